@@ -0,0 +1,104 @@
+/* fern.h - C interface for embedding the Fern compiler
+ *
+ * A session compiles a library (usually runtime/std.fn) once, then compiles many
+ * small source files against it, reusing its types, symbols and JIT. Each compiled
+ * module owns its code and must be destroyed before its session. Nothing here is
+ * thread-safe; use one session per thread.
+ *
+ *   fern_source std = {"std.fn", std_text, std_length};
+ *   fern_session *session = fern_session_create(&std, 1, NULL);
+ *   fern_module *module = fern_compile(session, "snippet.fn", "fn Add(i32 a, i32 b) -> i32 { return a + b }", 0);
+ *   const fern_function *add = fern_module_find(module, "Add");
+ *   int32_t a = 2, b = 3, sum;
+ *   void *args[] = {&a, &b};
+ *   fern_function_invoke(add, args, &sum);
+ *   fern_module_destroy(module);
+ *   fern_session_destroy(session);
+ */
+#ifndef FERN_H
+#define FERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct fern_session fern_session;
+typedef struct fern_module fern_module;
+typedef struct fern_function fern_function;
+
+/* Fern parameter and return types, as far as a host needs to lay out arguments */
+typedef enum fern_type
+{
+    FERN_TYPE_VOID,
+    FERN_TYPE_BOOL, /* one byte, 0 or 1 */
+    FERN_TYPE_CHAR,
+    FERN_TYPE_I8,
+    FERN_TYPE_I16,
+    FERN_TYPE_I32,
+    FERN_TYPE_I64,
+    FERN_TYPE_U8,
+    FERN_TYPE_U16,
+    FERN_TYPE_U32,
+    FERN_TYPE_U64,
+    FERN_TYPE_F32,
+    FERN_TYPE_F64,
+    FERN_TYPE_POINTER,
+    FERN_TYPE_OTHER /* arrays and types passed by value */
+} fern_type;
+
+/* `length` 0 means `text` is null-terminated */
+typedef struct fern_source
+{
+    const char *filename;
+    const char *text;
+    size_t length;
+} fern_source;
+
+typedef struct fern_options
+{
+    unsigned opt_level; /* LLVM pipeline level 0-3 */
+    int bounds_checks;  /* trap on out-of-range array indices */
+    int const_eval;     /* run pure calls with constant arguments while compiling */
+    int optimize_loops;
+    int quiet;          /* only log warnings and errors; the logger is process-wide */
+} fern_options;
+
+/* The defaults fern_session_create uses when given no options */
+void fern_options_init(fern_options *options);
+
+/* Compile the library. Always returns a session; check fern_session_error_count */
+fern_session *fern_session_create(const fern_source *library, size_t library_count, const fern_options *options);
+void fern_session_destroy(fern_session *session);
+size_t fern_session_error_count(const fern_session *session);
+const char *fern_session_error(const fern_session *session, size_t index);
+
+/* Compile one file against the session's library. Always returns a module; check
+ * fern_module_error_count. `filename` may be null */
+fern_module *fern_compile(fern_session *session, const char *filename, const char *text, size_t length);
+void fern_module_destroy(fern_module *module);
+size_t fern_module_error_count(const fern_module *module);
+const char *fern_module_error(const fern_module *module, size_t index);
+
+/* A top-level function of the module; null when missing or overloaded. Valid until
+ * the module is destroyed */
+const fern_function *fern_module_find(const fern_module *module, const char *name);
+
+size_t fern_function_param_count(const fern_function *function);
+fern_type fern_function_param_type(const fern_function *function, size_t index);
+fern_type fern_function_return_type(const fern_function *function);
+
+/* The compiled function itself, to cast to a matching C function pointer type */
+void *fern_function_address(const fern_function *function);
+
+/* Call through a generic wrapper: args[i] points at argument i, `result` at room for
+ * the return value (ignored for void functions) */
+void fern_function_invoke(const fern_function *function, void *const *args, void *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FERN_H */
@@ -1,5 +1,7 @@
 #include "compiler.hpp"
 #include "test_runner.hpp"
+#include "bench/bench_runner.hpp"
+#include "bench/commands.hpp"
 // #include "semantic/symbol_table.hpp"
 // #include "semantic/type_system.hpp"
 // #include "semantic/type_resolver.hpp"
@@ -7,33 +9,83 @@
 #include "parser/lexer.hpp"
 #include "parser/parser.hpp"
 #include "common/logger.hpp"
+#include "format/formatter.hpp"
 #include "ast/ast.hpp"
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <cstring>
+#include <cstdlib>
 #include <algorithm>
+#include <atomic>
+#include <new>
+#include <thread>
 
 using namespace Fern; 
 
-std::string read_file(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open file: " + filename);
+#ifdef FERN_COUNT_ALLOCATIONS
+// Count every heap allocation for --bench-bind. Only the FernBench build replaces operator new:
+// it costs an atomic increment per allocation, LLVM's included, which Fern itself shouldn't pay
+static std::atomic<size_t> heap_allocations{0};
+
+void* operator new(std::size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
     }
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
 }
 
+std::optional<size_t> Fern::heap_allocation_count() {
+    return heap_allocations.load(std::memory_order_relaxed);
+}
+#else
+std::optional<size_t> Fern::heap_allocation_count() {
+    return std::nullopt;
+}
+#endif
+
 void show_help(const std::string& program_name) {
     std::cout << "Fern Programming Language Compiler\n\n";
     std::cout << "Usage: " << program_name << " [options] <source files>\n\n";
     std::cout << "Options:\n";
     std::cout << "  --help, -h          Show this help message\n";
+    std::cout << "  fmt [--check] [paths]\n";
+    std::cout << "                      Format .fn files, and directories of them, in place (default: .);\n";
+    std::cout << "                      with --check, list the files that would change and write nothing\n";
     #ifdef FERN_DEBUG
     std::cout << "  --test, -t [dir]    Run tests in the specified directory (default: tests)\n";
     #endif
+    print_bench_help(std::cout);
+    std::cout << "  --bounds-checks     Trap on out-of-range array indices\n";
+    std::cout << "  --no-const-eval     Leave calls with constant arguments for run time\n";
+    std::cout << "  --const-eval-steps N\n";
+    std::cout << "                      Instructions one compile-time call may run (default: 4000000)\n";
+    std::cout << "  --const-eval-memory N\n";
+    std::cout << "                      Bytes one compile-time call may allocate (default: 16777216)\n";
+    std::cout << "  --codegen-threads N Split code generation into N partitions on N threads\n";
+    std::cout << "  --lazy-jit          Compile each function on its first call instead of up front\n";
+    std::cout << "  --tiered-jit        Start unoptimized with counters, recompile hot functions at -O3\n";
+    std::cout << "  --interpret         Run HLIR bytecode in the interpreter instead of generating LLVM IR\n";
+    std::cout << "  --perf              Emit line tables and expose JIT'd code to perf and GDB\n";
+    std::cout << "  --profile-generate <file>\n";
+    std::cout << "                      Count blocks and branches, appending the counts to <file>\n";
+    std::cout << "  --profile-use <file>\n";
+    std::cout << "                      Optimize with the counts in <file>\n";
+    std::cout << "  --emit=exe          Link a native executable instead of running the program\n";
+    std::cout << "  -o <file>           Executable to write with --emit=exe (default: first source's name)\n";
+    std::cout << "  --target-cpu <cpu>  CPU to generate the executable for (default: native)\n";
+    std::cout << "  --static            Link the executable statically\n";
+    std::cout << "  -O0 .. -O3          LLVM optimization level (default: -O0)\n";
     std::cout << "\nExamples:\n";
     std::cout << "  " << program_name << " main.fn\n";
     std::cout << "  " << program_name << " runtime/std.fn main.fn\n";
@@ -69,6 +121,48 @@ int main(int argc, char* argv[])
     }
     #endif
 
+    // Benchmarks (available in release builds, where timings mean something)
+    if (auto exit_code = run_bench_command(argc, argv)) {
+        return *exit_code;
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "fmt") == 0) {
+        bool check = false;
+        std::vector<std::string> paths;
+        for (int i = 2; i < argc; i++) {
+            if (std::strcmp(argv[i], "--check") == 0) {
+                check = true;
+            } else {
+                paths.push_back(argv[i]);
+            }
+        }
+        if (paths.empty()) {
+            paths.push_back(".");
+        }
+
+        Formatter formatter;
+        auto results = formatter.format_files(Formatter::collect_sources(paths), !check,
+                                              std::max(1u, std::thread::hardware_concurrency()));
+
+        size_t changed = 0;
+        size_t failed = 0;
+        for (const auto& result : results) {
+            if (!result.ok) {
+                std::cerr << result.path << ": " << result.error << std::endl;
+                failed++;
+            } else if (result.changed) {
+                std::cout << result.path << std::endl;
+                changed++;
+            }
+        }
+        std::cout << results.size() << " files, " << changed << (check ? " would be reformatted" : " reformatted");
+        if (failed > 0) {
+            std::cout << ", " << failed << " failed";
+        }
+        std::cout << std::endl;
+        return (failed > 0 || (check && changed > 0)) ? 1 : 0;
+    }
+
     Compiler compiler;
     #ifdef FERN_DEBUG
         compiler.set_print_ast(true);
@@ -78,6 +172,11 @@ int main(int argc, char* argv[])
 
     // Parse command line arguments
     std::vector<std::string> filenames;
+    bool emit_exe = false;
+    bool static_link = false;
+    std::string output_file;
+    std::string target_cpu = "native";
+    HLIR::ConstEvaluator::Limits const_eval_limits;
 
     if (argc > 1) {
         // Check for help flag
@@ -88,6 +187,74 @@ int main(int argc, char* argv[])
 
         // Collect source file arguments
         for (int i = 1; i < argc; i++) {
+            // Optimization level: -O0 .. -O3
+            if (std::strlen(argv[i]) == 3 && argv[i][0] == '-' && argv[i][1] == 'O' &&
+                argv[i][2] >= '0' && argv[i][2] <= '3') {
+                compiler.set_opt_level(argv[i][2] - '0');
+                continue;
+            }
+            if (std::strcmp(argv[i], "--bounds-checks") == 0) {
+                compiler.set_bounds_checks(true);
+                continue;
+            }
+            if (std::strcmp(argv[i], "--lazy-jit") == 0) {
+                compiler.set_jit_mode(JITMode::Lazy);
+                continue;
+            }
+            if (std::strcmp(argv[i], "--tiered-jit") == 0) {
+                compiler.set_jit_mode(JITMode::Tiered);
+                continue;
+            }
+            if (std::strcmp(argv[i], "--perf") == 0) {
+                compiler.set_profiling(true);
+                continue;
+            }
+            if (std::strcmp(argv[i], "--interpret") == 0) {
+                compiler.set_backend(Backend::Interpreter);
+                continue;
+            }
+            if (std::strcmp(argv[i], "--profile-generate") == 0 && i + 1 < argc) {
+                compiler.set_profile_generate(argv[++i]);
+                continue;
+            }
+            if (std::strcmp(argv[i], "--profile-use") == 0 && i + 1 < argc) {
+                compiler.set_profile_use(argv[++i]);
+                continue;
+            }
+            if (std::strcmp(argv[i], "--emit=exe") == 0) {
+                emit_exe = true;
+                continue;
+            }
+            if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+                output_file = argv[++i];
+                continue;
+            }
+            if (std::strcmp(argv[i], "--target-cpu") == 0 && i + 1 < argc) {
+                target_cpu = argv[++i];
+                continue;
+            }
+            if (std::strcmp(argv[i], "--static") == 0) {
+                static_link = true;
+                continue;
+            }
+            if (std::strcmp(argv[i], "--no-const-eval") == 0) {
+                compiler.set_const_eval(false);
+                continue;
+            }
+            if (std::strcmp(argv[i], "--const-eval-steps") == 0 && i + 1 < argc) {
+                const_eval_limits.max_steps = std::strtoull(argv[++i], nullptr, 10);
+                compiler.set_const_eval_limits(const_eval_limits);
+                continue;
+            }
+            if (std::strcmp(argv[i], "--const-eval-memory") == 0 && i + 1 < argc) {
+                const_eval_limits.max_memory_bytes = std::strtoull(argv[++i], nullptr, 10);
+                compiler.set_const_eval_limits(const_eval_limits);
+                continue;
+            }
+            if (std::strcmp(argv[i], "--codegen-threads") == 0 && i + 1 < argc) {
+                compiler.set_codegen_threads(static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10)));
+                continue;
+            }
             filenames.push_back(argv[i]);
         }
     } else
@@ -106,8 +273,7 @@ int main(int argc, char* argv[])
     {
         try
         {
-            auto source = read_file(filename);
-            source_files.push_back({filename, source});
+            source_files.push_back(SourceFile::open(filename));
         }
         catch (const std::exception& e)
         {
@@ -127,9 +293,17 @@ int main(int argc, char* argv[])
     if (result && result->is_valid())
     {
         #ifdef FERN_DEBUG
+        if (result->has_llvm_ir()) {
             result->dump_ir();
             result->write_object_file("out/output.o");
+        }
         #endif
+        if (emit_exe) {
+            if (output_file.empty()) {
+                output_file = std::filesystem::path(filenames.front()).stem().string();
+            }
+            return result->write_executable(output_file, target_cpu, static_link) ? 0 : 1;
+        }
         auto ret = result->execute_jit<float>("Main").value_or(-1.0f);
         std::cout << "\n";
         std::cout << "______________________________\n\n";
@@ -0,0 +1,26 @@
+// Starts FernLSP for Fern files: diagnostics, go-to-definition and hover
+const vscode = require("vscode");
+const { LanguageClient } = require("vscode-languageclient/node");
+
+let client;
+
+function activate(context) {
+    const command = vscode.workspace.getConfiguration("fern").get("server.path") || "FernLSP";
+
+    client = new LanguageClient(
+        "fern",
+        "Fern Language Server",
+        { command, args: [] },
+        {
+            documentSelector: [{ scheme: "file", language: "fern" }]
+        }
+    );
+    context.subscriptions.push(client);
+    return client.start();
+}
+
+function deactivate() {
+    return client ? client.stop() : undefined;
+}
+
+module.exports = { activate, deactivate };
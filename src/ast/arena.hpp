@@ -8,6 +8,7 @@
 #include <new>
 #include <span>
 #include <string_view>
+#include <type_traits>
 #include "ast.hpp"
 
 namespace Fern
@@ -80,12 +81,16 @@ namespace Fern
             return result;
         }
 
-        // Main allocation function for AST nodes
+        // Main allocation function for AST nodes. Nodes get their kind tag here rather
+        // than from a constructor, which would stop `T()` from zeroing their fields
         template <typename T, typename... Args>
         T *make(Args &&...args)
         {
             void *memory = allocate(sizeof(T), alignof(T));
-            return new (memory) T(std::forward<Args>(args)...);
+            T *node = new (memory) T(std::forward<Args>(args)...);
+            if constexpr (std::is_base_of_v<BaseSyntax, T>)
+                node->syntaxKind = T::NodeKind;
+            return node;
         }
 
         // Create a span from a vector
@@ -101,7 +106,7 @@ namespace Fern
         }
 
         // Helper factory methods
-        SimpleNameSyntax *makeIdentifier(Token token)
+        SimpleNameSyntax *makeIdentifier(const Token &token)
         {
             auto id = make<SimpleNameSyntax>();
             id->identifier = token;
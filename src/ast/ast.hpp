@@ -8,6 +8,7 @@
 #include <optional>
 #include <vector>
 #include "common/source_location.hpp"
+#include "common/visitor_dispatch.hpp"
 #include "common/token.hpp"
 #include "semantic/type.hpp"
 
@@ -99,10 +100,80 @@ namespace Fern
     using List = std::span<T>;
 #pragma endregion
 
+#pragma region Node Kinds
+// Every concrete node type, as X(Kind, Type). The order matters: each abstract base's
+// subtypes form one contiguous run (names, then the other expressions, statements and
+// declarations last among statements), so its classof is a single range check.
+#define FERN_SYNTAX_NODES(X) \
+    /* names */ \
+    X(SimpleName, SimpleNameSyntax) \
+    X(QualifiedName, QualifiedNameSyntax) \
+    X(GenericName, GenericNameSyntax) \
+    /* other expressions */ \
+    X(MissingExpr, MissingExprSyntax) \
+    X(LiteralExpr, LiteralExprSyntax) \
+    X(ArrayLiteralExpr, ArrayLiteralExprSyntax) \
+    X(ThisExpr, ThisExprSyntax) \
+    X(ParenthesizedExpr, ParenthesizedExprSyntax) \
+    X(UnaryExpr, UnaryExprSyntax) \
+    X(BinaryExpr, BinaryExprSyntax) \
+    X(AssignmentExpr, AssignmentExprSyntax) \
+    X(ConditionalExpr, ConditionalExprSyntax) \
+    X(MemberAccessExpr, MemberAccessExprSyntax) \
+    X(IndexerExpr, IndexerExprSyntax) \
+    X(CallExpr, CallExprSyntax) \
+    X(NewExpr, NewExprSyntax) \
+    X(CastExpr, CastExprSyntax) \
+    X(LambdaExpr, LambdaExprSyntax) \
+    X(TypeOfExpr, TypeOfExprSyntax) \
+    X(SizeOfExpr, SizeOfExprSyntax) \
+    X(ArrayType, ArrayTypeSyntax) \
+    X(PointerType, PointerTypeSyntax) \
+    /* statements */ \
+    X(MissingStmt, MissingStmtSyntax) \
+    X(Block, BlockSyntax) \
+    X(IfStmt, IfStmtSyntax) \
+    X(WhileStmt, WhileStmtSyntax) \
+    X(ForStmt, ForStmtSyntax) \
+    X(ReturnStmt, ReturnStmtSyntax) \
+    X(BreakStmt, BreakStmtSyntax) \
+    X(ContinueStmt, ContinueStmtSyntax) \
+    X(ExpressionStmt, ExpressionStmtSyntax) \
+    X(UsingDirective, UsingDirectiveSyntax) \
+    /* declarations */ \
+    X(VariableDecl, VariableDeclSyntax) \
+    X(PropertyDecl, PropertyDeclSyntax) \
+    X(ParameterDecl, ParameterDeclSyntax) \
+    X(FunctionDecl, FunctionDeclSyntax) \
+    X(ConstructorDecl, ConstructorDeclSyntax) \
+    X(EnumCaseDecl, EnumCaseDeclSyntax) \
+    X(TypeDecl, TypeDeclSyntax) \
+    X(TypeParameterDecl, TypeParameterDeclSyntax) \
+    X(NamespaceDecl, NamespaceDeclSyntax) \
+    /* supporting nodes */ \
+    X(TypedIdentifier, TypedIdentifier) \
+    X(PropertyAccessor, PropertyAccessorSyntax) \
+    X(CompilationUnit, CompilationUnitSyntax)
+
+    enum class SyntaxKind : uint8_t
+    {
+#define FERN_SYNTAX_KIND(Kind, Type) Kind,
+        FERN_SYNTAX_NODES(FERN_SYNTAX_KIND)
+#undef FERN_SYNTAX_KIND
+    };
+#pragma endregion
+
 // Macro to create an accept function implementation
 #define ACCEPT_VISITOR \
     void accept(Visitor *visitor) override { visitor->visit(this); }
 
+// Members every concrete node declares: its kind tag (stamped on the node by Arena::make),
+// the classof test is<T>()/as<T>() use, and accept
+#define SYNTAX_NODE(Kind)                                                                  \
+    static constexpr SyntaxKind NodeKind = SyntaxKind::Kind;                               \
+    static bool classof(const BaseSyntax *node) { return node->syntaxKind == NodeKind; } \
+    ACCEPT_VISITOR
+
 #pragma region Visitor Pattern
     class Visitor
     {
@@ -171,6 +242,11 @@ namespace Fern
         virtual void visit(TypedIdentifier *node) = 0;
         virtual void visit(PropertyAccessorSyntax *node) = 0;
         virtual void visit(CompilationUnitSyntax *node) = 0;
+
+        // Visit `node` as its concrete type: a switch on its kind tag and one virtual call,
+        // where node->accept(this) makes two. Passes that know their own final type can
+        // use SyntaxSwitchVisitor to make the visit call direct as well.
+        void dispatch(BaseSyntax *node);
     };
 #pragma endregion
 
@@ -178,43 +254,58 @@ namespace Fern
     struct BaseSyntax
     {
         SourceRange location;
+        SyntaxKind syntaxKind; // The concrete type; set by Arena::make
 
         virtual ~BaseSyntax() = default;
         virtual void accept(Visitor *visitor);
 
-        // Clean API using dynamic_cast
+        static bool classof(const BaseSyntax *) { return true; }
+
+        // Casts check the kind tag through T::classof instead of walking RTTI
         template <typename T>
         bool is() const
         {
-            return dynamic_cast<const T *>(this) != nullptr;
+            return T::classof(this);
         }
 
         template <typename T>
         T *as()
         {
-            return dynamic_cast<T *>(this);
+            return T::classof(this) ? static_cast<T *>(this) : nullptr;
         }
 
         template <typename T>
         const T *as() const
         {
-            return dynamic_cast<const T *>(this);
+            return T::classof(this) ? static_cast<const T *>(this) : nullptr;
         }
     };
 
     struct BaseExprSyntax : BaseSyntax
     {
+        static bool classof(const BaseSyntax *node)
+        {
+            return node->syntaxKind >= SyntaxKind::SimpleName && node->syntaxKind <= SyntaxKind::PointerType;
+        }
         ACCEPT_VISITOR
     };
 
     struct BaseStmtSyntax : BaseSyntax
     {
+        static bool classof(const BaseSyntax *node)
+        {
+            return node->syntaxKind >= SyntaxKind::MissingStmt && node->syntaxKind <= SyntaxKind::NamespaceDecl;
+        }
         ACCEPT_VISITOR
     };
 
     struct BaseDeclSyntax : BaseStmtSyntax
     {
         ModifierKindFlags modifiers;
+        static bool classof(const BaseSyntax *node)
+        {
+            return node->syntaxKind >= SyntaxKind::VariableDecl && node->syntaxKind <= SyntaxKind::NamespaceDecl;
+        }
         ACCEPT_VISITOR
     };
 #pragma endregion
@@ -223,6 +314,10 @@ namespace Fern
     
     struct BaseNameExprSyntax : BaseExprSyntax
     {
+        static bool classof(const BaseSyntax *node)
+        {
+            return node->syntaxKind >= SyntaxKind::SimpleName && node->syntaxKind <= SyntaxKind::GenericName;
+        }
         ACCEPT_VISITOR
 
         std::string get_name() const;
@@ -232,21 +327,21 @@ namespace Fern
     struct SimpleNameSyntax : BaseNameExprSyntax
     {
         Token identifier;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(SimpleName)
     };
 
     struct QualifiedNameSyntax : BaseNameExprSyntax
     {
         BaseExprSyntax *left;      // The qualifier (can be any expression to allow complex types)
         BaseNameExprSyntax *right; // The member name
-        ACCEPT_VISITOR
+        SYNTAX_NODE(QualifiedName)
     };
 
     struct GenericNameSyntax : BaseNameExprSyntax
     {
         BaseNameExprSyntax *identifier; // Just the name token
         List<BaseExprSyntax *> typeArguments;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(GenericName)
     };
 
     inline std::vector<std::string> BaseNameExprSyntax::get_parts() const
@@ -307,7 +402,7 @@ namespace Fern
     {
         BaseNameExprSyntax *name;
         BaseExprSyntax *type; // null = inferred (var)
-        ACCEPT_VISITOR
+        SYNTAX_NODE(TypedIdentifier)
     };
     
 #pragma endregion
@@ -318,31 +413,31 @@ namespace Fern
     {
         std::string message;
         List<BaseSyntax *> partialNodes;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(MissingExpr)
     };
 
     struct LiteralExprSyntax : BaseExprSyntax
     {
         LiteralKind kind;
         std::string value; // Raw text from source
-        ACCEPT_VISITOR
+        SYNTAX_NODE(LiteralExpr)
     };
 
     struct ArrayLiteralExprSyntax : BaseExprSyntax
     {
         List<BaseExprSyntax *> elements;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(ArrayLiteralExpr)
     };
 
     struct ThisExprSyntax : BaseExprSyntax
     {
-        ACCEPT_VISITOR
+        SYNTAX_NODE(ThisExpr)
     };
 
     struct ParenthesizedExprSyntax : BaseExprSyntax
     {
         BaseExprSyntax *expression; // The expression inside parentheses
-        ACCEPT_VISITOR
+        SYNTAX_NODE(ParenthesizedExpr)
     };
 
     struct UnaryExprSyntax : BaseExprSyntax
@@ -350,7 +445,7 @@ namespace Fern
         UnaryOperatorKind op;
         BaseExprSyntax *operand;
         bool isPostfix;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(UnaryExpr)
     };
 
     struct BinaryExprSyntax : BaseExprSyntax
@@ -358,7 +453,7 @@ namespace Fern
         BaseExprSyntax *left;
         BinaryOperatorKind op;
         BaseExprSyntax *right;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(BinaryExpr)
     };
 
     struct AssignmentExprSyntax : BaseExprSyntax
@@ -366,7 +461,7 @@ namespace Fern
         BaseExprSyntax *target;
         AssignmentOperatorKind op;
         BaseExprSyntax *value;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(AssignmentExpr)
     };
 
     struct ConditionalExprSyntax : BaseExprSyntax
@@ -374,61 +469,61 @@ namespace Fern
         BaseExprSyntax *condition;
         BaseExprSyntax *thenExpr;
         BaseExprSyntax *elseExpr;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(ConditionalExpr)
     };
 
     struct MemberAccessExprSyntax : BaseExprSyntax
     {
         BaseExprSyntax *object;       // The object/expression being accessed
         BaseNameExprSyntax *member; // The member name
-        ACCEPT_VISITOR
+        SYNTAX_NODE(MemberAccessExpr)
     };
 
     struct IndexerExprSyntax : BaseExprSyntax
     {
         BaseExprSyntax *object;
         BaseExprSyntax *index;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(IndexerExpr)
     };
 
     struct CallExprSyntax : BaseExprSyntax
     {
         BaseExprSyntax *callee;
         List<BaseExprSyntax *> arguments;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(CallExpr)
     };
 
     struct NewExprSyntax : BaseExprSyntax
     {
         BaseExprSyntax *type;
         List<BaseExprSyntax *> arguments;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(NewExpr)
     };
 
     struct CastExprSyntax : BaseExprSyntax
     {
         BaseExprSyntax *targetType;
         BaseExprSyntax *expression;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(CastExpr)
     };
 
     struct LambdaExprSyntax : BaseExprSyntax
     {
         List<ParameterDeclSyntax *> parameters;
         BaseStmtSyntax *body; // BlockSyntax or ExpressionStmtSyntax
-        ACCEPT_VISITOR
+        SYNTAX_NODE(LambdaExpr)
     };
 
     struct TypeOfExprSyntax : BaseExprSyntax
     {
         BaseExprSyntax *type;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(TypeOfExpr)
     };
 
     struct SizeOfExprSyntax : BaseExprSyntax
     {
         BaseExprSyntax *type;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(SizeOfExpr)
     };
 #pragma endregion
 
@@ -437,13 +532,13 @@ namespace Fern
     {
         BaseExprSyntax *baseType;
         LiteralExprSyntax *size; // Can be null for unsized arrays
-        ACCEPT_VISITOR
+        SYNTAX_NODE(ArrayType)
     };
 
     struct PointerTypeSyntax : BaseExprSyntax
     {
         BaseExprSyntax *baseType;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(PointerType)
     };
 #pragma endregion
 
@@ -453,13 +548,13 @@ namespace Fern
     {
         std::string message;
         List<BaseSyntax *> partialNodes;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(MissingStmt)
     };
 
     struct BlockSyntax : BaseStmtSyntax
     {
         List<BaseStmtSyntax *> statements;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(Block)
     };
 
     struct IfStmtSyntax : BaseStmtSyntax
@@ -467,14 +562,14 @@ namespace Fern
         BaseExprSyntax *condition;
         BaseStmtSyntax *thenBranch;
         BaseStmtSyntax *elseBranch; // Can be null
-        ACCEPT_VISITOR
+        SYNTAX_NODE(IfStmt)
     };
 
     struct WhileStmtSyntax : BaseStmtSyntax
     {
         BaseExprSyntax *condition;
         BaseStmtSyntax *body;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(WhileStmt)
     };
 
     struct ForStmtSyntax : BaseStmtSyntax
@@ -483,35 +578,35 @@ namespace Fern
         BaseExprSyntax *condition;   // Can be null (infinite loop)
         List<BaseExprSyntax *> updates;
         BaseStmtSyntax *body;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(ForStmt)
     };
 
     struct ReturnStmtSyntax : BaseStmtSyntax
     {
         BaseExprSyntax *value; // Can be null (void return)
-        ACCEPT_VISITOR
+        SYNTAX_NODE(ReturnStmt)
     };
 
     struct BreakStmtSyntax : BaseStmtSyntax
     {
-        ACCEPT_VISITOR
+        SYNTAX_NODE(BreakStmt)
     };
 
     struct ContinueStmtSyntax : BaseStmtSyntax
     {
-        ACCEPT_VISITOR
+        SYNTAX_NODE(ContinueStmt)
     };
 
     struct ExpressionStmtSyntax : BaseStmtSyntax
     {
         BaseExprSyntax *expression;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(ExpressionStmt)
     };
 
     struct UsingDirectiveSyntax : BaseStmtSyntax
     {
         BaseNameExprSyntax *target; // The imported namespace/type
-        ACCEPT_VISITOR
+        SYNTAX_NODE(UsingDirective)
     };
 
 #pragma endregion
@@ -521,7 +616,7 @@ namespace Fern
     {
         TypedIdentifier *variable;
         BaseExprSyntax *initializer; // Can be null
-        ACCEPT_VISITOR
+        SYNTAX_NODE(VariableDecl)
     };
 
     struct PropertyDeclSyntax : BaseDeclSyntax
@@ -529,7 +624,7 @@ namespace Fern
         VariableDeclSyntax *variable;   // The underlying variable
         PropertyAccessorSyntax *getter; // null = auto-generated
         PropertyAccessorSyntax *setter; // null = no setter (read-only)
-        ACCEPT_VISITOR
+        SYNTAX_NODE(PropertyDecl)
     };
 
     struct PropertyAccessorSyntax : BaseSyntax
@@ -551,14 +646,14 @@ namespace Fern
             >
             body;
 
-        ACCEPT_VISITOR
+        SYNTAX_NODE(PropertyAccessor)
     };
 
     struct ParameterDeclSyntax : BaseDeclSyntax
     {
         TypedIdentifier *param;
         BaseExprSyntax *defaultValue; // Can be null
-        ACCEPT_VISITOR
+        SYNTAX_NODE(ParameterDecl)
     };
 
     struct FunctionDeclSyntax : BaseDeclSyntax
@@ -568,7 +663,7 @@ namespace Fern
         List<ParameterDeclSyntax *> parameters;
         BaseExprSyntax *returnType; // null = void
         BlockSyntax *body;          // Can be null (abstract)
-        ACCEPT_VISITOR
+        SYNTAX_NODE(FunctionDecl)
     };
 
     struct ConstructorDeclSyntax : BaseDeclSyntax
@@ -576,14 +671,14 @@ namespace Fern
         // No name field - constructors are always "new"
         List<ParameterDeclSyntax *> parameters;
         BlockSyntax *body;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(ConstructorDecl)
     };
 
     struct EnumCaseDeclSyntax : BaseDeclSyntax
     {
         BaseNameExprSyntax *name;
         List<ParameterDeclSyntax *> associatedData; // Can be empty
-        ACCEPT_VISITOR
+        SYNTAX_NODE(EnumCaseDecl)
     };
 
     struct TypeDeclSyntax : BaseDeclSyntax
@@ -601,14 +696,14 @@ namespace Fern
         List<TypeParameterDeclSyntax *> typeParameters;
         List<BaseExprSyntax *> baseTypes;
         List<BaseDeclSyntax *> members;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(TypeDecl)
     };
 
     struct TypeParameterDeclSyntax : BaseDeclSyntax
     {
         BaseNameExprSyntax *name; // The type parameter name (T, U, etc.)
         // Future: constraints can be added here
-        ACCEPT_VISITOR
+        SYNTAX_NODE(TypeParameterDecl)
     };
 
     struct NamespaceDeclSyntax : BaseDeclSyntax
@@ -616,7 +711,7 @@ namespace Fern
         BaseNameExprSyntax *name; // The namespace name
         bool isFileScoped;
         std::optional<List<BaseStmtSyntax *>> body; // nullopt for file-scoped
-        ACCEPT_VISITOR
+        SYNTAX_NODE(NamespaceDecl)
     };
 #pragma endregion
 
@@ -624,7 +719,7 @@ namespace Fern
     struct CompilationUnitSyntax : BaseSyntax
     {
         List<BaseStmtSyntax *> topLevelStatements;
-        ACCEPT_VISITOR
+        SYNTAX_NODE(CompilationUnit)
     };
 #pragma endregion
 
@@ -653,20 +748,20 @@ namespace Fern
         {
             visit(static_cast<BaseNameExprSyntax *>(node));
             if (node->left)
-                node->left->accept(this);
+                dispatch(node->left);
             if (node->right)
-                node->right->accept(this);
+                dispatch(node->right);
         }
 
         void visit(GenericNameSyntax *node) override
         {
             visit(static_cast<BaseNameExprSyntax *>(node));
             if (node->identifier)
-                node->identifier->accept(this);
+                dispatch(node->identifier);
             for (auto arg : node->typeArguments)
             {
                 if (arg)
-                    arg->accept(this);
+                    dispatch(arg);
             }
         }
 
@@ -675,9 +770,9 @@ namespace Fern
         {
             visit(static_cast<BaseSyntax *>(node));
             if (node->name)
-                node->name->accept(this);
+                dispatch(node->name);
             if (node->type)
-                node->type->accept(this);
+                dispatch(node->type);
         }
 
         void visit(PropertyAccessorSyntax *node) override
@@ -686,12 +781,12 @@ namespace Fern
             if (auto expr = std::get_if<BaseExprSyntax *>(&node->body))
             {
                 if (*expr)
-                    (*expr)->accept(this);
+                    dispatch((*expr));
             }
             else if (auto block = std::get_if<BlockSyntax *>(&node->body))
             {
                 if (*block)
-                    (*block)->accept(this);
+                    dispatch((*block));
             }
         }
 
@@ -702,7 +797,7 @@ namespace Fern
             for (auto partial : node->partialNodes)
             {
                 if (partial)
-                    partial->accept(this);
+                    dispatch(partial);
             }
         }
 
@@ -717,7 +812,7 @@ namespace Fern
             for (auto elem : node->elements)
             {
                 if (elem)
-                    elem->accept(this);
+                    dispatch(elem);
             }
         }
         
@@ -730,72 +825,72 @@ namespace Fern
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->expression)
-                node->expression->accept(this);
+                dispatch(node->expression);
         }
 
         void visit(UnaryExprSyntax *node) override
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->operand)
-                node->operand->accept(this);
+                dispatch(node->operand);
         }
 
         void visit(BinaryExprSyntax *node) override
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->left)
-                node->left->accept(this);
+                dispatch(node->left);
             if (node->right)
-                node->right->accept(this);
+                dispatch(node->right);
         }
 
         void visit(AssignmentExprSyntax *node) override
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->target)
-                node->target->accept(this);
+                dispatch(node->target);
             if (node->value)
-                node->value->accept(this);
+                dispatch(node->value);
         }
 
         void visit(ConditionalExprSyntax *node) override
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->condition)
-                node->condition->accept(this);
+                dispatch(node->condition);
             if (node->thenExpr)
-                node->thenExpr->accept(this);
+                dispatch(node->thenExpr);
             if (node->elseExpr)
-                node->elseExpr->accept(this);
+                dispatch(node->elseExpr);
         }
 
         void visit(MemberAccessExprSyntax *node) override
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->object)
-                node->object->accept(this);
+                dispatch(node->object);
             if (node->member)
-                node->member->accept(this);
+                dispatch(node->member);
         }
 
         void visit(IndexerExprSyntax *node) override
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->object)
-                node->object->accept(this);
+                dispatch(node->object);
             if (node->index)
-                node->index->accept(this);
+                dispatch(node->index);
         }
 
         void visit(CallExprSyntax *node) override
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->callee)
-                node->callee->accept(this);
+                dispatch(node->callee);
             for (auto arg : node->arguments)
             {
                 if (arg)
-                    arg->accept(this);
+                    dispatch(arg);
             }
         }
 
@@ -803,11 +898,11 @@ namespace Fern
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->type)
-                node->type->accept(this);
+                dispatch(node->type);
             for (auto arg : node->arguments)
             {
                 if (arg)
-                    arg->accept(this);
+                    dispatch(arg);
             }
         }
 
@@ -815,9 +910,9 @@ namespace Fern
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->targetType)
-                node->targetType->accept(this);
+                dispatch(node->targetType);
             if (node->expression)
-                node->expression->accept(this);
+                dispatch(node->expression);
         }
 
         void visit(LambdaExprSyntax *node) override
@@ -826,24 +921,24 @@ namespace Fern
             for (auto param : node->parameters)
             {
                 if (param)
-                    param->accept(this);
+                    dispatch(param);
             }
             if (node->body)
-                node->body->accept(this);
+                dispatch(node->body);
         }
 
         void visit(TypeOfExprSyntax *node) override
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->type)
-                node->type->accept(this);
+                dispatch(node->type);
         }
 
         void visit(SizeOfExprSyntax *node) override
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->type)
-                node->type->accept(this);
+                dispatch(node->type);
         }
 
         // Type expressions
@@ -851,16 +946,16 @@ namespace Fern
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->baseType)
-                node->baseType->accept(this);
+                dispatch(node->baseType);
             if (node->size)
-                node->size->accept(this);
+                dispatch(node->size);
         }
 
         void visit(PointerTypeSyntax *node) override
         {
             visit(static_cast<BaseExprSyntax *>(node));
             if (node->baseType)
-                node->baseType->accept(this);
+                dispatch(node->baseType);
         }
 
         // Statements
@@ -870,7 +965,7 @@ namespace Fern
             for (auto partial : node->partialNodes)
             {
                 if (partial)
-                    partial->accept(this);
+                    dispatch(partial);
             }
         }
 
@@ -880,7 +975,7 @@ namespace Fern
             for (auto stmt : node->statements)
             {
                 if (stmt)
-                    stmt->accept(this);
+                    dispatch(stmt);
             }
         }
 
@@ -888,43 +983,43 @@ namespace Fern
         {
             visit(static_cast<BaseStmtSyntax *>(node));
             if (node->condition)
-                node->condition->accept(this);
+                dispatch(node->condition);
             if (node->thenBranch)
-                node->thenBranch->accept(this);
+                dispatch(node->thenBranch);
             if (node->elseBranch)
-                node->elseBranch->accept(this);
+                dispatch(node->elseBranch);
         }
 
         void visit(WhileStmtSyntax *node) override
         {
             visit(static_cast<BaseStmtSyntax *>(node));
             if (node->condition)
-                node->condition->accept(this);
+                dispatch(node->condition);
             if (node->body)
-                node->body->accept(this);
+                dispatch(node->body);
         }
 
         void visit(ForStmtSyntax *node) override
         {
             visit(static_cast<BaseStmtSyntax *>(node));
             if (node->initializer)
-                node->initializer->accept(this);
+                dispatch(node->initializer);
             if (node->condition)
-                node->condition->accept(this);
+                dispatch(node->condition);
             for (auto update : node->updates)
             {
                 if (update)
-                    update->accept(this);
+                    dispatch(update);
             }
             if (node->body)
-                node->body->accept(this);
+                dispatch(node->body);
         }
 
         void visit(ReturnStmtSyntax *node) override
         {
             visit(static_cast<BaseStmtSyntax *>(node));
             if (node->value)
-                node->value->accept(this);
+                dispatch(node->value);
         }
 
         void visit(BreakStmtSyntax *node) override
@@ -941,14 +1036,14 @@ namespace Fern
         {
             visit(static_cast<BaseStmtSyntax *>(node));
             if (node->expression)
-                node->expression->accept(this);
+                dispatch(node->expression);
         }
 
         void visit(UsingDirectiveSyntax *node) override
         {
             visit(static_cast<BaseStmtSyntax *>(node));
             if (node->target)
-                node->target->accept(this);
+                dispatch(node->target);
         }
 
         // Declarations
@@ -956,50 +1051,50 @@ namespace Fern
         {
             visit(static_cast<BaseDeclSyntax *>(node));
             if (node->variable)
-                node->variable->accept(this);
+                dispatch(node->variable);
             if (node->initializer)
-                node->initializer->accept(this);
+                dispatch(node->initializer);
         }
 
         void visit(PropertyDeclSyntax *node) override
         {
             visit(static_cast<BaseDeclSyntax *>(node));
             if (node->variable)
-                node->variable->accept(this);
+                dispatch(node->variable);
             if (node->getter)
-                node->getter->accept(this);
+                dispatch(node->getter);
             if (node->setter)
-                node->setter->accept(this);
+                dispatch(node->setter);
         }
 
         void visit(ParameterDeclSyntax *node) override
         {
             visit(static_cast<BaseDeclSyntax *>(node));
             if (node->param)
-                node->param->accept(this);
+                dispatch(node->param);
             if (node->defaultValue)
-                node->defaultValue->accept(this);
+                dispatch(node->defaultValue);
         }
 
         void visit(FunctionDeclSyntax *node) override
         {
             visit(static_cast<BaseDeclSyntax *>(node));
             if (node->name)
-                node->name->accept(this);
+                dispatch(node->name);
             for (auto typeParam : node->typeParameters)
             {
                 if (typeParam)
-                    typeParam->accept(this);
+                    dispatch(typeParam);
             }
             for (auto param : node->parameters)
             {
                 if (param)
-                    param->accept(this);
+                    dispatch(param);
             }
             if (node->returnType)
-                node->returnType->accept(this);
+                dispatch(node->returnType);
             if (node->body)
-                node->body->accept(this);
+                dispatch(node->body);
         }
 
         void visit(ConstructorDeclSyntax *node) override
@@ -1008,21 +1103,21 @@ namespace Fern
             for (auto param : node->parameters)
             {
                 if (param)
-                    param->accept(this);
+                    dispatch(param);
             }
             if (node->body)
-                node->body->accept(this);
+                dispatch(node->body);
         }
 
         void visit(EnumCaseDeclSyntax *node) override
         {
             visit(static_cast<BaseDeclSyntax *>(node));
             if (node->name)
-                node->name->accept(this);
+                dispatch(node->name);
             for (auto data : node->associatedData)
             {
                 if (data)
-                    data->accept(this);
+                    dispatch(data);
             }
         }
 
@@ -1030,21 +1125,21 @@ namespace Fern
         {
             visit(static_cast<BaseDeclSyntax *>(node));
             if (node->name)
-                node->name->accept(this);
+                dispatch(node->name);
             for (auto typeParam : node->typeParameters)
             {
                 if (typeParam)
-                    typeParam->accept(this);
+                    dispatch(typeParam);
             }
             for (auto base : node->baseTypes)
             {
                 if (base)
-                    base->accept(this);
+                    dispatch(base);
             }
             for (auto member : node->members)
             {
                 if (member)
-                    member->accept(this);
+                    dispatch(member);
             }
         }
 
@@ -1052,20 +1147,20 @@ namespace Fern
         {
             visit(static_cast<BaseDeclSyntax *>(node));
             if (node->name)
-                node->name->accept(this);
+                dispatch(node->name);
         }
 
         void visit(NamespaceDeclSyntax *node) override
         {
             visit(static_cast<BaseDeclSyntax *>(node));
             if (node->name)
-                node->name->accept(this);
+                dispatch(node->name);
             if (node->body)
             {
                 for (auto stmt : *node->body)
                 {
                     if (stmt)
-                        stmt->accept(this);
+                        dispatch(stmt);
                 }
             }
         }
@@ -1076,7 +1171,40 @@ namespace Fern
             for (auto stmt : node->topLevelStatements)
             {
                 if (stmt)
-                    stmt->accept(this);
+                    dispatch(stmt);
+            }
+        }
+    };
+
+    /**
+     * @brief Switch dispatch for a pass that knows its own most-derived type
+     *
+     * dispatch(node) switches on the node's kind and calls Derived::visit directly, so
+     * for a `final` pass the compiler can inline the call. Derived must see every visit
+     * overload, overriding it or bringing it in with `using Base::visit`, or overload
+     * resolution would quietly pick a visit for one of the node's base types.
+     */
+    template <typename Derived, typename Base = DefaultVisitor>
+    class SyntaxSwitchVisitor : public Base
+    {
+    protected:
+        void dispatch(BaseSyntax *node)
+        {
+            if (visitor_dispatch == VisitorDispatch::Virtual)
+            {
+                node->accept(this);
+                return;
+            }
+
+            Derived *self = static_cast<Derived *>(this);
+            switch (node->syntaxKind)
+            {
+#define FERN_SYNTAX_CASE(Kind, Type) \
+    case SyntaxKind::Kind:           \
+        self->visit(static_cast<Type *>(node)); \
+        return;
+                FERN_SYNTAX_NODES(FERN_SYNTAX_CASE)
+#undef FERN_SYNTAX_CASE
             }
         }
     };
@@ -1089,6 +1217,25 @@ namespace Fern
         visitor->visit(this);
     }
 
+    inline void Visitor::dispatch(BaseSyntax *node)
+    {
+        if (visitor_dispatch == VisitorDispatch::Virtual)
+        {
+            node->accept(this);
+            return;
+        }
+
+        switch (node->syntaxKind)
+        {
+#define FERN_SYNTAX_CASE(Kind, Type) \
+    case SyntaxKind::Kind:           \
+        visit(static_cast<Type *>(node)); \
+        return;
+            FERN_SYNTAX_NODES(FERN_SYNTAX_CASE)
+#undef FERN_SYNTAX_CASE
+        }
+    }
+
     // Default implementations for base type visits
     inline void Visitor::visit(BaseSyntax *node)
     {
@@ -3,7 +3,8 @@
 #include "ast/ast.hpp"
 #include "common/logger.hpp"
 #include <iostream>
-#include <sstream>
+#include <string>
+#include <string_view>
 #include <variant>
 
 namespace Fern
@@ -13,7 +14,7 @@ namespace Fern
     {
     private:
         int indentLevel = 0;
-        std::ostringstream output;
+        std::string output; // Appended in place; reserve() once for the whole tree
 
         // RAII helper for managing indentation levels safely.
         class IndentGuard
@@ -26,24 +27,19 @@ namespace Fern
             ~IndentGuard() { this->level--; }
         };
 
-        std::string get_indent()
+        void emit(std::string_view text)
         {
-            return std::string(indentLevel * 2, ' ');
-        }
-
-        void emit(const std::string &text)
-        {
-            output << text;
+            output.append(text);
         }
 
         void emit_indent()
         {
-            output << get_indent();
+            output.append(indentLevel * 2, ' ');
         }
 
         void emit_newline()
         {
-            output << "\n";
+            output.push_back('\n');
         }
 
         void print_modifiers(const ModifierKindFlags &modifiers)
@@ -74,9 +70,13 @@ namespace Fern
         }
 
     public:
+        // Size the output buffer up front, e.g. to the length of the source being printed
+        void reserve(size_t bytes) { output.reserve(bytes); }
+
         std::string get_result()
         {
-            std::string result = output.str();
+            std::string result = std::move(output);
+            output.clear();
             if (!result.empty() && result.back() == '\n')
             {
                 result.pop_back();
@@ -127,7 +127,7 @@ namespace Fern
         // ErrorTypeRef removed - no longer exists
 
         // --- Expressions (unchanged) ---
-        void visit(LiteralExprSyntax *node) override { emit(std::string(node->value)); }
+        void visit(LiteralExprSyntax *node) override { emit(node->value); }
         void visit(ArrayLiteralExprSyntax *node) override
         {
             emit("[");
@@ -142,31 +142,35 @@ namespace Fern
         }
         void visit(SimpleNameSyntax *node) override
         {
-            emit(std::string(node->identifier.text));
+            emit(node->identifier.text);
         }
         void visit(UnaryExprSyntax *node) override
         {
             if (node->isPostfix)
             {
                 node->operand->accept(this);
-                emit(std::string(to_string(node->op)));
+                emit(to_string(node->op));
             }
             else
             {
-                emit(std::string(to_string(node->op)));
+                emit(to_string(node->op));
                 node->operand->accept(this);
             }
         }
         void visit(BinaryExprSyntax *node) override
         {
             node->left->accept(this);
-            emit(" " + std::string(to_string(node->op)) + " ");
+            emit(" ");
+            emit(to_string(node->op));
+            emit(" ");
             node->right->accept(this);
         }
         void visit(AssignmentExprSyntax *node) override
         {
             node->target->accept(this);
-            emit(" " + std::string(to_string(node->op)) + " ");
+            emit(" ");
+            emit(to_string(node->op));
+            emit(" ");
             node->value->accept(this);
         }
         void visit(CallExprSyntax *node) override
@@ -285,7 +289,8 @@ namespace Fern
 
             if (node->elseBranch)
             {
-                output.seekp(-1, std::ios_base::end);
+                if (!output.empty() && output.back() == '\n')
+                    output.pop_back();
                 emit(" else");
 
                 if (node->elseBranch->is<IfStmtSyntax>())
@@ -0,0 +1,321 @@
+// backend.cpp - Benchmarks of HLIR construction and code generation
+#include "bench_runner.hpp"
+#include "bench_util.hpp"
+#include "compiler.hpp"
+#include "jit.hpp"
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+
+namespace Fern {
+
+// Straight-line arithmetic on one variable; each statement lowers to four instructions
+static std::string generate_straight_line_source(size_t statements) {
+    std::stringstream source;
+    source << "fn Main\n{\n    var x = 1\n";
+    for (size_t i = 0; i < statements; i++) {
+        source << "    x = x * " << (i % 7 + 2) << " + " << (i % 100) << "\n";
+    }
+    source << "    return x\n}\n";
+    return source.str();
+}
+
+HLIRBenchResult BenchRunner::run_hlir_benchmark(size_t instruction_count) {
+    HLIRBenchResult result;
+    result.statements = std::max<size_t>(1, instruction_count / 4);
+    std::string source = generate_straight_line_source(result.statements);
+
+    std::cout << "Compiling a generated Main with " << result.statements << " statements ("
+              << iterations << " iterations)...\n" << std::endl;
+
+    for (int i = 0; i < iterations; i++) {
+        try {
+            Compiler compiler;
+            compiler.set_print_ast(false);
+            compiler.set_print_symbols(false);
+            compiler.set_print_hlir(false);
+
+            auto compiled = compiler.compile(std::vector<SourceFile>{{"generated.fn", source}});
+            if (!compiled || !compiled->is_valid()) {
+                result.error_message = "compile failed";
+                return result;
+            }
+
+            const auto& timings = compiler.get_timings();
+            result.instructions = timings.hlir_instructions;
+            if (i == 0 || timings.hlir_ms < result.hlir_ms) {
+                result.hlir_ms = timings.hlir_ms;
+            }
+            if (i == 0 || timings.codegen_ms < result.codegen_ms) {
+                result.codegen_ms = timings.codegen_ms;
+            }
+        } catch (const std::exception& e) {
+            result.error_message = std::string("exception: ") + e.what();
+            return result;
+        }
+    }
+
+    result.ok = true;
+    return result;
+}
+
+void BenchRunner::print_hlir_summary(const HLIRBenchResult& result) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "HLIR BENCHMARK (ms, best of " << iterations << ")" << std::endl;
+    std::cout << "========================================" << std::endl;
+    if (!result.ok) {
+        std::cout << "ERROR: " << result.error_message << std::endl;
+        return;
+    }
+
+    auto per_instruction_ns = [&](double ms) {
+        return result.instructions ? ms * 1e6 / result.instructions : 0.0;
+    };
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "HLIR instructions: " << result.instructions << std::endl;
+    std::cout << "HLIR construction: " << result.hlir_ms << " ms ("
+              << per_instruction_ns(result.hlir_ms) << " ns/instruction)" << std::endl;
+    std::cout << "LLVM lowering:     " << result.codegen_ms << " ms ("
+              << per_instruction_ns(result.codegen_ms) << " ns/instruction)" << std::endl;
+    std::cout << std::defaultfloat;
+    std::cout << "========================================" << std::endl;
+}
+
+// Groups of functions that call down a chain, so the call graph has clusters worth keeping
+// together. Each function is `statements` lines of float math ending in a call to the next.
+static std::string generate_call_graph_source(size_t functions, size_t statements) {
+    const size_t chain = 8;
+    std::stringstream source;
+    for (size_t f = 0; f < functions; f++) {
+        source << "fn F" << f << "(f32 x) -> f32\n{\n    f32 y = x\n";
+        for (size_t i = 0; i < statements; i++) {
+            source << "    y = y * 0.5 + " << ((f + i) % 10) << ".0\n";
+        }
+        if (f % chain != 0) {
+            source << "    return F" << (f - 1) << "(y)\n}\n";
+        } else {
+            source << "    return y\n}\n";
+        }
+    }
+
+    source << "fn Main -> f32\n{\n    f32 total = 0.0\n";
+    for (size_t f = chain - 1; f < functions; f += chain) {
+        source << "    total = total + F" << f << "(1.0)\n";
+    }
+    source << "    return total\n}\n";
+    return source.str();
+}
+
+std::vector<CodegenBenchResult> BenchRunner::run_codegen_benchmark(size_t functions, unsigned max_threads) {
+    std::vector<CodegenBenchResult> results;
+    size_t statements = 50;
+    std::string source = generate_call_graph_source(std::max<size_t>(functions, 8), statements);
+
+    if (max_threads == 0) {
+        max_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::cout << "Compiling " << std::max<size_t>(functions, 8) << " generated functions at -O2 ("
+              << iterations << " iterations, " << std::thread::hardware_concurrency()
+              << " hardware threads)...\n" << std::endl;
+
+    // Powers of two, then max_threads itself
+    std::vector<unsigned> thread_counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    for (unsigned threads : thread_counts) {
+        CodegenBenchResult result;
+        result.threads = threads;
+
+        for (int i = 0; i < iterations; i++) {
+            try {
+                Compiler compiler;
+                compiler.set_print_ast(false);
+                compiler.set_print_symbols(false);
+                compiler.set_print_hlir(false);
+                compiler.set_opt_level(2);
+                compiler.set_codegen_threads(threads);
+
+                auto compiled = compiler.compile(std::vector<SourceFile>{{"generated.fn", source}});
+                if (!compiled || !compiled->is_valid()) {
+                    result.error_message = "compile failed";
+                    break;
+                }
+
+                // Main's lookup pulls in every partition, so this times machine code generation
+                auto start = Clock::now();
+                JIT jit(compiled->get_jit_mode(), compiled->get_thread_count());
+                auto main_func = compiled->add_to_jit(jit) ? jit.get_function<float()>("Main") : nullptr;
+                double jit_ms = elapsed_ms(start);
+                if (!main_func) {
+                    result.error_message = "Main not found";
+                    break;
+                }
+
+                const auto& timings = compiler.get_timings();
+                double total_ms = timings.codegen_ms + timings.optimize_ms + jit_ms;
+                if (i == 0 || total_ms < result.codegen_ms + result.optimize_ms + result.jit_ms) {
+                    result.codegen_ms = timings.codegen_ms;
+                    result.optimize_ms = timings.optimize_ms;
+                    result.jit_ms = jit_ms;
+                }
+                result.partitions = compiled->get_parts().size();
+                result.return_value = main_func();
+                result.ok = true;
+            } catch (const std::exception& e) {
+                result.error_message = std::string("exception: ") + e.what();
+                result.ok = false;
+                break;
+            }
+        }
+
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+void BenchRunner::print_codegen_summary(const std::vector<CodegenBenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "PARALLEL CODEGEN (ms, best of " << iterations << ")" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::cout << std::left << std::setw(9) << "threads" << std::setw(7) << "parts"
+              << std::right << std::setw(10) << "lower" << std::setw(10) << "optimize"
+              << std::setw(10) << "jit" << std::setw(10) << "total" << std::setw(10) << "speedup"
+              << std::endl;
+
+    double baseline = 0.0;
+    for (const auto& result : results) {
+        if (!result.ok) {
+            std::cout << std::left << std::setw(9) << result.threads << "ERROR: " << result.error_message
+                      << std::endl;
+            continue;
+        }
+
+        double total = result.codegen_ms + result.optimize_ms + result.jit_ms;
+        if (baseline == 0.0) {
+            baseline = total;
+        }
+
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << std::left << std::setw(9) << result.threads << std::setw(7) << result.partitions
+                  << std::right << std::setw(10) << result.codegen_ms << std::setw(10) << result.optimize_ms
+                  << std::setw(10) << result.jit_ms << std::setw(10) << total
+                  << std::setw(9) << std::setprecision(2) << baseline / total << "x" << std::endl;
+        std::cout << std::defaultfloat;
+    }
+
+    // Partitioning must not change what the program computes
+    bool consistent = std::all_of(results.begin(), results.end(), [&](const CodegenBenchResult& r) {
+        return !r.ok || r.return_value == results.front().return_value;
+    });
+    std::cout << "Results " << (consistent ? "match" : "DIFFER") << " across thread counts" << std::endl;
+    std::cout << "========================================" << std::endl;
+}
+
+// Loop nests `depth` deep, one per ten locals. Every loop touches three locals and a branch
+// one more, so the work done per loop doesn't depend on how many locals there are
+static std::string generate_ssa_source(size_t locals, size_t depth, size_t& loops) {
+    std::stringstream source;
+    source << "fn Main\n{\n";
+    for (size_t v = 0; v < locals; v++) {
+        source << "    var v" << v << " = " << (v % 10) << "\n";
+    }
+
+    loops = 0;
+    size_t nests = std::max<size_t>(1, locals / 10);
+    for (size_t n = 0; n < nests; n++) {
+        for (size_t d = 0; d < depth; d++) {
+            std::string indent(4 * (d + 1), ' ');
+            std::string counter = "c" + std::to_string(n) + "_" + std::to_string(d);
+            size_t first = (loops * 3) % locals;
+            source << indent << "var " << counter << " = 0\n"
+                   << indent << "while " << counter << " < 2\n" << indent << "{\n"
+                   << indent << "    v" << first << " = v" << first << " + " << counter << "\n"
+                   << indent << "    v" << (first + 1) % locals << " = v" << (first + 2) % locals << " * 2\n"
+                   << indent << "    if v" << first << " > 100\n" << indent << "    {\n"
+                   << indent << "        v" << (first + 3) % locals << " = 0\n" << indent << "    }\n"
+                   << indent << "    " << counter << " = " << counter << " + 1\n";
+            loops++;
+        }
+        for (size_t d = depth; d-- > 0;) {
+            source << std::string(4 * (d + 1), ' ') << "}\n";
+        }
+    }
+
+    source << "    return v0 + v" << locals / 2 << " + v" << locals - 1 << "\n}\n";
+    return source.str();
+}
+
+std::vector<SSABenchResult> BenchRunner::run_ssa_benchmark(size_t locals, size_t depth) {
+    std::vector<SSABenchResult> results;
+    locals = std::max<size_t>(locals, 4);
+    depth = std::max<size_t>(depth, 1);
+    std::cout << "Building HLIR for nests of " << depth << " loops over " << locals << " and " << locals * 2
+              << " locals (" << iterations << " iterations)...\n" << std::endl;
+
+    for (size_t size : {locals, locals * 2}) {
+        SSABenchResult result;
+        result.locals = size;
+        std::string source = generate_ssa_source(size, depth, result.loops);
+
+        for (int i = 0; i < iterations; i++) {
+            try {
+                Compiler compiler;
+                compiler.set_print_ast(false);
+                compiler.set_print_symbols(false);
+                compiler.set_print_hlir(false);
+
+                auto compiled = compiler.compile(std::vector<SourceFile>{{"generated.fn", source}});
+                if (!compiled || !compiled->is_valid()) {
+                    result.error_message = "compile failed";
+                    break;
+                }
+
+                const auto& timings = compiler.get_timings();
+                result.instructions = timings.hlir_instructions;
+                result.phis = timings.hlir_phis;
+                if (i == 0 || timings.hlir_ms < result.hlir_ms) {
+                    result.hlir_ms = timings.hlir_ms;
+                }
+                result.ok = true;
+            } catch (const std::exception& e) {
+                result.error_message = std::string("exception: ") + e.what();
+                result.ok = false;
+                break;
+            }
+        }
+        results.push_back(result);
+    }
+    return results;
+}
+
+void BenchRunner::print_ssa_summary(const std::vector<SSABenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "SSA BENCHMARK (HLIR construction, ms best of " << iterations << ")" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::right << std::setw(8) << "locals" << std::setw(8) << "loops" << std::setw(14) << "instructions"
+              << std::setw(10) << "phis" << std::setw(12) << "phis/loop" << std::setw(10) << "hlir" << std::endl;
+
+    for (const auto& result : results) {
+        std::cout << std::setw(8) << result.locals;
+        if (!result.ok) {
+            std::cout << "  ERROR: " << result.error_message << std::endl;
+            continue;
+        }
+        double per_loop = result.loops ? double(result.phis) / result.loops : 0.0;
+        std::cout << std::setw(8) << result.loops << std::setw(14) << result.instructions << std::setw(10)
+                  << result.phis << std::fixed << std::setprecision(2) << std::setw(12) << per_loop
+                  << std::setprecision(3) << std::setw(10) << result.hlir_ms << std::defaultfloat << std::endl;
+    }
+    std::cout << "========================================" << std::endl;
+}
+
+} // namespace Fern
@@ -0,0 +1,303 @@
+// bench_runner.cpp - Benchmark programs timed under each config, and the vectorization check
+#include "bench_runner.hpp"
+#include "bench_util.hpp"
+#include "compiler.hpp"
+#include "jit.hpp"
+#include <filesystem>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+namespace fs = std::filesystem;
+
+namespace Fern {
+
+bool BenchResult::passed() const {
+    if (timings.empty()) {
+        return false;
+    }
+    for (const auto& timing : timings) {
+        if (!timing.ok || timing.return_value != timings[0].return_value) {
+            return false;
+        }
+    }
+    return !expected || std::fabs(*expected - timings[0].return_value) <= std::fabs(*expected) * 1e-6f;
+}
+
+BenchRunner::BenchRunner(int iterations) : iterations(std::max(1, iterations)) {
+    configs = {
+        {"baseline", [](Compiler& compiler) {
+            compiler.set_optimize_loops(false);
+            compiler.set_const_eval(false);
+        }},
+        {"loop-opt", [](Compiler& compiler) {
+            compiler.set_optimize_loops(true);
+            compiler.set_const_eval(false);
+        }},
+        {"const-eval", [](Compiler& compiler) {
+            compiler.set_optimize_loops(true);
+            compiler.set_const_eval(true);
+        }},
+    };
+}
+
+BenchTiming BenchRunner::run_config(const BenchConfig& config, const std::string& bench_file,
+                                    const std::string& source, std::string& error) {
+    BenchTiming timing;
+
+    try {
+        Compiler compiler;
+        compiler.set_print_ast(false);
+        compiler.set_print_symbols(false);
+        compiler.set_print_hlir(false);
+        if (config.configure) {
+            config.configure(compiler);
+        }
+
+        auto start = Clock::now();
+        auto compiled = compiler.compile(std::vector<SourceFile>{{bench_file, source}});
+        timing.compile_ms = elapsed_ms(start);
+
+        if (!compiled || !compiled->is_valid()) {
+            std::stringstream ss;
+            ss << config.name << ": compile failed";
+            if (compiled) {
+                for (const auto& e : compiled->get_errors()) {
+                    ss << "; " << e;
+                }
+            }
+            error = ss.str();
+            return timing;
+        }
+
+        // Same hand-off as CompiledModule::execute_jit, but kept alive so the
+        // compile and the calls can be timed separately
+        start = Clock::now();
+        JIT jit(compiled->get_jit_mode(), compiled->get_thread_count());
+        if (!compiled->add_to_jit(jit)) {
+            error = config.name + ": failed to add module to JIT";
+            return timing;
+        }
+        auto main_func = jit.get_function<float()>("Main");
+        timing.jit_ms = elapsed_ms(start);
+
+        if (!main_func) {
+            error = config.name + ": Main not found";
+            return timing;
+        }
+
+        timing.run_ms = -1.0;
+        for (int i = 0; i < iterations; i++) {
+            start = Clock::now();
+            timing.return_value = main_func();
+            double run = elapsed_ms(start);
+            if (timing.run_ms < 0.0 || run < timing.run_ms) {
+                timing.run_ms = run;
+            }
+        }
+        timing.ok = true;
+    } catch (const std::exception& e) {
+        error = config.name + ": exception: " + e.what();
+    }
+
+    return timing;
+}
+
+BenchResult BenchRunner::run_single_benchmark(const std::string& bench_file) {
+    BenchResult result(fs::path(bench_file).filename().string());
+
+    std::string source;
+    try {
+        source = read_file(bench_file);
+    } catch (const std::exception& e) {
+        result.error_message = e.what();
+        return result;
+    }
+    result.expected = parse_expected(source);
+
+    for (const auto& config : configs) {
+        std::string error;
+        result.timings.push_back(run_config(config, bench_file, source, error));
+        if (!error.empty() && result.error_message.empty()) {
+            result.error_message = error;
+        }
+    }
+
+    return result;
+}
+
+std::vector<BenchResult> BenchRunner::run_all_benchmarks(const std::string& bench_dir) {
+    std::vector<BenchResult> results;
+    std::vector<std::string> bench_files;
+
+    try {
+        for (const auto& entry : fs::directory_iterator(bench_dir)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".fn") {
+                bench_files.push_back(entry.path().string());
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error scanning benchmark directory: " << e.what() << std::endl;
+        return results;
+    }
+
+    std::sort(bench_files.begin(), bench_files.end());
+
+    std::cout << "Running " << bench_files.size() << " benchmarks from " << bench_dir
+              << " (" << iterations << " iterations, " << configs.size() << " configs)...\n" << std::endl;
+
+    int bench_num = 0;
+    for (const auto& bench_file : bench_files) {
+        bench_num++;
+        std::cout << "[" << bench_num << "/" << bench_files.size() << "] "
+                  << fs::path(bench_file).filename().string() << "... " << std::flush;
+
+        results.push_back(run_single_benchmark(bench_file));
+        const auto& result = results.back();
+
+        if (result.passed()) {
+            std::cout << "OK (returned " << result.timings[0].return_value << ")" << std::endl;
+        } else if (!result.error_message.empty()) {
+            std::cout << "ERROR: " << result.error_message << std::endl;
+        } else {
+            std::cout << "MISMATCH:";
+            for (size_t i = 0; i < result.timings.size(); i++) {
+                std::cout << " " << configs[i].name << "=" << result.timings[i].return_value;
+            }
+            if (result.expected) {
+                std::cout << " expected=" << *result.expected;
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    return results;
+}
+
+void BenchRunner::print_summary(const std::vector<BenchResult>& results) {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "BENCHMARK SUMMARY (ms, best of " << iterations << ")" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::cout << std::left << std::setw(24) << "benchmark";
+    for (const auto& config : configs) {
+        std::cout << std::right << std::setw(16) << (config.name + " run")
+                  << std::setw(16) << (config.name + " jit");
+    }
+    std::cout << std::right << std::setw(10) << "speedup" << std::endl;
+
+    std::cout << std::fixed << std::setprecision(3);
+    int passed = 0;
+    for (const auto& result : results) {
+        if (result.passed()) {
+            passed++;
+        }
+
+        std::cout << std::left << std::setw(24) << result.bench_name << std::right;
+        for (const auto& timing : result.timings) {
+            std::cout << std::setw(16) << timing.run_ms << std::setw(16) << timing.jit_ms;
+        }
+
+        const auto& base = result.timings.front();
+        const auto& last = result.timings.back();
+        if (result.passed() && last.run_ms > 0.0) {
+            std::cout << std::setw(9) << std::setprecision(2) << base.run_ms / last.run_ms << "x"
+                      << std::setprecision(3);
+        } else {
+            std::cout << std::setw(10) << "-";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << std::defaultfloat;
+
+    std::cout << "\nTotal benchmarks: " << results.size() << std::endl;
+    std::cout << "Passed: " << passed << std::endl;
+    std::cout << "Failed: " << results.size() - passed << std::endl;
+    std::cout << "========================================" << std::endl;
+}
+
+std::vector<VectorizationCheck> BenchRunner::check_vectorization(const std::string& dir) {
+    std::vector<VectorizationCheck> results;
+    std::vector<std::string> files;
+
+    try {
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".fn") {
+                files.push_back(entry.path().string());
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error scanning directory: " << e.what() << std::endl;
+        return results;
+    }
+
+    std::sort(files.begin(), files.end());
+    std::cout << "Checking vectorization at -O3 for " << files.size() << " files from " << dir << "...\n" << std::endl;
+
+    for (const auto& file : files) {
+        VectorizationCheck check(fs::path(file).filename().string());
+
+        try {
+            Compiler compiler;
+            compiler.set_print_ast(false);
+            compiler.set_print_symbols(false);
+            compiler.set_print_hlir(false);
+
+            auto compiled = compiler.compile(std::vector<SourceFile>{{file, read_file(file)}});
+            if (compiled && compiled->is_valid()) {
+                check.compiled = compiled->optimize(3, &check.report);
+                if (!check.compiled) {
+                    check.error_message = "optimization failed";
+                }
+            } else {
+                check.error_message = "compile failed";
+            }
+        } catch (const std::exception& e) {
+            check.error_message = std::string("exception: ") + e.what();
+        }
+
+        std::cout << "  " << std::left << std::setw(24) << check.file_name << std::right;
+        if (!check.compiled) {
+            std::cout << "SKIP (" << check.error_message << ")" << std::endl;
+        } else {
+            std::cout << check.report.loops_vectorized << " loops vectorized, "
+                      << check.report.slp_vectorized << " SLP, "
+                      << check.report.forced_failures << " forced failures" << std::endl;
+            for (const auto& message : check.report.failure_messages) {
+                std::cout << "      " << message << std::endl;
+            }
+        }
+
+        results.push_back(std::move(check));
+    }
+
+    return results;
+}
+
+void BenchRunner::print_vectorization_summary(const std::vector<VectorizationCheck>& results) {
+    int compiled = 0;
+    int loops = 0;
+    int slp = 0;
+    int failures = 0;
+    for (const auto& result : results) {
+        if (!result.compiled) {
+            continue;
+        }
+        compiled++;
+        loops += result.report.loops_vectorized;
+        slp += result.report.slp_vectorized;
+        failures += result.report.forced_failures;
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "VECTORIZATION SUMMARY (-O3)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Files checked: " << compiled << " of " << results.size() << std::endl;
+    std::cout << "Loops vectorized: " << loops << std::endl;
+    std::cout << "SLP vectorized: " << slp << std::endl;
+    std::cout << "Forced loops left scalar: " << failures << std::endl;
+    std::cout << "========================================" << std::endl;
+}
+
+} // namespace Fern
@@ -0,0 +1,474 @@
+#pragma once
+
+#include "compiled_module.hpp"
+#include <cmath>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Fern {
+
+class Compiler;
+
+// One way of compiling every benchmark (e.g. with or without an optimization)
+struct BenchConfig {
+    std::string name;
+    std::function<void(Compiler&)> configure;
+};
+
+struct BenchTiming {
+    bool ok;
+    float return_value;
+    double compile_ms;  // source to LLVM IR
+    double jit_ms;      // LLVM IR to machine code
+    double run_ms;      // fastest call to Main
+
+    BenchTiming()
+        : ok(false), return_value(0.0f), compile_ms(0.0), jit_ms(0.0), run_ms(0.0) {}
+};
+
+struct BenchResult {
+    std::string bench_name;
+    std::optional<float> expected;     // from an "-- Expected: <value>" header comment
+    std::vector<BenchTiming> timings;  // one per config, in config order
+    std::string error_message;
+
+    BenchResult(const std::string& name) : bench_name(name) {}
+
+    bool passed() const;
+};
+
+// Result of compiling one file at -O3 and collecting vectorizer remarks
+struct VectorizationCheck {
+    std::string file_name;
+    bool compiled;
+    std::string error_message;
+    VectorizationReport report;
+
+    VectorizationCheck(const std::string& name) : file_name(name), compiled(false) {}
+
+    // Files that don't compile are skipped rather than failed; that's the test runner's job
+    bool passed() const { return !compiled || report.forced_failures == 0; }
+};
+
+// Back end throughput on one generated straight-line function
+struct HLIRBenchResult {
+    bool ok;
+    size_t statements;
+    size_t instructions;  // HLIR instructions after BoundToHLIR
+    double hlir_ms;       // bound tree to HLIR, fastest run
+    double codegen_ms;    // HLIRCodeGen::lower, fastest run
+    std::string error_message;
+
+    HLIRBenchResult() : ok(false), statements(0), instructions(0), hlir_ms(0.0), codegen_ms(0.0) {}
+};
+
+// Front-to-machine-code time of a generated multi-function program at one thread count
+struct CodegenBenchResult {
+    bool ok;
+    unsigned threads;
+    size_t partitions;
+    double codegen_ms;   // HLIR to LLVM IR, all partitions
+    double optimize_ms;  // LLVM -O2 pipeline, all partitions
+    double jit_ms;       // LLVM IR to machine code on the JIT's compile threads
+    float return_value;
+    std::string error_message;
+
+    CodegenBenchResult()
+        : ok(false), threads(1), partitions(0), codegen_ms(0.0), optimize_ms(0.0), jit_ms(0.0),
+          return_value(0.0f) {}
+};
+
+// Time to first result for a program that links the standard library but calls one function
+struct StartupBenchResult {
+    bool ok;
+    std::string mode;
+    double jit_ms;         // adding the modules and looking up Main
+    double first_call_ms;  // first call to Main, including any lazy compilation it triggers
+    float return_value;
+    std::string error_message;
+
+    StartupBenchResult() : ok(false), jit_ms(0.0), first_call_ms(0.0), return_value(0.0f) {}
+
+    double startup_ms() const { return jit_ms + first_call_ms; }
+};
+
+// Cumulative time over repeated calls to one hot function under one JIT configuration
+struct TieredBenchResult {
+    bool ok;
+    std::string mode;
+    double jit_ms;                   // adding the modules and looking up the function
+    std::vector<double> elapsed_ms;  // after each call, JIT time included
+    double steady_us;                // fastest call over the last tenth
+    size_t tier_ups;
+    double tier_up_compile_ms;       // background -O3 compile, summed over tier-ups
+    float return_value;
+    std::string error_message;
+
+    TieredBenchResult()
+        : ok(false), jit_ms(0.0), steady_us(0.0), tier_ups(0), tier_up_compile_ms(0.0), return_value(0.0f) {}
+};
+
+// End-to-end time of one program compiled and run with the JIT and with the bytecode interpreter
+struct InterpreterBenchResult {
+    std::string file_name;
+    bool jit_ok;
+    bool interpreter_ok;
+    double jit_compile_ms;          // source to LLVM IR
+    double jit_run_ms;              // LLVM IR to machine code, then one call to Main
+    double interpreter_compile_ms;  // source to bytecode
+    double interpreter_run_ms;      // one call to Main in a fresh interpreter
+    float jit_value;
+    float interpreter_value;
+    std::string error_message;
+
+    InterpreterBenchResult(const std::string& name)
+        : file_name(name), jit_ok(false), interpreter_ok(false), jit_compile_ms(0.0), jit_run_ms(0.0),
+          interpreter_compile_ms(0.0), interpreter_run_ms(0.0), jit_value(0.0f), interpreter_value(0.0f) {}
+
+    double jit_total_ms() const { return jit_compile_ms + jit_run_ms; }
+    double interpreter_total_ms() const { return interpreter_compile_ms + interpreter_run_ms; }
+
+    // Files the JIT can't run either are skipped rather than failed; that's the test runner's job
+    bool ok() const {
+        return !jit_ok || (interpreter_ok && (jit_value == interpreter_value ||
+                                              (std::isnan(jit_value) && std::isnan(interpreter_value))));
+    }
+};
+
+// Process start to exit for one program run through the JIT and as a native executable
+struct ExeBenchResult {
+    std::string file_name;
+    bool jit_ok;
+    bool exe_ok;
+    double build_ms;       // source to linked executable
+    double jit_start_ms;   // `Fern <file> <std>` from launch to exit
+    double exe_start_ms;   // the executable from launch to exit
+    int jit_exit;
+    int exe_exit;
+    std::string error_message;
+
+    ExeBenchResult(const std::string& name)
+        : file_name(name), jit_ok(false), exe_ok(false), build_ms(0.0), jit_start_ms(0.0), exe_start_ms(0.0),
+          jit_exit(0), exe_exit(0) {}
+
+    // Programs the JIT can't run either are skipped rather than failed
+    bool ok() const { return !jit_ok || (exe_ok && jit_exit == exe_exit); }
+};
+
+// Rows per second for one way of evaluating a Fern function over a batch of rows
+struct BatchBenchResult {
+    bool ok;
+    std::string mode;
+    size_t rows;        // rows actually run; the execute_jit loop runs a sample
+    double setup_ms;    // building the JIT (for batches, what a one-row batch costs)
+    double run_ms;      // every row; includes setup for batches, which build a JIT per call
+    bool matches;       // same results as the host loop over a function pointer
+    std::string error_message;
+
+    BatchBenchResult() : ok(false), rows(0), setup_ms(0.0), run_ms(0.0), matches(false) {}
+
+    double rows_per_second() const { return run_ms > 0.0 ? rows / (run_ms / 1000.0) : 0.0; }
+};
+
+// One program at -O2, timed without a profile and with one collected from an instrumented run
+struct PGOBenchResult {
+    std::string file_name;
+    BenchTiming plain;
+    BenchTiming instrumented;   // the run that wrote the profile
+    BenchTiming optimized;      // rebuilt with --profile-use
+    std::optional<float> expected;
+    std::string error_message;
+
+    PGOBenchResult(const std::string& name) : file_name(name) {}
+
+    bool ok() const {
+        return plain.ok && instrumented.ok && optimized.ok &&
+               plain.return_value == optimized.return_value &&
+               instrumented.return_value == plain.return_value &&
+               (!expected || std::fabs(*expected - plain.return_value) <= std::fabs(*expected) * 1e-6f);
+    }
+};
+
+// Compile-and-call of many small snippets that use the standard library, in one process
+struct SessionBenchResult {
+    bool ok;
+    std::string mode;
+    size_t snippets;     // snippets actually run; fresh compiles run a sample
+    double setup_ms;     // creating the session; 0 for fresh compiles
+    double total_ms;     // compiling and calling every snippet
+    double late_ms;      // per snippet over the last tenth, to show a session doesn't slow down
+    bool matches;        // every snippet returned what the host computed
+    std::string error_message;
+
+    SessionBenchResult() : ok(false), snippets(0), setup_ms(0.0), total_ms(0.0), late_ms(0.0), matches(false) {}
+
+    double per_snippet_ms() const { return snippets > 0 ? total_ms / snippets : 0.0; }
+};
+
+// Heap allocations made through operator new so far, or nullopt when they aren't counted.
+// Defined by the executable (main.cpp): only the FernBench build counts, so neither Fern nor a
+// host that links FernCore has its allocator replaced
+std::optional<size_t> heap_allocation_count();
+
+// Heap allocations made by BoundTreeBuilder::bind on one generated file
+struct BindBenchResult {
+    bool ok;
+    size_t statements;
+    size_t nodes;         // bound nodes made
+    std::optional<size_t> allocations; // heap allocations during bind, if counted
+    size_t arena_chunks;  // of those, new arena chunks
+    size_t names;         // distinct names interned
+    double bind_ms;       // fastest bind
+    std::string error_message;
+
+    BindBenchResult()
+        : ok(false), statements(0), nodes(0), arena_chunks(0), names(0), bind_ms(0.0) {}
+
+    double allocations_per_node() const { return nodes > 0 && allocations ? double(*allocations) / nodes : 0.0; }
+};
+
+// HLIR construction for one generated function of nested loops over many locals
+struct SSABenchResult {
+    bool ok;
+    size_t locals;
+    size_t loops;
+    size_t instructions;  // HLIR instructions after BoundToHLIR
+    size_t phis;          // of those, phis
+    double hlir_ms;       // bound tree to HLIR, fastest run
+    std::string error_message;
+
+    SSABenchResult() : ok(false), locals(0), loops(0), instructions(0), phis(0), hlir_ms(0.0) {}
+};
+
+// didChange -> publishDiagnostics latency in the language server over a generated workspace
+struct LSPBenchResult {
+    bool ok;
+    std::string edit;       // "open" for loading the workspace, else the kind of edit
+    size_t files;
+    size_t edits;
+    double files_analyzed;  // files bound and resolved per edit, on average
+    double p50_ms;
+    double p99_ms;
+    double max_ms;
+    std::string error_message;
+
+    LSPBenchResult() : ok(false), files(0), edits(0), files_analyzed(0.0), p50_ms(0.0), p99_ms(0.0), max_ms(0.0) {}
+};
+
+// Single-character edits to one large file: parsed whole each time, or reparsed incrementally
+struct ReparseBenchResult {
+    bool ok;
+    std::string mode;     // "full" (lex and parse) or "reparse"
+    size_t lines;
+    size_t edits;
+    double reused;        // top-level declarations taken from the previous tree, on average
+    double p50_ms;
+    double p99_ms;
+    std::string error_message;
+
+    ReparseBenchResult() : ok(false), lines(0), edits(0), reused(0.0), p50_ms(0.0), p99_ms(0.0) {}
+};
+
+// Lexing and parsing one large generated file, in tokens per second
+struct ParseBenchResult {
+    bool ok;
+    std::string source;   // "declarations" (types and small functions) or "statements" (long bodies)
+    size_t bytes;
+    size_t tokens;
+    double lex_ms;        // fastest run
+    double parse_ms;
+    std::string error_message;
+
+    ParseBenchResult() : ok(false), bytes(0), tokens(0), lex_ms(0.0), parse_ms(0.0) {}
+
+    double lex_tokens_per_second() const { return lex_ms > 0.0 ? tokens / (lex_ms / 1000.0) : 0.0; }
+    double parse_tokens_per_second() const { return parse_ms > 0.0 ? tokens / (parse_ms / 1000.0) : 0.0; }
+};
+
+// Parsing input that sends the parser down the same speculative paths again and again
+struct MemoBenchResult {
+    bool ok;
+    std::string shape;    // "comparisons" (a < b < c ...) or "initializers" (nested lambdas in var initializers)
+    size_t size;          // comparisons in the chain, or nesting depth
+    bool memoized;
+    double ms;
+    size_t hits;
+    size_t misses;
+    std::string error_message;
+
+    MemoBenchResult() : ok(false), size(0), memoized(false), ms(0.0), hits(0), misses(0) {}
+};
+
+// Formatting a corpus of Fern files held in memory, or checking that formatting is idempotent
+struct FmtBenchResult {
+    bool ok;
+    std::string mode;     // "1 thread", "N threads" or "idempotent"
+    size_t files;
+    size_t bytes;
+    size_t changed;       // files whose formatted text differs from their source
+    double ms;
+    std::string error_message;
+
+    FmtBenchResult() : ok(false), files(0), bytes(0), changed(0), ms(0.0) {}
+};
+
+// One tree pass over a generated file, reaching each node's visit() through a switch on its
+// kind tag and through virtual accept()
+struct DispatchBenchResult {
+    bool ok;
+    std::string pass;     // declare, bind, resolve, lower or print
+    size_t statements;
+    double switch_ms;     // fastest run
+    double virtual_ms;
+    bool matches;         // both ways printed the same AST and lowered the same HLIR
+    std::string error_message;
+
+    DispatchBenchResult() : ok(false), statements(0), switch_ms(0.0), virtual_ms(0.0), matches(false) {}
+};
+
+// Loading a generated corpus into SourceFiles and compile states, then reading every byte once
+// as the lexer would
+struct LoadBenchResult {
+    bool ok;
+    std::string mode;     // "stringstream" (read and copied by value, as before) or "mapped"
+    size_t files;
+    size_t bytes;
+    double load_ms;       // fastest run: files into SourceFiles, SourceFiles into compile states
+    double scan_ms;       // fastest run: one pass over all the text
+    size_t peak_bytes;    // growth of peak resident memory over the run, 0 where it can't be read
+    uint64_t checksum;    // of the scanned text, the same in both modes
+    std::string error_message;
+
+    LoadBenchResult()
+        : ok(false), files(0), bytes(0), load_ms(0.0), scan_ms(0.0), peak_bytes(0), checksum(0) {}
+};
+
+class BenchRunner {
+public:
+    // Runs Main `iterations` times per config and keeps the fastest run.
+    // The first config is the baseline the others are compared against.
+    BenchRunner(int iterations = 5);
+
+    void set_configs(std::vector<BenchConfig> new_configs) { configs = std::move(new_configs); }
+    const std::vector<BenchConfig>& get_configs() const { return configs; }
+
+    // Run all benchmarks in the specified directory
+    std::vector<BenchResult> run_all_benchmarks(const std::string& bench_dir);
+
+    // Print a timing table with speedups relative to the baseline config
+    void print_summary(const std::vector<BenchResult>& results);
+
+    // Compile every file in the directory at -O3 and check that the loops codegen
+    // asked to vectorize actually were
+    std::vector<VectorizationCheck> check_vectorization(const std::string& dir);
+    void print_vectorization_summary(const std::vector<VectorizationCheck>& results);
+
+    // Compile a generated Main of roughly `instruction_count` HLIR instructions and time
+    // HLIR construction and lowering to LLVM IR
+    HLIRBenchResult run_hlir_benchmark(size_t instruction_count);
+    void print_hlir_summary(const HLIRBenchResult& result);
+
+    // Compile a generated program of about `functions` functions with 1, 2, 4 ... up to
+    // `max_threads` codegen threads (0 means the hardware thread count)
+    std::vector<CodegenBenchResult> run_codegen_benchmark(size_t functions, unsigned max_threads = 0);
+    void print_codegen_summary(const std::vector<CodegenBenchResult>& results);
+
+    // Compile the standard library with a Main that calls one of its functions, then time
+    // JIT startup with eager and with lazy compilation
+    std::vector<StartupBenchResult> run_startup_benchmark(const std::string& std_file);
+    void print_startup_summary(const std::vector<StartupBenchResult>& results);
+
+    // Call a generated loop-heavy function `calls` times at -O0, at -O3 and with the tiered
+    // JIT, recording how total time grows from the first call to the steady state
+    std::vector<TieredBenchResult> run_tiered_benchmark(size_t calls);
+    void print_tiered_summary(const std::vector<TieredBenchResult>& results);
+
+    // Compile and run every file in the directory, linked with the standard library, once
+    // through the JIT and once through the bytecode interpreter, keeping the fastest of each
+    std::vector<InterpreterBenchResult> run_interpreter_benchmark(const std::string& dir, const std::string& std_file);
+    void print_interpreter_summary(const std::vector<InterpreterBenchResult>& results);
+
+    // Run every program in the directory, linked with the standard library, as a fresh
+    // `fern_binary` process and as a native executable built at `opt_level`, timing each
+    // from launch to exit and comparing exit codes
+    std::vector<ExeBenchResult> run_exe_benchmark(const std::string& fern_binary, const std::string& dir,
+                                                  const std::string& std_file, unsigned opt_level = 2);
+    void print_exe_summary(const std::vector<ExeBenchResult>& results);
+
+    // Evaluate a two-argument function over `rows` rows at -O2 with a host loop over
+    // execute_jit, a host loop over a JIT'd function pointer, and execute_batch on 1 and
+    // `threads` threads (0 means the hardware thread count)
+    std::vector<BatchBenchResult> run_batch_benchmark(size_t rows, unsigned threads = 0);
+    void print_batch_summary(const std::vector<BatchBenchResult>& results);
+
+    // Build the program at -O2 plainly, then instrumented to collect a profile, then at -O2
+    // with that profile, and compare the plain and profile-guided run times
+    PGOBenchResult run_pgo_benchmark(const std::string& bench_file);
+    void print_pgo_summary(const PGOBenchResult& result);
+
+    // Compile `snippets` small functions that call into the standard library and call each
+    // once: with Compiler::compile and execute_jit per snippet, then with one Session
+    std::vector<SessionBenchResult> run_session_benchmark(size_t snippets, const std::string& std_file);
+    void print_session_summary(const std::vector<SessionBenchResult>& results);
+
+    // Bind a generated file of `statements` statements and one twice that size, counting heap
+    // allocations; the names are the same in both, so any growth is per node
+    std::vector<BindBenchResult> run_bind_benchmark(size_t statements);
+    void print_bind_summary(const std::vector<BindBenchResult>& results);
+
+    // Build HLIR for a Main of `locals` locals and nests of `depth` loops, each loop updating
+    // a few of them, then again with twice the locals; phis should follow the updates, not the locals
+    std::vector<SSABenchResult> run_ssa_benchmark(size_t locals, size_t depth);
+    void print_ssa_summary(const std::vector<SSABenchResult>& results);
+
+    // Open a generated workspace of `files` files in the language server, then make `edits`
+    // edits inside function bodies and `edits` to declarations, timing each didChange until
+    // its diagnostics are published
+    std::vector<LSPBenchResult> run_lsp_benchmark(size_t files, size_t edits);
+    void print_lsp_summary(const std::vector<LSPBenchResult>& results);
+
+    // Make `edits` single-character edits across a generated file of about `lines` lines,
+    // timing a full lex and parse of each version against Parser::reparse
+    std::vector<ReparseBenchResult> run_reparse_benchmark(size_t lines, size_t edits);
+    void print_reparse_summary(const std::vector<ReparseBenchResult>& results);
+
+    // Lex and parse a generated file of about `lines` lines of declarations and one of
+    // `lines` statements in eight long functions, timing each stage
+    std::vector<ParseBenchResult> run_parse_benchmark(size_t lines);
+    void print_parse_summary(const std::vector<ParseBenchResult>& results);
+
+    // Parse comparison chains of `length`, 2 and 4 times that many `<`, and var initializers
+    // nested 6, 8 and 10 deep, with the parser's packrat memo off and on
+    std::vector<MemoBenchResult> run_memo_benchmark(size_t length);
+    void print_memo_summary(const std::vector<MemoBenchResult>& results);
+
+    // Format `copies` copies of the .fn files under `corpus_dirs` on one thread and on
+    // `threads` (0: hardware threads), then format each file under `idempotence_dirs`
+    // twice and check the second pass changes nothing
+    std::vector<FmtBenchResult> run_fmt_benchmark(const std::vector<std::string>& corpus_dirs,
+                                                  const std::vector<std::string>& idempotence_dirs,
+                                                  size_t copies, unsigned threads = 0);
+    void print_fmt_summary(const std::vector<FmtBenchResult>& results);
+
+    // Declare, bind, resolve, lower to HLIR and print the AST of a generated file of
+    // `statements` statements, once with switch dispatch and once with accept()
+    std::vector<DispatchBenchResult> run_dispatch_benchmark(size_t statements);
+    void print_dispatch_summary(const std::vector<DispatchBenchResult>& results);
+
+    // Write a corpus of about `megabytes` MB of generated files to a temporary directory and
+    // load it through std::stringstream and through mapped SourceBuffers
+    std::vector<LoadBenchResult> run_load_benchmark(size_t megabytes);
+    void print_load_summary(const std::vector<LoadBenchResult>& results);
+
+private:
+    int iterations;
+    std::vector<BenchConfig> configs;
+
+    BenchResult run_single_benchmark(const std::string& bench_file);
+    BenchTiming run_config(const BenchConfig& config, const std::string& bench_file,
+                           const std::string& source, std::string& error);
+};
+
+} // namespace Fern
@@ -0,0 +1,43 @@
+// bench_util.hpp - Timing and file helpers shared by the benchmark runner's files
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace Fern {
+
+using Clock = std::chrono::steady_clock;
+
+inline double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+inline std::string read_file(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+// Benchmarks document their result the same way tests do: "-- Expected: 42.0"
+inline std::optional<float> parse_expected(const std::string& source) {
+    const std::string marker = "-- Expected:";
+    auto pos = source.find(marker);
+    if (pos == std::string::npos) {
+        return std::nullopt;
+    }
+    try {
+        return std::stof(source.substr(pos + marker.size()));
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+} // namespace Fern
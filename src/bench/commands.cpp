@@ -0,0 +1,294 @@
+// commands.cpp - The benchmark flags: what each runs, its arguments and their defaults, and its help
+#include "commands.hpp"
+#include "bench_runner.hpp"
+#include "compiler.hpp"
+#include "common/logger.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Fern {
+
+// The arguments after a benchmark's flag; any left out take the default the benchmark passes
+struct BenchArgs {
+    const char* program;  // argv[0], for benchmarks that run Fern again
+    std::vector<std::string> args;
+
+    std::string text(size_t i, const char* fallback) const {
+        return i < args.size() ? args[i] : fallback;
+    }
+
+    size_t count(size_t i, size_t fallback) const {
+        return i < args.size() ? std::strtoul(args[i].c_str(), nullptr, 10) : fallback;
+    }
+
+    // A thread count, where 0 means the hardware thread count
+    unsigned threads(size_t i) const {
+        return static_cast<unsigned>(count(i, 0));
+    }
+};
+
+struct BenchCommand {
+    const char* flag;
+    const char* alias;  // nullptr when there's none
+    const char* usage;  // the arguments, as --help shows them
+    const char* help;   // lines separated by '\n', defaults last
+    bool (*run)(const BenchArgs& args);
+};
+
+// Whether one result passed, asked the way its type answers
+template <typename Result>
+static bool passed(const Result& result) {
+    if constexpr (requires { result.passed(); }) {
+        return result.passed();
+    } else if constexpr (requires { result.ok(); }) {
+        return result.ok();
+    } else if constexpr (requires { result.matches; }) {
+        return result.ok && result.matches;
+    } else {
+        return result.ok;
+    }
+}
+
+// Print a benchmark's results with `print` and tell whether they all passed
+template <typename Result>
+static bool report(BenchRunner& runner, void (BenchRunner::*print)(const Result&), const Result& result) {
+    (runner.*print)(result);
+    return passed(result);
+}
+
+template <typename Result>
+static bool report(BenchRunner& runner, void (BenchRunner::*print)(const std::vector<Result>&),
+                   const std::vector<Result>& results) {
+    (runner.*print)(results);
+    return std::all_of(results.begin(), results.end(), [](const Result& r) { return passed(r); });
+}
+
+// In the order --help lists them
+static const BenchCommand commands[] = {
+    {"--bench", "-b", "[dir]",
+     "Run benchmarks in the specified directory (default: benchmarks)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_summary,
+                       runner.run_all_benchmarks(args.text(0, "benchmarks")));
+     }},
+    {"--bench-vectorize", nullptr, "[dir]",
+     "Check that array loops vectorize at -O3 (default: tests)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_vectorization_summary,
+                       runner.check_vectorization(args.text(0, "tests")));
+     }},
+    {"--bench-bounds", nullptr, "[dir]",
+     "Time benchmarks without bounds checks, with them, and with\n"
+     "redundant checks elided (default: benchmarks)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         runner.set_configs({
+             {"unchecked", [](Compiler& compiler) { compiler.set_bounds_checks(false); }},
+             {"checked", [](Compiler& compiler) {
+                 compiler.set_bounds_checks(true);
+                 compiler.set_eliminate_bounds_checks(false);
+             }},
+             {"elided", [](Compiler& compiler) { compiler.set_bounds_checks(true); }},
+         });
+         return report(runner, &BenchRunner::print_summary,
+                       runner.run_all_benchmarks(args.text(0, "benchmarks")));
+     }},
+    {"--bench-hlir", nullptr, "[n]",
+     "Time HLIR construction and lowering for a generated\n"
+     "function of about n instructions (default: 100000)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_hlir_summary,
+                       runner.run_hlir_benchmark(args.count(0, 100000)));
+     }},
+    {"--bench-codegen", nullptr, "[n] [threads]",
+     "Time partitioned code generation of n generated functions\n"
+     "at 1, 2, 4 ... threads (default: 512, hardware threads)",
+     [](const BenchArgs& args) {
+         BenchRunner runner(3);
+         return report(runner, &BenchRunner::print_codegen_summary,
+                       runner.run_codegen_benchmark(args.count(0, 512), args.threads(1)));
+     }},
+    {"--bench-startup", nullptr, "[std]",
+     "Time eager and lazy JIT startup for a program that links\n"
+     "the standard library (default: runtime/std.fn)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_startup_summary,
+                       runner.run_startup_benchmark(args.text(0, "runtime/std.fn")));
+     }},
+    {"--bench-tiered", nullptr, "[calls]",
+     "Time repeated calls to a hot function at -O0, at -O3 and\n"
+     "with the tiered JIT (default: 100000)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_tiered_summary,
+                       runner.run_tiered_benchmark(args.count(0, 100000)));
+     }},
+    {"--bench-interpreter", nullptr, "[dir] [std]",
+     "Time compile and run of each program with the JIT and with\n"
+     "the bytecode interpreter (default: tests, runtime/std.fn)",
+     [](const BenchArgs& args) {
+         BenchRunner runner(3);
+         return report(runner, &BenchRunner::print_interpreter_summary,
+                       runner.run_interpreter_benchmark(args.text(0, "tests"), args.text(1, "runtime/std.fn")));
+     }},
+    {"--bench-batch", nullptr, "[rows] [threads]",
+     "Time a function over many rows with execute_jit per row and\n"
+     "with execute_batch (default: 1000000, hardware threads)",
+     [](const BenchArgs& args) {
+         BenchRunner runner(3);
+         return report(runner, &BenchRunner::print_batch_summary,
+                       runner.run_batch_benchmark(args.count(0, 1000000), args.threads(1)));
+     }},
+    {"--bench-pgo", nullptr, "[file]",
+     "Time a program at -O2 without and with a profile from an\n"
+     "instrumented run (default: benchmarks/branchy.fn)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_pgo_summary,
+                       runner.run_pgo_benchmark(args.text(0, "benchmarks/branchy.fn")));
+     }},
+    {"--bench-session", nullptr, "[n] [std]",
+     "Time compiling and calling n small snippets that use the\n"
+     "standard library, fresh each time and in one warm session\n"
+     "(default: 500, runtime/std.fn)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_session_summary,
+                       runner.run_session_benchmark(args.count(0, 500), args.text(1, "runtime/std.fn")));
+     }},
+    {"--bench-bind", nullptr, "[n]",
+     "Count heap allocations while binding generated files of n and\n"
+     "2n statements; run it from FernBench, which counts them (default: 20000)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_bind_summary,
+                       runner.run_bind_benchmark(args.count(0, 20000)));
+     }},
+    {"--bench-ssa", nullptr, "[n] [depth]",
+     "Build HLIR for nested loops over n and 2n locals and count\n"
+     "phis (default: 200 locals, depth 6)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_ssa_summary,
+                       runner.run_ssa_benchmark(args.count(0, 200), args.count(1, 6)));
+     }},
+    {"--bench-lsp", nullptr, "[files] [edits]",
+     "Time didChange to published diagnostics in the language server\n"
+     "for body and declaration edits (default: 200 files, 200 edits)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_lsp_summary,
+                       runner.run_lsp_benchmark(args.count(0, 200), args.count(1, 200)));
+     }},
+    {"--bench-reparse", nullptr, "[lines] [edits]",
+     "Time single-character edits to a generated file, parsed whole\n"
+     "and reparsed incrementally (default: 50000 lines, 200 edits)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_reparse_summary,
+                       runner.run_reparse_benchmark(args.count(0, 50000), args.count(1, 200)));
+     }},
+    {"--bench-parse", nullptr, "[n]",
+     "Lex and parse generated files of n lines of declarations and\n"
+     "n statements, in tokens per second (default: 200000)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_parse_summary,
+                       runner.run_parse_benchmark(args.count(0, 200000)));
+     }},
+    {"--bench-memo", nullptr, "[n]",
+     "Parse comparison chains of n, 2n and 4n and nested var initializers\n"
+     "with the parser's memo off and on (default: 500)",
+     [](const BenchArgs& args) {
+         BenchRunner runner(3);
+         return report(runner, &BenchRunner::print_memo_summary,
+                       runner.run_memo_benchmark(args.count(0, 500)));
+     }},
+    {"--bench-dispatch", nullptr, "[n]",
+     "Time each tree pass over a generated file of n statements with\n"
+     "switch and virtual visitor dispatch (default: 100000)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_dispatch_summary,
+                       runner.run_dispatch_benchmark(args.count(0, 100000)));
+     }},
+    {"--bench-load", nullptr, "[MB]",
+     "Load a generated corpus of about MB megabytes through std::stringstream\n"
+     "and mapped source buffers, with peak memory (default: 256)",
+     [](const BenchArgs& args) {
+         BenchRunner runner(3);
+         return report(runner, &BenchRunner::print_load_summary,
+                       runner.run_load_benchmark(args.count(0, 256)));
+     }},
+    {"--bench-fmt", nullptr, "[copies] [threads]",
+     "Format copies of tests, runtime and benchmarks in memory on 1 and\n"
+     "many threads, and check formatting is idempotent (default: 200,\n"
+     "hardware threads)",
+     [](const BenchArgs& args) {
+         BenchRunner runner;
+         return report(runner, &BenchRunner::print_fmt_summary,
+                       runner.run_fmt_benchmark({"tests", "runtime", "benchmarks"}, {"tests", "runtime"},
+                                                args.count(0, 200), args.threads(1)));
+     }},
+    {"--bench-exe", nullptr, "[dir] [std]",
+     "Time process start to exit for each program run through the\n"
+     "JIT and as a native executable (default: tests, runtime/std.fn)",
+     [](const BenchArgs& args) {
+         BenchRunner runner(3);
+         return report(runner, &BenchRunner::print_exe_summary,
+                       runner.run_exe_benchmark(args.program, args.text(0, "tests"), args.text(1, "runtime/std.fn")));
+     }},
+};
+
+std::optional<int> run_bench_command(int argc, char* argv[]) {
+    if (argc < 2) {
+        return std::nullopt;
+    }
+    for (const auto& command : commands) {
+        if (std::strcmp(argv[1], command.flag) != 0 &&
+            (!command.alias || std::strcmp(argv[1], command.alias) != 0)) {
+            continue;
+        }
+
+        // Compiler logging would drown out the timings
+        Logger::get_instance().set_console_level(LogLevel::WARN);
+
+        BenchArgs args{argv[0], std::vector<std::string>(argv + 2, argv + argc)};
+        return command.run(args) ? 0 : 1;
+    }
+    return std::nullopt;
+}
+
+void print_bench_help(std::ostream& out) {
+    const size_t column = 20;
+    for (const auto& command : commands) {
+        std::string name = command.flag;
+        if (command.alias) {
+            name += std::string(", ") + command.alias;
+        }
+        name += std::string(" ") + command.usage;
+
+        out << "  " << name;
+        if (name.size() < column) {
+            out << std::string(column - name.size(), ' ');
+        } else {
+            out << "\n" << std::string(column + 2, ' ');
+        }
+        for (const char* c = command.help; *c; c++) {
+            out << *c;
+            if (*c == '\n') {
+                out << std::string(column + 2, ' ');
+            }
+        }
+        out << "\n";
+    }
+}
+
+} // namespace Fern
@@ -0,0 +1,16 @@
+// commands.hpp - The command-line flags that run benchmarks (--bench, --bench-codegen, ...)
+#pragma once
+
+#include <optional>
+#include <ostream>
+
+namespace Fern {
+
+// Run the benchmark argv[1] names, with the arguments after it, and return the exit code:
+// 0 when every result passed. nullopt when argv[1] isn't a benchmark flag
+std::optional<int> run_bench_command(int argc, char* argv[]);
+
+// The --help lines for every benchmark flag
+void print_bench_help(std::ostream& out);
+
+} // namespace Fern
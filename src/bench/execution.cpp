@@ -0,0 +1,983 @@
+// execution.cpp - Benchmarks of running programs: JIT modes, the interpreter, batches,
+// sessions, profile-guided builds and native executables
+#include "bench_runner.hpp"
+#include "bench_util.hpp"
+#include "compiler.hpp"
+#include "jit.hpp"
+#include "embed/session.hpp"
+#include <llvm/Support/Program.h>
+#include <filesystem>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace Fern {
+
+std::vector<StartupBenchResult> BenchRunner::run_startup_benchmark(const std::string& std_file) {
+    std::vector<StartupBenchResult> results;
+    std::string std_source;
+    try {
+        std_source = read_file(std_file);
+    } catch (const std::exception& e) {
+        StartupBenchResult result;
+        result.mode = "std";
+        result.error_message = e.what();
+        results.push_back(result);
+        return results;
+    }
+
+    // Everything in the library gets lowered, only AbsF ever runs
+    std::string main_source = "fn Main -> f32\n{\n    return AbsF(0.0 - 42.5)\n}\n";
+
+    std::cout << "Starting a program that links " << std_file << " and calls one function ("
+              << iterations << " iterations)...\n" << std::endl;
+
+    const std::pair<const char*, JITMode> modes[] = {
+        {"eager", JITMode::Eager},
+        {"lazy", JITMode::Lazy},
+    };
+
+    for (const auto& [name, mode] : modes) {
+        StartupBenchResult result;
+        result.mode = name;
+
+        try {
+            Compiler compiler;
+            compiler.set_print_ast(false);
+            compiler.set_print_symbols(false);
+            compiler.set_print_hlir(false);
+            compiler.set_jit_mode(mode);
+
+            auto compiled = compiler.compile(std::vector<SourceFile>{
+                {"startup.fn", main_source}, {std_file, std_source}});
+            if (!compiled || !compiled->is_valid()) {
+                result.error_message = "compile failed";
+                results.push_back(result);
+                continue;
+            }
+
+            // A fresh JIT each time, since a second call would find everything compiled
+            for (int i = 0; i < iterations; i++) {
+                auto start = Clock::now();
+                JIT jit(compiled->get_jit_mode(), compiled->get_thread_count());
+                auto main_func = compiled->add_to_jit(jit) ? jit.get_function<float()>("Main") : nullptr;
+                double jit_ms = elapsed_ms(start);
+                if (!main_func) {
+                    result.error_message = "Main not found";
+                    break;
+                }
+
+                start = Clock::now();
+                float value = main_func();
+                double first_call_ms = elapsed_ms(start);
+
+                if (i == 0 || jit_ms + first_call_ms < result.startup_ms()) {
+                    result.jit_ms = jit_ms;
+                    result.first_call_ms = first_call_ms;
+                }
+                result.return_value = value;
+                result.ok = true;
+            }
+        } catch (const std::exception& e) {
+            result.error_message = std::string("exception: ") + e.what();
+            result.ok = false;
+        }
+
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+void BenchRunner::print_startup_summary(const std::vector<StartupBenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "JIT STARTUP (ms, best of " << iterations << ")" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::cout << std::left << std::setw(8) << "mode"
+              << std::right << std::setw(10) << "jit" << std::setw(12) << "first call"
+              << std::setw(10) << "startup" << std::setw(10) << "speedup" << std::setw(10) << "result"
+              << std::endl;
+
+    double baseline = 0.0;
+    for (const auto& result : results) {
+        if (!result.ok) {
+            std::cout << std::left << std::setw(8) << result.mode << "ERROR: " << result.error_message
+                      << std::endl;
+            continue;
+        }
+        if (baseline == 0.0) {
+            baseline = result.startup_ms();
+        }
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << std::left << std::setw(8) << result.mode
+                  << std::right << std::setw(10) << result.jit_ms << std::setw(12) << result.first_call_ms
+                  << std::setw(10) << result.startup_ms()
+                  << std::setw(9) << baseline / result.startup_ms() << "x"
+                  << std::setw(10) << std::defaultfloat << std::setprecision(6) << result.return_value
+                  << std::endl;
+    }
+    std::cout << "========================================" << std::endl;
+}
+
+std::vector<TieredBenchResult> BenchRunner::run_tiered_benchmark(size_t calls) {
+    std::vector<TieredBenchResult> results;
+    calls = std::max<size_t>(calls, 1);
+
+    // A few hundred iterations per call: one call is cheap, so tiering pays off only after many
+    const int32_t work_size = 256;
+    std::string source =
+        "fn Work(i32 n) -> i32\n"
+        "{\n"
+        "    var sum = 0\n"
+        "    var i = 0\n"
+        "    while i < n\n"
+        "    {\n"
+        "        sum += i * i % 7 + i\n"
+        "        i += 1\n"
+        "    }\n"
+        "    return sum\n"
+        "}\n"
+        "\n"
+        "fn Main -> f32\n"
+        "{\n"
+        "    return 0.0\n"
+        "}\n";
+
+    std::cout << "Calling a " << work_size << "-iteration loop " << calls << " times per JIT configuration...\n"
+              << std::endl;
+
+    struct TieredConfig {
+        const char* name;
+        JITMode mode;
+        int opt_level;
+    };
+    const TieredConfig configs[] = {
+        {"O0", JITMode::Eager, 0},
+        {"O3", JITMode::Eager, 3},
+        {"tiered", JITMode::Tiered, 0},
+    };
+
+    for (const auto& config : configs) {
+        TieredBenchResult result;
+        result.mode = config.name;
+
+        try {
+            Compiler compiler;
+            compiler.set_print_ast(false);
+            compiler.set_print_symbols(false);
+            compiler.set_print_hlir(false);
+            compiler.set_opt_level(config.opt_level);
+            compiler.set_jit_mode(config.mode);
+
+            // Compile time up to LLVM IR is the same for every mode; the -O3 pipeline is not
+            auto start = Clock::now();
+            auto compiled = compiler.compile(std::vector<SourceFile>{{"tiered.fn", source}});
+            if (!compiled || !compiled->is_valid()) {
+                result.error_message = "compile failed";
+                results.push_back(result);
+                continue;
+            }
+
+            JIT jit(compiled->get_jit_mode(), compiled->get_thread_count());
+            auto work = compiled->add_to_jit(jit) ? jit.get_function<int32_t(int32_t)>("Work") : nullptr;
+            result.jit_ms = elapsed_ms(start);
+            if (!work) {
+                result.error_message = "Work not found";
+                results.push_back(result);
+                continue;
+            }
+
+            result.elapsed_ms.reserve(calls);
+            double total_ms = result.jit_ms;
+            double fastest_us = 0.0;
+            for (size_t i = 0; i < calls; i++) {
+                auto call_start = Clock::now();
+                result.return_value = static_cast<float>(work(work_size));
+                double call_ms = elapsed_ms(call_start);
+                total_ms += call_ms;
+                result.elapsed_ms.push_back(total_ms);
+
+                if (i >= calls - calls / 10 - 1 && (fastest_us == 0.0 || call_ms * 1000.0 < fastest_us)) {
+                    fastest_us = call_ms * 1000.0;
+                }
+            }
+            result.steady_us = fastest_us;
+
+            jit.wait_for_tier_ups();
+            for (const auto& event : jit.get_tier_events()) {
+                result.tier_ups++;
+                result.tier_up_compile_ms += event.compile_ms;
+            }
+            result.ok = true;
+        } catch (const std::exception& e) {
+            result.error_message = std::string("exception: ") + e.what();
+        }
+
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+void BenchRunner::print_tiered_summary(const std::vector<TieredBenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "TIERED JIT (cumulative ms after N calls, compile included)" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    size_t calls = 0;
+    for (const auto& result : results) {
+        calls = std::max(calls, result.elapsed_ms.size());
+    }
+    std::vector<size_t> checkpoints;
+    for (size_t n : {size_t(1), size_t(10), size_t(100), size_t(1000), size_t(10000), calls}) {
+        if (n <= calls && (checkpoints.empty() || checkpoints.back() < n)) {
+            checkpoints.push_back(n);
+        }
+    }
+
+    std::cout << std::left << std::setw(8) << "mode" << std::right << std::setw(10) << "jit";
+    for (size_t n : checkpoints) {
+        std::cout << std::setw(10) << ("@" + std::to_string(n));
+    }
+    std::cout << std::setw(12) << "steady us" << std::setw(10) << "tier-ups" << std::setw(10) << "result"
+              << std::endl;
+
+    for (const auto& result : results) {
+        if (!result.ok) {
+            std::cout << std::left << std::setw(8) << result.mode << "ERROR: " << result.error_message
+                      << std::endl;
+            continue;
+        }
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << std::left << std::setw(8) << result.mode << std::right << std::setw(10) << result.jit_ms;
+        for (size_t n : checkpoints) {
+            std::cout << std::setw(10) << result.elapsed_ms[n - 1];
+        }
+        std::cout << std::setw(12) << result.steady_us << std::setw(10) << result.tier_ups
+                  << std::setw(10) << std::defaultfloat << std::setprecision(6) << result.return_value
+                  << std::endl;
+    }
+
+    for (const auto& result : results) {
+        if (result.ok && result.tier_ups > 0) {
+            std::cout << std::fixed << std::setprecision(2) << result.mode << ": " << result.tier_ups
+                      << " tier-up(s), " << result.tier_up_compile_ms << " ms of background -O3 compiles"
+                      << std::defaultfloat << std::endl;
+        }
+    }
+    std::cout << "========================================" << std::endl;
+}
+
+std::vector<InterpreterBenchResult> BenchRunner::run_interpreter_benchmark(const std::string& dir,
+                                                                           const std::string& std_file) {
+    std::vector<InterpreterBenchResult> results;
+    std::vector<std::string> files;
+    std::string std_source;
+
+    try {
+        std_source = read_file(std_file);
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".fn") {
+                files.push_back(entry.path().string());
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error scanning directory: " << e.what() << std::endl;
+        return results;
+    }
+
+    std::sort(files.begin(), files.end());
+    std::cout << "Running " << files.size() << " files from " << dir << " with the JIT and the interpreter ("
+              << iterations << " iterations)...\n" << std::endl;
+
+    for (const auto& file : files) {
+        InterpreterBenchResult result(fs::path(file).filename().string());
+
+        try {
+            std::vector<SourceFile> sources = {{file, read_file(file)}, {std_file, std_source}};
+
+            for (Backend backend : {Backend::LLVM, Backend::Interpreter}) {
+                bool interpreted = backend == Backend::Interpreter;
+                double best_compile = -1.0;
+                double best_run = -1.0;
+
+                for (int i = 0; i < iterations; i++) {
+                    Compiler compiler;
+                    compiler.set_print_ast(false);
+                    compiler.set_print_symbols(false);
+                    compiler.set_print_hlir(false);
+                    compiler.set_backend(backend);
+
+                    auto start = Clock::now();
+                    auto compiled = compiler.compile(sources);
+                    double compile_ms = elapsed_ms(start);
+                    if (!compiled || !compiled->is_valid()) {
+                        result.error_message = interpreted ? "interpreter: compile failed" : "jit: compile failed";
+                        break;
+                    }
+
+                    // Machine code generation is part of the JIT's run, as it is for a user
+                    start = Clock::now();
+                    std::optional<float> value = compiled->execute_jit<float>("Main");
+                    double run_ms = elapsed_ms(start);
+                    if (!value) {
+                        result.error_message = interpreted ? "interpreter: run failed" : "jit: run failed";
+                        break;
+                    }
+
+                    if (best_compile < 0.0 || compile_ms + run_ms < best_compile + best_run) {
+                        best_compile = compile_ms;
+                        best_run = run_ms;
+                    }
+                    (interpreted ? result.interpreter_value : result.jit_value) = *value;
+                    (interpreted ? result.interpreter_ok : result.jit_ok) = true;
+                }
+
+                if (interpreted) {
+                    result.interpreter_compile_ms = best_compile;
+                    result.interpreter_run_ms = best_run;
+                } else {
+                    result.jit_compile_ms = best_compile;
+                    result.jit_run_ms = best_run;
+                    if (!result.jit_ok) {
+                        break;
+                    }
+                }
+            }
+        } catch (const std::exception& e) {
+            result.error_message = std::string("exception: ") + e.what();
+        }
+
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
+
+void BenchRunner::print_interpreter_summary(const std::vector<InterpreterBenchResult>& results) {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "INTERPRETER vs JIT (ms, compile + run, best of " << iterations << ")" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::cout << std::left << std::setw(24) << "file"
+              << std::right << std::setw(10) << "jit" << std::setw(10) << "interp"
+              << std::setw(10) << "speedup" << std::setw(10) << "result" << std::endl;
+
+    double jit_total = 0.0;
+    double interpreter_total = 0.0;
+    int compared = 0;
+    int mismatched = 0;
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(24) << result.file_name << std::right;
+        if (!result.jit_ok) {
+            std::cout << "SKIP (" << result.error_message << ")" << std::endl;
+            continue;
+        }
+        if (!result.interpreter_ok) {
+            std::cout << "ERROR: " << result.error_message << std::endl;
+            mismatched++;
+            continue;
+        }
+
+        compared++;
+        jit_total += result.jit_total_ms();
+        interpreter_total += result.interpreter_total_ms();
+        if (!result.ok()) {
+            mismatched++;
+        }
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << std::setw(10) << result.jit_total_ms() << std::setw(10) << result.interpreter_total_ms()
+                  << std::setw(9) << result.jit_total_ms() / result.interpreter_total_ms() << "x"
+                  << std::setw(10) << (result.ok() ? "match" : "DIFFER") << std::defaultfloat << std::endl;
+    }
+
+    std::cout << "----------------------------------------" << std::endl;
+    if (compared > 0) {
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Total over " << compared << " files: JIT " << jit_total << " ms, interpreter "
+                  << interpreter_total << " ms (" << jit_total / interpreter_total << "x)" << std::defaultfloat
+                  << std::endl;
+    }
+    std::cout << "Results " << (mismatched == 0 ? "match" : "DIFFER") << " between backends";
+    if (mismatched > 0) {
+        std::cout << " (" << mismatched << " files)";
+    }
+    std::cout << std::endl;
+    std::cout << "========================================" << std::endl;
+}
+
+PGOBenchResult BenchRunner::run_pgo_benchmark(const std::string& bench_file) {
+    PGOBenchResult result(fs::path(bench_file).filename().string());
+
+    std::string source;
+    try {
+        source = read_file(bench_file);
+    } catch (const std::exception& e) {
+        result.error_message = e.what();
+        return result;
+    }
+    result.expected = parse_expected(source);
+
+    // Instrumented programs append, so start from an empty file
+    std::string profile_file =
+        (fs::temp_directory_path() / ("fern-pgo-" + fs::path(bench_file).stem().string() + ".profile")).string();
+    std::error_code ec;
+    fs::remove(profile_file, ec);
+
+    std::cout << "Running " << result.file_name << " at -O2 without and with a profile (" << iterations
+              << " iterations)...\n" << std::endl;
+
+    result.plain = run_config({"plain", [](Compiler& compiler) { compiler.set_opt_level(2); }},
+                              bench_file, source, result.error_message);
+    if (!result.plain.ok) {
+        return result;
+    }
+
+    // One training run through execute_jit, which writes the counts when Main returns
+    try {
+        Compiler compiler;
+        compiler.set_print_ast(false);
+        compiler.set_print_symbols(false);
+        compiler.set_print_hlir(false);
+        compiler.set_opt_level(2);
+        compiler.set_profile_generate(profile_file);
+
+        auto start = Clock::now();
+        auto compiled = compiler.compile(std::vector<SourceFile>{{bench_file, source}});
+        result.instrumented.compile_ms = elapsed_ms(start);
+        if (!compiled || !compiled->is_valid()) {
+            result.error_message = "instrumented: compile failed";
+            return result;
+        }
+
+        start = Clock::now();
+        auto value = compiled->execute_jit<float>("Main");
+        result.instrumented.run_ms = elapsed_ms(start);
+        if (!value) {
+            result.error_message = "instrumented: run failed";
+            return result;
+        }
+        result.instrumented.return_value = *value;
+        result.instrumented.ok = true;
+    } catch (const std::exception& e) {
+        result.error_message = std::string("instrumented: exception: ") + e.what();
+        return result;
+    }
+
+    result.optimized = run_config({"profile-use", [&](Compiler& compiler) {
+                                       compiler.set_opt_level(2);
+                                       compiler.set_profile_use(profile_file);
+                                   }},
+                                  bench_file, source, result.error_message);
+
+    fs::remove(profile_file, ec);
+    return result;
+}
+
+void BenchRunner::print_pgo_summary(const PGOBenchResult& result) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "PROFILE-GUIDED OPTIMIZATION: " << result.file_name << " (ms, best of " << iterations << ")"
+              << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::cout << std::left << std::setw(16) << "build" << std::right << std::setw(12) << "compile"
+              << std::setw(12) << "run" << std::setw(16) << "result" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    auto print_row = [](const char* name, const BenchTiming& timing) {
+        std::cout << std::left << std::setw(16) << name << std::right;
+        if (!timing.ok) {
+            std::cout << std::setw(12) << "-" << std::setw(12) << "-" << std::setw(16) << "FAILED" << std::endl;
+            return;
+        }
+        std::cout << std::setw(12) << timing.compile_ms << std::setw(12) << timing.run_ms << std::setw(16)
+                  << timing.return_value << std::endl;
+    };
+    print_row("O2", result.plain);
+    print_row("O2 instrumented", result.instrumented);
+    print_row("O2 + profile", result.optimized);
+
+    std::cout << "----------------------------------------" << std::endl;
+    if (result.plain.ok && result.optimized.ok && result.optimized.run_ms > 0.0) {
+        std::cout << "Speedup from profile: " << result.plain.run_ms / result.optimized.run_ms << "x" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+    if (!result.error_message.empty()) {
+        std::cout << "Error: " << result.error_message << std::endl;
+    }
+    std::cout << "Results " << (result.ok() ? "match" : "DIFFER") << std::endl;
+    std::cout << "========================================" << std::endl;
+}
+
+std::vector<BatchBenchResult> BenchRunner::run_batch_benchmark(size_t rows, unsigned threads) {
+    std::vector<BatchBenchResult> results;
+    rows = std::max<size_t>(rows, 1);
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Cheap enough per row that call overhead is what gets measured
+    std::string source =
+        "fn Score(f32 price, i32 quantity) -> f32\n"
+        "{\n"
+        "    var total = price * (f32)quantity\n"
+        "    if (quantity > 10)\n"
+        "    {\n"
+        "        total = total * 0.9\n"
+        "    }\n"
+        "    return total + 1.5\n"
+        "}\n"
+        "\n"
+        "fn Main -> f32\n"
+        "{\n"
+        "    return Score(2.0, 3)\n"
+        "}\n";
+
+    std::vector<float> prices(rows);
+    std::vector<int32_t> quantities(rows);
+    for (size_t i = 0; i < rows; i++) {
+        prices[i] = static_cast<float>(i % 1000) * 0.25f;
+        quantities[i] = static_cast<int32_t>(i % 23);
+    }
+
+    std::cout << "Evaluating Score over " << rows << " rows (" << iterations << " iterations, "
+              << threads << " batch threads)...\n" << std::endl;
+
+    Compiler compiler;
+    compiler.set_print_ast(false);
+    compiler.set_print_symbols(false);
+    compiler.set_print_hlir(false);
+    compiler.set_opt_level(2);
+    auto compiled = compiler.compile(std::vector<SourceFile>{{"batch.fn", source}});
+    if (!compiled || !compiled->is_valid()) {
+        BatchBenchResult result;
+        result.mode = "compile";
+        result.error_message = "compile failed";
+        results.push_back(result);
+        return results;
+    }
+
+    auto time_best = [&](auto&& run) {
+        double best = -1.0;
+        for (int i = 0; i < iterations; i++) {
+            auto start = Clock::now();
+            run();
+            double ms = elapsed_ms(start);
+            if (best < 0.0 || ms < best) {
+                best = ms;
+            }
+        }
+        return best;
+    };
+
+    // Reference results from the cheapest host loop there is
+    std::vector<float> expected(rows);
+    {
+        BatchBenchResult result;
+        result.mode = "pointer loop";
+        result.rows = rows;
+        auto start = Clock::now();
+        JIT jit(compiled->get_jit_mode(), compiled->get_thread_count());
+        auto score = compiled->add_to_jit(jit) ? jit.get_function<float(float, int32_t)>("Score") : nullptr;
+        result.setup_ms = elapsed_ms(start);
+        if (score) {
+            result.run_ms = time_best([&] {
+                for (size_t i = 0; i < rows; i++) {
+                    expected[i] = score(prices[i], quantities[i]);
+                }
+            });
+            result.ok = true;
+            result.matches = true;
+        } else {
+            result.error_message = "Score not found";
+        }
+        results.push_back(result);
+    }
+
+    // A JIT per call, so only a sample of rows; rows/s is what compares
+    {
+        BatchBenchResult result;
+        result.mode = "execute_jit loop";
+        result.rows = std::min<size_t>(rows, 100);
+        result.matches = true;
+        result.run_ms = time_best([&] {
+            for (size_t i = 0; i < result.rows; i++) {
+                auto value = compiled->execute_jit<float>("Score", prices[i], quantities[i]);
+                result.matches = result.matches && value && *value == expected[i];
+            }
+        });
+        result.ok = result.matches;
+        if (!result.ok) {
+            result.error_message = "execute_jit failed or returned a different result";
+        }
+        results.push_back(result);
+    }
+
+    std::vector<unsigned> thread_counts = {1};
+    if (threads > 1) {
+        thread_counts.push_back(threads);
+    }
+    for (unsigned batch_threads : thread_counts) {
+        BatchBenchResult result;
+        result.mode = "batch x" + std::to_string(batch_threads);
+        result.rows = rows;
+        compiled->set_batch_threads(batch_threads);
+
+        // Every batch builds its own JIT, so run_ms includes it; a one-row batch shows how much
+        std::vector<float> output(rows);
+        bool ran = true;
+        result.run_ms = time_best([&] {
+            ran = compiled->execute_batch("Score", rows, output.data(), prices.data(), quantities.data()) && ran;
+        });
+        float one = 0.0f;
+        result.setup_ms = time_best([&] {
+            compiled->execute_batch("Score", 1, &one, prices.data(), quantities.data());
+        });
+
+        result.ok = ran;
+        result.matches = ran && output == expected;
+        if (!ran) {
+            result.error_message = "execute_batch failed";
+        }
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+void BenchRunner::print_batch_summary(const std::vector<BatchBenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "BATCHED CALLS (best of " << iterations << ")" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::cout << std::left << std::setw(20) << "mode" << std::right << std::setw(10) << "rows" << std::setw(12)
+              << "setup ms" << std::setw(12) << "run ms" << std::setw(16) << "rows/s" << std::setw(10) << "result"
+              << std::endl;
+
+    double baseline = 0.0;
+    for (const auto& result : results) {
+        if (result.mode == "execute_jit loop" && result.ok) {
+            baseline = result.rows_per_second();
+        }
+    }
+
+    bool all_match = true;
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(20) << result.mode << std::right;
+        if (!result.ok) {
+            std::cout << "ERROR: " << result.error_message << std::endl;
+            all_match = false;
+            continue;
+        }
+        all_match = all_match && result.matches;
+        std::cout << std::fixed << std::setprecision(2) << std::setw(10) << result.rows << std::setw(12)
+                  << result.setup_ms << std::setw(12) << result.run_ms << std::setprecision(0) << std::setw(16)
+                  << result.rows_per_second() << std::setw(10) << (result.matches ? "match" : "DIFFER");
+        if (baseline > 0.0) {
+            std::cout << std::setprecision(1) << "  " << result.rows_per_second() / baseline << "x";
+        }
+        std::cout << std::defaultfloat << std::endl;
+    }
+
+    std::cout << "----------------------------------------" << std::endl;
+    std::cout << "Results " << (all_match ? "match" : "DIFFER") << std::endl;
+    std::cout << "========================================" << std::endl;
+}
+
+// Launch a process with its output discarded; the exit code, or -1 if it couldn't start
+static int run_process(const std::vector<std::string>& command, double& elapsed) {
+    std::vector<llvm::StringRef> args(command.begin(), command.end());
+    std::optional<llvm::StringRef> redirects[] = {std::nullopt, llvm::StringRef(""), llvm::StringRef("")};
+    bool failed = false;
+    auto start = Clock::now();
+    int status = llvm::sys::ExecuteAndWait(command.front(), args, std::nullopt, redirects, 0, 0, nullptr, &failed);
+    elapsed = elapsed_ms(start);
+    return failed ? -1 : status;
+}
+
+std::vector<ExeBenchResult> BenchRunner::run_exe_benchmark(const std::string& fern_binary, const std::string& dir,
+                                                           const std::string& std_file, unsigned opt_level) {
+    std::vector<ExeBenchResult> results;
+    std::vector<std::string> files;
+    std::string std_source;
+
+    try {
+        std_source = read_file(std_file);
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".fn") {
+                files.push_back(entry.path().string());
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error scanning directory: " << e.what() << std::endl;
+        return results;
+    }
+
+    std::sort(files.begin(), files.end());
+    std::string opt_flag = "-O" + std::to_string(opt_level);
+    std::cout << "Starting " << files.size() << " programs from " << dir << " through the JIT and as native "
+              << "executables at " << opt_flag << " (" << iterations << " iterations)...\n" << std::endl;
+
+    for (const auto& file : files) {
+        ExeBenchResult result(fs::path(file).filename().string());
+        std::string exe_file = (fs::temp_directory_path() / ("fern-exe-" + fs::path(file).stem().string())).string();
+
+        try {
+            // Programs that don't compile are skipped; a JIT process would just exit with 1
+            Compiler compiler;
+            compiler.set_print_ast(false);
+            compiler.set_print_symbols(false);
+            compiler.set_print_hlir(false);
+            compiler.set_opt_level(opt_level);
+
+            auto start = Clock::now();
+            auto compiled = compiler.compile(std::vector<SourceFile>{{file, read_file(file)}, {std_file, std_source}});
+            if (!compiled || !compiled->is_valid()) {
+                result.error_message = "compile failed";
+                results.push_back(result);
+                continue;
+            }
+            bool built = compiled->write_executable(exe_file);
+            result.build_ms = elapsed_ms(start);
+
+            // Main's result is the exit code, so only a process that couldn't start is a failure
+            for (int i = 0; i < iterations; i++) {
+                double ms = 0.0;
+                int status = run_process({fern_binary, opt_flag, file, std_file}, ms);
+                if (status < 0) {
+                    result.error_message = "jit: run failed";
+                    break;
+                }
+                if (i == 0 || ms < result.jit_start_ms) {
+                    result.jit_start_ms = ms;
+                }
+                result.jit_exit = status;
+                result.jit_ok = true;
+            }
+            if (!built) {
+                result.error_message = "exe: build failed";
+            }
+            for (int i = 0; built && result.jit_ok && i < iterations; i++) {
+                double ms = 0.0;
+                int status = run_process({exe_file}, ms);
+                if (status < 0) {
+                    result.error_message = "exe: run failed";
+                    result.exe_ok = false;
+                    break;
+                }
+                if (i == 0 || ms < result.exe_start_ms) {
+                    result.exe_start_ms = ms;
+                }
+                result.exe_exit = status;
+                result.exe_ok = true;
+            }
+        } catch (const std::exception& e) {
+            result.error_message = std::string("exception: ") + e.what();
+        }
+
+        std::error_code ec;
+        fs::remove(exe_file, ec);
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
+
+void BenchRunner::print_exe_summary(const std::vector<ExeBenchResult>& results) {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "NATIVE EXECUTABLE vs JIT (ms, launch to exit, best of " << iterations << ")" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::cout << std::left << std::setw(24) << "file" << std::right << std::setw(10) << "jit" << std::setw(10)
+              << "exe" << std::setw(10) << "speedup" << std::setw(10) << "build" << std::setw(10) << "exit"
+              << std::endl;
+
+    double jit_total = 0.0;
+    double exe_total = 0.0;
+    int compared = 0;
+    int mismatched = 0;
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(24) << result.file_name << std::right;
+        if (!result.jit_ok) {
+            std::cout << "SKIP (" << result.error_message << ")" << std::endl;
+            continue;
+        }
+        if (!result.exe_ok) {
+            std::cout << "ERROR: " << result.error_message << std::endl;
+            mismatched++;
+            continue;
+        }
+
+        compared++;
+        jit_total += result.jit_start_ms;
+        exe_total += result.exe_start_ms;
+        if (!result.ok()) {
+            mismatched++;
+        }
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << std::setw(10) << result.jit_start_ms << std::setw(10) << result.exe_start_ms << std::setw(9)
+                  << result.jit_start_ms / result.exe_start_ms << "x" << std::setw(10) << result.build_ms
+                  << std::setw(10) << (result.ok() ? "match" : "DIFFER") << std::defaultfloat << std::endl;
+    }
+
+    std::cout << "----------------------------------------" << std::endl;
+    if (compared > 0) {
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Total over " << compared << " programs: JIT " << jit_total << " ms, native " << exe_total
+                  << " ms (" << jit_total / exe_total << "x)" << std::defaultfloat << std::endl;
+    }
+    std::cout << "Exit codes " << (mismatched == 0 ? "match" : "DIFFER");
+    if (mismatched > 0) {
+        std::cout << " (" << mismatched << " programs)";
+    }
+    std::cout << std::endl;
+    std::cout << "========================================" << std::endl;
+}
+
+// Snippet i of the session benchmark, and what it should return for `x`
+static std::string session_snippet(size_t i) {
+    std::string k = std::to_string(i % 97 + 1);
+    return "fn Eval(i32 x) -> i32\n"
+           "{\n"
+           "    return Max(x * " + k + ", Abs(x - " + k + ")) + Clamp(x, 0, " + k + ")\n"
+           "}\n";
+}
+
+static int32_t session_snippet_value(size_t i, int32_t x) {
+    int32_t k = static_cast<int32_t>(i % 97 + 1);
+    return std::max(x * k, std::abs(x - k)) + std::clamp(x, 0, k);
+}
+
+std::vector<SessionBenchResult> BenchRunner::run_session_benchmark(size_t snippets, const std::string& std_file) {
+    std::vector<SessionBenchResult> results;
+    std::string std_source;
+    try {
+        std_source = read_file(std_file);
+    } catch (const std::exception& e) {
+        SessionBenchResult result;
+        result.mode = "read";
+        result.error_message = e.what();
+        results.push_back(result);
+        return results;
+    }
+
+    std::cout << "Compiling and calling " << snippets << " snippets against " << std_file << "...\n" << std::endl;
+
+    // Per-snippet times go in here; late_ms averages the last tenth
+    auto finish = [](SessionBenchResult& result, const std::vector<double>& times) {
+        result.snippets = times.size();
+        size_t late = std::max<size_t>(1, times.size() / 10);
+        for (size_t i = 0; i < times.size(); i++) {
+            result.total_ms += times[i];
+            if (i >= times.size() - late) {
+                result.late_ms += times[i] / late;
+            }
+        }
+    };
+
+    // Everything from scratch each time: library included, a new JIT per call
+    {
+        SessionBenchResult result;
+        result.mode = "compile";
+        result.matches = true;
+        std::vector<double> times;
+        size_t sample = std::min<size_t>(snippets, 20);
+        for (size_t i = 0; i < sample; i++) {
+            int32_t x = static_cast<int32_t>(i % 13) - 4;
+            auto start = Clock::now();
+            Compiler compiler;
+            auto compiled = compiler.compile(std::vector<SourceFile>{
+                {"snippet.fn", session_snippet(i)}, {std_file, std_source}});
+            auto value = compiled && compiled->is_valid() ? compiled->execute_jit<int32_t>("Eval", x) : std::nullopt;
+            times.push_back(elapsed_ms(start));
+            if (!value) {
+                result.error_message = "snippet " + std::to_string(i) + " failed";
+                break;
+            }
+            result.matches = result.matches && *value == session_snippet_value(i, x);
+        }
+        result.ok = result.error_message.empty();
+        finish(result, times);
+        results.push_back(result);
+    }
+
+    // One session: the library once, then only each snippet's own code
+    {
+        SessionBenchResult result;
+        result.mode = "session";
+        result.matches = true;
+        auto start = Clock::now();
+        Session session({{std_file, std_source}});
+        result.setup_ms = elapsed_ms(start);
+        if (!session.is_valid()) {
+            result.error_message = "library failed: " + session.get_errors().front();
+            results.push_back(result);
+            return results;
+        }
+
+        std::vector<double> times;
+        for (size_t i = 0; i < snippets; i++) {
+            int32_t x = static_cast<int32_t>(i % 13) - 4;
+            start = Clock::now();
+            auto module = session.compile(session_snippet(i));
+            auto* eval = module->is_valid() ? module->find("Eval") : nullptr;
+            auto value = eval ? eval->call<int32_t>(x) : std::nullopt;
+            module.reset();
+            times.push_back(elapsed_ms(start));
+            if (!value) {
+                result.error_message = "snippet " + std::to_string(i) + " failed";
+                break;
+            }
+            result.matches = result.matches && *value == session_snippet_value(i, x);
+        }
+        result.ok = result.error_message.empty();
+        finish(result, times);
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+void BenchRunner::print_session_summary(const std::vector<SessionBenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "SNIPPET COMPILE AND CALL (ms)" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::cout << std::left << std::setw(10) << "mode" << std::right << std::setw(10) << "snippets" << std::setw(10)
+              << "setup" << std::setw(12) << "total" << std::setw(12) << "per snippet" << std::setw(10) << "late"
+              << std::setw(10) << "speedup" << std::setw(10) << "result" << std::endl;
+
+    double baseline = 0.0;
+    bool all_match = true;
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(10) << result.mode << std::right;
+        if (!result.ok) {
+            std::cout << "ERROR: " << result.error_message << std::endl;
+            all_match = false;
+            continue;
+        }
+        if (baseline == 0.0) {
+            baseline = result.per_snippet_ms();
+        }
+        all_match = all_match && result.matches;
+        std::cout << std::fixed << std::setprecision(3) << std::setw(10) << result.snippets << std::setw(10)
+                  << result.setup_ms << std::setw(12) << result.total_ms << std::setw(12) << result.per_snippet_ms()
+                  << std::setw(10) << result.late_ms << std::setprecision(1) << std::setw(9)
+                  << baseline / result.per_snippet_ms() << "x" << std::setw(10)
+                  << (result.matches ? "match" : "DIFFER") << std::defaultfloat << std::endl;
+    }
+
+    std::cout << "----------------------------------------" << std::endl;
+    std::cout << "Results " << (all_match ? "match" : "DIFFER") << std::endl;
+    std::cout << "========================================" << std::endl;
+}
+
+} // namespace Fern
@@ -0,0 +1,1079 @@
+// frontend.cpp - Benchmarks of loading, lexing, parsing, binding, formatting and the
+// language server
+#include "bench_runner.hpp"
+#include "bench_util.hpp"
+#include "compiler.hpp"
+#include "parser/lexer.hpp"
+#include "parser/parser.hpp"
+#include "semantic/symbol_table_builder.hpp"
+#include "binding/bound_tree_builder.hpp"
+#include "semantic/type_resolver.hpp"
+#include "hlir/bound_to_hlir.hpp"
+#include "ast/ast_printer.hpp"
+#include "common/visitor_dispatch.hpp"
+#include "lsp/server.hpp"
+#include "format/formatter.hpp"
+#include "common/parallel.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace Fern {
+
+// Eight functions of branches, loops, calls and array accesses. The locals and function
+// names are the same at every size, so a bigger file only adds nodes, not names.
+static std::string generate_bind_source(size_t statements) {
+    const size_t functions = 8;
+    std::stringstream source;
+    for (size_t f = 0; f < functions; f++) {
+        source << "fn F" << f << "(i32 a, i32 b) -> i32\n{\n    var x = a\n    var y = b\n"
+               << "    var t = [a, b, 0]\n";
+        for (size_t i = f; i < statements; i += functions) {
+            switch (i % 4) {
+            case 0:
+                source << "    x = x * " << (i % 7 + 2) << " + y\n";
+                break;
+            case 1:
+                source << "    if x > y\n    {\n        y = y + F" << ((f + 1) % functions) << "(x, "
+                       << (i % 10) << ")\n    }\n    else\n    {\n        x = x - 1\n    }\n";
+                break;
+            case 2:
+                source << "    while x < " << (i % 100) << "\n    {\n        x = x + 1\n    }\n";
+                break;
+            default:
+                source << "    t[" << (i % 3) << "] = x\n    y = t[" << ((i + 1) % 3) << "] + y\n";
+                break;
+            }
+        }
+        source << "    return x + y\n}\n";
+    }
+    return source.str();
+}
+
+std::vector<BindBenchResult> BenchRunner::run_bind_benchmark(size_t statements) {
+    std::vector<BindBenchResult> results;
+    std::cout << "Binding generated files of " << statements << " and " << statements * 2 << " statements ("
+              << iterations << " iterations)...\n" << std::endl;
+
+    for (size_t size : {statements, statements * 2}) {
+        BindBenchResult result;
+        result.statements = size;
+        std::string source = generate_bind_source(size);
+
+        Lexer lexer(source);
+        auto tokens = lexer.tokenize_all();
+        Parser parser(tokens);
+        auto ast = parser.parse();
+        if (lexer.has_errors() || !ast || !parser.getErrors().empty()) {
+            result.error_message = "generated source didn't parse";
+            results.push_back(result);
+            continue;
+        }
+
+        TypeSystem types;
+        SymbolTable symbols(types);
+        SymbolTableBuilder declarations(symbols);
+        declarations.build(ast);
+
+        for (int i = 0; i < iterations; i++) {
+            BoundTreeBuilder binder(symbols);
+            size_t chunks_before = binder.get_arena().chunkCount();
+
+            auto allocations_before = heap_allocation_count();
+            auto start = Clock::now();
+            auto unit = binder.bind(ast);
+            double ms = elapsed_ms(start);
+            auto allocations_after = heap_allocation_count();
+
+            if (!unit) {
+                result.error_message = "bind failed";
+                break;
+            }
+            if (i == 0 || ms < result.bind_ms) {
+                result.bind_ms = ms;
+            }
+            if (allocations_before && allocations_after) {
+                result.allocations = *allocations_after - *allocations_before;
+            }
+            result.nodes = binder.get_arena().objectCount();
+            result.arena_chunks = binder.get_arena().chunkCount() - chunks_before;
+            result.names = binder.get_arena().internedNames();
+            result.ok = true;
+        }
+        results.push_back(result);
+    }
+    return results;
+}
+
+void BenchRunner::print_bind_summary(const std::vector<BindBenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "BIND BENCHMARK (heap allocations in BoundTreeBuilder::bind, ms best of " << iterations << ")"
+              << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::right << std::setw(12) << "statements" << std::setw(10) << "nodes" << std::setw(10) << "allocs"
+              << std::setw(10) << "chunks" << std::setw(8) << "names" << std::setw(12) << "per node" << std::setw(10)
+              << "bind" << std::endl;
+
+    for (const auto& result : results) {
+        std::cout << std::setw(12) << result.statements;
+        if (!result.ok) {
+            std::cout << "  ERROR: " << result.error_message << std::endl;
+            continue;
+        }
+        std::cout << std::setw(10) << result.nodes << std::setw(10);
+        if (result.allocations) {
+            std::cout << *result.allocations;
+        } else {
+            std::cout << "-";
+        }
+        std::cout << std::setw(10) << result.arena_chunks << std::setw(8) << result.names << std::setw(12);
+        if (result.allocations) {
+            std::cout << std::fixed << std::setprecision(4) << result.allocations_per_node();
+        } else {
+            std::cout << "-";
+        }
+        std::cout << std::fixed << std::setprecision(3) << std::setw(10) << result.bind_ms << std::defaultfloat
+                  << std::endl;
+    }
+
+    if (!results.empty() && results[0].ok && !results[0].allocations) {
+        std::cout << "----------------------------------------" << std::endl;
+        std::cout << "Heap allocations are only counted by the FernBench build" << std::endl;
+    } else if (results.size() == 2 && results[0].ok && results[1].ok && results[1].nodes > results[0].nodes) {
+        // Whatever the larger file allocates beyond the smaller one, less its extra arena chunks,
+        // is what the extra nodes cost the heap themselves
+        double extra_nodes = double(results[1].nodes - results[0].nodes);
+        double extra = double(*results[1].allocations) - double(*results[0].allocations) -
+                       (double(results[1].arena_chunks) - double(results[0].arena_chunks));
+        std::cout << "----------------------------------------" << std::endl;
+        std::cout << "Allocations per extra node, arena chunks aside: " << std::fixed << std::setprecision(4)
+                  << extra / extra_nodes << std::defaultfloat << std::endl;
+    }
+    std::cout << "========================================" << std::endl;
+}
+
+// File i of the LSP workspace. Files come in groups of ten, each calling the one before it in
+// its group, so a declaration edit reaches the rest of its group and no further. `body` and
+// `fields` vary what an edit changes: the first only a function body, the second the type
+static std::string generate_lsp_file(size_t i, size_t body, size_t fields) {
+    std::stringstream source;
+    source << "type T" << i << "\n{\n    i32 v\n";
+    for (size_t f = 0; f < fields; f++) {
+        source << "    i32 w" << f << "\n";
+    }
+    source << "\n    fn Get -> i32\n    {\n        return v * 2\n    }\n}\n\n";
+
+    source << "fn F" << i << "(i32 a) -> i32\n{\n    var t = new T" << i << "()\n"
+           << "    t.v = a + " << body << "\n";
+    if (i % 10 != 0) {
+        source << "    return t.Get() + F" << i - 1 << "(a - 1)\n";
+    } else {
+        source << "    return t.Get()\n";
+    }
+    source << "}\n";
+    return source.str();
+}
+
+static std::string file_uri(const fs::path& path) {
+    return "file://" + path.generic_string();
+}
+
+std::vector<LSPBenchResult> BenchRunner::run_lsp_benchmark(size_t files, size_t edits) {
+    using LSP::Json;
+    std::vector<LSPBenchResult> results;
+    files = std::max<size_t>(files, 1);
+    std::cout << "Editing a workspace of " << files << " files in the language server (" << edits
+              << " edits of each kind)...\n" << std::endl;
+
+    // The server loads the workspace from disk, as it would for an editor
+    fs::path root = fs::temp_directory_path() / ("fern_lsp_bench_" + std::to_string(files));
+    std::error_code error;
+    fs::remove_all(root, error);
+    fs::create_directories(root, error);
+    if (error) {
+        LSPBenchResult result;
+        result.edit = "open";
+        result.error_message = "can't create " + root.string() + ": " + error.message();
+        results.push_back(result);
+        return results;
+    }
+    for (size_t i = 0; i < files; i++) {
+        std::ofstream(root / ("file" + std::to_string(i) + ".fn")) << generate_lsp_file(i, 0, 0);
+    }
+
+    std::stringstream in;
+    std::stringstream out;
+    LSP::LanguageServer server(in, out);
+
+    auto count_published = [&]() {
+        std::string text = out.str();
+        out.str("");
+        size_t count = 0;
+        for (size_t at = text.find("publishDiagnostics"); at != std::string::npos;
+             at = text.find("publishDiagnostics", at + 1)) {
+            count++;
+        }
+        return count;
+    };
+
+    {
+        LSPBenchResult result;
+        result.edit = "open";
+        result.files = files;
+        result.edits = 1;
+
+        Json params;
+        params.set("rootUri", file_uri(root));
+        Json message;
+        message.set("jsonrpc", "2.0");
+        message.set("id", 1);
+        message.set("method", "initialize");
+        message.set("params", std::move(params));
+
+        auto start = Clock::now();
+        server.handle(message);
+        result.p50_ms = result.p99_ms = result.max_ms = elapsed_ms(start);
+        result.files_analyzed = double(server.get_workspace().get_last_update().files_analyzed);
+        count_published();
+
+        size_t with_errors = 0;
+        for (const auto& document : server.get_workspace().get_documents()) {
+            if (!document->current_diagnostics().empty()) {
+                with_errors++;
+            }
+        }
+        if (server.get_workspace().get_documents().size() != files) {
+            result.error_message = "loaded " + std::to_string(server.get_workspace().get_documents().size()) + " files";
+        } else if (with_errors > 0) {
+            result.error_message = std::to_string(with_errors) + " generated files have errors";
+        }
+        result.ok = result.error_message.empty();
+        results.push_back(result);
+        if (!result.ok) {
+            fs::remove_all(root, error);
+            return results;
+        }
+    }
+
+    // Edits spread over the workspace; every file keeps the version of its last edit
+    std::vector<size_t> bodies(files, 0);
+    std::vector<size_t> fields(files, 0);
+    int version = 1;
+
+    for (bool declarations : {false, true}) {
+        LSPBenchResult result;
+        result.edit = declarations ? "declaration" : "body";
+        result.files = files;
+
+        std::vector<double> times;
+        size_t analyzed = 0;
+        for (size_t e = 0; e < edits; e++) {
+            size_t i = (e * 37) % files;
+            if (declarations) {
+                fields[i] = (fields[i] + 1) % 3;
+            } else {
+                bodies[i]++;
+            }
+
+            fs::path path = root / ("file" + std::to_string(i) + ".fn");
+            Json document;
+            document.set("uri", file_uri(path));
+            document.set("version", ++version);
+            Json change;
+            change.set("text", generate_lsp_file(i, bodies[i], fields[i]));
+            Json params;
+            params.set("textDocument", std::move(document));
+            params.set("contentChanges", Json::Array{std::move(change)});
+            Json message;
+            message.set("jsonrpc", "2.0");
+            message.set("method", "textDocument/didChange");
+            message.set("params", std::move(params));
+
+            auto start = Clock::now();
+            server.handle(message);
+            times.push_back(elapsed_ms(start));
+
+            const auto& update = server.get_workspace().get_last_update();
+            analyzed += update.files_analyzed;
+            if (update.declarations_changed != declarations) {
+                result.error_message = "edit " + std::to_string(e) + " was treated as a " +
+                                       (update.declarations_changed ? "declaration" : "body") + " edit";
+                break;
+            }
+            if (count_published() == 0) {
+                result.error_message = "edit " + std::to_string(e) + " published no diagnostics";
+                break;
+            }
+            const LSP::Document* edited = nullptr;
+            for (const auto& candidate : server.get_workspace().get_documents()) {
+                if (fs::path(candidate->name) == path) {
+                    edited = candidate.get();
+                }
+            }
+            if (!edited) {
+                result.error_message = "edit " + std::to_string(e) + " opened a new document";
+                break;
+            }
+            if (!edited->current_diagnostics().empty()) {
+                result.error_message = "edit " + std::to_string(e) + ": " + edited->current_diagnostics().front().message;
+                break;
+            }
+        }
+
+        if (!times.empty()) {
+            result.edits = times.size();
+            result.files_analyzed = double(analyzed) / times.size();
+            std::sort(times.begin(), times.end());
+            result.p50_ms = times[times.size() / 2];
+            result.p99_ms = times[std::min(times.size() - 1, times.size() * 99 / 100)];
+            result.max_ms = times.back();
+        }
+        result.ok = result.error_message.empty() && !times.empty();
+        if (times.empty() && result.error_message.empty()) {
+            result.error_message = "no edits";
+        }
+        results.push_back(result);
+    }
+
+    fs::remove_all(root, error);
+    return results;
+}
+
+void BenchRunner::print_lsp_summary(const std::vector<LSPBenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "LSP BENCHMARK (didChange -> publishDiagnostics, ms)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::right << std::setw(12) << "edit" << std::setw(8) << "files" << std::setw(8) << "edits"
+              << std::setw(10) << "analyzed" << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10)
+              << "max" << std::endl;
+
+    for (const auto& result : results) {
+        std::cout << std::setw(12) << result.edit;
+        if (!result.ok) {
+            std::cout << "  ERROR: " << result.error_message << std::endl;
+            continue;
+        }
+        std::cout << std::setw(8) << result.files << std::setw(8) << result.edits << std::fixed
+                  << std::setprecision(1) << std::setw(10) << result.files_analyzed << std::setprecision(3)
+                  << std::setw(10) << result.p50_ms << std::setw(10) << result.p99_ms << std::setw(10)
+                  << result.max_ms << std::defaultfloat << std::endl;
+    }
+    std::cout << "========================================" << std::endl;
+}
+
+// Functions of about a dozen lines, with a type every fifth one, until the file is `lines`
+// long. `literals` gets the offset of each function's first number, where the edits go
+static std::string generate_reparse_source(size_t lines, std::vector<size_t>& literals) {
+    std::string source;
+    size_t line_count = 0;
+    for (size_t f = 0; line_count < lines; f++) {
+        std::stringstream chunk;
+        if (f % 5 == 0) {
+            chunk << "type T" << f << "\n{\n    i32 x, y\n    f32 z\n\n    fn Sum -> i32\n    {\n"
+                  << "        return x + y\n    }\n}\n\n";
+        }
+        chunk << "fn F" << f << "(i32 a, i32 b) -> i32\n{\n    var x = a * ";
+        std::string head = chunk.str();
+        literals.push_back(source.size() + head.size());
+        chunk << (f % 97 + 1) << "\n    if x > b\n    {\n        x = x - 1 -- count down\n    }\n"
+              << "    while b < x\n    {\n        b = b + 2\n    }\n    return x + b\n}\n\n";
+
+        std::string text = chunk.str();
+        line_count += std::count(text.begin(), text.end(), '\n');
+        source += text;
+    }
+    return source;
+}
+
+std::vector<ReparseBenchResult> BenchRunner::run_reparse_benchmark(size_t lines, size_t edits) {
+    std::vector<ReparseBenchResult> results;
+    std::vector<size_t> literals;
+    std::string source = generate_reparse_source(lines, literals);
+    edits = std::max<size_t>(edits, 2);
+    std::cout << "Making " << edits << " single-character edits to a file of " << lines << " lines ("
+              << source.size() / 1024 << " KB)...\n" << std::endl;
+
+    ReparseBenchResult full;
+    full.mode = "full";
+    ReparseBenchResult incremental;
+    incremental.mode = "reparse";
+    full.lines = incremental.lines = lines;
+
+    auto tokens = std::make_unique<TokenStream>(Lexer(source).tokenize_all());
+    auto parser = std::make_unique<Parser>(*tokens);
+    auto unit = parser->parse();
+    if (parser->hasErrors()) {
+        full.error_message = incremental.error_message = "generated source didn't parse";
+        return {full, incremental};
+    }
+
+    // Insert a digit into a function's first number, then take it out again, spread over the file
+    std::vector<double> full_times;
+    std::vector<double> reparse_times;
+    size_t reused = 0;
+    for (size_t e = 0; e < edits; e++) {
+        size_t offset = literals[(e / 2) * 7919 % literals.size()];
+        bool inserting = e % 2 == 0;
+        TextEdit edit{static_cast<int>(offset), inserting ? 0 : 1, inserting ? 1 : 0};
+        source = inserting ? source.substr(0, offset) + "1" + source.substr(offset)
+                           : source.substr(0, offset) + source.substr(offset + 1);
+
+        auto start = Clock::now();
+        Lexer lexer(source);
+        auto fresh_tokens = lexer.tokenize_all();
+        Parser fresh(fresh_tokens);
+        auto fresh_unit = fresh.parse();
+        full_times.push_back(elapsed_ms(start));
+
+        start = Clock::now();
+        auto next = std::make_unique<Parser>(*tokens);
+        unit = next->reparse(std::move(parser), unit, edit, source);
+        parser = std::move(next);
+        reparse_times.push_back(elapsed_ms(start));
+        reused += parser->getReusedCount();
+
+        if (parser->hasErrors() || fresh.hasErrors() ||
+            unit->topLevelStatements.size() != fresh_unit->topLevelStatements.size() ||
+            tokens->get_tokens().size() != fresh_tokens.get_tokens().size()) {
+            incremental.error_message = "edit " + std::to_string(e) + " reparsed differently from a full parse";
+            break;
+        }
+    }
+
+    auto finish = [&](ReparseBenchResult& result, std::vector<double>& times) {
+        result.edits = times.size();
+        if (times.empty()) {
+            return;
+        }
+        std::sort(times.begin(), times.end());
+        result.p50_ms = times[times.size() / 2];
+        result.p99_ms = times[std::min(times.size() - 1, times.size() * 99 / 100)];
+        result.ok = result.error_message.empty();
+    };
+    finish(full, full_times);
+    finish(incremental, reparse_times);
+    incremental.reused = reparse_times.empty() ? 0.0 : double(reused) / reparse_times.size();
+    return {full, incremental};
+}
+
+void BenchRunner::print_reparse_summary(const std::vector<ReparseBenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "REPARSE BENCHMARK (one edit to parsed tree, ms)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::right << std::setw(10) << "mode" << std::setw(8) << "lines" << std::setw(8) << "edits"
+              << std::setw(10) << "reused" << std::setw(10) << "p50" << std::setw(10) << "p99" << std::endl;
+
+    for (const auto& result : results) {
+        std::cout << std::setw(10) << result.mode;
+        if (!result.ok) {
+            std::cout << "  ERROR: " << result.error_message << std::endl;
+            continue;
+        }
+        std::cout << std::setw(8) << result.lines << std::setw(8) << result.edits << std::fixed
+                  << std::setprecision(1) << std::setw(10) << result.reused << std::setprecision(3)
+                  << std::setw(10) << result.p50_ms << std::setw(10) << result.p99_ms << std::defaultfloat
+                  << std::endl;
+    }
+
+    if (results.size() == 2 && results[0].ok && results[1].ok && results[1].p50_ms > 0.0) {
+        std::cout << "----------------------------------------" << std::endl;
+        std::cout << "Median speedup: " << std::fixed << std::setprecision(1) << results[0].p50_ms / results[1].p50_ms
+                  << "x" << std::defaultfloat << std::endl;
+    }
+    std::cout << "========================================" << std::endl;
+}
+
+std::vector<ParseBenchResult> BenchRunner::run_parse_benchmark(size_t lines) {
+    lines = std::max<size_t>(lines, 1);
+    std::cout << "Lexing and parsing generated files of " << lines << " lines of declarations and " << lines
+              << " statements (" << iterations << " iterations)...\n" << std::endl;
+
+    std::vector<size_t> literals;
+    std::pair<const char*, std::string> sources[] = {
+        {"declarations", generate_reparse_source(lines, literals)},
+        {"statements", generate_bind_source(lines)},
+    };
+
+    std::vector<ParseBenchResult> results;
+    for (const auto& [name, source] : sources) {
+        ParseBenchResult result;
+        result.source = name;
+        result.bytes = source.size();
+
+        for (int i = 0; i < iterations; i++) {
+            auto start = Clock::now();
+            Lexer lexer(source);
+            auto tokens = lexer.tokenize_all();
+            double lex_ms = elapsed_ms(start);
+
+            start = Clock::now();
+            Parser parser(tokens);
+            parser.parse();
+            double parse_ms = elapsed_ms(start);
+
+            if (lexer.has_errors() || parser.hasErrors()) {
+                result.error_message = "generated source didn't parse";
+                break;
+            }
+            result.tokens = tokens.get_tokens().size();
+            result.lex_ms = i == 0 ? lex_ms : std::min(result.lex_ms, lex_ms);
+            result.parse_ms = i == 0 ? parse_ms : std::min(result.parse_ms, parse_ms);
+        }
+        result.ok = result.error_message.empty();
+        results.push_back(result);
+    }
+    return results;
+}
+
+void BenchRunner::print_parse_summary(const std::vector<ParseBenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "PARSE BENCHMARK (ms best of " << iterations << ", millions of tokens per second)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::right << std::setw(14) << "source" << std::setw(9) << "MB" << std::setw(10) << "tokens"
+              << std::setw(10) << "lex" << std::setw(8) << "M/s" << std::setw(10) << "parse" << std::setw(8) << "M/s"
+              << std::endl;
+
+    for (const auto& result : results) {
+        std::cout << std::setw(14) << result.source;
+        if (!result.ok) {
+            std::cout << "  ERROR: " << result.error_message << std::endl;
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision(2) << std::setw(9) << result.bytes / 1e6 << std::setw(10)
+                  << result.tokens << std::setprecision(1) << std::setw(10) << result.lex_ms << std::setprecision(2)
+                  << std::setw(8) << result.lex_tokens_per_second() / 1e6 << std::setprecision(1) << std::setw(10)
+                  << result.parse_ms << std::setprecision(2) << std::setw(8)
+                  << result.parse_tokens_per_second() / 1e6 << std::defaultfloat << std::endl;
+    }
+    std::cout << "========================================" << std::endl;
+}
+
+// `var x = a < a < ... < a`: every `<` could open generic arguments, and finding out that it
+// doesn't reads to the end of the chain
+static std::string generate_comparison_chain(size_t length) {
+    std::string source = "fn Main\n{\n    var x = a";
+    for (size_t i = 0; i < length; i++) {
+        source += " < a";
+    }
+    return source + "\n}\n";
+}
+
+// Lambdas in var initializers, each body declaring the next. An initializer is parsed once to
+// look for property accessors and then again for real, so without a memo every level doubles
+static std::string generate_nested_initializers(size_t depth) {
+    std::string source = "fn Main\n{\n";
+    for (size_t i = 0; i < depth; i++) {
+        source += std::string(4 * (i + 1), ' ') + "var v" + std::to_string(i) + " = (x) => {\n";
+    }
+    source += std::string(4 * (depth + 1), ' ') + "x\n";
+    for (size_t i = depth; i > 0; i--) {
+        source += std::string(4 * i, ' ') + "}\n";
+    }
+    return source + "}\n";
+}
+
+std::vector<MemoBenchResult> BenchRunner::run_memo_benchmark(size_t length) {
+    length = std::max<size_t>(length, 1);
+    std::cout << "Parsing comparison chains of " << length << " to " << length * 4
+              << " and var initializers nested 6 to 10 deep...\n" << std::endl;
+
+    struct Shape {
+        const char* name;
+        std::vector<size_t> sizes;
+        std::string (*generate)(size_t);
+    };
+    std::vector<Shape> shapes = {
+        {"comparisons", {length, length * 2, length * 4}, generate_comparison_chain},
+        {"initializers", {6, 8, 10}, generate_nested_initializers},
+    };
+
+    std::vector<MemoBenchResult> results;
+    for (const auto& shape : shapes) {
+        for (bool memoized : {false, true}) {
+            for (size_t size : shape.sizes) {
+                MemoBenchResult result;
+                result.shape = shape.name;
+                result.size = size;
+                result.memoized = memoized;
+
+                std::string source = shape.generate(size);
+                double best = 0.0;
+                for (int i = 0; i < iterations; i++) {
+                    Lexer lexer(source);
+                    auto tokens = lexer.tokenize_all();
+                    auto start = Clock::now();
+                    Parser parser(tokens);
+                    parser.setMemoization(memoized);
+                    parser.parse();
+                    double ms = elapsed_ms(start);
+                    best = i == 0 ? ms : std::min(best, ms);
+
+                    if (parser.hasErrors()) {
+                        result.error_message = parser.getErrors().front().message;
+                        break;
+                    }
+                    result.hits = parser.getMemoStats().hits;
+                    result.misses = parser.getMemoStats().misses;
+                }
+                result.ms = best;
+                result.ok = result.error_message.empty();
+                results.push_back(result);
+            }
+        }
+    }
+    return results;
+}
+
+void BenchRunner::print_memo_summary(const std::vector<MemoBenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "PARSER MEMO BENCHMARK (parse only, ms)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::right << std::setw(14) << "shape" << std::setw(7) << "size" << std::setw(6) << "memo"
+              << std::setw(12) << "ms" << std::setw(9) << "growth" << std::setw(9) << "hits" << std::setw(9)
+              << "misses" << std::endl;
+
+    const MemoBenchResult* previous = nullptr;
+    for (const auto& result : results) {
+        std::cout << std::setw(14) << result.shape << std::setw(7) << result.size << std::setw(6)
+                  << (result.memoized ? "on" : "off");
+        if (!result.ok) {
+            std::cout << "  ERROR: " << result.error_message << std::endl;
+            previous = nullptr;
+            continue;
+        }
+
+        // How much longer than the next smaller input of the same shape and mode
+        std::cout << std::fixed << std::setprecision(3) << std::setw(12) << result.ms << std::setprecision(1);
+        if (previous && previous->shape == result.shape && previous->memoized == result.memoized &&
+            previous->ms > 0.0) {
+            std::cout << std::setw(8) << result.ms / previous->ms << "x";
+        } else {
+            std::cout << std::setw(9) << "-";
+        }
+        std::cout << std::defaultfloat << std::setw(9) << result.hits << std::setw(9) << result.misses << std::endl;
+        previous = &result;
+    }
+    std::cout << "========================================" << std::endl;
+}
+
+std::vector<FmtBenchResult> BenchRunner::run_fmt_benchmark(const std::vector<std::string>& corpus_dirs,
+                                                         const std::vector<std::string>& idempotence_dirs,
+                                                         size_t copies, unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    copies = std::max<size_t>(copies, 1);
+
+    std::vector<std::string> corpus;
+    for (const auto& path : Formatter::collect_sources(corpus_dirs)) {
+        corpus.push_back(read_file(path));
+    }
+    size_t corpus_bytes = 0;
+    for (const auto& source : corpus) {
+        corpus_bytes += source.size();
+    }
+    std::cout << "Formatting " << copies << " copies of " << corpus.size() << " files (" << corpus_bytes / 1024
+              << " KB each time) on 1 and " << threads << " threads...\n" << std::endl;
+
+    Formatter formatter;
+    auto run = [&](unsigned thread_count) {
+        FmtBenchResult result;
+        result.mode = std::to_string(thread_count) + (thread_count == 1 ? " thread" : " threads");
+        result.files = corpus.size() * copies;
+        result.bytes = corpus_bytes * copies;
+        if (corpus.empty()) {
+            result.error_message = "no .fn files found";
+            return result;
+        }
+
+        std::atomic<size_t> changed{0};
+        std::atomic<size_t> failed{0};
+        auto start = Clock::now();
+        parallel_for(result.files, thread_count, [&](size_t i) {
+            thread_local std::string formatted;
+            const std::string& source = corpus[i % corpus.size()];
+            if (!formatter.format(source, formatted)) {
+                failed++;
+            } else if (formatted != source) {
+                changed++;
+            }
+        });
+        result.ms = elapsed_ms(start);
+        result.changed = changed / copies;
+        if (failed > 0) {
+            result.error_message = std::to_string(failed / copies) + " files didn't format";
+        }
+        result.ok = result.error_message.empty();
+        return result;
+    };
+
+    std::vector<FmtBenchResult> results;
+    results.push_back(run(1));
+    if (threads > 1) {
+        results.push_back(run(threads));
+    }
+
+    // Formatted text must come back unchanged when formatted again
+    FmtBenchResult idempotent;
+    idempotent.mode = "idempotent";
+    auto start = Clock::now();
+    std::string once;
+    std::string twice;
+    for (const auto& path : Formatter::collect_sources(idempotence_dirs)) {
+        std::string source = read_file(path);
+        std::string error;
+        idempotent.files++;
+        idempotent.bytes += source.size();
+        if (!formatter.format(source, once, &error) || !formatter.format(once, twice, &error)) {
+            idempotent.error_message = path + ": " + error;
+            break;
+        }
+        if (once != source) {
+            idempotent.changed++;
+        }
+        if (twice != once) {
+            idempotent.error_message = path + " changed when formatted a second time";
+            break;
+        }
+    }
+    idempotent.ms = elapsed_ms(start);
+    idempotent.ok = idempotent.error_message.empty() && idempotent.files > 0;
+    if (idempotent.files == 0) {
+        idempotent.error_message = "no .fn files found";
+    }
+    results.push_back(idempotent);
+    return results;
+}
+
+void BenchRunner::print_fmt_summary(const std::vector<FmtBenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "FORMAT BENCHMARK (in memory, nothing written)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::right << std::setw(12) << "mode" << std::setw(9) << "files" << std::setw(9) << "changed"
+              << std::setw(10) << "ms" << std::setw(12) << "files/s" << std::setw(9) << "MB/s" << std::endl;
+
+    for (const auto& result : results) {
+        std::cout << std::setw(12) << result.mode;
+        if (!result.ok) {
+            std::cout << "  ERROR: " << result.error_message << std::endl;
+            continue;
+        }
+        double seconds = result.ms / 1000.0;
+        std::cout << std::setw(9) << result.files << std::setw(9) << result.changed << std::fixed
+                  << std::setprecision(1) << std::setw(10) << result.ms << std::setprecision(0) << std::setw(12)
+                  << (seconds > 0.0 ? result.files / seconds : 0.0) << std::setprecision(1) << std::setw(9)
+                  << (seconds > 0.0 ? result.bytes / seconds / (1024.0 * 1024.0) : 0.0) << std::defaultfloat
+                  << std::endl;
+    }
+
+    if (results.size() >= 3 && results[0].ok && results[1].ok && results[1].ms > 0.0) {
+        std::cout << "----------------------------------------" << std::endl;
+        std::cout << "Parallel speedup: " << std::fixed << std::setprecision(1) << results[0].ms / results[1].ms
+                  << "x" << std::defaultfloat << std::endl;
+    }
+    std::cout << "========================================" << std::endl;
+}
+
+std::vector<DispatchBenchResult> BenchRunner::run_dispatch_benchmark(size_t statements) {
+    statements = std::max<size_t>(statements, 1);
+    std::cout << "Running each pass over a generated file of " << statements
+              << " statements with switch and virtual dispatch (" << iterations << " iterations)...\n" << std::endl;
+
+    const char* passes[] = {"declare", "bind", "resolve", "lower", "print"};
+    std::vector<DispatchBenchResult> results;
+    for (const char* pass : passes) {
+        DispatchBenchResult result;
+        result.pass = pass;
+        result.statements = statements;
+        results.push_back(result);
+    }
+
+    std::string source = generate_bind_source(statements);
+    std::string printed[2];
+    std::string lowered[2];
+    std::string error;
+    VisitorDispatch saved = visitor_dispatch;
+
+    for (VisitorDispatch mode : {VisitorDispatch::Switch, VisitorDispatch::Virtual}) {
+        visitor_dispatch = mode;
+        size_t m = mode == VisitorDispatch::Switch ? 0 : 1;
+
+        for (int i = 0; i < iterations && error.empty(); i++) {
+            Lexer lexer(source);
+            auto tokens = lexer.tokenize_all();
+            Parser parser(tokens);
+            auto ast = parser.parse();
+            if (lexer.has_errors() || !ast || parser.hasErrors()) {
+                error = "generated source didn't parse";
+                break;
+            }
+
+            TypeSystem types;
+            SymbolTable symbols(types);
+            double ms[5];
+
+            auto start = Clock::now();
+            SymbolTableBuilder declarations(symbols);
+            declarations.build(ast);
+            ms[0] = elapsed_ms(start);
+
+            start = Clock::now();
+            BoundTreeBuilder binder(symbols);
+            auto unit = binder.bind(ast);
+            ms[1] = elapsed_ms(start);
+
+            start = Clock::now();
+            TypeResolver resolver(symbols);
+            bool resolved = resolver.resolve(unit);
+            ms[2] = elapsed_ms(start);
+            if (!unit || !resolved) {
+                error = "generated source didn't resolve";
+                break;
+            }
+
+            HLIR::Module module("generated", symbols.get_global_namespace());
+            start = Clock::now();
+            HLIR::BoundToHLIR lowering(&module, &types);
+            lowering.build(unit);
+            ms[3] = elapsed_ms(start);
+
+            start = Clock::now();
+            AstPrinter printer;
+            std::string text = printer.get_string(ast);
+            ms[4] = elapsed_ms(start);
+
+            for (size_t p = 0; p < results.size(); p++) {
+                double& best = m == 0 ? results[p].switch_ms : results[p].virtual_ms;
+                best = i == 0 ? ms[p] : std::min(best, ms[p]);
+            }
+            if (i == 0) {
+                printed[m] = std::move(text);
+                lowered[m] = module.dump();
+            }
+        }
+    }
+    visitor_dispatch = saved;
+
+    bool matches = printed[0] == printed[1] && lowered[0] == lowered[1];
+    for (auto& result : results) {
+        result.ok = error.empty();
+        result.error_message = error;
+        result.matches = matches;
+    }
+    return results;
+}
+
+void BenchRunner::print_dispatch_summary(const std::vector<DispatchBenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "DISPATCH BENCHMARK (ms best of " << iterations << ")" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::right << std::setw(10) << "pass" << std::setw(12) << "switch" << std::setw(12) << "virtual"
+              << std::setw(10) << "ratio" << std::endl;
+
+    for (const auto& result : results) {
+        std::cout << std::setw(10) << result.pass;
+        if (!result.ok) {
+            std::cout << "  ERROR: " << result.error_message << std::endl;
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision(3) << std::setw(12) << result.switch_ms << std::setw(12)
+                  << result.virtual_ms << std::setprecision(2) << std::setw(9)
+                  << (result.switch_ms > 0.0 ? result.virtual_ms / result.switch_ms : 0.0) << "x"
+                  << std::defaultfloat << std::endl;
+    }
+
+    if (!results.empty() && results[0].ok) {
+        std::cout << "----------------------------------------" << std::endl;
+        std::cout << "Same AST and HLIR both ways: " << (results[0].matches ? "yes" : "NO") << std::endl;
+    }
+    std::cout << "========================================" << std::endl;
+}
+
+// Resident memory from /proc/self/status ("VmRSS" now, "VmHWM" at its peak) in bytes, 0 where
+// there's no /proc
+static size_t resident_bytes(const std::string& field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, field.size(), field) == 0 && line.size() > field.size() && line[field.size()] == ':') {
+            return std::strtoull(line.c_str() + field.size() + 1, nullptr, 10) * 1024;
+        }
+    }
+    return 0;
+}
+
+// Gives freed memory back and starts VmHWM again from what's resident now, so each run's peak
+// is its own
+static void reset_peak_memory() {
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+// SourceFile as it was, holding its text by value
+struct CopiedSourceFile {
+    std::string filename;
+    std::string source;
+};
+
+template <typename File, typename Load, typename Text>
+static LoadBenchResult time_load(const char* mode, const std::vector<std::string>& paths, int iterations,
+                                 Load load, Text text) {
+    LoadBenchResult result;
+    result.mode = mode;
+    result.files = paths.size();
+    try {
+        for (int i = 0; i < iterations; i++) {
+            reset_peak_memory();
+            size_t before = resident_bytes("VmRSS");
+
+            auto start = Clock::now();
+            std::vector<File> files;
+            files.reserve(paths.size());
+            for (const auto& path : paths) {
+                files.push_back(load(path));
+            }
+            // Compiler::compile copies each SourceFile into its FileCompilationState
+            std::vector<File> states(files.begin(), files.end());
+            double load_ms = elapsed_ms(start);
+
+            start = Clock::now();
+            uint64_t checksum = 0;
+            size_t bytes = 0;
+            for (const auto& state : states) {
+                std::string_view source = text(state);
+                for (char c : source) {
+                    checksum += static_cast<unsigned char>(c);
+                }
+                bytes += source.size();
+            }
+            double scan_ms = elapsed_ms(start);
+
+            size_t peak = resident_bytes("VmHWM");
+            result.peak_bytes = std::max(result.peak_bytes, peak > before ? peak - before : 0);
+            result.bytes = bytes;
+            result.checksum = checksum;
+            result.load_ms = i == 0 ? load_ms : std::min(result.load_ms, load_ms);
+            result.scan_ms = i == 0 ? scan_ms : std::min(result.scan_ms, scan_ms);
+        }
+    } catch (const std::exception& e) {
+        result.error_message = e.what();
+    }
+    result.ok = result.error_message.empty();
+    return result;
+}
+
+std::vector<LoadBenchResult> BenchRunner::run_load_benchmark(size_t megabytes) {
+    const size_t file_bytes = 4 << 20;
+    size_t file_count = std::max<size_t>(megabytes / 4, 1);
+    std::cout << "Loading " << file_count << " generated files of 4 MB through std::stringstream and mapped "
+              << "source buffers (" << iterations << " iterations)...\n" << std::endl;
+
+    std::vector<LoadBenchResult> results;
+    fs::path root = fs::temp_directory_path() / ("fern_load_bench_" + std::to_string(megabytes));
+    std::error_code error;
+    fs::remove_all(root, error);
+    fs::create_directories(root, error);
+    if (error) {
+        LoadBenchResult result;
+        result.mode = "write";
+        result.error_message = "can't create " + root.string() + ": " + error.message();
+        results.push_back(result);
+        return results;
+    }
+
+    std::vector<size_t> literals;
+    std::string unit = generate_reparse_source(10000, literals);
+    std::string text;
+    while (text.size() < file_bytes) {
+        text += unit;
+    }
+
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < file_count; i++) {
+        paths.push_back((root / ("file" + std::to_string(i) + ".fn")).string());
+        std::ofstream file(paths.back(), std::ios::binary);
+        file.write(text.data(), std::streamsize(text.size()));
+        if (!file) {
+            LoadBenchResult result;
+            result.mode = "write";
+            result.error_message = "can't write " + paths.back();
+            results.push_back(result);
+            fs::remove_all(root, error);
+            return results;
+        }
+    }
+    text = {};
+    unit = {};
+
+    // The way main and the test runner read their inputs before source buffers
+    results.push_back(time_load<CopiedSourceFile>(
+        "stringstream", paths, iterations,
+        [](const std::string& path) {
+            auto source = read_file(path);
+            return CopiedSourceFile{path, source};
+        },
+        [](const CopiedSourceFile& file) { return std::string_view(file.source); }));
+    results.push_back(time_load<SourceFile>(
+        "mapped", paths, iterations, [](const std::string& path) { return SourceFile::open(path); },
+        [](const SourceFile& file) { return file.source(); }));
+
+    if (results[0].ok && results[1].ok && results[0].checksum != results[1].checksum) {
+        results[1].ok = false;
+        results[1].error_message = "read different text";
+    }
+
+    fs::remove_all(root, error);
+    return results;
+}
+
+void BenchRunner::print_load_summary(const std::vector<LoadBenchResult>& results) {
+    std::cout << "========================================" << std::endl;
+    std::cout << "LOAD BENCHMARK (ms best of " << iterations << ", peak resident MB)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::right << std::setw(14) << "mode" << std::setw(7) << "files" << std::setw(9) << "MB"
+              << std::setw(10) << "load" << std::setw(10) << "scan" << std::setw(10) << "total" << std::setw(10)
+              << "peak" << std::endl;
+
+    for (const auto& result : results) {
+        std::cout << std::setw(14) << result.mode;
+        if (!result.ok) {
+            std::cout << "  ERROR: " << result.error_message << std::endl;
+            continue;
+        }
+        std::cout << std::setw(7) << result.files << std::fixed << std::setprecision(1) << std::setw(9)
+                  << result.bytes / 1e6 << std::setw(10) << result.load_ms << std::setw(10) << result.scan_ms
+                  << std::setw(10) << result.load_ms + result.scan_ms << std::setw(10);
+        if (result.peak_bytes > 0) {
+            std::cout << result.peak_bytes / 1e6;
+        } else {
+            std::cout << "-";
+        }
+        std::cout << std::defaultfloat << std::endl;
+    }
+
+    if (results.size() == 2 && results[0].ok && results[1].ok) {
+        double before = results[0].load_ms + results[0].scan_ms;
+        double after = results[1].load_ms + results[1].scan_ms;
+        std::cout << "----------------------------------------" << std::endl;
+        std::cout << "Load and scan speedup: " << std::fixed << std::setprecision(1)
+                  << (after > 0.0 ? before / after : 0.0) << "x" << std::defaultfloat << std::endl;
+        std::cout << "Mapped pages are clean page cache, shared and dropped under pressure rather than" << std::endl;
+        std::cout << "swapped; copied text is private to the process" << std::endl;
+    }
+    std::cout << "========================================" << std::endl;
+}
+
+} // namespace Fern
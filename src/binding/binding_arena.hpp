@@ -2,9 +2,14 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 #include <new>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
 #include "bound_tree.hpp"
 
 namespace Fern
@@ -38,6 +43,9 @@ namespace Fern
 
         std::vector<Chunk> chunks;
         size_t chunkSize;
+        std::vector<BoundNode*> nodes; // to destroy, oldest first
+        size_t objects = 0;
+        std::unordered_set<std::string_view> names; // views into the chunks
 
     public:
         explicit BindingArena(size_t chunkSize = DEFAULT_CHUNK_SIZE) : chunkSize(chunkSize)
@@ -46,6 +54,12 @@ namespace Fern
             chunks.emplace_back(chunkSize);
         }
 
+        ~BindingArena()
+        {
+            for (auto it = nodes.rbegin(); it != nodes.rend(); ++it)
+                (*it)->~BoundNode();
+        }
+
         // Non-copyable, non-movable
         BindingArena(const BindingArena&) = delete;
         BindingArena& operator=(const BindingArena&) = delete;
@@ -72,22 +86,53 @@ namespace Fern
             return result;
         }
 
-        // Main allocation function for bound nodes
+        // Main allocation function for bound nodes. Their destructors run with the arena's,
+        // which only matters for the type references they hold; everything else a node owns
+        // (lists, names) lives in the arena too
         template<typename T, typename... Args>
         T* make(Args&&... args)
         {
+            static_assert(std::is_base_of_v<BoundNode, T> || std::is_trivially_destructible_v<T>,
+                          "Only bound nodes are destroyed");
             void* memory = allocate(sizeof(T), alignof(T));
-            return new (memory) T(std::forward<Args>(args)...);
+            T* object = new (memory) T(std::forward<Args>(args)...);
+            objects++;
+            if constexpr (std::is_base_of_v<BoundNode, T>)
+            {
+                // Tagged here, not by a constructor, so `T()` still zeroes the node's fields
+                object->boundKind = T::NodeKind;
+                nodes.push_back(object);
+            }
+            return object;
         }
 
-        // Create vector in arena
+        // Room for `count` items that need no destructor, left uninitialized
         template<typename T>
-        std::vector<T>* makeVector()
+        std::span<T> makeArray(size_t count)
         {
-            void* memory = allocate(sizeof(std::vector<T>), alignof(std::vector<T>));
-            return new (memory) std::vector<T>();
+            static_assert(std::is_trivially_destructible_v<T>, "The arena never runs destructors");
+            if (count == 0) return {};
+            return std::span<T>(static_cast<T*>(allocate(sizeof(T) * count, alignof(T))), count);
         }
 
+        // One copy of each distinct name, so bound nodes can hold string_views that live as
+        // long as the tree. Only a new name costs a heap allocation (its slot in the set)
+        std::string_view intern(std::string_view name)
+        {
+            if (name.empty()) return {};
+
+            auto it = names.find(name);
+            if (it != names.end()) return *it;
+
+            auto text = static_cast<char*>(allocate(name.size(), 1));
+            std::memcpy(text, name.data(), name.size());
+            return *names.insert(std::string_view(text, name.size())).first;
+        }
+
+        size_t internedNames() const { return names.size(); }
+        size_t objectCount() const { return objects; }
+        size_t chunkCount() const { return chunks.size(); }
+
         size_t bytesUsed() const
         {
             size_t total = 0;
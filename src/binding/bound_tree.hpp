@@ -4,9 +4,12 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <span>
+#include <string_view>
 #include <variant>
 #include <optional>
 #include "common/source_location.hpp"
+#include "common/visitor_dispatch.hpp"
 #include "common/token.hpp"
 #include "semantic/symbol.hpp"
 #include "conversions.hpp"
@@ -101,6 +104,10 @@ namespace Fern
 
         // Top-level
         virtual void visit(BoundCompilationUnit *node) = 0;
+
+        // Visit `node` as its concrete type with one switch on its kind tag and one
+        // virtual call; BoundSwitchVisitor makes the call direct for a final pass
+        void dispatch(BoundNode *node);
     };
 
     // Value categories
@@ -110,6 +117,18 @@ namespace Fern
         LValue
     };
 
+    // Built-in operations on vector types, resolved in the semantic pass
+    enum class VectorIntrinsic
+    {
+        None,
+        Construct, // f32x4(a, b, c, d), or f32x4(x) to broadcast
+        Shuffle,   // v.shuffle(3, 2, 1, 0) or a.shuffle(b, 0, 4, 1, 5)
+        Sum,       // horizontal reductions: v.sum(), v.product(), v.min(), v.max()
+        Product,
+        Min,
+        Max
+    };
+
     // Constant value for compile-time constants
     using ConstantValue = std::variant<
         std::monostate, // not constant
@@ -117,32 +136,99 @@ namespace Fern
         uint64_t,
         double,
         bool,
-        std::string>;
+        std::string_view>; // interned in the BindingArena
+
+// Every concrete bound node type, as X(Kind, Type). As with FERN_SYNTAX_NODES, each
+// abstract base's subtypes are listed together so its classof is one range check.
+#define FERN_BOUND_NODES(X) \
+    /* expressions */ \
+    X(LiteralExpression, BoundLiteralExpression) \
+    X(NameExpression, BoundNameExpression) \
+    X(BinaryExpression, BoundBinaryExpression) \
+    X(UnaryExpression, BoundUnaryExpression) \
+    X(AssignmentExpression, BoundAssignmentExpression) \
+    X(CallExpression, BoundCallExpression) \
+    X(MemberAccessExpression, BoundMemberAccessExpression) \
+    X(IndexExpression, BoundIndexExpression) \
+    X(NewExpression, BoundNewExpression) \
+    X(ArrayCreationExpression, BoundArrayCreationExpression) \
+    X(CastExpression, BoundCastExpression) \
+    X(ConditionalExpression, BoundConditionalExpression) \
+    X(ThisExpression, BoundThisExpression) \
+    X(TypeOfExpression, BoundTypeOfExpression) \
+    X(SizeOfExpression, BoundSizeOfExpression) \
+    X(ParenthesizedExpression, BoundParenthesizedExpression) \
+    X(ConversionExpression, BoundConversionExpression) \
+    X(TypeExpression, BoundTypeExpression) \
+    /* statements */ \
+    X(BlockStatement, BoundBlockStatement) \
+    X(ExpressionStatement, BoundExpressionStatement) \
+    X(IfStatement, BoundIfStatement) \
+    X(WhileStatement, BoundWhileStatement) \
+    X(ForStatement, BoundForStatement) \
+    X(BreakStatement, BoundBreakStatement) \
+    X(ContinueStatement, BoundContinueStatement) \
+    X(ReturnStatement, BoundReturnStatement) \
+    X(UsingStatement, BoundUsingStatement) \
+    /* declarations */ \
+    X(VariableDeclaration, BoundVariableDeclaration) \
+    X(FunctionDeclaration, BoundFunctionDeclaration) \
+    X(PropertyDeclaration, BoundPropertyDeclaration) \
+    X(TypeDeclaration, BoundTypeDeclaration) \
+    X(NamespaceDeclaration, BoundNamespaceDeclaration) \
+    /* root */ \
+    X(CompilationUnit, BoundCompilationUnit)
+
+    enum class BoundNodeKind : uint8_t
+    {
+#define FERN_BOUND_KIND(Kind, Type) Kind,
+        FERN_BOUND_NODES(FERN_BOUND_KIND)
+#undef FERN_BOUND_KIND
+    };
 
 // Macro for accept implementation
 #define BOUND_ACCEPT_VISITOR \
     inline void accept(BoundVisitor *visitor) override { visitor->visit(this); }
+
+// Members every concrete bound node declares: its kind tag (stamped on the node by
+// BindingArena::make), classof for is<T>()/as<T>(), and accept
+#define BOUND_NODE(Kind)                                                                  \
+    static constexpr BoundNodeKind NodeKind = BoundNodeKind::Kind;                        \
+    static bool classof(const BoundNode *node) { return node->boundKind == NodeKind; } \
+    BOUND_ACCEPT_VISITOR
     // === Base Nodes ===
 
+    // Bound nodes live in a BindingArena: their lists are spans and their names string_views
+    // into it, so a node owns no heap memory of its own
     struct BoundNode
     {
         SourceRange location;
+        BoundNodeKind boundKind; // The concrete type; set by BindingArena::make
 
         virtual ~BoundNode() = default;
         virtual void accept(BoundVisitor *visitor) = 0;
 
+        static bool classof(const BoundNode *) { return true; }
+
+        // Casts check the kind tag through T::classof instead of walking RTTI
         template <typename T>
-        T *as() { return dynamic_cast<T *>(this); }
+        T *as() { return T::classof(this) ? static_cast<T *>(this) : nullptr; }
 
         template <typename T>
-        const T *as() const { return dynamic_cast<const T *>(this); }
+        const T *as() const { return T::classof(this) ? static_cast<const T *>(this) : nullptr; }
 
         template <typename T>
-        bool is() const { return dynamic_cast<const T *>(this) != nullptr; }
+        bool is() const { return T::classof(this); }
     };
 
     struct BoundExpression : BoundNode
     {
+        static bool classof(const BoundNode *node)
+        {
+            return node->boundKind >= BoundNodeKind::LiteralExpression &&
+                   node->boundKind <= BoundNodeKind::TypeExpression;
+        }
+
         TypePtr type = nullptr; // Resolved in semantic pass
         ValueCategory valueCategory = ValueCategory::RValue;
         ConstantValue constantValue;
@@ -155,12 +241,23 @@ namespace Fern
 
     struct BoundStatement : BoundNode
     {
+        static bool classof(const BoundNode *node)
+        {
+            return node->boundKind >= BoundNodeKind::BlockStatement &&
+                   node->boundKind <= BoundNodeKind::NamespaceDeclaration;
+        }
     };
 
     // Base for all declarations (functions, types, variables, etc.)
     struct BoundDeclaration : BoundStatement
     {
-        std::string name;
+        static bool classof(const BoundNode *node)
+        {
+            return node->boundKind >= BoundNodeKind::VariableDeclaration &&
+                   node->boundKind <= BoundNodeKind::NamespaceDeclaration;
+        }
+
+        std::string_view name;
         Symbol *symbol = nullptr; // Resolved in semantic pass
         ModifierKindFlags modifiers = ModifierKindFlags::None;
     };
@@ -171,14 +268,14 @@ namespace Fern
     {
         LiteralKind literalKind;
         // constantValue is stored in base class
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(LiteralExpression)
     };
 
     struct BoundNameExpression : BoundExpression
     {
-        std::vector<std::string> parts; // e.g. ["System", "Console", "WriteLine"]
-        Symbol *symbol = nullptr;       // Resolved in semantic pass
-        BOUND_ACCEPT_VISITOR
+        std::span<std::string_view> parts; // e.g. ["System", "Console", "WriteLine"]
+        Symbol *symbol = nullptr;          // Resolved in semantic pass
+        BOUND_NODE(NameExpression)
     };
 
     struct BoundBinaryExpression : BoundExpression
@@ -187,7 +284,7 @@ namespace Fern
         BoundExpression *right = nullptr;
         BinaryOperatorKind operatorKind;
         FunctionSymbol *operatorMethod = nullptr; // For user-defined operators
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(BinaryExpression)
     };
 
     struct BoundUnaryExpression : BoundExpression
@@ -195,7 +292,7 @@ namespace Fern
         BoundExpression *operand = nullptr;
         UnaryOperatorKind operatorKind;
         FunctionSymbol *operatorMethod = nullptr;
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(UnaryExpression)
     };
 
     struct BoundAssignmentExpression : BoundExpression
@@ -203,23 +300,24 @@ namespace Fern
         BoundExpression *target = nullptr;
         BoundExpression *value = nullptr;
         AssignmentOperatorKind operatorKind;
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(AssignmentExpression)
     };
 
     struct BoundCallExpression : BoundExpression
     {
         BoundExpression *callee = nullptr; // Can be name, member access, etc.
-        std::vector<BoundExpression *> arguments;
+        std::span<BoundExpression *> arguments;
         FunctionSymbol *method = nullptr; // Resolved in semantic pass
-        BOUND_ACCEPT_VISITOR
+        VectorIntrinsic intrinsic = VectorIntrinsic::None; // Set instead of method for vector built-ins
+        BOUND_NODE(CallExpression)
     };
 
     struct BoundMemberAccessExpression : BoundExpression
     {
         BoundExpression *object = nullptr;
-        std::string memberName;
+        std::string_view memberName;
         Symbol *member = nullptr; // Could be field, property, method
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(MemberAccessExpression)
     };
 
     struct BoundIndexExpression : BoundExpression
@@ -227,23 +325,23 @@ namespace Fern
         BoundExpression *object = nullptr;
         BoundExpression *index = nullptr;
         PropertySymbol *indexerProperty = nullptr; // For custom indexers
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(IndexExpression)
     };
 
     struct BoundNewExpression : BoundExpression
     {
         BoundExpression *typeExpression = nullptr; // The type to instantiate
-        std::vector<BoundExpression *> arguments;
+        std::span<BoundExpression *> arguments;
         FunctionSymbol *constructor = nullptr; // Resolved in semantic pass
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(NewExpression)
     };
 
     struct BoundArrayCreationExpression : BoundExpression
     {
         BoundExpression *elementTypeExpression = nullptr;
         BoundExpression *size = nullptr; // Can be null for initializer syntax
-        std::vector<BoundExpression *> initializers;
-        BOUND_ACCEPT_VISITOR
+        std::span<BoundExpression *> initializers;
+        BOUND_NODE(ArrayCreationExpression)
     };
 
     struct BoundCastExpression : BoundExpression
@@ -251,7 +349,7 @@ namespace Fern
         BoundExpression *expression = nullptr;
         BoundExpression *targetTypeExpression = nullptr;
         ConversionKind conversionKind = ConversionKind::NoConversion; // Set in semantic pass
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(CastExpression)
     };
 
     struct BoundConditionalExpression : BoundExpression
@@ -259,31 +357,31 @@ namespace Fern
         BoundExpression *condition = nullptr;
         BoundExpression *thenExpression = nullptr;
         BoundExpression *elseExpression = nullptr;
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(ConditionalExpression)
     };
 
     struct BoundThisExpression : BoundExpression
     {
         TypeSymbol *containingType = nullptr; // Resolved in semantic pass
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(ThisExpression)
     };
 
     struct BoundTypeOfExpression : BoundExpression
     {
         BoundExpression *typeExpression = nullptr;
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(TypeOfExpression)
     };
 
     struct BoundSizeOfExpression : BoundExpression
     {
         BoundExpression *typeExpression = nullptr;
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(SizeOfExpression)
     };
 
     struct BoundParenthesizedExpression : BoundExpression
     {
         BoundExpression *expression = nullptr;
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(ParenthesizedExpression)
     };
 
     struct BoundConversionExpression : BoundExpression
@@ -291,22 +389,22 @@ namespace Fern
         BoundExpression *expression = nullptr;
         ConversionKind conversionKind;
         // type is stored in base class
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(ConversionExpression)
     };
 
     // === Statements ===
 
     struct BoundBlockStatement : BoundStatement
     {
-        std::vector<BoundStatement *> statements;
+        std::span<BoundStatement *> statements;
         Symbol *symbol = nullptr;  // The $block namespace symbol
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(BlockStatement)
     };
 
     struct BoundExpressionStatement : BoundStatement
     {
         BoundExpression *expression = nullptr;
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(ExpressionStatement)
     };
 
     struct BoundIfStatement : BoundStatement
@@ -314,48 +412,48 @@ namespace Fern
         BoundExpression *condition = nullptr;
         BoundStatement *thenStatement = nullptr;
         BoundStatement *elseStatement = nullptr;
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(IfStatement)
     };
 
     struct BoundWhileStatement : BoundStatement
     {
         BoundExpression *condition = nullptr;
         BoundStatement *body = nullptr;
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(WhileStatement)
     };
 
     struct BoundForStatement : BoundStatement
     {
         BoundStatement *initializer = nullptr;
         BoundExpression *condition = nullptr;
-        std::vector<BoundExpression *> incrementors;
+        std::span<BoundExpression *> incrementors;
         BoundStatement *body = nullptr;
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(ForStatement)
     };
 
     struct BoundBreakStatement : BoundStatement
     {
         // Target loop will be resolved in semantic pass
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(BreakStatement)
     };
 
     struct BoundContinueStatement : BoundStatement
     {
         // Target loop will be resolved in semantic pass
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(ContinueStatement)
     };
 
     struct BoundReturnStatement : BoundStatement
     {
         BoundExpression *value = nullptr;
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(ReturnStatement)
     };
 
     struct BoundUsingStatement : BoundStatement
     {
-        std::vector<std::string> namespaceParts;
+        std::span<std::string_view> namespaceParts;
         NamespaceSymbol *targetNamespace = nullptr; // Resolved in semantic pass
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(UsingStatement)
     };
 
     // === Declarations ===
@@ -367,16 +465,16 @@ namespace Fern
         bool isParameter = false;
         bool isLocal = false;
         bool isField = false;
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(VariableDeclaration)
     };
 
     struct BoundFunctionDeclaration : BoundDeclaration
     {
         BoundExpression *returnTypeExpression = nullptr; // Can be null for constructors
-        std::vector<BoundVariableDeclaration *> parameters;
+        std::span<BoundVariableDeclaration *> parameters;
         BoundStatement *body = nullptr;
         bool isConstructor = false;
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(FunctionDeclaration)
     };
 
     // Property accessor (getter or setter)
@@ -401,38 +499,38 @@ namespace Fern
         BoundPropertyAccessor *getter = nullptr;
         BoundPropertyAccessor *setter = nullptr;
         BoundExpression *initializer = nullptr;  // For auto-properties with initial value
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(PropertyDeclaration)
     };
 
     struct BoundTypeDeclaration : BoundDeclaration
     {
-        std::vector<BoundStatement *> members;         // Can be any declaration or statement
+        std::span<BoundStatement *> members;           // Can be any declaration or statement
         BoundExpression *baseTypeExpression = nullptr; // For inheritance
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(TypeDeclaration)
     };
 
     struct BoundNamespaceDeclaration : BoundDeclaration
     {
-        std::vector<BoundStatement *> members;
-        BOUND_ACCEPT_VISITOR
+        std::span<BoundStatement *> members;
+        BOUND_NODE(NamespaceDeclaration)
     };
 
     // === Type Expression ===
 
     struct BoundTypeExpression : BoundExpression
     {
-        std::vector<std::string> parts;                   // ["List"], or ["System", "Collections", "Generic", "List"]
-        std::vector<BoundTypeExpression *> typeArguments; // For generics (future)
+        std::span<std::string_view> parts;                // ["List"], or ["System", "Collections", "Generic", "List"]
+        std::span<BoundTypeExpression *> typeArguments;   // For generics (future)
         TypePtr resolvedTypeReference = nullptr;          // Resolved in semantic pass
-        BOUND_ACCEPT_VISITOR
+        BOUND_NODE(TypeExpression)
     };
 
     // === Compilation Unit ===
 
     struct BoundCompilationUnit : BoundNode
     {
-        std::vector<BoundStatement *> statements; // Top-level statements/declarations
-        BOUND_ACCEPT_VISITOR
+        std::span<BoundStatement *> statements; // Top-level statements/declarations
+        BOUND_NODE(CompilationUnit)
     };
 
     class DefaultBoundVisitor : public BoundVisitor
@@ -452,90 +550,90 @@ namespace Fern
         void visit(BoundBinaryExpression *node) override
         {
             if (node->left)
-                node->left->accept(this);
+                dispatch(node->left);
             if (node->right)
-                node->right->accept(this);
+                dispatch(node->right);
         }
 
         void visit(BoundUnaryExpression *node) override
         {
             if (node->operand)
-                node->operand->accept(this);
+                dispatch(node->operand);
         }
 
         void visit(BoundAssignmentExpression *node) override
         {
             if (node->target)
-                node->target->accept(this);
+                dispatch(node->target);
             if (node->value)
-                node->value->accept(this);
+                dispatch(node->value);
         }
 
         void visit(BoundCallExpression *node) override
         {
             if (node->callee)
-                node->callee->accept(this);
+                dispatch(node->callee);
             for (auto *arg : node->arguments)
             {
                 if (arg)
-                    arg->accept(this);
+                    dispatch(arg);
             }
         }
 
         void visit(BoundMemberAccessExpression *node) override
         {
             if (node->object)
-                node->object->accept(this);
+                dispatch(node->object);
         }
 
         void visit(BoundIndexExpression *node) override
         {
             if (node->object)
-                node->object->accept(this);
+                dispatch(node->object);
             if (node->index)
-                node->index->accept(this);
+                dispatch(node->index);
         }
 
         void visit(BoundNewExpression *node) override
         {
             if (node->typeExpression)
-                node->typeExpression->accept(this);
+                dispatch(node->typeExpression);
             for (auto *arg : node->arguments)
             {
                 if (arg)
-                    arg->accept(this);
+                    dispatch(arg);
             }
         }
 
         void visit(BoundArrayCreationExpression *node) override
         {
             if (node->elementTypeExpression)
-                node->elementTypeExpression->accept(this);
+                dispatch(node->elementTypeExpression);
             if (node->size)
-                node->size->accept(this);
+                dispatch(node->size);
             for (auto *init : node->initializers)
             {
                 if (init)
-                    init->accept(this);
+                    dispatch(init);
             }
         }
 
         void visit(BoundCastExpression *node) override
         {
             if (node->expression)
-                node->expression->accept(this);
+                dispatch(node->expression);
             if (node->targetTypeExpression)
-                node->targetTypeExpression->accept(this);
+                dispatch(node->targetTypeExpression);
         }
 
         void visit(BoundConditionalExpression *node) override
         {
             if (node->condition)
-                node->condition->accept(this);
+                dispatch(node->condition);
             if (node->thenExpression)
-                node->thenExpression->accept(this);
+                dispatch(node->thenExpression);
             if (node->elseExpression)
-                node->elseExpression->accept(this);
+                dispatch(node->elseExpression);
         }
 
         void visit(BoundThisExpression *node) override
@@ -546,25 +644,25 @@ namespace Fern
         void visit(BoundTypeOfExpression *node) override
         {
             if (node->typeExpression)
-                node->typeExpression->accept(this);
+                dispatch(node->typeExpression);
         }
 
         void visit(BoundSizeOfExpression *node) override
         {
             if (node->typeExpression)
-                node->typeExpression->accept(this);
+                dispatch(node->typeExpression);
         }
 
         void visit(BoundParenthesizedExpression *node) override
         {
             if (node->expression)
-                node->expression->accept(this);
+                dispatch(node->expression);
         }
 
         void visit(BoundConversionExpression *node) override
         {
             if (node->expression)
-                node->expression->accept(this);
+                dispatch(node->expression);
         }
 
         void visit(BoundTypeExpression *node) override
@@ -572,7 +670,7 @@ namespace Fern
             for (auto *typeArg : node->typeArguments)
             {
                 if (typeArg)
-                    typeArg->accept(this);
+                    dispatch(typeArg);
             }
         }
 
@@ -582,47 +680,47 @@ namespace Fern
             for (auto *stmt : node->statements)
             {
                 if (stmt)
-                    stmt->accept(this);
+                    dispatch(stmt);
             }
         }
 
         void visit(BoundExpressionStatement *node) override
         {
             if (node->expression)
-                node->expression->accept(this);
+                dispatch(node->expression);
         }
 
         void visit(BoundIfStatement *node) override
         {
             if (node->condition)
-                node->condition->accept(this);
+                dispatch(node->condition);
             if (node->thenStatement)
-                node->thenStatement->accept(this);
+                dispatch(node->thenStatement);
             if (node->elseStatement)
-                node->elseStatement->accept(this);
+                dispatch(node->elseStatement);
         }
 
         void visit(BoundWhileStatement *node) override
         {
             if (node->condition)
-                node->condition->accept(this);
+                dispatch(node->condition);
             if (node->body)
-                node->body->accept(this);
+                dispatch(node->body);
         }
 
         void visit(BoundForStatement *node) override
         {
             if (node->initializer)
-                node->initializer->accept(this);
+                dispatch(node->initializer);
             if (node->condition)
-                node->condition->accept(this);
+                dispatch(node->condition);
             for (auto *inc : node->incrementors)
             {
                 if (inc)
-                    inc->accept(this);
+                    dispatch(inc);
             }
             if (node->body)
-                node->body->accept(this);
+                dispatch(node->body);
         }
 
         void visit(BoundBreakStatement *node) override
@@ -638,7 +736,7 @@ namespace Fern
         void visit(BoundReturnStatement *node) override
         {
             if (node->value)
-                node->value->accept(this);
+                dispatch(node->value);
         }
 
         void visit(BoundUsingStatement *node) override
@@ -650,55 +748,55 @@ namespace Fern
         void visit(BoundVariableDeclaration *node) override
         {
             if (node->typeExpression)
-                node->typeExpression->accept(this);
+                dispatch(node->typeExpression);
             if (node->initializer)
-                node->initializer->accept(this);
+                dispatch(node->initializer);
         }
 
         void visit(BoundFunctionDeclaration *node) override
         {
             if (node->returnTypeExpression)
-                node->returnTypeExpression->accept(this);
+                dispatch(node->returnTypeExpression);
             for (auto *param : node->parameters)
             {
                 if (param)
-                    param->accept(this);
+                    dispatch(param);
             }
             if (node->body)
-                node->body->accept(this);
+                dispatch(node->body);
         }
 
         void visit(BoundPropertyDeclaration *node) override
         {
             if (node->typeExpression)
-                node->typeExpression->accept(this);
+                dispatch(node->typeExpression);
             if (node->initializer)
-                node->initializer->accept(this);
+                dispatch(node->initializer);
                 
             if (node->getter)
             {
                 if (node->getter->expression)
-                    node->getter->expression->accept(this);
+                    dispatch(node->getter->expression);
                 if (node->getter->body)
-                    node->getter->body->accept(this);
+                    dispatch(node->getter->body);
             }
             if (node->setter)
             {
                 if (node->setter->expression)
-                    node->setter->expression->accept(this);
+                    dispatch(node->setter->expression);
                 if (node->setter->body)
-                    node->setter->body->accept(this);
+                    dispatch(node->setter->body);
             }
         }
 
         void visit(BoundTypeDeclaration *node) override
         {
             if (node->baseTypeExpression)
-                node->baseTypeExpression->accept(this);
+                dispatch(node->baseTypeExpression);
             for (auto *member : node->members)
             {
                 if (member)
-                    member->accept(this);
+                    dispatch(member);
             }
         }
 
@@ -707,7 +805,7 @@ namespace Fern
             for (auto *member : node->members)
             {
                 if (member)
-                    member->accept(this);
+                    dispatch(member);
             }
         }
 
@@ -717,7 +815,58 @@ namespace Fern
             for (auto *stmt : node->statements)
             {
                 if (stmt)
-                    stmt->accept(this);
+                    dispatch(stmt);
+            }
+        }
+    };
+
+    inline void BoundVisitor::dispatch(BoundNode *node)
+    {
+        if (visitor_dispatch == VisitorDispatch::Virtual)
+        {
+            node->accept(this);
+            return;
+        }
+
+        switch (node->boundKind)
+        {
+#define FERN_BOUND_CASE(Kind, Type) \
+    case BoundNodeKind::Kind:       \
+        visit(static_cast<Type *>(node)); \
+        return;
+            FERN_BOUND_NODES(FERN_BOUND_CASE)
+#undef FERN_BOUND_CASE
+        }
+    }
+
+    /**
+     * @brief Switch dispatch for a bound-tree pass that knows its own most-derived type
+     *
+     * The bound-tree counterpart of SyntaxSwitchVisitor: dispatch(node) calls
+     * Derived::visit directly, so a `final` pass pays for one switch per node and no
+     * virtual calls. Derived must see every visit overload.
+     */
+    template <typename Derived, typename Base = DefaultBoundVisitor>
+    class BoundSwitchVisitor : public Base
+    {
+    protected:
+        void dispatch(BoundNode *node)
+        {
+            if (visitor_dispatch == VisitorDispatch::Virtual)
+            {
+                node->accept(this);
+                return;
+            }
+
+            Derived *self = static_cast<Derived *>(this);
+            switch (node->boundKind)
+            {
+#define FERN_BOUND_CASE(Kind, Type) \
+    case BoundNodeKind::Kind:       \
+        self->visit(static_cast<Type *>(node)); \
+        return;
+                FERN_BOUND_NODES(FERN_BOUND_CASE)
+#undef FERN_BOUND_CASE
             }
         }
     };
@@ -1,4 +1,5 @@
 #include "bound_tree_builder.hpp"
+#include <charconv>
 #include <iostream>
 
 namespace Fern
@@ -6,6 +7,48 @@ namespace Fern
     BoundTreeBuilder::BoundTreeBuilder(SymbolTable &symbol_table)
         : arena_(), symbol_table_(symbol_table) {}
 
+    void BoundTreeBuilder::push_name_parts(BaseNameExprSyntax *syntax)
+    {
+        if (auto qualified = syntax->as<QualifiedNameSyntax>())
+        {
+            // Parts from the left side only if it's a name
+            if (auto left_name = qualified->left->as<BaseNameExprSyntax>())
+            {
+                push_name_parts(left_name);
+            }
+            push_name_parts(qualified->right);
+        }
+        else if (auto simple = syntax->as<SimpleNameSyntax>())
+        {
+            name_stack_.push_back(arena_.intern(simple->identifier.text));
+        }
+        else if (auto generic = syntax->as<GenericNameSyntax>())
+        {
+            // No type arguments
+            push_name_parts(generic->identifier);
+        }
+    }
+
+    std::string_view BoundTreeBuilder::intern_name(BaseNameExprSyntax *syntax)
+    {
+        if (auto simple = syntax->as<SimpleNameSyntax>())
+        {
+            return arena_.intern(simple->identifier.text);
+        }
+
+        size_t mark = name_stack_.size();
+        push_name_parts(syntax);
+        name_buffer_.clear();
+        for (size_t i = mark; i < name_stack_.size(); ++i)
+        {
+            if (i > mark)
+                name_buffer_ += '.';
+            name_buffer_ += name_stack_[i];
+        }
+        name_stack_.resize(mark);
+        return arena_.intern(name_buffer_);
+    }
+
     BoundCompilationUnit *BoundTreeBuilder::bind(CompilationUnitSyntax *syntax)
     {
         auto unit = arena_.make<BoundCompilationUnit>();
@@ -14,16 +57,18 @@ namespace Fern
         // Start from global namespace
         ScopeGuard scope(symbol_table_, symbol_table_.get_global_namespace());
 
+        size_t mark = node_stack_.size();
         for (auto stmt : syntax->topLevelStatements)
         {
             if (stmt)
             {
                 if (auto bound = bind_statement(stmt))
                 {
-                    unit->statements.push_back(bound);
+                    node_stack_.push_back(bound);
                 }
             }
         }
+        unit->statements = take_nodes<BoundStatement>(mark);
 
         return unit;
     }
@@ -35,41 +80,45 @@ namespace Fern
         if (!syntax)
             return nullptr;
 
+        switch (syntax->syntaxKind)
+        {
         // Declarations
-        if (auto func_decl = syntax->as<FunctionDeclSyntax>())
-            return bind_function_declaration(func_decl);
-        if (auto ctor_decl = syntax->as<ConstructorDeclSyntax>())
-            return bind_constructor_declaration(ctor_decl);
-        if (auto type_decl = syntax->as<TypeDeclSyntax>())
-            return bind_type_declaration(type_decl);
-        if (auto var_decl = syntax->as<VariableDeclSyntax>())
-            return bind_variable_declaration(var_decl);
-        if (auto namespace_decl = syntax->as<NamespaceDeclSyntax>())
-            return bind_namespace_declaration(namespace_decl);
-        if (auto prop_decl = syntax->as<PropertyDeclSyntax>())
-            return bind_property_declaration(prop_decl);
-        if (auto using_decl = syntax->as<UsingDirectiveSyntax>())
-            return bind_using_statement(using_decl);
+        case SyntaxKind::FunctionDecl:
+            return bind_function_declaration(static_cast<FunctionDeclSyntax *>(syntax));
+        case SyntaxKind::ConstructorDecl:
+            return bind_constructor_declaration(static_cast<ConstructorDeclSyntax *>(syntax));
+        case SyntaxKind::TypeDecl:
+            return bind_type_declaration(static_cast<TypeDeclSyntax *>(syntax));
+        case SyntaxKind::VariableDecl:
+            return bind_variable_declaration(static_cast<VariableDeclSyntax *>(syntax));
+        case SyntaxKind::NamespaceDecl:
+            return bind_namespace_declaration(static_cast<NamespaceDeclSyntax *>(syntax));
+        case SyntaxKind::PropertyDecl:
+            return bind_property_declaration(static_cast<PropertyDeclSyntax *>(syntax));
+        case SyntaxKind::UsingDirective:
+            return bind_using_statement(static_cast<UsingDirectiveSyntax *>(syntax));
 
         // Statements
-        if (auto block = syntax->as<BlockSyntax>())
-            return bind_block(block);
-        if (auto if_stmt = syntax->as<IfStmtSyntax>())
-            return bind_if_statement(if_stmt);
-        if (auto while_stmt = syntax->as<WhileStmtSyntax>())
-            return bind_while_statement(while_stmt);
-        if (auto for_stmt = syntax->as<ForStmtSyntax>())
-            return bind_for_statement(for_stmt);
-        if (auto return_stmt = syntax->as<ReturnStmtSyntax>())
-            return bind_return_statement(return_stmt);
-        if (auto break_stmt = syntax->as<BreakStmtSyntax>())
-            return bind_break_statement(break_stmt);
-        if (auto continue_stmt = syntax->as<ContinueStmtSyntax>())
-            return bind_continue_statement(continue_stmt);
-        if (auto expr_stmt = syntax->as<ExpressionStmtSyntax>())
-            return bind_expression_statement(expr_stmt);
-
-        return nullptr;
+        case SyntaxKind::Block:
+            return bind_block(static_cast<BlockSyntax *>(syntax));
+        case SyntaxKind::IfStmt:
+            return bind_if_statement(static_cast<IfStmtSyntax *>(syntax));
+        case SyntaxKind::WhileStmt:
+            return bind_while_statement(static_cast<WhileStmtSyntax *>(syntax));
+        case SyntaxKind::ForStmt:
+            return bind_for_statement(static_cast<ForStmtSyntax *>(syntax));
+        case SyntaxKind::ReturnStmt:
+            return bind_return_statement(static_cast<ReturnStmtSyntax *>(syntax));
+        case SyntaxKind::BreakStmt:
+            return bind_break_statement(static_cast<BreakStmtSyntax *>(syntax));
+        case SyntaxKind::ContinueStmt:
+            return bind_continue_statement(static_cast<ContinueStmtSyntax *>(syntax));
+        case SyntaxKind::ExpressionStmt:
+            return bind_expression_statement(static_cast<ExpressionStmtSyntax *>(syntax));
+
+        default:
+            return nullptr;
+        }
     }
 
     BoundBlockStatement *BoundTreeBuilder::bind_block(BlockSyntax *syntax)
@@ -83,13 +132,15 @@ namespace Fern
         // Push into block scope so variable lookups work correctly
         ScopeGuard scope(symbol_table_, bound->symbol);
 
+        size_t mark = node_stack_.size();
         for (auto stmt : syntax->statements)
         {
             if (auto bound_stmt = bind_statement(stmt))
             {
-                bound->statements.push_back(bound_stmt);
+                node_stack_.push_back(bound_stmt);
             }
         }
+        bound->statements = take_nodes<BoundStatement>(mark);
 
         return bound;
     }
@@ -102,7 +153,7 @@ namespace Fern
 
         if (syntax->variable && syntax->variable->name)
         {
-            bound->name = syntax->variable->name->get_name();
+            bound->name = intern_name(syntax->variable->name);
         }
 
         if (syntax->variable && syntax->variable->type)
@@ -138,11 +189,11 @@ namespace Fern
 
         if (syntax->name)
         {
-            bound->name = syntax->name->get_name();
+            bound->name = intern_name(syntax->name);
         }
 
         // Resolve the symbol
-        bound->symbol = resolve_symbol({bound->name});
+        bound->symbol = symbol_table_.resolve(bound->name);
 
         // Enter function scope
         ScopeGuard scope(symbol_table_, bound->symbol);
@@ -153,22 +204,24 @@ namespace Fern
         }
 
         // Bind parameters
+        size_t mark = node_stack_.size();
         for (auto param : syntax->parameters)
         {
             if (auto param_syntax = param->as<ParameterDeclSyntax>())
             {
                 auto bound_param = arena_.make<BoundVariableDeclaration>();
                 bound_param->location = param_syntax->location;
-                bound_param->name = param_syntax->param->name ? param_syntax->param->name->get_name() : "";
+                bound_param->name = param_syntax->param->name ? intern_name(param_syntax->param->name) : std::string_view();
                 bound_param->typeExpression = param_syntax->param->type ? bind_type_expression(param_syntax->param->type) : nullptr;
                 bound_param->isParameter = true;
 
                 // Resolve parameter symbol
                 bound_param->symbol = symbol_table_.resolve_local(bound_param->name);
 
-                bound->parameters.push_back(bound_param);
+                node_stack_.push_back(bound_param);
             }
         }
+        bound->parameters = take_nodes<BoundVariableDeclaration>(mark);
 
         if (syntax->body)
         {
@@ -188,7 +241,7 @@ namespace Fern
         auto containing_type = get_containing_type();
         if (containing_type)
         {
-            bound->name = containing_type->name;
+            bound->name = arena_.intern(containing_type->name);
 
             // Match constructor using AST node mapping
             // During symbol table building, we mapped each constructor AST node to its symbol
@@ -202,22 +255,24 @@ namespace Fern
         bound->returnTypeExpression = nullptr;
 
         // Bind parameters
+        size_t mark = node_stack_.size();
         for (auto param : syntax->parameters)
         {
             if (auto param_syntax = param->as<ParameterDeclSyntax>())
             {
                 auto bound_param = arena_.make<BoundVariableDeclaration>();
                 bound_param->location = param_syntax->location;
-                bound_param->name = param_syntax->param->name ? param_syntax->param->name->get_name() : "";
+                bound_param->name = param_syntax->param->name ? intern_name(param_syntax->param->name) : std::string_view();
                 bound_param->typeExpression = param_syntax->param->type ? bind_type_expression(param_syntax->param->type) : nullptr;
                 bound_param->isParameter = true;
 
                 // Resolve parameter symbol
                 bound_param->symbol = symbol_table_.resolve_local(bound_param->name);
 
-                bound->parameters.push_back(bound_param);
+                node_stack_.push_back(bound_param);
             }
         }
+        bound->parameters = take_nodes<BoundVariableDeclaration>(mark);
 
         if (syntax->body)
         {
@@ -235,11 +290,11 @@ namespace Fern
 
         if (syntax->name)
         {
-            bound->name = syntax->name->get_name();
+            bound->name = intern_name(syntax->name);
         }
 
         // Resolve the symbol
-        bound->symbol = resolve_symbol({bound->name});
+        bound->symbol = symbol_table_.resolve(bound->name);
 
         // Enter type scope
         ScopeGuard scope(symbol_table_, bound->symbol);
@@ -251,13 +306,15 @@ namespace Fern
         // }
 
         // Bind members
+        size_t mark = node_stack_.size();
         for (auto member : syntax->members)
         {
             if (auto bound_member = bind_statement(member))
             {
-                bound->members.push_back(bound_member);
+                node_stack_.push_back(bound_member);
             }
         }
+        bound->members = take_nodes<BoundStatement>(mark);
 
         return bound;
     }
@@ -269,24 +326,26 @@ namespace Fern
 
         if (syntax->name)
         {
-            bound->name = syntax->name->get_name();
+            bound->name = intern_name(syntax->name);
         }
 
         // Resolve the symbol
-        bound->symbol = resolve_symbol({bound->name});
+        bound->symbol = symbol_table_.resolve(bound->name);
 
         // Enter namespace scope
         ScopeGuard scope(symbol_table_, bound->symbol);
 
         if (syntax->body.has_value())
         {
+            size_t mark = node_stack_.size();
             for (auto member : syntax->body.value())
             {
                 if (auto bound_member = bind_statement(member))
                 {
-                    bound->members.push_back(bound_member);
+                    node_stack_.push_back(bound_member);
                 }
             }
+            bound->members = take_nodes<BoundStatement>(mark);
         }
 
         return bound;
@@ -302,7 +361,7 @@ namespace Fern
         {
             if (syntax->variable->variable->name)
             {
-                bound->name = syntax->variable->variable->name->get_name();
+                bound->name = intern_name(syntax->variable->variable->name);
             }
             if (syntax->variable->variable->type)
             {
@@ -317,7 +376,7 @@ namespace Fern
         }
 
         // Resolve the symbol
-        bound->symbol = resolve_symbol({bound->name});
+        bound->symbol = symbol_table_.resolve(bound->name);
 
         // Bind getter if present
         if (syntax->getter)
@@ -327,9 +386,8 @@ namespace Fern
             
             // Find the getter function symbol as a child of the property
             if (auto prop_sym = bound->symbol->as<PropertySymbol>()) {
-                auto getter_members = prop_sym->get_member("get");
-                if (!getter_members.empty()) {
-                    if (auto func_sym = getter_members[0]->as<FunctionSymbol>()) {
+                if (auto getter_member = prop_sym->find_member("get")) {
+                    if (auto func_sym = getter_member->as<FunctionSymbol>()) {
                         accessor->function_symbol = func_sym;
 
                         // Enter getter function scope for binding body
@@ -362,9 +420,8 @@ namespace Fern
             
             // Find the setter function symbol as a child of the property
             if (auto prop_sym = bound->symbol->as<PropertySymbol>()) {
-                auto setter_members = prop_sym->get_member("set");
-                if (!setter_members.empty()) {
-                    if (auto func_sym = setter_members[0]->as<FunctionSymbol>()) {
+                if (auto setter_member = prop_sym->find_member("set")) {
+                    if (auto func_sym = setter_member->as<FunctionSymbol>()) {
                         accessor->function_symbol = func_sym;
 
                         // Enter setter function scope for binding body
@@ -438,13 +495,15 @@ namespace Fern
             bound->condition = bind_expression(syntax->condition);
         }
 
+        size_t mark = node_stack_.size();
         for (auto update : syntax->updates)
         {
             if (auto bound_update = bind_expression(update))
             {
-                bound->incrementors.push_back(bound_update);
+                node_stack_.push_back(bound_update);
             }
         }
+        bound->incrementors = take_nodes<BoundExpression>(mark);
 
         bound->body = bind_statement(syntax->body);
 
@@ -493,7 +552,9 @@ namespace Fern
 
         if (syntax->target)
         {
-            bound->namespaceParts = syntax->target->get_parts();
+            size_t mark = name_stack_.size();
+            push_name_parts(syntax->target);
+            bound->namespaceParts = take_names(mark);
         }
 
         // Resolve the namespace
@@ -514,40 +575,45 @@ namespace Fern
         if (!syntax)
             return nullptr;
 
-        if (auto literal = syntax->as<LiteralExprSyntax>())
-            return bind_literal(literal);
-        if (auto name = syntax->as<BaseNameExprSyntax>())
-            return bind_name(name);
-        if (auto binary = syntax->as<BinaryExprSyntax>())
-            return bind_binary_expression(binary);
-        if (auto unary = syntax->as<UnaryExprSyntax>())
-            return bind_unary_expression(unary);
-        if (auto assignment = syntax->as<AssignmentExprSyntax>())
-            return bind_assignment_expression(assignment);
-        if (auto call = syntax->as<CallExprSyntax>())
-            return bind_call_expression(call);
-        if (auto member = syntax->as<MemberAccessExprSyntax>())
-            return bind_member_access(member);
-        if (auto indexer = syntax->as<IndexerExprSyntax>())
-            return bind_index_expression(indexer);
-        if (auto conditional = syntax->as<ConditionalExprSyntax>())
-            return bind_conditional_expression(conditional);
-        if (auto cast = syntax->as<CastExprSyntax>())
-            return bind_cast_expression(cast);
-        if (auto new_expr = syntax->as<NewExprSyntax>())
-            return bind_new_expression(new_expr);
-        if (auto this_expr = syntax->as<ThisExprSyntax>())
-            return bind_this_expression(this_expr);
-        if (auto array = syntax->as<ArrayLiteralExprSyntax>())
-            return bind_array_creation(array);
-        if (auto typeof_expr = syntax->as<TypeOfExprSyntax>())
-            return bind_typeof_expression(typeof_expr);
-        if (auto sizeof_expr = syntax->as<SizeOfExprSyntax>())
-            return bind_sizeof_expression(sizeof_expr);
-        if (auto paren = syntax->as<ParenthesizedExprSyntax>())
-            return bind_parenthesized_expression(paren);
-
-        return nullptr;
+        switch (syntax->syntaxKind)
+        {
+        case SyntaxKind::LiteralExpr:
+            return bind_literal(static_cast<LiteralExprSyntax *>(syntax));
+        case SyntaxKind::SimpleName:
+        case SyntaxKind::QualifiedName:
+        case SyntaxKind::GenericName:
+            return bind_name(static_cast<BaseNameExprSyntax *>(syntax));
+        case SyntaxKind::BinaryExpr:
+            return bind_binary_expression(static_cast<BinaryExprSyntax *>(syntax));
+        case SyntaxKind::UnaryExpr:
+            return bind_unary_expression(static_cast<UnaryExprSyntax *>(syntax));
+        case SyntaxKind::AssignmentExpr:
+            return bind_assignment_expression(static_cast<AssignmentExprSyntax *>(syntax));
+        case SyntaxKind::CallExpr:
+            return bind_call_expression(static_cast<CallExprSyntax *>(syntax));
+        case SyntaxKind::MemberAccessExpr:
+            return bind_member_access(static_cast<MemberAccessExprSyntax *>(syntax));
+        case SyntaxKind::IndexerExpr:
+            return bind_index_expression(static_cast<IndexerExprSyntax *>(syntax));
+        case SyntaxKind::ConditionalExpr:
+            return bind_conditional_expression(static_cast<ConditionalExprSyntax *>(syntax));
+        case SyntaxKind::CastExpr:
+            return bind_cast_expression(static_cast<CastExprSyntax *>(syntax));
+        case SyntaxKind::NewExpr:
+            return bind_new_expression(static_cast<NewExprSyntax *>(syntax));
+        case SyntaxKind::ThisExpr:
+            return bind_this_expression(static_cast<ThisExprSyntax *>(syntax));
+        case SyntaxKind::ArrayLiteralExpr:
+            return bind_array_creation(static_cast<ArrayLiteralExprSyntax *>(syntax));
+        case SyntaxKind::TypeOfExpr:
+            return bind_typeof_expression(static_cast<TypeOfExprSyntax *>(syntax));
+        case SyntaxKind::SizeOfExpr:
+            return bind_sizeof_expression(static_cast<SizeOfExprSyntax *>(syntax));
+        case SyntaxKind::ParenthesizedExpr:
+            return bind_parenthesized_expression(static_cast<ParenthesizedExprSyntax *>(syntax));
+        default:
+            return nullptr;
+        }
     }
 
     BoundLiteralExpression *BoundTreeBuilder::bind_literal(LiteralExprSyntax *syntax)
@@ -559,22 +625,35 @@ namespace Fern
         // Store the constant value
         switch (syntax->kind)
         {
+        // from_chars rather than stoll and friends, which would copy the text into a string
         case LiteralKind::I32:
         case LiteralKind::I64:
         case LiteralKind::I8:
         case LiteralKind::I16:
-            bound->constantValue = static_cast<int64_t>(std::stoll(std::string(syntax->value)));
+        {
+            int64_t value = 0;
+            std::from_chars(syntax->value.data(), syntax->value.data() + syntax->value.size(), value);
+            bound->constantValue = value;
             break;
+        }
         case LiteralKind::U32:
         case LiteralKind::U64:
         case LiteralKind::U8:
         case LiteralKind::U16:
-            bound->constantValue = static_cast<uint64_t>(std::stoull(std::string(syntax->value)));
+        {
+            uint64_t value = 0;
+            std::from_chars(syntax->value.data(), syntax->value.data() + syntax->value.size(), value);
+            bound->constantValue = value;
             break;
+        }
         case LiteralKind::F32:
         case LiteralKind::F64:
-            bound->constantValue = std::stod(std::string(syntax->value));
+        {
+            double value = 0.0;
+            std::from_chars(syntax->value.data(), syntax->value.data() + syntax->value.size(), value);
+            bound->constantValue = value;
             break;
+        }
         case LiteralKind::Bool:
             bound->constantValue = (syntax->value == "true");
             break;
@@ -585,7 +664,7 @@ namespace Fern
             }
             break;
         case LiteralKind::String:
-            bound->constantValue = std::string(syntax->value);
+            bound->constantValue = arena_.intern(syntax->value);
             break;
         case LiteralKind::Null:
             bound->constantValue = std::monostate{};
@@ -611,20 +690,22 @@ namespace Fern
                 auto member_access = arena_.make<BoundMemberAccessExpression>();
                 member_access->location = syntax->location;
                 member_access->object = object;
-                member_access->memberName = qualified->right->get_name();
+                member_access->memberName = intern_name(qualified->right);
                 // member symbol will be resolved by type resolver
                 return member_access;
             }
         }
 
-        auto parts = syntax->get_parts();
+        size_t mark = name_stack_.size();
+        push_name_parts(syntax);
+        auto parts = take_names(mark);
 
         // For qualified names, check if the first part is a variable
         // If so, convert to member access chain
         if (parts.size() > 1)
         {
             // Try to resolve just the first part
-            std::vector<std::string> first_part = {parts[0]};
+            auto first_part = parts.first(1);
             auto first_symbol = resolve_symbol(first_part);
             
             // If first part is a variable or parameter, build member access chain
@@ -789,18 +870,20 @@ namespace Fern
         bound->location = syntax->location;
         bound->callee = bind_expression(syntax->callee);
 
+        size_t mark = node_stack_.size();
         for (auto arg : syntax->arguments)
         {
             if (auto bound_arg = bind_expression(arg))
             {
-                bound->arguments.push_back(bound_arg);
+                node_stack_.push_back(bound_arg);
             }
         }
+        bound->arguments = take_nodes<BoundExpression>(mark);
 
         // Resolve the method
         if (auto name_expr = bound->callee->as<BoundNameExpression>())
         {
-            std::string func_name = name_expr->parts.empty() ? "" : name_expr->parts.back();
+            std::string_view func_name = name_expr->parts.empty() ? std::string_view() : name_expr->parts.back();
             bound->method = resolve_function(func_name, bound);
         }
         else if (auto member_expr = bound->callee->as<BoundMemberAccessExpression>())
@@ -822,7 +905,7 @@ namespace Fern
 
         if (syntax->member)
         {
-            bound->memberName = syntax->member->get_name();
+            bound->memberName = intern_name(syntax->member);
         }
 
         // Resolve the member
@@ -878,13 +961,15 @@ namespace Fern
         bound->location = syntax->location;
         bound->typeExpression = bind_type_expression(syntax->type);
 
+        size_t mark = node_stack_.size();
         for (auto arg : syntax->arguments)
         {
             if (auto bound_arg = bind_expression(arg))
             {
-                bound->arguments.push_back(bound_arg);
+                node_stack_.push_back(bound_arg);
             }
         }
+        bound->arguments = take_nodes<BoundExpression>(mark);
 
         // Constructor will be resolved during type resolution when argument types are known
         bound->constructor = nullptr;
@@ -908,13 +993,15 @@ namespace Fern
         auto bound = arena_.make<BoundArrayCreationExpression>();
         bound->location = syntax->location;
 
+        size_t mark = node_stack_.size();
         for (auto elem : syntax->elements)
         {
             if (auto bound_elem = bind_expression(elem))
             {
-                bound->initializers.push_back(bound_elem);
+                node_stack_.push_back(bound_elem);
             }
         }
+        bound->initializers = take_nodes<BoundExpression>(mark);
 
         return bound;
     }
@@ -957,7 +1044,9 @@ namespace Fern
 
         if (auto name = syntax->as<BaseNameExprSyntax>())
         {
-            bound->parts = name->get_parts();
+            size_t mark = name_stack_.size();
+            push_name_parts(name);
+            bound->parts = take_names(mark);
 
             // Resolve the type reference
             if (auto symbol = resolve_symbol(bound->parts))
@@ -973,8 +1062,10 @@ namespace Fern
             // For array types, bind the element type
             if (auto element_type = bind_type_expression(array_type->baseType))
             {
-                bound->parts.push_back("[]"); // Marker for array
-                bound->typeArguments.push_back(element_type);
+                bound->parts = arena_.makeArray<std::string_view>(1);
+                bound->parts[0] = "[]"; // Marker for array
+                bound->typeArguments = arena_.makeArray<BoundTypeExpression*>(1);
+                bound->typeArguments[0] = element_type;
             }
         }
         else if (auto ptr_type = syntax->as<PointerTypeSyntax>())
@@ -982,8 +1073,10 @@ namespace Fern
             // For pointer types
             if (auto pointee = bind_type_expression(ptr_type->baseType))
             {
-                bound->parts.push_back("*"); // Marker for pointer
-                bound->typeArguments.push_back(pointee);
+                bound->parts = arena_.makeArray<std::string_view>(1);
+                bound->parts[0] = "*"; // Marker for pointer
+                bound->typeArguments = arena_.makeArray<BoundTypeExpression*>(1);
+                bound->typeArguments[0] = pointee;
             }
         }
 
@@ -12,17 +12,23 @@ namespace Fern
     private:
         BindingArena arena_;
         SymbolTable& symbol_table_;
+
+        // Lists and name parts are gathered here while their node is bound, then copied into
+        // the arena in one piece; children push above their parent's mark and pop back to it
+        std::vector<BoundNode*> node_stack_;
+        std::vector<std::string_view> name_stack_;
+        std::string name_buffer_; // joins dotted names before they're interned
         
         #pragma region Symbol Resolution Helpers
         
         // Simple symbol lookup
-        Symbol* resolve_symbol(const std::vector<std::string>& parts)
+        Symbol* resolve_symbol(std::span<const std::string_view> parts)
         {
             return symbol_table_.resolve(parts);
         }
         
         // Function overload resolution
-        FunctionSymbol* resolve_function(const std::string& name, BoundCallExpression* call)
+        FunctionSymbol* resolve_function(std::string_view name, BoundCallExpression* call)
         {
             std::vector<TypePtr> arg_types;
             for (auto* arg : call->arguments)
@@ -36,7 +42,7 @@ namespace Fern
         }
         
         // Member resolution on a type
-        Symbol* resolve_member(TypePtr type, const std::string& member_name)
+        Symbol* resolve_member(TypePtr type, std::string_view member_name)
         {
             if (!type) return nullptr;
             
@@ -44,8 +50,7 @@ namespace Fern
             {
                 if (auto type_symbol = symbol->as<TypeSymbol>())
                 {
-                    auto members = type_symbol->get_member(member_name);
-                    return members.empty() ? nullptr : members[0];
+                    return type_symbol->find_member(member_name);
                 }
             }
             return nullptr;
@@ -78,6 +83,36 @@ namespace Fern
             return true;
         }
         
+        #pragma region Arena Helpers
+
+        // Everything pushed on node_stack_ since `mark`, as an arena list
+        template<typename T>
+        std::span<T*> take_nodes(size_t mark)
+        {
+            auto list = arena_.makeArray<T*>(node_stack_.size() - mark);
+            for (size_t i = 0; i < list.size(); ++i)
+            {
+                list[i] = static_cast<T*>(node_stack_[mark + i]);
+            }
+            node_stack_.resize(mark);
+            return list;
+        }
+
+        // Everything pushed on name_stack_ since `mark`, as an arena list
+        std::span<std::string_view> take_names(size_t mark)
+        {
+            auto list = arena_.makeArray<std::string_view>(name_stack_.size() - mark);
+            std::copy(name_stack_.begin() + mark, name_stack_.end(), list.begin());
+            name_stack_.resize(mark);
+            return list;
+        }
+
+        // Push the interned parts of a (possibly qualified) name, as get_parts() lists them
+        void push_name_parts(BaseNameExprSyntax* syntax);
+
+        // The name's parts joined with '.', as get_name() spells it, interned
+        std::string_view intern_name(BaseNameExprSyntax* syntax);
+        
         #pragma region Scope Management Helpers
         
         class ScopeGuard
@@ -107,6 +142,9 @@ namespace Fern
         
         // Main entry point
         BoundCompilationUnit* bind(CompilationUnitSyntax* syntax);
+
+        // Owns every node bind() returned
+        const BindingArena& get_arena() const { return arena_; }
         
     private:
 
@@ -66,8 +66,8 @@ namespace Fern
                     ss << std::get<uint64_t>(expr->constantValue);
                 else if (std::holds_alternative<bool>(expr->constantValue))
                     ss << (std::get<bool>(expr->constantValue) ? "true" : "false");
-                else if (std::holds_alternative<std::string>(expr->constantValue))
-                    ss << "\"" << std::get<std::string>(expr->constantValue) << "\"";
+                else if (std::holds_alternative<std::string_view>(expr->constantValue))
+                    ss << "\"" << std::get<std::string_view>(expr->constantValue) << "\"";
                 else if (std::holds_alternative<double>(expr->constantValue))
                     ss << std::get<double>(expr->constantValue);
             }
@@ -170,6 +170,18 @@ namespace Fern
                 return ConversionKind::ExplicitReference;
             }
 
+            // Vectors convert lane by lane, so only between equal lane counts
+            auto sourceVector = sourceType->as<VectorType>();
+            auto targetVector = targetType->as<VectorType>();
+            if (sourceVector || targetVector)
+            {
+                if (sourceType == targetType)
+                    return ConversionKind::Identity;
+                if (sourceVector && targetVector && sourceVector->lanes == targetVector->lanes)
+                    return ConversionKind::ExplicitNumeric;
+                return ConversionKind::NoConversion;
+            }
+
             // Handle primitive types
             auto sourcePrim = sourceType->as<PrimitiveType>();
             auto targetPrim = targetType->as<PrimitiveType>();
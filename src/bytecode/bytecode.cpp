@@ -0,0 +1,130 @@
+// bytecode.cpp - Opcode names, value conversions and program dumps
+#include "bytecode.hpp"
+#include <sstream>
+
+namespace Fern::Bytecode
+{
+#define FERN_BYTECODE_OP_STRING(name, ...) #name,
+
+    const char *op_name(Op op)
+    {
+        static const char *names[] = {
+            FERN_BYTECODE_BINARY_OPS(FERN_BYTECODE_OP_STRING)
+            FERN_BYTECODE_UNARY_OPS(FERN_BYTECODE_OP_STRING)
+            FERN_BYTECODE_OTHER_OPS(FERN_BYTECODE_OP_STRING)
+        };
+        auto index = static_cast<size_t>(op);
+        return index < static_cast<size_t>(Op::Count) ? names[index] : "?";
+    }
+
+#undef FERN_BYTECODE_OP_STRING
+
+    uint32_t kind_size(ValueKind kind)
+    {
+        switch (kind)
+        {
+        case ValueKind::Bool:
+        case ValueKind::I8:
+        case ValueKind::U8:
+            return 1;
+        case ValueKind::I16:
+        case ValueKind::U16:
+            return 2;
+        case ValueKind::I32:
+        case ValueKind::U32:
+        case ValueKind::F32:
+            return 4;
+        case ValueKind::I64:
+        case ValueKind::U64:
+        case ValueKind::F64:
+        case ValueKind::Ptr:
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    void convert(ValueKind from, const uint8_t *src, ValueKind to, uint8_t *dst)
+    {
+        switch (to)
+        {
+        case ValueKind::Bool:
+            // Truncation to i1 keeps the low bit; fptoui to i1 is the same on the integer part
+            if (is_float_kind(from))
+                write<uint8_t>(dst, static_cast<uint8_t>(read_as<int64_t>(from, src) & 1));
+            else
+                write<uint8_t>(dst, static_cast<uint8_t>(read_as<uint64_t>(from, src) & 1));
+            break;
+        case ValueKind::I8:
+            write<int8_t>(dst, read_as<int8_t>(from, src));
+            break;
+        case ValueKind::U8:
+            write<uint8_t>(dst, read_as<uint8_t>(from, src));
+            break;
+        case ValueKind::I16:
+            write<int16_t>(dst, read_as<int16_t>(from, src));
+            break;
+        case ValueKind::U16:
+            write<uint16_t>(dst, read_as<uint16_t>(from, src));
+            break;
+        case ValueKind::I32:
+            write<int32_t>(dst, read_as<int32_t>(from, src));
+            break;
+        case ValueKind::U32:
+            write<uint32_t>(dst, read_as<uint32_t>(from, src));
+            break;
+        case ValueKind::I64:
+            write<int64_t>(dst, read_as<int64_t>(from, src));
+            break;
+        case ValueKind::U64:
+        case ValueKind::Ptr:
+            write<uint64_t>(dst, read_as<uint64_t>(from, src));
+            break;
+        case ValueKind::F32:
+            write<float>(dst, read_as<float>(from, src));
+            break;
+        case ValueKind::F64:
+            write<double>(dst, read_as<double>(from, src));
+            break;
+        default:
+            break;
+        }
+    }
+
+    size_t Program::instruction_count() const
+    {
+        size_t count = 0;
+        for (const auto &function : functions)
+        {
+            count += function.code.size();
+        }
+        return count;
+    }
+
+    std::string Program::dump() const
+    {
+        std::stringstream ss;
+        for (const auto &function : functions)
+        {
+            ss << "function " << function.name << " (frame " << function.frame_size << " bytes, "
+               << function.constants.size() << " of constants)\n";
+            for (size_t i = 0; i < function.code.size(); i++)
+            {
+                const Instruction &inst = function.code[i];
+                ss << "  " << i << ": " << op_name(inst.op) << " dst=" << inst.dst << " a=" << inst.a
+                   << " b=" << inst.b << " c=" << inst.c;
+                if (inst.aux)
+                {
+                    ss << " aux=" << inst.aux;
+                }
+                ss << "\n";
+            }
+        }
+        for (const auto &native : natives)
+        {
+            ss << "extern " << native.name << " (" << native.params.size() << " params)\n";
+        }
+        return ss.str();
+    }
+
+} // namespace Fern::Bytecode
@@ -0,0 +1,292 @@
+// bytecode.hpp - Register bytecode compiled from HLIR, run by the Interpreter
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Fern::Bytecode
+{
+
+    // Scalar operations: name, operand type, result type, result in terms of `a` and `b`.
+    // The opcode list, the interpreter's handlers and its per-lane vector loops all expand
+    // from these tables, so an operation's meaning is written down exactly once.
+    // Integer arithmetic is done on unsigned types so overflow wraps like LLVM's add/sub/mul.
+#define FERN_BYTECODE_INT_BINARY(X, W)                                   \
+    X(Add##W, uint##W##_t, uint##W##_t, a + b)                            \
+    X(Sub##W, uint##W##_t, uint##W##_t, a - b)                            \
+    X(Mul##W, uint##W##_t, uint##W##_t, a * b)                            \
+    X(SDiv##W, int##W##_t, int##W##_t, a / b)                             \
+    X(UDiv##W, uint##W##_t, uint##W##_t, a / b)                           \
+    X(SRem##W, int##W##_t, int##W##_t, a % b)                             \
+    X(URem##W, uint##W##_t, uint##W##_t, a % b)                           \
+    X(And##W, uint##W##_t, uint##W##_t, a & b)                            \
+    X(Or##W, uint##W##_t, uint##W##_t, a | b)                             \
+    X(Xor##W, uint##W##_t, uint##W##_t, a ^ b)                            \
+    X(Shl##W, uint##W##_t, uint##W##_t, a << (b & (W - 1)))               \
+    X(AShr##W, int##W##_t, int##W##_t, a >> (b & (W - 1)))                \
+    X(LShr##W, uint##W##_t, uint##W##_t, a >> (b & (W - 1)))              \
+    X(Eq##W, uint##W##_t, uint8_t, a == b)                                \
+    X(Ne##W, uint##W##_t, uint8_t, a != b)                                \
+    X(SLt##W, int##W##_t, uint8_t, a < b)                                 \
+    X(SLe##W, int##W##_t, uint8_t, a <= b)                                \
+    X(ULt##W, uint##W##_t, uint8_t, a < b)                                \
+    X(ULe##W, uint##W##_t, uint8_t, a <= b)
+
+    // Comparisons are ordered: false when either side is NaN, like fcmp olt/one
+#define FERN_BYTECODE_FLOAT_BINARY(X, W, T)                              \
+    X(FAdd##W, T, T, a + b)                                               \
+    X(FSub##W, T, T, a - b)                                               \
+    X(FMul##W, T, T, a * b)                                               \
+    X(FDiv##W, T, T, a / b)                                               \
+    X(FRem##W, T, T, std::fmod(a, b))                                     \
+    X(FEq##W, T, uint8_t, a == b)                                         \
+    X(FNe##W, T, uint8_t, a < b || a > b)                                 \
+    X(FLt##W, T, uint8_t, a < b)                                          \
+    X(FLe##W, T, uint8_t, a <= b)
+
+#define FERN_BYTECODE_BINARY_OPS(X)                                       \
+    FERN_BYTECODE_INT_BINARY(X, 8)                                        \
+    FERN_BYTECODE_INT_BINARY(X, 16)                                       \
+    FERN_BYTECODE_INT_BINARY(X, 32)                                       \
+    FERN_BYTECODE_INT_BINARY(X, 64)                                       \
+    FERN_BYTECODE_FLOAT_BINARY(X, 32, float)                              \
+    FERN_BYTECODE_FLOAT_BINARY(X, 64, double)
+
+#define FERN_BYTECODE_INT_UNARY(X, W)                                    \
+    X(Neg##W, uint##W##_t, uint##W##_t, 0 - a)                            \
+    X(Not##W, uint##W##_t, uint##W##_t, ~a)
+
+#define FERN_BYTECODE_UNARY_OPS(X)                                        \
+    FERN_BYTECODE_INT_UNARY(X, 8)                                         \
+    FERN_BYTECODE_INT_UNARY(X, 16)                                        \
+    FERN_BYTECODE_INT_UNARY(X, 32)                                        \
+    FERN_BYTECODE_INT_UNARY(X, 64)                                        \
+    X(BoolNot, uint8_t, uint8_t, a ^ 1)                                   \
+    X(FNeg32, float, float, -a)                                           \
+    X(FNeg64, double, double, -a)
+
+    // Everything else. Operands are byte offsets into the frame unless noted.
+#define FERN_BYTECODE_OTHER_OPS(X)                                        \
+    X(Mov)              /* dst <- a, one 8-byte slot */                   \
+    X(MovN)             /* dst <- a, c bytes */                           \
+    X(Load1)            /* dst <- *a */                                   \
+    X(Load2)                                                              \
+    X(Load4)                                                              \
+    X(Load8)                                                              \
+    X(LoadN)            /* c bytes */                                     \
+    X(Store1)           /* *b <- a */                                     \
+    X(Store2)                                                             \
+    X(Store4)                                                             \
+    X(Store8)                                                             \
+    X(StoreN)           /* c bytes */                                     \
+    X(StackAlloc)       /* dst <- b bytes of stack, aligned to aux */     \
+    X(HeapAlloc)        /* dst <- malloc(b) */                            \
+    X(AddOffset)        /* dst <- a + b, b a constant */                  \
+    X(ElementAddr32)    /* dst <- a + i32 b * c */                        \
+    X(ElementAddr64)                                                      \
+    X(DynElementAddr32) /* dst <- a->data + i32 b * c */                  \
+    X(DynElementAddr64)                                                   \
+    X(BoundsCheck)      /* throw unless 0 <= a < b; aux = kinds */        \
+    X(Cast)             /* dst <- a converted; aux = from | to << 8 */    \
+    X(VectorBinary)     /* aux = lane op, c = lanes */                    \
+    X(VectorUnary)                                                        \
+    X(VectorCast)       /* aux = from | to << 8, c = lanes */             \
+    X(ExtractLane)      /* dst <- a[b]; c = lane size */                  \
+    X(InsertLane)       /* dst[b] <- a; c = lane size */                  \
+    X(Reduce)           /* aux = kind | lane kind << 8, c = lanes */      \
+    X(Call)             /* a = function, b = call site */                 \
+    X(CallNative)       /* a = native, b = call site */                   \
+    X(Ret)              /* return slot a */                               \
+    X(RetVoid)                                                            \
+    X(Jump)             /* to instruction a */                            \
+    X(JumpIf)           /* to instruction b if a */                       \
+    X(JumpIfNot)
+
+#define FERN_BYTECODE_OP_NAME(name, ...) name,
+
+    enum class Op : uint16_t
+    {
+        FERN_BYTECODE_BINARY_OPS(FERN_BYTECODE_OP_NAME)
+        FERN_BYTECODE_UNARY_OPS(FERN_BYTECODE_OP_NAME)
+        FERN_BYTECODE_OTHER_OPS(FERN_BYTECODE_OP_NAME)
+        Count
+    };
+
+    const char *op_name(Op op);
+
+    // The integer ops repeat in the same order for every width, so the 16, 32 and
+    // 64-bit forms sit at a fixed stride from the 8-bit one
+    inline Op int_op(Op op8, uint32_t bytes)
+    {
+        uint16_t stride = op8 >= Op::Neg8
+            ? static_cast<uint16_t>(Op::Neg16) - static_cast<uint16_t>(Op::Neg8)
+            : static_cast<uint16_t>(Op::Add16) - static_cast<uint16_t>(Op::Add8);
+        uint16_t step = bytes >= 8 ? 3 : bytes >= 4 ? 2 : bytes >= 2 ? 1 : 0;
+        return static_cast<Op>(static_cast<uint16_t>(op8) + stride * step);
+    }
+
+    inline Op float_op(Op op32, bool is_double)
+    {
+        uint16_t stride = static_cast<uint16_t>(Op::FAdd64) - static_cast<uint16_t>(Op::FAdd32);
+        return is_double ? static_cast<Op>(static_cast<uint16_t>(op32) + stride) : op32;
+    }
+
+    // How a slot's bytes are read; also picks native calling-convention registers
+    enum class ValueKind : uint8_t
+    {
+        Void,
+        Bool,
+        I8,
+        I16,
+        I32,
+        I64,
+        U8,
+        U16,
+        U32,
+        U64,
+        F32,
+        F64,
+        Ptr,
+        Aggregate, // structs, arrays and vectors, copied by size
+    };
+
+    // Same order as HLIR::ReduceKind
+    enum class ReduceKind : uint8_t
+    {
+        Add,
+        Mul,
+        Min,
+        Max,
+    };
+
+    inline bool is_float_kind(ValueKind kind) { return kind == ValueKind::F32 || kind == ValueKind::F64; }
+    inline bool is_signed_kind(ValueKind kind)
+    {
+        return kind == ValueKind::I8 || kind == ValueKind::I16 || kind == ValueKind::I32 || kind == ValueKind::I64;
+    }
+    uint32_t kind_size(ValueKind kind);
+
+    // Numeric conversion between scalar kinds, with the rules HLIRCodeGen::gen_cast uses
+    void convert(ValueKind from, const uint8_t *src, ValueKind to, uint8_t *dst);
+
+    struct Instruction
+    {
+        Op op;
+        uint16_t aux = 0;
+        uint32_t dst = 0;
+        uint32_t a = 0;
+        uint32_t b = 0;
+        uint32_t c = 0;
+    };
+
+    struct Slot
+    {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+        ValueKind kind = ValueKind::Void;
+    };
+
+    // Frame offsets of a call's arguments, in parameter order
+    struct CallSite
+    {
+        std::vector<uint32_t> args;
+    };
+
+    /**
+     * A function's frame is one block of 8-byte aligned slots:
+     * [constants | parameters | instruction results | phi temporaries]
+     * The constant part is copied in from `constants` on entry, so constants cost
+     * nothing at run time and every operand is just a frame offset.
+     */
+    struct Function
+    {
+        std::string name;
+        std::vector<Instruction> code;
+        std::vector<uint8_t> constants;
+        std::vector<Slot> params;
+        Slot result; // kind Void when the function returns nothing
+        uint32_t frame_size = 0;
+    };
+
+    // An extern fn (or a declaration without a body), resolved in the host process at run time
+    struct NativeFunction
+    {
+        std::string name;
+        std::vector<ValueKind> params;
+        ValueKind result = ValueKind::Void;
+        uint32_t result_size = 0;
+    };
+
+    struct Program
+    {
+        std::vector<Function> functions;
+        std::vector<NativeFunction> natives;
+        std::vector<CallSite> call_sites;
+        std::deque<std::string> strings; // string constants; a deque so their addresses never move
+        std::unordered_map<std::string, uint32_t> function_index;
+
+        const Function *find_function(const std::string &name) const
+        {
+            auto it = function_index.find(name);
+            return it == function_index.end() ? nullptr : &functions[it->second];
+        }
+
+        size_t instruction_count() const;
+        std::string dump() const;
+    };
+
+    template <typename T>
+    T read(const uint8_t *p)
+    {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void write(uint8_t *p, T value)
+    {
+        std::memcpy(p, &value, sizeof(T));
+    }
+
+    // Read a slot of any scalar kind as a numeric T, converting like a cast would
+    template <typename T>
+    T read_as(ValueKind kind, const uint8_t *p)
+    {
+        static_assert(std::is_arithmetic_v<T>);
+        switch (kind)
+        {
+        case ValueKind::Bool:
+        case ValueKind::U8:
+            return static_cast<T>(read<uint8_t>(p));
+        case ValueKind::I8:
+            return static_cast<T>(read<int8_t>(p));
+        case ValueKind::I16:
+            return static_cast<T>(read<int16_t>(p));
+        case ValueKind::U16:
+            return static_cast<T>(read<uint16_t>(p));
+        case ValueKind::I32:
+            return static_cast<T>(read<int32_t>(p));
+        case ValueKind::U32:
+            return static_cast<T>(read<uint32_t>(p));
+        case ValueKind::I64:
+            return static_cast<T>(read<int64_t>(p));
+        case ValueKind::U64:
+        case ValueKind::Ptr:
+            return static_cast<T>(read<uint64_t>(p));
+        case ValueKind::F32:
+            return static_cast<T>(read<float>(p));
+        case ValueKind::F64:
+            return static_cast<T>(read<double>(p));
+        default:
+            return T();
+        }
+    }
+
+} // namespace Fern::Bytecode
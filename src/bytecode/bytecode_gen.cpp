@@ -0,0 +1,1033 @@
+// bytecode_gen.cpp - HLIR to interpreter bytecode lowering implementation
+#include "bytecode_gen.hpp"
+#include "hlir/loop_analysis.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace Fern
+{
+    using Bytecode::Op;
+    using Bytecode::Slot;
+    using Bytecode::ValueKind;
+
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    static uint32_t align_to(uint32_t value, uint32_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    static bool is_constant(HLIR::Opcode op)
+    {
+        return op == HLIR::Opcode::ConstInt || op == HLIR::Opcode::ConstFloat ||
+               op == HLIR::Opcode::ConstBool || op == HLIR::Opcode::ConstNull ||
+               op == HLIR::Opcode::ConstString;
+    }
+
+    static TypePtr lane_type(TypePtr type)
+    {
+        auto *vector = type->as<VectorType>();
+        return vector ? vector->element : type;
+    }
+
+    // ============================================================================
+    // Main Entry Point
+    // ============================================================================
+
+    std::unique_ptr<Bytecode::Program> BytecodeGen::lower(HLIR::Module *hlir_module)
+    {
+        auto result = std::make_unique<Bytecode::Program>();
+        program = result.get();
+
+        declare_functions(hlir_module);
+        for (const auto &hlir_func : hlir_module->functions)
+        {
+            if (function_index.count(hlir_func.get()))
+            {
+                generate_function(hlir_func.get());
+            }
+        }
+
+        program = nullptr;
+        current = nullptr;
+        return result;
+    }
+
+    // ============================================================================
+    // Types
+    // ============================================================================
+
+    ValueKind BytecodeGen::kind_of(TypePtr type)
+    {
+        if (!type)
+        {
+            return ValueKind::Void;
+        }
+        if (auto *prim = type->as<PrimitiveType>())
+        {
+            switch (prim->kind)
+            {
+            case PrimitiveKind::Void:
+                return ValueKind::Void;
+            case PrimitiveKind::Bool:
+                return ValueKind::Bool;
+            case PrimitiveKind::Char:
+            case PrimitiveKind::U8:
+                return ValueKind::U8;
+            case PrimitiveKind::I8:
+                return ValueKind::I8;
+            case PrimitiveKind::I16:
+                return ValueKind::I16;
+            case PrimitiveKind::U16:
+                return ValueKind::U16;
+            case PrimitiveKind::I32:
+                return ValueKind::I32;
+            case PrimitiveKind::U32:
+                return ValueKind::U32;
+            case PrimitiveKind::I64:
+                return ValueKind::I64;
+            case PrimitiveKind::U64:
+                return ValueKind::U64;
+            case PrimitiveKind::F32:
+                return ValueKind::F32;
+            case PrimitiveKind::F64:
+                return ValueKind::F64;
+            }
+        }
+        if (type->is<PointerType>() || type->is<FunctionType>())
+        {
+            return ValueKind::Ptr;
+        }
+        if (type->is<UnresolvedType>() || type->is<TypeParameter>())
+        {
+            // The same programs HLIRCodeGen rejects, so both backends agree on what compiles
+            throw std::runtime_error("Cannot lower unresolved type: " + type->get_name());
+        }
+        return ValueKind::Aggregate;
+    }
+
+    uint32_t BytecodeGen::size_of(TypePtr type)
+    {
+        return type ? static_cast<uint32_t>(std::max(0, type->get_size())) : 0;
+    }
+
+    // Same layout as HLIRCodeGen::get_field_offsets
+    const std::vector<uint32_t> &BytecodeGen::get_field_offsets(TypeSymbol *type_sym)
+    {
+        auto it = field_offsets.find(type_sym);
+        if (it != field_offsets.end())
+        {
+            return it->second;
+        }
+
+        std::vector<uint32_t> offsets;
+        int offset = 0;
+        for (const auto &member : type_sym->member_order)
+        {
+            if (auto *var_sym = member->as<VariableSymbol>())
+            {
+                int alignment = var_sym->type ? std::max(1, var_sym->type->get_alignment()) : 1;
+                offset = (offset + alignment - 1) / alignment * alignment;
+                offsets.push_back(static_cast<uint32_t>(offset));
+                offset += var_sym->type ? var_sym->type->get_size() : 0;
+            }
+        }
+
+        return field_offsets[type_sym] = std::move(offsets);
+    }
+
+    // ============================================================================
+    // Functions and Frames
+    // ============================================================================
+
+    void BytecodeGen::declare_functions(HLIR::Module *hlir_module)
+    {
+        for (const auto &hlir_func : hlir_module->functions)
+        {
+            HLIR::Function *func = hlir_func.get();
+            if (func->is_external || !func->entry)
+            {
+                // Resolved in the host process like the JIT does: simple names for externs
+                Bytecode::NativeFunction native;
+                native.name = func->is_external && func->symbol ? func->symbol->name : func->name();
+                for (HLIR::Value *param : func->params)
+                {
+                    native.params.push_back(kind_of(param->type));
+                }
+                native.result = kind_of(func->return_type());
+                native.result_size = size_of(func->return_type());
+                native_index[func] = static_cast<uint32_t>(program->natives.size());
+                program->natives.push_back(std::move(native));
+                continue;
+            }
+
+            uint32_t index = static_cast<uint32_t>(program->functions.size());
+            function_index[func] = index;
+            program->functions.emplace_back();
+            program->functions.back().name = func->name();
+            program->function_index[func->name()] = index;
+        }
+    }
+
+    void BytecodeGen::generate_function(HLIR::Function *hlir_func)
+    {
+        current = &program->functions[function_index[hlir_func]];
+        slots.assign(hlir_func->next_value_id, Slot{NO_SLOT, 0, ValueKind::Void});
+        block_start.assign(hlir_func->next_block_id, 0);
+        fixups.clear();
+        frame_size = 0;
+
+        // Constants first, so the frame's prefix can be copied in from one image
+        for (const auto &block : hlir_func->blocks)
+        {
+            for (auto *inst : block->instructions)
+            {
+                if (inst->result && is_constant(inst->op))
+                {
+                    gen_constant(inst);
+                }
+            }
+        }
+        current->constants.resize(frame_size, 0);
+
+        for (HLIR::Value *param : hlir_func->params)
+        {
+            slots[param->id] = allocate_slot(param->type);
+            current->params.push_back(slots[param->id]);
+        }
+
+        for (const auto &block : hlir_func->blocks)
+        {
+            for (auto *inst : block->instructions)
+            {
+                if (inst->result && !is_constant(inst->op))
+                {
+                    slots[inst->result->id] = allocate_slot(inst->result->type);
+                }
+            }
+        }
+
+        TypePtr return_type = hlir_func->return_type();
+        current->result = {0, size_of(return_type), kind_of(return_type)};
+
+        // Reverse post-order puts loop bodies right after their headers, so most
+        // branches fall through; unreachable leftovers go last
+        std::vector<HLIR::BasicBlock *> order = HLIR::compute_reverse_post_order(hlir_func);
+        std::unordered_set<HLIR::BasicBlock *> ordered(order.begin(), order.end());
+        for (const auto &block : hlir_func->blocks)
+        {
+            if (!ordered.count(block.get()))
+            {
+                order.push_back(block.get());
+            }
+        }
+
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            block_start[order[i]->id] = static_cast<uint32_t>(current->code.size());
+            generate_block(order[i], i + 1 < order.size() ? order[i + 1] : nullptr);
+        }
+
+        for (const auto &fixup : fixups)
+        {
+            Bytecode::Instruction &inst = current->code[fixup.index];
+            (fixup.in_b ? inst.b : inst.a) = block_start[fixup.target->id];
+        }
+
+        current->frame_size = align_to(frame_size, 16);
+        current = nullptr;
+    }
+
+    Slot BytecodeGen::allocate_slot(TypePtr type)
+    {
+        // Every slot starts 8-byte aligned and is rounded up to 8 bytes, so a whole
+        // scalar slot can always be moved as one 8-byte word
+        Slot slot;
+        slot.offset = frame_size;
+        slot.size = size_of(type);
+        slot.kind = kind_of(type);
+        frame_size += align_to(std::max<uint32_t>(slot.size, 1), 8);
+        return slot;
+    }
+
+    const Slot &BytecodeGen::slot_of(HLIR::Value *value)
+    {
+        if (!value || value->id >= slots.size() || slots[value->id].offset == NO_SLOT)
+        {
+            throw std::runtime_error("Bytecode generation: value has no slot in " + current->name +
+                                     (value ? " (%" + std::to_string(value->id) + ")" : ""));
+        }
+        return slots[value->id];
+    }
+
+    // ============================================================================
+    // Blocks and Control Flow
+    // ============================================================================
+
+    void BytecodeGen::generate_block(HLIR::BasicBlock *block, HLIR::BasicBlock *next)
+    {
+        for (auto *inst : block->instructions)
+        {
+            switch (inst->op)
+            {
+            case HLIR::Opcode::Br:
+                emit_edge(block, static_cast<HLIR::BrInst *>(inst)->target, next);
+                break;
+            case HLIR::Opcode::CondBr:
+                gen_cond_br(static_cast<HLIR::CondBrInst *>(inst), next);
+                break;
+            default:
+                generate_instruction(inst);
+                break;
+            }
+        }
+
+        if (!block->terminator())
+        {
+            throw std::runtime_error("Bytecode generation: block bb" + std::to_string(block->id) + " in " +
+                                     current->name + " has no terminator");
+        }
+    }
+
+    void BytecodeGen::gen_cond_br(HLIR::CondBrInst *inst, HLIR::BasicBlock *next)
+    {
+        HLIR::BasicBlock *block = inst->parent;
+        uint32_t condition = slot_of(inst->condition).offset;
+
+        auto has_copies = [&](HLIR::BasicBlock *target)
+        {
+            return !target->instructions.empty() && target->instructions.front()->op == HLIR::Opcode::Phi;
+        };
+
+        if (!has_copies(inst->false_block))
+        {
+            emit_jump(Op::JumpIfNot, condition, inst->false_block);
+            emit_edge(block, inst->true_block, next);
+        }
+        else if (!has_copies(inst->true_block))
+        {
+            emit_jump(Op::JumpIf, condition, inst->true_block);
+            emit_edge(block, inst->false_block, next);
+        }
+        else
+        {
+            // Both edges carry phi copies: the true edge's copies inline, the false edge's after them
+            size_t branch = emit(Op::JumpIfNot, 0, condition);
+            emit_edge(block, inst->true_block, nullptr);
+            current->code[branch].b = static_cast<uint32_t>(current->code.size());
+            emit_edge(block, inst->false_block, next);
+        }
+    }
+
+    void BytecodeGen::emit_edge(HLIR::BasicBlock *from, HLIR::BasicBlock *to, HLIR::BasicBlock *next)
+    {
+        struct Copy
+        {
+            uint32_t dst, src, size;
+        };
+        std::vector<Copy> copies;
+        std::unordered_set<uint32_t> destinations;
+
+        for (auto *inst : to->instructions)
+        {
+            if (inst->op != HLIR::Opcode::Phi)
+            {
+                break;
+            }
+            auto *phi = static_cast<HLIR::PhiInst *>(inst);
+            for (const auto &[value, block] : phi->incoming)
+            {
+                if (block == from && value)
+                {
+                    const Slot &dst = slot_of(phi->result);
+                    copies.push_back({dst.offset, slot_of(value).offset, dst.size});
+                    destinations.insert(dst.offset);
+                    break;
+                }
+            }
+        }
+
+        // Phis read their inputs all at once; go through temporaries when one phi feeds another
+        bool overlapping = std::any_of(copies.begin(), copies.end(), [&](const Copy &copy)
+        {
+            return copy.src != copy.dst && destinations.count(copy.src);
+        });
+        if (overlapping)
+        {
+            std::vector<uint32_t> temps;
+            for (const auto &copy : copies)
+            {
+                uint32_t temp = frame_size;
+                frame_size += align_to(std::max<uint32_t>(copy.size, 1), 8);
+                emit_copy(temp, copy.src, copy.size);
+                temps.push_back(temp);
+            }
+            for (size_t i = 0; i < copies.size(); i++)
+            {
+                emit_copy(copies[i].dst, temps[i], copies[i].size);
+            }
+        }
+        else
+        {
+            for (const auto &copy : copies)
+            {
+                emit_copy(copy.dst, copy.src, copy.size);
+            }
+        }
+
+        if (to != next)
+        {
+            emit_jump(Op::Jump, 0, to);
+        }
+    }
+
+    void BytecodeGen::emit_jump(Op op, uint32_t condition, HLIR::BasicBlock *target)
+    {
+        size_t index = emit(op, 0, condition);
+        fixups.push_back({index, op != Op::Jump, target});
+    }
+
+    void BytecodeGen::emit_copy(uint32_t dst, uint32_t src, uint32_t size)
+    {
+        if (dst == src)
+        {
+            return;
+        }
+        if (size <= 8)
+        {
+            emit(Op::Mov, dst, src);
+        }
+        else
+        {
+            emit(Op::MovN, dst, src, 0, size);
+        }
+    }
+
+    size_t BytecodeGen::emit(Op op, uint32_t dst, uint32_t a, uint32_t b, uint32_t c, uint16_t aux)
+    {
+        Bytecode::Instruction inst;
+        inst.op = op;
+        inst.aux = aux;
+        inst.dst = dst;
+        inst.a = a;
+        inst.b = b;
+        inst.c = c;
+        current->code.push_back(inst);
+        return current->code.size() - 1;
+    }
+
+    // ============================================================================
+    // Instruction Generation
+    // ============================================================================
+
+    void BytecodeGen::generate_instruction(HLIR::Instruction *inst)
+    {
+        switch (inst->op)
+        {
+        case HLIR::Opcode::ConstInt:
+        case HLIR::Opcode::ConstFloat:
+        case HLIR::Opcode::ConstBool:
+        case HLIR::Opcode::ConstNull:
+        case HLIR::Opcode::ConstString:
+        case HLIR::Opcode::Phi:
+            // Constants live in the frame image; phis are written by their incoming edges
+            break;
+        case HLIR::Opcode::Alloc:
+            gen_alloc(static_cast<HLIR::AllocInst *>(inst));
+            break;
+        case HLIR::Opcode::Load:
+            gen_load(static_cast<HLIR::LoadInst *>(inst));
+            break;
+        case HLIR::Opcode::Store:
+            gen_store(static_cast<HLIR::StoreInst *>(inst));
+            break;
+        case HLIR::Opcode::FieldAddr:
+            gen_field_addr(static_cast<HLIR::FieldAddrInst *>(inst));
+            break;
+        case HLIR::Opcode::ElementAddr:
+            gen_element_addr(static_cast<HLIR::ElementAddrInst *>(inst));
+            break;
+        case HLIR::Opcode::BoundsCheck:
+            gen_bounds_check(static_cast<HLIR::BoundsCheckInst *>(inst));
+            break;
+        case HLIR::Opcode::Add:
+        case HLIR::Opcode::Sub:
+        case HLIR::Opcode::Mul:
+        case HLIR::Opcode::Div:
+        case HLIR::Opcode::Rem:
+        case HLIR::Opcode::Eq:
+        case HLIR::Opcode::Ne:
+        case HLIR::Opcode::Lt:
+        case HLIR::Opcode::Le:
+        case HLIR::Opcode::Gt:
+        case HLIR::Opcode::Ge:
+        case HLIR::Opcode::And:
+        case HLIR::Opcode::Or:
+        case HLIR::Opcode::BitAnd:
+        case HLIR::Opcode::BitOr:
+        case HLIR::Opcode::BitXor:
+        case HLIR::Opcode::Shl:
+        case HLIR::Opcode::Shr:
+            gen_binary(static_cast<HLIR::BinaryInst *>(inst));
+            break;
+        case HLIR::Opcode::Neg:
+        case HLIR::Opcode::Not:
+        case HLIR::Opcode::BitNot:
+            gen_unary(static_cast<HLIR::UnaryInst *>(inst));
+            break;
+        case HLIR::Opcode::Cast:
+            gen_cast(static_cast<HLIR::CastInst *>(inst));
+            break;
+        case HLIR::Opcode::Splat:
+        case HLIR::Opcode::BuildVector:
+        case HLIR::Opcode::ExtractLane:
+        case HLIR::Opcode::InsertLane:
+        case HLIR::Opcode::Shuffle:
+        case HLIR::Opcode::Reduce:
+            gen_vector(inst);
+            break;
+        case HLIR::Opcode::Call:
+            gen_call(static_cast<HLIR::CallInst *>(inst));
+            break;
+        case HLIR::Opcode::Ret:
+            gen_ret(static_cast<HLIR::RetInst *>(inst));
+            break;
+        default:
+            throw std::runtime_error("Unsupported HLIR opcode: " +
+                std::to_string(static_cast<int>(inst->op)));
+        }
+    }
+
+    void BytecodeGen::gen_constant(HLIR::Instruction *inst)
+    {
+        Slot slot = allocate_slot(inst->result->type);
+        if (inst->op == HLIR::Opcode::ConstInt && slot.kind == ValueKind::Void)
+        {
+            // Untyped integer constants are i32, as in HLIRCodeGen::gen_const_int
+            slot.size = 4;
+            slot.kind = ValueKind::I32;
+        }
+        slots[inst->result->id] = slot;
+        current->constants.resize(frame_size, 0);
+        uint8_t *bytes = current->constants.data() + slot.offset;
+
+        switch (inst->op)
+        {
+        case HLIR::Opcode::ConstInt:
+        {
+            // Pointers, arrays and structs made by const_null are all zero bytes
+            int64_t value = static_cast<HLIR::ConstIntInst *>(inst)->value;
+            if (slot.kind != ValueKind::Aggregate)
+            {
+                Bytecode::convert(ValueKind::I64, reinterpret_cast<const uint8_t *>(&value), slot.kind, bytes);
+            }
+            break;
+        }
+        case HLIR::Opcode::ConstFloat:
+        {
+            double value = static_cast<HLIR::ConstFloatInst *>(inst)->value;
+            Bytecode::convert(ValueKind::F64, reinterpret_cast<const uint8_t *>(&value), slot.kind, bytes);
+            break;
+        }
+        case HLIR::Opcode::ConstBool:
+            bytes[0] = static_cast<HLIR::ConstBoolInst *>(inst)->value ? 1 : 0;
+            break;
+        case HLIR::Opcode::ConstString:
+        {
+            program->strings.push_back(static_cast<HLIR::ConstStringInst *>(inst)->value);
+            Bytecode::write<const char *>(bytes, program->strings.back().c_str());
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    void BytecodeGen::gen_alloc(HLIR::AllocInst *inst)
+    {
+        uint32_t size = std::max<uint32_t>(size_of(inst->alloc_type), 1);
+        uint32_t dst = slot_of(inst->result).offset;
+
+        if (inst->on_stack)
+        {
+            // Same alignment rule as HLIRCodeGen::gen_alloc
+            uint32_t alignment = static_cast<uint32_t>(std::max(1, inst->alloc_type->get_alignment()));
+            if (inst->alloc_type->is<ArrayType>() && size >= 16)
+            {
+                alignment = std::max<uint32_t>(alignment, 16);
+            }
+            emit(Op::StackAlloc, dst, 0, size, 0, static_cast<uint16_t>(alignment));
+        }
+        else
+        {
+            emit(Op::HeapAlloc, dst, 0, size);
+        }
+
+        // A constant table starts out holding its elements
+        if (!inst->initializer.empty())
+        {
+            uint32_t element_size = size_of(inst->alloc_type->as<ArrayType>()->element);
+            uint32_t address = frame_size;
+            frame_size += 8;
+            for (size_t i = 0; i < inst->initializer.size(); i++)
+            {
+                emit(Op::AddOffset, address, dst, static_cast<uint32_t>(i * element_size));
+                emit_store(slot_of(inst->initializer[i]), address);
+            }
+        }
+    }
+
+    void BytecodeGen::gen_load(HLIR::LoadInst *inst)
+    {
+        const Slot &result = slot_of(inst->result);
+        uint32_t address = slot_of(inst->address).offset;
+        switch (result.size)
+        {
+        case 1:
+            emit(Op::Load1, result.offset, address);
+            break;
+        case 2:
+            emit(Op::Load2, result.offset, address);
+            break;
+        case 4:
+            emit(Op::Load4, result.offset, address);
+            break;
+        case 8:
+            emit(Op::Load8, result.offset, address);
+            break;
+        default:
+            emit(Op::LoadN, result.offset, address, 0, result.size);
+            break;
+        }
+    }
+
+    void BytecodeGen::gen_store(HLIR::StoreInst *inst)
+    {
+        emit_store(slot_of(inst->value), slot_of(inst->address).offset);
+    }
+
+    void BytecodeGen::emit_store(const Slot &value, uint32_t address)
+    {
+        switch (value.size)
+        {
+        case 1:
+            emit(Op::Store1, 0, value.offset, address);
+            break;
+        case 2:
+            emit(Op::Store2, 0, value.offset, address);
+            break;
+        case 4:
+            emit(Op::Store4, 0, value.offset, address);
+            break;
+        case 8:
+            emit(Op::Store8, 0, value.offset, address);
+            break;
+        default:
+            emit(Op::StoreN, 0, value.offset, address, value.size);
+            break;
+        }
+    }
+
+    void BytecodeGen::gen_field_addr(HLIR::FieldAddrInst *inst)
+    {
+        TypePtr struct_type = inst->object->type;
+        if (auto *ptr_type = struct_type->as<PointerType>())
+        {
+            struct_type = ptr_type->pointee;
+        }
+
+        // Dynamic arrays are a { i32 length, ptr data } header
+        static const std::vector<uint32_t> array_header_offsets = {0, 8};
+
+        const std::vector<uint32_t> *offsets = nullptr;
+        auto *array_type = struct_type->as<ArrayType>();
+        if (array_type && array_type->size < 0)
+        {
+            offsets = &array_header_offsets;
+        }
+        else if (auto *named = struct_type->as<NamedType>(); named && named->symbol)
+        {
+            offsets = &get_field_offsets(named->symbol);
+        }
+        else
+        {
+            throw std::runtime_error("Field address of non-struct type: " + struct_type->get_name());
+        }
+        if (inst->field_index >= offsets->size())
+        {
+            throw std::runtime_error("Field index out of range in " + struct_type->get_name());
+        }
+
+        uint32_t dst = slot_of(inst->result).offset;
+        uint32_t object = slot_of(inst->object).offset;
+        uint32_t offset = (*offsets)[inst->field_index];
+        if (offset == 0)
+        {
+            emit(Op::Mov, dst, object);
+        }
+        else
+        {
+            emit(Op::AddOffset, dst, object, offset);
+        }
+    }
+
+    void BytecodeGen::gen_element_addr(HLIR::ElementAddrInst *inst)
+    {
+        TypePtr element_type = inst->result->type;
+        if (auto *ptr_type = element_type->as<PointerType>())
+        {
+            element_type = ptr_type->pointee;
+        }
+
+        // The array operand always holds an address; for a dynamic array it's the
+        // address of the { i32 length, ptr data } header
+        auto *array_type = inst->array->type->as<ArrayType>();
+        bool dynamic = array_type && array_type->size < 0;
+
+        uint32_t index = slot_of(inst->index).offset;
+        ValueKind index_kind = slot_of(inst->index).kind;
+        bool wide = Bytecode::kind_size(index_kind) == 8;
+        if (Bytecode::kind_size(index_kind) != 4 && !wide)
+        {
+            uint32_t widened = frame_size;
+            frame_size += 8;
+            emit(Op::Cast, widened, index, 0, 0,
+                 static_cast<uint16_t>(static_cast<uint16_t>(index_kind) | (static_cast<uint16_t>(ValueKind::I64) << 8)));
+            index = widened;
+            wide = true;
+        }
+
+        Op op = dynamic ? (wide ? Op::DynElementAddr64 : Op::DynElementAddr32)
+                        : (wide ? Op::ElementAddr64 : Op::ElementAddr32);
+        emit(op, slot_of(inst->result).offset, slot_of(inst->array).offset, index, size_of(element_type));
+    }
+
+    void BytecodeGen::gen_bounds_check(HLIR::BoundsCheckInst *inst)
+    {
+        const Slot &index = slot_of(inst->index);
+        const Slot &length = slot_of(inst->length);
+        emit(Op::BoundsCheck, 0, index.offset, length.offset, 0,
+             static_cast<uint16_t>(static_cast<uint16_t>(index.kind) | (static_cast<uint16_t>(length.kind) << 8)));
+    }
+
+    // Pick the scalar op for an HLIR binary opcode; Gt and Ge become Lt and Le with swapped operands
+    static Op select_binary_op(HLIR::Opcode opcode, TypePtr operand_type, bool &swap)
+    {
+        ValueKind kind = BytecodeGen::kind_of(lane_type(operand_type));
+        bool is_float = Bytecode::is_float_kind(kind);
+        bool is_signed = Bytecode::is_signed_kind(kind);
+        swap = false;
+
+        Op op;
+        switch (opcode)
+        {
+        case HLIR::Opcode::Add:
+            op = is_float ? Op::FAdd32 : Op::Add8;
+            break;
+        case HLIR::Opcode::Sub:
+            op = is_float ? Op::FSub32 : Op::Sub8;
+            break;
+        case HLIR::Opcode::Mul:
+            op = is_float ? Op::FMul32 : Op::Mul8;
+            break;
+        case HLIR::Opcode::Div:
+            op = is_float ? Op::FDiv32 : is_signed ? Op::SDiv8 : Op::UDiv8;
+            break;
+        case HLIR::Opcode::Rem:
+            op = is_float ? Op::FRem32 : is_signed ? Op::SRem8 : Op::URem8;
+            break;
+        case HLIR::Opcode::Eq:
+            op = is_float ? Op::FEq32 : Op::Eq8;
+            break;
+        case HLIR::Opcode::Ne:
+            op = is_float ? Op::FNe32 : Op::Ne8;
+            break;
+        case HLIR::Opcode::Gt:
+            swap = true;
+            [[fallthrough]];
+        case HLIR::Opcode::Lt:
+            op = is_float ? Op::FLt32 : is_signed ? Op::SLt8 : Op::ULt8;
+            break;
+        case HLIR::Opcode::Ge:
+            swap = true;
+            [[fallthrough]];
+        case HLIR::Opcode::Le:
+            op = is_float ? Op::FLe32 : is_signed ? Op::SLe8 : Op::ULe8;
+            break;
+        case HLIR::Opcode::And:
+        case HLIR::Opcode::BitAnd:
+            op = Op::And8;
+            break;
+        case HLIR::Opcode::Or:
+        case HLIR::Opcode::BitOr:
+            op = Op::Or8;
+            break;
+        case HLIR::Opcode::BitXor:
+            op = Op::Xor8;
+            break;
+        case HLIR::Opcode::Shl:
+            op = Op::Shl8;
+            break;
+        case HLIR::Opcode::Shr:
+            op = is_signed ? Op::AShr8 : Op::LShr8;
+            break;
+        default:
+            throw std::runtime_error("Unsupported binary operation");
+        }
+
+        if (is_float)
+        {
+            if (op < Op::FAdd32)
+            {
+                throw std::runtime_error("Bitwise operation on floating point type " + operand_type->get_name());
+            }
+            return Bytecode::float_op(op, kind == ValueKind::F64);
+        }
+        return Bytecode::int_op(op, std::max<uint32_t>(Bytecode::kind_size(kind), 1));
+    }
+
+    void BytecodeGen::gen_binary(HLIR::BinaryInst *inst)
+    {
+        bool swap;
+        Op op = select_binary_op(inst->op, inst->left->type, swap);
+        uint32_t left = slot_of(inst->left).offset;
+        uint32_t right = slot_of(inst->right).offset;
+        if (swap)
+        {
+            std::swap(left, right);
+        }
+
+        if (auto *vector = inst->left->type->as<VectorType>())
+        {
+            if (!inst->result->type->is<VectorType>())
+            {
+                throw std::runtime_error("Vector comparisons are not supported by the interpreter");
+            }
+            emit(Op::VectorBinary, slot_of(inst->result).offset, left, right, vector->lanes,
+                 static_cast<uint16_t>(op));
+            return;
+        }
+        emit(op, slot_of(inst->result).offset, left, right);
+    }
+
+    void BytecodeGen::gen_unary(HLIR::UnaryInst *inst)
+    {
+        ValueKind kind = kind_of(lane_type(inst->operand->type));
+        Op op;
+        if (inst->op == HLIR::Opcode::Neg)
+        {
+            op = Bytecode::is_float_kind(kind) ? Bytecode::float_op(Op::FNeg32, kind == ValueKind::F64)
+                                               : Bytecode::int_op(Op::Neg8, Bytecode::kind_size(kind));
+        }
+        else if (kind == ValueKind::Bool)
+        {
+            op = Op::BoolNot; // not on i1 flips the one bit
+        }
+        else if (Bytecode::is_float_kind(kind))
+        {
+            throw std::runtime_error("Bitwise not on floating point type " + inst->operand->type->get_name());
+        }
+        else
+        {
+            op = Bytecode::int_op(Op::Not8, Bytecode::kind_size(kind));
+        }
+
+        uint32_t dst = slot_of(inst->result).offset;
+        uint32_t operand = slot_of(inst->operand).offset;
+        if (auto *vector = inst->operand->type->as<VectorType>())
+        {
+            emit(Op::VectorUnary, dst, operand, 0, vector->lanes, static_cast<uint16_t>(op));
+            return;
+        }
+        emit(op, dst, operand);
+    }
+
+    void BytecodeGen::gen_cast(HLIR::CastInst *inst)
+    {
+        const Slot &source = slot_of(inst->value);
+        const Slot &result = slot_of(inst->result);
+
+        auto cast_kinds = [](ValueKind from, ValueKind to)
+        {
+            return static_cast<uint16_t>(static_cast<uint16_t>(from) | (static_cast<uint16_t>(to) << 8));
+        };
+
+        auto *source_vector = inst->value->type->as<VectorType>();
+        auto *target_vector = inst->target_type->as<VectorType>();
+        if (source_vector && target_vector)
+        {
+            emit(Op::VectorCast, result.offset, source.offset, 0, target_vector->lanes,
+                 cast_kinds(kind_of(source_vector->element), kind_of(target_vector->element)));
+            return;
+        }
+
+        if (source.kind == result.kind ||
+            (source.kind == ValueKind::Aggregate || result.kind == ValueKind::Aggregate))
+        {
+            // Same representation (or struct to struct): the bytes carry over
+            if (source.size != result.size && (source.kind == ValueKind::Aggregate || result.kind == ValueKind::Aggregate))
+            {
+                throw std::runtime_error("Cannot cast " + inst->value->type->get_name() + " to " +
+                                         inst->target_type->get_name());
+            }
+            emit_copy(result.offset, source.offset, result.size);
+            return;
+        }
+        emit(Op::Cast, result.offset, source.offset, 0, 0, cast_kinds(source.kind, result.kind));
+    }
+
+    void BytecodeGen::gen_vector(HLIR::Instruction *inst)
+    {
+        uint32_t dst = slot_of(inst->result).offset;
+        auto constant_lane = [](HLIR::Value *lane, int64_t &value)
+        {
+            if (lane->def && lane->def->op == HLIR::Opcode::ConstInt)
+            {
+                value = static_cast<HLIR::ConstIntInst *>(lane->def)->value;
+                return true;
+            }
+            return false;
+        };
+
+        switch (inst->op)
+        {
+        case HLIR::Opcode::Splat:
+        {
+            auto *splat = static_cast<HLIR::SplatInst *>(inst);
+            auto *vector = splat->result->type->as<VectorType>();
+            uint32_t lane_size = size_of(vector->element);
+            for (uint32_t i = 0; i < vector->lanes; i++)
+            {
+                emit(Op::MovN, dst + i * lane_size, slot_of(splat->scalar).offset, 0, lane_size);
+            }
+            break;
+        }
+        case HLIR::Opcode::BuildVector:
+        {
+            auto *build = static_cast<HLIR::BuildVectorInst *>(inst);
+            uint32_t lane_size = size_of(build->result->type->as<VectorType>()->element);
+            for (size_t i = 0; i < build->elements.size(); i++)
+            {
+                emit(Op::MovN, dst + static_cast<uint32_t>(i) * lane_size, slot_of(build->elements[i]).offset, 0,
+                     lane_size);
+            }
+            break;
+        }
+        case HLIR::Opcode::ExtractLane:
+        {
+            auto *extract = static_cast<HLIR::ExtractLaneInst *>(inst);
+            uint32_t lane_size = size_of(extract->result->type);
+            uint32_t vector = slot_of(extract->vector).offset;
+            int64_t lane;
+            if (constant_lane(extract->lane, lane))
+            {
+                emit(Op::MovN, dst, vector + static_cast<uint32_t>(lane) * lane_size, 0, lane_size);
+            }
+            else
+            {
+                emit(Op::ExtractLane, dst, vector, slot_of(extract->lane).offset, lane_size,
+                     static_cast<uint16_t>(slot_of(extract->lane).kind));
+            }
+            break;
+        }
+        case HLIR::Opcode::InsertLane:
+        {
+            auto *insert = static_cast<HLIR::InsertLaneInst *>(inst);
+            uint32_t lane_size = size_of(insert->value->type);
+            emit_copy(dst, slot_of(insert->vector).offset, slot_of(insert->result).size);
+            int64_t lane;
+            if (constant_lane(insert->lane, lane))
+            {
+                emit(Op::MovN, dst + static_cast<uint32_t>(lane) * lane_size, slot_of(insert->value).offset, 0,
+                     lane_size);
+            }
+            else
+            {
+                emit(Op::InsertLane, dst, slot_of(insert->value).offset, slot_of(insert->lane).offset, lane_size,
+                     static_cast<uint16_t>(slot_of(insert->lane).kind));
+            }
+            break;
+        }
+        case HLIR::Opcode::Shuffle:
+        {
+            // Every mask entry is a constant, so a shuffle is just lane moves
+            auto *shuffle = static_cast<HLIR::ShuffleInst *>(inst);
+            auto *left_type = shuffle->left->type->as<VectorType>();
+            uint32_t lane_size = size_of(left_type->element);
+            for (size_t i = 0; i < shuffle->mask.size(); i++)
+            {
+                int32_t lane = shuffle->mask[i];
+                if (lane < 0)
+                {
+                    continue;
+                }
+                uint32_t source = static_cast<uint32_t>(lane) < left_type->lanes
+                    ? slot_of(shuffle->left).offset + lane * lane_size
+                    : slot_of(shuffle->right).offset + (lane - left_type->lanes) * lane_size;
+                emit(Op::MovN, dst + static_cast<uint32_t>(i) * lane_size, source, 0, lane_size);
+            }
+            break;
+        }
+        case HLIR::Opcode::Reduce:
+        {
+            auto *reduce = static_cast<HLIR::ReduceInst *>(inst);
+            auto *vector = reduce->vector->type->as<VectorType>();
+            emit(Op::Reduce, dst, slot_of(reduce->vector).offset, 0, vector->lanes,
+                 static_cast<uint16_t>(static_cast<uint16_t>(reduce->kind) |
+                                       (static_cast<uint16_t>(kind_of(vector->element)) << 8)));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    void BytecodeGen::gen_call(HLIR::CallInst *inst)
+    {
+        Bytecode::CallSite site;
+        for (HLIR::Value *arg : inst->args)
+        {
+            site.args.push_back(slot_of(arg).offset);
+        }
+        uint32_t site_index = static_cast<uint32_t>(program->call_sites.size());
+        uint32_t dst = inst->result ? slot_of(inst->result).offset : 0;
+
+        auto native = native_index.find(inst->callee);
+        if (native != native_index.end())
+        {
+            const auto &function = program->natives[native->second];
+            bool aggregate = function.result == ValueKind::Aggregate ||
+                std::find(function.params.begin(), function.params.end(), ValueKind::Aggregate) != function.params.end();
+            if (aggregate)
+            {
+                throw std::runtime_error("Calls to " + function.name +
+                                         " pass a struct or array by value, which the interpreter can't do natively");
+            }
+            program->call_sites.push_back(std::move(site));
+            emit(Op::CallNative, dst, native->second, site_index);
+            return;
+        }
+
+        auto function = function_index.find(inst->callee);
+        if (function == function_index.end())
+        {
+            throw std::runtime_error("Function not declared: " + inst->callee->name());
+        }
+        program->call_sites.push_back(std::move(site));
+        emit(Op::Call, dst, function->second, site_index);
+    }
+
+    void BytecodeGen::gen_ret(HLIR::RetInst *inst)
+    {
+        if (inst->value)
+        {
+            emit(Op::Ret, 0, slot_of(inst->value).offset);
+        }
+        else
+        {
+            emit(Op::RetVoid);
+        }
+    }
+
+} // namespace Fern
@@ -0,0 +1,87 @@
+// bytecode_gen.hpp - HLIR to interpreter bytecode lowering
+#pragma once
+
+#include "bytecode.hpp"
+#include "hlir/hlir.hpp"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Fern
+{
+
+    /**
+     * @brief Lowers HLIR to register bytecode for the Interpreter
+     *
+     * Every HLIR value gets a fixed slot in its function's frame, so instructions
+     * name their operands by frame offset and no register allocation is needed.
+     * The process is:
+     * 1. Number the functions; externs and bodiless declarations become natives
+     * 2. Lay out each frame: constants, then parameters, then instruction results
+     * 3. Emit blocks in reverse post-order, dropping jumps to the next block;
+     *    phis become copies on the incoming edges
+     * 4. Patch jump targets once every block's position is known
+     */
+    class BytecodeGen
+    {
+    private:
+        struct Fixup
+        {
+            size_t index;         // instruction to patch
+            bool in_b;            // JumpIf/JumpIfNot keep their target in b, Jump in a
+            HLIR::BasicBlock *target;
+        };
+
+        Bytecode::Program *program = nullptr;
+        std::unordered_map<HLIR::Function *, uint32_t> function_index;
+        std::unordered_map<HLIR::Function *, uint32_t> native_index;
+        std::unordered_map<TypeSymbol *, std::vector<uint32_t>> field_offsets;
+
+        // Per function
+        Bytecode::Function *current = nullptr;
+        std::vector<Bytecode::Slot> slots; // by HLIR value id
+        std::vector<uint32_t> block_start; // by HLIR block id
+        std::vector<Fixup> fixups;
+        uint32_t frame_size = 0;
+
+        void declare_functions(HLIR::Module *hlir_module);
+        void generate_function(HLIR::Function *hlir_func);
+        void generate_block(HLIR::BasicBlock *block, HLIR::BasicBlock *next);
+        void generate_instruction(HLIR::Instruction *inst);
+
+        void gen_constant(HLIR::Instruction *inst);
+        void gen_alloc(HLIR::AllocInst *inst);
+        void gen_load(HLIR::LoadInst *inst);
+        void gen_store(HLIR::StoreInst *inst);
+        void gen_field_addr(HLIR::FieldAddrInst *inst);
+        void gen_element_addr(HLIR::ElementAddrInst *inst);
+        void gen_bounds_check(HLIR::BoundsCheckInst *inst);
+        void gen_binary(HLIR::BinaryInst *inst);
+        void gen_unary(HLIR::UnaryInst *inst);
+        void gen_cast(HLIR::CastInst *inst);
+        void gen_vector(HLIR::Instruction *inst);
+        void gen_call(HLIR::CallInst *inst);
+        void gen_ret(HLIR::RetInst *inst);
+        void gen_cond_br(HLIR::CondBrInst *inst, HLIR::BasicBlock *next);
+
+        // Phi copies for the edge from -> to, then a jump unless `to` comes next
+        void emit_edge(HLIR::BasicBlock *from, HLIR::BasicBlock *to, HLIR::BasicBlock *next);
+        void emit_jump(Bytecode::Op op, uint32_t condition, HLIR::BasicBlock *target);
+        void emit_copy(uint32_t dst, uint32_t src, uint32_t size);
+        void emit_store(const Bytecode::Slot &value, uint32_t address);
+        size_t emit(Bytecode::Op op, uint32_t dst = 0, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0,
+                    uint16_t aux = 0);
+
+        Bytecode::Slot allocate_slot(TypePtr type);
+        const Bytecode::Slot &slot_of(HLIR::Value *value);
+
+        const std::vector<uint32_t> &get_field_offsets(TypeSymbol *type_sym);
+
+    public:
+        std::unique_ptr<Bytecode::Program> lower(HLIR::Module *hlir_module);
+
+        static Bytecode::ValueKind kind_of(TypePtr type);
+        static uint32_t size_of(TypePtr type);
+    };
+
+} // namespace Fern
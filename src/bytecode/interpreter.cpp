@@ -0,0 +1,571 @@
+// interpreter.cpp - Threaded-dispatch interpreter for HLIR bytecode
+#include "interpreter.hpp"
+#include <llvm/Support/DynamicLibrary.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+#if defined(__GNUC__)
+#define FERN_THREADED_DISPATCH 1
+#else
+#define FERN_THREADED_DISPATCH 0
+#endif
+
+namespace Fern
+{
+    using namespace Bytecode;
+
+    static uint8_t *align_up(uint8_t *pointer, uintptr_t alignment)
+    {
+        auto address = reinterpret_cast<uintptr_t>(pointer);
+        return pointer + ((alignment - address % alignment) % alignment);
+    }
+
+    // ============================================================================
+    // Vector Lanes
+    // ============================================================================
+
+    // The scalar tables again, once per lane
+    using BinaryLanes = void (*)(uint8_t *dst, const uint8_t *pa, const uint8_t *pb, uint32_t lanes);
+    using UnaryLanes = void (*)(uint8_t *dst, const uint8_t *pa, uint32_t lanes);
+
+#define FERN_BINARY_LANES(name, T, R, expr)                                              \
+    static void lanes_##name(uint8_t *dst, const uint8_t *pa, const uint8_t *pb, uint32_t lanes) \
+    {                                                                                    \
+        for (uint32_t i = 0; i < lanes; i++)                                             \
+        {                                                                                \
+            T a = read<T>(pa + i * sizeof(T));                                           \
+            T b = read<T>(pb + i * sizeof(T));                                           \
+            write<R>(dst + i * sizeof(R), static_cast<R>(expr));                         \
+        }                                                                                \
+    }
+#define FERN_UNARY_LANES(name, T, R, expr)                                               \
+    static void lanes_##name(uint8_t *dst, const uint8_t *pa, uint32_t lanes)            \
+    {                                                                                    \
+        for (uint32_t i = 0; i < lanes; i++)                                             \
+        {                                                                                \
+            T a = read<T>(pa + i * sizeof(T));                                           \
+            write<R>(dst + i * sizeof(R), static_cast<R>(expr));                         \
+        }                                                                                \
+    }
+#define FERN_LANES_ENTRY(name, ...) &lanes_##name,
+
+    FERN_BYTECODE_BINARY_OPS(FERN_BINARY_LANES)
+    FERN_BYTECODE_UNARY_OPS(FERN_UNARY_LANES)
+
+    // Binary ops open the opcode list, so they index this table directly
+    static const BinaryLanes binary_lanes[] = {FERN_BYTECODE_BINARY_OPS(FERN_LANES_ENTRY)};
+    static const UnaryLanes unary_lanes[] = {FERN_BYTECODE_UNARY_OPS(FERN_LANES_ENTRY)};
+
+#undef FERN_BINARY_LANES
+#undef FERN_UNARY_LANES
+#undef FERN_LANES_ENTRY
+
+    template <typename T, bool = std::is_integral_v<T>>
+    struct Accumulator
+    {
+        using type = T;
+    };
+
+    template <typename T>
+    struct Accumulator<T, true>
+    {
+        using type = std::make_unsigned_t<T>;
+    };
+
+    template <typename T>
+    static void reduce_lanes(ReduceKind kind, const uint8_t *vector, uint32_t lanes, uint8_t *dst)
+    {
+        // Add and Mul wrap for integers, like LLVM's reductions
+        using Acc = typename Accumulator<T>::type;
+        Acc acc = kind == ReduceKind::Mul ? Acc(1) : Acc(0);
+        T best = read<T>(vector);
+        for (uint32_t i = 0; i < lanes; i++)
+        {
+            T lane = read<T>(vector + i * sizeof(T));
+            switch (kind)
+            {
+            case ReduceKind::Add:
+                acc = static_cast<Acc>(acc + static_cast<Acc>(lane));
+                break;
+            case ReduceKind::Mul:
+                acc = static_cast<Acc>(acc * static_cast<Acc>(lane));
+                break;
+            case ReduceKind::Min:
+                if constexpr (std::is_floating_point_v<T>)
+                    best = std::fmin(best, lane);
+                else
+                    best = std::min(best, lane);
+                break;
+            case ReduceKind::Max:
+                if constexpr (std::is_floating_point_v<T>)
+                    best = std::fmax(best, lane);
+                else
+                    best = std::max(best, lane);
+                break;
+            }
+        }
+        if (kind == ReduceKind::Add || kind == ReduceKind::Mul)
+            write<T>(dst, static_cast<T>(acc));
+        else
+            write<T>(dst, best);
+    }
+
+    static void reduce(uint16_t aux, const uint8_t *vector, uint32_t lanes, uint8_t *dst)
+    {
+        auto kind = static_cast<ReduceKind>(aux & 0xff);
+        switch (static_cast<ValueKind>(aux >> 8))
+        {
+        case ValueKind::I8:
+            return reduce_lanes<int8_t>(kind, vector, lanes, dst);
+        case ValueKind::Bool:
+        case ValueKind::U8:
+            return reduce_lanes<uint8_t>(kind, vector, lanes, dst);
+        case ValueKind::I16:
+            return reduce_lanes<int16_t>(kind, vector, lanes, dst);
+        case ValueKind::U16:
+            return reduce_lanes<uint16_t>(kind, vector, lanes, dst);
+        case ValueKind::I32:
+            return reduce_lanes<int32_t>(kind, vector, lanes, dst);
+        case ValueKind::U32:
+            return reduce_lanes<uint32_t>(kind, vector, lanes, dst);
+        case ValueKind::I64:
+            return reduce_lanes<int64_t>(kind, vector, lanes, dst);
+        case ValueKind::U64:
+            return reduce_lanes<uint64_t>(kind, vector, lanes, dst);
+        case ValueKind::F32:
+            return reduce_lanes<float>(kind, vector, lanes, dst);
+        case ValueKind::F64:
+            return reduce_lanes<double>(kind, vector, lanes, dst);
+        default:
+            throw std::runtime_error("Reduction over a non-numeric vector");
+        }
+    }
+
+    // ============================================================================
+    // Setup and Entry
+    // ============================================================================
+
+    Interpreter::Interpreter(const Program &program, size_t stack_size)
+        : program(program), stack(new uint8_t[stack_size])
+    {
+        stack_end = stack.get() + stack_size;
+        sp = stack.get();
+
+        // The same process-wide lookup the JIT's generator does for extern fns
+        llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+        for (const auto &native : program.natives)
+        {
+            natives.push_back(llvm::sys::DynamicLibrary::SearchForAddressOfSymbol(native.name));
+        }
+    }
+
+    InterpreterValue Interpreter::invoke(const std::string &function_name, const std::vector<InterpreterValue> &args)
+    {
+        const Function *function = program.find_function(function_name);
+        if (!function)
+        {
+            throw std::runtime_error("Function not found: " + function_name);
+        }
+
+        uint8_t *frame = align_up(stack.get(), 16);
+        if (frame + function->frame_size > stack_end)
+        {
+            throw std::runtime_error("Interpreter stack overflow in " + function->name);
+        }
+
+        size_t count = std::min(args.size(), function->params.size());
+        for (size_t i = 0; i < count; i++)
+        {
+            const Slot &param = function->params[i];
+            if (param.kind == ValueKind::Aggregate)
+            {
+                throw std::runtime_error("Cannot pass a struct or array to " + function_name + " from the host");
+            }
+            convert(args[i].kind, args[i].bytes, param.kind, frame + param.offset);
+        }
+
+        const uint8_t *result = execute(*function, frame);
+
+        InterpreterValue value;
+        value.kind = function->result.kind;
+        if (value.kind == ValueKind::Aggregate)
+        {
+            throw std::runtime_error("Cannot return a struct or array from " + function_name + " to the host");
+        }
+        std::memcpy(value.bytes, result, std::min<size_t>(function->result.size, sizeof(value.bytes)));
+        return value;
+    }
+
+    // ============================================================================
+    // Native Calls
+    // ============================================================================
+
+    void Interpreter::call_native(uint32_t index, const CallSite &site, uint8_t *frame, uint8_t *result)
+    {
+        const NativeFunction &native = program.natives[index];
+        void *address = natives[index];
+        if (!address)
+        {
+            throw std::runtime_error("Unresolved extern function: " + native.name);
+        }
+
+        // f32 travels in the low half of a double register, as the C ABI expects
+        auto float_bits = [&](ValueKind kind, const uint8_t *value)
+        {
+            uint64_t bits = kind == ValueKind::F32 ? read<uint32_t>(value) : read<uint64_t>(value);
+            double as_double;
+            std::memcpy(&as_double, &bits, sizeof(double));
+            return as_double;
+        };
+
+        size_t count = std::min(site.args.size(), native.params.size());
+        bool float_result = is_float_kind(native.result);
+        uint64_t int_result = 0;
+        double float_result_value = 0.0;
+
+#if defined(_WIN64)
+        // Every argument goes in one positional slot. Through a variadic call, doubles are
+        // copied to both the integer and the vector register, so the callee finds each
+        // argument where its real prototype expects it.
+        double args[8] = {};
+        if (count > 8)
+        {
+            throw std::runtime_error("Too many arguments for extern function " + native.name);
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            ValueKind kind = native.params[i];
+            const uint8_t *value = frame + site.args[i];
+            if (is_float_kind(kind))
+            {
+                args[i] = float_bits(kind, value);
+            }
+            else
+            {
+                uint64_t bits = read_as<uint64_t>(kind, value);
+                std::memcpy(&args[i], &bits, sizeof(double));
+            }
+        }
+        auto call = [&](auto fn)
+        {
+            return fn(args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7]);
+        };
+        if (float_result)
+            float_result_value = call(reinterpret_cast<double (*)(...)>(address));
+        else
+            int_result = call(reinterpret_cast<uint64_t (*)(...)>(address));
+#else
+        // System V and AAPCS64 assign integer and vector registers independently, so one
+        // signature with six of each covers every scalar prototype that fits in registers
+        uint64_t ints[6] = {};
+        double floats[8] = {};
+        size_t int_count = 0;
+        size_t float_count = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            ValueKind kind = native.params[i];
+            const uint8_t *value = frame + site.args[i];
+            if (is_float_kind(kind))
+            {
+                if (float_count == 8)
+                    throw std::runtime_error("Too many floating point arguments for extern function " + native.name);
+                floats[float_count++] = float_bits(kind, value);
+            }
+            else
+            {
+                if (int_count == 6)
+                    throw std::runtime_error("Too many integer arguments for extern function " + native.name);
+                ints[int_count++] = read_as<uint64_t>(kind, value);
+            }
+        }
+        auto call = [&](auto fn)
+        {
+            return fn(ints[0], ints[1], ints[2], ints[3], ints[4], ints[5], floats[0], floats[1], floats[2],
+                      floats[3], floats[4], floats[5], floats[6], floats[7]);
+        };
+        using IntTrampoline = uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, double, double,
+                                           double, double, double, double, double, double);
+        using FloatTrampoline = double (*)(uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, double, double,
+                                           double, double, double, double, double, double);
+        if (float_result)
+            float_result_value = call(reinterpret_cast<FloatTrampoline>(address));
+        else
+            int_result = call(reinterpret_cast<IntTrampoline>(address));
+#endif
+
+        if (float_result)
+        {
+            uint64_t bits;
+            std::memcpy(&bits, &float_result_value, sizeof(bits));
+            if (native.result == ValueKind::F32)
+                write<uint32_t>(result, static_cast<uint32_t>(bits));
+            else
+                write<uint64_t>(result, bits);
+        }
+        else if (native.result != ValueKind::Void)
+        {
+            std::memcpy(result, &int_result, kind_size(native.result));
+        }
+    }
+
+    // ============================================================================
+    // Dispatch Loop
+    // ============================================================================
+
+    const uint8_t *Interpreter::execute(const Function &function, uint8_t *frame)
+    {
+        uint8_t *frame_end = frame + function.frame_size;
+        if (frame_end > stack_end)
+        {
+            throw std::runtime_error("Interpreter stack overflow in " + function.name);
+        }
+        sp = frame_end;
+        std::memcpy(frame, function.constants.data(), function.constants.size());
+
+        const Instruction *code = function.code.data();
+        const Instruction *ip = code;
+
+#if FERN_THREADED_DISPATCH
+#define FERN_LABEL(name, ...) &&op_##name,
+        static const void *labels[] = {
+            FERN_BYTECODE_BINARY_OPS(FERN_LABEL)
+            FERN_BYTECODE_UNARY_OPS(FERN_LABEL)
+            FERN_BYTECODE_OTHER_OPS(FERN_LABEL)
+        };
+#undef FERN_LABEL
+#define CASE(name) op_##name:
+#define DISPATCH() goto *labels[static_cast<size_t>(ip->op)]
+        DISPATCH();
+#else
+#define CASE(name) case Op::name:
+#define DISPATCH() continue
+        for (;;)
+        {
+            switch (ip->op)
+            {
+#endif
+#define NEXT() { ++ip; DISPATCH(); }
+#define SLOT(field) (frame + ip->field)
+
+#define FERN_BINARY_HANDLER(name, T, R, expr)          \
+    CASE(name)                                         \
+    {                                                  \
+        T a = read<T>(SLOT(a));                        \
+        T b = read<T>(SLOT(b));                        \
+        write<R>(SLOT(dst), static_cast<R>(expr));     \
+        NEXT();                                        \
+    }
+#define FERN_UNARY_HANDLER(name, T, R, expr)           \
+    CASE(name)                                         \
+    {                                                  \
+        T a = read<T>(SLOT(a));                        \
+        write<R>(SLOT(dst), static_cast<R>(expr));     \
+        NEXT();                                        \
+    }
+
+        FERN_BYTECODE_BINARY_OPS(FERN_BINARY_HANDLER)
+        FERN_BYTECODE_UNARY_OPS(FERN_UNARY_HANDLER)
+
+#undef FERN_BINARY_HANDLER
+#undef FERN_UNARY_HANDLER
+
+        CASE(Mov)
+        {
+            std::memcpy(SLOT(dst), SLOT(a), 8);
+            NEXT();
+        }
+        CASE(MovN)
+        {
+            std::memcpy(SLOT(dst), SLOT(a), ip->c);
+            NEXT();
+        }
+
+#define FERN_LOAD_HANDLER(name, size)                                  \
+    CASE(name)                                                         \
+    {                                                                  \
+        std::memcpy(SLOT(dst), read<const uint8_t *>(SLOT(a)), size);  \
+        NEXT();                                                        \
+    }
+#define FERN_STORE_HANDLER(name, size)                                 \
+    CASE(name)                                                         \
+    {                                                                  \
+        std::memcpy(read<uint8_t *>(SLOT(b)), SLOT(a), size);          \
+        NEXT();                                                        \
+    }
+
+        FERN_LOAD_HANDLER(Load1, 1)
+        FERN_LOAD_HANDLER(Load2, 2)
+        FERN_LOAD_HANDLER(Load4, 4)
+        FERN_LOAD_HANDLER(Load8, 8)
+        FERN_LOAD_HANDLER(LoadN, ip->c)
+        FERN_STORE_HANDLER(Store1, 1)
+        FERN_STORE_HANDLER(Store2, 2)
+        FERN_STORE_HANDLER(Store4, 4)
+        FERN_STORE_HANDLER(Store8, 8)
+        FERN_STORE_HANDLER(StoreN, ip->c)
+
+#undef FERN_LOAD_HANDLER
+#undef FERN_STORE_HANDLER
+
+        CASE(StackAlloc)
+        {
+            uint8_t *memory = align_up(sp, ip->aux);
+            if (memory + ip->b > stack_end)
+            {
+                throw std::runtime_error("Interpreter stack overflow in " + function.name);
+            }
+            sp = memory + ip->b;
+            write<uint8_t *>(SLOT(dst), memory);
+            NEXT();
+        }
+        CASE(HeapAlloc)
+        {
+            write<void *>(SLOT(dst), std::malloc(ip->b));
+            NEXT();
+        }
+        CASE(AddOffset)
+        {
+            write<uint8_t *>(SLOT(dst), read<uint8_t *>(SLOT(a)) + ip->b);
+            NEXT();
+        }
+        CASE(ElementAddr32)
+        {
+            write<uint8_t *>(SLOT(dst), read<uint8_t *>(SLOT(a)) + int64_t(read<int32_t>(SLOT(b))) * ip->c);
+            NEXT();
+        }
+        CASE(ElementAddr64)
+        {
+            write<uint8_t *>(SLOT(dst), read<uint8_t *>(SLOT(a)) + read<int64_t>(SLOT(b)) * ip->c);
+            NEXT();
+        }
+        CASE(DynElementAddr32)
+        {
+            uint8_t *data = read<uint8_t *>(read<uint8_t *>(SLOT(a)) + 8);
+            write<uint8_t *>(SLOT(dst), data + int64_t(read<int32_t>(SLOT(b))) * ip->c);
+            NEXT();
+        }
+        CASE(DynElementAddr64)
+        {
+            uint8_t *data = read<uint8_t *>(read<uint8_t *>(SLOT(a)) + 8);
+            write<uint8_t *>(SLOT(dst), data + read<int64_t>(SLOT(b)) * ip->c);
+            NEXT();
+        }
+        CASE(BoundsCheck)
+        {
+            // Both widened to 64 bits, then one unsigned compare, as the JIT does
+            uint64_t index = read_as<uint64_t>(static_cast<ValueKind>(ip->aux & 0xff), SLOT(a));
+            uint64_t length = read_as<uint64_t>(static_cast<ValueKind>(ip->aux >> 8), SLOT(b));
+            if (index >= length)
+            {
+                throw std::runtime_error("Array index out of bounds in " + function.name);
+            }
+            NEXT();
+        }
+        CASE(Cast)
+        {
+            convert(static_cast<ValueKind>(ip->aux & 0xff), SLOT(a), static_cast<ValueKind>(ip->aux >> 8), SLOT(dst));
+            NEXT();
+        }
+        CASE(VectorBinary)
+        {
+            binary_lanes[ip->aux](SLOT(dst), SLOT(a), SLOT(b), ip->c);
+            NEXT();
+        }
+        CASE(VectorUnary)
+        {
+            unary_lanes[ip->aux - static_cast<uint16_t>(Op::Neg8)](SLOT(dst), SLOT(a), ip->c);
+            NEXT();
+        }
+        CASE(VectorCast)
+        {
+            auto from = static_cast<ValueKind>(ip->aux & 0xff);
+            auto to = static_cast<ValueKind>(ip->aux >> 8);
+            for (uint32_t i = 0; i < ip->c; i++)
+            {
+                convert(from, SLOT(a) + i * kind_size(from), to, SLOT(dst) + i * kind_size(to));
+            }
+            NEXT();
+        }
+        CASE(ExtractLane)
+        {
+            uint64_t lane = read_as<uint64_t>(static_cast<ValueKind>(ip->aux), SLOT(b));
+            std::memcpy(SLOT(dst), SLOT(a) + lane * ip->c, ip->c);
+            NEXT();
+        }
+        CASE(InsertLane)
+        {
+            uint64_t lane = read_as<uint64_t>(static_cast<ValueKind>(ip->aux), SLOT(b));
+            std::memcpy(SLOT(dst) + lane * ip->c, SLOT(a), ip->c);
+            NEXT();
+        }
+        CASE(Reduce)
+        {
+            reduce(ip->aux, SLOT(a), ip->c, SLOT(dst));
+            NEXT();
+        }
+        CASE(Call)
+        {
+            const Function &callee = program.functions[ip->a];
+            const CallSite &site = program.call_sites[ip->b];
+            uint8_t *caller_sp = sp;
+            uint8_t *callee_frame = align_up(sp, 16);
+            if (callee_frame + callee.frame_size > stack_end)
+            {
+                throw std::runtime_error("Interpreter stack overflow in " + callee.name);
+            }
+
+            size_t count = std::min(site.args.size(), callee.params.size());
+            for (size_t i = 0; i < count; i++)
+            {
+                std::memcpy(callee_frame + callee.params[i].offset, frame + site.args[i], callee.params[i].size);
+            }
+            const uint8_t *result = execute(callee, callee_frame);
+            std::memcpy(SLOT(dst), result, callee.result.size);
+            sp = caller_sp;
+            NEXT();
+        }
+        CASE(CallNative)
+        {
+            call_native(ip->a, program.call_sites[ip->b], frame, SLOT(dst));
+            NEXT();
+        }
+        CASE(Ret)
+        {
+            return SLOT(a);
+        }
+        CASE(RetVoid)
+        {
+            return frame;
+        }
+        CASE(Jump)
+        {
+            ip = code + ip->a;
+            DISPATCH();
+        }
+        CASE(JumpIf)
+        {
+            ip = *SLOT(a) ? code + ip->b : ip + 1;
+            DISPATCH();
+        }
+        CASE(JumpIfNot)
+        {
+            ip = *SLOT(a) ? ip + 1 : code + ip->b;
+            DISPATCH();
+        }
+
+#if !FERN_THREADED_DISPATCH
+            default:
+                throw std::runtime_error("Invalid bytecode op in " + function.name);
+            }
+        }
+#endif
+
+#undef CASE
+#undef DISPATCH
+#undef NEXT
+#undef SLOT
+    }
+
+} // namespace Fern
@@ -0,0 +1,90 @@
+// interpreter.hpp - Threaded-dispatch interpreter for HLIR bytecode
+#pragma once
+
+#include "bytecode.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Fern
+{
+
+    // A scalar passed to or returned from Interpreter::invoke, tagged with its kind
+    struct InterpreterValue
+    {
+        Bytecode::ValueKind kind = Bytecode::ValueKind::Void;
+        uint8_t bytes[8] = {};
+
+        template <typename T>
+        static InterpreterValue from(T value)
+        {
+            static_assert(std::is_arithmetic_v<T> || std::is_pointer_v<T>, "Only scalars cross into the interpreter");
+            InterpreterValue result;
+            if constexpr (std::is_pointer_v<T>)
+                result.kind = Bytecode::ValueKind::Ptr;
+            else if constexpr (std::is_same_v<T, bool>)
+                result.kind = Bytecode::ValueKind::Bool;
+            else if constexpr (std::is_floating_point_v<T>)
+                result.kind = sizeof(T) == 4 ? Bytecode::ValueKind::F32 : Bytecode::ValueKind::F64;
+            else if constexpr (std::is_signed_v<T>)
+                result.kind = sizeof(T) == 1 ? Bytecode::ValueKind::I8 : sizeof(T) == 2 ? Bytecode::ValueKind::I16
+                            : sizeof(T) == 4 ? Bytecode::ValueKind::I32 : Bytecode::ValueKind::I64;
+            else
+                result.kind = sizeof(T) == 1 ? Bytecode::ValueKind::U8 : sizeof(T) == 2 ? Bytecode::ValueKind::U16
+                            : sizeof(T) == 4 ? Bytecode::ValueKind::U32 : Bytecode::ValueKind::U64;
+            std::memcpy(result.bytes, &value, sizeof(T));
+            return result;
+        }
+
+        // Converted like a cast, so an f32 Main can be read as float or double
+        template <typename T>
+        T as() const
+        {
+            if constexpr (std::is_pointer_v<T>)
+                return reinterpret_cast<T>(Bytecode::read_as<uintptr_t>(kind, bytes));
+            else
+                return Bytecode::read_as<T>(kind, bytes);
+        }
+    };
+
+    /**
+     * @brief Runs a Bytecode::Program without generating machine code
+     *
+     * Frames live on a private stack. A call:
+     * 1. Places the callee's frame at the top of the stack, copies in its constant
+     *    image and the arguments
+     * 2. Dispatches instructions through a table of label addresses (computed goto)
+     *    where the compiler supports it, and through a switch otherwise
+     * 3. Returns the address of the result slot, which the caller copies out before
+     *    the stack grows again
+     * Extern functions are looked up in the host process once, when the interpreter
+     * is created, and called through a fixed-register trampoline.
+     */
+    class Interpreter
+    {
+    private:
+        const Bytecode::Program &program;
+        std::vector<void *> natives; // by native index; null when the symbol wasn't found
+
+        std::unique_ptr<uint8_t[]> stack;
+        uint8_t *stack_end = nullptr;
+        uint8_t *sp = nullptr;
+
+        const uint8_t *execute(const Bytecode::Function &function, uint8_t *frame);
+        void call_native(uint32_t index, const Bytecode::CallSite &site, uint8_t *frame, uint8_t *result);
+
+    public:
+        static constexpr size_t DEFAULT_STACK_SIZE = 16 * 1024 * 1024;
+
+        explicit Interpreter(const Bytecode::Program &program, size_t stack_size = DEFAULT_STACK_SIZE);
+
+        // Call a function by name. Throws std::runtime_error when it doesn't exist, when an
+        // extern it calls is missing, on a failed bounds check and on stack overflow.
+        InterpreterValue invoke(const std::string &function_name, const std::vector<InterpreterValue> &args = {});
+    };
+
+} // namespace Fern
@@ -1,9 +1,17 @@
 // codegen.cpp - HLIR to LLVM IR Lowering Implementation
 #include "codegen.hpp"
+#include "hlir/loop_analysis.hpp"
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/ProfileSummary.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
+#include <llvm/BinaryFormat/Dwarf.h>
 #include <stdexcept>
+#include <algorithm>
+#include <filesystem>
 #include <iostream>
 
 namespace Fern
@@ -20,14 +28,46 @@ namespace Fern
             throw std::runtime_error("Cannot lower null HLIR module");
         }
 
+        std::vector<HLIR::Function *> bodies;
+        for (const auto &hlir_func : hlir_module->functions)
+        {
+            bodies.push_back(hlir_func.get());
+        }
+        return lower(hlir_module, bodies);
+    }
+
+    std::unique_ptr<llvm::Module> HLIRCodeGen::lower(HLIR::Module *hlir_module,
+                                                     const std::vector<HLIR::Function *> &bodies)
+    {
+        if (!hlir_module)
+        {
+            throw std::runtime_error("Cannot lower null HLIR module");
+        }
+
         // Phase 1: Declare all types
         declare_types(hlir_module);
 
         // Phase 2: Declare all functions
-        declare_functions(hlir_module);
+        declare_functions(bodies);
 
         // Phase 3: Generate function bodies
-        generate_function_bodies(hlir_module);
+        if (debug_info)
+        {
+            init_debug_info(bodies);
+        }
+        generate_function_bodies(bodies);
+        if (!instrumented_functions.empty())
+        {
+            emit_profile_writer();
+        }
+        if (profile)
+        {
+            module->setProfileSummary(profile->summary(context), llvm::ProfileSummary::PSK_Instr);
+        }
+        if (di_builder)
+        {
+            di_builder->finalize();
+        }
 
         // Verify the generated module
         std::string error_msg;
@@ -161,6 +201,10 @@ namespace Fern
                 llvm_type = llvm::StructType::create(context, fields, "array");
             }
         }
+        else if (auto *vector_type = type->as<VectorType>())
+        {
+            llvm_type = llvm::FixedVectorType::get(get_or_create_type(vector_type->element), vector_type->lanes);
+        }
         else if (auto *named_type = type->as<NamedType>())
         {
             // Named types should already be in the map from declare_types
@@ -202,11 +246,14 @@ namespace Fern
     // Phase 2: Function Declaration
     // ============================================================================
 
-    void HLIRCodeGen::declare_functions(HLIR::Module *hlir_module)
+    void HLIRCodeGen::declare_functions(const std::vector<HLIR::Function *> &bodies)
     {
-        for (const auto &hlir_func : hlir_module->functions)
+        // The bodies first, so they keep their names. Callees defined elsewhere are declared
+        // as calls reach them, which keeps modules that hold a few functions of a large
+        // HLIR module (partitions, session snippets) from declaring all the others
+        for (HLIR::Function *hlir_func : bodies)
         {
-            declare_function(hlir_func.get());
+            declare_function(hlir_func);
         }
     }
 
@@ -278,13 +325,13 @@ namespace Fern
     // Phase 3: Function Body Generation
     // ============================================================================
 
-    void HLIRCodeGen::generate_function_bodies(HLIR::Module *hlir_module)
+    void HLIRCodeGen::generate_function_bodies(const std::vector<HLIR::Function *> &functions)
     {
-        for (const auto &hlir_func : hlir_module->functions)
+        for (HLIR::Function *hlir_func : functions)
         {
             if (!hlir_func->is_external && hlir_func->entry)
             {
-                generate_function_body(hlir_func.get());
+                generate_function_body(hlir_func);
             }
         }
     }
@@ -295,9 +342,16 @@ namespace Fern
         current_hlir_function = hlir_func;
         current_llvm_function = function_map[hlir_func];
 
-        // Clear per-function state
-        value_map.clear();
-        block_map.clear();
+        // Per-function state, indexed by id; assign() reuses the last function's storage
+        values.assign(hlir_func->next_value_id, nullptr);
+        blocks.assign(hlir_func->next_block_id, nullptr);
+        exit_blocks.assign(hlir_func->next_block_id, nullptr);
+        bounds_fail_block = nullptr;
+
+        if (di_builder)
+        {
+            begin_function_debug_info(hlir_func);
+        }
 
         // Map function parameters to LLVM arguments
         size_t arg_idx = 0;
@@ -305,7 +359,7 @@ namespace Fern
         {
             if (arg_idx < hlir_func->params.size())
             {
-                value_map[hlir_func->params[arg_idx]] = &arg;
+                set_value(hlir_func->params[arg_idx], &arg);
             }
             arg_idx++;
         }
@@ -318,13 +372,31 @@ namespace Fern
                 : hlir_block->name;
             llvm::BasicBlock *llvm_block = llvm::BasicBlock::Create(
                 context, block_name, current_llvm_function);
-            block_map[hlir_block.get()] = llvm_block;
+            blocks[hlir_block->id] = llvm_block;
         }
 
-        // Generate code for each basic block
+        if (profile_counters)
+        {
+            emit_profile_prologue(hlir_func);
+        }
+        if (!profile_output.empty() || profile)
+        {
+            begin_function_profile(hlir_func);
+        }
+
+        // Generate code in reverse post-order so every value is emitted before the blocks it
+        // dominates use it (creation order breaks this for nested loops), then any unreachable
+        // leftovers so they still get terminated
+        for (auto *hlir_block : HLIR::compute_reverse_post_order(hlir_func))
+        {
+            generate_basic_block(hlir_block);
+        }
         for (const auto &hlir_block : hlir_func->blocks)
         {
-            generate_basic_block(hlir_block.get());
+            if (!exit_blocks[hlir_block->id])
+            {
+                generate_basic_block(hlir_block.get());
+            }
         }
 
         // Resolve pending phi nodes now that all values are generated
@@ -333,12 +405,25 @@ namespace Fern
             for (const auto &incoming : hlir_phi->incoming)
             {
                 llvm::Value *value = get_value(incoming.first);
-                llvm::BasicBlock *block = get_block(incoming.second);
+                llvm::BasicBlock *block = get_exit_block(incoming.second);
                 llvm_phi->addIncoming(value, block);
             }
         }
         pending_phis.clear();
 
+        annotate_loops(hlir_func);
+
+        counter_layout.reset();
+        block_counters = nullptr;
+        function_profile = nullptr;
+
+        if (di_subprogram)
+        {
+            di_builder->finalizeSubprogram(di_subprogram);
+            di_subprogram = nullptr;
+            builder->SetCurrentDebugLocation(llvm::DebugLoc());
+        }
+
         // Reset current function
         current_hlir_function = nullptr;
         current_llvm_function = nullptr;
@@ -349,11 +434,32 @@ namespace Fern
         llvm::BasicBlock *llvm_block = get_block(hlir_block);
         builder->SetInsertPoint(llvm_block);
 
+        // Loop headers count iterations right after their phis, as do all blocks when instrumenting
+        bool bump_counter = profile_counters && profiled_headers.count(hlir_block);
+        bool count_block = block_counters != nullptr;
+
         // Generate all instructions
         for (const auto &inst : hlir_block->instructions)
         {
-            generate_instruction(inst.get());
+            if (bump_counter && inst->op != HLIR::Opcode::Phi)
+            {
+                emit_counter_bump();
+                bump_counter = false;
+            }
+            if (count_block && inst->op != HLIR::Opcode::Phi)
+            {
+                emit_block_count(counter_layout->block_counter.at(hlir_block),
+                                 llvm::ConstantInt::get(llvm::Type::getInt64Ty(context), 1));
+                count_block = false;
+            }
+            // Instructions passes created without a line keep the one before them
+            if (di_subprogram && inst->debug_line > 0)
+            {
+                builder->SetCurrentDebugLocation(llvm::DILocation::get(context, inst->debug_line, 0, di_subprogram));
+            }
+            generate_instruction(inst);
         }
+        exit_blocks[hlir_block->id] = builder->GetInsertBlock();
     }
 
     // ============================================================================
@@ -391,6 +497,9 @@ namespace Fern
         case HLIR::Opcode::ElementAddr:
             gen_element_addr(static_cast<HLIR::ElementAddrInst *>(inst));
             break;
+        case HLIR::Opcode::BoundsCheck:
+            gen_bounds_check(static_cast<HLIR::BoundsCheckInst *>(inst));
+            break;
         case HLIR::Opcode::Add:
         case HLIR::Opcode::Sub:
         case HLIR::Opcode::Mul:
@@ -419,6 +528,24 @@ namespace Fern
         case HLIR::Opcode::Cast:
             gen_cast(static_cast<HLIR::CastInst *>(inst));
             break;
+        case HLIR::Opcode::Splat:
+            gen_splat(static_cast<HLIR::SplatInst *>(inst));
+            break;
+        case HLIR::Opcode::BuildVector:
+            gen_build_vector(static_cast<HLIR::BuildVectorInst *>(inst));
+            break;
+        case HLIR::Opcode::ExtractLane:
+            gen_extract_lane(static_cast<HLIR::ExtractLaneInst *>(inst));
+            break;
+        case HLIR::Opcode::InsertLane:
+            gen_insert_lane(static_cast<HLIR::InsertLaneInst *>(inst));
+            break;
+        case HLIR::Opcode::Shuffle:
+            gen_shuffle(static_cast<HLIR::ShuffleInst *>(inst));
+            break;
+        case HLIR::Opcode::Reduce:
+            gen_reduce(static_cast<HLIR::ReduceInst *>(inst));
+            break;
         case HLIR::Opcode::Call:
             gen_call(static_cast<HLIR::CallInst *>(inst));
             break;
@@ -455,21 +582,21 @@ namespace Fern
         }
 
         llvm::Value *const_val = llvm::ConstantInt::get(type, inst->value, true);
-        value_map[inst->result] = const_val;
+        set_value(inst->result, const_val);
     }
 
     void HLIRCodeGen::gen_const_float(HLIR::ConstFloatInst *inst)
     {
         llvm::Type *type = get_or_create_type(inst->result->type);
         llvm::Value *const_val = llvm::ConstantFP::get(type, inst->value);
-        value_map[inst->result] = const_val;
+        set_value(inst->result, const_val);
     }
 
     void HLIRCodeGen::gen_const_bool(HLIR::ConstBoolInst *inst)
     {
         llvm::Value *const_val = llvm::ConstantInt::get(
             llvm::Type::getInt1Ty(context), inst->value ? 1 : 0);
-        value_map[inst->result] = const_val;
+        set_value(inst->result, const_val);
     }
 
     void HLIRCodeGen::gen_const_string(HLIR::ConstStringInst *inst)
@@ -495,7 +622,7 @@ namespace Fern
             indices,
             "str");
 
-        value_map[inst->result] = str_ptr;
+        set_value(inst->result, str_ptr);
     }
 
     // ============================================================================
@@ -506,11 +633,40 @@ namespace Fern
     {
         llvm::Type *alloc_type = get_or_create_type(inst->alloc_type);
 
+        // A constant table is never written, so one read-only copy serves every call
+        if (!inst->initializer.empty())
+        {
+            std::vector<llvm::Constant *> elements;
+            for (auto *element : inst->initializer)
+            {
+                elements.push_back(llvm::cast<llvm::Constant>(get_value(element)));
+            }
+            auto *table = new llvm::GlobalVariable(
+                *module,
+                alloc_type,
+                true,
+                llvm::GlobalValue::PrivateLinkage,
+                llvm::ConstantArray::get(llvm::cast<llvm::ArrayType>(alloc_type), elements),
+                "table");
+            table->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+            table->setAlignment(llvm::Align(std::max<uint64_t>(16, std::max(1, inst->alloc_type->get_alignment()))));
+            set_value(inst->result, table);
+            return;
+        }
+
         llvm::Value *ptr;
         if (inst->on_stack)
         {
-            // Stack allocation using alloca
-            ptr = builder->CreateAlloca(alloc_type, nullptr, "alloc");
+            // Stack allocation using alloca. Arrays of 16 bytes or more get 16 byte
+            // alignment so vectorized loops over them can use aligned loads
+            auto *alloca = builder->CreateAlloca(alloc_type, nullptr, "alloc");
+            uint64_t alignment = std::max(1, inst->alloc_type->get_alignment());
+            if (inst->alloc_type->is<ArrayType>() && inst->alloc_type->get_size() >= 16)
+            {
+                alignment = std::max<uint64_t>(alignment, 16);
+            }
+            alloca->setAlignment(llvm::Align(alignment));
+            ptr = alloca;
         }
         else
         {
@@ -526,11 +682,19 @@ namespace Fern
                 false);
             llvm::FunctionCallee malloc_func = module->getOrInsertFunction("malloc", malloc_type);
 
+            // A fresh allocation can't alias anything that already exists
+            if (auto *malloc_decl = llvm::dyn_cast<llvm::Function>(malloc_func.getCallee()))
+            {
+                malloc_decl->addRetAttr(llvm::Attribute::NoAlias);
+            }
+
             // Call malloc - returns opaque pointer
-            ptr = builder->CreateCall(malloc_func, {size}, "heap_alloc");
+            auto *call = builder->CreateCall(malloc_func, {size}, "heap_alloc");
+            call->addRetAttr(llvm::Attribute::NoAlias);
+            ptr = call;
         }
 
-        value_map[inst->result] = ptr;
+        set_value(inst->result, ptr);
     }
 
     void HLIRCodeGen::gen_load(HLIR::LoadInst *inst)
@@ -553,15 +717,17 @@ namespace Fern
         }
 
         llvm::Type *load_type = get_or_create_type(inst->result->type);
-        llvm::Value *loaded = builder->CreateLoad(load_type, addr, "load");
-        value_map[inst->result] = loaded;
+        llvm::LoadInst *loaded = builder->CreateLoad(load_type, addr, "load");
+        attach_memory_info(loaded, inst->address, inst->result->type);
+        set_value(inst->result, loaded);
     }
 
     void HLIRCodeGen::gen_store(HLIR::StoreInst *inst)
     {
         llvm::Value *val = get_value(inst->value);
         llvm::Value *addr = get_value(inst->address);
-        builder->CreateStore(val, addr);
+        llvm::StoreInst *store = builder->CreateStore(val, addr);
+        attach_memory_info(store, inst->address, inst->value->type);
     }
 
     void HLIRCodeGen::gen_field_addr(HLIR::FieldAddrInst *inst)
@@ -585,7 +751,7 @@ namespace Fern
             inst->field_index,
             "field_addr");
 
-        value_map[inst->result] = field_ptr;
+        set_value(inst->result, field_ptr);
     }
 
     void HLIRCodeGen::gen_element_addr(HLIR::ElementAddrInst *inst)
@@ -617,7 +783,7 @@ namespace Fern
                 indices,
                 "elem_addr");
 
-            value_map[inst->result] = elem_ptr;
+            set_value(inst->result, elem_ptr);
         }
         // Check if this is a dynamic array (struct { i32, ptr })
         else if (array_llvm_type->isStructTy())
@@ -642,7 +808,7 @@ namespace Fern
                 index,
                 "elem_addr");
 
-            value_map[inst->result] = elem_ptr;
+            set_value(inst->result, elem_ptr);
         }
         else
         {
@@ -653,10 +819,41 @@ namespace Fern
                 index,
                 "elem_addr");
 
-            value_map[inst->result] = elem_ptr;
+            set_value(inst->result, elem_ptr);
         }
     }
 
+    void HLIRCodeGen::gen_bounds_check(HLIR::BoundsCheckInst *inst)
+    {
+        // Widen both sides so one unsigned compare covers index < 0 and index >= length
+        llvm::Type *i64_type = llvm::Type::getInt64Ty(context);
+        llvm::Value *index = get_value(inst->index);
+        llvm::Value *length = get_value(inst->length);
+        index = is_unsigned_int(inst->index->type)
+            ? builder->CreateZExtOrTrunc(index, i64_type)
+            : builder->CreateSExtOrTrunc(index, i64_type);
+        length = is_unsigned_int(inst->length->type)
+            ? builder->CreateZExtOrTrunc(length, i64_type)
+            : builder->CreateSExtOrTrunc(length, i64_type);
+        llvm::Value *in_bounds = builder->CreateICmpULT(index, length, "in_bounds");
+
+        if (!bounds_fail_block)
+        {
+            bounds_fail_block = llvm::BasicBlock::Create(context, "bounds.fail", current_llvm_function);
+            llvm::IRBuilder<> fail_builder(bounds_fail_block);
+            fail_builder.CreateCall(llvm::Intrinsic::getDeclaration(module.get(), llvm::Intrinsic::trap));
+            fail_builder.CreateUnreachable();
+        }
+
+        llvm::BasicBlock *ok_block = llvm::BasicBlock::Create(context, "bounds.ok", current_llvm_function);
+        llvm::MDBuilder md_builder(context);
+        builder->CreateCondBr(in_bounds, ok_block, bounds_fail_block,
+                              md_builder.createBranchWeights(1 << 20, 1));
+
+        // The rest of the HLIR block continues in ok_block
+        builder->SetInsertPoint(ok_block);
+    }
+
     // ============================================================================
     // Binary Instructions
     // ============================================================================
@@ -767,7 +964,7 @@ namespace Fern
             throw std::runtime_error("Unsupported binary operation");
         }
 
-        value_map[inst->result] = result;
+        set_value(inst->result, result);
     }
 
     // ============================================================================
@@ -797,7 +994,7 @@ namespace Fern
             throw std::runtime_error("Unsupported unary operation");
         }
 
-        value_map[inst->result] = result;
+        set_value(inst->result, result);
     }
 
     // ============================================================================
@@ -843,7 +1040,92 @@ namespace Fern
             result = builder->CreateIntCast(value, target_type, src_is_signed, "cast");
         }
 
-        value_map[inst->result] = result;
+        set_value(inst->result, result);
+    }
+
+    // ============================================================================
+    // Vector Instructions
+    // ============================================================================
+
+    void HLIRCodeGen::gen_splat(HLIR::SplatInst *inst)
+    {
+        auto *vector_type = inst->result->type->as<VectorType>();
+        set_value(inst->result, builder->CreateVectorSplat(vector_type->lanes, get_value(inst->scalar), "splat"));
+    }
+
+    void HLIRCodeGen::gen_build_vector(HLIR::BuildVectorInst *inst)
+    {
+        llvm::Value *result = llvm::PoisonValue::get(get_or_create_type(inst->result->type));
+        for (size_t i = 0; i < inst->elements.size(); ++i)
+        {
+            result = builder->CreateInsertElement(result, get_value(inst->elements[i]), builder->getInt32(i), "vec");
+        }
+        set_value(inst->result, result);
+    }
+
+    void HLIRCodeGen::gen_extract_lane(HLIR::ExtractLaneInst *inst)
+    {
+        set_value(inst->result, builder->CreateExtractElement(get_value(inst->vector), get_value(inst->lane), "lane"));
+    }
+
+    void HLIRCodeGen::gen_insert_lane(HLIR::InsertLaneInst *inst)
+    {
+        set_value(inst->result, builder->CreateInsertElement(get_value(inst->vector), get_value(inst->value),
+                                                               get_value(inst->lane), "vec"));
+    }
+
+    void HLIRCodeGen::gen_shuffle(HLIR::ShuffleInst *inst)
+    {
+        llvm::Value *left = get_value(inst->left);
+        llvm::Value *right = inst->right ? get_value(inst->right) : llvm::PoisonValue::get(left->getType());
+        set_value(inst->result, builder->CreateShuffleVector(left, right, inst->mask, "shuffle"));
+    }
+
+    void HLIRCodeGen::gen_reduce(HLIR::ReduceInst *inst)
+    {
+        llvm::Value *vector = get_value(inst->vector);
+        bool is_float_op = is_float(inst->vector->type);
+        llvm::Value *result = nullptr;
+
+        switch (inst->kind)
+        {
+        case HLIR::ReduceKind::Add:
+        case HLIR::ReduceKind::Mul:
+            if (is_float_op)
+            {
+                // Without reassoc LLVM has to add the lanes strictly in order
+                llvm::Value *start = llvm::ConstantFP::get(get_or_create_type(inst->result->type),
+                                                           inst->kind == HLIR::ReduceKind::Add ? 0.0 : 1.0);
+                auto *call = inst->kind == HLIR::ReduceKind::Add ? builder->CreateFAddReduce(start, vector)
+                                                                  : builder->CreateFMulReduce(start, vector);
+                llvm::FastMathFlags flags;
+                flags.setAllowReassoc();
+                call->setFastMathFlags(flags);
+                result = call;
+            }
+            else
+            {
+                result = inst->kind == HLIR::ReduceKind::Add ? builder->CreateAddReduce(vector)
+                                                             : builder->CreateMulReduce(vector);
+            }
+            break;
+        case HLIR::ReduceKind::Min:
+            if (is_float_op)
+                result = builder->CreateFPMinReduce(vector);
+            else
+                result = builder->CreateIntMinReduce(vector, is_signed_int(inst->vector->type));
+            break;
+        case HLIR::ReduceKind::Max:
+            if (is_float_op)
+                result = builder->CreateFPMaxReduce(vector);
+            else
+                result = builder->CreateIntMaxReduce(vector, is_signed_int(inst->vector->type));
+            break;
+        default:
+            throw std::runtime_error("Unsupported vector reduction");
+        }
+
+        set_value(inst->result, result);
     }
 
     // ============================================================================
@@ -852,7 +1134,7 @@ namespace Fern
 
     void HLIRCodeGen::gen_call(HLIR::CallInst *inst)
     {
-        llvm::Function *callee = function_map[inst->callee];
+        llvm::Function *callee = declare_function(inst->callee);
         if (!callee)
         {
             throw std::runtime_error("Function not declared: " + inst->callee->name());
@@ -872,7 +1154,7 @@ namespace Fern
         // Map result if not void
         if (inst->result)
         {
-            value_map[inst->result] = call_result;
+            set_value(inst->result, call_result);
         }
     }
 
@@ -904,7 +1186,29 @@ namespace Fern
         llvm::Value *cond = get_value(inst->condition);
         llvm::BasicBlock *true_block = get_block(inst->true_block);
         llvm::BasicBlock *false_block = get_block(inst->false_block);
-        builder->CreateCondBr(cond, true_block, false_block);
+
+        if (block_counters)
+        {
+            emit_block_count(counter_layout->edge_counter.at(inst->parent),
+                             builder->CreateZExt(cond, llvm::Type::getInt64Ty(context)));
+        }
+
+        llvm::MDNode *weights = nullptr;
+        if (function_profile)
+        {
+            const auto &counts = function_profile->counts;
+            uint64_t total = counts[counter_layout->block_counter.at(inst->parent)];
+            uint64_t taken = std::min(total, counts[counter_layout->edge_counter.at(inst->parent)]);
+            if (total > 0)
+            {
+                // Weights are 32-bit; scale both sides alike so the ratio survives
+                uint64_t scale = total / UINT32_MAX + 1;
+                llvm::MDBuilder md_builder(context);
+                weights = md_builder.createBranchWeights(static_cast<uint32_t>(taken / scale),
+                                                         static_cast<uint32_t>((total - taken) / scale));
+            }
+        }
+        builder->CreateCondBr(cond, true_block, false_block, weights);
     }
 
     void HLIRCodeGen::gen_phi(HLIR::PhiInst *inst)
@@ -913,7 +1217,7 @@ namespace Fern
         llvm::PHINode *phi = builder->CreatePHI(phi_type, inst->incoming.size(), "phi");
 
         // Register the phi node result immediately so it can be referenced
-        value_map[inst->result] = phi;
+        set_value(inst->result, phi);
 
         // Defer adding incoming values until all blocks are processed
         // This is necessary because incoming values might be defined in blocks
@@ -921,34 +1225,332 @@ namespace Fern
         pending_phis.push_back({phi, inst});
     }
 
+    // ============================================================================
+    // Memory and Loop Metadata
+    // ============================================================================
+
+    void HLIRCodeGen::init_tbaa_root()
+    {
+        if (tbaa_root)
+        {
+            return;
+        }
+
+        llvm::MDBuilder md(context);
+        tbaa_root = md.createTBAARoot("Fern TBAA");
+        tbaa_char = md.createTBAAScalarTypeNode("omnipotent char", tbaa_root);
+    }
+
+    llvm::MDNode *HLIRCodeGen::get_tbaa_scalar_node(TypePtr type)
+    {
+        if (!type)
+        {
+            return nullptr;
+        }
+
+        init_tbaa_root();
+
+        // Key on the machine representation so signed/unsigned variants alias each other
+        std::string key;
+        if (auto *prim = type->as<PrimitiveType>())
+        {
+            switch (prim->kind)
+            {
+            case PrimitiveKind::Bool:
+                key = "bool";
+                break;
+            case PrimitiveKind::Char:
+            case PrimitiveKind::I8:
+            case PrimitiveKind::U8:
+                return tbaa_char; // byte accesses may alias anything
+            case PrimitiveKind::I16:
+            case PrimitiveKind::U16:
+                key = "int16";
+                break;
+            case PrimitiveKind::I32:
+            case PrimitiveKind::U32:
+                key = "int32";
+                break;
+            case PrimitiveKind::I64:
+            case PrimitiveKind::U64:
+                key = "int64";
+                break;
+            case PrimitiveKind::F32:
+                key = "f32";
+                break;
+            case PrimitiveKind::F64:
+                key = "f64";
+                break;
+            default:
+                return nullptr;
+            }
+        }
+        else if (type->is<PointerType>())
+        {
+            key = "any pointer";
+        }
+        else
+        {
+            return nullptr; // aggregates are left untagged
+        }
+
+        auto it = tbaa_scalar_nodes.find(key);
+        if (it != tbaa_scalar_nodes.end())
+        {
+            return it->second;
+        }
+
+        llvm::MDBuilder md(context);
+        auto *node = md.createTBAAScalarTypeNode(key, tbaa_char);
+        tbaa_scalar_nodes[key] = node;
+        return node;
+    }
+
+    const std::vector<uint64_t> &HLIRCodeGen::get_field_offsets(TypeSymbol *type_sym)
+    {
+        auto it = field_offsets.find(type_sym);
+        if (it != field_offsets.end())
+        {
+            return it->second;
+        }
+
+        std::vector<uint64_t> offsets;
+        int offset = 0;
+        for (const auto &member : type_sym->member_order)
+        {
+            if (auto *var_sym = member->as<VariableSymbol>())
+            {
+                int alignment = var_sym->type ? std::max(1, var_sym->type->get_alignment()) : 1;
+                offset = (offset + alignment - 1) / alignment * alignment;
+                offsets.push_back(offset);
+                offset += var_sym->type ? var_sym->type->get_size() : 0;
+            }
+        }
+
+        return field_offsets[type_sym] = std::move(offsets);
+    }
+
+    llvm::MDNode *HLIRCodeGen::get_tbaa_struct_node(TypeSymbol *type_sym)
+    {
+        auto it = tbaa_struct_nodes.find(type_sym);
+        if (it != tbaa_struct_nodes.end())
+        {
+            return it->second;
+        }
+
+        // Guard against self-referencing types while the node is being built
+        tbaa_struct_nodes[type_sym] = nullptr;
+        init_tbaa_root();
+
+        const auto &offsets = get_field_offsets(type_sym);
+        std::vector<std::pair<llvm::MDNode *, uint64_t>> fields;
+        size_t field_idx = 0;
+        for (const auto &member : type_sym->member_order)
+        {
+            if (auto *var_sym = member->as<VariableSymbol>())
+            {
+                llvm::MDNode *field_node = get_tbaa_scalar_node(var_sym->type);
+                if (!field_node && var_sym->type)
+                {
+                    if (auto *named = var_sym->type->as<NamedType>())
+                    {
+                        field_node = named->symbol ? get_tbaa_struct_node(named->symbol) : nullptr;
+                    }
+                }
+                fields.push_back({field_node ? field_node : tbaa_char, offsets[field_idx++]});
+            }
+        }
+
+        llvm::MDBuilder md(context);
+        auto *node = md.createTBAAStructTypeNode(type_sym->get_qualified_name(), fields);
+        tbaa_struct_nodes[type_sym] = node;
+        return node;
+    }
+
+    llvm::MDNode *HLIRCodeGen::get_tbaa_access_tag(HLIR::Value *address, TypePtr access_type)
+    {
+        llvm::MDNode *access_node = get_tbaa_scalar_node(access_type);
+        if (!access_node)
+        {
+            return nullptr;
+        }
+
+        llvm::MDBuilder md(context);
+
+        // Direct field access: tag with the containing struct so distinct fields never alias
+        if (address->def && address->def->op == HLIR::Opcode::FieldAddr)
+        {
+            auto *field = static_cast<HLIR::FieldAddrInst *>(address->def);
+            TypePtr object_type = field->object->type;
+            if (auto *ptr_type = object_type->as<PointerType>())
+            {
+                object_type = ptr_type->pointee;
+            }
+
+            auto *named = object_type ? object_type->as<NamedType>() : nullptr;
+            if (named && named->symbol)
+            {
+                // Only when the access matches the declared field type
+                size_t field_idx = 0;
+                VariableSymbol *field_sym = nullptr;
+                for (const auto &member : named->symbol->member_order)
+                {
+                    if (auto *var_sym = member->as<VariableSymbol>())
+                    {
+                        if (field_idx++ == field->field_index)
+                        {
+                            field_sym = var_sym;
+                            break;
+                        }
+                    }
+                }
+
+                auto *struct_node = get_tbaa_struct_node(named->symbol);
+                if (struct_node && field_sym && get_tbaa_scalar_node(field_sym->type) == access_node)
+                {
+                    return md.createTBAAStructTagNode(
+                        struct_node, access_node, get_field_offsets(named->symbol)[field->field_index]);
+                }
+            }
+        }
+
+        return md.createTBAAStructTagNode(access_node, access_node, 0);
+    }
+
+    void HLIRCodeGen::attach_memory_info(llvm::Instruction *inst, HLIR::Value *address, TypePtr access_type)
+    {
+        if (!access_type)
+        {
+            return;
+        }
+
+        auto alignment = llvm::Align(std::max(1, access_type->get_alignment()));
+        if (auto *load = llvm::dyn_cast<llvm::LoadInst>(inst))
+        {
+            load->setAlignment(alignment);
+        }
+        else if (auto *store = llvm::dyn_cast<llvm::StoreInst>(inst))
+        {
+            store->setAlignment(alignment);
+        }
+
+        if (auto *tag = get_tbaa_access_tag(address, access_type))
+        {
+            inst->setMetadata(llvm::LLVMContext::MD_tbaa, tag);
+        }
+    }
+
+    void HLIRCodeGen::annotate_loops(HLIR::Function *hlir_func)
+    {
+        HLIR::LoopInfo loop_info(hlir_func);
+
+        for (const auto &loop : loop_info.all_loops())
+        {
+            // Ask for vectorization on innermost loops that write array elements. Reductions and
+            // loops with calls are left to the cost model so they don't produce forced-hint warnings
+            if (!loop->children.empty())
+            {
+                continue;
+            }
+
+            bool writes_array = false;
+            bool has_calls = false;
+            bool has_bounds_checks = false;
+            for (auto *block : loop->blocks)
+            {
+                for (const auto &inst : block->instructions)
+                {
+                    if (inst->op == HLIR::Opcode::Call)
+                    {
+                        has_calls = true;
+                    }
+                    else if (inst->op == HLIR::Opcode::BoundsCheck)
+                    {
+                        has_bounds_checks = true;
+                    }
+                    else if (inst->op == HLIR::Opcode::Store)
+                    {
+                        auto *address = static_cast<HLIR::StoreInst *>(inst)->address;
+                        if (address->def && (address->def->op == HLIR::Opcode::ElementAddr ||
+                                             address->def->op == HLIR::Opcode::Phi))
+                        {
+                            writes_array = true;
+                        }
+                    }
+                }
+            }
+            // A check left in the body is an early exit the vectorizer can't handle
+            if (!writes_array || has_calls || has_bounds_checks)
+            {
+                continue;
+            }
+
+            llvm::Metadata *vectorize_ops[] = {
+                llvm::MDString::get(context, "llvm.loop.vectorize.enable"),
+                llvm::ConstantAsMetadata::get(llvm::ConstantInt::getTrue(context))};
+            llvm::Metadata *loop_ops[] = {nullptr, llvm::MDNode::get(context, vectorize_ops)};
+
+            // Loop IDs are distinct and refer to themselves
+            llvm::MDNode *loop_id = llvm::MDNode::getDistinct(context, loop_ops);
+            loop_id->replaceOperandWith(0, loop_id);
+
+            // Attach to every back edge
+            for (auto *block : loop->blocks)
+            {
+                bool is_back_edge = std::find(block->successors.begin(), block->successors.end(),
+                                              loop->header) != block->successors.end();
+                if (!is_back_edge)
+                {
+                    continue;
+                }
+                if (auto *terminator = get_exit_block(block)->getTerminator())
+                {
+                    terminator->setMetadata(llvm::LLVMContext::MD_loop, loop_id);
+                }
+            }
+        }
+    }
+
     // ============================================================================
     // Helper Functions
     // ============================================================================
 
     llvm::Value *HLIRCodeGen::get_value(HLIR::Value *hlir_value)
     {
-        auto it = value_map.find(hlir_value);
-        if (it == value_map.end())
+        if (hlir_value->id >= values.size() || !values[hlir_value->id])
         {
             throw std::runtime_error("HLIR value not found: %" +
                 std::to_string(hlir_value->id));
         }
-        return it->second;
+        return values[hlir_value->id];
     }
 
     llvm::BasicBlock *HLIRCodeGen::get_block(HLIR::BasicBlock *hlir_block)
     {
-        auto it = block_map.find(hlir_block);
-        if (it == block_map.end())
+        if (hlir_block->id >= blocks.size() || !blocks[hlir_block->id])
         {
             throw std::runtime_error("HLIR block not found: bb" +
                 std::to_string(hlir_block->id));
         }
-        return it->second;
+        return blocks[hlir_block->id];
+    }
+
+    llvm::BasicBlock *HLIRCodeGen::get_exit_block(HLIR::BasicBlock *hlir_block)
+    {
+        if (hlir_block->id >= exit_blocks.size() || !exit_blocks[hlir_block->id])
+        {
+            throw std::runtime_error("HLIR block not generated: bb" +
+                std::to_string(hlir_block->id));
+        }
+        return exit_blocks[hlir_block->id];
     }
 
     bool HLIRCodeGen::is_signed_int(TypePtr type)
     {
+        if (auto *vector = type->as<VectorType>())
+        {
+            type = vector->element; // vector operations are classified by their lanes
+        }
         if (auto *prim = type->as<PrimitiveType>())
         {
             return prim->kind == PrimitiveKind::I8 ||
@@ -961,6 +1563,10 @@ namespace Fern
 
     bool HLIRCodeGen::is_unsigned_int(TypePtr type)
     {
+        if (auto *vector = type->as<VectorType>())
+        {
+            type = vector->element; // vector operations are classified by their lanes
+        }
         if (auto *prim = type->as<PrimitiveType>())
         {
             return prim->kind == PrimitiveKind::U8 ||
@@ -973,6 +1579,10 @@ namespace Fern
 
     bool HLIRCodeGen::is_float(TypePtr type)
     {
+        if (auto *vector = type->as<VectorType>())
+        {
+            type = vector->element; // vector operations are classified by their lanes
+        }
         if (auto *prim = type->as<PrimitiveType>())
         {
             return prim->kind == PrimitiveKind::F32 ||
@@ -981,4 +1591,236 @@ namespace Fern
         return false;
     }
 
+    // ============================================================================
+    // Profile-Guided Optimization
+    // ============================================================================
+
+    void HLIRCodeGen::begin_function_profile(HLIR::Function *hlir_func)
+    {
+        counter_layout = std::make_unique<CounterLayout>(hlir_func);
+
+        if (!profile_output.empty() && counter_layout->size > 0)
+        {
+            auto *counters_type = llvm::ArrayType::get(llvm::Type::getInt64Ty(context), counter_layout->size);
+            block_counters = new llvm::GlobalVariable(
+                *module, counters_type, false, llvm::GlobalValue::ExternalLinkage,
+                llvm::ConstantAggregateZero::get(counters_type), "__fern_prof." + current_llvm_function->getName());
+            instrumented_functions.push_back({hlir_func->name(), block_counters});
+        }
+
+        if (profile)
+        {
+            function_profile = profile->find(hlir_func->name(), counter_layout->size);
+        }
+        if (!function_profile)
+        {
+            return;
+        }
+
+        const auto &counts = function_profile->counts;
+        current_llvm_function->setEntryCount(counts[0]);
+        if (counts[0] == 0)
+        {
+            current_llvm_function->addFnAttr(llvm::Attribute::Cold);
+        }
+
+        // Blocks that never ran go to the end, so the code that did run stays together
+        std::vector<llvm::BasicBlock *> cold_blocks;
+        for (const auto &hlir_block : hlir_func->blocks)
+        {
+            if (hlir_block.get() != hlir_func->entry && counts[counter_layout->block_counter.at(hlir_block.get())] == 0)
+            {
+                cold_blocks.push_back(get_block(hlir_block.get()));
+            }
+        }
+        for (llvm::BasicBlock *block : cold_blocks)
+        {
+            block->moveAfter(&current_llvm_function->back());
+        }
+    }
+
+    void HLIRCodeGen::emit_block_count(uint32_t index, llvm::Value *amount)
+    {
+        llvm::Type *i64_type = llvm::Type::getInt64Ty(context);
+        llvm::Value *slot = builder->CreateConstInBoundsGEP2_64(block_counters->getValueType(), block_counters, 0, index);
+        llvm::Value *count = builder->CreateLoad(i64_type, slot);
+        builder->CreateStore(builder->CreateAdd(count, amount), slot);
+    }
+
+    void HLIRCodeGen::emit_profile_writer()
+    {
+        llvm::Type *i32_type = llvm::Type::getInt32Ty(context);
+        llvm::Type *i64_type = llvm::Type::getInt64Ty(context);
+        llvm::Type *ptr_type = llvm::PointerType::getUnqual(context);
+
+        auto fopen = module->getOrInsertFunction("fopen", llvm::FunctionType::get(ptr_type, {ptr_type, ptr_type}, false));
+        auto fprintf = module->getOrInsertFunction("fprintf", llvm::FunctionType::get(i32_type, {ptr_type, ptr_type}, true));
+        auto fclose = module->getOrInsertFunction("fclose", llvm::FunctionType::get(i32_type, {ptr_type}, false));
+
+        auto *writer = llvm::Function::Create(llvm::FunctionType::get(llvm::Type::getVoidTy(context), false),
+                                              llvm::Function::ExternalLinkage,
+                                              profile_writer_name(module->getName().str()), module.get());
+        auto *entry = llvm::BasicBlock::Create(context, "entry", writer);
+        auto *write = llvm::BasicBlock::Create(context, "write", writer);
+        auto *done = llvm::BasicBlock::Create(context, "done", writer);
+
+        llvm::IRBuilder<> writer_builder(entry);
+        llvm::Value *file = writer_builder.CreateCall(
+            fopen, {writer_builder.CreateGlobalString(profile_output), writer_builder.CreateGlobalString("a")});
+        writer_builder.CreateCondBr(writer_builder.CreateIsNull(file), done, write);
+
+        writer_builder.SetInsertPoint(write);
+        writer_builder.CreateCall(fprintf, {file, writer_builder.CreateGlobalString("fern-profile 1\n")});
+        llvm::Value *record_format = writer_builder.CreateGlobalString("fn %s %llu\n");
+        llvm::Value *count_format = writer_builder.CreateGlobalString("%llu\n");
+
+        // One loop per function. Counters are cleared as they're written, so calling the
+        // writer again (say from a destructor after the JIT already did) appends only new counts.
+        for (const auto &[name, counters] : instrumented_functions)
+        {
+            uint64_t size = counters->getValueType()->getArrayNumElements();
+            writer_builder.CreateCall(fprintf, {file, record_format, writer_builder.CreateGlobalString(name),
+                                                llvm::ConstantInt::get(i64_type, size)});
+
+            llvm::BasicBlock *before = writer_builder.GetInsertBlock();
+            auto *loop = llvm::BasicBlock::Create(context, "counters", writer, done);
+            auto *next = llvm::BasicBlock::Create(context, "next", writer, done);
+            writer_builder.CreateBr(loop);
+
+            writer_builder.SetInsertPoint(loop);
+            llvm::PHINode *index = writer_builder.CreatePHI(i64_type, 2, "i");
+            index->addIncoming(llvm::ConstantInt::get(i64_type, 0), before);
+            llvm::Value *slot = writer_builder.CreateInBoundsGEP(
+                counters->getValueType(), counters, {llvm::ConstantInt::get(i64_type, 0), index});
+            writer_builder.CreateCall(fprintf, {file, count_format, writer_builder.CreateLoad(i64_type, slot)});
+            writer_builder.CreateStore(llvm::ConstantInt::get(i64_type, 0), slot);
+            llvm::Value *index_next = writer_builder.CreateAdd(index, llvm::ConstantInt::get(i64_type, 1));
+            index->addIncoming(index_next, loop);
+            writer_builder.CreateCondBr(writer_builder.CreateICmpULT(index_next, llvm::ConstantInt::get(i64_type, size)),
+                                        loop, next);
+            writer_builder.SetInsertPoint(next);
+        }
+        writer_builder.CreateCall(fclose, {file});
+        writer_builder.CreateBr(done);
+
+        writer_builder.SetInsertPoint(done);
+        writer_builder.CreateRetVoid();
+
+        // Native binaries write at exit; the JIT looks the writer up and calls it after Main
+        llvm::appendToGlobalDtors(*module, writer, 0);
+    }
+
+    // ============================================================================
+    // Line Tables
+    // ============================================================================
+
+    void HLIRCodeGen::init_debug_info(const std::vector<HLIR::Function *> &bodies)
+    {
+        di_builder = std::make_unique<llvm::DIBuilder>(*module);
+        di_files.clear();
+
+        // One compile unit per module, named after the first file with a body in it
+        std::string unit_file = module->getName().str();
+        for (HLIR::Function *hlir_func : bodies)
+        {
+            if (!hlir_func->source_file.empty())
+            {
+                unit_file = hlir_func->source_file;
+                break;
+            }
+        }
+        di_builder->createCompileUnit(llvm::dwarf::DW_LANG_C, get_di_file(unit_file), "Fern", false, "", 0, "",
+                                      llvm::DICompileUnit::LineTablesOnly);
+        di_function_type = di_builder->createSubroutineType(di_builder->getOrCreateTypeArray({}));
+
+        module->addModuleFlag(llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
+        module->addModuleFlag(llvm::Module::Warning, "Dwarf Version", 4);
+    }
+
+    llvm::DIFile *HLIRCodeGen::get_di_file(const std::string &path)
+    {
+        auto it = di_files.find(path);
+        if (it != di_files.end())
+        {
+            return it->second;
+        }
+
+        // Absolute, so perf annotate and gdb find the source from any working directory
+        std::error_code ec;
+        std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+        if (ec)
+        {
+            absolute = path;
+        }
+        llvm::DIFile *file = di_builder->createFile(absolute.filename().string(), absolute.parent_path().string());
+        di_files[path] = file;
+        return file;
+    }
+
+    void HLIRCodeGen::begin_function_debug_info(HLIR::Function *hlir_func)
+    {
+        llvm::DIFile *file = get_di_file(hlir_func->source_file.empty() ? module->getName().str()
+                                                                         : hlir_func->source_file);
+        unsigned line = hlir_func->source_line;
+        di_subprogram = di_builder->createFunction(
+            file, hlir_func->name(), current_llvm_function->getName(), file, line, di_function_type, line,
+            llvm::DINode::FlagPrototyped, llvm::DISubprogram::SPFlagDefinition);
+        current_llvm_function->setSubprogram(di_subprogram);
+
+        // The prologue and anything before the first numbered instruction belong to the declaration
+        builder->SetCurrentDebugLocation(llvm::DILocation::get(context, line, 0, di_subprogram));
+    }
+
+    // ============================================================================
+    // Tier-0 Profiling
+    // ============================================================================
+
+    void HLIRCodeGen::emit_profile_prologue(HLIR::Function *hlir_func)
+    {
+        llvm::Type *i64_type = llvm::Type::getInt64Ty(context);
+        llvm::Type *ptr_type = llvm::PointerType::getUnqual(context);
+
+        // Exported so the JIT can look it up and report it
+        profile_counter = new llvm::GlobalVariable(
+            *module, i64_type, false, llvm::GlobalValue::ExternalLinkage,
+            llvm::ConstantInt::get(i64_type, 0), "__fern_count." + current_llvm_function->getName());
+
+        // Provided by the JIT: the state starts with the threshold, the hook queues a recompile
+        auto *tier_state = module->getOrInsertGlobal("__fern_tier_state", i64_type);
+        auto tier_up = module->getOrInsertFunction(
+            "__fern_tier_up", llvm::FunctionType::get(llvm::Type::getVoidTy(context), {ptr_type, ptr_type}, false));
+
+        profiled_headers.clear();
+        HLIR::LoopInfo loop_info(hlir_func);
+        for (const auto &loop : loop_info.all_loops())
+        {
+            profiled_headers.insert(loop->header);
+        }
+
+        // The prologue becomes the entry block and falls through to the function's own entry
+        llvm::BasicBlock *entry = get_block(hlir_func->entry);
+        llvm::BasicBlock *prologue = llvm::BasicBlock::Create(
+            context, "profile", current_llvm_function, &current_llvm_function->front());
+        llvm::BasicBlock *tier_up_block = llvm::BasicBlock::Create(context, "profile.tier_up", current_llvm_function);
+
+        builder->SetInsertPoint(prologue);
+        emit_counter_bump();
+        llvm::Value *count = builder->CreateLoad(i64_type, profile_counter, "count");
+        llvm::Value *threshold = builder->CreateLoad(i64_type, tier_state, "threshold");
+        llvm::Value *hot = builder->CreateICmpUGE(count, threshold, "hot");
+        llvm::MDBuilder md_builder(context);
+        builder->CreateCondBr(hot, tier_up_block, entry, md_builder.createBranchWeights(1, 1 << 20));
+
+        builder->SetInsertPoint(tier_up_block);
+        builder->CreateCall(tier_up, {tier_state, profile_counter});
+        builder->CreateBr(entry);
+    }
+
+    void HLIRCodeGen::emit_counter_bump()
+    {
+        llvm::Type *i64_type = llvm::Type::getInt64Ty(context);
+        llvm::Value *count = builder->CreateLoad(i64_type, profile_counter);
+        builder->CreateStore(builder->CreateAdd(count, llvm::ConstantInt::get(i64_type, 1)), profile_counter);
+    }
+
 } // namespace Fern
\ No newline at end of file
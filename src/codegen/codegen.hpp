@@ -2,13 +2,17 @@
 #pragma once
 
 #include "hlir/hlir.hpp"
+#include "profile.hpp"
+#include <llvm/IR/DIBuilder.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/IR/Value.h>
 #include <llvm/IR/Verifier.h>
 #include <llvm/Support/raw_ostream.h>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <string>
 
@@ -41,11 +45,18 @@ namespace Fern
         // Function mapping: HLIR Function -> LLVM Function
         std::unordered_map<HLIR::Function *, llvm::Function *> function_map;
 
-        // Value mapping: HLIR Value -> LLVM Value (per function, cleared between functions)
-        std::unordered_map<HLIR::Value *, llvm::Value *> value_map;
+        // Value mapping: HLIR Value -> LLVM Value, by Value::id. Sized to the function's id
+        // range when its body starts; the storage is kept for the next function
+        std::vector<llvm::Value *> values;
 
-        // Block mapping: HLIR BasicBlock -> LLVM BasicBlock (per function)
-        std::unordered_map<HLIR::BasicBlock *, llvm::BasicBlock *> block_map;
+        // Block mapping: HLIR BasicBlock -> LLVM BasicBlock, by BasicBlock::id (per function)
+        std::vector<llvm::BasicBlock *> blocks;
+
+        // Block each HLIR block ends in; differs from `blocks` when a bounds check splits it
+        std::vector<llvm::BasicBlock *> exit_blocks;
+
+        // Shared trap block for failed bounds checks (per function, created on demand)
+        llvm::BasicBlock *bounds_fail_block = nullptr;
 
         // Current function being generated
         HLIR::Function *current_hlir_function = nullptr;
@@ -54,6 +65,35 @@ namespace Fern
         // Pending phi nodes (need to be resolved after all blocks are generated)
         std::vector<std::pair<llvm::PHINode*, HLIR::PhiInst*>> pending_phis;
 
+        // TBAA type tree: scalars hang off "omnipotent char", structs list their fields
+        llvm::MDNode *tbaa_root = nullptr;
+        llvm::MDNode *tbaa_char = nullptr;
+        std::unordered_map<std::string, llvm::MDNode *> tbaa_scalar_nodes;
+        std::unordered_map<TypeSymbol *, llvm::MDNode *> tbaa_struct_nodes;
+        std::unordered_map<TypeSymbol *, std::vector<uint64_t>> field_offsets;
+
+        // Tier-0 profiling: a counter per function, bumped on entry and at every loop header
+        bool profile_counters = false;
+        llvm::GlobalVariable *profile_counter = nullptr; // current function's counter
+        std::unordered_set<HLIR::BasicBlock *> profiled_headers;
+
+        // Line tables for profilers and debuggers: a subprogram per body, each instruction
+        // at its HLIR debug_line. No variables or types, just enough to map code to source.
+        bool debug_info = false;
+        std::unique_ptr<llvm::DIBuilder> di_builder;
+        llvm::DISubroutineType *di_function_type = nullptr;
+        std::unordered_map<std::string, llvm::DIFile *> di_files;
+        llvm::DISubprogram *di_subprogram = nullptr; // current function's
+
+        // Profile-guided optimization: counting runs write block and edge counts (laid out
+        // as CounterLayout describes), later builds read them back as weights
+        std::string profile_output;             // set when instrumenting
+        const ProfileData *profile = nullptr;   // set when optimizing with a profile
+        std::unique_ptr<CounterLayout> counter_layout;       // current function's
+        llvm::GlobalVariable *block_counters = nullptr;      // current function's, when instrumenting
+        const FunctionProfile *function_profile = nullptr;   // current function's, when it has one
+        std::vector<std::pair<std::string, llvm::GlobalVariable *>> instrumented_functions;
+
     public:
         HLIRCodeGen(llvm::LLVMContext &ctx, const std::string &module_name)
             : context(ctx)
@@ -65,6 +105,25 @@ namespace Fern
         // Main entry point: lower entire HLIR module to LLVM IR
         std::unique_ptr<llvm::Module> lower(HLIR::Module *hlir_module);
 
+        // Lower one partition: only the given functions get bodies, the functions they
+        // call are declared so calls resolve when the partitions are linked
+        std::unique_ptr<llvm::Module> lower(HLIR::Module *hlir_module,
+                                            const std::vector<HLIR::Function *> &bodies);
+
+        // Emit the counters and tier-up checks the tiered JIT reads (see tiered_jit.hpp)
+        void set_profile_counters(bool enabled) { profile_counters = enabled; }
+
+        // Emit DWARF line tables from Instruction::debug_line
+        void set_debug_info(bool enabled) { debug_info = enabled; }
+
+        // Count block executions and taken branches, and export a function that appends the
+        // counts to `filename` (see profile_writer_name). Native binaries also call it at exit.
+        void set_profile_generate(const std::string &filename) { profile_output = filename; }
+
+        // Turn the counts of an earlier instrumented run into branch weights, entry counts,
+        // cold attributes and block order, plus the summary LLVM's PGO-aware passes read
+        void set_profile_use(const ProfileData *data) { profile = data; }
+
         // Get the generated module (transfers ownership)
         std::unique_ptr<llvm::Module> release_module() { return std::move(module); }
 
@@ -75,12 +134,12 @@ namespace Fern
         llvm::StructType *declare_struct_type(HLIR::TypeDefinition *type_def);
 
         // === Phase 2: Function Declaration ===
-        void declare_functions(HLIR::Module *hlir_module);
+        void declare_functions(const std::vector<HLIR::Function *> &bodies);
         llvm::Function *declare_function(HLIR::Function *hlir_func);
         llvm::FunctionType *get_function_type(HLIR::Function *hlir_func);
 
         // === Phase 3: Function Body Generation ===
-        void generate_function_bodies(HLIR::Module *hlir_module);
+        void generate_function_bodies(const std::vector<HLIR::Function *> &functions);
         void generate_function_body(HLIR::Function *hlir_func);
 
         // Basic block generation
@@ -99,20 +158,52 @@ namespace Fern
         void gen_store(HLIR::StoreInst *inst);
         void gen_field_addr(HLIR::FieldAddrInst *inst);
         void gen_element_addr(HLIR::ElementAddrInst *inst);
+        void gen_bounds_check(HLIR::BoundsCheckInst *inst);
         void gen_binary(HLIR::BinaryInst *inst);
         void gen_unary(HLIR::UnaryInst *inst);
         void gen_cast(HLIR::CastInst *inst);
+        void gen_splat(HLIR::SplatInst *inst);
+        void gen_build_vector(HLIR::BuildVectorInst *inst);
+        void gen_extract_lane(HLIR::ExtractLaneInst *inst);
+        void gen_insert_lane(HLIR::InsertLaneInst *inst);
+        void gen_shuffle(HLIR::ShuffleInst *inst);
+        void gen_reduce(HLIR::ReduceInst *inst);
         void gen_call(HLIR::CallInst *inst);
         void gen_ret(HLIR::RetInst *inst);
         void gen_br(HLIR::BrInst *inst);
         void gen_cond_br(HLIR::CondBrInst *inst);
         void gen_phi(HLIR::PhiInst *inst);
 
+        // === Memory and loop metadata ===
+        void init_tbaa_root();
+        llvm::MDNode *get_tbaa_scalar_node(TypePtr type);
+        llvm::MDNode *get_tbaa_struct_node(TypeSymbol *type_sym);
+        llvm::MDNode *get_tbaa_access_tag(HLIR::Value *address, TypePtr access_type);
+        const std::vector<uint64_t> &get_field_offsets(TypeSymbol *type_sym);
+        void attach_memory_info(llvm::Instruction *inst, HLIR::Value *address, TypePtr access_type);
+        void annotate_loops(HLIR::Function *hlir_func);
+
+        // === Tier-0 profiling ===
+        void emit_profile_prologue(HLIR::Function *hlir_func);
+        void emit_counter_bump();
+
+        // === Line tables ===
+        void init_debug_info(const std::vector<HLIR::Function *> &bodies);
+        llvm::DIFile *get_di_file(const std::string &path);
+        void begin_function_debug_info(HLIR::Function *hlir_func);
+
+        // === Profile-guided optimization ===
+        void begin_function_profile(HLIR::Function *hlir_func);
+        void emit_block_count(uint32_t index, llvm::Value *amount);
+        void emit_profile_writer();
+
         // Helper: Get LLVM value for HLIR value
         llvm::Value *get_value(HLIR::Value *hlir_value);
+        void set_value(HLIR::Value *hlir_value, llvm::Value *value) { values[hlir_value->id] = value; }
 
         // Helper: Get LLVM basic block for HLIR basic block
         llvm::BasicBlock *get_block(HLIR::BasicBlock *hlir_block);
+        llvm::BasicBlock *get_exit_block(HLIR::BasicBlock *hlir_block);
 
         // Type helpers
         bool is_signed_int(TypePtr type);
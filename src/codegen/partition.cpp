@@ -0,0 +1,151 @@
+// partition.cpp - Call-graph clustering of an HLIR module for parallel code generation
+#include "partition.hpp"
+#include "hlir/loop_analysis.hpp"
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <unordered_map>
+
+namespace Fern
+{
+
+    std::vector<CodegenPartition> ModulePartitioner::run(HLIR::Module *module, unsigned count)
+    {
+        stats = Stats();
+        count = std::max(count, 1u);
+
+        // Only functions with bodies get lowered; externals are declared in every partition
+        std::vector<HLIR::Function *> functions;
+        std::unordered_map<HLIR::Function *, uint32_t> index_of;
+        for (const auto &func : module->functions)
+        {
+            if (!func->is_external && func->entry)
+            {
+                index_of[func.get()] = static_cast<uint32_t>(functions.size());
+                functions.push_back(func.get());
+            }
+        }
+        stats.functions = static_cast<uint32_t>(functions.size());
+
+        // Sizes and call edges. Edges are keyed (low, high) so both directions add up,
+        // and kept in a map so the merge order doesn't depend on pointer values.
+        std::vector<size_t> sizes(functions.size(), 0);
+        std::map<std::pair<uint32_t, uint32_t>, uint64_t> edge_weights;
+        for (uint32_t i = 0; i < functions.size(); i++)
+        {
+            HLIR::Function *func = functions[i];
+            std::vector<std::pair<HLIR::BasicBlock *, uint32_t>> call_sites;
+
+            for (const auto &block : func->blocks)
+            {
+                sizes[i] += block->instructions.size();
+                for (HLIR::Instruction *inst : block->instructions)
+                {
+                    if (inst->op != HLIR::Opcode::Call)
+                        continue;
+
+                    auto it = index_of.find(static_cast<HLIR::CallInst *>(inst)->callee);
+                    if (it != index_of.end() && it->second != i)
+                    {
+                        call_sites.push_back({block.get(), it->second});
+                    }
+                }
+            }
+            sizes[i] = std::max<size_t>(sizes[i], 1);
+
+            if (call_sites.empty())
+                continue;
+
+            // A call inside a loop is worth keeping inlinable far more than one that runs once
+            HLIR::LoopInfo loop_info(func);
+            for (auto [block, callee] : call_sites)
+            {
+                HLIR::Loop *loop = loop_info.loop_for(block);
+                uint32_t depth = loop ? loop->depth : 0;
+                uint64_t weight = uint64_t(1) << std::min<uint32_t>(depth * 3, 30);
+                edge_weights[{std::min(i, callee), std::max(i, callee)}] += weight;
+            }
+        }
+        stats.call_edges = static_cast<uint32_t>(edge_weights.size());
+
+        size_t total = std::accumulate(sizes.begin(), sizes.end(), size_t(0));
+        size_t largest = sizes.empty() ? 0 : *std::max_element(sizes.begin(), sizes.end());
+        size_t budget = std::max((total + count - 1) / count, largest);
+
+        // Union-find over functions, merging along the heaviest edges first
+        std::vector<uint32_t> parent(functions.size());
+        std::iota(parent.begin(), parent.end(), 0);
+        std::vector<size_t> cluster_size = sizes;
+
+        auto find = [&](uint32_t x)
+        {
+            while (parent[x] != x)
+            {
+                parent[x] = parent[parent[x]];
+                x = parent[x];
+            }
+            return x;
+        };
+
+        std::vector<std::pair<std::pair<uint32_t, uint32_t>, uint64_t>> edges(edge_weights.begin(), edge_weights.end());
+        std::stable_sort(edges.begin(), edges.end(),
+                         [](const auto &a, const auto &b) { return a.second > b.second; });
+
+        for (const auto &[edge, weight] : edges)
+        {
+            uint32_t a = find(edge.first);
+            uint32_t b = find(edge.second);
+            if (a == b || cluster_size[a] + cluster_size[b] > budget)
+                continue;
+
+            // Keep the lower index as the root so clusters list in module order
+            if (b < a)
+                std::swap(a, b);
+            parent[b] = a;
+            cluster_size[a] += cluster_size[b];
+        }
+
+        std::vector<uint32_t> roots;
+        for (uint32_t i = 0; i < functions.size(); i++)
+        {
+            if (find(i) == i)
+                roots.push_back(i);
+        }
+        stats.clusters = static_cast<uint32_t>(roots.size());
+
+        std::stable_sort(roots.begin(), roots.end(),
+                         [&](uint32_t a, uint32_t b) { return cluster_size[a] > cluster_size[b]; });
+
+        // Largest cluster first, always into the lightest partition
+        std::vector<CodegenPartition> partitions(std::clamp<size_t>(roots.size(), 1, count));
+        std::vector<uint32_t> partition_of(functions.size(), 0);
+        std::unordered_map<uint32_t, uint32_t> partition_of_root;
+        for (uint32_t root : roots)
+        {
+            uint32_t lightest = 0;
+            for (uint32_t p = 1; p < partitions.size(); p++)
+            {
+                if (partitions[p].instructions < partitions[lightest].instructions)
+                    lightest = p;
+            }
+            partitions[lightest].instructions += cluster_size[root];
+            partition_of_root[root] = lightest;
+        }
+
+        // Module order within each partition keeps the output stable
+        for (uint32_t i = 0; i < functions.size(); i++)
+        {
+            partition_of[i] = partition_of_root[find(i)];
+            partitions[partition_of[i]].functions.push_back(functions[i]);
+        }
+
+        for (const auto &[edge, weight] : edge_weights)
+        {
+            if (partition_of[edge.first] != partition_of[edge.second])
+                stats.cut_edges++;
+        }
+
+        return partitions;
+    }
+
+} // namespace Fern
@@ -0,0 +1,53 @@
+// partition.hpp - Call-graph clustering of an HLIR module for parallel code generation
+#pragma once
+
+#include "hlir/hlir.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Fern
+{
+
+    // Functions whose bodies are lowered into the same LLVM module
+    struct CodegenPartition
+    {
+        std::vector<HLIR::Function *> functions;
+        size_t instructions = 0;
+    };
+
+    /**
+     * @brief Splits the functions of an HLIR module into balanced partitions
+     *
+     * Each partition is lowered and optimized in its own LLVMContext, so the
+     * optimizer can only inline within a partition. The process is:
+     * 1. Weigh functions by instruction count and call edges by call sites
+     *    (a call inside a loop counts for more)
+     * 2. Merge clusters along the heaviest edges first, as long as the merged
+     *    cluster stays under the per-partition budget
+     * 3. Pack clusters largest first, each into the currently lightest partition
+     */
+    class ModulePartitioner
+    {
+    public:
+        struct Stats
+        {
+            uint32_t functions = 0;
+            uint32_t clusters = 0;
+            uint32_t call_edges = 0;
+            uint32_t cut_edges = 0; // call edges that cross partitions
+        };
+
+    private:
+        Stats stats;
+
+    public:
+        ModulePartitioner() = default;
+
+        // Between one and `count` partitions; external functions are declared, never placed
+        std::vector<CodegenPartition> run(HLIR::Module *module, unsigned count);
+
+        const Stats &get_stats() const { return stats; }
+    };
+
+} // namespace Fern
@@ -0,0 +1,124 @@
+// profile.cpp - Profile file reading and LLVM profile summaries
+#include "profile.hpp"
+#include <llvm/IR/ProfileSummary.h>
+#include <llvm/ProfileData/InstrProf.h>
+#include <llvm/ProfileData/ProfileCommon.h>
+#include <fstream>
+#include <sstream>
+
+namespace Fern
+{
+
+    CounterLayout::CounterLayout(HLIR::Function *func)
+    {
+        // The entry block first, so counts[0] is always the function's entry count
+        if (func->entry)
+        {
+            block_counter[func->entry] = size++;
+        }
+        for (const auto &block : func->blocks)
+        {
+            if (block.get() != func->entry)
+            {
+                block_counter[block.get()] = size++;
+            }
+        }
+        for (const auto &block : func->blocks)
+        {
+            auto *terminator = block->terminator();
+            if (terminator && terminator->op == HLIR::Opcode::CondBr)
+            {
+                edge_counter[block.get()] = size++;
+            }
+        }
+    }
+
+    bool ProfileData::load(const std::string &filename, std::string &error)
+    {
+        std::ifstream file(filename);
+        if (!file.is_open())
+        {
+            error = "Could not open profile: " + filename;
+            return false;
+        }
+
+        std::string magic;
+        int version = 0;
+        if (!(file >> magic >> version) || magic != "fern-profile" || version != 1)
+        {
+            error = filename + " is not a Fern profile";
+            return false;
+        }
+
+        // Records from separate runs follow each other, each with its own header
+        std::string token;
+        while (file >> token)
+        {
+            if (token == "fern-profile")
+            {
+                file >> version;
+                continue;
+            }
+
+            std::string name;
+            size_t count = 0;
+            if (token != "fn" || !(file >> name >> count))
+            {
+                error = "Malformed record in profile " + filename;
+                return false;
+            }
+            std::vector<uint64_t> counts(count);
+            for (auto &value : counts)
+            {
+                if (!(file >> value))
+                {
+                    error = "Truncated record for " + name + " in profile " + filename;
+                    return false;
+                }
+            }
+            add(name, counts);
+        }
+        return true;
+    }
+
+    const FunctionProfile *ProfileData::find(const std::string &function_name, uint32_t counters) const
+    {
+        auto it = functions.find(function_name);
+        if (it == functions.end() || it->second.counts.size() != counters)
+        {
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    void ProfileData::add(const std::string &function_name, const std::vector<uint64_t> &counts)
+    {
+        auto &profile = functions[function_name];
+        if (profile.counts.size() != counts.size())
+        {
+            // A different layout means a different program; the newest run wins
+            profile.counts = counts;
+            return;
+        }
+        for (size_t i = 0; i < counts.size(); i++)
+        {
+            profile.counts[i] += counts[i];
+        }
+    }
+
+    llvm::Metadata *ProfileData::summary(llvm::LLVMContext &context) const
+    {
+        llvm::InstrProfSummaryBuilder builder(std::vector<uint32_t>(
+            llvm::ProfileSummaryBuilder::DefaultCutoffs.begin(), llvm::ProfileSummaryBuilder::DefaultCutoffs.end()));
+        for (const auto &[name, profile] : functions)
+        {
+            if (!profile.counts.empty())
+            {
+                // The first counter is taken as the entry count, the rest as block counts
+                builder.addRecord(llvm::InstrProfRecord(profile.counts));
+            }
+        }
+        return builder.getSummary()->getMD(context);
+    }
+
+} // namespace Fern
@@ -0,0 +1,78 @@
+// profile.hpp - Block and edge counts for profile-guided optimization
+#pragma once
+
+#include "hlir/hlir.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace llvm
+{
+    class LLVMContext;
+    class Metadata;
+}
+
+namespace Fern
+{
+
+    /**
+     * @brief Where an instrumented function keeps its counters
+     *
+     * One counter per HLIR block in `blocks` order, counting executions, then one
+     * per conditional branch in the same block order, counting how often the
+     * true edge was taken. The false edge is the block's count minus that.
+     * A profile only applies to a function with the same layout, so it must be
+     * collected from the same source compiled with the same HLIR passes.
+     */
+    struct CounterLayout
+    {
+        std::unordered_map<HLIR::BasicBlock *, uint32_t> block_counter;
+        std::unordered_map<HLIR::BasicBlock *, uint32_t> edge_counter; // by the branch's block
+        uint32_t size = 0;
+
+        explicit CounterLayout(HLIR::Function *func);
+    };
+
+    // The function an instrumented module exports to append its counts to the profile
+    inline std::string profile_writer_name(const std::string &module_name)
+    {
+        return "__fern_profile_write." + module_name;
+    }
+
+    struct FunctionProfile
+    {
+        std::vector<uint64_t> counts;
+    };
+
+    /**
+     * @brief The counters of one or more instrumented runs, by function name
+     *
+     * Stored as text:
+     *   fern-profile 1
+     *   fn <qualified name> <counter count>
+     *   <count> ... one per line
+     * Instrumented programs append to the file, and load() sums every record for
+     * the same function, so several runs merge into one profile.
+     */
+    class ProfileData
+    {
+    private:
+        std::unordered_map<std::string, FunctionProfile> functions;
+
+    public:
+        bool load(const std::string &filename, std::string &error);
+
+        // Null when the function never ran or its counter layout changed
+        const FunctionProfile *find(const std::string &function_name, uint32_t counters) const;
+
+        void add(const std::string &function_name, const std::vector<uint64_t> &counts);
+        bool empty() const { return functions.empty(); }
+        size_t size() const { return functions.size(); }
+
+        // LLVM's profile summary over every count, which decides what its passes treat as hot or cold
+        llvm::Metadata *summary(llvm::LLVMContext &context) const;
+    };
+
+} // namespace Fern
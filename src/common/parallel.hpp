@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Fern
+{
+    // Run fn(i) for every i in [0, count) on up to `threads` threads (the caller is one
+    // of them). Work is handed out one index at a time, so uneven items still balance.
+    // The first exception thrown by any item is rethrown on the calling thread.
+    template <typename Fn>
+    void parallel_for(size_t count, unsigned threads, Fn &&fn)
+    {
+        size_t workers = std::min<size_t>(std::max(threads, 1u), count);
+        if (workers <= 1)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                fn(i);
+            }
+            return;
+        }
+
+        std::atomic<size_t> next{0};
+        std::exception_ptr failure;
+        std::mutex failure_mutex;
+
+        auto work = [&]()
+        {
+            for (size_t i = next++; i < count; i = next++)
+            {
+                try
+                {
+                    fn(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(failure_mutex);
+                    if (!failure)
+                        failure = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        pool.reserve(workers - 1);
+        for (size_t t = 1; t < workers; t++)
+        {
+            pool.emplace_back(work);
+        }
+        work();
+        for (auto &thread : pool)
+        {
+            thread.join();
+        }
+
+        if (failure)
+            std::rethrow_exception(failure);
+    }
+
+} // namespace Fern
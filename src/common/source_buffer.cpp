@@ -0,0 +1,120 @@
+#include "common/source_buffer.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Fern
+{
+
+    namespace
+    {
+        // Maps `path` read-only, returning null (and leaving `size` alone) for anything
+        // that can't be mapped: an empty file, a pipe, a platform without mappings
+        void *map_file(const std::string &path, size_t &size, bool &opened)
+        {
+#ifdef _WIN32
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                      FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            opened = file != INVALID_HANDLE_VALUE;
+            if (!opened)
+                return nullptr;
+
+            void *view = nullptr;
+            LARGE_INTEGER length;
+            if (GetFileSizeEx(file, &length) && length.QuadPart > 0)
+            {
+                HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (mapping)
+                {
+                    view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                    CloseHandle(mapping); // the view keeps the mapping alive
+                }
+                if (view)
+                    size = size_t(length.QuadPart);
+            }
+            CloseHandle(file);
+            return view;
+#else
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            opened = fd >= 0;
+            if (!opened)
+                return nullptr;
+
+            void *view = nullptr;
+            struct stat info;
+            if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+            {
+                view = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (view == MAP_FAILED)
+                {
+                    view = nullptr;
+                }
+                else
+                {
+                    size = size_t(info.st_size);
+                    // The lexer reads front to back, so let the kernel read ahead
+                    madvise(view, size, MADV_SEQUENTIAL);
+                }
+            }
+            ::close(fd); // the mapping holds its own reference to the file
+            return view;
+#endif
+        }
+    } // namespace
+
+    std::shared_ptr<const SourceBuffer> SourceBuffer::open(const std::string &path)
+    {
+        std::shared_ptr<SourceBuffer> buffer(new SourceBuffer());
+
+        bool opened = false;
+        buffer->mapping_ = map_file(path, buffer->size_, opened);
+        if (!opened)
+            throw std::runtime_error("Could not open file: " + path);
+        if (buffer->mapping_)
+        {
+            buffer->data_ = static_cast<const char *>(buffer->mapping_);
+            return buffer;
+        }
+
+        // Empty files and things that aren't regular files are read the ordinary way
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("Could not open file: " + path);
+        buffer->owned_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        buffer->data_ = buffer->owned_.data();
+        buffer->size_ = buffer->owned_.size();
+        return buffer;
+    }
+
+    std::shared_ptr<const SourceBuffer> SourceBuffer::from_string(std::string text)
+    {
+        std::shared_ptr<SourceBuffer> buffer(new SourceBuffer());
+        buffer->owned_ = std::move(text);
+        buffer->data_ = buffer->owned_.data();
+        buffer->size_ = buffer->owned_.size();
+        return buffer;
+    }
+
+    SourceBuffer::~SourceBuffer()
+    {
+        if (!mapping_)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(mapping_);
+#else
+        munmap(mapping_, size_);
+#endif
+    }
+
+} // namespace Fern
@@ -0,0 +1,49 @@
+// source_buffer.hpp - the immutable text of one source file, shared rather than copied
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Fern
+{
+
+    /**
+     * @brief The text of a source file, read-only once made
+     *
+     * A file opened from disk is mapped into memory, so loading it costs no copy and its
+     * pages are read in only as the lexer reaches them; text made in memory (a snippet,
+     * an LSP document) is owned as a string. Either way it's handed around as a
+     * shared_ptr, so copying a SourceFile or a compile state copies a pointer, and the
+     * text stays put for as long as anything that lexed it holds the buffer. SourceRange
+     * offsets index into text().
+     *
+     * A mapped file that's truncated while mapped faults on the next read, so this is for
+     * compiles that read their inputs once; the language server, which lives alongside an
+     * editor writing those files, keeps reading them into memory.
+     */
+    class SourceBuffer
+    {
+    public:
+        // Map the file at `path`; throws std::runtime_error if it can't be opened or read
+        static std::shared_ptr<const SourceBuffer> open(const std::string &path);
+        static std::shared_ptr<const SourceBuffer> from_string(std::string text);
+
+        ~SourceBuffer();
+        SourceBuffer(const SourceBuffer &) = delete;
+        SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+        std::string_view text() const { return {data_, size_}; }
+        size_t size() const { return size_; }
+        bool is_mapped() const { return mapping_ != nullptr; }
+
+    private:
+        SourceBuffer() = default;
+
+        const char *data_ = "";
+        size_t size_ = 0;
+        void *mapping_ = nullptr; // the mapped view, null when the text is owned
+        std::string owned_;
+    };
+
+} // namespace Fern
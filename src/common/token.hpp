@@ -5,6 +5,7 @@
 #include <vector>
 #include <cstdint>
 #include <array>
+#include <initializer_list>
 #include "source_location.hpp"
 
 namespace Fern
@@ -152,6 +153,30 @@ namespace Fern
         Dollar,       // $
     };
 
+    // A set of token kinds held as a bitmask, so testing a kind against all of them is one
+    // shift and mask rather than a loop. Converts from a braced list, so a call site reads
+    // the same as with an initializer_list: tokens.check_any({TokenKind::Comma, TokenKind::Semicolon})
+    class TokenKindSet
+    {
+    public:
+        constexpr TokenKindSet() = default;
+        constexpr TokenKindSet(std::initializer_list<TokenKind> kinds)
+        {
+            for (TokenKind kind : kinds)
+                insert(kind);
+        }
+
+        constexpr void insert(TokenKind kind) { bits[index(kind) / 64] |= uint64_t(1) << (index(kind) % 64); }
+        constexpr bool contains(TokenKind kind) const { return (bits[index(kind) / 64] >> (index(kind) % 64)) & 1; }
+
+    private:
+        static constexpr size_t index(TokenKind kind) { return static_cast<size_t>(kind); }
+
+        uint64_t bits[2] = {};
+    };
+    static_assert(static_cast<size_t>(magic_enum::enum_values<TokenKind>().back()) < 128,
+                  "TokenKindSet holds 128 kinds, and TokenStream packs kinds into bytes");
+
     enum class KeywordKind
     {
         Invalid = (int)TokenKind::Invalid,
@@ -698,7 +723,7 @@ namespace Fern
         Token(TokenKind kind, SourceRange location, std::string_view source)
             : kind(kind), location(location)
         {
-            if (location.end_offset() <= source.size())
+            if (static_cast<size_t>(location.end_offset()) <= source.size())
                 text = std::string(source.substr(location.start.offset, location.width));
             else
                 text = {};
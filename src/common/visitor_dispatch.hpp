@@ -0,0 +1,17 @@
+#pragma once
+
+namespace Fern
+{
+    // How a visitor's dispatch(node) reaches the visit() for the node's type.
+    //  Switch:  one switch on the node's kind tag (the default)
+    //  Virtual: node->accept(visitor), the double dispatch every pass used before
+    //           nodes carried tags; kept so --bench-dispatch can time the two side by side
+    enum class VisitorDispatch
+    {
+        Switch,
+        Virtual
+    };
+
+    // Only meant to be changed between compilations, never while a pass is running
+    inline VisitorDispatch visitor_dispatch = VisitorDispatch::Switch;
+}
@@ -1,5 +1,7 @@
 #include "compiled_module.hpp"
 #include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FileUtilities.h>
+#include <llvm/Support/Program.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/IR/LegacyPassManager.h>
@@ -7,6 +9,19 @@
 #include <llvm/Target/TargetOptions.h>
 #include <llvm/MC/TargetRegistry.h>
 #include <llvm/TargetParser/Host.h>
+#include <llvm/IR/DiagnosticHandler.h>
+#include <llvm/IR/DiagnosticInfo.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include "common/parallel.hpp"
+#include "codegen/profile.hpp"
+#include <algorithm>
+#include <cstdlib>
 
 namespace Fern
 {
@@ -26,11 +41,489 @@ namespace Fern
         initialized = true;
     }
 
-    bool CompiledModule::write_ir(const std::string &filename) const
+    // Routes vectorizer remarks into a VectorizationReport
+    class VectorizationRemarkHandler : public llvm::DiagnosticHandler
+    {
+    private:
+        VectorizationReport *report;
+
+        static bool is_vectorizer(llvm::StringRef pass_name)
+        {
+            return pass_name == "loop-vectorize" || pass_name == "slp-vectorizer";
+        }
+
+    public:
+        VectorizationRemarkHandler(VectorizationReport *report) : report(report) {}
+
+        bool isPassedOptRemarkEnabled(llvm::StringRef pass_name) const override
+        {
+            return report && is_vectorizer(pass_name);
+        }
+
+        bool handleDiagnostics(const llvm::DiagnosticInfo &info) override
+        {
+            // Failed vectorize.enable hints are warnings; keep them off stderr either way
+            if (info.getKind() == llvm::DK_OptimizationFailure)
+            {
+                if (report)
+                {
+                    report->forced_failures++;
+                    report->failure_messages.push_back(
+                        llvm::cast<llvm::DiagnosticInfoOptimizationBase>(info).getMsg());
+                }
+                return true;
+            }
+
+            auto *remark = llvm::dyn_cast<llvm::DiagnosticInfoOptimizationBase>(&info);
+            if (!remark || !report || !remark->isPassed())
+            {
+                return remark != nullptr;
+            }
+
+            if (remark->getPassName() == "loop-vectorize")
+            {
+                report->loops_vectorized++;
+            }
+            else if (remark->getPassName() == "slp-vectorizer")
+            {
+                report->slp_vectorized++;
+            }
+            return true;
+        }
+    };
+
+    // Copy a module into another context. CloneModule can't cross contexts, so go through bitcode.
+    static std::unique_ptr<llvm::Module> clone_into(const llvm::Module &module, llvm::LLVMContext &context)
+    {
+        llvm::SmallVector<char, 0> buffer;
+        llvm::raw_svector_ostream stream(buffer);
+        llvm::WriteBitcodeToFile(module, stream);
+
+        auto parsed = llvm::parseBitcodeFile(
+            llvm::MemoryBufferRef(llvm::StringRef(buffer.data(), buffer.size()), module.getModuleIdentifier()),
+            context);
+        if (!parsed)
+        {
+            std::cerr << "Failed to copy module: " << llvm::toString(parsed.takeError()) << "\n";
+            return nullptr;
+        }
+        return std::move(*parsed);
+    }
+
+    bool optimize_module(llvm::Module &module, unsigned opt_level, VectorizationReport *report)
+    {
+        // Same host description the JIT uses, so cost models match the code we'll run.
+        // Target machines aren't thread-safe, so every part gets its own.
+        auto target_builder = llvm::orc::JITTargetMachineBuilder::detectHost();
+        if (!target_builder)
+        {
+            std::cerr << "Host detection failed: " << llvm::toString(target_builder.takeError()) << "\n";
+            return false;
+        }
+        auto target_machine = target_builder->createTargetMachine();
+        if (!target_machine)
+        {
+            std::cerr << "Target machine creation failed: " << llvm::toString(target_machine.takeError()) << "\n";
+            return false;
+        }
+
+        module.setTargetTriple((*target_machine)->getTargetTriple().str());
+        module.setDataLayout((*target_machine)->createDataLayout());
+
+        llvm::LLVMContext &context = module.getContext();
+        auto previous_handler = context.getDiagnosticHandler();
+        context.setDiagnosticHandler(std::make_unique<VectorizationRemarkHandler>(report));
+
+        llvm::LoopAnalysisManager loop_am;
+        llvm::FunctionAnalysisManager function_am;
+        llvm::CGSCCAnalysisManager cgscc_am;
+        llvm::ModuleAnalysisManager module_am;
+
+        llvm::PassBuilder pass_builder(target_machine->get());
+        pass_builder.registerModuleAnalyses(module_am);
+        pass_builder.registerCGSCCAnalyses(cgscc_am);
+        pass_builder.registerFunctionAnalyses(function_am);
+        pass_builder.registerLoopAnalyses(loop_am);
+        pass_builder.crossRegisterProxies(loop_am, function_am, cgscc_am, module_am);
+
+        llvm::OptimizationLevel level = opt_level == 1   ? llvm::OptimizationLevel::O1
+                                        : opt_level == 2 ? llvm::OptimizationLevel::O2
+                                                         : llvm::OptimizationLevel::O3;
+        llvm::ModulePassManager pipeline = pass_builder.buildPerModuleDefaultPipeline(level);
+        pipeline.run(module, module_am);
+
+        context.setDiagnosticHandler(std::move(previous_handler));
+        return true;
+    }
+
+    bool CompiledModule::optimize(unsigned opt_level, VectorizationReport *report)
     {
         if (!is_valid())
         {
-            std::cerr << "Cannot write IR: module is invalid\n";
+            std::cerr << "Cannot optimize: module is invalid\n";
+            return false;
+        }
+        if (!has_llvm_ir())
+        {
+            // Bytecode is run as lowered; the HLIR passes have already been applied
+            return true;
+        }
+        if (opt_level == 0)
+        {
+            return true;
+        }
+        applied_opt_level = opt_level;
+        batch_cache.clear(); // built from the parts as they were
+
+        llvm::InitializeNativeTarget();
+
+        // Each part lives in its own context, so the pipelines can run side by side.
+        // Reports are collected per part and summed afterwards.
+        std::vector<VectorizationReport> part_reports(parts.size());
+        std::vector<char> part_ok(parts.size(), 0);
+        parallel_for(parts.size(), threads, [&](size_t i)
+        {
+            part_ok[i] = optimize_module(*parts[i].module, opt_level, report ? &part_reports[i] : nullptr);
+        });
+
+        if (report)
+        {
+            for (auto &part_report : part_reports)
+            {
+                report->loops_vectorized += part_report.loops_vectorized;
+                report->slp_vectorized += part_report.slp_vectorized;
+                report->forced_failures += part_report.forced_failures;
+                for (auto &message : part_report.failure_messages)
+                {
+                    report->failure_messages.push_back(std::move(message));
+                }
+            }
+        }
+        return std::find(part_ok.begin(), part_ok.end(), 0) == part_ok.end();
+    }
+
+    std::unique_ptr<llvm::Module> CompiledModule::merged_module(llvm::LLVMContext &scratch) const
+    {
+        if (parts.size() == 1)
+        {
+            return llvm::CloneModule(*parts.front().module);
+        }
+
+        // Partitions declare each other's functions, so linking them just resolves the calls
+        auto merged = std::make_unique<llvm::Module>(module_name, scratch);
+        llvm::Linker linker(*merged);
+        for (const auto &part : parts)
+        {
+            auto copy = clone_into(*part.module, scratch);
+            if (!copy || linker.linkInModule(std::move(copy)))
+            {
+                std::cerr << "Failed to link module partitions\n";
+                return nullptr;
+            }
+        }
+        return merged;
+    }
+
+    bool CompiledModule::add_to_jit(JIT &jit) const
+    {
+        if (!is_valid() || !has_llvm_ir())
+        {
+            LOG_ERROR("Cannot add to JIT: module is invalid or has no LLVM IR.", LogCategory::JIT);
+            return false;
+        }
+
+        // Tiered JITs start from the instrumented modules and recompile hot functions
+        // from the plain ones
+        const auto &jit_parts = jit_mode == JITMode::Tiered && !baseline_parts.empty() ? baseline_parts : parts;
+        for (const auto &part : jit_parts)
+        {
+            // Verify module before JIT execution
+            std::string verify_error;
+            llvm::raw_string_ostream error_stream(verify_error);
+            if (llvm::verifyModule(*part.module, &error_stream))
+            {
+                LOG_ERROR("Module verification failed:\n" + verify_error, LogCategory::JIT);
+                return false;
+            }
+
+            // Copy into a fresh context so the original stays usable and the JIT's
+            // compile threads never share a context
+            auto jit_context = std::make_unique<llvm::LLVMContext>();
+            auto copy = clone_into(*part.module, *jit_context);
+            if (!copy || !jit.add_module(std::move(copy), std::move(jit_context)))
+            {
+                LOG_ERROR("Failed to add module to JIT", LogCategory::JIT);
+                return false;
+            }
+        }
+
+        if (jit_mode == JITMode::Tiered)
+        {
+            llvm::LLVMContext scratch;
+            auto source = merged_module(scratch);
+            if (!source)
+            {
+                LOG_ERROR("Failed to build the tier-up source module", LogCategory::JIT);
+                return false;
+            }
+            jit.set_tier_source(*source);
+        }
+        return true;
+    }
+
+    static bool matches_host_scalar(llvm::Type *type, const HostScalar &host)
+    {
+        if (host.is_pointer)
+        {
+            return type->isPointerTy();
+        }
+        if (host.is_float)
+        {
+            return (type->isFloatTy() && host.size == 4) || (type->isDoubleTy() && host.size == 8);
+        }
+        if (auto *int_type = llvm::dyn_cast<llvm::IntegerType>(type))
+        {
+            // Fern bools are i1, stored in a byte like a C++ bool
+            return int_type->getBitWidth() == 1 ? host.size == 1 : int_type->getBitWidth() == host.size * 8;
+        }
+        return false;
+    }
+
+    static std::string batch_wrapper_name(const std::string &function_name)
+    {
+        return "__fern_batch." + function_name;
+    }
+
+    /**
+     * Add `void __fern_batch.<name>(ptr results, ptr columns, i64 begin, i64 end)`:
+     *   for (i = begin; i < end; i++) results[i] = name(columns[0][i], columns[1][i], ...)
+     * The call is marked always-inline, so an optimized wrapper is one loop over the body.
+     */
+    static bool emit_batch_wrapper(llvm::Module &module, const std::string &function_name,
+                                   const HostScalar &result_type, const std::vector<HostScalar> &param_types,
+                                   std::string &error)
+    {
+        llvm::Function *target = module.getFunction(function_name);
+        if (!target || target->isDeclaration())
+        {
+            error = "No function named " + function_name;
+            return false;
+        }
+
+        llvm::FunctionType *target_type = target->getFunctionType();
+        if (target_type->getNumParams() != param_types.size())
+        {
+            error = function_name + " takes " + std::to_string(target_type->getNumParams()) + " arguments, the batch has " +
+                    std::to_string(param_types.size()) + " columns";
+            return false;
+        }
+        for (size_t i = 0; i < param_types.size(); i++)
+        {
+            if (!matches_host_scalar(target_type->getParamType(i), param_types[i]))
+            {
+                error = "Column " + std::to_string(i) + " doesn't match parameter " + std::to_string(i) + " of " +
+                        function_name;
+                return false;
+            }
+        }
+        if (!matches_host_scalar(target_type->getReturnType(), result_type))
+        {
+            error = "The result buffer doesn't match the return type of " + function_name;
+            return false;
+        }
+
+        llvm::LLVMContext &context = module.getContext();
+        llvm::Type *i64_type = llvm::Type::getInt64Ty(context);
+        llvm::Type *ptr_type = llvm::PointerType::getUnqual(context);
+        auto *wrapper_type = llvm::FunctionType::get(llvm::Type::getVoidTy(context),
+                                                     {ptr_type, ptr_type, i64_type, i64_type}, false);
+        auto *wrapper = llvm::Function::Create(wrapper_type, llvm::Function::ExternalLinkage,
+                                               batch_wrapper_name(function_name), module);
+        llvm::Argument *results = wrapper->getArg(0);
+        llvm::Argument *columns = wrapper->getArg(1);
+        llvm::Argument *begin = wrapper->getArg(2);
+        llvm::Argument *end = wrapper->getArg(3);
+
+        auto *entry = llvm::BasicBlock::Create(context, "entry", wrapper);
+        auto *loop = llvm::BasicBlock::Create(context, "rows", wrapper);
+        auto *exit = llvm::BasicBlock::Create(context, "exit", wrapper);
+        llvm::IRBuilder<> builder(entry);
+
+        std::vector<llvm::Value *> column_bases;
+        for (size_t i = 0; i < param_types.size(); i++)
+        {
+            llvm::Value *slot = builder.CreateConstInBoundsGEP1_64(ptr_type, columns, i);
+            column_bases.push_back(builder.CreateLoad(ptr_type, slot, "column" + std::to_string(i)));
+        }
+        builder.CreateCondBr(builder.CreateICmpULT(begin, end), loop, exit);
+
+        builder.SetInsertPoint(loop);
+        llvm::PHINode *row = builder.CreatePHI(i64_type, 2, "row");
+        row->addIncoming(begin, entry);
+
+        std::vector<llvm::Value *> args;
+        for (size_t i = 0; i < param_types.size(); i++)
+        {
+            llvm::Type *param_type = target_type->getParamType(i);
+            llvm::Value *element = builder.CreateInBoundsGEP(param_type, column_bases[i], row);
+            args.push_back(builder.CreateLoad(param_type, element));
+        }
+        llvm::CallInst *call = builder.CreateCall(target, args);
+        call->setCallingConv(target->getCallingConv());
+        if (!target->hasFnAttribute(llvm::Attribute::NoInline))
+        {
+            call->addFnAttr(llvm::Attribute::AlwaysInline);
+        }
+        builder.CreateStore(call, builder.CreateInBoundsGEP(target_type->getReturnType(), results, row));
+
+        llvm::Value *next = builder.CreateAdd(row, llvm::ConstantInt::get(i64_type, 1));
+        row->addIncoming(next, loop);
+        builder.CreateCondBr(builder.CreateICmpULT(next, end), loop, exit);
+
+        builder.SetInsertPoint(exit);
+        builder.CreateRetVoid();
+        return true;
+    }
+
+    static bool same_scalar(const HostScalar &a, const HostScalar &b)
+    {
+        return a.size == b.size && a.is_float == b.is_float && a.is_pointer == b.is_pointer;
+    }
+
+    CompiledModule::BatchEntry *CompiledModule::batch_entry(const std::string &function_name,
+                                                            const HostScalar &result_type,
+                                                            const std::vector<HostScalar> &param_types)
+    {
+        auto cached = batch_cache.find(function_name);
+        if (cached != batch_cache.end())
+        {
+            const BatchEntry &entry = cached->second;
+            bool same_signature = same_scalar(entry.result_type, result_type) &&
+                                  entry.param_types.size() == param_types.size() &&
+                                  std::equal(param_types.begin(), param_types.end(), entry.param_types.begin(),
+                                             same_scalar);
+            if (same_signature)
+            {
+                return &cached->second;
+            }
+            // Called with other host types: check them against the function again
+            batch_cache.erase(cached);
+        }
+
+        // The whole program in one module with the wrapper, so the call can be inlined
+        llvm::LLVMContext scratch;
+        auto merged = merged_module(scratch);
+        auto batch_context = std::make_unique<llvm::LLVMContext>();
+        auto batch_module = merged ? clone_into(*merged, *batch_context) : nullptr;
+        if (!batch_module)
+        {
+            LOG_ERROR("Failed to build the batch module", LogCategory::JIT);
+            return nullptr;
+        }
+
+        std::string error;
+        if (!emit_batch_wrapper(*batch_module, function_name, result_type, param_types, error))
+        {
+            LOG_ERROR("Cannot execute batch: " + error, LogCategory::JIT);
+            return nullptr;
+        }
+
+        std::string verify_error;
+        llvm::raw_string_ostream error_stream(verify_error);
+        if (llvm::verifyModule(*batch_module, &error_stream))
+        {
+            LOG_ERROR("Batch module verification failed:\n" + verify_error, LogCategory::JIT);
+            return nullptr;
+        }
+
+        // Unoptimized modules stay that way; otherwise the wrapper gets the pipeline the
+        // parts had, which inlines the call and can vectorize the row loop
+        if (applied_opt_level > 0 && !optimize_module(*batch_module, applied_opt_level))
+        {
+            return nullptr;
+        }
+
+        // Tier-up swaps functions behind the wrapper's back, so batches always run eagerly
+        BatchEntry entry;
+        entry.jit = std::make_unique<JIT>(jit_mode == JITMode::Lazy ? JITMode::Lazy : JITMode::Eager, threads,
+                                          profiling);
+        if (!entry.jit->add_module(std::move(batch_module), std::move(batch_context)))
+        {
+            LOG_ERROR("Failed to add batch module to JIT", LogCategory::JIT);
+            return nullptr;
+        }
+
+        entry.wrapper = entry.jit->get_function<BatchWrapper>(batch_wrapper_name(function_name));
+        if (!entry.wrapper)
+        {
+            LOG_ERROR("Failed to find batch wrapper for: " + function_name, LogCategory::JIT);
+            return nullptr;
+        }
+        entry.result_type = result_type;
+        entry.param_types = param_types;
+        return &(batch_cache[function_name] = std::move(entry));
+    }
+
+    bool CompiledModule::run_batch(const std::string &function_name, size_t count, void *results,
+                                   const void *const *columns, const HostScalar &result_type,
+                                   const std::vector<HostScalar> &param_types)
+    {
+        if (!has_llvm_ir())
+        {
+            LOG_ERROR("Cannot execute batch: module has no LLVM IR.", LogCategory::JIT);
+            return false;
+        }
+
+        BatchEntry *entry = batch_entry(function_name, result_type, param_types);
+        if (!entry)
+        {
+            return false;
+        }
+        BatchWrapper *wrapper = entry->wrapper;
+
+        size_t chunks = (count + BATCH_CHUNK_ROWS - 1) / BATCH_CHUNK_ROWS;
+        try
+        {
+            parallel_for(chunks, batch_threads, [&](size_t chunk)
+            {
+                wrapper(results, columns, chunk * BATCH_CHUNK_ROWS, std::min(count, (chunk + 1) * BATCH_CHUNK_ROWS));
+            });
+        }
+        catch (...)
+        {
+            LOG_ERROR("Exception during batch execution", LogCategory::JIT);
+            return false;
+        }
+
+        if (instrumented)
+        {
+            // The writer clears the counters it writes, so reusing the cached JIT appends only this batch
+            write_profile(*entry->jit);
+        }
+        return true;
+    }
+
+    void CompiledModule::write_profile(JIT &jit) const
+    {
+        for (const auto &part : parts)
+        {
+            std::string writer_name = profile_writer_name(part.module->getModuleIdentifier());
+            if (auto *writer = jit.get_function<void()>(writer_name))
+            {
+                writer();
+            }
+            else
+            {
+                LOG_ERROR("Instrumented module has no profile writer: " + writer_name, LogCategory::JIT);
+            }
+        }
+    }
+
+    bool CompiledModule::write_ir(const std::string &filename) const
+    {
+        if (!is_valid() || !has_llvm_ir())
+        {
+            std::cerr << "Cannot write IR: module is invalid or has no LLVM IR\n";
             return false;
         }
 
@@ -43,46 +536,64 @@ namespace Fern
             return false;
         }
 
-        module->print(output, nullptr);
+        llvm::LLVMContext scratch;
+        auto merged = merged_module(scratch);
+        if (!merged)
+            return false;
+
+        merged->print(output, nullptr);
         return true;
     }
 
     std::string CompiledModule::get_ir_string() const
     {
-        if (!is_valid())
+        if (!is_valid() || !has_llvm_ir())
+            return "";
+
+        llvm::LLVMContext scratch;
+        auto merged = merged_module(scratch);
+        if (!merged)
             return "";
 
         std::string ir_str;
         llvm::raw_string_ostream stream(ir_str);
-        module->print(stream, nullptr);
+        merged->print(stream, nullptr);
         return stream.str();
     }
 
     void CompiledModule::dump_ir() const
     {
-        if (!is_valid())
+        if (!is_valid() || !has_llvm_ir())
         {
-            std::cerr << "Cannot dump IR: module is invalid\n";
+            std::cerr << "Cannot dump IR: module is invalid or has no LLVM IR\n";
             return;
         }
 
+        llvm::LLVMContext scratch;
+        auto merged = merged_module(scratch);
+        if (!merged)
+            return;
+
         std::cout << "\n=== LLVM IR ===\n";
-        module->print(llvm::outs(), nullptr);
+        merged->print(llvm::outs(), nullptr);
         std::cout << "\n===============\n";
     }
 
     bool CompiledModule::write_object_file(const std::string &filename) const
     {
-        if (!is_valid())
+        if (!is_valid() || !has_llvm_ir())
         {
-            std::cerr << "Cannot generate object file: module is invalid\n";
+            std::cerr << "Cannot generate object file: module is invalid or has no LLVM IR\n";
             return false;
         }
 
         initializeCommonTargets();
 
         // Clone module since we need to modify it
-        auto cloned_module = llvm::CloneModule(*module);
+        llvm::LLVMContext scratch;
+        auto cloned_module = merged_module(scratch);
+        if (!cloned_module)
+            return false;
 
         // Get target triple
         auto target_triple = llvm::sys::getDefaultTargetTriple();
@@ -134,17 +645,180 @@ namespace Fern
         return true;
     }
 
+    // int main() { return (int)Main(); } in the module, for native executables
+    static bool emit_c_main(llvm::Module &module, std::string &error)
+    {
+        if (module.getFunction("main"))
+        {
+            error = "The program already defines a C main function";
+            return false;
+        }
+        llvm::Function *fern_main = module.getFunction("Main");
+        if (!fern_main || fern_main->isDeclaration())
+        {
+            error = "The program has no Main function";
+            return false;
+        }
+        if (fern_main->arg_size() != 0)
+        {
+            error = "Main must take no parameters to be an executable's entry point";
+            return false;
+        }
+
+        llvm::LLVMContext &context = module.getContext();
+        llvm::Type *i32_type = llvm::Type::getInt32Ty(context);
+        auto *c_main = llvm::Function::Create(llvm::FunctionType::get(i32_type, false),
+                                              llvm::Function::ExternalLinkage, "main", module);
+        llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", c_main));
+        llvm::CallInst *result = builder.CreateCall(fern_main);
+        result->setCallingConv(fern_main->getCallingConv());
+
+        // The same conversion the JIT driver applies to Main's result for its exit code
+        llvm::Type *result_type = fern_main->getReturnType();
+        if (result_type->isFloatingPointTy())
+        {
+            builder.CreateRet(builder.CreateFPToSI(result, i32_type));
+        }
+        else if (result_type->isIntegerTy())
+        {
+            builder.CreateRet(builder.CreateSExtOrTrunc(result, i32_type));
+        }
+        else
+        {
+            builder.CreateRet(llvm::ConstantInt::get(i32_type, 0));
+        }
+        return true;
+    }
+
+    bool CompiledModule::write_executable(const std::string &filename, const std::string &cpu, bool static_link) const
+    {
+        if (!is_valid() || !has_llvm_ir())
+        {
+            std::cerr << "Cannot generate executable: module is invalid or has no LLVM IR\n";
+            return false;
+        }
+
+        initializeCommonTargets();
+
+        llvm::LLVMContext scratch;
+        auto cloned_module = merged_module(scratch);
+        if (!cloned_module)
+            return false;
+
+        std::string error;
+        if (!emit_c_main(*cloned_module, error))
+        {
+            std::cerr << "Cannot generate executable: " << error << "\n";
+            return false;
+        }
+
+        // "native" means this machine's CPU and features, as the JIT would use
+        auto target_builder = llvm::orc::JITTargetMachineBuilder::detectHost();
+        if (!target_builder)
+        {
+            std::cerr << "Host detection failed: " << llvm::toString(target_builder.takeError()) << "\n";
+            return false;
+        }
+        if (cpu != "native")
+        {
+            target_builder->setCPU(cpu);
+            target_builder->setFeatures("");
+        }
+        target_builder->setRelocationModel(static_link ? llvm::Reloc::Static : llvm::Reloc::PIC_);
+        target_builder->setCodeGenOptLevel(applied_opt_level == 0   ? llvm::CodeGenOptLevel::None
+                                           : applied_opt_level == 1 ? llvm::CodeGenOptLevel::Less
+                                           : applied_opt_level == 2 ? llvm::CodeGenOptLevel::Default
+                                                                    : llvm::CodeGenOptLevel::Aggressive);
+        auto target_machine = target_builder->createTargetMachine();
+        if (!target_machine)
+        {
+            std::cerr << "Target machine creation failed: " << llvm::toString(target_machine.takeError()) << "\n";
+            return false;
+        }
+
+        cloned_module->setTargetTriple((*target_machine)->getTargetTriple().str());
+        cloned_module->setDataLayout((*target_machine)->createDataLayout());
+
+        std::string verify_error;
+        llvm::raw_string_ostream error_stream(verify_error);
+        if (llvm::verifyModule(*cloned_module, &error_stream))
+        {
+            std::cerr << "Module verification failed:\n" << verify_error << "\n";
+            return false;
+        }
+
+        llvm::SmallString<128> object_path;
+        if (auto EC = llvm::sys::fs::createTemporaryFile("fern", "o", object_path))
+        {
+            std::cerr << "Could not create object file: " << EC.message() << "\n";
+            return false;
+        }
+        llvm::FileRemover object_remover(object_path);
+
+        {
+            std::error_code EC;
+            llvm::raw_fd_ostream dest(object_path, EC, llvm::sys::fs::OF_None);
+            if (EC)
+            {
+                std::cerr << "Could not open file: " << EC.message() << "\n";
+                return false;
+            }
+
+            llvm::legacy::PassManager pass;
+            if ((*target_machine)->addPassesToEmitFile(pass, dest, nullptr, llvm::CodeGenFileType::ObjectFile))
+            {
+                std::cerr << "Target machine can't emit object file\n";
+                return false;
+            }
+            pass.run(*cloned_module);
+        }
+
+        // The C compiler driver knows where crt1.o and libc live, which a bare ld doesn't
+        const char *cc_env = std::getenv("CC");
+        std::string linker_name = cc_env && *cc_env ? cc_env : "cc";
+        auto linker = llvm::sys::findProgramByName(linker_name);
+        if (!linker)
+        {
+            std::cerr << "Could not find the C compiler '" << linker_name << "' to link with\n";
+            return false;
+        }
+
+        std::vector<llvm::StringRef> args = {*linker, object_path, "-o", filename, "-lm"};
+        if (static_link)
+        {
+            args.push_back("-static");
+        }
+        else
+        {
+            args.push_back("-pie");
+        }
+
+        std::string link_error;
+        int status = llvm::sys::ExecuteAndWait(*linker, args, std::nullopt, {}, 0, 0, &link_error);
+        if (status != 0)
+        {
+            std::cerr << "Linking " << filename << " failed"
+                      << (link_error.empty() ? "" : ": " + link_error) << "\n";
+            return false;
+        }
+        return true;
+    }
+
     bool CompiledModule::write_assembly(const std::string &filename) const
     {
-        if (!is_valid())
+        if (!is_valid() || !has_llvm_ir())
         {
-            std::cerr << "Cannot generate assembly: module is invalid\n";
+            std::cerr << "Cannot generate assembly: module is invalid or has no LLVM IR\n";
             return false;
         }
 
         initializeCommonTargets();
 
-        auto cloned_module = llvm::CloneModule(*module);
+        llvm::LLVMContext scratch;
+        auto cloned_module = merged_module(scratch);
+        if (!cloned_module)
+            return false;
+
         auto target_triple = llvm::sys::getDefaultTargetTriple();
         cloned_module->setTargetTriple(target_triple);
 
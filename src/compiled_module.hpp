@@ -4,45 +4,139 @@
 #include <llvm/IR/Verifier.h>
 #include <llvm/Transforms/Utils/Cloning.h>
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 #include <optional>
 #include <iostream>
+#include <unordered_map>
 #include <type_traits>
 #include "jit.hpp"
+#include "bytecode/interpreter.hpp"
 #include "common/logger.hpp"
+#include "common/parallel.hpp"
 
 namespace Fern
 {
     // Forward declaration
     class JIT;
 
-    class CompiledModule
+    // What the vectorizers reported while optimizing a module
+    struct VectorizationReport
+    {
+        int loops_vectorized = 0;
+        int slp_vectorized = 0;   // straight-line code packed into vectors (e.g. fully unrolled loops)
+        int forced_failures = 0;  // loops tagged llvm.loop.vectorize.enable that stayed scalar
+        std::vector<std::string> failure_messages;
+    };
+
+    // One LLVM module with the context it lives in. Partitioned builds have several,
+    // each lowered and optimized on its own thread.
+    struct ModulePart
     {
-    private:
         std::unique_ptr<llvm::LLVMContext> context;
         std::unique_ptr<llvm::Module> module;
+    };
+
+    // How a host-side C++ scalar is laid out, for checking it against a Fern parameter
+    struct HostScalar
+    {
+        uint32_t size = 0;
+        bool is_float = false;
+        bool is_pointer = false;
+
+        template <typename T>
+        static HostScalar of()
+        {
+            return {static_cast<uint32_t>(sizeof(T)), std::is_floating_point_v<T>, std::is_pointer_v<T>};
+        }
+    };
+
+    // Run LLVM's standard pipeline (opt_level 1-3) on one module, tuned for the host CPU
+    bool optimize_module(llvm::Module &module, unsigned opt_level, VectorizationReport *report = nullptr);
+
+    class CompiledModule
+    {
+    private:
+        std::vector<ModulePart> parts;
+        std::vector<ModulePart> baseline_parts; // same code with profile counters, for tiered JITs
+        std::unique_ptr<Bytecode::Program> bytecode; // set instead of parts for the interpreter backend
         std::string module_name;
         bool has_errors;
         std::vector<std::string> errors;
+        unsigned threads = 1; // for optimizing parts and for the JIT's compile threads
+        JITMode jit_mode = JITMode::Eager;
+        bool profiling = false; // announce JIT'd code to perf and GDB
+        bool instrumented = false; // parts carry PGO counters and a profile writer
+        unsigned applied_opt_level = 0; // what optimize() ran, run again on batch wrappers
+        unsigned batch_threads = 1;
+
+        // A batch wrapper, JIT'd once per function and kept for later execute_batch calls
+        using BatchWrapper = void(void *, const void *const *, uint64_t, uint64_t);
+        struct BatchEntry
+        {
+            std::unique_ptr<JIT> jit; // owns the wrapper's code
+            BatchWrapper *wrapper = nullptr;
+            HostScalar result_type;
+            std::vector<HostScalar> param_types;
+        };
+        std::unordered_map<std::string, BatchEntry> batch_cache; // by function name
+
+        // The wrapper for `function_name` with this host signature, building it on first use
+        BatchEntry *batch_entry(const std::string &function_name, const HostScalar &result_type,
+                                const std::vector<HostScalar> &param_types);
+
+        // Every part in one module, cloned into the first part's context or linked into `scratch`
+        std::unique_ptr<llvm::Module> merged_module(llvm::LLVMContext &scratch) const;
+
+        // execute_jit and execute_jit_void on a bytecode module
+        template<typename ReturnType, typename... Args>
+        std::optional<ReturnType> execute_interpreted(const std::string &function_name, Args... args);
+
+        // execute_batch on LLVM IR: link the parts with a generated loop over the rows, JIT it
+        // (the first time this function is batched), then run it over chunks of the batch
+        bool run_batch(const std::string &function_name, size_t count, void *results, const void *const *columns,
+                       const HostScalar &result_type, const std::vector<HostScalar> &param_types);
+
+        // execute_batch on a bytecode module: one interpreter per chunk
+        template<typename ReturnType, typename... Args>
+        bool execute_batch_interpreted(const std::string &function_name, size_t count, ReturnType *results,
+                                       const Args *...columns);
 
     public:
         CompiledModule()
-            : context(nullptr), module(nullptr), has_errors(true) {}
+            : has_errors(true) {}
 
         CompiledModule(const std::vector<std::string> &compilation_errors)
-            : context(nullptr), module(nullptr), has_errors(true), errors(compilation_errors) {}
+            : has_errors(true), errors(compilation_errors) {}
 
         CompiledModule(std::unique_ptr<llvm::LLVMContext> ctx,
                        std::unique_ptr<llvm::Module> mod,
                        const std::string &name,
                        const std::vector<std::string> &compilation_errors = {})
-            : context(std::move(ctx)),
-              module(std::move(mod)),
+            : module_name(name),
+              has_errors(!compilation_errors.empty()),
+              errors(compilation_errors)
+        {
+            parts.push_back({std::move(ctx), std::move(mod)});
+        }
+
+        CompiledModule(std::vector<ModulePart> module_parts,
+                       const std::string &name,
+                       unsigned thread_count,
+                       const std::vector<std::string> &compilation_errors = {})
+            : parts(std::move(module_parts)),
               module_name(name),
               has_errors(!compilation_errors.empty()),
-              errors(compilation_errors) {}
+              errors(compilation_errors),
+              threads(thread_count > 0 ? thread_count : 1) {}
+
+        CompiledModule(std::unique_ptr<Bytecode::Program> program, const std::string &name)
+            : bytecode(std::move(program)),
+              module_name(name),
+              has_errors(false) {}
 
         // Move-only type
         CompiledModule(CompiledModule &&) = default;
@@ -51,13 +145,27 @@ namespace Fern
         CompiledModule &operator=(const CompiledModule &) = delete;
 
         // Check if compilation succeeded
-        bool is_valid() const { return module != nullptr && !has_errors; }
+        bool is_valid() const { return (has_llvm_ir() || bytecode != nullptr) && !has_errors; }
+        bool has_llvm_ir() const { return !parts.empty() && parts.front().module != nullptr; }
         const std::vector<std::string> &get_errors() const { return errors; }
 
-        // Output options
+        // Run LLVM's standard pipeline (opt_level 1-3) tuned for the host CPU.
+        // Parts are optimized concurrently; vectorizer remarks go into the report instead of stderr.
+        bool optimize(unsigned opt_level, VectorizationReport *report = nullptr);
+
+        // Output options; partitioned builds are linked into a single module first
         bool write_ir(const std::string &filename) const;
         bool write_object_file(const std::string &filename) const;
         bool write_assembly(const std::string &filename) const;
+
+        // Link a runnable binary: a C `main` that calls Main and exits with its result, compiled
+        // for `cpu` ("native" for this machine) at the level optimize() ran, then linked by the
+        // system C compiler ($CC, else cc). `static_link` asks it for a fully static binary.
+        bool write_executable(const std::string &filename, const std::string &cpu = "native",
+                              bool static_link = false) const;
+
+        // Verify every part and hand a copy of each to the JIT
+        bool add_to_jit(JIT &jit) const;
         
         // Generic JIT execution for any return type and function signature
         template<typename ReturnType, typename... Args>
@@ -67,15 +175,55 @@ namespace Fern
         template<typename... Args>
         bool execute_jit_void(const std::string &function_name, Args... args);
 
+        // Call a function once per row of a column-oriented batch: results[i] = f(columns[i]...).
+        // A generated loop calls the function from JIT'd code, inlining it when the module was
+        // optimized, so the host pays for one call per chunk instead of one per row. Chunks run
+        // on up to set_batch_threads threads. Every argument and the result must be a scalar
+        // whose size and kind match the function's signature.
+        template<typename ReturnType, typename... Args>
+        bool execute_batch(const std::string &function_name, size_t count, ReturnType *results,
+                           const Args *...columns);
+
+        // Rows per unit of work handed to a batch thread
+        static constexpr size_t BATCH_CHUNK_ROWS = 4096;
+
+        void set_batch_threads(unsigned count) { batch_threads = count > 0 ? count : 1; }
+        unsigned get_batch_threads() const { return batch_threads; }
+
         // Get LLVM IR as string
         std::string get_ir_string() const;
 
         // For debugging
         void dump_ir() const;
         
-        // Get raw module pointer (for advanced use)
-        llvm::Module* get_module() const { return module.get(); }
-        llvm::LLVMContext* get_context() const { return context.get(); }
+        // Get raw module pointer (for advanced use); the first part of a partitioned build
+        llvm::Module* get_module() const { return parts.empty() ? nullptr : parts.front().module.get(); }
+        llvm::LLVMContext* get_context() const { return parts.empty() ? nullptr : parts.front().context.get(); }
+        const std::vector<ModulePart> &get_parts() const { return parts; }
+        unsigned get_thread_count() const { return threads; }
+
+        // How execute_jit compiles: everything up front, each function on first call,
+        // or instrumented first and hot functions again at -O3
+        void set_jit_mode(JITMode mode) { jit_mode = mode; }
+        JITMode get_jit_mode() const { return jit_mode; }
+
+        // Let perf and GDB see the code execute_jit generates (see JIT)
+        void set_profiling(bool enabled) { profiling = enabled; }
+        bool get_profiling() const { return profiling; }
+
+        // Built with --profile-generate: execute_jit appends the counts to the profile after a run
+        void set_instrumented(bool enabled) { instrumented = enabled; }
+        bool is_instrumented() const { return instrumented; }
+
+        // Call every part's profile writer in a JIT that ran this module
+        void write_profile(JIT &jit) const;
+
+        // Tier-0 code for JITMode::Tiered: the unoptimized parts lowered with profile counters
+        void set_baseline_parts(std::vector<ModulePart> instrumented) { baseline_parts = std::move(instrumented); }
+        const std::vector<ModulePart> &get_baseline_parts() const { return baseline_parts; }
+
+        // The interpreter backend's program; null for LLVM builds
+        const Bytecode::Program *get_bytecode() const { return bytecode.get(); }
     };
 
     // Template implementation (must be in header)
@@ -94,28 +242,16 @@ namespace Fern
             return std::nullopt;
         }
 
-        // Verify module before JIT execution
-        std::string verify_error;
-        llvm::raw_string_ostream error_stream(verify_error);
-        if (llvm::verifyModule(*module, &error_stream))
+        if (bytecode)
         {
-            LOG_ERROR("Module verification failed:\n" + verify_error, LogCategory::JIT);
-            return std::nullopt;
+            return execute_interpreted<ReturnType>(function_name, args...);
         }
 
-        // Create JIT instance
-        JIT jit;
-
-        // Clone the module to preserve the original
-        auto cloned_module = llvm::CloneModule(*module);
-        
-        // The cloned module needs its own context for the JIT
-        auto jit_context = std::make_unique<llvm::LLVMContext>();
-
-        // Move ownership to JIT
-        if (!jit.add_module(std::move(cloned_module), std::move(jit_context)))
+        // Parts compile on the JIT's own threads once Main is looked up (eager)
+        // or function by function as they're first called (lazy)
+        JIT jit(jit_mode, threads, profiling);
+        if (!add_to_jit(jit))
         {
-            LOG_ERROR("Failed to add module to JIT", LogCategory::JIT);
             return std::nullopt;
         }
 
@@ -133,6 +269,10 @@ namespace Fern
         try
         {
             ReturnType result = func(args...);
+            if (instrumented)
+            {
+                write_profile(jit);
+            }
             return result;
         }
         catch (...)
@@ -156,28 +296,17 @@ namespace Fern
             return false;
         }
 
-        // Verify module before JIT execution
-        std::string verify_error;
-        llvm::raw_string_ostream error_stream(verify_error);
-        if (llvm::verifyModule(*module, &error_stream))
+        if (bytecode)
         {
-            LOG_ERROR("Module verification failed:\n" + verify_error, LogCategory::JIT);
-            return false;
+            // The result is ignored; any kind will do
+            return execute_interpreted<int>(function_name, args...).has_value();
         }
 
-        // Create JIT instance
-        JIT jit;
-
-        // Clone the module to preserve the original
-        auto cloned_module = llvm::CloneModule(*module);
-        
-        // The cloned module needs its own context for the JIT
-        auto jit_context = std::make_unique<llvm::LLVMContext>();
-
-        // Move ownership to JIT
-        if (!jit.add_module(std::move(cloned_module), std::move(jit_context)))
+        // Parts compile on the JIT's own threads once Main is looked up (eager)
+        // or function by function as they're first called (lazy)
+        JIT jit(jit_mode, threads, profiling);
+        if (!add_to_jit(jit))
         {
-            LOG_ERROR("Failed to add module to JIT", LogCategory::JIT);
             return false;
         }
 
@@ -195,6 +324,10 @@ namespace Fern
         try
         {
             func(args...);
+            if (instrumented)
+            {
+                write_profile(jit);
+            }
             return true;
         }
         catch (...)
@@ -204,4 +337,85 @@ namespace Fern
         }
     }
 
+    template<typename ReturnType, typename... Args>
+    bool CompiledModule::execute_batch(const std::string &function_name, size_t count, ReturnType *results,
+                                       const Args *...columns)
+    {
+        static_assert(!std::is_void_v<ReturnType>, "Batches write one result per row");
+        static_assert((std::is_arithmetic_v<ReturnType> || std::is_pointer_v<ReturnType>) &&
+                          ((std::is_arithmetic_v<Args> || std::is_pointer_v<Args>) && ...),
+                      "Batch columns and results must be scalars");
+
+        if (!is_valid())
+        {
+            LOG_ERROR("Cannot execute batch: module is invalid.", LogCategory::JIT);
+            return false;
+        }
+        if (count == 0)
+        {
+            return true;
+        }
+
+        if (bytecode)
+        {
+            return execute_batch_interpreted(function_name, count, results, columns...);
+        }
+
+        // Trailing null so the array exists for functions without parameters
+        const void *column_list[] = {static_cast<const void *>(columns)..., nullptr};
+        return run_batch(function_name, count, results, column_list, HostScalar::of<ReturnType>(),
+                         {HostScalar::of<Args>()...});
+    }
+
+    template<typename ReturnType, typename... Args>
+    bool CompiledModule::execute_batch_interpreted(const std::string &function_name, size_t count,
+                                                   ReturnType *results, const Args *...columns)
+    {
+        size_t chunks = (count + BATCH_CHUNK_ROWS - 1) / BATCH_CHUNK_ROWS;
+        try
+        {
+            parallel_for(chunks, batch_threads, [&](size_t chunk)
+            {
+                Interpreter interpreter(*bytecode);
+                size_t end = std::min(count, (chunk + 1) * BATCH_CHUNK_ROWS);
+                for (size_t row = chunk * BATCH_CHUNK_ROWS; row < end; row++)
+                {
+                    InterpreterValue result =
+                        interpreter.invoke(function_name, {InterpreterValue::from(columns[row])...});
+                    results[row] = result.template as<ReturnType>();
+                }
+            });
+            return true;
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR("Interpreter error: " + std::string(e.what()), LogCategory::JIT);
+            return false;
+        }
+    }
+
+    // Template implementation for the interpreter backend
+    template<typename ReturnType, typename... Args>
+    std::optional<ReturnType> CompiledModule::execute_interpreted(const std::string &function_name, Args... args)
+    {
+        try
+        {
+            Interpreter interpreter(*bytecode);
+            InterpreterValue result = interpreter.invoke(function_name, {InterpreterValue::from(args)...});
+            if constexpr (std::is_arithmetic_v<ReturnType> || std::is_pointer_v<ReturnType>)
+            {
+                return result.template as<ReturnType>();
+            }
+            else
+            {
+                return ReturnType{};
+            }
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR("Interpreter error: " + std::string(e.what()), LogCategory::JIT);
+            return std::nullopt;
+        }
+    }
+
 } // namespace Fern
@@ -2,6 +2,9 @@
 
 #include "common/logger.hpp"
 #include "codegen/codegen.hpp"
+#include "codegen/partition.hpp"
+#include "bytecode/bytecode_gen.hpp"
+#include "common/parallel.hpp"
 #include "semantic/symbol_table.hpp"
 #include "parser/lexer.hpp"
 #include "parser/parser.hpp"
@@ -14,6 +17,9 @@
 #include "semantic/symbol_table_builder.hpp"
 #include "hlir/hlir.hpp"
 #include "hlir/bound_to_hlir.hpp"
+#include "hlir/loop_optimizer.hpp"
+#include "hlir/bounds_check_elimination.hpp"
+#include "hlir/const_eval.hpp"
 
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/raw_ostream.h>
@@ -23,7 +29,9 @@
 #include <llvm/Target/TargetOptions.h>
 #include <llvm/MC/TargetRegistry.h>
 #include <llvm/TargetParser/Host.h>
+#include <algorithm>
 #include <optional>
+#include <chrono>
 
 namespace Fern
 {
@@ -84,6 +92,55 @@ namespace Fern
     //     global_symbols.set_current_scope(global_symbols.get_global_namespace());
     // }
 
+    void Compiler::run_hlir_passes(HLIR::Module *module, const std::vector<HLIR::Function *> &functions)
+    {
+        // First, so the passes after it see folded calls as plain constants
+        if (const_eval)
+        {
+            HLIR::ConstEvaluator evaluator(const_eval_limits);
+            evaluator.run(module, functions);
+
+            const auto &stats = evaluator.get_stats();
+            LOG_INFO("Constant evaluation: " + std::to_string(stats.pure_functions) + " pure functions, " +
+                     std::to_string(stats.calls_folded) + " calls folded (" + std::to_string(stats.calls_abandoned) +
+                     " abandoned, " + std::to_string(stats.steps) + " steps), " +
+                     std::to_string(stats.instructions_folded) + " instructions folded, " +
+                     std::to_string(stats.tables_folded) + " constant tables",
+                     LogCategory::COMPILER);
+        }
+
+        // Runs before the loop optimizer so it can clean up index math only the checks used
+        if (bounds_checks && eliminate_bounds_checks)
+        {
+            HLIR::BoundsCheckEliminator eliminator;
+            for (auto *func : functions)
+            {
+                eliminator.run(func);
+            }
+
+            const auto &stats = eliminator.get_stats();
+            LOG_INFO("Bounds checks: " + std::to_string(stats.checks) + " inserted, " +
+                     std::to_string(stats.removed) + " removed as redundant",
+                     LogCategory::COMPILER);
+        }
+        
+        // Loop-aware cleanups on the finished HLIR, before it's printed or lowered
+        if (optimize_loops)
+        {
+            HLIR::LoopOptimizer loop_optimizer;
+            for (auto *func : functions)
+            {
+                loop_optimizer.run(func);
+            }
+
+            const auto &stats = loop_optimizer.get_stats();
+            LOG_INFO("Loop optimization: " + std::to_string(stats.loops) + " loops, " +
+                     std::to_string(stats.hoisted) + " hoisted (" + std::to_string(stats.loads_hoisted) + " loads), " +
+                     std::to_string(stats.strength_reduced) + " element addresses strength-reduced",
+                     LogCategory::COMPILER);
+        }
+    }
+
     std::unique_ptr<CompiledModule> Compiler::compile(const std::vector<SourceFile> &source_files)
     {
         if (source_files.empty())
@@ -105,7 +162,7 @@ namespace Fern
             LOG_INFO("Parsing: " + state.file.filename, LogCategory::COMPILER);
 
             // Lex and parse
-            auto lexer = Lexer(state.file.source);
+            auto lexer = Lexer(state.file.source());
             auto tokens = lexer.tokenize_all();
 
             if (lexer.has_errors())
@@ -360,6 +417,14 @@ namespace Fern
         // === Convert bound tree to HLIR ===
         LOG_HEADER("HLIR generation", LogCategory::COMPILER);
 
+        using Clock = std::chrono::steady_clock;
+        auto elapsed_ms = [](Clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        };
+        timings = CompileTimings();
+        auto phase_start = Clock::now();
+
         // Create HLIR module
         auto hlir_module = std::make_unique<HLIR::Module>("FernProgram", global_symbols->get_global_namespace());
         
@@ -372,9 +437,44 @@ namespace Fern
             LOG_INFO("Generating HLIR for: " + state.file.filename, LogCategory::COMPILER);
             
             HLIR::BoundToHLIR converter(hlir_module.get(), global_type_system.get());
+            converter.set_bounds_checks(bounds_checks);
+            converter.set_source_file(state.file.filename);
             converter.build(state.boundTree);
         }
-        
+
+        timings.hlir_ms = elapsed_ms(phase_start);
+        for (const auto &func : hlir_module->functions)
+        {
+            for (const auto &block : func->blocks)
+            {
+                timings.hlir_instructions += block->instructions.size();
+                timings.hlir_phis += std::count_if(block->instructions.begin(), block->instructions.end(),
+                                                   [](HLIR::Instruction *inst) { return inst->op == HLIR::Opcode::Phi; });
+            }
+        }
+        phase_start = Clock::now();
+
+        std::vector<HLIR::Function *> functions;
+        for (const auto &func : hlir_module->functions)
+        {
+            functions.push_back(func.get());
+        }
+        run_hlir_passes(hlir_module.get(), functions);
+
+        timings.passes_ms = elapsed_ms(phase_start);
+
+#ifdef FERN_DEBUG
+        // Passes rewrite operands through the use lists, so a missed use is a miscompile
+        for (const auto &func : hlir_module->functions)
+        {
+            std::string error = HLIR::verify_uses(func.get());
+            if (!error.empty())
+            {
+                LOG_ERROR("HLIR use lists out of date in " + func->name() + ": " + error, LogCategory::COMPILER);
+            }
+        }
+#endif
+
         // Dump HLIR if requested
         if (print_hlir)
         {
@@ -382,16 +482,125 @@ namespace Fern
             std::cout << hlir_module->dump() << "\n";
         }
 
+        if (backend == Backend::Interpreter)
+        {
+            // === Bytecode Generation from HLIR ===
+            LOG_HEADER("Bytecode generation", LogCategory::COMPILER);
+
+            std::unique_ptr<Bytecode::Program> program;
+            try
+            {
+                phase_start = Clock::now();
+                program = BytecodeGen().lower(hlir_module.get());
+                timings.codegen_ms = elapsed_ms(phase_start);
+                LOG_INFO("Bytecode generation successful: " + std::to_string(program->instruction_count()) +
+                             " instructions",
+                         LogCategory::COMPILER);
+            }
+            catch (const std::exception &e)
+            {
+                all_errors.push_back("Bytecode generation error: " + std::string(e.what()));
+            }
+
+            if (!all_errors.empty())
+            {
+                LOG_HEADER("Code generation errors", LogCategory::COMPILER);
+                for (const auto &error : all_errors)
+                {
+                    LOG_ERROR(error, LogCategory::COMPILER);
+                }
+                return std::make_unique<CompiledModule>(all_errors);
+            }
+
+            return std::make_unique<CompiledModule>(std::move(program), "FernProgram");
+        }
+
         // === LLVM Code Generation from HLIR ===
         LOG_HEADER("LLVM code generation", LogCategory::COMPILER);
 
-        auto llvm_context = std::make_unique<llvm::LLVMContext>();
-        HLIRCodeGen codegen(*llvm_context, "FernProgram");
+        std::vector<ModulePart> parts;
+        std::vector<ModulePart> baseline_parts;
+        JITMode module_jit_mode = jit_mode;
+        if (!profile_generate.empty() && jit_mode == JITMode::Tiered)
+        {
+            // Tier-up would swap counted code for uncounted code partway through the run
+            LOG_WARN("Instrumented builds run with the eager JIT, not tiered", LogCategory::COMPILER);
+            module_jit_mode = JITMode::Eager;
+        }
+
+        ProfileData profile_data;
+        if (!profile_use.empty())
+        {
+            std::string profile_error;
+            if (!profile_data.load(profile_use, profile_error))
+            {
+                LOG_ERROR(profile_error, LogCategory::COMPILER);
+                return std::make_unique<CompiledModule>(std::vector<std::string>{profile_error});
+            }
+            else
+            {
+                LOG_INFO("Loaded profile for " + std::to_string(profile_data.size()) + " functions from " + profile_use,
+                         LogCategory::COMPILER);
+            }
+        }
 
-        std::unique_ptr<llvm::Module> llvm_module;
         try
         {
-            llvm_module = codegen.lower(hlir_module.get());
+            phase_start = Clock::now();
+
+            std::vector<CodegenPartition> partitions;
+            if (codegen_threads > 1)
+            {
+                ModulePartitioner partitioner;
+                partitions = partitioner.run(hlir_module.get(), codegen_threads);
+
+                const auto &stats = partitioner.get_stats();
+                LOG_INFO("Code generation partitions: " + std::to_string(partitions.size()) + " from " +
+                         std::to_string(stats.clusters) + " call-graph clusters, " +
+                         std::to_string(stats.cut_edges) + " of " + std::to_string(stats.call_edges) +
+                         " call edges cut",
+                         LogCategory::COMPILER);
+            }
+
+            auto lower_parts = [&](bool profile_counters)
+            {
+                std::vector<ModulePart> lowered;
+                if (!partitions.empty())
+                {
+                    // One module per partition, each in its own context, lowered side by side
+                    lowered.resize(partitions.size());
+                    parallel_for(partitions.size(), codegen_threads, [&](size_t i)
+                    {
+                        lowered[i].context = std::make_unique<llvm::LLVMContext>();
+                        HLIRCodeGen codegen(*lowered[i].context, "FernProgram." + std::to_string(i));
+                        codegen.set_profile_counters(profile_counters);
+                        codegen.set_debug_info(profiling);
+                        codegen.set_profile_generate(profile_generate);
+                        codegen.set_profile_use(profile_use.empty() ? nullptr : &profile_data);
+                        lowered[i].module = codegen.lower(hlir_module.get(), partitions[i].functions);
+                    });
+                }
+                else
+                {
+                    auto llvm_context = std::make_unique<llvm::LLVMContext>();
+                    HLIRCodeGen codegen(*llvm_context, "FernProgram");
+                    codegen.set_profile_counters(profile_counters);
+                    codegen.set_debug_info(profiling);
+                    codegen.set_profile_generate(profile_generate);
+                    codegen.set_profile_use(profile_use.empty() ? nullptr : &profile_data);
+                    auto llvm_module = codegen.lower(hlir_module.get());
+                    lowered.push_back({std::move(llvm_context), std::move(llvm_module)});
+                }
+                return lowered;
+            };
+
+            parts = lower_parts(false);
+            if (module_jit_mode == JITMode::Tiered)
+            {
+                // Tier 0 runs this copy as-is; `parts` is what hot functions are recompiled from
+                baseline_parts = lower_parts(true);
+            }
+            timings.codegen_ms = elapsed_ms(phase_start);
             LOG_INFO("LLVM IR generation successful", LogCategory::COMPILER);
         }
         catch (const std::exception &e)
@@ -409,11 +618,25 @@ namespace Fern
             return std::make_unique<CompiledModule>(all_errors);
         }
 
-        return std::make_unique<CompiledModule>(
-            std::move(llvm_context),
-            std::move(llvm_module),
+        auto compiled = std::make_unique<CompiledModule>(
+            std::move(parts),
             "FernProgram",
+            codegen_threads,
             all_errors);
+        compiled->set_jit_mode(module_jit_mode);
+        compiled->set_profiling(profiling);
+        compiled->set_instrumented(!profile_generate.empty());
+        compiled->set_baseline_parts(std::move(baseline_parts));
+
+        if (opt_level > 0)
+        {
+            LOG_HEADER("LLVM optimization (O" + std::to_string(opt_level) + ")", LogCategory::COMPILER);
+            phase_start = Clock::now();
+            compiled->optimize(opt_level);
+            timings.optimize_ms = elapsed_ms(phase_start);
+        }
+
+        return compiled;
     }
 
 } // namespace Fern
\ No newline at end of file
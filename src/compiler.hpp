@@ -7,6 +7,8 @@
 #include "parser/token_stream.hpp"
 #include "binding/bound_tree.hpp"
 #include "binding/bound_tree_builder.hpp"
+#include "hlir/const_eval.hpp"
+#include "common/source_buffer.hpp"
 
 #include <string>
 #include <memory>
@@ -16,10 +18,26 @@ namespace Fern
 
     class Parser;
 
+    // A file to compile. The text lives in a shared SourceBuffer, so copying a SourceFile
+    // (into a FileCompilationState, say) doesn't copy the text.
     struct SourceFile
     {
         std::string filename;
-        std::string source;
+        std::shared_ptr<const SourceBuffer> buffer;
+
+        SourceFile() = default;
+        SourceFile(std::string filename, std::shared_ptr<const SourceBuffer> buffer)
+            : filename(std::move(filename)), buffer(std::move(buffer)) {}
+        SourceFile(std::string filename, std::string source)
+            : filename(std::move(filename)), buffer(SourceBuffer::from_string(std::move(source))) {}
+
+        // Maps the file rather than reading it; throws std::runtime_error if it can't be opened
+        static SourceFile open(const std::string &filename)
+        {
+            return SourceFile(filename, SourceBuffer::open(filename));
+        }
+
+        std::string_view source() const { return buffer ? buffer->text() : std::string_view(); }
     };
 
     struct FileCompilationState
@@ -40,6 +58,24 @@ namespace Fern
         bool symbols_complete = false;
     };
 
+    // Back end timings of the last compile, for benchmarking
+    struct CompileTimings
+    {
+        double hlir_ms = 0.0;     // bound tree to HLIR
+        double passes_ms = 0.0;   // HLIR passes (bounds checks, loop optimizer)
+        double codegen_ms = 0.0;  // HLIR to LLVM IR, or to bytecode for the interpreter
+        double optimize_ms = 0.0; // LLVM pipeline, 0 when opt_level is 0
+        size_t hlir_instructions = 0;
+        size_t hlir_phis = 0;     // of hlir_instructions, before the HLIR passes
+    };
+
+    // What the HLIR is lowered to: LLVM IR for the JIT, or bytecode for the Interpreter
+    enum class Backend
+    {
+        LLVM,
+        Interpreter
+    };
+
     class Compiler
     {
     private:
@@ -48,6 +84,19 @@ namespace Fern
         bool print_ast = false;
         bool print_symbols = false;
         bool print_hlir = false;
+        bool optimize_loops = true;
+        bool const_eval = true; // run pure calls with constant arguments while compiling
+        HLIR::ConstEvaluator::Limits const_eval_limits;
+        bool bounds_checks = false;           // trap on out-of-range array indices
+        bool eliminate_bounds_checks = true;  // drop the checks range analysis proves redundant
+        unsigned opt_level = 0; // LLVM pipeline level, 0 leaves the IR as generated
+        unsigned codegen_threads = 1; // >1 splits the module into that many partitions
+        JITMode jit_mode = JITMode::Eager;
+        Backend backend = Backend::LLVM;
+        bool profiling = false; // line tables, and a JIT that perf and GDB can see into
+        std::string profile_generate; // instrument, appending counts to this file
+        std::string profile_use;      // optimize with the counts in this file
+        CompileTimings timings;
 
         void add_builtin_functions(SymbolTable& global_symbols);
 
@@ -59,11 +108,32 @@ namespace Fern
             return compile(std::vector<SourceFile>{source});
         }
 
+        // The HLIR passes compile() runs, in the same order, rewriting only `functions`.
+        // The rest of the module is still read, e.g. to tell which callees are pure
+        void run_hlir_passes(HLIR::Module *module, const std::vector<HLIR::Function *> &functions);
+
         // Configuration
         void set_verbose(bool v) { verbose = v; }
         void set_print_ast(bool p) { print_ast = p; }
         void set_print_symbols(bool p) { print_symbols = p; }
         void set_print_hlir(bool p) { print_hlir = p; }
+        void set_optimize_loops(bool o) { optimize_loops = o; }
+        void set_const_eval(bool c) { const_eval = c; }
+        void set_const_eval_limits(const HLIR::ConstEvaluator::Limits &limits) { const_eval_limits = limits; }
+        void set_bounds_checks(bool b) { bounds_checks = b; }
+        void set_eliminate_bounds_checks(bool e) { eliminate_bounds_checks = e; }
+        void set_opt_level(unsigned level) { opt_level = level > 3 ? 3 : level; }
+        void set_codegen_threads(unsigned threads) { codegen_threads = threads > 0 ? threads : 1; }
+        void set_jit_mode(JITMode mode) { jit_mode = mode; }
+        void set_backend(Backend b) { backend = b; }
+        void set_profiling(bool p) { profiling = p; }
+        void set_profile_generate(const std::string &filename) { profile_generate = filename; }
+        void set_profile_use(const std::string &filename) { profile_use = filename; }
+
+        bool get_bounds_checks() const { return bounds_checks; }
+        unsigned get_opt_level() const { return opt_level; }
+
+        const CompileTimings &get_timings() const { return timings; }
     };
 
 } // namespace Fern
\ No newline at end of file
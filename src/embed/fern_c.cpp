@@ -0,0 +1,213 @@
+// fern_c.cpp - C interface over Session (see include/fern.h)
+#include "fern.h"
+#include "session.hpp"
+
+#include "common/logger.hpp"
+
+#include <exception>
+#include <string>
+#include <vector>
+
+struct fern_session
+{
+    std::unique_ptr<Fern::Session> session;
+    std::vector<std::string> errors;
+};
+
+struct fern_module
+{
+    std::unique_ptr<Fern::SessionModule> module;
+    std::vector<std::string> errors;
+};
+
+// Handed out as-is; fern_function is never defined
+static const Fern::SessionFunction *unwrap(const fern_function *function)
+{
+    return reinterpret_cast<const Fern::SessionFunction *>(function);
+}
+
+static std::string source_text(const char *text, size_t length)
+{
+    if (!text)
+    {
+        return "";
+    }
+    return length > 0 ? std::string(text, length) : std::string(text);
+}
+
+static fern_type to_fern_type(Fern::TypePtr type)
+{
+    if (!type)
+    {
+        return FERN_TYPE_VOID;
+    }
+    if (type->is<Fern::PointerType>())
+    {
+        return FERN_TYPE_POINTER;
+    }
+    auto *primitive = type->as<Fern::PrimitiveType>();
+    if (!primitive)
+    {
+        return FERN_TYPE_OTHER;
+    }
+
+    switch (primitive->kind)
+    {
+    case Fern::PrimitiveKind::Void: return FERN_TYPE_VOID;
+    case Fern::PrimitiveKind::Bool: return FERN_TYPE_BOOL;
+    case Fern::PrimitiveKind::Char: return FERN_TYPE_CHAR;
+    case Fern::PrimitiveKind::I8: return FERN_TYPE_I8;
+    case Fern::PrimitiveKind::I16: return FERN_TYPE_I16;
+    case Fern::PrimitiveKind::I32: return FERN_TYPE_I32;
+    case Fern::PrimitiveKind::I64: return FERN_TYPE_I64;
+    case Fern::PrimitiveKind::U8: return FERN_TYPE_U8;
+    case Fern::PrimitiveKind::U16: return FERN_TYPE_U16;
+    case Fern::PrimitiveKind::U32: return FERN_TYPE_U32;
+    case Fern::PrimitiveKind::U64: return FERN_TYPE_U64;
+    case Fern::PrimitiveKind::F32: return FERN_TYPE_F32;
+    case Fern::PrimitiveKind::F64: return FERN_TYPE_F64;
+    default: return FERN_TYPE_OTHER;
+    }
+}
+
+extern "C"
+{
+
+    void fern_options_init(fern_options *options)
+    {
+        options->opt_level = 0;
+        options->bounds_checks = 0;
+        options->const_eval = 1;
+        options->optimize_loops = 1;
+        options->quiet = 1;
+    }
+
+    fern_session *fern_session_create(const fern_source *library, size_t library_count, const fern_options *options)
+    {
+        fern_options defaults;
+        fern_options_init(&defaults);
+        if (!options)
+        {
+            options = &defaults;
+        }
+        if (options->quiet)
+        {
+            Fern::Logger::get_instance().set_console_level(Fern::LogLevel::WARN);
+        }
+
+        Fern::Compiler configuration;
+        configuration.set_opt_level(options->opt_level);
+        configuration.set_bounds_checks(options->bounds_checks != 0);
+        configuration.set_const_eval(options->const_eval != 0);
+        configuration.set_optimize_loops(options->optimize_loops != 0);
+
+        std::vector<Fern::SourceFile> files;
+        for (size_t i = 0; i < library_count; i++)
+        {
+            files.push_back({library[i].filename ? library[i].filename : "library" + std::to_string(i) + ".fn",
+                             source_text(library[i].text, library[i].length)});
+        }
+
+        auto *result = new fern_session();
+        try
+        {
+            result->session = std::make_unique<Fern::Session>(files, configuration);
+            result->errors = result->session->get_errors();
+        }
+        catch (const std::exception &e)
+        {
+            result->session.reset();
+            result->errors.push_back(std::string("Session creation failed: ") + e.what());
+        }
+        return result;
+    }
+
+    void fern_session_destroy(fern_session *session)
+    {
+        delete session;
+    }
+
+    size_t fern_session_error_count(const fern_session *session)
+    {
+        return session->errors.size();
+    }
+
+    const char *fern_session_error(const fern_session *session, size_t index)
+    {
+        return index < session->errors.size() ? session->errors[index].c_str() : nullptr;
+    }
+
+    fern_module *fern_compile(fern_session *session, const char *filename, const char *text, size_t length)
+    {
+        auto *result = new fern_module();
+        if (!session->session)
+        {
+            result->errors.push_back("The session failed to start");
+            return result;
+        }
+
+        try
+        {
+            std::string source = source_text(text, length);
+            result->module = filename ? session->session->compile(Fern::SourceFile{filename, source})
+                                      : session->session->compile(source);
+            result->errors = result->module->get_errors();
+        }
+        catch (const std::exception &e)
+        {
+            result->errors.push_back(std::string("Compilation failed: ") + e.what());
+        }
+        return result;
+    }
+
+    void fern_module_destroy(fern_module *module)
+    {
+        delete module;
+    }
+
+    size_t fern_module_error_count(const fern_module *module)
+    {
+        return module->errors.size();
+    }
+
+    const char *fern_module_error(const fern_module *module, size_t index)
+    {
+        return index < module->errors.size() ? module->errors[index].c_str() : nullptr;
+    }
+
+    const fern_function *fern_module_find(const fern_module *module, const char *name)
+    {
+        if (!module->module || !module->errors.empty() || !name)
+        {
+            return nullptr;
+        }
+        return reinterpret_cast<const fern_function *>(module->module->find(name));
+    }
+
+    size_t fern_function_param_count(const fern_function *function)
+    {
+        return unwrap(function)->get_param_types().size();
+    }
+
+    fern_type fern_function_param_type(const fern_function *function, size_t index)
+    {
+        const auto &params = unwrap(function)->get_param_types();
+        return index < params.size() ? to_fern_type(params[index]) : FERN_TYPE_VOID;
+    }
+
+    fern_type fern_function_return_type(const fern_function *function)
+    {
+        return to_fern_type(unwrap(function)->get_return_type());
+    }
+
+    void *fern_function_address(const fern_function *function)
+    {
+        return unwrap(function)->get_address();
+    }
+
+    void fern_function_invoke(const fern_function *function, void *const *args, void *result)
+    {
+        unwrap(function)->invoke(args, result);
+    }
+
+} // extern "C"
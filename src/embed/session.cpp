@@ -0,0 +1,470 @@
+// session.cpp - Long-lived compiler sessions for embedding Fern in a host program
+#include "session.hpp"
+
+#include "common/logger.hpp"
+#include "codegen/codegen.hpp"
+#include "parser/lexer.hpp"
+#include "parser/parser.hpp"
+#include "semantic/symbol_table_builder.hpp"
+#include "semantic/type_resolver.hpp"
+#include "hlir/bound_to_hlir.hpp"
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/raw_ostream.h>
+#include <unordered_set>
+
+namespace Fern
+{
+
+    bool is_host_compatible(TypePtr type, const HostScalar &host)
+    {
+        if (!type)
+        {
+            return false;
+        }
+        if (type->is<PointerType>())
+        {
+            return host.is_pointer;
+        }
+        auto *primitive = type->as<PrimitiveType>();
+        if (!primitive || host.is_pointer)
+        {
+            return false;
+        }
+
+        switch (primitive->kind)
+        {
+        case PrimitiveKind::F32:
+            return host.is_float && host.size == 4;
+        case PrimitiveKind::F64:
+            return host.is_float && host.size == 8;
+        case PrimitiveKind::Bool:
+        case PrimitiveKind::Char:
+        case PrimitiveKind::I8:
+        case PrimitiveKind::U8:
+            return !host.is_float && host.size == 1;
+        case PrimitiveKind::I16:
+        case PrimitiveKind::U16:
+            return !host.is_float && host.size == 2;
+        case PrimitiveKind::I32:
+        case PrimitiveKind::U32:
+            return !host.is_float && host.size == 4;
+        case PrimitiveKind::I64:
+        case PrimitiveKind::U64:
+            return !host.is_float && host.size == 8;
+        default:
+            return false;
+        }
+    }
+
+    bool SessionFunction::matches(const std::vector<HostScalar> &args, const std::optional<HostScalar> &result) const
+    {
+        if (args.size() != param_types.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < args.size(); i++)
+        {
+            if (!is_host_compatible(param_types[i], args[i]))
+            {
+                return false;
+            }
+        }
+
+        auto *primitive = return_type ? return_type->as<PrimitiveType>() : nullptr;
+        bool returns_void = !return_type || (primitive && primitive->kind == PrimitiveKind::Void);
+        return result ? is_host_compatible(return_type, *result) : returns_void;
+    }
+
+    static std::string invoker_name(const std::string &function_name)
+    {
+        return "__fern_invoke." + function_name;
+    }
+
+    /**
+     * Add `void __fern_invoke.<name>(ptr args, ptr result)`:
+     *   *result = name(*args[0], *args[1], ...)
+     * which lets the host call any signature through one function pointer type.
+     */
+    static void emit_invoker(llvm::Module &module, llvm::Function *target)
+    {
+        llvm::LLVMContext &context = module.getContext();
+        llvm::Type *ptr_type = llvm::PointerType::getUnqual(context);
+        auto *invoker_type = llvm::FunctionType::get(llvm::Type::getVoidTy(context), {ptr_type, ptr_type}, false);
+        auto *invoker = llvm::Function::Create(invoker_type, llvm::Function::ExternalLinkage,
+                                               invoker_name(target->getName().str()), module);
+        llvm::Argument *args = invoker->getArg(0);
+        llvm::Argument *result = invoker->getArg(1);
+
+        llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", invoker));
+        std::vector<llvm::Value *> values;
+        for (unsigned i = 0; i < target->arg_size(); i++)
+        {
+            llvm::Value *slot = builder.CreateConstInBoundsGEP1_64(ptr_type, args, i);
+            llvm::Value *arg = builder.CreateLoad(ptr_type, slot, "arg" + std::to_string(i));
+            values.push_back(builder.CreateLoad(target->getArg(i)->getType(), arg));
+        }
+        llvm::CallInst *call = builder.CreateCall(target, values);
+        call->setCallingConv(target->getCallingConv());
+        if (!target->getReturnType()->isVoidTy())
+        {
+            builder.CreateStore(call, result);
+        }
+        builder.CreateRetVoid();
+    }
+
+    // ============================================================================
+    // Session
+    // ============================================================================
+
+    Session::Session(const std::vector<SourceFile> &library, const Compiler &configuration)
+        : settings(configuration)
+    {
+        library_symbols = std::make_unique<SymbolTable>(types);
+        jit = std::make_unique<JIT>(JITMode::Eager);
+
+        // Same front end as Compiler::compile: a symbol table per file, merged, then bound
+        library_files.resize(library.size());
+        for (size_t i = 0; i < library.size(); i++)
+        {
+            auto &state = library_files[i];
+            state.file = library[i];
+            if (!parse(state))
+            {
+                continue;
+            }
+
+            state.symbolTable = std::make_unique<SymbolTable>(types);
+            SymbolTableBuilder builder(*state.symbolTable);
+            builder.build(state.ast);
+            for (const auto &error : builder.get_errors())
+            {
+                state.errors.push_back(state.file.filename + " - Declaration: " + error);
+            }
+            state.symbols_complete = state.errors.empty();
+        }
+
+        for (auto &state : library_files)
+        {
+            errors.insert(errors.end(), state.errors.begin(), state.errors.end());
+            if (state.symbols_complete)
+            {
+                for (const auto &conflict : library_symbols->merge(*state.symbolTable))
+                {
+                    errors.push_back(state.file.filename + " - " + conflict);
+                }
+            }
+        }
+        if (!errors.empty())
+        {
+            return;
+        }
+
+        std::vector<FileCompilationState *> files;
+        for (auto &state : library_files)
+        {
+            state.boundTreeBuilder = std::make_unique<BoundTreeBuilder>(*library_symbols);
+            state.boundTree = state.boundTreeBuilder->bind(state.ast);
+            if (!state.boundTree)
+            {
+                errors.push_back(state.file.filename + ": Invalid Bound Tree");
+                continue;
+            }
+            files.push_back(&state);
+        }
+        resolve(*library_symbols, files, errors);
+        if (!errors.empty())
+        {
+            return;
+        }
+
+        // The library's HLIR stays: files compiled later call into it, and the
+        // constant evaluator reads it to run pure library functions
+        hlir_module = std::make_unique<HLIR::Module>("FernLibrary", library_symbols->get_global_namespace());
+        for (auto *state : files)
+        {
+            HLIR::BoundToHLIR converter(hlir_module.get(), &types);
+            converter.set_bounds_checks(settings.get_bounds_checks());
+            converter.set_source_file(state->file.filename);
+            converter.build(state->boundTree);
+        }
+
+        std::vector<HLIR::Function *> functions;
+        for (const auto &func : hlir_module->functions)
+        {
+            functions.push_back(func.get());
+        }
+        settings.run_hlir_passes(hlir_module.get(), functions);
+
+        auto context = std::make_unique<llvm::LLVMContext>();
+        auto module = lower(*context, "FernLibrary", functions, errors);
+        if (!module || !jit->add_module(std::move(module), std::move(context)))
+        {
+            errors.push_back("Failed to add the library to the JIT");
+            return;
+        }
+
+        // Compile the library now rather than in the first file's lookup
+        for (auto *func : functions)
+        {
+            if (!func->is_external && func->entry)
+            {
+                auto address = jit->lookup(func->name());
+                if (!address)
+                {
+                    errors.push_back("Failed to JIT the library: " + llvm::toString(address.takeError()));
+                }
+                break;
+            }
+        }
+    }
+
+    Session::~Session() = default;
+
+    bool Session::parse(FileCompilationState &state)
+    {
+        auto lexer = Lexer(state.file.source());
+        auto tokens = lexer.tokenize_all();
+        if (lexer.has_errors())
+        {
+            for (const auto &error : lexer.get_diagnostics())
+            {
+                state.errors.push_back(state.file.filename + " - Lexer: " + error.message);
+            }
+            return false;
+        }
+
+        state.tokens = std::make_unique<TokenStream>(std::move(tokens));
+        state.parser = std::make_unique<Parser>(*state.tokens);
+        state.ast = state.parser->parse();
+        if (!state.ast)
+        {
+            state.errors.push_back(state.file.filename + ": Invalid AST");
+            return false;
+        }
+
+        for (const auto &error : state.parser->getErrors())
+        {
+            state.errors.push_back(state.file.filename + " - Parser: " +
+                                   error.location.start.to_string() + ": " + error.message);
+        }
+        state.parse_complete = state.errors.empty();
+        return state.parse_complete;
+    }
+
+    void Session::resolve(SymbolTable &symbols, const std::vector<FileCompilationState *> &files,
+                          std::vector<std::string> &resolve_errors)
+    {
+        // As many rounds as Compiler::compile, so inference reaches the same fixed point
+        TypeResolver resolver(symbols);
+        for (int i = 0; i < 10; ++i)
+        {
+            for (auto *state : files)
+            {
+                resolver.resolve(state->boundTree);
+            }
+        }
+        for (auto *state : files)
+        {
+            resolver.resolve(state->boundTree);
+            for (const auto &error : resolver.get_errors())
+            {
+                resolve_errors.push_back(state->file.filename + " - " + error);
+            }
+        }
+    }
+
+    std::unique_ptr<llvm::Module> Session::lower(llvm::LLVMContext &context, const std::string &name,
+                                                 const std::vector<HLIR::Function *> &functions,
+                                                 std::vector<std::string> &lower_errors)
+    {
+        std::unique_ptr<llvm::Module> module;
+        try
+        {
+            HLIRCodeGen codegen(context, name);
+            module = codegen.lower(hlir_module.get(), functions);
+        }
+        catch (const std::exception &e)
+        {
+            lower_errors.push_back("LLVM code generation error: " + std::string(e.what()));
+            return nullptr;
+        }
+
+        if (settings.get_opt_level() > 0 && !optimize_module(*module, settings.get_opt_level()))
+        {
+            lower_errors.push_back("LLVM optimization failed");
+            return nullptr;
+        }
+        return module;
+    }
+
+    std::unique_ptr<SessionModule> Session::compile(const SourceFile &source)
+    {
+        auto result = std::unique_ptr<SessionModule>(new SessionModule(*this));
+        auto &state = result->state;
+        state.file = source;
+        uint64_t index = compiled_count++;
+
+        if (!is_valid())
+        {
+            result->errors.push_back("The session's library didn't compile");
+            return result;
+        }
+
+        // The file declares into a table of its own that falls back on the library's, so
+        // nothing it defines can clash with another file or outlive it
+        if (parse(state))
+        {
+            state.symbolTable = std::make_unique<SymbolTable>(types);
+            state.symbolTable->set_outer_namespace(library_symbols->get_global_namespace());
+            SymbolTableBuilder builder(*state.symbolTable);
+            builder.build(state.ast);
+            for (const auto &error : builder.get_errors())
+            {
+                state.errors.push_back(state.file.filename + " - Declaration: " + error);
+            }
+        }
+        if (state.errors.empty())
+        {
+            state.boundTreeBuilder = std::make_unique<BoundTreeBuilder>(*state.symbolTable);
+            state.boundTree = state.boundTreeBuilder->bind(state.ast);
+            if (!state.boundTree)
+            {
+                state.errors.push_back(state.file.filename + ": Invalid Bound Tree");
+            }
+        }
+        if (state.errors.empty())
+        {
+            resolve(*state.symbolTable, {&state}, state.errors);
+        }
+        if (!state.errors.empty())
+        {
+            result->errors = state.errors;
+            return result;
+        }
+
+        // Into the session's HLIR module, so calls into the library find its functions.
+        // Only the new functions go through the passes and code generation
+        size_t first_function = hlir_module->functions.size();
+        size_t first_type = hlir_module->types.size();
+        hlir_module->add_namespace(state.symbolTable->get_global_namespace());
+        for (size_t i = first_function; i < hlir_module->functions.size(); i++)
+        {
+            result->hlir_functions.push_back(hlir_module->functions[i].get());
+        }
+        for (size_t i = first_type; i < hlir_module->types.size(); i++)
+        {
+            result->hlir_types.push_back(hlir_module->types[i].get());
+        }
+
+        HLIR::BoundToHLIR converter(hlir_module.get(), &types);
+        converter.set_bounds_checks(settings.get_bounds_checks());
+        converter.set_source_file(state.file.filename);
+        converter.build(state.boundTree);
+        settings.run_hlir_passes(hlir_module.get(), result->hlir_functions);
+
+        std::string module_name = "FernSnippet." + std::to_string(index);
+        auto context = std::make_unique<llvm::LLVMContext>();
+        auto module = lower(*context, module_name, result->hlir_functions, result->errors);
+        if (!module)
+        {
+            return result;
+        }
+
+        // Every top-level function the host can find() gets an invoker
+        std::vector<std::pair<FunctionSymbol *, std::string>> exported;
+        for (auto *func : result->hlir_functions)
+        {
+            auto *symbol = func->symbol;
+            if (func->is_external || !func->entry || symbol->parent != state.symbolTable->get_global_namespace())
+            {
+                continue;
+            }
+            if (auto *llvm_func = module->getFunction(func->name()))
+            {
+                emit_invoker(*module, llvm_func);
+                exported.push_back({symbol, func->name()});
+            }
+        }
+
+        std::string verify_error;
+        llvm::raw_string_ostream error_stream(verify_error);
+        if (llvm::verifyModule(*module, &error_stream))
+        {
+            result->errors.push_back("Invoker verification failed: " + verify_error);
+            return result;
+        }
+
+        result->library = jit->create_library(module_name);
+        if (!result->library || !jit->add_module(std::move(module), std::move(context), *result->library))
+        {
+            result->errors.push_back("Failed to add " + state.file.filename + " to the JIT");
+            return result;
+        }
+
+        // Looking the functions up compiles the file, so compile() returns ready-to-call code
+        for (const auto &[symbol, name] : exported)
+        {
+            auto address = jit->lookup(*result->library, name);
+            auto invoker = address ? jit->lookup(*result->library, invoker_name(name))
+                                   : llvm::Expected<llvm::orc::ExecutorAddr>(address.takeError());
+            if (!invoker)
+            {
+                result->errors.push_back("Failed to JIT " + name + ": " + llvm::toString(invoker.takeError()));
+                return result;
+            }
+
+            SessionFunction function;
+            function.name = name;
+            function.address = address->toPtr<void *>();
+            function.invoker = invoker->toPtr<void (*)(void *const *, void *)>();
+            function.return_type = symbol->return_type;
+            for (auto *param : symbol->parameters)
+            {
+                function.param_types.push_back(param->type);
+            }
+
+            // Overloads share a name; find() refuses those rather than pick one
+            auto [it, inserted] = result->functions.emplace(symbol->name, std::move(function));
+            if (!inserted)
+            {
+                it->second.address = nullptr;
+            }
+        }
+        return result;
+    }
+
+    void Session::release(SessionModule &module)
+    {
+        if (module.library)
+        {
+            jit->remove_library(*module.library);
+        }
+        if (hlir_module)
+        {
+            hlir_module->remove({module.hlir_functions.begin(), module.hlir_functions.end()},
+                                {module.hlir_types.begin(), module.hlir_types.end()});
+        }
+    }
+
+    // ============================================================================
+    // SessionModule
+    // ============================================================================
+
+    SessionModule::SessionModule(Session &owner) : session(owner), state()
+    {
+    }
+
+    SessionModule::~SessionModule()
+    {
+        session.release(*this);
+    }
+
+    const SessionFunction *SessionModule::find(const std::string &name) const
+    {
+        auto it = functions.find(name);
+        return it != functions.end() && it->second.get_address() ? &it->second : nullptr;
+    }
+
+} // namespace Fern
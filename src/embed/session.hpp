@@ -0,0 +1,177 @@
+// session.hpp - Long-lived compiler sessions for embedding Fern in a host program
+#pragma once
+#include "compiler.hpp"
+#include "compiled_module.hpp"
+#include "semantic/type_system.hpp"
+#include "hlir/hlir.hpp"
+#include "jit.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace llvm::orc
+{
+    class JITDylib;
+}
+
+namespace Fern
+{
+
+    class Session;
+
+    // Whether a host-side scalar can stand in for a Fern parameter or result of this type
+    bool is_host_compatible(TypePtr type, const HostScalar &host);
+
+    /**
+     * @brief A function compiled by a Session, callable from the host
+     *
+     * call() checks the C++ argument and result types against the Fern signature.
+     * invoke() goes through a generated wrapper instead, so callers that only know
+     * the signature at run time (e.g. the C interface) don't need one host function
+     * pointer type per signature.
+     */
+    class SessionFunction
+    {
+    private:
+        friend class Session;
+
+        std::string name;
+        void *address = nullptr;
+        void (*invoker)(void *const *args, void *result) = nullptr;
+        std::vector<TypePtr> param_types;
+        TypePtr return_type;
+
+        bool matches(const std::vector<HostScalar> &args, const std::optional<HostScalar> &result) const;
+
+    public:
+        const std::string &get_name() const { return name; }
+        const std::vector<TypePtr> &get_param_types() const { return param_types; }
+        TypePtr get_return_type() const { return return_type; }
+        void *get_address() const { return address; }
+
+        // args[i] points at argument i and `result` at room for the return value; both are
+        // laid out as the Fern types are, and `result` is ignored for void functions
+        void invoke(void *const *args, void *result) const { invoker(args, result); }
+
+        // Empty when the argument or result types don't match the signature
+        template <typename ReturnType, typename... Args>
+        std::optional<ReturnType> call(Args... args) const
+        {
+            static_assert(!std::is_void_v<ReturnType>, "Use call_void for void functions");
+            if (!matches({HostScalar::of<Args>()...}, HostScalar::of<ReturnType>()))
+            {
+                LOG_ERROR("Arguments don't match the signature of " + name, LogCategory::JIT);
+                return std::nullopt;
+            }
+            return reinterpret_cast<ReturnType (*)(Args...)>(address)(args...);
+        }
+
+        template <typename... Args>
+        bool call_void(Args... args) const
+        {
+            if (!matches({HostScalar::of<Args>()...}, std::nullopt))
+            {
+                LOG_ERROR("Arguments don't match the signature of " + name, LogCategory::JIT);
+                return false;
+            }
+            reinterpret_cast<void (*)(Args...)>(address)(args...);
+            return true;
+        }
+    };
+
+    /**
+     * @brief One source file compiled against a Session's library
+     *
+     * Owns the file's symbols, its HLIR functions in the session's module and a JIT
+     * library of its own, so snippets can reuse names and each one's code is freed
+     * with it. Must be destroyed before the Session that compiled it.
+     */
+    class SessionModule
+    {
+    private:
+        friend class Session;
+
+        Session &session;
+        FileCompilationState state;
+        std::vector<HLIR::Function *> hlir_functions;
+        std::vector<HLIR::TypeDefinition *> hlir_types;
+        llvm::orc::JITDylib *library = nullptr;
+        std::unordered_map<std::string, SessionFunction> functions;
+        std::vector<std::string> errors;
+
+        explicit SessionModule(Session &owner);
+
+    public:
+        ~SessionModule();
+        SessionModule(const SessionModule &) = delete;
+        SessionModule &operator=(const SessionModule &) = delete;
+
+        bool is_valid() const { return errors.empty(); }
+        const std::vector<std::string> &get_errors() const { return errors; }
+
+        // A top-level function of this file; null when there is none by that name, or
+        // several overloads of it
+        const SessionFunction *find(const std::string &name) const;
+    };
+
+    /**
+     * @brief A warm compiler for many small programs in one process
+     *
+     * Compiler::compile builds a new type system, symbol table, LLVM context and JIT on
+     * every call, and recompiles whatever library it's given. A Session does that once:
+     * the library (usually runtime/std.fn) is parsed, resolved, lowered and JIT'd when
+     * the session is created, and every compile() after that reuses its interned types,
+     * its symbols, its HLIR and the JIT, adding only the new file's code.
+     *
+     * A compiled file sees the library's symbols through SymbolTable::set_outer_namespace
+     * and links against its code in the JIT, but not the other way around, and files
+     * don't see each other. Sessions are not thread-safe.
+     */
+    class Session
+    {
+    private:
+        friend class SessionModule;
+
+        Compiler settings; // configuration and the HLIR passes
+        TypeSystem types;
+        std::unique_ptr<SymbolTable> library_symbols;
+        std::vector<FileCompilationState> library_files; // the library's symbols point into these trees
+        std::unique_ptr<HLIR::Module> hlir_module;
+        std::unique_ptr<JIT> jit;
+        std::vector<std::string> errors;
+        uint64_t compiled_count = 0; // names each file's JIT library
+
+        bool parse(FileCompilationState &state);
+        void resolve(SymbolTable &symbols, const std::vector<FileCompilationState *> &files,
+                     std::vector<std::string> &resolve_errors);
+        std::unique_ptr<llvm::Module> lower(llvm::LLVMContext &context, const std::string &name,
+                                            const std::vector<HLIR::Function *> &functions,
+                                            std::vector<std::string> &lower_errors);
+        void release(SessionModule &module);
+
+    public:
+        // Compile `library` with `configuration`'s settings (optimization level, bounds checks,
+        // HLIR passes). Only the eager LLVM JIT is supported; the backend and JIT mode are ignored
+        explicit Session(const std::vector<SourceFile> &library, const Compiler &configuration = Compiler());
+        ~Session();
+        Session(const Session &) = delete;
+        Session &operator=(const Session &) = delete;
+
+        // False when the library didn't compile; compile() then refuses every file
+        bool is_valid() const { return errors.empty(); }
+        const std::vector<std::string> &get_errors() const { return errors; }
+
+        // Always returns a module; check is_valid() for errors
+        std::unique_ptr<SessionModule> compile(const SourceFile &source);
+        std::unique_ptr<SessionModule> compile(const std::string &source)
+        {
+            return compile(SourceFile{"snippet" + std::to_string(compiled_count) + ".fn", source});
+        }
+    };
+
+} // namespace Fern
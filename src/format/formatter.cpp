@@ -0,0 +1,353 @@
+#include "format/formatter.hpp"
+#include "common/parallel.hpp"
+#include "parser/lexer.hpp"
+#include "parser/token_stream.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+namespace Fern
+{
+
+    namespace
+    {
+        // A line that ends in one of these goes on, one level deeper, on the next
+        bool continues_line(TokenKind kind)
+        {
+            switch (kind)
+            {
+            case TokenKind::Assign:
+            case TokenKind::PlusAssign:
+            case TokenKind::MinusAssign:
+            case TokenKind::StarAssign:
+            case TokenKind::SlashAssign:
+            case TokenKind::PercentAssign:
+            case TokenKind::AndAssign:
+            case TokenKind::OrAssign:
+            case TokenKind::XorAssign:
+            case TokenKind::LeftShiftAssign:
+            case TokenKind::RightShiftAssign:
+            case TokenKind::NullCoalesceAssign:
+            case TokenKind::Plus:
+            case TokenKind::Minus:
+            case TokenKind::Slash:
+            case TokenKind::Percent:
+            case TokenKind::Equal:
+            case TokenKind::NotEqual:
+            case TokenKind::LessEqual:
+            case TokenKind::GreaterEqual:
+            case TokenKind::And:
+            case TokenKind::Or:
+            case TokenKind::BitwiseOr:
+            case TokenKind::BitwiseXor:
+            case TokenKind::NullCoalesce:
+            case TokenKind::Dot:
+            case TokenKind::ThinArrow:
+                return true;
+            default:
+                // Not `*`, `&`, `<` or `>`, which also end pointer, reference and generic types
+                return false;
+            }
+        }
+
+        TokenKind closer_of(TokenKind kind)
+        {
+            switch (kind)
+            {
+            case TokenKind::LeftBrace:
+                return TokenKind::RightBrace;
+            case TokenKind::LeftParen:
+                return TokenKind::RightParen;
+            case TokenKind::LeftBracket:
+                return TokenKind::RightBracket;
+            default:
+                return TokenKind::None;
+            }
+        }
+
+        bool is_closer(TokenKind kind)
+        {
+            return kind == TokenKind::RightBrace || kind == TokenKind::RightParen || kind == TokenKind::RightBracket;
+        }
+
+        std::string_view trim_right(std::string_view text)
+        {
+            size_t end = text.find_last_not_of(" \t\v\f\r");
+            return end == std::string_view::npos ? std::string_view() : text.substr(0, end + 1);
+        }
+
+        // Writes tokens and comments into the output one at a time, deciding what goes
+        // between each and the one before: nothing, a space, or newlines and indentation
+        class LineWriter
+        {
+        public:
+            LineWriter(std::string &out, const FormatOptions &options) : out(out), options(options) {}
+
+            void space(std::string_view whitespace)
+            {
+                if (!at_line_start())
+                    pending_space = whitespace;
+            }
+
+            void newline()
+            {
+                newlines++;
+                pending_space = {};
+            }
+
+            void comment(std::string_view text)
+            {
+                // Keep the spacing in front of a comment after code: it's often aligned
+                std::string_view before = pending_space;
+                begin_item(TokenKind::None, before);
+                out.append(trim_right(text));
+            }
+
+            void token(TokenKind kind, std::string_view text)
+            {
+                begin_item(kind, pending_space.empty() ? "" : " ");
+                out.append(text);
+
+                if (TokenKind closer = closer_of(kind); closer != TokenKind::None)
+                {
+                    // Groups opened together on one line share a level, so `f(g(` indents once
+                    if (!groups.empty() && groups.back().line == line)
+                        groups.push_back({closer, groups.back().outer, groups.back().inner, line});
+                    else
+                        groups.push_back({closer, line_level, line_level + 1, line});
+                }
+                else if (is_closer(kind) && !groups.empty())
+                {
+                    groups.pop_back();
+                }
+                continued = continues_line(kind);
+                if (kind == TokenKind::LeftBrace)
+                    awaiting_body = false;
+            }
+
+            void finish()
+            {
+                if (!out.empty())
+                    out.push_back('\n');
+            }
+
+        private:
+            struct Group
+            {
+                TokenKind closer;
+                uint32_t outer; // level of the line that opened it, and of its closer on a line of its own
+                uint32_t inner; // level of the lines inside it
+                size_t line;    // the output line it was opened on
+            };
+
+            bool at_line_start() const { return newlines > 0 || out.empty(); }
+
+            // `kind` is None for a comment
+            void begin_item(TokenKind kind, std::string_view separator)
+            {
+                if (!at_line_start())
+                {
+                    out.append(separator);
+                    pending_space = {};
+                    return;
+                }
+
+                if (!out.empty())
+                    out.append(std::min(newlines, options.max_blank_lines + 1), '\n');
+                newlines = 0;
+                pending_space = {};
+                line++;
+
+                if (is_closer(kind) && !groups.empty())
+                {
+                    line_level = groups.back().outer;
+                }
+                else
+                {
+                    line_level = groups.empty() ? 0 : groups.back().inner;
+                    bool in_block = groups.empty() || groups.back().closer == TokenKind::RightBrace;
+                    // The one statement of an `if`, `else`, `while` or `for` without braces
+                    if (in_block && kind != TokenKind::LeftBrace && (continued || awaiting_body))
+                        line_level++;
+                }
+                out.append(size_t(line_level) * options.indent_width, ' ');
+
+                // Comment lines leave the statement they sit in to the next line of code
+                if (kind != TokenKind::None)
+                    awaiting_body = kind == TokenKind::If || kind == TokenKind::Else ||
+                                    kind == TokenKind::While || kind == TokenKind::For;
+            }
+
+            std::string &out;
+            const FormatOptions &options;
+            std::vector<Group> groups;
+            std::string_view pending_space; // whitespace since the last item on this line
+            uint32_t newlines = 0;          // newlines since the last item
+            size_t line = 0;
+            uint32_t line_level = 0;
+            bool continued = false;     // the last token continues its line onto the next
+            bool awaiting_body = false; // the last line of code began a statement header
+        };
+
+        bool read_file(const std::string &path, std::string &text)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file)
+                return false;
+            text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            return true;
+        }
+
+        std::string describe(const LexerDiagnostic &diagnostic)
+        {
+            return std::to_string(diagnostic.location.line) + ":" + std::to_string(diagnostic.location.column) +
+                   ": " + diagnostic.message;
+        }
+    } // namespace
+
+    bool Formatter::format(std::string_view source, std::string &out, std::string *error) const
+    {
+        out.clear();
+        out.reserve(source.size() + source.size() / 8 + 64);
+
+        Lexer lexer(source);
+        TokenStream stream = lexer.tokenize_all();
+        if (lexer.has_errors())
+        {
+            if (error)
+                *error = describe(lexer.get_diagnostics().front());
+            return false;
+        }
+        const std::vector<Token> &tokens = stream.get_tokens();
+
+        // Trivia only records widths: its text is whatever lies between the tokens
+        LineWriter writer(out, options);
+        size_t offset = 0;
+        auto take_trivia = [&](const std::vector<Trivia> &trivia)
+        {
+            for (const Trivia &item : trivia)
+            {
+                std::string_view text = source.substr(offset, item.width);
+                offset += item.width;
+                switch (item.kind)
+                {
+                case TriviaKind::Whitespace:
+                    writer.space(text);
+                    break;
+                case TriviaKind::Newline:
+                    writer.newline();
+                    break;
+                case TriviaKind::LineComment:
+                case TriviaKind::BlockComment:
+                case TriviaKind::DocComment:
+                    writer.comment(text);
+                    break;
+                }
+            }
+        };
+
+        for (const Token &token : tokens)
+        {
+            take_trivia(token.leading_trivia);
+            if (token.kind == TokenKind::EndOfFile)
+                break;
+            // Locations hold ints; offsets into the source are size_t
+            size_t start = static_cast<size_t>(token.location.start.offset);
+            size_t width = static_cast<size_t>(token.location.width);
+            if (start != offset)
+            {
+                if (error)
+                    *error = std::to_string(token.location.start.line) + ":" +
+                             std::to_string(token.location.start.column) + ": token doesn't follow its trivia";
+                return false;
+            }
+            writer.token(token.kind, source.substr(offset, width));
+            offset += width;
+            take_trivia(token.trailing_trivia);
+        }
+        writer.finish();
+
+        // Only whitespace was meant to change; make sure the tokens read back the same
+        Lexer check(out);
+        TokenStream formatted = check.tokenize_all();
+        const std::vector<Token> &again = formatted.get_tokens();
+        bool same = !check.has_errors() && again.size() == tokens.size();
+        for (size_t i = 0; same && i < tokens.size(); i++)
+            same = again[i].kind == tokens[i].kind && again[i].text == tokens[i].text;
+        if (!same)
+        {
+            if (error)
+                *error = "formatting would change the file's tokens";
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<FormatFileResult> Formatter::format_files(const std::vector<std::string> &paths, bool write,
+                                                          unsigned threads) const
+    {
+        std::vector<FormatFileResult> results(paths.size());
+
+        parallel_for(paths.size(), threads, [&](size_t i)
+        {
+            // Each worker keeps its buffers across files, so they grow to the largest
+            // file once instead of being reallocated per file
+            thread_local std::string source;
+            thread_local std::string formatted;
+
+            FormatFileResult &result = results[i];
+            result.path = paths[i];
+            if (!read_file(result.path, source))
+            {
+                result.error = "could not read file";
+                return;
+            }
+            if (!format(source, formatted, &result.error))
+                return;
+
+            result.changed = formatted != source;
+            if (result.changed && write)
+            {
+                std::ofstream file(result.path, std::ios::binary | std::ios::trunc);
+                file.write(formatted.data(), std::streamsize(formatted.size()));
+                if (!file)
+                {
+                    result.error = "could not write file";
+                    return;
+                }
+            }
+            result.ok = true;
+        });
+
+        return results;
+    }
+
+    std::vector<std::string> Formatter::collect_sources(const std::vector<std::string> &paths)
+    {
+        std::vector<std::string> sources;
+        for (const std::string &path : paths)
+        {
+            std::error_code ec;
+            if (!fs::is_directory(path, ec))
+            {
+                sources.push_back(path);
+                continue;
+            }
+
+            size_t first = sources.size();
+            for (auto it = fs::recursive_directory_iterator(path, ec); !ec && it != fs::recursive_directory_iterator();
+                 it.increment(ec))
+            {
+                if (it->is_regular_file(ec) && it->path().extension() == ".fn")
+                    sources.push_back(it->path().string());
+            }
+            std::sort(sources.begin() + first, sources.end());
+        }
+        return sources;
+    }
+
+} // namespace Fern
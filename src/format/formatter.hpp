@@ -0,0 +1,62 @@
+// formatter.hpp - `fern fmt`: reformats Fern source from its tokens and trivia, keeping comments
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Fern
+{
+
+    struct FormatOptions
+    {
+        uint32_t indent_width = 4;    // Spaces per nesting level
+        uint32_t max_blank_lines = 1; // Longer runs of blank lines are shortened to this
+    };
+
+    // What became of one file in Formatter::format_files
+    struct FormatFileResult
+    {
+        std::string path;
+        bool ok = false;      // false if the file couldn't be read, lexed or written
+        bool changed = false; // the formatted text differs from what's on disk
+        std::string error;
+    };
+
+    /**
+     * @brief Lays out Fern source again from the lexer's tokens and trivia
+     *
+     * Only whitespace changes: each line is indented by the braces, parentheses and
+     * brackets it sits in (plus one level after a line that ends in an operator), runs of
+     * spaces between tokens become one space, trailing whitespace goes, runs of blank lines
+     * are shortened and the file ends in a single newline. Tokens and comments are copied
+     * from the source as they are, as is the spacing in front of a comment that follows
+     * code, so aligned comments stay aligned. The result is lexed again and must give back
+     * the same tokens, so formatting can never change what a file means.
+     *
+     * Formatting a file twice gives the same text as formatting it once.
+     */
+    class Formatter
+    {
+    public:
+        explicit Formatter(FormatOptions options = {}) : options(options) {}
+
+        // Format `source` into `out`, which is cleared first and keeps its capacity, so
+        // one buffer can be reused across files. Returns false, with the reason in
+        // `error`, if the source doesn't lex.
+        bool format(std::string_view source, std::string &out, std::string *error = nullptr) const;
+
+        // Format every file on up to `threads` threads, writing back only the files that
+        // change (and none at all unless `write`). Results are in the order of `paths`.
+        std::vector<FormatFileResult> format_files(const std::vector<std::string> &paths, bool write,
+                                                   unsigned threads) const;
+
+        // The .fn files named by `paths`: files as given, directories searched recursively
+        // (each directory's files sorted by path)
+        static std::vector<std::string> collect_sources(const std::vector<std::string> &paths);
+
+    private:
+        FormatOptions options;
+    };
+
+} // namespace Fern
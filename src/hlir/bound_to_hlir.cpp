@@ -1,5 +1,6 @@
 // hlir_builder.cpp
 #include "bound_to_hlir.hpp"
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -9,7 +10,6 @@ namespace Fern::HLIR
 
     void BoundToHLIR::build(BoundCompilationUnit* unit) {
         visit(unit);
-        resolve_pending_phis();
     }
 
     // Helper: Get field index within a type
@@ -48,8 +48,8 @@ namespace Fern::HLIR
             auto val = std::get<double>(node->constantValue);
             result = builder.const_float(val, node->type);
         }
-        else if (std::holds_alternative<std::string>(node->constantValue)) {
-            auto& val = std::get<std::string>(node->constantValue);
+        else if (std::holds_alternative<std::string_view>(node->constantValue)) {
+            std::string val(std::get<std::string_view>(node->constantValue));
             result = builder.const_string(val, node->type);
         }
         
@@ -101,6 +101,12 @@ namespace Fern::HLIR
             return;
         }
         
+        // Vector op scalar applies the scalar to every lane
+        if (node->type && node->type->is<VectorType>()) {
+            left = splat_to_vector(left, node->type);
+            right = splat_to_vector(right, node->type);
+        }
+
         auto opcode = get_binary_opcode(node->operatorKind);
         auto result = builder.binary(opcode, left, right);
         
@@ -143,6 +149,9 @@ namespace Fern::HLIR
                     }
                 }
             }
+            else if (auto index = node->target->as<BoundIndexExpression>()) {
+                current_value = evaluate_expression(index);
+            }
 
             // Perform the compound operation
             if (current_value) {
@@ -164,7 +173,7 @@ namespace Fern::HLIR
                         break;
                 }
 
-                final_value = builder.binary(opcode, current_value, rhs_value);
+                final_value = builder.binary(opcode, current_value, splat_to_vector(rhs_value, current_value->type));
             }
         }
 
@@ -246,6 +255,15 @@ namespace Fern::HLIR
                 }
             }
         }
+        // Handle vector lane assignment: rebuild the vector and assign it back
+        else if (auto index = node->target->as<BoundIndexExpression>();
+                 index && index->object->type && index->object->type->is<VectorType>()) {
+            auto vector_val = evaluate_expression(index->object);
+            auto lane_val = evaluate_expression(index->index);
+            if (vector_val && lane_val) {
+                store_vector(index->object, builder.insert_lane(vector_val, lane_val, final_value));
+            }
+        }
         // Handle array element assignment
         else if (auto index = node->target->as<BoundIndexExpression>()) {
             auto obj_val = evaluate_expression(index->object);
@@ -262,6 +280,7 @@ namespace Fern::HLIR
 
                 if (element_type) {
                     // Generate element address and store
+                    emit_bounds_check(obj_val, index_val, index->object->type);
                     auto addr_result = builder.element_addr(obj_val, index_val, element_type);
                     builder.store(final_value, addr_result);
                 }
@@ -272,6 +291,11 @@ namespace Fern::HLIR
     }
     
     void BoundToHLIR::visit(BoundCallExpression* node) {
+        if (node->intrinsic != VectorIntrinsic::None) {
+            expression_values[node] = lower_vector_intrinsic(node);
+            return;
+        }
+
         std::vector<HLIR::Value*> args;
 
         // Check if this is a method call through member access
@@ -325,6 +349,108 @@ namespace Fern::HLIR
         }
     }
     
+    void BoundToHLIR::emit_bounds_check(HLIR::Value* array, HLIR::Value* index, TypePtr array_type) {
+        // Raw pointers carry no length, so only arrays are checked
+        auto array_info = array_type ? array_type->as<ArrayType>() : nullptr;
+        if (!bounds_checks || !array_info) return;
+
+        auto i32_type = type_system->get_i32();
+        HLIR::Value* length = nullptr;
+        if (array_info->size >= 0) {
+            length = builder.const_int(array_info->size, i32_type);
+        } else {
+            // Dynamic arrays are { i32 length, ptr data }
+            length = builder.load(builder.field_addr(array, 0, i32_type), i32_type);
+        }
+        builder.bounds_check(index, length);
+    }
+
+    #pragma region Vector Expressions
+
+    HLIR::Value* BoundToHLIR::splat_to_vector(HLIR::Value* value, TypePtr vector_type) {
+        if (!value || !vector_type || !vector_type->is<VectorType>() || value->type == vector_type) {
+            return value;
+        }
+        return builder.splat(value, vector_type);
+    }
+
+    void BoundToHLIR::store_vector(BoundExpression* target, HLIR::Value* vector) {
+        if (auto name = target->as<BoundNameExpression>()) {
+            // Fields reached through an implicit `this` come back as addresses
+            auto target_val = evaluate_expression(name);
+            if (target_val && target_val->type->as<PointerType>()) {
+                builder.store(vector, target_val);
+            } else if (name->symbol) {
+                set_symbol_value(name->symbol, vector);
+            }
+        }
+        else if (auto member = target->as<BoundMemberAccessExpression>()) {
+            auto obj_val = evaluate_expression(member->object);
+            auto var = member->member ? member->member->as<VariableSymbol>() : nullptr;
+            if (obj_val && var) {
+                size_t field_index = get_field_index(var->parent->as<TypeSymbol>(), var);
+                builder.store(vector, builder.field_addr(obj_val, field_index, var->type));
+            }
+        }
+        else if (auto index = target->as<BoundIndexExpression>()) {
+            auto obj_val = evaluate_expression(index->object);
+            auto index_val = evaluate_expression(index->index);
+            if (obj_val && index_val) {
+                emit_bounds_check(obj_val, index_val, index->object->type);
+                builder.store(vector, builder.element_addr(obj_val, index_val, vector->type));
+            }
+        }
+    }
+
+    HLIR::Value* BoundToHLIR::lower_vector_intrinsic(BoundCallExpression* node) {
+        auto vector_type = node->type;
+
+        if (node->intrinsic == VectorIntrinsic::Construct) {
+            std::vector<HLIR::Value*> elements;
+            for (auto arg : node->arguments) {
+                auto value = evaluate_expression(arg);
+                if (!value) return nullptr;
+                elements.push_back(value);
+            }
+            if (elements.size() == 1) {
+                return builder.splat(elements[0], vector_type);
+            }
+            return builder.build_vector(std::move(elements), vector_type);
+        }
+
+        auto member_expr = node->callee->as<BoundMemberAccessExpression>();
+        auto vector = member_expr ? evaluate_expression(member_expr->object) : nullptr;
+        if (!vector) return nullptr;
+
+        switch (node->intrinsic) {
+            case VectorIntrinsic::Shuffle: {
+                // The optional second source comes first; the rest are constant lane indices
+                HLIR::Value* other = nullptr;
+                size_t first_index = 0;
+                if (!node->arguments.empty() && node->arguments[0]->type->is<VectorType>()) {
+                    other = evaluate_expression(node->arguments[0]);
+                    first_index = 1;
+                }
+
+                std::vector<int32_t> mask;
+                for (size_t i = first_index; i < node->arguments.size(); i++) {
+                    mask.push_back(static_cast<int32_t>(std::get<int64_t>(node->arguments[i]->constantValue)));
+                }
+                return builder.shuffle(vector, other, std::move(mask), vector_type);
+            }
+            case VectorIntrinsic::Sum:
+                return builder.reduce(HLIR::ReduceKind::Add, vector, node->type);
+            case VectorIntrinsic::Product:
+                return builder.reduce(HLIR::ReduceKind::Mul, vector, node->type);
+            case VectorIntrinsic::Min:
+                return builder.reduce(HLIR::ReduceKind::Min, vector, node->type);
+            case VectorIntrinsic::Max:
+                return builder.reduce(HLIR::ReduceKind::Max, vector, node->type);
+            default:
+                return nullptr;
+        }
+    }
+
     #pragma region Stub Expressions
     
     void BoundToHLIR::visit(BoundMemberAccessExpression* node) {
@@ -414,6 +540,12 @@ namespace Fern::HLIR
             return;
         }
 
+        // Vector lanes are read straight out of the register
+        if (auto vector_type = node->object->type->as<VectorType>()) {
+            expression_values[node] = builder.extract_lane(obj_val, index_val, vector_type->element);
+            return;
+        }
+
         // Get element type from array type
         TypePtr element_type = nullptr;
         if (auto array_type = node->object->type->as<ArrayType>()) {
@@ -428,6 +560,7 @@ namespace Fern::HLIR
         }
 
         // Generate element address
+        emit_bounds_check(obj_val, index_val, node->object->type);
         auto addr_result = builder.element_addr(obj_val, index_val, element_type);
 
         // Follow member access rules:
@@ -598,7 +731,8 @@ namespace Fern::HLIR
     
     void BoundToHLIR::visit(BoundBlockStatement* node) {
         for (auto stmt : node->statements) {
-            stmt->accept(this);
+            set_debug_line(stmt);
+            dispatch(stmt);
         }
     }
     
@@ -609,11 +743,6 @@ namespace Fern::HLIR
     void BoundToHLIR::visit(BoundIfStatement* node) {
         auto cond = evaluate_expression(node->condition);
 
-        // Save the block before the if-statement
-        auto before_block = current_block;
-        // Save symbol values before the if-statement
-        auto before_values = symbol_values;
-
         auto then_block = create_block("if.then");
         auto merge_block = create_block("if.merge");
         auto else_block = node->elseStatement
@@ -621,13 +750,12 @@ namespace Fern::HLIR
             : merge_block;
 
         builder.cond_br(cond, then_block, else_block);
+        seal_block(then_block);
 
         // Then branch
         builder.set_block(then_block);
         current_block = then_block;
-        node->thenStatement->accept(this);
-        // Save values after then branch
-        auto then_values = symbol_values;
+        dispatch(node->thenStatement);
         auto then_exit_block = current_block;
 
         // Check if then_block has a terminator (current_block might have changed or become null)
@@ -637,22 +765,14 @@ namespace Fern::HLIR
             builder.br(merge_block);
         }
 
-        // Else branch (if exists)
+        // Else branch (if exists); without one the merge block is the false target
         bool else_terminated = false;
-        HLIR::BasicBlock* else_exit_block = nullptr;
-        std::unordered_map<Symbol*, HLIR::Value*> else_values;
-
         if (node->elseStatement) {
-            // Restore symbol values to before the if for the else branch
-            symbol_values = before_values;
-
+            seal_block(else_block);
             builder.set_block(else_block);
             current_block = else_block;
-            node->elseStatement->accept(this);
-
-            // Save values after else branch
-            else_values = symbol_values;
-            else_exit_block = current_block;
+            dispatch(node->elseStatement);
+            auto else_exit_block = current_block;
 
             // Check if else_block has a terminator (current_block might have changed or become null)
             else_terminated = !else_exit_block || else_exit_block->terminator() != nullptr;
@@ -660,57 +780,16 @@ namespace Fern::HLIR
                 builder.set_block(else_exit_block);
                 builder.br(merge_block);
             }
-        } else {
-            // No else branch - values stay the same as before
-            else_values = before_values;
-            // The "else" path comes directly from the block before the if
-            else_exit_block = before_block;
         }
 
         // Check if merge block is reachable
         bool merge_reachable = !then_terminated || !else_terminated;
 
         if (merge_reachable) {
-            // Merge block is reachable, create PHI nodes for modified variables
+            // Both branches are in; variables read after the if get phis as they're needed
+            seal_block(merge_block);
             builder.set_block(merge_block);
             current_block = merge_block;
-
-            // Collect all symbols that might need PHI nodes
-            std::unordered_set<Symbol*> all_symbols;
-            for (auto& [sym, _] : then_values) all_symbols.insert(sym);
-            for (auto& [sym, _] : else_values) all_symbols.insert(sym);
-
-            // Create PHI nodes for symbols with different values
-            for (auto* sym : all_symbols) {
-                auto then_it = then_values.find(sym);
-                auto else_it = else_values.find(sym);
-
-                HLIR::Value* then_val = (then_it != then_values.end()) ? then_it->second : nullptr;
-                HLIR::Value* else_val = (else_it != else_values.end()) ? else_it->second : nullptr;
-
-                // If values differ between branches, create a PHI node
-                if (then_val && else_val && then_val != else_val) {
-                    auto phi_result = builder.phi(then_val->type);
-                    auto phi_inst = static_cast<HLIR::PhiInst*>(phi_result->def);
-
-                    // Add incoming values from each branch
-                    if (!then_terminated) {
-                        phi_inst->add_incoming(then_val, then_exit_block);
-                    }
-                    if (!else_terminated) {
-                        phi_inst->add_incoming(else_val, else_exit_block);
-                    }
-
-                    // Update symbol to use the PHI result
-                    symbol_values[sym] = phi_result;
-                } else if (then_val) {
-                    // Only then branch has this value, use it
-                    symbol_values[sym] = then_val;
-                } else if (else_val) {
-                    // Only else branch has this value, use it
-                    symbol_values[sym] = else_val;
-                }
-            }
         } else {
             // Both branches terminated - merge block is dead code
             // Remove it from the function's block list
@@ -727,7 +806,6 @@ namespace Fern::HLIR
     }
     
     void BoundToHLIR::visit(BoundWhileStatement* node) {
-        auto entry_block = current_block;
         auto header = create_block("while.header");
         auto body = create_block("while.body");
         auto exit = create_block("while.exit");
@@ -736,50 +814,44 @@ namespace Fern::HLIR
         builder.br(header);
         builder.set_block(header);
         current_block = header;
-
-        // Create phi helper to manage loop-carried variables
-        LoopPhiHelper phi_helper(this, entry_block, header);
-        phi_helper.create_phis();
+        open_loop(header);
 
         // Set up loop context
         LoopContext ctx;
         ctx.continue_target = header;
         ctx.break_target = exit;
-        ctx.loop_entry_values = symbol_values;
         loop_stack.push(ctx);
 
         // Evaluate condition and branch
         auto cond = evaluate_expression(node->condition);
         builder.cond_br(cond, body, exit);
+        seal_block(body);
 
         // Process loop body
         builder.set_block(body);
         current_block = body;
-        node->body->accept(this);
+        dispatch(node->body);
 
         auto body_end_block = current_block;
         if (body_end_block && !body_end_block->terminator()) {
             builder.br(header);
         }
 
-        // Add back-edge to phi nodes
-        phi_helper.add_backedge(body_end_block);
-
+        // The back edge, continues and breaks are all in now
         loop_stack.pop();
+        close_loop(header);
+        seal_block(exit);
+
         builder.set_block(exit);
         current_block = exit;
-
-        // Finalize phis - variables use phi results after loop
-        phi_helper.finalize();
     }
     
     void BoundToHLIR::visit(BoundForStatement* node) {
         // Initialize
         if (node->initializer) {
-            node->initializer->accept(this);
+            dispatch(node->initializer);
         }
 
-        auto entry_block = current_block;
         auto header = create_block("for.header");
         auto body = create_block("for.body");
         auto update = create_block("for.update");
@@ -788,16 +860,12 @@ namespace Fern::HLIR
         builder.br(header);
         builder.set_block(header);
         current_block = header;
-
-        // Create phi helper to manage loop-carried variables
-        LoopPhiHelper phi_helper(this, entry_block, header);
-        phi_helper.create_phis();
+        open_loop(header);
 
         // Set up loop context
         LoopContext ctx;
         ctx.continue_target = update;
         ctx.break_target = exit;
-        ctx.loop_entry_values = symbol_values;
         loop_stack.push(ctx);
 
         // Evaluate condition and branch
@@ -807,16 +875,18 @@ namespace Fern::HLIR
         } else {
             builder.br(body);
         }
+        seal_block(body);
 
         // Process body
         builder.set_block(body);
         current_block = body;
-        node->body->accept(this);
-        if (!current_block->terminator()) {
+        dispatch(node->body);
+        if (current_block && !current_block->terminator()) {
             builder.br(update);
         }
 
-        // Update block - increment variables and loop back
+        // Update block - increment variables and loop back; continues jump here too
+        seal_block(update);
         builder.set_block(update);
         current_block = update;
         for (auto inc : node->incrementors) {
@@ -824,15 +894,12 @@ namespace Fern::HLIR
         }
         builder.br(header);
 
-        // Add back-edge to phi nodes from update block
-        phi_helper.add_backedge(update);
-
         loop_stack.pop();
+        close_loop(header);
+        seal_block(exit);
+
         builder.set_block(exit);
         current_block = exit;
-
-        // Finalize phis - variables use phi results after loop
-        phi_helper.finalize();
     }
     
     void BoundToHLIR::visit(BoundBreakStatement* node) {
@@ -934,8 +1001,7 @@ namespace Fern::HLIR
         // Set is_external flag from symbol
         func->is_external = func_sym->isExtern;
 
-        // Clear symbol values from previous function
-        symbol_values.clear();
+        // Clear expression values from previous function
         expression_values.clear();
 
         current_function = func;
@@ -964,16 +1030,6 @@ namespace Fern::HLIR
             auto param = func->create_value(param_type, node->parameters[i]->name);
             func->params.push_back(param);
 
-            // For external functions, we're done - no stack allocation needed
-            if (func_sym->isExtern) {
-                continue;
-            }
-
-            // For regular functions with primitive/pointer parameters, use the parameter directly
-            if (!param_type->as<NamedType>() || !param_type->is_value_type()) {
-                set_symbol_value(param_sym, param);
-            }
-            // Note: Value type parameters are handled after entry block is created
         }
 
         // Skip body generation for external functions
@@ -983,27 +1039,31 @@ namespace Fern::HLIR
             current_block = entry;  // Set current_block
             builder.set_function(func);
             builder.set_block(entry);
+            begin_body(func, node);
 
-            // NOW allocate stack space for value-type parameters (after entry block exists)
+            // Parameters are defined in the entry block
             for (size_t i = 0; i < node->parameters.size(); i++) {
                 auto param_sym = node->parameters[i]->symbol->as<ParameterSymbol>();
                 auto param_type = param_sym->type;
+                auto param_value = func->params[is_member_function && !func_sym->isStatic ? i + 1 : i];
 
                 if (param_type->as<NamedType>() && param_type->is_value_type()) {
                     // Allocate stack space for the parameter
                     auto param_addr = builder.alloc(param_type, true);
                     // Store the parameter value into the stack allocation
-                    auto param_value = func->params[is_member_function && !func_sym->isStatic ? i + 1 : i];
                     builder.store(param_value, param_addr);
 
                     // Use the stack address for all subsequent accesses
                     set_symbol_value(param_sym, param_addr);
+                } else {
+                    // Primitive and pointer parameters are used directly
+                    set_symbol_value(param_sym, param_value);
                 }
             }
 
             // Process body
             if (node->body) {
-                node->body->accept(this);
+                dispatch(node->body);
             }
 
             // Add implicit return if needed
@@ -1039,41 +1099,78 @@ namespace Fern::HLIR
         
         // Process member functions if any
         for (auto member : node->members) {
-            member->accept(this);
+            dispatch(member);
         }
     }
     
     void BoundToHLIR::visit(BoundNamespaceDeclaration* node) {
         // Process namespace members
         for (auto member : node->members) {
-            member->accept(this);
+            dispatch(member);
         }
     }
     
     void BoundToHLIR::visit(BoundCompilationUnit* node) {
         for (auto stmt : node->statements) {
-            stmt->accept(this);
+            dispatch(stmt);
         }
     }
     
     #pragma region Helper Methods
     
     HLIR::Value* BoundToHLIR::evaluate_expression(BoundExpression* expr) {
-        expr->accept(this);
+        set_debug_line(expr);
+        dispatch(expr);
         return expression_values[expr];
     }
     
+    void BoundToHLIR::begin_body(HLIR::Function* func, BoundNode* decl) {
+        // Definitions are per function; the entry block has no predecessors to wait for
+        block_definitions.clear();
+        open_loops.clear();
+        assignments.clear();
+        removed_phis.clear();
+        seal_block(func->entry);
+
+        func->source_file = source_file;
+        func->source_line = decl ? static_cast<uint32_t>(std::max(0, decl->location.start.line)) : 0;
+        builder.set_debug_line(func->source_line);
+    }
+
+    // Later instructions take this line until a nested statement or expression sets its own
+    void BoundToHLIR::set_debug_line(BoundNode* node) {
+        if (node && node->location.start.line > 0) {
+            builder.set_debug_line(static_cast<uint32_t>(node->location.start.line));
+        }
+    }
+
     HLIR::Value* BoundToHLIR::get_symbol_value(Symbol* sym) {
-        auto it = symbol_values.find(sym);
-        if (it != symbol_values.end()) {
-            return it->second;
+        // Nothing is read after a return or break left no block to read in
+        if (!current_block) return nullptr;
+
+        auto it = assignments.find(sym);
+        if (it == assignments.end()) {
+            // Not assigned in this function
+            return nullptr;
+        }
+        auto& assignment = it->second;
+        if (assignment.only && (open_loops.empty() || assignment.block->id > open_loops.back()->id)) {
+            return forwarded(assignment.value);
         }
-        // TODO: Handle undefined variable
-        return nullptr;
+        return read_variable(sym, current_block);
     }
     
     void BoundToHLIR::set_symbol_value(Symbol* sym, HLIR::Value* val) {
-        symbol_values[sym] = val;
+        if (!current_block) return;
+
+        auto [it, first] = assignments.try_emplace(sym, OnlyAssignment{current_block, val, true});
+        if (!first) {
+            it->second.only = false;
+        }
+        if (!open_loops.empty()) {
+            definitions(open_loops.back()).assigned_in_loop.insert(sym);
+        }
+        write_variable(sym, current_block, val);
     }
     
     HLIR::BasicBlock* BoundToHLIR::create_block(const std::string& name) {
@@ -1082,12 +1179,155 @@ namespace Fern::HLIR
         return block;
     }
     
-    void BoundToHLIR::resolve_pending_phis() {
-        // TODO: Complete phi nodes with proper values
-        for (auto& pending : pending_phis) {
-            // Find value for symbol at each predecessor
+    #pragma region SSA Construction
+
+    BoundToHLIR::BlockDefinitions& BoundToHLIR::definitions(HLIR::BasicBlock* block) {
+        if (block->id >= block_definitions.size()) {
+            block_definitions.resize(block->id + 1);
+        }
+        return block_definitions[block->id];
+    }
+
+    void BoundToHLIR::write_variable(Symbol* sym, HLIR::BasicBlock* block, HLIR::Value* val) {
+        definitions(block).values[sym] = val;
+    }
+
+    HLIR::Value* BoundToHLIR::read_variable(Symbol* sym, HLIR::BasicBlock* block) {
+        auto& values = definitions(block).values;
+        auto it = values.find(sym);
+        if (it != values.end()) {
+            it->second = forwarded(it->second);
+            return it->second;
+        }
+        return read_variable_recursive(sym, block);
+    }
+
+    // A block's first predecessor is never a back edge: loop headers are entered from above
+    // before their bodies branch back. Reading through it first gives a phi its type and
+    // can't come back around to the block being read
+    HLIR::Value* BoundToHLIR::read_variable_recursive(Symbol* sym, HLIR::BasicBlock* block) {
+        auto& preds = block->predecessors;
+        if (preds.empty()) {
+            // Not defined in this function (the entry block, or code nothing branches to)
+            return nullptr;
+        }
+
+        HLIR::Value* value = nullptr;
+        if (!definitions(block).sealed) {
+            // More predecessors to come; the phi gets its operands when the block is sealed
+            auto first = read_variable(sym, preds[0]);
+            if (!first) return nullptr;
+            auto phi = insert_phi(block, first->type);
+            definitions(block).incomplete_phis.push_back({sym, phi});
+            value = phi->result;
+        } else if (preds.size() == 1) {
+            // No phi needed
+            value = read_variable(sym, preds[0]);
+        } else if (definitions(block).loop_header && !definitions(block).assigned_in_loop.count(sym)) {
+            // Nothing in the loop assigns it, so it keeps the value it came in with
+            value = read_variable(sym, preds[0]);
+        } else {
+            auto first = read_variable(sym, preds[0]);
+            if (!first) return nullptr;
+            // Defined before reading the operands, so a loop back to this block finds it
+            auto phi = insert_phi(block, first->type);
+            write_variable(sym, block, phi->result);
+            value = add_phi_operands(sym, phi);
+        }
+        write_variable(sym, block, value);
+        return value;
+    }
+
+    // Phis go ahead of everything else in the block, which may already have code
+    HLIR::PhiInst* BoundToHLIR::insert_phi(HLIR::BasicBlock* block, TypePtr type) {
+        size_t index = 0;
+        while (index < block->instructions.size() && block->instructions[index]->op == Opcode::Phi) {
+            index++;
+        }
+
+        auto result = current_function->create_value(type);
+        auto phi = current_function->make_inst<HLIR::PhiInst>(result);
+        result->def = phi;
+        block->insert_inst(index, phi);
+        return phi;
+    }
+
+    HLIR::Value* BoundToHLIR::add_phi_operands(Symbol* sym, HLIR::PhiInst* phi) {
+        for (auto pred : phi->parent->predecessors) {
+            // Scoping keeps a variable from being read where some path hasn't declared it
+            if (auto value = read_variable(sym, pred)) {
+                phi->add_incoming(value, pred);
+            }
+        }
+        return try_remove_trivial_phi(phi);
+    }
+
+    // A phi of only itself and one other value is that value. Removing it can make the phis
+    // that used it trivial in turn
+    HLIR::Value* BoundToHLIR::try_remove_trivial_phi(HLIR::PhiInst* phi) {
+        HLIR::Value* same = nullptr;
+        for (auto& [value, pred] : phi->incoming) {
+            if (value == same || value == phi->result) continue;
+            if (same) return phi->result;
+            same = value;
+        }
+        // Only reachable through itself, so there is nothing to replace it with
+        if (!same) return phi->result;
+
+        std::vector<HLIR::PhiInst*> users;
+        for (auto use = phi->result->first_use; use; use = use->next) {
+            if (use->user != phi && use->user->op == Opcode::Phi) {
+                users.push_back(static_cast<HLIR::PhiInst*>(use->user));
+            }
+        }
+
+        replace_all_uses(phi->result, same);
+        phi->result->def = nullptr;
+        current_function->drop_uses(phi);
+        phi->parent->remove_inst(phi);
+        removed_phis[phi->result] = same;
+
+        for (auto user : users) {
+            if (user->parent) {
+                try_remove_trivial_phi(user);
+            }
+        }
+        // One of those may have been `same`
+        return forwarded(same);
+    }
+
+    HLIR::Value* BoundToHLIR::forwarded(HLIR::Value* val) {
+        if (removed_phis.empty()) return val;
+        for (auto it = removed_phis.find(val); it != removed_phis.end(); it = removed_phis.find(val)) {
+            val = it->second;
+        }
+        return val;
+    }
+
+    void BoundToHLIR::seal_block(HLIR::BasicBlock* block) {
+        // Reading the operands can't add phis here (each symbol already has one), but the
+        // list is taken first since reading may grow block_definitions
+        auto incomplete = std::move(definitions(block).incomplete_phis);
+        definitions(block).incomplete_phis.clear();
+        for (auto& [sym, phi] : incomplete) {
+            add_phi_operands(sym, phi);
+        }
+        definitions(block).sealed = true;
+    }
+
+    void BoundToHLIR::open_loop(HLIR::BasicBlock* header) {
+        definitions(header).loop_header = true;
+        open_loops.push_back(header);
+    }
+
+    // Once the back edge and every continue are in
+    void BoundToHLIR::close_loop(HLIR::BasicBlock* header) {
+        open_loops.pop_back();
+        if (!open_loops.empty()) {
+            auto& assigned = definitions(header).assigned_in_loop;
+            definitions(open_loops.back()).assigned_in_loop.insert(assigned.begin(), assigned.end());
         }
-        pending_phis.clear();
+        seal_block(header);
     }
     
     HLIR::Opcode BoundToHLIR::get_binary_opcode(BinaryOperatorKind kind) {
@@ -1156,6 +1396,7 @@ namespace Fern::HLIR
         current_block = entry_block;
         builder.set_function(getter_func);
         builder.set_block(entry_block);
+        begin_body(getter_func, prop_decl);
         
         // Generate getter body
         if (getter->expression) {
@@ -1164,7 +1405,7 @@ namespace Fern::HLIR
             builder.ret(result);
         } else if (getter->body) {
             // Block property: { ... }
-            getter->body->accept(this);
+            dispatch(getter->body);
             // Add implicit return if no explicit return
             if (!current_block->terminator()) {
                 builder.ret(nullptr);
@@ -1223,6 +1464,7 @@ namespace Fern::HLIR
         current_block = entry_block;
         builder.set_function(setter_func);
         builder.set_block(entry_block);
+        begin_body(setter_func, prop_decl);
         
         // Generate setter body
         if (setter->expression) {
@@ -1230,7 +1472,7 @@ namespace Fern::HLIR
             evaluate_expression(setter->expression);
         } else if (setter->body) {
             // Block setter: { ... }
-            setter->body->accept(this);
+            dispatch(setter->body);
         }
         
         // Add implicit void return if no explicit return
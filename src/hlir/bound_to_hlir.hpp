@@ -11,7 +11,7 @@
 
 namespace Fern::HLIR
 {
-    class BoundToHLIR : public BoundVisitor {
+    class BoundToHLIR final : public BoundSwitchVisitor<BoundToHLIR, BoundVisitor> {
     private:
         #pragma region Core State
         HLIR::Module* module;
@@ -23,8 +23,33 @@ namespace Fern::HLIR
         HLIR::BasicBlock* current_block = nullptr;
         
         #pragma region SSA Value Tracking
-        // Symbol to SSA value mapping
-        std::unordered_map<Symbol*, HLIR::Value*> symbol_values;
+        // Variables go straight to SSA form as the tree is lowered (Braun et al., "Simple and
+        // Efficient Construction of Static Single Assignment Form"). Each block records only the
+        // symbols assigned in it; a read elsewhere walks back through the predecessors and places
+        // a phi only where different definitions meet. A block is sealed once all its
+        // predecessors are known, and phis placed before that wait for their operands
+        struct BlockDefinitions {
+            std::unordered_map<Symbol*, HLIR::Value*> values;
+            std::vector<std::pair<Symbol*, HLIR::PhiInst*>> incomplete_phis;
+            bool sealed = false;
+            bool loop_header = false;
+            std::unordered_set<Symbol*> assigned_in_loop; // loop headers only, nested loops included
+        };
+        std::vector<BlockDefinitions> block_definitions; // by block id, current function only
+        std::vector<HLIR::BasicBlock*> open_loops;       // headers not yet sealed, innermost last
+
+        // Where each symbol was assigned, while it has been assigned only once. Scoping makes that
+        // assignment dominate every read, so a read after it needs no search unless an open loop
+        // was entered before it and could assign again on the way around
+        struct OnlyAssignment {
+            HLIR::BasicBlock* block;
+            HLIR::Value* value;
+            bool only;
+        };
+        std::unordered_map<Symbol*, OnlyAssignment> assignments;
+
+        // Trivial phis removed after being recorded as a definition, to what replaced them
+        std::unordered_map<HLIR::Value*, HLIR::Value*> removed_phis;
         
         // Expression results cache
         std::unordered_map<BoundExpression*, HLIR::Value*> expression_values;
@@ -33,23 +58,22 @@ namespace Fern::HLIR
         struct LoopContext {
             HLIR::BasicBlock* continue_target;
             HLIR::BasicBlock* break_target;
-            std::unordered_map<Symbol*, HLIR::Value*> loop_entry_values;
         };
         std::stack<LoopContext> loop_stack;
         
-        // For deferred phi resolution
-        struct PendingPhi {
-            HLIR::PhiInst* phi;
-            Symbol* symbol;
-            HLIR::BasicBlock* block;
-        };
-        std::vector<PendingPhi> pending_phis;
+        // Guard array element accesses with BoundsCheck instructions
+        bool bounds_checks = false;
+
+        // File the bound tree came from, recorded on each function for line tables
+        std::string source_file;
         
     public:
         BoundToHLIR(HLIR::Module* mod, TypeSystem* types)
             : module(mod), builder(types), type_system(types) {}
         
         void build(BoundCompilationUnit* unit);
+        void set_bounds_checks(bool enabled) { bounds_checks = enabled; }
+        void set_source_file(const std::string& filename) { source_file = filename; }
         
         #pragma region Visitor Methods
         // Expressions
@@ -99,68 +123,33 @@ namespace Fern::HLIR
         HLIR::Value* get_symbol_value(Symbol* sym);
         void set_symbol_value(Symbol* sym, HLIR::Value* val);
         HLIR::BasicBlock* create_block(const std::string& name);
-        void resolve_pending_phis();
         HLIR::Opcode get_binary_opcode(BinaryOperatorKind kind);
         HLIR::Opcode get_unary_opcode(UnaryOperatorKind kind);
         size_t get_field_index(TypeSymbol* type_sym, Symbol* field_sym);
+        void emit_bounds_check(HLIR::Value* array, HLIR::Value* index, TypePtr array_type);
+        void begin_body(HLIR::Function* func, BoundNode* decl);
+        void set_debug_line(BoundNode* node);
+
+        // SSA construction
+        BlockDefinitions& definitions(HLIR::BasicBlock* block);
+        void write_variable(Symbol* sym, HLIR::BasicBlock* block, HLIR::Value* val);
+        HLIR::Value* read_variable(Symbol* sym, HLIR::BasicBlock* block);
+        HLIR::Value* read_variable_recursive(Symbol* sym, HLIR::BasicBlock* block);
+        HLIR::PhiInst* insert_phi(HLIR::BasicBlock* block, TypePtr type);
+        HLIR::Value* add_phi_operands(Symbol* sym, HLIR::PhiInst* phi);
+        HLIR::Value* try_remove_trivial_phi(HLIR::PhiInst* phi);
+        HLIR::Value* forwarded(HLIR::Value* val);
+        void seal_block(HLIR::BasicBlock* block);
+        void open_loop(HLIR::BasicBlock* header);
+        void close_loop(HLIR::BasicBlock* header);
+
+        // Vector helper methods
+        HLIR::Value* splat_to_vector(HLIR::Value* value, TypePtr vector_type);
+        void store_vector(BoundExpression* target, HLIR::Value* vector);
+        HLIR::Value* lower_vector_intrinsic(BoundCallExpression* node);
 
         // Property helper methods
         void generate_property_getter(BoundPropertyDeclaration* prop_decl, BoundPropertyAccessor* getter);
         void generate_property_setter(BoundPropertyDeclaration* prop_decl, BoundPropertyAccessor* setter);
-
-        // Loop phi node helper
-        class LoopPhiHelper {
-        private:
-            BoundToHLIR* converter;
-            HLIR::BasicBlock* entry_block;
-            HLIR::BasicBlock* header_block;
-            std::unordered_map<Symbol*, HLIR::Value*> entry_values;
-            std::unordered_map<Symbol*, HLIR::PhiInst*> phi_nodes;
-
-        public:
-            LoopPhiHelper(BoundToHLIR* conv, HLIR::BasicBlock* entry, HLIR::BasicBlock* header)
-                : converter(conv), entry_block(entry), header_block(header) {
-                entry_values = conv->symbol_values;
-            }
-
-            // Create phi nodes at loop header for all current variables
-            void create_phis() {
-                for (auto& [sym, entry_val] : entry_values) {
-                    auto phi_result = converter->builder.phi(entry_val->type);
-                    auto phi_inst = static_cast<HLIR::PhiInst*>(phi_result->def);
-                    phi_nodes[sym] = phi_inst;
-
-                    // Add incoming value from entry block
-                    phi_inst->add_incoming(entry_val, entry_block);
-
-                    // Update symbol_values to use the phi result
-                    converter->symbol_values[sym] = phi_result;
-                }
-            }
-
-            // Add back-edge values from loop body
-            void add_backedge(HLIR::BasicBlock* backedge_block) {
-                if (backedge_block) {
-                    for (auto& [sym, phi_inst] : phi_nodes) {
-                        auto body_val = converter->symbol_values[sym];
-
-                        // If the value is still the PHI result itself (unchanged in loop body),
-                        // use the entry value instead to avoid self-referential PHI
-                        if (body_val == phi_inst->result) {
-                            body_val = entry_values[sym];
-                        }
-
-                        phi_inst->add_incoming(body_val, backedge_block);
-                    }
-                }
-            }
-
-            // Restore phi results after loop
-            void finalize() {
-                for (auto& [sym, phi_inst] : phi_nodes) {
-                    converter->symbol_values[sym] = phi_inst->result;
-                }
-            }
-        };
     };
 }
\ No newline at end of file
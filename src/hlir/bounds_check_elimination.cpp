@@ -0,0 +1,387 @@
+// bounds_check_elimination.cpp
+#include "bounds_check_elimination.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+namespace Fern::HLIR
+{
+    using Range = BoundsCheckEliminator::Range;
+
+    // Expressions deeper than this are treated as unknown; also cuts cycles through phis
+    static constexpr int MAX_DEPTH = 8;
+    static constexpr size_t MAX_PHI_WEB = 32;
+
+    static Range full_range() {
+        return Range{};
+    }
+
+    // Values a type can hold. u64 doesn't fit in int64, so it's left unknown.
+    static Range type_range(TypePtr type) {
+        auto prim = type ? type->as<PrimitiveType>() : nullptr;
+        if (!prim) return full_range();
+
+        switch (prim->kind) {
+        case PrimitiveKind::I8: return {INT8_MIN, INT8_MAX};
+        case PrimitiveKind::I16: return {INT16_MIN, INT16_MAX};
+        case PrimitiveKind::I32: return {INT32_MIN, INT32_MAX};
+        case PrimitiveKind::U8: return {0, UINT8_MAX};
+        case PrimitiveKind::U16: return {0, UINT16_MAX};
+        case PrimitiveKind::U32: return {0, UINT32_MAX};
+        default: return full_range();
+        }
+    }
+
+    static bool is_known(const Range& range) {
+        return range.lo != INT64_MIN || range.hi != INT64_MAX;
+    }
+
+    static Range intersect(const Range& a, const Range& b) {
+        return {std::max(a.lo, b.lo), std::min(a.hi, b.hi)};
+    }
+
+    // Arithmetic may wrap, so a result that leaves the type's range says nothing
+    static Range fit_to_type(bool overflow, int64_t lo, int64_t hi, TypePtr type) {
+        Range limits = type_range(type);
+        if (overflow || lo < limits.lo || hi > limits.hi) return limits;
+        return {lo, hi};
+    }
+
+    static Opcode negate_compare(Opcode op) {
+        switch (op) {
+        case Opcode::Lt: return Opcode::Ge;
+        case Opcode::Le: return Opcode::Gt;
+        case Opcode::Gt: return Opcode::Le;
+        case Opcode::Ge: return Opcode::Lt;
+        case Opcode::Eq: return Opcode::Ne;
+        default: return Opcode::Eq;
+        }
+    }
+
+    #pragma region Pass
+
+    void BoundsCheckEliminator::run(Module* module) {
+        for (auto& func : module->functions) {
+            run(func.get());
+        }
+    }
+
+    void BoundsCheckEliminator::run(Function* func) {
+        if (func->is_external || !func->entry) return;
+
+        std::vector<BoundsCheckInst*> checks;
+        for (auto& block : func->blocks) {
+            for (auto& inst : block->instructions) {
+                if (inst->op == Opcode::BoundsCheck) {
+                    checks.push_back(static_cast<BoundsCheckInst*>(inst));
+                }
+            }
+        }
+        stats.checks += static_cast<uint32_t>(checks.size());
+        if (checks.empty()) return;
+
+        LoopInfo info(func);
+        loop_info = &info;
+
+        for (auto check : checks) {
+            if (!info.dominators().is_reachable(check->parent) || !is_redundant(check)) continue;
+
+            func->drop_uses(check);
+            check->parent->remove_inst(check);
+            stats.removed++;
+        }
+
+        loop_info = nullptr;
+        facts.clear();
+    }
+
+    bool BoundsCheckEliminator::is_redundant(BoundsCheckInst* check) {
+        collect_facts(check);
+
+        Range index = range_of(check->index);
+        Range length = range_of(check->length);
+        return index.lo >= 0 && index.hi < length.lo;
+    }
+
+    #pragma region Facts
+
+    void BoundsCheckEliminator::collect_facts(BoundsCheckInst* check) {
+        facts.clear();
+        const auto& dom_tree = loop_info->dominators();
+        BasicBlock* block = check->parent;
+
+        // Checks earlier in the same block already passed
+        for (auto& inst : block->instructions) {
+            if (inst == check) break;
+            if (inst->op == Opcode::BoundsCheck) {
+                add_check_facts(static_cast<BoundsCheckInst*>(inst));
+            }
+        }
+
+        for (auto dom = dom_tree.idom(block); dom; dom = dom_tree.idom(dom)) {
+            for (auto& inst : dom->instructions) {
+                if (inst->op == Opcode::BoundsCheck) {
+                    add_check_facts(static_cast<BoundsCheckInst*>(inst));
+                }
+            }
+
+            // A branch edge tells us its condition when every path to the check goes through it
+            auto terminator = dom->terminator();
+            if (!terminator || terminator->op != Opcode::CondBr) continue;
+
+            auto branch = static_cast<CondBrInst*>(terminator);
+            if (branch->true_block == branch->false_block) continue;
+            for (auto target : {branch->true_block, branch->false_block}) {
+                if (target->predecessors.size() == 1 && dom_tree.dominates(target, block)) {
+                    add_branch_facts(branch->condition, target == branch->true_block);
+                }
+            }
+        }
+    }
+
+    void BoundsCheckEliminator::add_check_facts(BoundsCheckInst* check) {
+        Range length = range_of(check->length, 1);
+        if (length.hi == INT64_MIN) return;
+        facts.push_back({check->index, {0, length.hi - 1}});
+    }
+
+    void BoundsCheckEliminator::add_branch_facts(Value* condition, bool taken) {
+        if (!condition->def || !is_compare(condition->def->op)) return;
+
+        auto compare = static_cast<BinaryInst*>(condition->def);
+        Opcode op = taken ? compare->op : negate_compare(compare->op);
+        Value* left = compare->left;
+        Value* right = compare->right;
+
+        // Only integers whose values fit in int64; u64 and floats compare differently
+        if (!is_known(type_range(left->type)) || !is_known(type_range(right->type))) return;
+
+        // Normalize to left < right or left <= right
+        if (op == Opcode::Gt || op == Opcode::Ge) {
+            std::swap(left, right);
+            op = op == Opcode::Gt ? Opcode::Lt : Opcode::Le;
+        }
+
+        Range left_range = range_of(left, 1);
+        Range right_range = range_of(right, 1);
+
+        switch (op) {
+        case Opcode::Lt:
+            facts.push_back({left, {INT64_MIN, right_range.hi - 1}});
+            facts.push_back({right, {left_range.lo + 1, INT64_MAX}});
+            break;
+        case Opcode::Le:
+            facts.push_back({left, {INT64_MIN, right_range.hi}});
+            facts.push_back({right, {left_range.lo, INT64_MAX}});
+            break;
+        case Opcode::Eq:
+            facts.push_back({left, right_range});
+            facts.push_back({right, left_range});
+            break;
+        default:
+            break;
+        }
+    }
+
+    #pragma region Ranges
+
+    Range BoundsCheckEliminator::range_of(Value* value, int depth, bool through_phi) {
+        Range range = depth > MAX_DEPTH ? type_range(value->type) : compute_range(value, depth, through_phi);
+        for (const auto& fact : facts) {
+            if (fact.value != value) continue;
+            // A fact is about the value's latest definition, and a phi can hold an earlier
+            // one (last iteration's, around a back edge) unless it's only ever defined once
+            if (through_phi && !is_defined_once(value)) continue;
+            range = intersect(range, fact.range);
+        }
+        return range;
+    }
+
+    bool BoundsCheckEliminator::is_defined_once(Value* value) const {
+        return !value->def || !loop_info->loop_for(value->def->parent);
+    }
+
+    Range BoundsCheckEliminator::compute_range(Value* value, int depth, bool through_phi) {
+        if (!value->def) return type_range(value->type);
+
+        auto inst = value->def;
+        int64_t constant;
+
+        switch (inst->op) {
+        case Opcode::ConstInt: {
+            int64_t v = static_cast<ConstIntInst*>(inst)->value;
+            return {v, v};
+        }
+
+        case Opcode::Add:
+        case Opcode::Sub:
+        case Opcode::Mul: {
+            auto bin = static_cast<BinaryInst*>(inst);
+            Range a = range_of(bin->left, depth + 1, through_phi);
+            Range b = range_of(bin->right, depth + 1, through_phi);
+            if (!is_known(a) || !is_known(b)) return type_range(value->type);
+
+            int64_t lo, hi;
+            bool overflow = false;
+            if (inst->op == Opcode::Add) {
+                overflow |= __builtin_add_overflow(a.lo, b.lo, &lo);
+                overflow |= __builtin_add_overflow(a.hi, b.hi, &hi);
+            } else if (inst->op == Opcode::Sub) {
+                overflow |= __builtin_sub_overflow(a.lo, b.hi, &lo);
+                overflow |= __builtin_sub_overflow(a.hi, b.lo, &hi);
+            } else {
+                int64_t corners[4];
+                overflow |= __builtin_mul_overflow(a.lo, b.lo, &corners[0]);
+                overflow |= __builtin_mul_overflow(a.lo, b.hi, &corners[1]);
+                overflow |= __builtin_mul_overflow(a.hi, b.lo, &corners[2]);
+                overflow |= __builtin_mul_overflow(a.hi, b.hi, &corners[3]);
+                lo = *std::min_element(corners, corners + 4);
+                hi = *std::max_element(corners, corners + 4);
+            }
+            return fit_to_type(overflow, lo, hi, value->type);
+        }
+
+        case Opcode::Rem: {
+            // x % c keeps the sign of x and stays below c in magnitude
+            auto bin = static_cast<BinaryInst*>(inst);
+            if (!get_const_int(bin->right, constant) || constant <= 0) return type_range(value->type);
+            Range a = range_of(bin->left, depth + 1, through_phi);
+            if (a.lo >= 0) return {0, std::min(a.hi, constant - 1)};
+            return {-(constant - 1), constant - 1};
+        }
+
+        case Opcode::BitAnd: {
+            // Masking with a non-negative value can only clear bits
+            auto bin = static_cast<BinaryInst*>(inst);
+            Range a = range_of(bin->left, depth + 1, through_phi);
+            Range b = range_of(bin->right, depth + 1, through_phi);
+            if (a.lo >= 0 && b.lo >= 0) return {0, std::min(a.hi, b.hi)};
+            if (a.lo >= 0) return {0, a.hi};
+            if (b.lo >= 0) return {0, b.hi};
+            return type_range(value->type);
+        }
+
+        case Opcode::Shr: {
+            auto bin = static_cast<BinaryInst*>(inst);
+            Range a = range_of(bin->left, depth + 1, through_phi);
+            if (!get_const_int(bin->right, constant) || constant < 0 || constant > 63 || a.lo < 0) {
+                return type_range(value->type);
+            }
+            return {a.lo >> constant, a.hi >> constant};
+        }
+
+        case Opcode::Cast: {
+            Range source = range_of(static_cast<CastInst*>(inst)->value, depth + 1, through_phi);
+            Range target = type_range(value->type);
+            if (source.lo >= target.lo && source.hi <= target.hi) return source;
+            return target;
+        }
+
+        case Opcode::Phi: {
+            auto phi = static_cast<PhiInst*>(inst);
+            Range iv = induction_range(phi, depth);
+            if (is_known(iv)) return iv;
+
+            // Otherwise the value came from one of the sources feeding this web of phis
+            std::vector<Value*> sources;
+            if (!collect_phi_sources(phi, sources)) return type_range(value->type);
+
+            Range merged = {INT64_MAX, INT64_MIN};
+            for (auto source : sources) {
+                Range r = range_of(source, depth + 1, true);
+                merged = {std::min(merged.lo, r.lo), std::max(merged.hi, r.hi)};
+            }
+            return merged;
+        }
+
+        default:
+            return type_range(value->type);
+        }
+    }
+
+    bool BoundsCheckEliminator::collect_phi_sources(PhiInst* phi, std::vector<Value*>& sources) {
+        // BoundToHLIR threads every variable through a phi at each loop header, so a value
+        // from outside a loop nest reaches the body through a cycle of phis that only
+        // forward it. Induction variables are kept as sources since they have their own range.
+        std::vector<PhiInst*> worklist = {phi};
+        std::unordered_set<PhiInst*> visited = {phi};
+        while (!worklist.empty()) {
+            auto current = worklist.back();
+            worklist.pop_back();
+
+            for (auto& [incoming, block] : current->incoming) {
+                auto def = incoming->def;
+                bool is_phi = def && def->op == Opcode::Phi;
+                if (is_phi) {
+                    Loop* loop = loop_info->loop_for(def->parent);
+                    if (loop && loop->header == def->parent && loop->find_induction_var(incoming)) {
+                        is_phi = false;
+                    }
+                }
+
+                if (!is_phi) {
+                    if (std::find(sources.begin(), sources.end(), incoming) == sources.end()) {
+                        sources.push_back(incoming);
+                    }
+                } else if (visited.insert(static_cast<PhiInst*>(def)).second) {
+                    if (visited.size() > MAX_PHI_WEB) return false;
+                    worklist.push_back(static_cast<PhiInst*>(def));
+                }
+            }
+        }
+        return !sources.empty();
+    }
+
+    Range BoundsCheckEliminator::induction_range(PhiInst* phi, int depth) {
+        Loop* loop = loop_info->loop_for(phi->parent);
+        if (!loop || loop->header != phi->parent) return full_range();
+
+        auto iv = loop->find_induction_var(phi->result);
+        auto terminator = loop->header->terminator();
+        if (!iv || !terminator || terminator->op != Opcode::CondBr) return full_range();
+
+        // The header test has to compare this variable, and leave the loop when it fails
+        auto branch = static_cast<CondBrInst*>(terminator);
+        auto condition = branch->condition->def;
+        if (!condition || !is_compare(condition->op)) return full_range();
+
+        bool stays_on_true = loop->contains(branch->true_block);
+        if (stays_on_true == loop->contains(branch->false_block)) return full_range();
+
+        auto compare = static_cast<BinaryInst*>(condition);
+        Opcode op = stays_on_true ? compare->op : negate_compare(compare->op);
+        Value* bound = nullptr;
+        if (compare->left == phi->result) {
+            bound = compare->right;
+        } else if (compare->right == phi->result) {
+            bound = compare->left;
+            // bound < phi is phi > bound
+            switch (op) {
+            case Opcode::Lt: op = Opcode::Gt; break;
+            case Opcode::Le: op = Opcode::Ge; break;
+            case Opcode::Gt: op = Opcode::Lt; break;
+            case Opcode::Ge: op = Opcode::Le; break;
+            default: break;
+            }
+        }
+        if (!bound || !loop->is_invariant(bound)) return full_range();
+
+        Range init = range_of(iv->init, depth + 1, true);
+        Range limit = range_of(bound, depth + 1, true);
+        if (!is_known(init) || !is_known(limit)) return full_range();
+
+        // The update only runs after the test passed, so the variable can overshoot the
+        // bound by at most one step before the loop exits
+        int64_t edge;
+        bool overflow = false;
+        if (iv->step > 0 && (op == Opcode::Lt || op == Opcode::Le)) {
+            overflow |= __builtin_add_overflow(limit.hi, iv->step - (op == Opcode::Lt ? 1 : 0), &edge);
+            return fit_to_type(overflow, init.lo, std::max(init.hi, edge), phi->result->type);
+        }
+        if (iv->step < 0 && (op == Opcode::Gt || op == Opcode::Ge)) {
+            overflow |= __builtin_add_overflow(limit.lo, iv->step + (op == Opcode::Gt ? 1 : 0), &edge);
+            return fit_to_type(overflow, std::min(init.lo, edge), init.hi, phi->result->type);
+        }
+        return full_range();
+    }
+
+} // namespace Fern::HLIR
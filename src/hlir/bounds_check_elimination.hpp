@@ -0,0 +1,65 @@
+// bounds_check_elimination.hpp - Range analysis that removes provably redundant bounds checks
+#pragma once
+
+#include "hlir.hpp"
+#include "loop_analysis.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace Fern::HLIR
+{
+    /**
+     * Removes BoundsCheck instructions whose index is known to lie in [0, length).
+     * Integer ranges come from:
+     * 1. Constants and arithmetic on ranges (add, sub, mul, rem, masks, shifts, casts)
+     * 2. Induction variables, bounded by the loop test that guards every step
+     * 3. Facts that hold at the check: conditions on dominating branches, and the
+     *    checks that already ran before it. Behind a phi these only apply to values
+     *    defined outside every loop, since the phi may hold a loop value from the
+     *    previous iteration.
+     */
+    class BoundsCheckEliminator {
+    public:
+        struct Stats {
+            uint32_t checks = 0;
+            uint32_t removed = 0;
+        };
+
+        // Inclusive integer interval; the full int64 range means nothing is known
+        struct Range {
+            int64_t lo = INT64_MIN;
+            int64_t hi = INT64_MAX;
+        };
+
+    private:
+        struct Fact {
+            Value* value;
+            Range range;
+        };
+
+        const LoopInfo* loop_info = nullptr;
+        std::vector<Fact> facts; // hold at the check currently being examined
+        Stats stats;
+
+        void collect_facts(BoundsCheckInst* check);
+        void add_branch_facts(Value* condition, bool taken);
+        void add_check_facts(BoundsCheckInst* check);
+        bool is_redundant(BoundsCheckInst* check);
+
+        // `through_phi` once the value was reached through a phi's incoming values
+        Range range_of(Value* value, int depth = 0, bool through_phi = false);
+        Range compute_range(Value* value, int depth, bool through_phi);
+        bool is_defined_once(Value* value) const;
+        Range induction_range(PhiInst* phi, int depth);
+        bool collect_phi_sources(PhiInst* phi, std::vector<Value*>& sources);
+
+    public:
+        BoundsCheckEliminator() = default;
+
+        void run(Module* module);
+        void run(Function* func);
+
+        const Stats& get_stats() const { return stats; }
+    };
+
+} // namespace Fern::HLIR
@@ -0,0 +1,881 @@
+// const_eval.cpp
+#include "const_eval.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace Fern::HLIR
+{
+    namespace {
+
+    // Thrown to abandon an evaluation or a fold; whatever it was working on is left for run time
+    struct Abandoned {};
+
+    enum class CellKind : uint8_t {
+        Undef,
+        Int,
+        Float,
+        Pointer,
+    };
+
+    // One scalar of interpreter state. Integers are kept zero-extended from their width,
+    // floats as the bits of a double (f32 results are rounded to float), and pointers as
+    // an object plus a cell offset into it
+    struct Cell {
+        CellKind kind = CellKind::Undef;
+        uint64_t bits = 0;
+        uint32_t object = 0; // 0 is null
+        uint32_t offset = 0;
+    };
+
+    } // namespace
+
+    // Every scalar takes one cell; the memory limit counts a cell as 8 bytes
+    static constexpr uint64_t CELL_BYTES = 8;
+
+    static const PrimitiveType* primitive(const TypePtr& type) {
+        return type ? type->as<PrimitiveType>() : nullptr;
+    }
+
+    static TypePtr strip_pointer(const TypePtr& type) {
+        auto ptr = type ? type->as<PointerType>() : nullptr;
+        return ptr ? ptr->pointee : type;
+    }
+
+    static bool is_float_type(const TypePtr& type) {
+        auto prim = primitive(type);
+        return prim && (prim->kind == PrimitiveKind::F32 || prim->kind == PrimitiveKind::F64);
+    }
+
+    static bool is_signed_type(const TypePtr& type) {
+        auto prim = primitive(type);
+        return prim && (prim->kind == PrimitiveKind::I8 || prim->kind == PrimitiveKind::I16 ||
+                        prim->kind == PrimitiveKind::I32 || prim->kind == PrimitiveKind::I64);
+    }
+
+    // Scalars a fold can turn back into a constant instruction
+    static bool is_foldable_type(const TypePtr& type) {
+        auto prim = primitive(type);
+        return prim && prim->kind != PrimitiveKind::Void;
+    }
+
+    // Same widths HLIRCodeGen gives the LLVM types
+    static uint32_t bit_width(const TypePtr& type) {
+        auto prim = primitive(type);
+        if (!prim) throw Abandoned{};
+        switch (prim->kind) {
+            case PrimitiveKind::Bool: return 1;
+            case PrimitiveKind::Char:
+            case PrimitiveKind::I8:
+            case PrimitiveKind::U8: return 8;
+            case PrimitiveKind::I16:
+            case PrimitiveKind::U16: return 16;
+            case PrimitiveKind::I32:
+            case PrimitiveKind::U32:
+            case PrimitiveKind::F32: return 32;
+            case PrimitiveKind::I64:
+            case PrimitiveKind::U64:
+            case PrimitiveKind::F64: return 64;
+            default: throw Abandoned{};
+        }
+    }
+
+    static uint64_t truncate(uint64_t bits, uint32_t width) {
+        return width >= 64 ? bits : bits & ((uint64_t(1) << width) - 1);
+    }
+
+    static int64_t sign_extend(uint64_t bits, uint32_t width) {
+        if (width >= 64) return static_cast<int64_t>(bits);
+        uint64_t sign = uint64_t(1) << (width - 1);
+        return static_cast<int64_t>((truncate(bits, width) ^ sign) - sign);
+    }
+
+    static Cell int_cell(uint64_t bits, uint32_t width) {
+        Cell cell;
+        cell.kind = CellKind::Int;
+        cell.bits = truncate(bits, width);
+        return cell;
+    }
+
+    static Cell float_cell(double value, bool single) {
+        if (single) value = static_cast<double>(static_cast<float>(value));
+        Cell cell;
+        cell.kind = CellKind::Float;
+        std::memcpy(&cell.bits, &value, sizeof(value));
+        return cell;
+    }
+
+    static double to_double(uint64_t bits) {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    static const Cell& expect(const Cell& cell, CellKind kind) {
+        if (cell.kind != kind) throw Abandoned{};
+        return cell;
+    }
+
+    // The value of a constant instruction, or false when `value` isn't one
+    static bool constant_cell(Value* value, Cell& out) {
+        if (!value->def || !is_foldable_type(value->type)) return false;
+        switch (value->def->op) {
+            case Opcode::ConstInt:
+                if (is_float_type(value->type)) return false;
+                out = int_cell(static_cast<uint64_t>(static_cast<ConstIntInst*>(value->def)->value), bit_width(value->type));
+                return true;
+            case Opcode::ConstFloat:
+                if (!is_float_type(value->type)) return false;
+                out = float_cell(static_cast<ConstFloatInst*>(value->def)->value,
+                                 primitive(value->type)->kind == PrimitiveKind::F32);
+                return true;
+            case Opcode::ConstBool:
+                out = int_cell(static_cast<ConstBoolInst*>(value->def)->value ? 1 : 0, 1);
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    #pragma region Arithmetic
+
+    // Everything here follows HLIRCodeGen: wrapping integer arithmetic, signedness from the
+    // operand type, ordered float comparisons. What LLVM leaves undefined or traps on
+    // abandons the fold instead of picking an answer
+
+    static Cell eval_binary(Opcode op, const TypePtr& type, const Cell& left, const Cell& right) {
+        if (is_float_type(type)) {
+            bool single = primitive(type)->kind == PrimitiveKind::F32;
+            double a = to_double(expect(left, CellKind::Float).bits);
+            double b = to_double(expect(right, CellKind::Float).bits);
+            switch (op) {
+                case Opcode::Add: return float_cell(a + b, single);
+                case Opcode::Sub: return float_cell(a - b, single);
+                case Opcode::Mul: return float_cell(a * b, single);
+                case Opcode::Div: return float_cell(a / b, single);
+                case Opcode::Rem: return float_cell(std::fmod(a, b), single);
+                case Opcode::Eq: return int_cell(a == b, 1);
+                case Opcode::Ne: return int_cell(a < b || a > b, 1);
+                case Opcode::Lt: return int_cell(a < b, 1);
+                case Opcode::Le: return int_cell(a <= b, 1);
+                case Opcode::Gt: return int_cell(a > b, 1);
+                case Opcode::Ge: return int_cell(a >= b, 1);
+                default: throw Abandoned{};
+            }
+        }
+
+        uint32_t width = bit_width(type);
+        bool is_signed = is_signed_type(type);
+        uint64_t a = expect(left, CellKind::Int).bits;
+        uint64_t b = expect(right, CellKind::Int).bits;
+        int64_t sa = sign_extend(a, width);
+        int64_t sb = sign_extend(b, width);
+
+        switch (op) {
+            case Opcode::Add: return int_cell(a + b, width);
+            case Opcode::Sub: return int_cell(a - b, width);
+            case Opcode::Mul: return int_cell(a * b, width);
+            case Opcode::Div:
+            case Opcode::Rem:
+                if (b == 0) throw Abandoned{};
+                if (is_signed) {
+                    if (sb == -1 && sa == sign_extend(uint64_t(1) << (width - 1), width)) throw Abandoned{};
+                    return int_cell(static_cast<uint64_t>(op == Opcode::Div ? sa / sb : sa % sb), width);
+                }
+                return int_cell(op == Opcode::Div ? a / b : a % b, width);
+            case Opcode::Eq: return int_cell(a == b, 1);
+            case Opcode::Ne: return int_cell(a != b, 1);
+            case Opcode::Lt: return int_cell(is_signed ? sa < sb : a < b, 1);
+            case Opcode::Le: return int_cell(is_signed ? sa <= sb : a <= b, 1);
+            case Opcode::Gt: return int_cell(is_signed ? sa > sb : a > b, 1);
+            case Opcode::Ge: return int_cell(is_signed ? sa >= sb : a >= b, 1);
+            case Opcode::And:
+            case Opcode::BitAnd: return int_cell(a & b, width);
+            case Opcode::Or:
+            case Opcode::BitOr: return int_cell(a | b, width);
+            case Opcode::BitXor: return int_cell(a ^ b, width);
+            case Opcode::Shl:
+            case Opcode::Shr:
+                // Shifting by the width or more is poison
+                if (b >= width) throw Abandoned{};
+                if (op == Opcode::Shl) return int_cell(a << b, width);
+                return int_cell(is_signed ? static_cast<uint64_t>(sa >> b) : a >> b, width);
+            default:
+                throw Abandoned{};
+        }
+    }
+
+    static Cell eval_unary(Opcode op, const TypePtr& type, const Cell& operand) {
+        if (is_float_type(type)) {
+            if (op != Opcode::Neg) throw Abandoned{};
+            return float_cell(-to_double(expect(operand, CellKind::Float).bits),
+                              primitive(type)->kind == PrimitiveKind::F32);
+        }
+
+        uint32_t width = bit_width(type);
+        uint64_t a = expect(operand, CellKind::Int).bits;
+        return op == Opcode::Neg ? int_cell(0 - a, width) : int_cell(~a, width);
+    }
+
+    static Cell eval_cast(const TypePtr& from, const TypePtr& to, const Cell& value) {
+        if (!is_foldable_type(from) || !is_foldable_type(to)) throw Abandoned{};
+        bool single = primitive(to)->kind == PrimitiveKind::F32;
+
+        if (is_float_type(from)) {
+            double v = to_double(expect(value, CellKind::Float).bits);
+            if (is_float_type(to)) return float_cell(v, single);
+
+            // Converting a float that doesn't fit the integer type is poison
+            uint32_t width = bit_width(to);
+            if (std::isnan(v)) throw Abandoned{};
+            double t = std::trunc(v);
+            if (is_signed_type(to)) {
+                double limit = std::ldexp(1.0, width - 1);
+                if (t < -limit || t >= limit) throw Abandoned{};
+                return int_cell(static_cast<uint64_t>(static_cast<int64_t>(t)), width);
+            }
+            if (t < 0 || t >= std::ldexp(1.0, width)) throw Abandoned{};
+            return int_cell(static_cast<uint64_t>(t), width);
+        }
+
+        uint32_t source_width = bit_width(from);
+        uint64_t bits = expect(value, CellKind::Int).bits;
+        bool source_signed = is_signed_type(from);
+        if (is_float_type(to)) {
+            // Round straight to the target type; going through double could round twice
+            if (single) {
+                float f = source_signed ? static_cast<float>(sign_extend(bits, source_width))
+                                        : static_cast<float>(bits);
+                return float_cell(f, true);
+            }
+            return float_cell(source_signed ? static_cast<double>(sign_extend(bits, source_width))
+                                            : static_cast<double>(bits), false);
+        }
+        return int_cell(source_signed ? static_cast<uint64_t>(sign_extend(bits, source_width)) : bits, bit_width(to));
+    }
+
+    #pragma region Interpreter
+
+    namespace {
+
+    /**
+     * Runs HLIR directly, one instruction at a time. Memory is a set of objects of cells
+     * laid out from the HLIR types, so an evaluation can only ever touch what it
+     * allocated itself, and any access outside an object abandons it
+     */
+    class Machine {
+    public:
+        uint64_t steps = 0;
+
+        Machine(const ConstEvaluator::Limits& limits, const std::unordered_set<Function*>& pure, uint64_t step_budget)
+            : limits(limits), pure(pure), step_budget(step_budget) {}
+
+        Cell call(Function* func, const std::vector<Cell>& args) {
+            Frame frame = make_frame(func);
+            for (size_t i = 0; i < args.size(); i++) {
+                frame.cells[func->params[i]->id] = args[i];
+            }
+            run(func, frame);
+            return frame.result;
+        }
+
+    private:
+        struct Object {
+            std::vector<Cell> cells;
+            bool live = true;
+        };
+
+        struct Frame {
+            std::vector<Cell> cells;                   // by value id
+            std::vector<std::vector<Cell>> aggregates; // struct and array values, by value id
+            std::vector<uint32_t> stack_objects;       // released when the call returns
+            Cell result;
+            std::vector<Cell> result_aggregate;
+        };
+
+        const ConstEvaluator::Limits& limits;
+        const std::unordered_set<Function*>& pure;
+        uint64_t step_budget;
+
+        std::vector<Object> objects; // an object's id is its index + 1
+        uint64_t memory = 0;
+        uint32_t depth = 0;
+        std::unordered_map<TypeSymbol*, std::vector<uint32_t>> layouts;
+
+        Frame make_frame(Function* func) {
+            Frame frame;
+            frame.cells.resize(func->values.size());
+            frame.aggregates.resize(func->values.size());
+            return frame;
+        }
+
+        // Cell offset of each field in declaration order, then the struct's total size.
+        // Fields are the same members HLIRCodeGen puts in the LLVM struct
+        const std::vector<uint32_t>& layout(TypeSymbol* symbol) {
+            if (!symbol) throw Abandoned{};
+            auto it = layouts.find(symbol);
+            if (it != layouts.end()) return it->second;
+
+            std::vector<uint32_t> offsets;
+            uint64_t total = 0;
+            for (const auto& member : symbol->member_order) {
+                if (auto var = member->as<VariableSymbol>()) {
+                    offsets.push_back(static_cast<uint32_t>(total));
+                    total += cell_count(var->type);
+                    if (total > UINT32_MAX) throw Abandoned{};
+                }
+            }
+            offsets.push_back(static_cast<uint32_t>(total));
+            return layouts[symbol] = std::move(offsets);
+        }
+
+        static bool is_aggregate(const TypePtr& type) {
+            if (auto array = type->as<ArrayType>()) return array->size >= 0;
+            return type->is<NamedType>() && type->is_value_type();
+        }
+
+        uint64_t cell_count(const TypePtr& type) {
+            if (!type) throw Abandoned{};
+            if (type->is<PrimitiveType>() || type->is<PointerType>()) return 1;
+            if (auto named = type->as<NamedType>()) {
+                return type->is_value_type() ? layout(named->symbol).back() : 1; // references are pointers
+            }
+            if (auto array = type->as<ArrayType>(); array && array->size >= 0) {
+                uint64_t count = static_cast<uint64_t>(array->size) * cell_count(array->element);
+                if (count > UINT32_MAX) throw Abandoned{};
+                return count;
+            }
+            // Dynamic arrays and vectors never get here from code the evaluator accepts
+            throw Abandoned{};
+        }
+
+        uint32_t allocate(uint64_t cells) {
+            memory += std::max<uint64_t>(cells, 1) * CELL_BYTES;
+            if (memory > limits.max_memory_bytes) throw Abandoned{};
+            objects.push_back(Object{std::vector<Cell>(cells), true});
+            return static_cast<uint32_t>(objects.size());
+        }
+
+        void release(uint32_t id) {
+            Object& object = objects[id - 1];
+            memory -= std::max<uint64_t>(object.cells.size(), 1) * CELL_BYTES;
+            object.cells = {};
+            object.live = false;
+        }
+
+        // The cells an address points at, checked against the bounds of its object
+        Cell* resolve(const Cell& address, uint64_t count) {
+            if (address.kind != CellKind::Pointer || address.object == 0) throw Abandoned{};
+            Object& object = objects[address.object - 1];
+            if (!object.live || address.offset + count > object.cells.size()) throw Abandoned{};
+            return object.cells.data() + address.offset;
+        }
+
+        int64_t index_of(Value* index, const Frame& frame) {
+            uint64_t bits = expect(frame.cells[index->id], CellKind::Int).bits;
+            return is_signed_type(index->type) ? sign_extend(bits, bit_width(index->type))
+                                               : static_cast<int64_t>(bits);
+        }
+
+        static void copy_value(const Frame& from, Value* source, Frame& to, Value* dest) {
+            to.cells[dest->id] = from.cells[source->id];
+            to.aggregates[dest->id] = from.aggregates[source->id];
+        }
+
+        // Phis read their incoming values in parallel, before any of them is written
+        size_t enter_block(BasicBlock* block, BasicBlock* previous, Frame& frame) {
+            size_t count = 0;
+            while (count < block->instructions.size() && block->instructions[count]->op == Opcode::Phi) {
+                count++;
+            }
+            if (count == 0) return 0;
+            if (!previous) throw Abandoned{};
+
+            std::vector<Cell> cells(count);
+            std::vector<std::vector<Cell>> aggregates(count);
+            for (size_t i = 0; i < count; i++) {
+                auto phi = static_cast<PhiInst*>(block->instructions[i]);
+                auto incoming = std::find_if(phi->incoming.begin(), phi->incoming.end(),
+                                             [&](const auto& entry) { return entry.second == previous; });
+                if (incoming == phi->incoming.end()) throw Abandoned{};
+                cells[i] = frame.cells[incoming->first->id];
+                aggregates[i] = frame.aggregates[incoming->first->id];
+            }
+            for (size_t i = 0; i < count; i++) {
+                Value* result = block->instructions[i]->result;
+                frame.cells[result->id] = cells[i];
+                frame.aggregates[result->id] = std::move(aggregates[i]);
+            }
+            steps += count;
+            return count;
+        }
+
+        void run(Function* func, Frame& frame) {
+            if (++depth > limits.max_call_depth) throw Abandoned{};
+
+            BasicBlock* block = func->entry;
+            BasicBlock* previous = nullptr;
+            while (block) {
+                size_t start = enter_block(block, previous, frame);
+                BasicBlock* next = nullptr;
+
+                for (size_t i = start; i < block->instructions.size() && !next; i++) {
+                    if (++steps > step_budget) throw Abandoned{};
+                    Instruction* inst = block->instructions[i];
+
+                    if (is_binary_op(inst->op)) {
+                        auto bin = static_cast<BinaryInst*>(inst);
+                        frame.cells[inst->result->id] = eval_binary(inst->op, bin->left->type,
+                                                                    frame.cells[bin->left->id], frame.cells[bin->right->id]);
+                        continue;
+                    }
+                    if (is_unary_op(inst->op)) {
+                        auto un = static_cast<UnaryInst*>(inst);
+                        frame.cells[inst->result->id] = eval_unary(inst->op, un->operand->type, frame.cells[un->operand->id]);
+                        continue;
+                    }
+
+                    switch (inst->op) {
+                        case Opcode::ConstInt:
+                        case Opcode::ConstFloat:
+                        case Opcode::ConstBool:
+                            if (!constant_cell(inst->result, frame.cells[inst->result->id])) throw Abandoned{};
+                            break;
+
+                        case Opcode::Cast: {
+                            auto cast = static_cast<CastInst*>(inst);
+                            frame.cells[inst->result->id] = eval_cast(cast->value->type, cast->target_type,
+                                                                      frame.cells[cast->value->id]);
+                            break;
+                        }
+
+                        case Opcode::Alloc: {
+                            auto alloc = static_cast<AllocInst*>(inst);
+                            auto named = alloc->alloc_type->as<NamedType>();
+                            uint32_t id = allocate(named ? layout(named->symbol).back() : cell_count(alloc->alloc_type));
+                            if (alloc->on_stack) frame.stack_objects.push_back(id);
+
+                            auto& cells = objects[id - 1].cells;
+                            for (size_t e = 0; e < alloc->initializer.size() && e < cells.size(); e++) {
+                                cells[e] = frame.cells[alloc->initializer[e]->id];
+                            }
+
+                            Cell pointer;
+                            pointer.kind = CellKind::Pointer;
+                            pointer.object = id;
+                            frame.cells[inst->result->id] = pointer;
+                            break;
+                        }
+
+                        case Opcode::Load: {
+                            auto load = static_cast<LoadInst*>(inst);
+                            const Cell& address = frame.cells[load->address->id];
+                            if (is_aggregate(inst->result->type)) {
+                                uint64_t count = cell_count(inst->result->type);
+                                Cell* cells = resolve(address, count);
+                                frame.aggregates[inst->result->id].assign(cells, cells + count);
+                            }
+                            else {
+                                frame.cells[inst->result->id] = *resolve(address, 1);
+                            }
+                            break;
+                        }
+
+                        case Opcode::Store: {
+                            auto store = static_cast<StoreInst*>(inst);
+                            const Cell& address = frame.cells[store->address->id];
+                            if (is_aggregate(store->value->type)) {
+                                const auto& value = frame.aggregates[store->value->id];
+                                if (value.size() != cell_count(store->value->type)) throw Abandoned{};
+                                std::copy(value.begin(), value.end(), resolve(address, value.size()));
+                            }
+                            else {
+                                *resolve(address, 1) = frame.cells[store->value->id];
+                            }
+                            break;
+                        }
+
+                        case Opcode::FieldAddr: {
+                            auto field = static_cast<FieldAddrInst*>(inst);
+                            auto named = strip_pointer(field->object->type)->as<NamedType>();
+                            if (!named) throw Abandoned{};
+                            const auto& offsets = layout(named->symbol);
+                            if (field->field_index + 1 >= offsets.size()) throw Abandoned{};
+
+                            Cell address = expect(frame.cells[field->object->id], CellKind::Pointer);
+                            address.offset += offsets[field->field_index];
+                            frame.cells[inst->result->id] = address;
+                            break;
+                        }
+
+                        case Opcode::ElementAddr: {
+                            auto elem = static_cast<ElementAddrInst*>(inst);
+                            // A dynamic array's data lives outside anything the evaluation allocated
+                            auto array = strip_pointer(elem->array->type)->as<ArrayType>();
+                            if (array && array->size < 0) throw Abandoned{};
+
+                            int64_t index = index_of(elem->index, frame);
+                            int64_t stride = static_cast<int64_t>(cell_count(strip_pointer(elem->result->type)));
+                            if (index < INT32_MIN || index > INT32_MAX) throw Abandoned{};
+
+                            Cell address = expect(frame.cells[elem->array->id], CellKind::Pointer);
+                            int64_t offset = static_cast<int64_t>(address.offset) + index * stride;
+                            if (offset < 0 || offset > UINT32_MAX) throw Abandoned{};
+                            address.offset = static_cast<uint32_t>(offset);
+                            frame.cells[inst->result->id] = address;
+                            break;
+                        }
+
+                        case Opcode::BoundsCheck: {
+                            // A failing check traps at run time; leave it to do that
+                            auto check = static_cast<BoundsCheckInst*>(inst);
+                            int64_t index = index_of(check->index, frame);
+                            int64_t length = index_of(check->length, frame);
+                            if (index < 0 || index >= length) throw Abandoned{};
+                            break;
+                        }
+
+                        case Opcode::Call: {
+                            auto call = static_cast<CallInst*>(inst);
+                            Function* callee = call->callee;
+                            if (!pure.count(callee) || callee->params.size() != call->args.size()) throw Abandoned{};
+
+                            Frame callee_frame = make_frame(callee);
+                            for (size_t a = 0; a < call->args.size(); a++) {
+                                copy_value(frame, call->args[a], callee_frame, callee->params[a]);
+                            }
+                            run(callee, callee_frame);
+                            if (inst->result) {
+                                frame.cells[inst->result->id] = callee_frame.result;
+                                frame.aggregates[inst->result->id] = std::move(callee_frame.result_aggregate);
+                            }
+                            break;
+                        }
+
+                        case Opcode::Ret: {
+                            auto ret = static_cast<RetInst*>(inst);
+                            if (ret->value) {
+                                frame.result = frame.cells[ret->value->id];
+                                frame.result_aggregate = std::move(frame.aggregates[ret->value->id]);
+                            }
+                            for (uint32_t id : frame.stack_objects) {
+                                release(id);
+                            }
+                            depth--;
+                            return;
+                        }
+
+                        case Opcode::Br:
+                            next = static_cast<BrInst*>(inst)->target;
+                            break;
+
+                        case Opcode::CondBr: {
+                            auto br = static_cast<CondBrInst*>(inst);
+                            next = expect(frame.cells[br->condition->id], CellKind::Int).bits ? br->true_block : br->false_block;
+                            break;
+                        }
+
+                        // Strings, bitcasts, vectors and switches are left for run time
+                        default:
+                            throw Abandoned{};
+                    }
+                }
+
+                // A block that ends without a terminator has nowhere to go
+                if (!next) throw Abandoned{};
+                previous = block;
+                block = next;
+            }
+            throw Abandoned{};
+        }
+    };
+
+    } // namespace
+
+    #pragma region Purity
+
+    bool ConstEvaluator::is_pure_body(Function* func) {
+        for (const auto& block : func->blocks) {
+            for (auto inst : block->instructions) {
+                switch (inst->op) {
+                    case Opcode::Call:
+                        if (!pure.count(static_cast<CallInst*>(inst)->callee)) return false;
+                        break;
+                    case Opcode::Store: {
+                        // Only through memory it allocated or was handed as a parameter
+                        Value* root = address_root(static_cast<StoreInst*>(inst)->address);
+                        if (root->def && root->def->op != Opcode::Alloc) return false;
+                        break;
+                    }
+                    case Opcode::ConstString:
+                    case Opcode::ConstNull:
+                    case Opcode::Bitcast:
+                    case Opcode::Switch:
+                    case Opcode::Copy:
+                        return false;
+                    default:
+                        if (is_vector_op(inst->op)) return false;
+                        break;
+                }
+            }
+        }
+        return true;
+    }
+
+    void ConstEvaluator::find_pure_functions(Module* module) {
+        // Optimistic: everything with a body starts out pure and loses it when it calls
+        // something that isn't, so mutually recursive pure functions stay pure
+        for (const auto& func : module->functions) {
+            if (!func->is_external && func->entry) pure.insert(func.get());
+        }
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (const auto& func : module->functions) {
+                if (pure.count(func.get()) && !is_pure_body(func.get())) {
+                    pure.erase(func.get());
+                    changed = true;
+                }
+            }
+        }
+        stats.pure_functions = static_cast<uint32_t>(pure.size());
+    }
+
+    #pragma region Folding
+
+    void ConstEvaluator::run(Module* module) {
+        std::vector<Function*> functions;
+        for (const auto& func : module->functions) {
+            functions.push_back(func.get());
+        }
+        run(module, functions);
+    }
+
+    void ConstEvaluator::run(Module* module, const std::vector<Function*>& functions) {
+        find_pure_functions(module);
+        for (auto func : functions) {
+            if (func->is_external || !func->entry) continue;
+            fold_constants(func);
+            fold_tables(func);
+        }
+    }
+
+    void ConstEvaluator::fold_constants(Function* func) {
+        for (const auto& block : func->blocks) {
+            // Folding removes the instruction from the block, so walk a copy
+            std::vector<Instruction*> instructions = block->instructions;
+            for (auto inst : instructions) {
+                if (inst->op == Opcode::Call) {
+                    fold_call(static_cast<CallInst*>(inst));
+                }
+                else if (is_binary_op(inst->op) || is_unary_op(inst->op) || inst->op == Opcode::Cast) {
+                    fold_instruction(inst);
+                }
+            }
+        }
+    }
+
+    bool ConstEvaluator::fold_call(CallInst* call) {
+        Function* callee = call->callee;
+        if (!call->result || !pure.count(callee) || !is_foldable_type(call->result->type) ||
+            callee->params.size() != call->args.size()) {
+            return false;
+        }
+
+        std::vector<Cell> args;
+        std::vector<uint64_t> key;
+        for (size_t i = 0; i < call->args.size(); i++) {
+            auto param = primitive(callee->params[i]->type);
+            auto arg = primitive(call->args[i]->type);
+            Cell cell;
+            if (!param || !arg || param->kind != arg->kind || !constant_cell(call->args[i], cell)) return false;
+            args.push_back(cell);
+            key.push_back(cell.bits);
+        }
+
+        auto [entry, inserted] = results.try_emplace({callee, std::move(key)});
+        if (inserted && stats.steps < limits.max_total_steps) {
+            Machine machine(limits, pure, std::min(limits.max_steps, limits.max_total_steps - stats.steps));
+            try {
+                Cell result = machine.call(callee, args);
+                CellKind expected = is_float_type(call->result->type) ? CellKind::Float : CellKind::Int;
+                if (result.kind == expected) entry->second = result.bits;
+            }
+            catch (const Abandoned&) {
+            }
+            stats.steps += machine.steps;
+        }
+
+        if (!entry->second) {
+            stats.calls_abandoned++;
+            return false;
+        }
+        replace_with_constant(call, *entry->second);
+        stats.calls_folded++;
+        return true;
+    }
+
+    bool ConstEvaluator::fold_instruction(Instruction* inst) {
+        if (!is_foldable_type(inst->result->type)) return false;
+
+        Cell result;
+        try {
+            if (inst->op == Opcode::Cast) {
+                auto cast = static_cast<CastInst*>(inst);
+                Cell value;
+                if (!constant_cell(cast->value, value)) return false;
+                result = eval_cast(cast->value->type, cast->target_type, value);
+            }
+            else if (is_unary_op(inst->op)) {
+                auto un = static_cast<UnaryInst*>(inst);
+                Cell operand;
+                if (!constant_cell(un->operand, operand)) return false;
+                result = eval_unary(inst->op, un->operand->type, operand);
+            }
+            else {
+                auto bin = static_cast<BinaryInst*>(inst);
+                Cell left, right;
+                if (!constant_cell(bin->left, left) || !constant_cell(bin->right, right)) return false;
+                result = eval_binary(inst->op, bin->left->type, left, right);
+            }
+        }
+        catch (const Abandoned&) {
+            return false;
+        }
+
+        if ((result.kind == CellKind::Float) != is_float_type(inst->result->type)) return false;
+        replace_with_constant(inst, result.bits);
+        stats.instructions_folded++;
+        return true;
+    }
+
+    void ConstEvaluator::replace_with_constant(Instruction* inst, uint64_t bits) {
+        BasicBlock* block = inst->parent;
+        Function* func = block->parent;
+        TypePtr type = inst->result->type;
+        auto kind = primitive(type)->kind;
+
+        Value* value = func->create_value(type);
+        Instruction* constant;
+        if (kind == PrimitiveKind::Bool) {
+            constant = func->make_inst<ConstBoolInst>(value, bits != 0);
+        }
+        else if (kind == PrimitiveKind::F32 || kind == PrimitiveKind::F64) {
+            constant = func->make_inst<ConstFloatInst>(value, to_double(bits));
+        }
+        else {
+            int64_t number = is_signed_type(type) ? sign_extend(bits, bit_width(type)) : static_cast<int64_t>(bits);
+            constant = func->make_inst<ConstIntInst>(value, number);
+        }
+        value->def = constant;
+        constant->debug_line = inst->debug_line;
+
+        auto position = std::find(block->instructions.begin(), block->instructions.end(), inst);
+        block->insert_inst(position - block->instructions.begin(), constant);
+
+        replace_all_uses(inst->result, value);
+        inst->result->def = nullptr;
+        func->drop_uses(inst);
+        block->remove_inst(inst);
+    }
+
+    #pragma region Constant Tables
+
+    void ConstEvaluator::fold_tables(Function* func) {
+        for (const auto& block : func->blocks) {
+            std::vector<AllocInst*> allocs;
+            for (auto inst : block->instructions) {
+                if (inst->op == Opcode::Alloc) allocs.push_back(static_cast<AllocInst*>(inst));
+            }
+
+            for (auto alloc : allocs) {
+                auto array = alloc->alloc_type->as<ArrayType>();
+                if (!alloc->on_stack || !alloc->initializer.empty() || !array || array->size <= 0 ||
+                    !is_foldable_type(array->element)) {
+                    continue;
+                }
+                auto element_kind = primitive(array->element)->kind;
+
+                // Every use must be an element address that is either stored to exactly once
+                // with a constant, by the code that fills the array, or only ever loaded from
+                std::vector<StoreInst*> stores(array->size, nullptr);
+                std::vector<ElementAddrInst*> reads;
+                bool table = true;
+                for (Use* use = alloc->result->first_use; use && table; use = use->next) {
+                    if (use->user->op != Opcode::ElementAddr) {
+                        table = false;
+                        break;
+                    }
+                    auto elem = static_cast<ElementAddrInst*>(use->user);
+                    if (elem->array != alloc->result || elem->index == alloc->result || !elem->result->first_use) {
+                        table = false;
+                        break;
+                    }
+
+                    auto first = elem->result->first_use->user;
+                    if (first->op == Opcode::Store) {
+                        auto store = static_cast<StoreInst*>(first);
+                        int64_t index = -1;
+                        if (elem->index->def && elem->index->def->op == Opcode::ConstInt) {
+                            index = static_cast<ConstIntInst*>(elem->index->def)->value;
+                        }
+                        auto value_type = primitive(store->value->type);
+                        table = elem->result->use_count == 1 && store->address == elem->result &&
+                                store->parent == alloc->parent && index >= 0 && index < array->size &&
+                                !stores[index] && value_type && value_type->kind == element_kind &&
+                                store->value->def && (store->value->def->op == Opcode::ConstInt ||
+                                                      store->value->def->op == Opcode::ConstFloat ||
+                                                      store->value->def->op == Opcode::ConstBool);
+                        if (table) stores[index] = store;
+                    }
+                    else {
+                        for (Use* read = elem->result->first_use; read && table; read = read->next) {
+                            table = read->user->op == Opcode::Load;
+                        }
+                        reads.push_back(elem);
+                    }
+                }
+                if (!table || std::find(stores.begin(), stores.end(), nullptr) != stores.end()) continue;
+
+                // Reads in the alloc's own block have to come after the array is filled; other
+                // blocks can only run once this one has run to its end
+                auto position = [&](Instruction* inst) {
+                    return std::find(block->instructions.begin(), block->instructions.end(), inst) - block->instructions.begin();
+                };
+                ptrdiff_t filled = 0;
+                for (auto store : stores) filled = std::max(filled, position(store));
+                for (auto elem : reads) {
+                    for (Use* read = elem->result->first_use; read && table; read = read->next) {
+                        table = read->user->parent != block.get() || position(read->user) > filled;
+                    }
+                }
+                if (!table) continue;
+
+                // The constants move up so they're defined before the table that holds them
+                for (auto store : stores) {
+                    Value* value = store->value;
+                    if (value->def->parent == block.get() && position(value->def) > position(alloc)) {
+                        block->remove_inst(value->def);
+                        block->insert_inst(position(alloc), value->def);
+                    }
+                    alloc->initializer.push_back(value);
+                    func->add_use(value, alloc);
+                }
+
+                for (auto store : stores) {
+                    auto elem = static_cast<ElementAddrInst*>(store->address->def);
+                    func->drop_uses(store);
+                    block->remove_inst(store);
+                    elem->result->def = nullptr;
+                    func->drop_uses(elem);
+                    block->remove_inst(elem);
+                }
+                stats.tables_folded++;
+            }
+        }
+    }
+
+} // namespace Fern::HLIR
@@ -0,0 +1,77 @@
+// const_eval.hpp - Compile-time evaluation of pure functions and constant tables
+#pragma once
+
+#include "hlir.hpp"
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace Fern::HLIR
+{
+    /**
+     * Runs over the module after BoundToHLIR, before the other HLIR passes:
+     * 1. Find the pure functions: ones with a body that only call pure functions and
+     *    only store through memory they allocated or were handed as a parameter
+     * 2. Run each call to a pure function whose arguments are all constants on an
+     *    HLIR interpreter, and replace the call with the scalar it returned
+     * 3. Fold arithmetic, comparisons and casts whose operands are constants, so the
+     *    results of folded calls keep folding into their users
+     * 4. Turn local arrays that are filled with constants and then only read into
+     *    constant tables, which code generation emits as read-only globals
+     * An evaluation that would trap, read memory it didn't allocate or run past the
+     * limits is abandoned and the call is left for run time.
+     */
+    class ConstEvaluator {
+    public:
+        struct Limits {
+            uint64_t max_steps = 4'000'000;               // instructions per folded call
+            uint64_t max_total_steps = 64'000'000;        // across the module, so compile time stays bounded
+            uint64_t max_memory_bytes = 16 * 1024 * 1024; // live allocations per folded call
+            uint32_t max_call_depth = 1024;
+        };
+
+        struct Stats {
+            uint32_t pure_functions = 0;
+            uint32_t calls_folded = 0;
+            uint32_t calls_abandoned = 0;
+            uint32_t instructions_folded = 0;
+            uint32_t tables_folded = 0;
+            uint64_t steps = 0;
+        };
+
+    private:
+        Limits limits;
+        Stats stats;
+        std::unordered_set<Function*> pure;
+
+        // Outcome of each evaluated call by callee and argument bits, failures included,
+        // so the same call written twice is only run once
+        std::map<std::pair<Function*, std::vector<uint64_t>>, std::optional<uint64_t>> results;
+
+        void find_pure_functions(Module* module);
+        bool is_pure_body(Function* func);
+
+        void fold_constants(Function* func);
+        bool fold_call(CallInst* call);
+        bool fold_instruction(Instruction* inst);
+        void fold_tables(Function* func);
+
+        // Replace `inst`'s result with a constant of the same type, inserted just before it
+        void replace_with_constant(Instruction* inst, uint64_t bits);
+
+    public:
+        ConstEvaluator() = default;
+        explicit ConstEvaluator(const Limits& limits) : limits(limits) {}
+
+        void run(Module* module);
+
+        // Only rewrite `functions`; the rest of the module is still read to find pure callees
+        void run(Module* module, const std::vector<Function*>& functions);
+
+        const Stats& get_stats() const { return stats; }
+    };
+
+} // namespace Fern::HLIR
@@ -1,15 +1,19 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
+#include <string_view>
 #include <variant>
 #include <unordered_map>
+#include <unordered_set>
 #include "semantic/type.hpp"
 #include "semantic/symbol.hpp"
 #include <set>
 #include <sstream>
+#include "hlir_arena.hpp"
 
 namespace Fern::HLIR
 {
@@ -25,15 +29,61 @@ namespace Fern::HLIR
 
 #pragma region SSA Value
 
+    // One operand slot reading a value. The links live in the node itself, so a value's
+    // users are found without a side table and a use moves between values without allocating
+    struct Use
+    {
+        Instruction *user;
+        Use *prev = nullptr;
+        Use *next = nullptr;
+
+        Use(Instruction *user) : user(user) {}
+    };
+
     struct Value
     {
         uint32_t id;
         TypePtr type;
         Instruction *def = nullptr;
-        std::vector<Instruction *> uses;
-        std::string debug_name;
+        Use *first_use = nullptr;
+        uint32_t use_count = 0;
+        std::string_view debug_name; // interned in the owning function's arena
 
         Value(uint32_t id, TypePtr type) : id(id), type(type) {}
+
+        bool has_uses() const { return first_use != nullptr; }
+
+        void link_use(Use *use)
+        {
+            use->prev = nullptr;
+            use->next = first_use;
+            if (first_use)
+                first_use->prev = use;
+            first_use = use;
+            use_count++;
+        }
+
+        void unlink_use(Use *use)
+        {
+            if (use->prev)
+                use->prev->next = use->next;
+            else
+                first_use = use->next;
+            if (use->next)
+                use->next->prev = use->prev;
+            use->prev = use->next = nullptr;
+            use_count--;
+        }
+
+        Use *find_use(Instruction *user) const
+        {
+            for (Use *use = first_use; use; use = use->next)
+            {
+                if (use->user == user)
+                    return use;
+            }
+            return nullptr;
+        }
     };
 
 #pragma region Inst Opcodes
@@ -53,6 +103,7 @@ namespace Fern::HLIR
         Store,
         FieldAddr,
         ElementAddr,
+        BoundsCheck,
 
         // Arithmetic
         Add,
@@ -87,6 +138,14 @@ namespace Fern::HLIR
         Cast,
         Bitcast,
 
+        // Vector
+        Splat,
+        BuildVector,
+        ExtractLane,
+        InsertLane,
+        Shuffle,
+        Reduce,
+
         // Control flow
         Call,
         Ret,
@@ -99,16 +158,44 @@ namespace Fern::HLIR
         Copy,
     };
 
+    inline bool is_constant_op(Opcode op)
+    {
+        return op == Opcode::ConstInt || op == Opcode::ConstFloat ||
+               op == Opcode::ConstBool || op == Opcode::ConstNull;
+    }
+
+    // BinaryInst opcodes: arithmetic, comparisons, logical and bitwise
+    inline bool is_binary_op(Opcode op)
+    {
+        return op >= Opcode::Add && op <= Opcode::Shr &&
+               op != Opcode::Neg && op != Opcode::Not && op != Opcode::BitNot;
+    }
+
+    inline bool is_unary_op(Opcode op)
+    {
+        return op == Opcode::Neg || op == Opcode::Not || op == Opcode::BitNot;
+    }
+
+    inline bool is_vector_op(Opcode op)
+    {
+        return op >= Opcode::Splat && op <= Opcode::Reduce;
+    }
+
+    inline bool is_compare(Opcode op)
+    {
+        return op >= Opcode::Eq && op <= Opcode::Ge;
+    }
+
 #pragma region Base Inst
 
+    // Instructions live in their function's arena and are never deleted through a base
+    // pointer, so there is no vtable; everything that handles them switches on `op`
     struct Instruction
     {
         Opcode op;
         Value *result = nullptr;
         BasicBlock *parent = nullptr;
         uint32_t debug_line = 0;
-
-        virtual ~Instruction() = default;
     };
 
 #pragma region Constant Inst
@@ -170,6 +257,10 @@ namespace Fern::HLIR
         bool escapes = true;            // Pessimistic default
         std::set<Function *> escape_to; // Functions it escapes to
 
+        // Constant per element when the array is a read-only table (see ConstEvaluator);
+        // the allocation then starts out holding these and is never written
+        std::vector<Value *> initializer;
+
         AllocInst(Value *result, TypePtr type)
         {
             op = Opcode::Alloc;
@@ -231,6 +322,20 @@ namespace Fern::HLIR
         }
     };
 
+    // Traps unless 0 <= index < length. Has no result; it guards the element accesses after it
+    struct BoundsCheckInst : Instruction
+    {
+        Value *index;
+        Value *length;
+
+        BoundsCheckInst(Value *idx, Value *len)
+        {
+            op = Opcode::BoundsCheck;
+            this->index = idx;
+            this->length = len;
+        }
+    };
+
 #pragma region Binary Inst
 
     struct BinaryInst : Instruction
@@ -277,6 +382,105 @@ namespace Fern::HLIR
         }
     };
 
+#pragma region Vector Inst
+
+    // Broadcast a scalar to every lane of the result vector
+    struct SplatInst : Instruction
+    {
+        Value *scalar;
+
+        SplatInst(Value *result, Value *scalar)
+        {
+            op = Opcode::Splat;
+            this->result = result;
+            this->scalar = scalar;
+        }
+    };
+
+    // One scalar per lane, in lane order
+    struct BuildVectorInst : Instruction
+    {
+        std::vector<Value *> elements;
+
+        BuildVectorInst(Value *result, std::vector<Value *> elements)
+        {
+            op = Opcode::BuildVector;
+            this->result = result;
+            this->elements = std::move(elements);
+        }
+    };
+
+    struct ExtractLaneInst : Instruction
+    {
+        Value *vector;
+        Value *lane;
+
+        ExtractLaneInst(Value *result, Value *vector, Value *lane)
+        {
+            op = Opcode::ExtractLane;
+            this->result = result;
+            this->vector = vector;
+            this->lane = lane;
+        }
+    };
+
+    // Produces a copy of `vector` with one lane replaced
+    struct InsertLaneInst : Instruction
+    {
+        Value *vector;
+        Value *lane;
+        Value *value;
+
+        InsertLaneInst(Value *result, Value *vector, Value *lane, Value *value)
+        {
+            op = Opcode::InsertLane;
+            this->result = result;
+            this->vector = vector;
+            this->lane = lane;
+            this->value = value;
+        }
+    };
+
+    // Lanes of `right` (when present) are numbered after the lanes of `left`
+    struct ShuffleInst : Instruction
+    {
+        Value *left;
+        Value *right;
+        std::vector<int32_t> mask;
+
+        ShuffleInst(Value *result, Value *left, Value *right, std::vector<int32_t> mask)
+        {
+            op = Opcode::Shuffle;
+            this->result = result;
+            this->left = left;
+            this->right = right;
+            this->mask = std::move(mask);
+        }
+    };
+
+    enum class ReduceKind
+    {
+        Add,
+        Mul,
+        Min,
+        Max
+    };
+
+    // Horizontal reduction of every lane to a scalar
+    struct ReduceInst : Instruction
+    {
+        ReduceKind kind;
+        Value *vector;
+
+        ReduceInst(Value *result, ReduceKind kind, Value *vector)
+        {
+            op = Opcode::Reduce;
+            this->result = result;
+            this->kind = kind;
+            this->vector = vector;
+        }
+    };
+
 #pragma region Call Inst
 
     struct CallInst : Instruction
@@ -342,10 +546,8 @@ namespace Fern::HLIR
             this->result = result;
         }
 
-        void add_incoming(Value *val, BasicBlock *block)
-        {
-            incoming.push_back({val, block});
-        }
+        // Records the use too, so the phi must already be in a block
+        void add_incoming(Value *val, BasicBlock *block);
     };
 
 #pragma region Basic Block
@@ -356,17 +558,44 @@ namespace Fern::HLIR
         std::string name;
         Function *parent;
 
-        std::vector<std::unique_ptr<Instruction>> instructions;
+        std::vector<Instruction *> instructions; // owned by the function's arena
         std::vector<BasicBlock *> predecessors;
         std::vector<BasicBlock *> successors;
 
         BasicBlock(uint32_t id, const std::string &name = "")
             : id(id), name(name) {}
 
-        void add_inst(std::unique_ptr<Instruction> inst)
+        void add_inst(Instruction *inst)
+        {
+            inst->parent = this;
+            instructions.push_back(inst);
+        }
+
+        // Insert an instruction at a given position (used by passes that move code around)
+        void insert_inst(size_t index, Instruction *inst)
         {
             inst->parent = this;
-            instructions.push_back(std::move(inst));
+            instructions.insert(instructions.begin() + index, inst);
+        }
+
+        // Insert just before the terminator, or at the end if the block is still open
+        void insert_before_terminator(Instruction *inst)
+        {
+            size_t index = terminator() ? instructions.size() - 1 : instructions.size();
+            insert_inst(index, inst);
+        }
+
+        // Detach an instruction from this block so it can be reinserted elsewhere. Its uses
+        // stay recorded; call Function::drop_uses when it's being deleted for good
+        Instruction *remove_inst(Instruction *inst)
+        {
+            auto it = std::find(instructions.begin(), instructions.end(), inst);
+            if (it == instructions.end())
+                return nullptr;
+
+            instructions.erase(it);
+            inst->parent = nullptr;
+            return inst;
         }
 
         Instruction *terminator() const
@@ -374,7 +603,7 @@ namespace Fern::HLIR
             if (instructions.empty())
                 return nullptr;
 
-            auto *last = instructions.back().get();
+            auto *last = instructions.back();
             // Check if the last instruction is actually a terminator
             if (last->op == Opcode::Ret ||
                 last->op == Opcode::Br ||
@@ -397,25 +626,55 @@ namespace Fern::HLIR
         std::vector<bool> param_escapes;  // Which params escape
         std::vector<bool> param_modified; // Which params are modified
 
+        // Instructions, values and use nodes, in creation order
+        HLIRArena arena;
+
         std::vector<std::unique_ptr<BasicBlock>> blocks;
-        std::vector<std::unique_ptr<Value>> values;
+        std::vector<Value *> values;
         BasicBlock *entry = nullptr;
 
+        Use *free_uses = nullptr; // use nodes released by drop_uses, reused before allocating
+
         uint32_t next_value_id = 0;
         uint32_t next_block_id = 0;
 
         bool is_external = false;
         bool is_static = false; // if not then we need a this pointer as first arg
 
-        Value *create_value(TypePtr type, const std::string &name = "")
+        // Where the body was written, for line tables; instructions carry their own lines
+        std::string source_file;
+        uint32_t source_line = 0;
+
+        Value *create_value(TypePtr type, std::string_view name = {})
         {
-            auto val = std::make_unique<Value>(next_value_id++, type);
-            val->debug_name = name;
-            Value *ptr = val.get();
-            values.push_back(std::move(val));
-            return ptr;
+            auto *val = arena.make<Value>(next_value_id++, type);
+            val->debug_name = arena.intern(name);
+            values.push_back(val);
+            return val;
+        }
+
+        // Allocate an instruction in the arena and record a use for each of its operands
+        template <typename T, typename... Args>
+        T *make_inst(Args &&...args);
+
+        void add_use(Value *value, Instruction *user)
+        {
+            Use *use = free_uses;
+            if (use)
+            {
+                free_uses = use->next;
+                use->user = user;
+            }
+            else
+            {
+                use = arena.make<Use>(user);
+            }
+            value->link_use(use);
         }
 
+        // Forget the uses of an instruction that is being deleted
+        void drop_uses(Instruction *inst);
+
         BasicBlock *create_block(const std::string &name = "")
         {
             auto block = std::make_unique<BasicBlock>(next_block_id++, name);
@@ -436,6 +695,236 @@ namespace Fern::HLIR
         }
     };
 
+#pragma region Operand Helpers
+
+    // Visit every value operand of an instruction. Operands are passed by reference
+    // so passes can rewrite them in place.
+    template <typename Fn>
+    void for_each_operand(Instruction *inst, Fn &&fn)
+    {
+        switch (inst->op)
+        {
+        case Opcode::Alloc:
+            for (auto &element : static_cast<AllocInst *>(inst)->initializer)
+                fn(element);
+            break;
+        case Opcode::Load:
+            fn(static_cast<LoadInst *>(inst)->address);
+            break;
+        case Opcode::Store:
+        {
+            auto *store = static_cast<StoreInst *>(inst);
+            fn(store->value);
+            fn(store->address);
+            break;
+        }
+        case Opcode::FieldAddr:
+            fn(static_cast<FieldAddrInst *>(inst)->object);
+            break;
+        case Opcode::ElementAddr:
+        {
+            auto *elem = static_cast<ElementAddrInst *>(inst);
+            fn(elem->array);
+            fn(elem->index);
+            break;
+        }
+        case Opcode::BoundsCheck:
+        {
+            auto *check = static_cast<BoundsCheckInst *>(inst);
+            fn(check->index);
+            fn(check->length);
+            break;
+        }
+        case Opcode::Add:
+        case Opcode::Sub:
+        case Opcode::Mul:
+        case Opcode::Div:
+        case Opcode::Rem:
+        case Opcode::Eq:
+        case Opcode::Ne:
+        case Opcode::Lt:
+        case Opcode::Le:
+        case Opcode::Gt:
+        case Opcode::Ge:
+        case Opcode::And:
+        case Opcode::Or:
+        case Opcode::BitAnd:
+        case Opcode::BitOr:
+        case Opcode::BitXor:
+        case Opcode::Shl:
+        case Opcode::Shr:
+        {
+            auto *bin = static_cast<BinaryInst *>(inst);
+            fn(bin->left);
+            fn(bin->right);
+            break;
+        }
+        case Opcode::Neg:
+        case Opcode::Not:
+        case Opcode::BitNot:
+            fn(static_cast<UnaryInst *>(inst)->operand);
+            break;
+        case Opcode::Cast:
+            fn(static_cast<CastInst *>(inst)->value);
+            break;
+        case Opcode::Splat:
+            fn(static_cast<SplatInst *>(inst)->scalar);
+            break;
+        case Opcode::BuildVector:
+            for (auto &element : static_cast<BuildVectorInst *>(inst)->elements)
+                fn(element);
+            break;
+        case Opcode::ExtractLane:
+        {
+            auto *extract = static_cast<ExtractLaneInst *>(inst);
+            fn(extract->vector);
+            fn(extract->lane);
+            break;
+        }
+        case Opcode::InsertLane:
+        {
+            auto *insert = static_cast<InsertLaneInst *>(inst);
+            fn(insert->vector);
+            fn(insert->lane);
+            fn(insert->value);
+            break;
+        }
+        case Opcode::Shuffle:
+        {
+            auto *shuffle = static_cast<ShuffleInst *>(inst);
+            fn(shuffle->left);
+            if (shuffle->right)
+                fn(shuffle->right);
+            break;
+        }
+        case Opcode::Reduce:
+            fn(static_cast<ReduceInst *>(inst)->vector);
+            break;
+        case Opcode::Call:
+            for (auto &arg : static_cast<CallInst *>(inst)->args)
+                fn(arg);
+            break;
+        case Opcode::Ret:
+        {
+            auto *ret = static_cast<RetInst *>(inst);
+            if (ret->value)
+                fn(ret->value);
+            break;
+        }
+        case Opcode::CondBr:
+            fn(static_cast<CondBrInst *>(inst)->condition);
+            break;
+        case Opcode::Phi:
+            for (auto &[value, block] : static_cast<PhiInst *>(inst)->incoming)
+                fn(value);
+            break;
+        default:
+            break;
+        }
+    }
+
+    template <typename T, typename... Args>
+    T *Function::make_inst(Args &&...args)
+    {
+        T *inst = arena.make<T>(std::forward<Args>(args)...);
+        for_each_operand(inst, [&](Value *&operand) { add_use(operand, inst); });
+        return inst;
+    }
+
+    inline void Function::drop_uses(Instruction *inst)
+    {
+        for_each_operand(inst, [&](Value *&operand)
+        {
+            if (Use *use = operand->find_use(inst))
+            {
+                operand->unlink_use(use);
+                use->next = free_uses;
+                free_uses = use;
+            }
+        });
+    }
+
+    inline void PhiInst::add_incoming(Value *val, BasicBlock *block)
+    {
+        incoming.push_back({val, block});
+        parent->parent->add_use(val, this);
+    }
+
+    // Rewrite every use of `from` to refer to `to`. Only the users on `from`'s use list are
+    // visited, and their use nodes move over to `to`
+    inline void replace_all_uses(Value *from, Value *to)
+    {
+        while (Use *use = from->first_use)
+        {
+            for_each_operand(use->user, [&](Value *&operand)
+            {
+                if (operand == from)
+                    operand = to;
+            });
+            from->unlink_use(use);
+            to->link_use(use);
+        }
+    }
+
+    // The value of a ConstInt, or false when `value` isn't one
+    inline bool get_const_int(Value *value, int64_t &out)
+    {
+        if (!value->def || value->def->op != Opcode::ConstInt)
+            return false;
+        out = static_cast<ConstIntInst *>(value->def)->value;
+        return true;
+    }
+
+    // The value an address was computed from by FieldAddr and ElementAddr steps: an
+    // allocation, a parameter, or whatever else produced the base pointer
+    inline Value *address_root(Value *address)
+    {
+        Value *current = address;
+        while (current->def)
+        {
+            if (current->def->op == Opcode::FieldAddr)
+                current = static_cast<FieldAddrInst *>(current->def)->object;
+            else if (current->def->op == Opcode::ElementAddr)
+                current = static_cast<ElementAddrInst *>(current->def)->array;
+            else
+                break;
+        }
+        return current;
+    }
+
+    // Check that every operand of every instruction has exactly one matching use node and
+    // that no value lists a user it doesn't have. Returns an empty string when consistent
+    inline std::string verify_uses(Function *func)
+    {
+        std::unordered_map<Value *, std::unordered_map<Instruction *, uint32_t>> expected;
+        for (auto &block : func->blocks)
+        {
+            for (auto *inst : block->instructions)
+            {
+                for_each_operand(inst, [&](Value *&operand) { expected[operand][inst]++; });
+            }
+        }
+
+        for (auto *value : func->values)
+        {
+            auto &users = expected[value];
+            for (Use *use = value->first_use; use; use = use->next)
+            {
+                // Instructions removed from their block may still hold uses; they're harmless
+                if (!use->user->parent)
+                    continue;
+                if (users[use->user]-- == 0)
+                    return "%" + std::to_string(value->id) + " lists a use that doesn't exist";
+            }
+            for (auto &[user, missing] : users)
+            {
+                if (missing != 0)
+                    return "%" + std::to_string(value->id) + " is missing a use";
+            }
+        }
+        return "";
+    }
+
 #pragma region Type Definition
 
     struct TypeDefinition
@@ -456,9 +945,14 @@ namespace Fern::HLIR
         Module(const std::string &name, NamespaceSymbol *global_ns)
         {
             this->name = name;
+            add_namespace(global_ns);
+        }
 
-            // Recursively define all types and functions in the global namespace
-            for (const auto &member : global_ns->member_order)
+        // Recursively define all types and functions in a namespace. A module that outlives one
+        // compile takes each new file's namespace this way, next to what it already holds
+        void add_namespace(NamespaceSymbol *ns)
+        {
+            for (const auto &member : ns->member_order)
             {
                 if (auto type_sym = member->as<TypeSymbol>())
                 {
@@ -470,6 +964,14 @@ namespace Fern::HLIR
                 }
             }
         }
+
+        // Drop functions and types added with add_namespace once nothing can call or use them
+        void remove(const std::unordered_set<Function *> &dead_functions,
+                    const std::unordered_set<TypeDefinition *> &dead_types)
+        {
+            std::erase_if(functions, [&](const auto &func) { return dead_functions.count(func.get()) > 0; });
+            std::erase_if(types, [&](const auto &type) { return dead_types.count(type.get()) > 0; });
+        }
         
         // Lookup function by symbol
         Function* find_function(FunctionSymbol* sym)
@@ -669,7 +1171,7 @@ namespace Fern::HLIR
             // Dump instructions
             for (const auto &inst : block->instructions)
             {
-                ss << "    " << dump_instruction(inst.get()) << "\n";
+                ss << "    " << dump_instruction(inst) << "\n";
             }
 
             return ss.str();
@@ -725,6 +1227,13 @@ namespace Fern::HLIR
                     ss << " [stack]";
                 if (!alloc->escapes)
                     ss << " [no-escape]";
+                if (!alloc->initializer.empty())
+                {
+                    ss << " [const";
+                    for (size_t i = 0; i < alloc->initializer.size(); ++i)
+                        ss << (i == 0 ? " " : ", ") << value_ref(alloc->initializer[i]);
+                    ss << "]";
+                }
                 break;
             }
             case Opcode::Load:
@@ -751,6 +1260,12 @@ namespace Fern::HLIR
                 ss << "elementaddr " << value_ref(elem->array) << ", " << value_ref(elem->index);
                 break;
             }
+            case Opcode::BoundsCheck:
+            {
+                auto *check = static_cast<const BoundsCheckInst *>(inst);
+                ss << "boundscheck " << value_ref(check->index) << ", " << value_ref(check->length);
+                break;
+            }
             case Opcode::Add:
             case Opcode::Sub:
             case Opcode::Mul:
@@ -789,6 +1304,60 @@ namespace Fern::HLIR
                 ss << "cast " << value_ref(cast->value) << " to " << type_to_string(cast->target_type);
                 break;
             }
+            case Opcode::Splat:
+            {
+                auto *splat = static_cast<const SplatInst *>(inst);
+                ss << "splat " << value_ref(splat->scalar) << " to " << type_to_string(inst->result->type);
+                break;
+            }
+            case Opcode::BuildVector:
+            {
+                auto *build = static_cast<const BuildVectorInst *>(inst);
+                ss << "buildvector " << type_to_string(inst->result->type) << " (";
+                for (size_t i = 0; i < build->elements.size(); ++i)
+                {
+                    if (i > 0)
+                        ss << ", ";
+                    ss << value_ref(build->elements[i]);
+                }
+                ss << ")";
+                break;
+            }
+            case Opcode::ExtractLane:
+            {
+                auto *extract = static_cast<const ExtractLaneInst *>(inst);
+                ss << "extractlane " << value_ref(extract->vector) << ", " << value_ref(extract->lane);
+                break;
+            }
+            case Opcode::InsertLane:
+            {
+                auto *insert = static_cast<const InsertLaneInst *>(inst);
+                ss << "insertlane " << value_ref(insert->vector) << ", " << value_ref(insert->lane)
+                   << ", " << value_ref(insert->value);
+                break;
+            }
+            case Opcode::Shuffle:
+            {
+                auto *shuffle = static_cast<const ShuffleInst *>(inst);
+                ss << "shuffle " << value_ref(shuffle->left);
+                if (shuffle->right)
+                    ss << ", " << value_ref(shuffle->right);
+                ss << " [";
+                for (size_t i = 0; i < shuffle->mask.size(); ++i)
+                {
+                    if (i > 0)
+                        ss << ", ";
+                    ss << shuffle->mask[i];
+                }
+                ss << "]";
+                break;
+            }
+            case Opcode::Reduce:
+            {
+                auto *reduce = static_cast<const ReduceInst *>(inst);
+                ss << "reduce." << reduce_kind_to_string(reduce->kind) << " " << value_ref(reduce->vector);
+                break;
+            }
             case Opcode::Call:
             {
                 auto *call = static_cast<const CallInst *>(inst);
@@ -872,6 +1441,23 @@ namespace Fern::HLIR
             return type->get_name();
         }
 
+        static std::string reduce_kind_to_string(ReduceKind kind)
+        {
+            switch (kind)
+            {
+            case ReduceKind::Add:
+                return "add";
+            case ReduceKind::Mul:
+                return "mul";
+            case ReduceKind::Min:
+                return "min";
+            case ReduceKind::Max:
+                return "max";
+            default:
+                return "unknown";
+            }
+        }
+
         static std::string opcode_to_string(Opcode op)
         {
             switch (op)
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Fern::HLIR
+{
+    // Bump allocator that owns a function's instructions, values and use nodes. Objects are
+    // laid out in creation order, so walking a block touches a handful of contiguous chunks
+    // instead of one heap allocation per node. Nothing is freed individually; destructors of
+    // the few node types that need them run when the arena goes away.
+    class HLIRArena
+    {
+        static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024; // 64KB chunks
+
+        struct Chunk
+        {
+            std::unique_ptr<uint8_t[]> memory;
+            size_t size;
+            size_t used;
+
+            Chunk(size_t size) : memory(new uint8_t[size]), size(size), used(0) {}
+
+            void *allocate(size_t bytes, size_t alignment)
+            {
+                size_t space = size - used;
+                void *ptr = memory.get() + used;
+
+                if (std::align(alignment, bytes, ptr, space))
+                {
+                    size_t offset = static_cast<uint8_t *>(ptr) - (memory.get() + used);
+                    used += offset + bytes;
+                    return ptr;
+                }
+                return nullptr;
+            }
+        };
+
+        struct Destructor
+        {
+            void *object;
+            void (*destroy)(void *);
+        };
+
+        std::vector<Chunk> chunks;
+        std::vector<Destructor> destructors;
+        size_t chunkSize;
+
+    public:
+        explicit HLIRArena(size_t chunkSize = DEFAULT_CHUNK_SIZE) : chunkSize(chunkSize)
+        {
+            chunks.reserve(16);
+            chunks.emplace_back(chunkSize);
+        }
+
+        ~HLIRArena()
+        {
+            // Reverse creation order, like automatic objects
+            for (auto it = destructors.rbegin(); it != destructors.rend(); ++it)
+            {
+                it->destroy(it->object);
+            }
+        }
+
+        // Non-copyable, non-movable
+        HLIRArena(const HLIRArena &) = delete;
+        HLIRArena &operator=(const HLIRArena &) = delete;
+        HLIRArena(HLIRArena &&) = delete;
+        HLIRArena &operator=(HLIRArena &&) = delete;
+
+        void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+        {
+            if (bytes == 0)
+                return nullptr;
+
+            // Try current chunk
+            if (void *ptr = chunks.back().allocate(bytes, alignment))
+            {
+                return ptr;
+            }
+
+            // Need new chunk
+            size_t newChunkSize = std::max(chunkSize, bytes + alignment);
+            chunks.emplace_back(newChunkSize);
+
+            void *result = chunks.back().allocate(bytes, alignment);
+            if (!result)
+                throw std::bad_alloc();
+            return result;
+        }
+
+        template <typename T, typename... Args>
+        T *make(Args &&...args)
+        {
+            void *memory = allocate(sizeof(T), alignof(T));
+            T *object = new (memory) T(std::forward<Args>(args)...);
+            if constexpr (!std::is_trivially_destructible_v<T>)
+            {
+                destructors.push_back({object, [](void *p) { static_cast<T *>(p)->~T(); }});
+            }
+            return object;
+        }
+
+        // Copy a string into the arena; the view stays valid for the arena's lifetime
+        std::string_view intern(std::string_view text)
+        {
+            if (text.empty())
+                return {};
+
+            char *memory = static_cast<char *>(allocate(text.size(), alignof(char)));
+            std::memcpy(memory, text.data(), text.size());
+            return std::string_view(memory, text.size());
+        }
+
+        // Memory statistics
+        size_t bytesUsed() const
+        {
+            size_t total = 0;
+            for (const auto &chunk : chunks)
+            {
+                total += chunk.used;
+            }
+            return total;
+        }
+
+        size_t bytesReserved() const
+        {
+            size_t total = 0;
+            for (const auto &chunk : chunks)
+            {
+                total += chunk.size;
+            }
+            return total;
+        }
+    };
+
+} // namespace Fern::HLIR
@@ -9,6 +9,12 @@ namespace Fern::HLIR
         Function* current_func = nullptr;
         BasicBlock* current_block = nullptr;
         TypeSystem* type_system = nullptr;
+        uint32_t debug_line = 0; // source line stamped on new instructions, 0 if unknown
+
+        void add(Instruction* inst) {
+            inst->debug_line = debug_line;
+            current_block->add_inst(inst);
+        }
 
     public:
         HLIRBuilder() = default;
@@ -17,36 +23,37 @@ namespace Fern::HLIR
         void set_function(Function* f) { current_func = f; }
         void set_block(BasicBlock* b) { current_block = b; }
         void set_type_system(TypeSystem* ts) { type_system = ts; }
+        void set_debug_line(uint32_t line) { debug_line = line; }
         
         Value* const_int(int64_t val, TypePtr type) {
             auto result = current_func->create_value(type);
-            auto inst = std::make_unique<ConstIntInst>(result, val);
-            result->def = inst.get();
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<ConstIntInst>(result, val);
+            result->def = inst;
+            add(inst);
             return result;
         }
         
         Value* const_bool(bool val, TypePtr type) {
             auto result = current_func->create_value(type);
-            auto inst = std::make_unique<ConstBoolInst>(result, val);
-            result->def = inst.get();
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<ConstBoolInst>(result, val);
+            result->def = inst;
+            add(inst);
             return result;
         }
         
         Value* const_float(double val, TypePtr type) {
             auto result = current_func->create_value(type);
-            auto inst = std::make_unique<ConstFloatInst>(result, val);
-            result->def = inst.get();
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<ConstFloatInst>(result, val);
+            result->def = inst;
+            add(inst);
             return result;
         }
         
         Value* const_string(const std::string& val, TypePtr type) {
             auto result = current_func->create_value(type);
-            auto inst = std::make_unique<ConstStringInst>(result, val);
-            result->def = inst.get();
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<ConstStringInst>(result, val);
+            result->def = inst;
+            add(inst);
             return result;
         }
         
@@ -73,12 +80,16 @@ namespace Fern::HLIR
                         break;
                 }
             }
+
+            if (auto vector = type->as<VectorType>()) {
+                return splat(const_null(vector->element), type);
+            }
             
             // For pointers, arrays, and complex types, use nullptr/zero
             auto result = current_func->create_value(type);
-            auto inst = std::make_unique<ConstIntInst>(result, 0);
-            result->def = inst.get();
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<ConstIntInst>(result, 0);
+            result->def = inst;
+            add(inst);
             return result;
         }
         
@@ -86,27 +97,24 @@ namespace Fern::HLIR
             // Result type is pointer to the allocated type
             auto ptr_type = type_system ? type_system->get_pointer(type) : type;
             auto result = current_func->create_value(ptr_type);
-            auto inst = std::make_unique<AllocInst>(result, type);
+            auto inst = current_func->make_inst<AllocInst>(result, type);
             inst->on_stack = stack;
-            result->def = inst.get();
-            current_block->add_inst(std::move(inst));
+            result->def = inst;
+            add(inst);
             return result;
         }
         
         Value* load(Value* addr, TypePtr type) {
             auto result = current_func->create_value(type);
-            auto inst = std::make_unique<LoadInst>(result, addr);
-            result->def = inst.get();
-            addr->uses.push_back(inst.get());
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<LoadInst>(result, addr);
+            result->def = inst;
+            add(inst);
             return result;
         }
         
         void store(Value* val, Value* addr) {
-            auto inst = std::make_unique<StoreInst>(val, addr);
-            val->uses.push_back(inst.get());
-            addr->uses.push_back(inst.get());
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<StoreInst>(val, addr);
+            add(inst);
         }
         
         Value* binary(Opcode op, Value* left, Value* right) {
@@ -123,40 +131,83 @@ namespace Fern::HLIR
             }
 
             auto result = current_func->create_value(result_type);
-            auto inst = std::make_unique<BinaryInst>(op, result, left, right);
-            result->def = inst.get();
-            left->uses.push_back(inst.get());
-            right->uses.push_back(inst.get());
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<BinaryInst>(op, result, left, right);
+            result->def = inst;
+            add(inst);
             return result;
         }
         
         Value* unary(Opcode op, Value* operand) {
             auto result = current_func->create_value(operand->type);
-            auto inst = std::make_unique<UnaryInst>(op, result, operand);
-            result->def = inst.get();
-            operand->uses.push_back(inst.get());
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<UnaryInst>(op, result, operand);
+            result->def = inst;
+            add(inst);
             return result;
         }
         
         Value* cast(Value* value, TypePtr target_type) {
             auto result = current_func->create_value(target_type);
-            auto inst = std::make_unique<CastInst>(result, value, target_type);
-            result->def = inst.get();
-            value->uses.push_back(inst.get());
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<CastInst>(result, value, target_type);
+            result->def = inst;
+            add(inst);
             return result;
         }
         
+        Value* splat(Value* scalar, TypePtr vector_type) {
+            auto result = current_func->create_value(vector_type);
+            auto inst = current_func->make_inst<SplatInst>(result, scalar);
+            result->def = inst;
+            add(inst);
+            return result;
+        }
+
+        Value* build_vector(std::vector<Value*> elements, TypePtr vector_type) {
+            auto result = current_func->create_value(vector_type);
+            auto inst = current_func->make_inst<BuildVectorInst>(result, elements);
+            result->def = inst;
+            add(inst);
+            return result;
+        }
+
+        Value* extract_lane(Value* vector, Value* lane, TypePtr element_type) {
+            auto result = current_func->create_value(element_type);
+            auto inst = current_func->make_inst<ExtractLaneInst>(result, vector, lane);
+            result->def = inst;
+            add(inst);
+            return result;
+        }
+
+        Value* insert_lane(Value* vector, Value* lane, Value* value) {
+            auto result = current_func->create_value(vector->type);
+            auto inst = current_func->make_inst<InsertLaneInst>(result, vector, lane, value);
+            result->def = inst;
+            add(inst);
+            return result;
+        }
+
+        Value* shuffle(Value* left, Value* right, std::vector<int32_t> mask, TypePtr result_type) {
+            auto result = current_func->create_value(result_type);
+            auto inst = current_func->make_inst<ShuffleInst>(result, left, right, std::move(mask));
+            result->def = inst;
+            add(inst);
+            return result;
+        }
+
+        Value* reduce(ReduceKind kind, Value* vector, TypePtr element_type) {
+            auto result = current_func->create_value(element_type);
+            auto inst = current_func->make_inst<ReduceInst>(result, kind, vector);
+            result->def = inst;
+            add(inst);
+            return result;
+        }
+
         Value* field_addr(Value* object, uint32_t field_index, TypePtr field_type) {
             // Result type is pointer to field type
             auto ptr_type = type_system ? type_system->get_pointer(field_type) : field_type;
             auto result = current_func->create_value(ptr_type);
-            auto inst = std::make_unique<FieldAddrInst>(result, object, field_index);
-            result->def = inst.get();
-            object->uses.push_back(inst.get());
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<FieldAddrInst>(result, object, field_index);
+            result->def = inst;
+            add(inst);
             return result;
         }
 
@@ -164,45 +215,43 @@ namespace Fern::HLIR
             // Result type is pointer to element type
             auto ptr_type = type_system ? type_system->get_pointer(element_type) : element_type;
             auto result = current_func->create_value(ptr_type);
-            auto inst = std::make_unique<ElementAddrInst>(result, array, index);
-            result->def = inst.get();
-            array->uses.push_back(inst.get());
-            index->uses.push_back(inst.get());
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<ElementAddrInst>(result, array, index);
+            result->def = inst;
+            add(inst);
             return result;
         }
         
+        void bounds_check(Value* index, Value* length) {
+            auto inst = current_func->make_inst<BoundsCheckInst>(index, length);
+            add(inst);
+        }
+        
         Value* call(Function* func, std::vector<Value*> args) {
             Value* result = nullptr;
             if (func->return_type() && !func->return_type()->is_void()) {
                 result = current_func->create_value(func->return_type());
             }
-            auto inst = std::make_unique<CallInst>(result, func, args);
-            if (result) result->def = inst.get();
-            for (auto arg : args) {
-                arg->uses.push_back(inst.get());
-            }
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<CallInst>(result, func, args);
+            if (result) result->def = inst;
+            add(inst);
             return result;
         }
         
         void ret(Value* val = nullptr) {
-            auto inst = std::make_unique<RetInst>(val);
-            if (val) val->uses.push_back(inst.get());
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<RetInst>(val);
+            add(inst);
         }
         
         void br(BasicBlock* target) {
-            auto inst = std::make_unique<BrInst>(target);
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<BrInst>(target);
+            add(inst);
             current_block->successors.push_back(target);
             target->predecessors.push_back(current_block);
         }
         
         void cond_br(Value* cond, BasicBlock* t, BasicBlock* f) {
-            auto inst = std::make_unique<CondBrInst>(cond, t, f);
-            cond->uses.push_back(inst.get());
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<CondBrInst>(cond, t, f);
+            add(inst);
             current_block->successors.push_back(t);
             current_block->successors.push_back(f);
             t->predecessors.push_back(current_block);
@@ -211,9 +260,9 @@ namespace Fern::HLIR
         
         Value* phi(TypePtr type) {
             auto result = current_func->create_value(type);
-            auto inst = std::make_unique<PhiInst>(result);
-            result->def = inst.get();
-            current_block->add_inst(std::move(inst));
+            auto inst = current_func->make_inst<PhiInst>(result);
+            result->def = inst;
+            add(inst);
             return result;
         }
     };
@@ -0,0 +1,265 @@
+// loop_analysis.cpp
+#include "loop_analysis.hpp"
+#include <algorithm>
+
+namespace Fern::HLIR
+{
+    // True if value is target, or a phi that only forwards target. BoundToHLIR removes
+    // trivial phis one at a time, so a cycle of phis passing the counter around can survive
+    static bool forwards_value(Value* value, Value* target) {
+        std::vector<Value*> worklist = {value};
+        std::unordered_set<Value*> visited = {value};
+        while (!worklist.empty()) {
+            auto current = worklist.back();
+            worklist.pop_back();
+            if (current == target) continue;
+            if (!current->def || current->def->op != Opcode::Phi) return false;
+
+            for (auto& [incoming, block] : static_cast<PhiInst*>(current->def)->incoming) {
+                if (visited.insert(incoming).second) worklist.push_back(incoming);
+            }
+        }
+        return visited.count(target) != 0;
+    }
+
+    std::vector<BasicBlock*> compute_reverse_post_order(Function* func) {
+        std::vector<BasicBlock*> order;
+        if (!func->entry) return order;
+
+        // Iterative DFS so deeply nested code can't blow the stack
+        std::unordered_set<BasicBlock*> visited;
+        std::vector<std::pair<BasicBlock*, size_t>> stack;
+        stack.push_back({func->entry, 0});
+        visited.insert(func->entry);
+
+        while (!stack.empty()) {
+            auto& [block, next] = stack.back();
+            if (next < block->successors.size()) {
+                auto succ = block->successors[next++];
+                if (visited.insert(succ).second) {
+                    stack.push_back({succ, 0});
+                }
+                continue;
+            }
+            order.push_back(block);
+            stack.pop_back();
+        }
+
+        std::reverse(order.begin(), order.end());
+        return order;
+    }
+
+    #pragma region Dominator Tree
+
+    DominatorTree::DominatorTree(Function* func) {
+        rpo = compute_reverse_post_order(func);
+        for (uint32_t i = 0; i < rpo.size(); ++i) {
+            rpo_index[rpo[i]] = i;
+        }
+
+        // Predecessors restricted to reachable blocks
+        std::vector<std::vector<uint32_t>> preds(rpo.size());
+        for (uint32_t i = 0; i < rpo.size(); ++i) {
+            for (auto succ : rpo[i]->successors) {
+                auto it = rpo_index.find(succ);
+                if (it != rpo_index.end()) {
+                    preds[it->second].push_back(i);
+                }
+            }
+        }
+
+        const uint32_t undefined = UINT32_MAX;
+        idoms.assign(rpo.size(), undefined);
+        if (rpo.empty()) return;
+        idoms[0] = 0;
+
+        auto intersect = [&](uint32_t a, uint32_t b) {
+            while (a != b) {
+                while (a > b) a = idoms[a];
+                while (b > a) b = idoms[b];
+            }
+            return a;
+        };
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (uint32_t i = 1; i < rpo.size(); ++i) {
+                uint32_t new_idom = undefined;
+                for (auto pred : preds[i]) {
+                    if (idoms[pred] == undefined) continue;
+                    new_idom = new_idom == undefined ? pred : intersect(pred, new_idom);
+                }
+                if (new_idom != idoms[i]) {
+                    idoms[i] = new_idom;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    bool DominatorTree::dominates(BasicBlock* a, BasicBlock* b) const {
+        auto a_it = rpo_index.find(a);
+        auto b_it = rpo_index.find(b);
+        if (a_it == rpo_index.end() || b_it == rpo_index.end()) return false;
+
+        uint32_t target = a_it->second;
+        uint32_t current = b_it->second;
+        // Dominators always sit earlier in reverse post-order, so walk up until we pass it
+        while (current > target) {
+            current = idoms[current];
+        }
+        return current == target;
+    }
+
+    BasicBlock* DominatorTree::idom(BasicBlock* block) const {
+        auto it = rpo_index.find(block);
+        if (it == rpo_index.end() || it->second == 0) return nullptr;
+        return rpo[idoms[it->second]];
+    }
+
+    #pragma region Loop
+
+    bool Loop::is_invariant(Value* value) const {
+        if (!value->def) return true;
+        if (is_constant_op(value->def->op)) return true;
+        return !contains(value->def);
+    }
+
+    const InductionVariable* Loop::find_induction_var(Value* value) const {
+        for (const auto& iv : induction_vars) {
+            if (iv.phi->result == value) return &iv;
+        }
+        return nullptr;
+    }
+
+    #pragma region Loop Info
+
+    LoopInfo::LoopInfo(Function* func) : dom_tree(func) {
+        const auto& rpo = dom_tree.reverse_post_order();
+
+        std::unordered_map<BasicBlock*, std::vector<BasicBlock*>> preds;
+        for (auto block : rpo) {
+            for (auto succ : block->successors) {
+                if (dom_tree.is_reachable(succ)) {
+                    preds[succ].push_back(block);
+                }
+            }
+        }
+
+        // A back edge is an edge whose target dominates its source; every header gets one loop
+        std::unordered_map<BasicBlock*, Loop*> by_header;
+        for (auto block : rpo) {
+            for (auto succ : block->successors) {
+                if (!dom_tree.dominates(succ, block)) continue;
+
+                Loop*& loop = by_header[succ];
+                if (!loop) {
+                    loops.push_back(std::make_unique<Loop>());
+                    loop = loops.back().get();
+                    loop->header = succ;
+                    loop->block_set.insert(succ);
+                }
+
+                // Walk predecessors back from the latch until we hit the header
+                std::vector<BasicBlock*> worklist = {block};
+                while (!worklist.empty()) {
+                    auto current = worklist.back();
+                    worklist.pop_back();
+                    if (!loop->block_set.insert(current).second) continue;
+                    for (auto pred : preds[current]) {
+                        worklist.push_back(pred);
+                    }
+                }
+            }
+        }
+
+        for (auto& loop : loops) {
+            for (auto block : rpo) {
+                if (loop->contains(block)) loop->blocks.push_back(block);
+            }
+
+            std::vector<BasicBlock*> outside, inside;
+            for (auto pred : preds[loop->header]) {
+                (loop->contains(pred) ? inside : outside).push_back(pred);
+            }
+            if (outside.size() == 1 && outside[0]->successors.size() == 1) {
+                loop->preheader = outside[0];
+            }
+            if (inside.size() == 1) {
+                loop->latch = inside[0];
+            }
+        }
+
+        // Nesting: the parent is the smallest other loop that contains our header
+        for (auto& loop : loops) {
+            for (auto& other : loops) {
+                if (other.get() == loop.get() || !other->contains(loop->header)) continue;
+                if (other->blocks.size() <= loop->blocks.size()) continue;
+                if (!loop->parent || other->blocks.size() < loop->parent->blocks.size()) {
+                    loop->parent = other.get();
+                }
+            }
+        }
+        for (auto& loop : loops) {
+            if (loop->parent) loop->parent->children.push_back(loop.get());
+            for (auto p = loop->parent; p; p = p->parent) loop->depth++;
+        }
+
+        for (auto& loop : loops) {
+            for (auto block : loop->blocks) {
+                auto& current = innermost[block];
+                if (!current || current->blocks.size() > loop->blocks.size()) {
+                    current = loop.get();
+                }
+            }
+            find_induction_vars(loop.get());
+        }
+    }
+
+    void LoopInfo::find_induction_vars(Loop* loop) {
+        if (!loop->preheader || !loop->latch) return;
+
+        for (auto& inst : loop->header->instructions) {
+            if (inst->op != Opcode::Phi) break;
+
+            auto phi = static_cast<PhiInst*>(inst);
+            if (phi->incoming.size() != 2) continue;
+
+            Value* init = nullptr;
+            Value* next = nullptr;
+            for (auto& [value, block] : phi->incoming) {
+                if (block == loop->preheader) init = value;
+                else if (block == loop->latch) next = value;
+            }
+            if (!init || !next || !next->def) continue;
+            if (next->def->op != Opcode::Add && next->def->op != Opcode::Sub) continue;
+
+            auto update = static_cast<BinaryInst*>(next->def);
+            Value* step_value = nullptr;
+            if (forwards_value(update->left, phi->result)) step_value = update->right;
+            else if (update->op == Opcode::Add && forwards_value(update->right, phi->result)) step_value = update->left;
+            if (!step_value || !step_value->def || step_value->def->op != Opcode::ConstInt) continue;
+
+            int64_t step = static_cast<ConstIntInst*>(step_value->def)->value;
+            if (update->op == Opcode::Sub) step = -step;
+
+            loop->induction_vars.push_back({phi, init, update, step});
+        }
+    }
+
+    Loop* LoopInfo::loop_for(BasicBlock* block) const {
+        auto it = innermost.find(block);
+        return it == innermost.end() ? nullptr : it->second;
+    }
+
+    std::vector<Loop*> LoopInfo::innermost_first() const {
+        std::vector<Loop*> order;
+        for (auto& loop : loops) order.push_back(loop.get());
+        std::stable_sort(order.begin(), order.end(), [](Loop* a, Loop* b) {
+            return a->depth > b->depth;
+        });
+        return order;
+    }
+
+} // namespace Fern::HLIR
@@ -0,0 +1,85 @@
+// loop_analysis.hpp - Dominators, natural loops and induction variables over HLIR
+#pragma once
+
+#include "hlir.hpp"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <memory>
+
+namespace Fern::HLIR
+{
+    // Blocks reachable from the entry, in reverse post-order (every block comes after its dominators)
+    std::vector<BasicBlock*> compute_reverse_post_order(Function* func);
+
+    #pragma region Dominator Tree
+
+    // Iterative dominator computation (Cooper, Harvey & Kennedy)
+    class DominatorTree {
+    private:
+        std::vector<BasicBlock*> rpo;
+        std::unordered_map<BasicBlock*, uint32_t> rpo_index;
+        std::vector<uint32_t> idoms; // indexed by rpo position
+
+    public:
+        explicit DominatorTree(Function* func);
+
+        bool is_reachable(BasicBlock* block) const { return rpo_index.count(block) != 0; }
+        bool dominates(BasicBlock* a, BasicBlock* b) const;
+        BasicBlock* idom(BasicBlock* block) const;
+        const std::vector<BasicBlock*>& reverse_post_order() const { return rpo; }
+    };
+
+    #pragma region Loops
+
+    // A basic induction variable: header phi that steps by a constant once per iteration
+    struct InductionVariable {
+        PhiInst* phi = nullptr;
+        Value* init = nullptr;      // value flowing in from the preheader
+        BinaryInst* update = nullptr; // phi +/- step, flowing in from the latch
+        int64_t step = 0;
+    };
+
+    struct Loop {
+        BasicBlock* header = nullptr;
+        BasicBlock* preheader = nullptr; // unique outside predecessor that only branches to the header
+        BasicBlock* latch = nullptr;     // unique in-loop predecessor of the header
+        Loop* parent = nullptr;
+        std::vector<Loop*> children;
+        std::vector<BasicBlock*> blocks; // header first, then reverse post-order
+        std::unordered_set<BasicBlock*> block_set;
+        std::vector<InductionVariable> induction_vars;
+        uint32_t depth = 1;
+
+        bool contains(BasicBlock* block) const { return block_set.count(block) != 0; }
+        bool contains(Instruction* inst) const { return inst && contains(inst->parent); }
+
+        // Defined outside the loop (params, outer code) or a constant that can be rematerialized
+        bool is_invariant(Value* value) const;
+
+        const InductionVariable* find_induction_var(Value* value) const;
+    };
+
+    class LoopInfo {
+    private:
+        DominatorTree dom_tree;
+        std::vector<std::unique_ptr<Loop>> loops;
+        std::unordered_map<BasicBlock*, Loop*> innermost;
+
+        void find_induction_vars(Loop* loop);
+
+    public:
+        explicit LoopInfo(Function* func);
+
+        const DominatorTree& dominators() const { return dom_tree; }
+        const std::vector<std::unique_ptr<Loop>>& all_loops() const { return loops; }
+        bool empty() const { return loops.empty(); }
+
+        // Innermost loop containing the block, or nullptr
+        Loop* loop_for(BasicBlock* block) const;
+
+        // Inner loops before the loops that enclose them
+        std::vector<Loop*> innermost_first() const;
+    };
+
+} // namespace Fern::HLIR
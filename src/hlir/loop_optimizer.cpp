@@ -0,0 +1,441 @@
+// loop_optimizer.cpp
+#include "loop_optimizer.hpp"
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+namespace Fern::HLIR
+{
+    // Marks an element step in a field path; any index may be taken there
+    static constexpr uint32_t ANY_ELEMENT = UINT32_MAX;
+
+    // Instructions with no side effects, safe to delete once nothing reads them
+    static bool is_pure(Opcode op) {
+        return is_constant_op(op) || is_binary_op(op) || is_unary_op(op) || is_vector_op(op) ||
+               op == Opcode::ConstString || op == Opcode::FieldAddr || op == Opcode::ElementAddr ||
+               op == Opcode::Cast || op == Opcode::Load || op == Opcode::Phi;
+    }
+
+    // Field path from `root` down to `address`, or false if the address isn't derived from it
+    static bool field_path(Value* address, Value* root, std::vector<uint32_t>& path) {
+        path.clear();
+        for (Value* current = address; current != root;) {
+            if (!current->def) return false;
+            if (current->def->op == Opcode::FieldAddr) {
+                auto field = static_cast<FieldAddrInst*>(current->def);
+                path.push_back(field->field_index);
+                current = field->object;
+            }
+            else if (current->def->op == Opcode::ElementAddr) {
+                path.push_back(ANY_ELEMENT);
+                current = static_cast<ElementAddrInst*>(current->def)->array;
+            }
+            else {
+                return false;
+            }
+        }
+        std::reverse(path.begin(), path.end());
+        return true;
+    }
+
+    // A dynamic array's element address reads the data pointer out of the array's header
+    static bool reads_array_header(ElementAddrInst* elem) {
+        auto array = elem->array->type ? elem->array->type->as<ArrayType>() : nullptr;
+        return array && array->size < 0;
+    }
+
+    static bool paths_overlap(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+        size_t common = std::min(a.size(), b.size());
+        for (size_t i = 0; i < common; i++) {
+            if (a[i] != b[i] && a[i] != ANY_ELEMENT && b[i] != ANY_ELEMENT) return false;
+        }
+        return true;
+    }
+
+    #pragma region Entry Points
+
+    void LoopOptimizer::run(Module* module) {
+        for (auto& func : module->functions) {
+            run(func.get());
+        }
+    }
+
+    void LoopOptimizer::run(Function* func) {
+        if (func->is_external || !func->entry) return;
+
+        current_function = func;
+        // BoundToHLIR always passes the receiver first and names it "this"
+        this_param = !func->params.empty() && func->params[0]->debug_name == "this"
+            ? func->params[0]
+            : nullptr;
+
+        bool changed = false;
+        LoopInfo loop_info(func);
+        stats.loops += static_cast<uint32_t>(loop_info.all_loops().size());
+        for (auto loop : loop_info.innermost_first()) {
+            uint32_t before = stats.hoisted + stats.strength_reduced;
+            hoist_invariants(loop, loop_info.dominators());
+            reduce_element_addresses(loop);
+            changed |= stats.hoisted + stats.strength_reduced != before;
+        }
+
+        if (changed) {
+            remove_dead_instructions(func);
+        }
+
+        current_function = nullptr;
+        this_param = nullptr;
+    }
+
+    #pragma region Invariant Code Motion
+
+    // True when the header can't leave the loop the first time it runs, so the body is
+    // reached whenever the loop is. Only a header test comparing constants on entry is known
+    bool LoopOptimizer::enters_body(Loop* loop) {
+        auto terminator = loop->header->instructions.empty() ? nullptr : loop->header->instructions.back();
+        if (!terminator || terminator->op != Opcode::CondBr) {
+            return std::all_of(loop->header->successors.begin(), loop->header->successors.end(),
+                               [&](BasicBlock* succ) { return loop->contains(succ); });
+        }
+
+        auto branch = static_cast<CondBrInst*>(terminator);
+        bool stay_on_true = loop->contains(branch->true_block);
+        if (stay_on_true == loop->contains(branch->false_block)) return true;
+
+        auto condition = branch->condition->def;
+        if (!condition || !is_compare(condition->op) || !loop->preheader) return false;
+
+        // Header phis are read as the value they come in with
+        auto on_entry = [&](Value* value, int64_t& out) {
+            if (value->def && value->def->op == Opcode::Phi && value->def->parent == loop->header) {
+                for (auto& [incoming, pred] : static_cast<PhiInst*>(value->def)->incoming) {
+                    if (pred == loop->preheader) return get_const_int(incoming, out);
+                }
+                return false;
+            }
+            return get_const_int(value, out);
+        };
+
+        auto compare = static_cast<BinaryInst*>(condition);
+        int64_t left, right;
+        // Negative constants would need the operand type's signedness; nothing to gain from it
+        if (!on_entry(compare->left, left) || !on_entry(compare->right, right) || left < 0 || right < 0) {
+            return false;
+        }
+
+        bool taken = false;
+        switch (compare->op) {
+        case Opcode::Eq: taken = left == right; break;
+        case Opcode::Ne: taken = left != right; break;
+        case Opcode::Lt: taken = left < right; break;
+        case Opcode::Le: taken = left <= right; break;
+        case Opcode::Gt: taken = left > right; break;
+        case Opcode::Ge: taken = left >= right; break;
+        default: return false;
+        }
+        return taken == stay_on_true;
+    }
+
+    bool LoopOptimizer::can_hoist(Instruction* inst, Loop* loop, const LoopSummary& summary) {
+        bool operands_invariant = true;
+        for_each_operand(inst, [&](Value*& operand) {
+            if (!loop->is_invariant(operand)) operands_invariant = false;
+        });
+        if (!operands_invariant) return false;
+
+        switch (inst->op) {
+        case Opcode::FieldAddr:
+        case Opcode::Cast:
+            return true;
+
+        case Opcode::ElementAddr:
+            // Reading the header early is only safe if the loop was going to, and calls can
+            // grow the array and move its data
+            if (!reads_array_header(static_cast<ElementAddrInst*>(inst))) return true;
+            return !summary.has_calls && summary.always_run.count(inst->parent) != 0;
+
+        case Opcode::Div:
+        case Opcode::Rem: {
+            // Only hoist when the divisor can't trap on a path that never ran the division
+            auto divisor = static_cast<BinaryInst*>(inst)->right;
+            if (!divisor->def) return false;
+            if (divisor->def->op == Opcode::ConstFloat) return true;
+            int64_t value;
+            return get_const_int(divisor, value) && value != 0 && value != -1;
+        }
+
+        case Opcode::Load: {
+            // Loads are only moved when they read through `this` and nothing in the loop can
+            // write the same field; locals allocated in this function can't alias the receiver
+            if (!this_param || summary.has_calls) return false;
+
+            std::vector<uint32_t> path;
+            if (!field_path(static_cast<LoadInst*>(inst)->address, this_param, path)) return false;
+
+            // A field of `this` can be read anywhere. An element may be past the end or behind
+            // a guard, so it's only read early if the loop was going to read it, and bounds
+            // checks stay in the loop, so never ahead of one
+            bool reads_element = std::find(path.begin(), path.end(), ANY_ELEMENT) != path.end();
+            if (reads_element && (summary.has_bounds_checks || !summary.always_run.count(inst->parent))) {
+                return false;
+            }
+
+            std::vector<uint32_t> store_path;
+            for (auto store : summary.stores) {
+                if (field_path(store->address, this_param, store_path)) {
+                    if (paths_overlap(path, store_path)) return false;
+                    continue;
+                }
+
+                auto root = address_root(store->address);
+                bool is_local = root->def && root->def->op == Opcode::Alloc &&
+                                static_cast<AllocInst*>(root->def)->on_stack;
+                if (!is_local) return false;
+            }
+            return true;
+        }
+
+        default:
+            return is_binary_op(inst->op) || is_unary_op(inst->op) || is_vector_op(inst->op);
+        }
+    }
+
+    void LoopOptimizer::hoist(Instruction* inst, Loop* loop) {
+        // Constants used by the instruction have to come along so they're defined before it
+        for_each_operand(inst, [&](Value*& operand) {
+            if (operand->def && loop->contains(operand->def) && is_constant_op(operand->def->op)) {
+                hoist(operand->def, loop);
+            }
+        });
+
+        inst->parent->remove_inst(inst);
+        loop->preheader->insert_before_terminator(inst);
+    }
+
+    void LoopOptimizer::hoist_invariants(Loop* loop, const DominatorTree& dominators) {
+        if (!loop->preheader) return;
+
+        LoopSummary summary;
+        std::vector<BasicBlock*> exiting;
+        for (auto block : loop->blocks) {
+            for (auto& inst : block->instructions) {
+                if (inst->op == Opcode::Call) summary.has_calls = true;
+                else if (inst->op == Opcode::BoundsCheck) summary.has_bounds_checks = true;
+                else if (inst->op == Opcode::Store) summary.stores.push_back(static_cast<StoreInst*>(inst));
+            }
+            if (block != loop->header && std::any_of(block->successors.begin(), block->successors.end(),
+                                                     [&](BasicBlock* succ) { return !loop->contains(succ); })) {
+                exiting.push_back(block);
+            }
+        }
+
+        // The header always runs. Past it, a block runs on every entry when the body is entered
+        // and the block dominates the latch and every other way out
+        summary.always_run.insert(loop->header);
+        if (loop->latch && enters_body(loop)) {
+            for (auto block : loop->blocks) {
+                if (!dominators.dominates(block, loop->latch)) continue;
+                if (std::all_of(exiting.begin(), exiting.end(),
+                                [&](BasicBlock* exit) { return dominators.dominates(block, exit); })) {
+                    summary.always_run.insert(block);
+                }
+            }
+        }
+
+        // Reverse post-order visits operands before their users, so chains move out together
+        for (auto block : loop->blocks) {
+            std::vector<Instruction*> candidates;
+            for (auto& inst : block->instructions) {
+                candidates.push_back(inst);
+            }
+
+            for (auto inst : candidates) {
+                if (inst->parent != block || !can_hoist(inst, loop, summary)) continue;
+
+                hoist(inst, loop);
+                stats.hoisted++;
+                if (inst->op == Opcode::Load) stats.loads_hoisted++;
+            }
+        }
+    }
+
+    #pragma region Strength Reduction
+
+    bool LoopOptimizer::analyze_affine(Value* index, Loop* loop, AffineIndex& out) {
+        if (auto iv = loop->find_induction_var(index)) {
+            out = AffineIndex{iv, 1, 0, nullptr};
+            return true;
+        }
+
+        if (!index->def || !loop->contains(index->def)) return false;
+
+        auto op = index->def->op;
+        if (op != Opcode::Add && op != Opcode::Sub && op != Opcode::Mul) return false;
+
+        auto bin = static_cast<BinaryInst*>(index->def);
+        int64_t constant;
+
+        if (op == Opcode::Mul) {
+            Value* other = nullptr;
+            if (get_const_int(bin->right, constant)) other = bin->left;
+            else if (get_const_int(bin->left, constant)) other = bin->right;
+            if (!other || !analyze_affine(other, loop, out) || out.base) return false;
+
+            out.scale *= constant;
+            out.offset *= constant;
+            return out.scale != 0;
+        }
+
+        if (op == Opcode::Sub) {
+            if (!get_const_int(bin->right, constant) || !analyze_affine(bin->left, loop, out)) return false;
+            out.offset -= constant;
+            return true;
+        }
+
+        // Add: exactly one side depends on the induction variable
+        Value* other = nullptr;
+        if (analyze_affine(bin->left, loop, out)) other = bin->right;
+        else if (analyze_affine(bin->right, loop, out)) other = bin->left;
+        else return false;
+
+        if (get_const_int(other, constant)) {
+            out.offset += constant;
+            return true;
+        }
+        if (!out.base && loop->is_invariant(other)) {
+            out.base = other;
+            return true;
+        }
+        return false;
+    }
+
+    void LoopOptimizer::reduce_element_addresses(Loop* loop) {
+        if (!loop->preheader || !loop->latch || loop->induction_vars.empty()) return;
+
+        // Accesses sharing array and index expression share one pointer
+        using Key = std::tuple<Value*, PhiInst*, int64_t, int64_t, Value*>;
+        std::map<Key, Value*> reduced;
+
+        for (auto block : loop->blocks) {
+            std::vector<ElementAddrInst*> candidates;
+            for (auto& inst : block->instructions) {
+                if (inst->op == Opcode::ElementAddr) {
+                    candidates.push_back(static_cast<ElementAddrInst*>(inst));
+                }
+            }
+
+            for (auto elem : candidates) {
+                // Only flat pointers can be stepped; dynamic arrays hide their data behind a header
+                if (!elem->array->type || !elem->array->type->as<PointerType>()) continue;
+                if (!loop->is_invariant(elem->array)) continue;
+
+                AffineIndex affine;
+                if (!analyze_affine(elem->index, loop, affine)) continue;
+
+                Key key{elem->array, affine.iv->phi, affine.scale, affine.offset, affine.base};
+                Value*& pointer = reduced[key];
+                if (!pointer) {
+                    auto index_type = affine.iv->phi->result->type;
+
+                    // Starting address, computed once in the preheader
+                    Value* start = nullptr;
+                    int64_t init;
+                    if (get_const_int(affine.iv->init, init)) {
+                        int64_t folded = affine.scale * init + affine.offset;
+                        if (!affine.base) start = emit_const_int(loop->preheader, folded, index_type);
+                        else if (folded == 0) start = affine.base;
+                        else start = emit_binary(loop->preheader, Opcode::Add, affine.base,
+                                                 emit_const_int(loop->preheader, folded, index_type));
+                    }
+                    else {
+                        start = affine.iv->init;
+                        if (affine.scale != 1) {
+                            start = emit_binary(loop->preheader, Opcode::Mul, start,
+                                                emit_const_int(loop->preheader, affine.scale, index_type));
+                        }
+                        if (affine.offset != 0) {
+                            start = emit_binary(loop->preheader, Opcode::Add, start,
+                                                emit_const_int(loop->preheader, affine.offset, index_type));
+                        }
+                        if (affine.base) {
+                            start = emit_binary(loop->preheader, Opcode::Add, start, affine.base);
+                        }
+                    }
+                    auto start_addr = emit_element_addr(loop->preheader, elem->array, start, elem->result->type);
+
+                    pointer = current_function->create_value(elem->result->type, "ptr.iv");
+                    auto phi_ptr = current_function->make_inst<PhiInst>(pointer);
+                    pointer->def = phi_ptr;
+                    loop->header->insert_inst(0, phi_ptr);
+
+                    // Step on the back edge by the same amount the index advances per iteration
+                    auto stride = emit_const_int(loop->latch, affine.scale * affine.iv->step, index_type);
+                    auto next_addr = emit_element_addr(loop->latch, pointer, stride, elem->result->type);
+
+                    phi_ptr->add_incoming(start_addr, loop->preheader);
+                    phi_ptr->add_incoming(next_addr, loop->latch);
+                }
+
+                replace_all_uses(elem->result, pointer);
+                elem->result->def = nullptr;
+                current_function->drop_uses(elem);
+                block->remove_inst(elem);
+                stats.strength_reduced++;
+            }
+        }
+    }
+
+    #pragma region Dead Code
+
+    void LoopOptimizer::remove_dead_instructions(Function* func) {
+        // Use lists are exact, so deleting an instruction immediately frees up its operands;
+        // sweep until a pass finds nothing more
+        bool changed = true;
+        while (changed) {
+            changed = false;
+
+            for (auto& block : func->blocks) {
+                auto& insts = block->instructions;
+                auto dead = std::remove_if(insts.begin(), insts.end(), [&](Instruction* inst) {
+                    if (!inst->result || !is_pure(inst->op) || inst->result->has_uses()) return false;
+                    func->drop_uses(inst);
+                    inst->result->def = nullptr;
+                    inst->parent = nullptr;
+                    return true;
+                });
+                if (dead != insts.end()) {
+                    stats.dead_removed += static_cast<uint32_t>(insts.end() - dead);
+                    insts.erase(dead, insts.end());
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    #pragma region Emit Helpers
+
+    Value* LoopOptimizer::emit_const_int(BasicBlock* block, int64_t value, TypePtr type) {
+        auto result = current_function->create_value(type);
+        auto inst = current_function->make_inst<ConstIntInst>(result, value);
+        result->def = inst;
+        block->insert_before_terminator(inst);
+        return result;
+    }
+
+    Value* LoopOptimizer::emit_binary(BasicBlock* block, Opcode op, Value* left, Value* right) {
+        auto result = current_function->create_value(left->type);
+        auto inst = current_function->make_inst<BinaryInst>(op, result, left, right);
+        result->def = inst;
+        block->insert_before_terminator(inst);
+        return result;
+    }
+
+    Value* LoopOptimizer::emit_element_addr(BasicBlock* block, Value* array, Value* index, TypePtr type) {
+        auto result = current_function->create_value(type);
+        auto inst = current_function->make_inst<ElementAddrInst>(result, array, index);
+        result->def = inst;
+        block->insert_before_terminator(inst);
+        return result;
+    }
+
+} // namespace Fern::HLIR
@@ -0,0 +1,75 @@
+// loop_optimizer.hpp - Loop-aware HLIR cleanups run before LLVM lowering
+#pragma once
+
+#include "hlir.hpp"
+#include "loop_analysis.hpp"
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace Fern::HLIR
+{
+    /**
+     * Runs over each function after BoundToHLIR, whose SSA construction has already
+     * removed the trivial phis:
+     * 1. Hoist loop-invariant address math, arithmetic and loads through `this`. Anything
+     *    that reads an array (an element, or a dynamic array's header) only moves when
+     *    the loop was certain to run it
+     * 2. Turn element addresses that are affine in an induction variable into pointer
+     *    induction variables, so the body steps a pointer instead of redoing index math
+     * 3. Drop the pure instructions that became dead along the way
+     */
+    class LoopOptimizer {
+    public:
+        struct Stats {
+            uint32_t loops = 0;
+            uint32_t hoisted = 0;
+            uint32_t loads_hoisted = 0;
+            uint32_t strength_reduced = 0;
+            uint32_t dead_removed = 0;
+        };
+
+    private:
+        Function* current_function = nullptr;
+        Value* this_param = nullptr;
+        Stats stats;
+
+        // What hoisting out of one loop needs to know about its body
+        struct LoopSummary {
+            bool has_calls = false;
+            bool has_bounds_checks = false;
+            std::vector<StoreInst*> stores;
+            std::unordered_set<BasicBlock*> always_run; // blocks run every time the loop is entered
+        };
+
+        // Element address affine in an induction variable: scale * iv + offset (+ base)
+        struct AffineIndex {
+            const InductionVariable* iv = nullptr;
+            int64_t scale = 1;
+            int64_t offset = 0;
+            Value* base = nullptr; // optional loop-invariant addend
+        };
+
+        void hoist_invariants(Loop* loop, const DominatorTree& dominators);
+        void reduce_element_addresses(Loop* loop);
+        void remove_dead_instructions(Function* func);
+
+        bool enters_body(Loop* loop);
+        bool can_hoist(Instruction* inst, Loop* loop, const LoopSummary& summary);
+        void hoist(Instruction* inst, Loop* loop);
+        bool analyze_affine(Value* index, Loop* loop, AffineIndex& out);
+
+        Value* emit_const_int(BasicBlock* block, int64_t value, TypePtr type);
+        Value* emit_binary(BasicBlock* block, Opcode op, Value* left, Value* right);
+        Value* emit_element_addr(BasicBlock* block, Value* array, Value* index, TypePtr type);
+
+    public:
+        LoopOptimizer() = default;
+
+        void run(Module* module);
+        void run(Function* func);
+
+        const Stats& get_stats() const { return stats; }
+    };
+
+} // namespace Fern::HLIR
@@ -1,21 +1,131 @@
 // jit_executor.cpp
 #include "jit.hpp"
 #include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h>
+#include <llvm/ExecutionEngine/SectionMemoryManager.h>
+#include <llvm/Object/SymbolSize.h>
+#include <llvm/Support/Process.h>
 #include <llvm/Support/TargetSelect.h>
+#include <cstdio>
 #include <iostream>
+#include <mutex>
 
 namespace Fern
 {
 
-    JIT::JIT()
+    // Appends "<start> <size> <name>" for every function in each loaded object to
+    // /tmp/perf-<pid>.map, which perf report reads as-is to name samples in JIT'd code
+    class PerfMapListener : public llvm::JITEventListener
+    {
+    private:
+        std::mutex mutex;
+        std::FILE *file = nullptr;
+
+    public:
+        PerfMapListener()
+        {
+            std::string path = "/tmp/perf-" + std::to_string(llvm::sys::Process::getProcessId()) + ".map";
+            file = std::fopen(path.c_str(), "a");
+        }
+
+        ~PerfMapListener() override
+        {
+            if (file)
+            {
+                std::fclose(file);
+            }
+        }
+
+        void notifyObjectLoaded(ObjectKey, const llvm::object::ObjectFile &object,
+                                const llvm::RuntimeDyld::LoadedObjectInfo &info) override
+        {
+            // The debug copy has its symbols at their load addresses
+            auto loaded = info.getObjectForDebug(object);
+            if (!file || !loaded.getBinary())
+            {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto &[symbol, size] : llvm::object::computeSymbolSizes(*loaded.getBinary()))
+            {
+                auto type = symbol.getType();
+                if (!type || *type != llvm::object::SymbolRef::ST_Function || size == 0)
+                {
+                    llvm::consumeError(type.takeError());
+                    continue;
+                }
+                auto name = symbol.getName();
+                auto address = symbol.getAddress();
+                if (!name || !address)
+                {
+                    llvm::consumeError(name.takeError());
+                    llvm::consumeError(address.takeError());
+                    continue;
+                }
+                std::fprintf(file, "%llx %llx %s\n", static_cast<unsigned long long>(*address),
+                             static_cast<unsigned long long>(size), name->str().c_str());
+            }
+            std::fflush(file);
+        }
+    };
+
+    JIT::JIT(JITMode mode, unsigned compile_threads, bool profiling) : mode(mode)
     {
         // Initialize LLVM targets (if not already done)
         llvm::InitializeNativeTarget();
         llvm::InitializeNativeTargetAsmPrinter();
         llvm::InitializeNativeTargetAsmParser();
 
-        // Create LLJIT instance
-        auto jit_expected = llvm::orc::LLJITBuilder().create();
+        if (profiling)
+        {
+            perf_map = std::make_unique<PerfMapListener>();
+        }
+
+        // Event listeners only exist for RuntimeDyld, so profiling replaces the default linker.
+        // The GDB and perf listeners are process-wide singletons; perf's is null when LLVM
+        // was built without it.
+        auto create_object_layer = [this](llvm::orc::ExecutionSession &es, const llvm::Triple &)
+            -> llvm::Expected<std::unique_ptr<llvm::orc::ObjectLayer>>
+        {
+            auto layer = std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(
+                es, []() { return std::make_unique<llvm::SectionMemoryManager>(); });
+            layer->registerJITEventListener(*llvm::JITEventListener::createGDBRegistrationListener());
+            if (auto *perf = llvm::JITEventListener::createPerfJITEventListener())
+            {
+                layer->registerJITEventListener(*perf);
+            }
+            layer->registerJITEventListener(*perf_map);
+            return std::unique_ptr<llvm::orc::ObjectLayer>(std::move(layer));
+        };
+
+        // Create LLJIT instance; the lazy one adds a compile-on-demand layer on top
+        auto configure = [&](auto &jit_builder)
+        {
+            if (compile_threads > 1)
+            {
+                jit_builder.setNumCompileThreads(compile_threads);
+            }
+            if (profiling)
+            {
+                jit_builder.setObjectLinkingLayerCreator(create_object_layer);
+            }
+        };
+        auto create_jit = [&]() -> llvm::Expected<std::unique_ptr<llvm::orc::LLJIT>>
+        {
+            if (mode == JITMode::Lazy)
+            {
+                llvm::orc::LLLazyJITBuilder jit_builder;
+                configure(jit_builder);
+                return jit_builder.create();
+            }
+
+            llvm::orc::LLJITBuilder jit_builder;
+            configure(jit_builder);
+            return jit_builder.create();
+        };
+
+        auto jit_expected = create_jit();
         if (!jit_expected)
         {
             llvm::errs() << "Failed to create JIT: "
@@ -38,13 +148,34 @@ namespace Fern
             exit(1);
         }
         main_dylib.addGenerator(std::move(*generator));
+
+        if (mode == JITMode::Tiered)
+        {
+            tiers = std::make_unique<TierManager>(*jit);
+        }
     }
 
     bool JIT::add_module(std::unique_ptr<llvm::Module> module,
                          std::unique_ptr<llvm::LLVMContext> context)
     {
-        auto err = jit->addIRModule(
-            llvm::orc::ThreadSafeModule(std::move(module), std::move(context)));
+        if (mode == JITMode::Tiered)
+        {
+            if (auto err = tiers->add_module(std::move(module), std::move(context)))
+            {
+                llvm::errs() << "Failed to add module: "
+                             << llvm::toString(std::move(err)) << "\n";
+                return false;
+            }
+            return true;
+        }
+
+        llvm::orc::ThreadSafeModule thread_safe_module(std::move(module), std::move(context));
+
+        // Lazy modules are only scanned for their symbols here; each function body is
+        // split out and compiled when its stub is first called
+        auto err = mode == JITMode::Lazy
+            ? static_cast<llvm::orc::LLLazyJIT &>(*jit).addLazyIRModule(std::move(thread_safe_module))
+            : jit->addIRModule(std::move(thread_safe_module));
 
         if (err)
         {
@@ -57,7 +188,92 @@ namespace Fern
 
     llvm::Expected<llvm::orc::ExecutorAddr> JIT::lookup(const std::string &name)
     {
+        // Tier-0 code is compiled here, before anything can call through its stubs
+        if (tiers)
+        {
+            if (auto err = tiers->link_pending())
+            {
+                return std::move(err);
+            }
+        }
         return jit->lookup(name);
     }
 
+    llvm::orc::JITDylib *JIT::create_library(const std::string &name)
+    {
+        auto library = jit->createJITDylib(name);
+        if (!library)
+        {
+            llvm::errs() << "Failed to create JIT library " << name << ": "
+                         << llvm::toString(library.takeError()) << "\n";
+            return nullptr;
+        }
+
+        // The main library also holds the process symbols, so libc resolves through it too
+        library->addToLinkOrder(jit->getMainJITDylib());
+        return &*library;
+    }
+
+    bool JIT::add_module(std::unique_ptr<llvm::Module> module,
+                         std::unique_ptr<llvm::LLVMContext> context,
+                         llvm::orc::JITDylib &library)
+    {
+        llvm::orc::ThreadSafeModule thread_safe_module(std::move(module), std::move(context));
+        if (auto err = jit->addIRModule(library, std::move(thread_safe_module)))
+        {
+            llvm::errs() << "Failed to add module: "
+                         << llvm::toString(std::move(err)) << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    llvm::Expected<llvm::orc::ExecutorAddr> JIT::lookup(llvm::orc::JITDylib &library, const std::string &name)
+    {
+        return jit->lookup(library, name);
+    }
+
+    void JIT::remove_library(llvm::orc::JITDylib &library)
+    {
+        if (auto err = jit->getExecutionSession().removeJITDylib(library))
+        {
+            llvm::errs() << "Failed to remove JIT library: "
+                         << llvm::toString(std::move(err)) << "\n";
+        }
+    }
+
+    void JIT::set_tier_source(const llvm::Module &module)
+    {
+        if (tiers)
+        {
+            tiers->set_source(module);
+        }
+    }
+
+    void JIT::set_tier_threshold(uint64_t threshold)
+    {
+        if (tiers)
+        {
+            tiers->set_threshold(threshold);
+        }
+    }
+
+    void JIT::wait_for_tier_ups()
+    {
+        if (tiers)
+        {
+            tiers->wait_idle();
+        }
+    }
+
+    std::vector<TierUpEvent> JIT::get_tier_events() const
+    {
+        return tiers ? tiers->get_events() : std::vector<TierUpEvent>();
+    }
+
+    std::vector<FunctionCounter> JIT::get_tier_counters() const
+    {
+        return tiers ? tiers->get_counters() : std::vector<FunctionCounter>();
+    }
+
 } // namespace Fern
@@ -1,20 +1,43 @@
 #pragma once
+#include <llvm/ExecutionEngine/JITEventListener.h>
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
 #include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 #include <llvm/IR/Module.h>
 #include <llvm/Support/Error.h>
+#include "tiered_jit.hpp"
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace Fern
 {
+    // Eager compiles a whole module the first time anything in it is looked up.
+    // Lazy puts every function behind a stub and compiles it on its first call,
+    // so functions that never run are never compiled.
+    // Tiered runs unoptimized, counting code first and recompiles hot functions
+    // at -O3 in the background (see TierManager).
+    enum class JITMode
+    {
+        Eager,
+        Lazy,
+        Tiered
+    };
+
     class JIT
     {
     private:
+        std::unique_ptr<llvm::JITEventListener> perf_map; // before jit: notified as it frees objects
         std::unique_ptr<llvm::orc::LLJIT> jit;
+        std::unique_ptr<TierManager> tiers; // after jit: its worker must stop before the JIT goes
+        JITMode mode;
 
     public:
-        JIT();
+        // compile_threads > 1 compiles on a thread pool; 0 or 1 compiles on the thread
+        // that looks up (eager) or first calls (lazy) the code.
+        // profiling links through RuntimeDyld so external tools can see the generated code:
+        // GDB through its JIT interface, perf through /tmp/perf-<pid>.map and, when LLVM was
+        // built with perf support, jitdump records with line tables (see `perf inject --jit`)
+        explicit JIT(JITMode mode = JITMode::Eager, unsigned compile_threads = 0, bool profiling = false);
         ~JIT() = default;
 
         bool add_module(std::unique_ptr<llvm::Module> module,
@@ -22,6 +45,25 @@ namespace Fern
 
         llvm::Expected<llvm::orc::ExecutorAddr> lookup(const std::string &name);
 
+        // A library of its own that links against the modules added above, so code added to
+        // it can call theirs and be removed again without them. Names only need to be unique
+        // within a library. Eager mode only; null if LLVM refuses the name
+        llvm::orc::JITDylib *create_library(const std::string &name);
+        bool add_module(std::unique_ptr<llvm::Module> module,
+                        std::unique_ptr<llvm::LLVMContext> context,
+                        llvm::orc::JITDylib &library);
+        llvm::Expected<llvm::orc::ExecutorAddr> lookup(llvm::orc::JITDylib &library, const std::string &name);
+
+        // Frees the library's code; nothing may call into it afterwards
+        void remove_library(llvm::orc::JITDylib &library);
+
+        // Tiered mode only; the other modes ignore these or return nothing
+        void set_tier_source(const llvm::Module &module);
+        void set_tier_threshold(uint64_t threshold);
+        void wait_for_tier_ups();
+        std::vector<TierUpEvent> get_tier_events() const;
+        std::vector<FunctionCounter> get_tier_counters() const;
+
         template <typename FuncType>
         FuncType *get_function(const std::string &name)
         {
@@ -0,0 +1,515 @@
+// json.cpp - Just enough JSON for the language server protocol
+#include "json.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace Fern::LSP
+{
+
+    const std::string &Json::as_string() const
+    {
+        static const std::string empty;
+        auto *text = std::get_if<std::string>(&value);
+        return text ? *text : empty;
+    }
+
+    double Json::as_number() const
+    {
+        auto *number = std::get_if<double>(&value);
+        return number ? *number : 0.0;
+    }
+
+    bool Json::as_bool() const
+    {
+        auto *flag = std::get_if<bool>(&value);
+        return flag && *flag;
+    }
+
+    const Json::Array &Json::as_array() const
+    {
+        static const Array empty;
+        auto *array = std::get_if<Array>(&value);
+        return array ? *array : empty;
+    }
+
+    const Json &Json::operator[](std::string_view key) const
+    {
+        static const Json null;
+        if (auto *object = std::get_if<Object>(&value))
+        {
+            for (const auto &[name, member] : *object)
+            {
+                if (name == key)
+                {
+                    return member;
+                }
+            }
+        }
+        return null;
+    }
+
+    bool Json::contains(std::string_view key) const
+    {
+        if (auto *object = std::get_if<Object>(&value))
+        {
+            for (const auto &member : *object)
+            {
+                if (member.first == key)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    Json &Json::set(std::string key, Json member)
+    {
+        if (is_null())
+        {
+            value = Object();
+        }
+        auto &object = std::get<Object>(value);
+        for (auto &[name, existing] : object)
+        {
+            if (name == key)
+            {
+                existing = std::move(member);
+                return *this;
+            }
+        }
+        object.emplace_back(std::move(key), std::move(member));
+        return *this;
+    }
+
+    // ============================================================================
+    // Writing
+    // ============================================================================
+
+    static void dump_string(const std::string &text, std::string &out)
+    {
+        out += '"';
+        for (unsigned char c : text)
+        {
+            switch (c)
+            {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (c < 0x20)
+                {
+                    char escape[8];
+                    std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+                    out += escape;
+                }
+                else
+                {
+                    out += static_cast<char>(c);
+                }
+            }
+        }
+        out += '"';
+    }
+
+    void Json::dump(std::string &out) const
+    {
+        if (std::holds_alternative<std::nullptr_t>(value))
+        {
+            out += "null";
+        }
+        else if (auto *flag = std::get_if<bool>(&value))
+        {
+            out += *flag ? "true" : "false";
+        }
+        else if (auto *number = std::get_if<double>(&value))
+        {
+            // Ids, lines and columns are integers, and clients expect them written as such
+            if (std::isfinite(*number) && *number == std::floor(*number) && std::fabs(*number) < 1e15)
+            {
+                out += std::to_string(static_cast<int64_t>(*number));
+            }
+            else if (std::isfinite(*number))
+            {
+                char text[32];
+                std::snprintf(text, sizeof(text), "%.17g", *number);
+                out += text;
+            }
+            else
+            {
+                out += "null";
+            }
+        }
+        else if (auto *text = std::get_if<std::string>(&value))
+        {
+            dump_string(*text, out);
+        }
+        else if (auto *array = std::get_if<Array>(&value))
+        {
+            out += '[';
+            for (size_t i = 0; i < array->size(); i++)
+            {
+                if (i > 0)
+                {
+                    out += ',';
+                }
+                (*array)[i].dump(out);
+            }
+            out += ']';
+        }
+        else
+        {
+            const auto &object = std::get<Object>(value);
+            out += '{';
+            for (size_t i = 0; i < object.size(); i++)
+            {
+                if (i > 0)
+                {
+                    out += ',';
+                }
+                dump_string(object[i].first, out);
+                out += ':';
+                object[i].second.dump(out);
+            }
+            out += '}';
+        }
+    }
+
+    std::string Json::dump() const
+    {
+        std::string out;
+        dump(out);
+        return out;
+    }
+
+    // ============================================================================
+    // Parsing
+    // ============================================================================
+
+    namespace
+    {
+        class JsonParser
+        {
+        public:
+            explicit JsonParser(std::string_view text) : text(text) {}
+
+            std::optional<Json> parse_document()
+            {
+                auto result = parse_value(0);
+                skip_whitespace();
+                if (!result || position != text.size())
+                {
+                    return std::nullopt;
+                }
+                return result;
+            }
+
+        private:
+            static constexpr int max_depth = 256;
+
+            std::string_view text;
+            size_t position = 0;
+
+            void skip_whitespace()
+            {
+                while (position < text.size() &&
+                       (text[position] == ' ' || text[position] == '\t' || text[position] == '\n' ||
+                        text[position] == '\r'))
+                {
+                    position++;
+                }
+            }
+
+            bool consume(char expected)
+            {
+                skip_whitespace();
+                if (position < text.size() && text[position] == expected)
+                {
+                    position++;
+                    return true;
+                }
+                return false;
+            }
+
+            bool consume_word(std::string_view word)
+            {
+                if (text.substr(position, word.size()) != word)
+                {
+                    return false;
+                }
+                position += word.size();
+                return true;
+            }
+
+            std::optional<Json> parse_value(int depth)
+            {
+                if (depth > max_depth)
+                {
+                    return std::nullopt;
+                }
+                skip_whitespace();
+                if (position >= text.size())
+                {
+                    return std::nullopt;
+                }
+
+                switch (text[position])
+                {
+                case '{':
+                    return parse_object(depth);
+                case '[':
+                    return parse_array(depth);
+                case '"':
+                {
+                    auto text_value = parse_string();
+                    if (!text_value)
+                    {
+                        return std::nullopt;
+                    }
+                    return Json(std::move(*text_value));
+                }
+                case 't':
+                    return consume_word("true") ? std::optional<Json>(Json(true)) : std::nullopt;
+                case 'f':
+                    return consume_word("false") ? std::optional<Json>(Json(false)) : std::nullopt;
+                case 'n':
+                    return consume_word("null") ? std::optional<Json>(Json()) : std::nullopt;
+                default:
+                    return parse_number();
+                }
+            }
+
+            std::optional<Json> parse_object(int depth)
+            {
+                position++; // {
+                Json::Object object;
+                if (consume('}'))
+                {
+                    return Json(std::move(object));
+                }
+                do
+                {
+                    skip_whitespace();
+                    auto key = parse_string();
+                    if (!key || !consume(':'))
+                    {
+                        return std::nullopt;
+                    }
+                    auto member = parse_value(depth + 1);
+                    if (!member)
+                    {
+                        return std::nullopt;
+                    }
+                    object.emplace_back(std::move(*key), std::move(*member));
+                } while (consume(','));
+
+                if (!consume('}'))
+                {
+                    return std::nullopt;
+                }
+                return Json(std::move(object));
+            }
+
+            std::optional<Json> parse_array(int depth)
+            {
+                position++; // [
+                Json::Array array;
+                if (consume(']'))
+                {
+                    return Json(std::move(array));
+                }
+                do
+                {
+                    auto element = parse_value(depth + 1);
+                    if (!element)
+                    {
+                        return std::nullopt;
+                    }
+                    array.push_back(std::move(*element));
+                } while (consume(','));
+
+                if (!consume(']'))
+                {
+                    return std::nullopt;
+                }
+                return Json(std::move(array));
+            }
+
+            std::optional<Json> parse_number()
+            {
+                size_t start = position;
+                if (position < text.size() && text[position] == '-')
+                {
+                    position++;
+                }
+                while (position < text.size() &&
+                       (std::isdigit(static_cast<unsigned char>(text[position])) || text[position] == '.' ||
+                        text[position] == 'e' || text[position] == 'E' || text[position] == '+' ||
+                        text[position] == '-'))
+                {
+                    position++;
+                }
+                if (position == start)
+                {
+                    return std::nullopt;
+                }
+
+                std::string digits(text.substr(start, position - start));
+                char *end = nullptr;
+                double number = std::strtod(digits.c_str(), &end);
+                if (end != digits.c_str() + digits.size())
+                {
+                    return std::nullopt;
+                }
+                return Json(number);
+            }
+
+            static void append_utf8(uint32_t code, std::string &out)
+            {
+                if (code < 0x80)
+                {
+                    out += static_cast<char>(code);
+                }
+                else if (code < 0x800)
+                {
+                    out += static_cast<char>(0xC0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else if (code < 0x10000)
+                {
+                    out += static_cast<char>(0xE0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else
+                {
+                    out += static_cast<char>(0xF0 | (code >> 18));
+                    out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
+
+            std::optional<uint32_t> parse_hex4()
+            {
+                if (position + 4 > text.size())
+                {
+                    return std::nullopt;
+                }
+                uint32_t code = 0;
+                for (int i = 0; i < 4; i++)
+                {
+                    char c = text[position++];
+                    code <<= 4;
+                    if (c >= '0' && c <= '9')
+                        code |= c - '0';
+                    else if (c >= 'a' && c <= 'f')
+                        code |= c - 'a' + 10;
+                    else if (c >= 'A' && c <= 'F')
+                        code |= c - 'A' + 10;
+                    else
+                        return std::nullopt;
+                }
+                return code;
+            }
+
+            std::optional<std::string> parse_string()
+            {
+                if (position >= text.size() || text[position] != '"')
+                {
+                    return std::nullopt;
+                }
+                position++;
+
+                std::string out;
+                while (position < text.size())
+                {
+                    char c = text[position++];
+                    if (c == '"')
+                    {
+                        return out;
+                    }
+                    if (c != '\\')
+                    {
+                        out += c;
+                        continue;
+                    }
+                    if (position >= text.size())
+                    {
+                        return std::nullopt;
+                    }
+
+                    char escape = text[position++];
+                    switch (escape)
+                    {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        out += escape;
+                        break;
+                    case 'b':
+                        out += '\b';
+                        break;
+                    case 'f':
+                        out += '\f';
+                        break;
+                    case 'n':
+                        out += '\n';
+                        break;
+                    case 'r':
+                        out += '\r';
+                        break;
+                    case 't':
+                        out += '\t';
+                        break;
+                    case 'u':
+                    {
+                        auto code = parse_hex4();
+                        if (!code)
+                        {
+                            return std::nullopt;
+                        }
+                        // A surrogate pair spells one code point above the basic plane
+                        if (*code >= 0xD800 && *code < 0xDC00 && text.substr(position, 2) == "\\u")
+                        {
+                            position += 2;
+                            auto low = parse_hex4();
+                            if (!low || *low < 0xDC00 || *low >= 0xE000)
+                            {
+                                return std::nullopt;
+                            }
+                            *code = 0x10000 + ((*code - 0xD800) << 10) + (*low - 0xDC00);
+                        }
+                        append_utf8(*code, out);
+                        break;
+                    }
+                    default:
+                        return std::nullopt;
+                    }
+                }
+                return std::nullopt;
+            }
+        };
+    } // namespace
+
+    std::optional<Json> Json::parse(std::string_view text)
+    {
+        return JsonParser(text).parse_document();
+    }
+
+} // namespace Fern::LSP
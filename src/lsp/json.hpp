@@ -0,0 +1,71 @@
+// json.hpp - Just enough JSON for the language server protocol
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace Fern::LSP
+{
+
+    /**
+     * @brief A JSON value: read from a client's message, or built up for a reply
+     *
+     * Objects keep their members in order in a vector, since protocol messages have a
+     * handful of members each. Numbers are doubles, which holds every request id and
+     * position a client sends exactly.
+     */
+    class Json
+    {
+    public:
+        using Array = std::vector<Json>;
+        using Object = std::vector<std::pair<std::string, Json>>;
+
+        Json() = default;
+        Json(std::nullptr_t) {}
+        Json(bool value) : value(value) {}
+        Json(int value) : value(static_cast<double>(value)) {}
+        Json(int64_t value) : value(static_cast<double>(value)) {}
+        Json(size_t value) : value(static_cast<double>(value)) {}
+        Json(double value) : value(value) {}
+        Json(const char *value) : value(std::string(value)) {}
+        Json(std::string value) : value(std::move(value)) {}
+        Json(Array value) : value(std::move(value)) {}
+        Json(Object value) : value(std::move(value)) {}
+
+        bool is_null() const { return std::holds_alternative<std::nullptr_t>(value); }
+        bool is_string() const { return std::holds_alternative<std::string>(value); }
+        bool is_number() const { return std::holds_alternative<double>(value); }
+        bool is_array() const { return std::holds_alternative<Array>(value); }
+        bool is_object() const { return std::holds_alternative<Object>(value); }
+
+        // Each of these returns an empty value when this is something else
+        const std::string &as_string() const;
+        double as_number() const;
+        int64_t as_int() const { return static_cast<int64_t>(as_number()); }
+        bool as_bool() const;
+        const Array &as_array() const;
+
+        // Null when this isn't an object or has no such member
+        const Json &operator[](std::string_view key) const;
+        bool contains(std::string_view key) const;
+
+        // Adds the member, or replaces it; turns a null into an object first
+        Json &set(std::string key, Json member);
+
+        std::string dump() const;
+        void dump(std::string &out) const;
+
+        // Empty when `text` isn't one well-formed JSON value
+        static std::optional<Json> parse(std::string_view text);
+
+    private:
+        std::variant<std::nullptr_t, bool, double, std::string, Array, Object> value;
+    };
+
+} // namespace Fern::LSP
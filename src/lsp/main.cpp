@@ -0,0 +1,15 @@
+// main.cpp - FernLSP, the language server editors start for Fern files
+#include "server.hpp"
+#include "common/logger.hpp"
+
+#include <iostream>
+
+int main()
+{
+    // stdout carries the protocol, so nothing else may be written to it
+    Fern::Logger::get_instance().set_console_level(Fern::LogLevel::NONE);
+    std::ios::sync_with_stdio(false);
+
+    Fern::LSP::LanguageServer server(std::cin, std::cout);
+    return server.run();
+}
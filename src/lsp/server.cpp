@@ -0,0 +1,447 @@
+// server.cpp - The Fern language server: the language server protocol over a pair of streams
+#include "server.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+namespace Fern::LSP
+{
+
+    // JSON-RPC error codes
+    static constexpr int InvalidRequest = -32600;
+    static constexpr int MethodNotFound = -32601;
+
+    static std::optional<std::string> read_file(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            return std::nullopt;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return buffer.str();
+    }
+
+    // Converts between byte offsets into a text and the protocol's line/column positions
+    class LineIndex
+    {
+    public:
+        explicit LineIndex(const std::string &text)
+        {
+            starts.push_back(0);
+            for (size_t i = 0; i < text.size(); i++)
+            {
+                if (text[i] == '\n')
+                    starts.push_back(static_cast<int>(i + 1));
+            }
+            size = static_cast<int>(text.size());
+        }
+
+        int offset_of(const Json &position) const
+        {
+            auto line = position["line"].as_int();
+            if (line < 0)
+                return 0;
+            if (line >= static_cast<int64_t>(starts.size()))
+                return size;
+
+            int start = starts[line];
+            int end = line + 1 < static_cast<int64_t>(starts.size()) ? starts[line + 1] - 1 : size;
+            auto column = std::max<int64_t>(0, position["character"].as_int());
+            return static_cast<int>(std::min<int64_t>(start + column, end));
+        }
+
+        Json position_of(int offset) const
+        {
+            offset = std::clamp(offset, 0, size);
+            auto line = std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin() - 1;
+            Json position;
+            position.set("line", static_cast<int64_t>(line));
+            position.set("character", static_cast<int64_t>(offset - starts[line]));
+            return position;
+        }
+
+        Json range_of(const SourceRange &range) const
+        {
+            Json result;
+            result.set("start", position_of(range.start.offset));
+            result.set("end", position_of(range.end_offset()));
+            return result;
+        }
+
+    private:
+        std::vector<int> starts; // offset of each line's first byte
+        int size = 0;
+    };
+
+    LanguageServer::LanguageServer(std::istream &in, std::ostream &out) : in(in), out(out) {}
+
+    // ============================================================================
+    // Transport
+    // ============================================================================
+
+    std::optional<std::string> LanguageServer::read_message()
+    {
+        size_t length = 0;
+        bool has_length = false;
+        std::string header;
+        while (std::getline(in, header))
+        {
+            if (!header.empty() && header.back() == '\r')
+                header.pop_back();
+            if (header.empty())
+            {
+                if (has_length)
+                    break;
+                continue;
+            }
+
+            static constexpr std::string_view content_length = "Content-Length:";
+            if (header.compare(0, content_length.size(), content_length) == 0)
+            {
+                length = std::strtoull(header.c_str() + content_length.size(), nullptr, 10);
+                has_length = true;
+            }
+        }
+        if (!has_length || !in)
+        {
+            return std::nullopt;
+        }
+
+        std::string body(length, '\0');
+        in.read(body.data(), static_cast<std::streamsize>(length));
+        if (static_cast<size_t>(in.gcount()) != length)
+        {
+            return std::nullopt;
+        }
+        return body;
+    }
+
+    void LanguageServer::send(const Json &message)
+    {
+        auto body = message.dump();
+        out << "Content-Length: " << body.size() << "\r\n\r\n" << body;
+        out.flush();
+    }
+
+    void LanguageServer::reply(const Json &id, Json result)
+    {
+        Json message;
+        message.set("jsonrpc", "2.0");
+        message.set("id", id);
+        message.set("result", std::move(result));
+        send(message);
+    }
+
+    void LanguageServer::reply_error(const Json &id, int code, const std::string &text)
+    {
+        Json error;
+        error.set("code", code);
+        error.set("message", text);
+
+        Json message;
+        message.set("jsonrpc", "2.0");
+        message.set("id", id);
+        message.set("error", std::move(error));
+        send(message);
+    }
+
+    int LanguageServer::run()
+    {
+        while (!exited)
+        {
+            auto body = read_message();
+            if (!body)
+            {
+                break;
+            }
+            if (auto message = Json::parse(*body))
+            {
+                handle(*message);
+            }
+        }
+        return shutdown_requested ? 0 : 1;
+    }
+
+    void LanguageServer::handle(const Json &message)
+    {
+        const auto &method = message["method"].as_string();
+        const auto &params = message["params"];
+        bool is_request = message.contains("id");
+        const auto &id = message["id"];
+
+        if (is_request && shutdown_requested)
+        {
+            reply_error(id, InvalidRequest, "Server is shutting down");
+            return;
+        }
+
+        if (method == "initialize")
+            reply(id, initialize(params));
+        else if (method == "shutdown")
+        {
+            shutdown_requested = true;
+            reply(id, Json());
+        }
+        else if (method == "exit")
+            exited = true;
+        else if (method == "textDocument/didOpen")
+            did_open(params);
+        else if (method == "textDocument/didChange")
+            did_change(params);
+        else if (method == "textDocument/didClose")
+            did_close(params);
+        else if (method == "textDocument/definition")
+            reply(id, definition(params));
+        else if (method == "textDocument/hover")
+            reply(id, hover(params));
+        else if (is_request)
+            reply_error(id, MethodNotFound, "Unhandled method: " + method);
+        // Other notifications (initialized, $/cancelRequest, ...) need nothing from us
+    }
+
+    // ============================================================================
+    // URIs
+    // ============================================================================
+
+    std::string LanguageServer::path_of(const std::string &uri)
+    {
+        static constexpr std::string_view scheme = "file://";
+        std::string_view rest = uri;
+        if (rest.substr(0, scheme.size()) == scheme)
+            rest.remove_prefix(scheme.size());
+
+        std::string path;
+        for (size_t i = 0; i < rest.size(); i++)
+        {
+            if (rest[i] == '%' && i + 2 < rest.size() && std::isxdigit(static_cast<unsigned char>(rest[i + 1])) &&
+                std::isxdigit(static_cast<unsigned char>(rest[i + 2])))
+            {
+                path += static_cast<char>(std::stoi(std::string(rest.substr(i + 1, 2)), nullptr, 16));
+                i += 2;
+            }
+            else
+            {
+                path += rest[i];
+            }
+        }
+
+        // file:///c:/src -> c:/src
+        if (path.size() > 2 && path[0] == '/' && std::isalpha(static_cast<unsigned char>(path[1])) && path[2] == ':')
+            path.erase(0, 1);
+
+        uris.emplace(path, uri);
+        return path;
+    }
+
+    std::string LanguageServer::uri_of(const std::string &path)
+    {
+        auto known = uris.find(path);
+        if (known != uris.end())
+        {
+            return known->second;
+        }
+
+        std::string uri = "file://";
+        if (path.empty() || path[0] != '/')
+            uri += '/';
+        for (unsigned char c : path)
+        {
+            if (std::isalnum(c) || c == '/' || c == '-' || c == '_' || c == '.' || c == '~')
+            {
+                uri += static_cast<char>(c);
+            }
+            else if (c == '\\')
+            {
+                uri += '/';
+            }
+            else
+            {
+                char escape[4];
+                std::snprintf(escape, sizeof(escape), "%%%02X", c);
+                uri += escape;
+            }
+        }
+        uris.emplace(path, uri);
+        return uri;
+    }
+
+    // ============================================================================
+    // Methods
+    // ============================================================================
+
+    void LanguageServer::publish(const std::vector<Document *> &documents)
+    {
+        for (auto document : documents)
+        {
+            LineIndex lines(document->text);
+            Json::Array diagnostics;
+            for (const auto &diagnostic : document->current_diagnostics())
+            {
+                Json item;
+                item.set("range", lines.range_of(diagnostic.has_location ? diagnostic.location
+                                                                         : SourceRange(SourceLocation(), 0)));
+                item.set("severity", 1);
+                item.set("source", "fern");
+                item.set("message", diagnostic.message);
+                diagnostics.push_back(std::move(item));
+            }
+
+            Json params;
+            params.set("uri", uri_of(document->name));
+            params.set("diagnostics", std::move(diagnostics));
+
+            Json message;
+            message.set("jsonrpc", "2.0");
+            message.set("method", "textDocument/publishDiagnostics");
+            message.set("params", std::move(params));
+            send(message);
+        }
+    }
+
+    Json LanguageServer::initialize(const Json &params)
+    {
+        // Every Fern file in the project, so definitions in files the client hasn't opened resolve
+        std::string root;
+        if (params["rootUri"].is_string())
+            root = path_of(params["rootUri"].as_string());
+        else if (params["rootPath"].is_string())
+            root = params["rootPath"].as_string();
+
+        std::vector<SourceFile> files;
+        std::error_code error;
+        if (!root.empty() && std::filesystem::is_directory(root, error))
+        {
+            namespace fs = std::filesystem;
+            fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, error);
+            for (; !error && it != fs::recursive_directory_iterator(); it.increment(error))
+            {
+                auto name = it->path().filename().string();
+                if (it->is_directory(error))
+                {
+                    // .git, build trees and the like
+                    if (!name.empty() && name[0] == '.')
+                        it.disable_recursion_pending();
+                    continue;
+                }
+                if (it->path().extension() != ".fn")
+                    continue;
+
+                auto path = it->path().generic_string();
+                if (auto source = read_file(path))
+                    files.push_back({path, std::move(*source)});
+            }
+        }
+        publish(workspace.load(files));
+
+        Json sync;
+        sync.set("openClose", true);
+        sync.set("change", 1); // full text
+
+        Json capabilities;
+        capabilities.set("textDocumentSync", std::move(sync));
+        capabilities.set("definitionProvider", true);
+        capabilities.set("hoverProvider", true);
+
+        Json info;
+        info.set("name", "FernLSP");
+
+        Json result;
+        result.set("capabilities", std::move(capabilities));
+        result.set("serverInfo", std::move(info));
+        return result;
+    }
+
+    void LanguageServer::did_open(const Json &params)
+    {
+        const auto &document = params["textDocument"];
+        auto path = path_of(document["uri"].as_string());
+
+        // Opening a file changes nothing until its text differs from what was loaded
+        auto existing = workspace.find(path);
+        if (existing && existing->text == document["text"].as_string())
+        {
+            publish({existing});
+            return;
+        }
+        publish(workspace.update(path, document["text"].as_string()));
+    }
+
+    void LanguageServer::did_change(const Json &params)
+    {
+        const auto &changes = params["contentChanges"].as_array();
+        if (changes.empty())
+        {
+            return;
+        }
+        auto path = path_of(params["textDocument"]["uri"].as_string());
+        publish(workspace.update(path, changes.back()["text"].as_string()));
+    }
+
+    void LanguageServer::did_close(const Json &params)
+    {
+        // Back to what's on disk, which may be nothing for a file that was never saved
+        auto path = path_of(params["textDocument"]["uri"].as_string());
+        auto existing = workspace.find(path);
+        auto text = read_file(path).value_or("");
+        if (existing && existing->text == text)
+        {
+            return;
+        }
+        publish(workspace.update(path, std::move(text)));
+    }
+
+    Json LanguageServer::definition(const Json &params)
+    {
+        auto document = workspace.find(path_of(params["textDocument"]["uri"].as_string()));
+        if (!document)
+        {
+            return Json();
+        }
+
+        int offset = LineIndex(document->text).offset_of(params["position"]);
+        auto found = workspace.find_definition(*document, offset);
+        if (!found)
+        {
+            return Json();
+        }
+
+        Json location;
+        location.set("uri", uri_of(found->document->name));
+        location.set("range", LineIndex(found->document->text).range_of(found->range));
+        return location;
+    }
+
+    Json LanguageServer::hover(const Json &params)
+    {
+        auto document = workspace.find(path_of(params["textDocument"]["uri"].as_string()));
+        if (!document)
+        {
+            return Json();
+        }
+
+        int offset = LineIndex(document->text).offset_of(params["position"]);
+        auto description = workspace.describe(*document, offset);
+        if (!description)
+        {
+            return Json();
+        }
+
+        Json contents;
+        contents.set("kind", "markdown");
+        contents.set("value", "```fern\n" + *description + "\n```");
+
+        Json result;
+        result.set("contents", std::move(contents));
+        return result;
+    }
+
+} // namespace Fern::LSP
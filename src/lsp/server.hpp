@@ -0,0 +1,65 @@
+// server.hpp - The Fern language server: the language server protocol over a pair of streams
+#pragma once
+#include "json.hpp"
+#include "workspace.hpp"
+
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Fern::LSP
+{
+
+    /**
+     * @brief Serves one client: diagnostics as files change, go-to-definition and hover
+     *
+     * Messages are JSON-RPC framed with a Content-Length header, as the protocol has it.
+     * Documents are synchronized whole (every change carries the full text), which keeps
+     * the client side trivial; the work an edit costs is bounded by Workspace, not by how
+     * the text arrived.
+     *
+     * Positions are sent as lines and byte columns. The protocol counts columns in UTF-16
+     * units, which agrees for the ASCII that Fern identifiers are made of.
+     */
+    class LanguageServer
+    {
+    public:
+        LanguageServer(std::istream &in, std::ostream &out);
+
+        // Serve until the client sends exit or the input ends. Returns the process exit code
+        int run();
+
+        // Handle one message, sending whatever it calls for. Public so tests and benchmarks
+        // can drive the server without framing
+        void handle(const Json &message);
+
+        const Workspace &get_workspace() const { return workspace; }
+
+    private:
+        std::istream &in;
+        std::ostream &out;
+        Workspace workspace;
+        std::unordered_map<std::string, std::string> uris; // document name (a path) -> the client's URI for it
+        bool shutdown_requested = false;
+        bool exited = false;
+
+        std::optional<std::string> read_message();
+        void send(const Json &message);
+        void reply(const Json &id, Json result);
+        void reply_error(const Json &id, int code, const std::string &message);
+        void publish(const std::vector<Document *> &documents);
+
+        std::string path_of(const std::string &uri);
+        std::string uri_of(const std::string &path);
+
+        Json initialize(const Json &params);
+        void did_open(const Json &params);
+        void did_change(const Json &params);
+        void did_close(const Json &params);
+        Json definition(const Json &params);
+        Json hover(const Json &params);
+    };
+
+} // namespace Fern::LSP
@@ -0,0 +1,785 @@
+// workspace.cpp - A project's Fern files, analyzed and kept resident for the language server
+#include "workspace.hpp"
+
+#include "binding/bound_tree_builder.hpp"
+#include "parser/lexer.hpp"
+#include "parser/parser.hpp"
+#include "semantic/symbol_table_builder.hpp"
+#include "semantic/type_resolver.hpp"
+
+#include <algorithm>
+
+namespace Fern::LSP
+{
+
+    static Diagnostic file_diagnostic(std::string message)
+    {
+        return {SourceRange(SourceLocation(), 0), false, std::move(message)};
+    }
+
+    // ============================================================================
+    // What a file declares and uses
+    // ============================================================================
+
+    // The bodies of every function, constructor and accessor, in source order
+    static void collect_bodies(BaseSyntax *node, std::vector<SourceRange> &bodies)
+    {
+        if (auto function = node->as<FunctionDeclSyntax>())
+        {
+            if (function->body)
+                bodies.push_back(function->body->location);
+        }
+        else if (auto constructor = node->as<ConstructorDeclSyntax>())
+        {
+            if (constructor->body)
+                bodies.push_back(constructor->body->location);
+        }
+        else if (auto property = node->as<PropertyDeclSyntax>())
+        {
+            for (auto accessor : {property->getter, property->setter})
+            {
+                if (!accessor)
+                    continue;
+                if (auto block = std::get_if<BlockSyntax *>(&accessor->body))
+                    bodies.push_back((*block)->location);
+                else if (auto expression = std::get_if<BaseExprSyntax *>(&accessor->body))
+                    bodies.push_back((*expression)->location);
+            }
+        }
+        else if (auto type = node->as<TypeDeclSyntax>())
+        {
+            for (auto member : type->members)
+                collect_bodies(member, bodies);
+        }
+        else if (auto ns = node->as<NamespaceDeclSyntax>())
+        {
+            if (ns->body)
+            {
+                for (auto statement : *ns->body)
+                    collect_bodies(statement, bodies);
+            }
+        }
+    }
+
+    // The source with every body emptied out. Two versions of a file with the same interface
+    // declare the same things, so an edit that keeps it can't have changed another file's view
+    static std::string interface_text(CompilationUnitSyntax *unit, std::string_view source)
+    {
+        std::vector<SourceRange> bodies;
+        for (auto statement : unit->topLevelStatements)
+        {
+            collect_bodies(statement, bodies);
+        }
+
+        std::string text;
+        text.reserve(source.size());
+        size_t position = 0;
+        for (const auto &body : bodies)
+        {
+            size_t start = std::min<size_t>(body.start.offset, source.size());
+            if (start < position)
+                continue;
+            text.append(source, position, start - position);
+            text += "{}";
+            position = std::min<size_t>(body.end_offset(), source.size());
+        }
+        text.append(source, position, std::string::npos);
+        return text;
+    }
+
+    static void collect_declared(BaseStmtSyntax *node, std::vector<std::string> &names)
+    {
+        if (auto type = node->as<TypeDeclSyntax>())
+        {
+            if (type->name)
+                names.push_back(type->name->get_name());
+        }
+        else if (auto function = node->as<FunctionDeclSyntax>())
+        {
+            if (function->name)
+                names.push_back(function->name->get_name());
+        }
+        else if (auto variable = node->as<VariableDeclSyntax>())
+        {
+            if (variable->variable && variable->variable->name)
+                names.push_back(variable->variable->name->get_name());
+        }
+        else if (auto ns = node->as<NamespaceDeclSyntax>())
+        {
+            if (ns->body)
+            {
+                for (auto statement : *ns->body)
+                    collect_declared(statement, names);
+            }
+        }
+    }
+
+    // Names of the namespace-level declarations; members are reached through these
+    static std::vector<std::string> declared_names(CompilationUnitSyntax *unit)
+    {
+        std::vector<std::string> names;
+        for (auto statement : unit->topLevelStatements)
+        {
+            collect_declared(statement, names);
+        }
+        return names;
+    }
+
+    // ============================================================================
+    // Patching a file's symbols in place
+    // ============================================================================
+
+    // Whether two versions of a declaration have the same members, so one can stand in for
+    // the other. For a function only the parameters count; the rest is its body
+    static bool same_shape(Symbol *old_symbol, Symbol *new_symbol)
+    {
+        if (old_symbol->kind != new_symbol->kind || old_symbol->name != new_symbol->name)
+        {
+            return false;
+        }
+
+        if (auto old_function = old_symbol->as<FunctionSymbol>())
+        {
+            auto new_function = new_symbol->as<FunctionSymbol>();
+            if (!new_function || old_function->is_constructor != new_function->is_constructor ||
+                old_function->parameters.size() != new_function->parameters.size())
+            {
+                return false;
+            }
+            for (size_t i = 0; i < old_function->parameters.size(); i++)
+            {
+                if (old_function->parameters[i]->name != new_function->parameters[i]->name)
+                    return false;
+            }
+            return true;
+        }
+
+        auto old_container = old_symbol->as<ContainerSymbol>();
+        auto new_container = new_symbol->as<ContainerSymbol>();
+        if (!old_container || !new_container)
+        {
+            return !old_container && !new_container;
+        }
+        if (old_container->member_order.size() != new_container->member_order.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < old_container->member_order.size(); i++)
+        {
+            if (!same_shape(old_container->member_order[i], new_container->member_order[i]))
+                return false;
+        }
+        return true;
+    }
+
+    // Keep `old_symbol` and its members, taking the new version's locations and function
+    // bodies. The old bodies' symbols go to `retired`
+    static void adopt(Symbol *old_symbol, Symbol *new_symbol, std::unordered_map<Symbol *, Symbol *> &counterparts,
+                      std::vector<std::unique_ptr<Symbol>> &retired)
+    {
+        counterparts[new_symbol] = old_symbol;
+        old_symbol->location = new_symbol->location;
+
+        if (auto old_function = old_symbol->as<FunctionSymbol>())
+        {
+            auto new_function = new_symbol->as<FunctionSymbol>();
+            for (size_t i = 0; i < old_function->parameters.size(); i++)
+            {
+                counterparts[new_function->parameters[i]] = old_function->parameters[i];
+                old_function->parameters[i]->location = new_function->parameters[i]->location;
+            }
+
+            auto old_members = old_function->member_order;
+            for (auto member : old_members)
+            {
+                if (!member->is<ParameterSymbol>())
+                    retired.push_back(old_function->remove_member(member));
+            }
+            auto new_members = new_function->member_order;
+            for (auto member : new_members)
+            {
+                if (!member->is<ParameterSymbol>())
+                    old_function->add_member(new_function->remove_member(member));
+            }
+            return;
+        }
+
+        if (auto old_container = old_symbol->as<ContainerSymbol>())
+        {
+            auto new_container = new_symbol->as<ContainerSymbol>();
+            for (size_t i = 0; i < old_container->member_order.size(); i++)
+            {
+                adopt(old_container->member_order[i], new_container->member_order[i], counterparts, retired);
+            }
+        }
+    }
+
+    // Functions whose return type comes from their body, reset so resolving infers it anew
+    class InferredReturns : public DefaultBoundVisitor
+    {
+    public:
+        explicit InferredReturns(TypeSystem &types) : types(types) {}
+
+        std::vector<std::pair<FunctionSymbol *, TypePtr>> previous;
+
+        void visit(BoundFunctionDeclaration *node) override
+        {
+            auto function = node->symbol ? node->symbol->as<FunctionSymbol>() : nullptr;
+            if (function && node->body && !node->returnTypeExpression && !node->isConstructor)
+            {
+                previous.emplace_back(function, function->return_type);
+                function->return_type = types.get_unresolved();
+            }
+            DefaultBoundVisitor::visit(node);
+        }
+
+    private:
+        TypeSystem &types;
+    };
+
+    // ============================================================================
+    // Workspace
+    // ============================================================================
+
+    Workspace::Workspace() : symbols(types) {}
+
+    Workspace::~Workspace() = default;
+
+    Document *Workspace::find(const std::string &name)
+    {
+        auto it = by_name.find(name);
+        return it != by_name.end() ? it->second : nullptr;
+    }
+
+    Document *Workspace::add(const std::string &name)
+    {
+        if (auto existing = find(name))
+        {
+            return existing;
+        }
+        documents.push_back(std::make_unique<Document>());
+        auto document = documents.back().get();
+        document->name = name;
+        by_name[name] = document;
+        return document;
+    }
+
+    bool Workspace::parse(FileCompilationState &state, std::vector<Diagnostic> &diagnostics,
+                          std::unordered_set<std::string> &referenced)
+    {
+        auto lexer = Lexer(state.file.source());
+        auto tokens = lexer.tokenize_all();
+        for (const auto &error : lexer.get_diagnostics())
+        {
+            if (error.is_error)
+                diagnostics.push_back({SourceRange(error.location, 1), true, error.message});
+        }
+        if (lexer.has_errors())
+        {
+            return false;
+        }
+
+        // Every identifier, for judging which files can see which
+        auto start = tokens.checkpoint();
+        for (; !tokens.at_end(); tokens.advance())
+        {
+            if (tokens.current().kind == TokenKind::Identifier)
+                referenced.insert(tokens.current().text);
+        }
+        tokens.restore(start);
+
+        state.tokens = std::make_unique<TokenStream>(std::move(tokens));
+        state.parser = std::make_unique<Parser>(*state.tokens);
+        state.ast = state.parser->parse();
+        if (!state.ast)
+        {
+            diagnostics.push_back(file_diagnostic("Invalid AST"));
+            return false;
+        }
+
+        for (const auto &error : state.parser->getErrors())
+        {
+            diagnostics.push_back({error.location, true, error.message});
+        }
+        state.parse_complete = diagnostics.empty();
+        return state.parse_complete;
+    }
+
+    std::vector<Document *> Workspace::load(const std::vector<SourceFile> &files)
+    {
+        last_update = {};
+        last_update.declarations_changed = true;
+
+        for (const auto &file : files)
+        {
+            auto document = add(file.filename);
+            document->text = file.source();
+            document->syntax_errors.clear();
+
+            FileCompilationState fresh{};
+            fresh.file = file;
+            std::unordered_set<std::string> referenced;
+            if (parse(fresh, document->syntax_errors, referenced))
+            {
+                document->state = std::move(fresh);
+                document->referenced = std::move(referenced);
+            }
+        }
+
+        std::vector<Document *> all;
+        for (auto &document : documents)
+        {
+            all.push_back(document.get());
+        }
+
+        std::vector<std::unique_ptr<Symbol>> retired;
+        redeclare(all, retired);
+        analyze(all);
+        return all;
+    }
+
+    std::vector<Document *> Workspace::update(const std::string &name, std::string text)
+    {
+        last_update = {};
+        auto document = add(name);
+        document->text = std::move(text);
+        document->syntax_errors.clear();
+
+        FileCompilationState fresh{};
+        fresh.file = {name, document->text};
+        std::unordered_set<std::string> referenced;
+        if (!parse(fresh, document->syntax_errors, referenced))
+        {
+            return {document};
+        }
+
+        // Freed once nothing can reach them: after every tree that did has been rebound
+        std::vector<std::unique_ptr<Symbol>> retired;
+
+        bool same_interface = document->has_symbols && document->state.symbols_complete &&
+                              interface_text(fresh.ast, fresh.file.source()) == document->interface;
+        if (same_interface && patch(*document, fresh, retired))
+        {
+            document->state = std::move(fresh);
+            document->referenced = std::move(referenced);
+            document->diagnostics.clear();
+            if (!analyze({document}, true))
+            {
+                return {document};
+            }
+            // A body edit changed an inferred return type, which other files see like any
+            // other declaration change
+        }
+        else
+        {
+            document->state = std::move(fresh);
+            document->referenced = std::move(referenced);
+        }
+
+        last_update.declarations_changed = true;
+        auto affected = dependents(*document, document->declared);
+        redeclare(affected, retired);
+        analyze(affected);
+        return affected;
+    }
+
+    bool Workspace::patch(Document &document, FileCompilationState &fresh,
+                          std::vector<std::unique_ptr<Symbol>> &retired)
+    {
+        fresh.symbolTable = std::make_unique<SymbolTable>(types);
+        SymbolTableBuilder builder(*fresh.symbolTable);
+        builder.build(fresh.ast);
+        if (!builder.get_errors().empty())
+        {
+            return false;
+        }
+
+        const auto &old_declarations = document.merged.declarations;
+        auto new_declarations = SymbolTable::collect_declarations(fresh.symbolTable->get_global_namespace());
+        if (old_declarations.size() != new_declarations.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < old_declarations.size(); i++)
+        {
+            if (!same_shape(old_declarations[i], new_declarations[i]))
+                return false;
+        }
+
+        std::unordered_map<Symbol *, Symbol *> counterparts;
+        for (size_t i = 0; i < old_declarations.size(); i++)
+        {
+            adopt(old_declarations[i], new_declarations[i], counterparts, retired);
+        }
+
+        // The new AST's mappings, onto the symbols that were kept
+        for (auto syntax : document.merged.syntax)
+        {
+            symbols.unmap_ast(syntax);
+        }
+        document.merged.syntax.clear();
+        for (auto &[syntax, symbol] : fresh.symbolTable->get_ast_symbols())
+        {
+            auto kept = counterparts.find(symbol);
+            symbols.map_ast_to_symbol(syntax, kept != counterparts.end() ? kept->second : symbol);
+            document.merged.syntax.push_back(syntax);
+        }
+        fresh.symbols_complete = true;
+        return true;
+    }
+
+    std::vector<Document *> Workspace::dependents(Document &changed, const std::vector<std::string> &old_names)
+    {
+        std::vector<Document *> affected{&changed};
+        std::unordered_set<const Document *> seen{&changed};
+
+        // Names whose symbols are being replaced, or that now mean something they didn't
+        std::unordered_set<std::string> names(old_names.begin(), old_names.end());
+        if (changed.state.ast)
+        {
+            for (auto &name : declared_names(changed.state.ast))
+                names.insert(std::move(name));
+        }
+
+        bool grew = true;
+        while (grew)
+        {
+            grew = false;
+            for (auto &document : documents)
+            {
+                if (seen.count(document.get()))
+                    continue;
+
+                bool uses = std::any_of(names.begin(), names.end(),
+                                        [&](const std::string &name) { return document->referenced.count(name) > 0; });
+                if (!uses)
+                    continue;
+
+                // Its symbols are replaced in turn, so the files naming them are affected too
+                seen.insert(document.get());
+                affected.push_back(document.get());
+                names.insert(document->declared.begin(), document->declared.end());
+                grew = true;
+            }
+        }
+        return affected;
+    }
+
+    void Workspace::redeclare(const std::vector<Document *> &affected, std::vector<std::unique_ptr<Symbol>> &retired)
+    {
+        for (auto document : affected)
+        {
+            if (!document->has_symbols)
+                continue;
+
+            for (auto symbol : document->merged.declarations)
+            {
+                owners.erase(symbol);
+            }
+            for (auto &symbol : symbols.unmerge(document->merged))
+            {
+                retired.push_back(std::move(symbol));
+            }
+            document->merged = {};
+            document->has_symbols = false;
+        }
+
+        for (auto document : affected)
+        {
+            declare(*document);
+        }
+    }
+
+    void Workspace::declare(Document &document)
+    {
+        auto &state = document.state;
+        document.diagnostics.clear();
+        state.symbols_complete = false;
+        if (!state.ast)
+        {
+            return;
+        }
+
+        document.interface = interface_text(state.ast, state.file.source());
+        document.declared = declared_names(state.ast);
+
+        state.symbolTable = std::make_unique<SymbolTable>(types);
+        SymbolTableBuilder builder(*state.symbolTable);
+        builder.build(state.ast);
+        for (const auto &error : builder.get_errors())
+        {
+            document.diagnostics.push_back(file_diagnostic(error));
+        }
+
+        for (const auto &conflict : symbols.merge(*state.symbolTable, &document.merged))
+        {
+            document.diagnostics.push_back(file_diagnostic(conflict));
+        }
+        document.has_symbols = true;
+        for (auto symbol : document.merged.declarations)
+        {
+            owners[symbol] = &document;
+        }
+
+        state.symbols_complete = document.diagnostics.empty();
+    }
+
+    bool Workspace::analyze(const std::vector<Document *> &affected, bool reinfer)
+    {
+        std::vector<Document *> bound;
+        for (auto document : affected)
+        {
+            auto &state = document->state;
+            state.boundTree = nullptr;
+            state.boundTreeBuilder.reset();
+            if (!state.ast || !state.symbols_complete)
+                continue;
+
+            state.boundTreeBuilder = std::make_unique<BoundTreeBuilder>(symbols);
+            state.boundTree = state.boundTreeBuilder->bind(state.ast);
+            if (!state.boundTree)
+            {
+                document->diagnostics.push_back(file_diagnostic("Invalid bound tree"));
+                continue;
+            }
+            bound.push_back(document);
+        }
+
+        InferredReturns inferred(types);
+        if (reinfer)
+        {
+            for (auto document : bound)
+                document->state.boundTree->accept(&inferred);
+        }
+
+        // As many rounds as Compiler::compile, so inference reaches the same fixed point
+        TypeResolver resolver(symbols);
+        for (int i = 0; i < 10; ++i)
+        {
+            for (auto document : bound)
+            {
+                resolver.resolve(document->state.boundTree);
+            }
+        }
+        for (auto document : bound)
+        {
+            resolver.resolve(document->state.boundTree);
+            for (const auto &error : resolver.get_diagnostics())
+            {
+                document->diagnostics.push_back({error.location, error.has_location, error.message});
+            }
+        }
+        last_update.files_analyzed += bound.size();
+
+        return std::any_of(inferred.previous.begin(), inferred.previous.end(), [&](const auto &entry) {
+            return !types.are_equal(entry.first->return_type, entry.second);
+        });
+    }
+
+    Document *Workspace::owner_of(Symbol *symbol)
+    {
+        for (; symbol; symbol = symbol->parent)
+        {
+            auto it = owners.find(symbol);
+            if (it != owners.end())
+                return it->second;
+        }
+        return nullptr;
+    }
+
+    // ============================================================================
+    // Queries
+    // ============================================================================
+
+    namespace
+    {
+        // The innermost node at an offset that names something
+        class NodeFinder : public DefaultBoundVisitor
+        {
+        public:
+            explicit NodeFinder(int offset) : offset(offset) {}
+
+            BoundNode *node = nullptr;
+            Symbol *symbol = nullptr;
+
+            void visit(BoundNameExpression *node) override
+            {
+                consider(node, node->symbol);
+            }
+
+            void visit(BoundMemberAccessExpression *node) override
+            {
+                consider(node, node->member);
+                DefaultBoundVisitor::visit(node);
+            }
+
+            void visit(BoundCallExpression *node) override
+            {
+                DefaultBoundVisitor::visit(node);
+                // The callee names the overload the call picked, not the first one by that name
+                if (node->method && this->node && this->node == node->callee)
+                    symbol = node->method;
+            }
+
+            void visit(BoundTypeExpression *node) override
+            {
+                auto type = node->resolvedTypeReference;
+                auto named = type ? type->as<NamedType>() : nullptr;
+                consider(node, named ? named->symbol : nullptr);
+                DefaultBoundVisitor::visit(node);
+            }
+
+            void visit(BoundVariableDeclaration *node) override
+            {
+                consider(node, node->symbol);
+                DefaultBoundVisitor::visit(node);
+            }
+
+            void visit(BoundFunctionDeclaration *node) override
+            {
+                // Only the signature: a body is full of things with better answers
+                int header_end = node->body ? node->body->location.start.offset : node->location.end_offset();
+                if (offset < header_end)
+                    consider(node, node->symbol);
+                DefaultBoundVisitor::visit(node);
+            }
+
+            void visit(BoundPropertyDeclaration *node) override
+            {
+                consider(node, node->symbol);
+                DefaultBoundVisitor::visit(node);
+            }
+
+            void visit(BoundTypeDeclaration *node) override
+            {
+                int header_end = node->members.empty() ? node->location.end_offset()
+                                                       : node->members.front()->location.start.offset;
+                if (offset < header_end)
+                    consider(node, node->symbol);
+                DefaultBoundVisitor::visit(node);
+            }
+
+        private:
+            int offset;
+
+            // Outer nodes are visited first, so a candidate no wider than the current pick is inside it.
+            // The end is inclusive: a cursor just after a name is still on it
+            void consider(BoundNode *candidate, Symbol *candidate_symbol)
+            {
+                const auto &range = candidate->location;
+                if (offset < range.start.offset || offset > range.end_offset())
+                    return;
+                if (!node || range.width <= node->location.width)
+                {
+                    node = candidate;
+                    symbol = candidate_symbol;
+                }
+            }
+        };
+
+        std::string type_name(TypePtr type)
+        {
+            return type ? type->get_name() : "?";
+        }
+
+        std::string describe_symbol(Symbol *symbol)
+        {
+            if (auto function = symbol->as<FunctionSymbol>())
+            {
+                std::string text;
+                if (function->is_constructor)
+                {
+                    auto owner = function->parent;
+                    text = "new " + (owner ? owner->get_qualified_name() : function->name);
+                }
+                else
+                {
+                    text = "fn " + function->get_qualified_name();
+                }
+
+                text += "(";
+                for (size_t i = 0; i < function->parameters.size(); i++)
+                {
+                    if (i > 0)
+                        text += ", ";
+                    text += type_name(function->parameters[i]->type) + " " + function->parameters[i]->name;
+                }
+                text += ")";
+
+                if (!function->is_constructor && function->return_type && !function->return_type->is_void())
+                    text += " -> " + type_name(function->return_type);
+                return text;
+            }
+            if (auto type = symbol->as<TypeSymbol>())
+            {
+                return "type " + type->get_qualified_name();
+            }
+            if (auto property = symbol->as<PropertySymbol>())
+            {
+                return "(property) " + type_name(property->type) + " " + property->get_qualified_name();
+            }
+            if (auto field = symbol->as<FieldSymbol>())
+            {
+                return "(field) " + type_name(field->type) + " " + field->get_qualified_name();
+            }
+            if (auto parameter = symbol->as<ParameterSymbol>())
+            {
+                return "(parameter) " + type_name(parameter->type) + " " + parameter->name;
+            }
+            if (auto variable = symbol->as<VariableSymbol>())
+            {
+                return type_name(variable->type) + " " + variable->name;
+            }
+            if (symbol->is<NamespaceSymbol>())
+            {
+                return "namespace " + symbol->get_qualified_name();
+            }
+            return symbol->get_qualified_name();
+        }
+    } // namespace
+
+    std::optional<Workspace::Location> Workspace::find_definition(Document &document, int offset)
+    {
+        // Offsets into text that didn't parse don't line up with the tree of the last that did
+        if (!document.syntax_errors.empty() || !document.state.boundTree)
+        {
+            return std::nullopt;
+        }
+
+        NodeFinder finder(offset);
+        document.state.boundTree->accept(&finder);
+        if (!finder.symbol || finder.symbol->location.width <= 0)
+        {
+            return std::nullopt;
+        }
+
+        auto owner = owner_of(finder.symbol);
+        if (!owner)
+        {
+            return std::nullopt;
+        }
+        return Location{owner, finder.symbol->location};
+    }
+
+    std::optional<std::string> Workspace::describe(Document &document, int offset)
+    {
+        if (!document.syntax_errors.empty() || !document.state.boundTree)
+        {
+            return std::nullopt;
+        }
+
+        NodeFinder finder(offset);
+        document.state.boundTree->accept(&finder);
+        if (finder.symbol)
+        {
+            return describe_symbol(finder.symbol);
+        }
+        if (auto expression = finder.node ? finder.node->as<BoundExpression>() : nullptr)
+        {
+            if (expression->type)
+                return type_name(expression->type);
+        }
+        return std::nullopt;
+    }
+
+} // namespace Fern::LSP
@@ -0,0 +1,126 @@
+// workspace.hpp - A project's Fern files, analyzed and kept resident for the language server
+#pragma once
+#include "compiler.hpp"
+#include "semantic/symbol_table.hpp"
+#include "semantic/type_system.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Fern::LSP
+{
+
+    struct Diagnostic
+    {
+        SourceRange location;
+        bool has_location; // false for errors about the file as a whole
+        std::string message;
+    };
+
+    /**
+     * @brief One file of a Workspace: its current text and the analysis of its last good version
+     *
+     * While the text doesn't lex or parse, syntax_errors say why and the rest (symbols,
+     * bound tree) still describe the last version that did.
+     */
+    struct Document
+    {
+        std::string name;
+        std::string text;
+        FileCompilationState state{}; // the analyzed version; its symbols are merged into the workspace's
+        std::vector<Diagnostic> syntax_errors; // of the current text
+        std::vector<Diagnostic> diagnostics;   // of the analyzed version
+
+        // What a client should be shown for the current text
+        const std::vector<Diagnostic> &current_diagnostics() const
+        {
+            return syntax_errors.empty() ? diagnostics : syntax_errors;
+        }
+
+        SymbolTable::MergedSymbols merged; // what this file put into the workspace's symbol table
+        bool has_symbols = false;          // whether `merged` is in the table
+
+        std::string interface;                    // the analyzed text without function bodies
+        std::vector<std::string> declared;        // names of the file's namespace-level declarations
+        std::unordered_set<std::string> referenced; // every identifier the file uses
+    };
+
+    /**
+     * @brief Incremental analysis of many files sharing one symbol table
+     *
+     * The front end of Compiler::compile (parse, declare, merge, bind, resolve), run once
+     * over the whole project by load() and then again per edit only where the edit can
+     * reach. An edit inside function bodies keeps the file's declarations: its symbols are
+     * patched in place, so no other file needs to look again, and only that file is bound
+     * and resolved. An edit to a declaration replaces the file's symbols, and every file
+     * that names one of them, old or new, is declared, bound and resolved again too, as
+     * are the files naming theirs in turn.
+     *
+     * Which files depend on which is judged by name: a file that doesn't spell out any of
+     * another's declarations can't be holding any of its symbols, since every reference a
+     * bound tree keeps was found by looking a name up, or is a member of something that was.
+     * Reaching a member through a third file's function means naming that function, and
+     * that file is in the set already for naming the type.
+     */
+    class Workspace
+    {
+    public:
+        Workspace();
+        ~Workspace();
+        Workspace(const Workspace &) = delete;
+        Workspace &operator=(const Workspace &) = delete;
+
+        // Analyze many files at once, as when a project is first opened. Returns every document
+        std::vector<Document *> load(const std::vector<SourceFile> &files);
+
+        // Give a file new text, adding it if it's new, and analyze it and whatever its edit
+        // can reach. Returns the documents whose diagnostics were recomputed
+        std::vector<Document *> update(const std::string &name, std::string text);
+
+        Document *find(const std::string &name);
+        const std::vector<std::unique_ptr<Document>> &get_documents() const { return documents; }
+
+        struct Location
+        {
+            const Document *document;
+            SourceRange range;
+        };
+
+        // Where the symbol used or declared at `offset` was declared
+        std::optional<Location> find_definition(Document &document, int offset);
+
+        // What is at `offset`, as a line of Fern: a declaration, or the type of an expression
+        std::optional<std::string> describe(Document &document, int offset);
+
+        // How the last load() or update() went, for benchmarks and logging
+        struct UpdateStats
+        {
+            bool declarations_changed = false; // false when the edit was confined to bodies
+            size_t files_analyzed = 0;         // files bound and resolved
+        };
+        const UpdateStats &get_last_update() const { return last_update; }
+
+    private:
+        TypeSystem types;
+        SymbolTable symbols;
+        std::vector<std::unique_ptr<Document>> documents;
+        std::unordered_map<std::string, Document *> by_name;
+        std::unordered_map<Symbol *, Document *> owners; // merged declarations, by file
+        UpdateStats last_update;
+
+        Document *add(const std::string &name);
+        bool parse(FileCompilationState &state, std::vector<Diagnostic> &diagnostics,
+                   std::unordered_set<std::string> &referenced);
+        bool patch(Document &document, FileCompilationState &fresh, std::vector<std::unique_ptr<Symbol>> &retired);
+        void redeclare(const std::vector<Document *> &affected, std::vector<std::unique_ptr<Symbol>> &retired);
+        void declare(Document &document);
+        bool analyze(const std::vector<Document *> &affected, bool reinfer = false);
+        std::vector<Document *> dependents(Document &changed, const std::vector<std::string> &old_names);
+        Document *owner_of(Symbol *symbol);
+    };
+
+} // namespace Fern::LSP
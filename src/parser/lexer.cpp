@@ -905,4 +905,13 @@ namespace Fern
         return TokenStream(std::move(tokens));
     }
 
+    void Lexer::resume(SourceLocation start)
+    {
+        reset();
+        current_offset_ = std::min<size_t>(start.offset, source_.size());
+        current_location_ = start;
+        cache_start_offset_ = current_offset_;
+        diagnostics_.clear();
+    }
+
 } // namespace Fern
\ No newline at end of file
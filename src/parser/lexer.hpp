@@ -61,6 +61,12 @@ namespace Fern
         // Tokenize entire source and return token stream
         TokenStream tokenize_all();
 
+        // Tokenize part of the source, as when relexing around an edit: resume at `start`,
+        // which must be exact (offset, line and column) and where a token or its leading
+        // trivia begins, then take tokens one at a time up to the end-of-file token
+        void resume(SourceLocation start);
+        Token lex_next() { return next_token(); }
+
         // Position and state queries
         SourceLocation current_location() const { return current_location_; }
         bool at_end() const { return current_offset_ >= source_.size(); }
@@ -1,4 +1,6 @@
 #include "parser/parser.hpp"
+#include "parser/lexer.hpp"
+#include <algorithm>
 
 // #define REQUIRE_SEMI
 #ifdef REQUIRE_SEMI
@@ -32,7 +34,7 @@ namespace Fern
             return unit;
         }
 
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         std::vector<BaseStmtSyntax *> statements;
 
         while (!tokens.at_end())
@@ -60,26 +62,254 @@ namespace Fern
         return !errors.empty();
     }
 
+    #pragma endregion
+
+    #pragma region Incremental Parsing
+
+    // Past this many reparses in a row the text is parsed whole, which frees the chain of
+    // arenas holding reused declarations and whatever the edits replaced
+    static constexpr size_t MaxReparseGeneration = 128;
+
+    namespace
+    {
+        // Moves a reused declaration to where an edit put it. Columns stay: a declaration is
+        // only reused when its first token kept its column, and nothing after it changed
+        class LocationShifter : public DefaultVisitor
+        {
+        public:
+            using DefaultVisitor::visit;
+
+            LocationShifter(int offsetDelta, int lineDelta) : offsetDelta(offsetDelta), lineDelta(lineDelta) {}
+
+            void visit(BaseSyntax *node) override
+            {
+                shift(node->location);
+            }
+
+            void visit(SimpleNameSyntax *node) override
+            {
+                shift(node->identifier.location);
+                DefaultVisitor::visit(node);
+            }
+
+            // Fields declared together (i32 x, y) share one type node, which must move only once
+            void visit(TypedIdentifier *node) override
+            {
+                shift(node->location);
+                if (node->name)
+                    node->name->accept(this);
+                if (node->type && node->type != lastType)
+                {
+                    lastType = node->type;
+                    node->type->accept(this);
+                }
+            }
+
+        private:
+            int offsetDelta;
+            int lineDelta;
+            BaseExprSyntax *lastType = nullptr;
+
+            void shift(SourceRange &range)
+            {
+                range.start.offset += offsetDelta;
+                range.start.line += lineDelta;
+            }
+        };
+
+        // Index of the first token starting at or after `offset`
+        size_t tokenAt(const std::vector<Token> &tokens, int offset)
+        {
+            auto it = std::lower_bound(tokens.begin(), tokens.end(), offset, [](const Token &token, int value)
+                                       { return token.location.start.offset < value; });
+            return static_cast<size_t>(it - tokens.begin());
+        }
+    }
+
+    CompilationUnitSyntax *Parser::parseWhole(std::string_view source)
+    {
+        Lexer lexer(source);
+        tokens = lexer.tokenize_all();
+        for (const auto &diagnostic : lexer.get_diagnostics())
+        {
+            if (diagnostic.is_error)
+                errors.push_back({diagnostic.message, SourceRange(diagnostic.location, 1), ParseError::ERROR});
+        }
+        reusedFrom.reset();
+        generation = 0;
+        reusedCount = 0;
+        memo.clear(); // its token positions were into the old tokens
+        return parse();
+    }
+
+    CompilationUnitSyntax *Parser::reparse(std::unique_ptr<Parser> prior, CompilationUnitSyntax *priorUnit,
+                                           const TextEdit &edit, std::string_view source)
+    {
+        // A tree with errors may have ended declarations anywhere, so nothing of it is trusted
+        if (!prior || !priorUnit || &prior->tokens != &tokens || prior->hasErrors() ||
+            prior->generation + 1 >= MaxReparseGeneration)
+        {
+            return parseWhole(source);
+        }
+
+        const auto &old = tokens.get_tokens();
+        const auto &priorStatements = priorUnit->topLevelStatements;
+        if (priorStatements.empty())
+        {
+            return parseWhole(source);
+        }
+
+        int delta = edit.inserted - edit.removed;
+        int editEnd = edit.offset + edit.removed;
+        auto startOf = [&](size_t statement) { return priorStatements[statement]->location.start.offset; };
+
+        // Relex from the last token starting before the edit, which the edit may extend. Its
+        // start and leading trivia are untouched, so lexing resumes exactly there
+        size_t relexFrom = tokenAt(old, edit.offset);
+        bool resumeAtToken = relexFrom > 0;
+        if (resumeAtToken)
+            relexFrom--;
+        // Both halves of a '>>' split for generic arguments start at the same place
+        while (relexFrom > 0 && old[relexFrom - 1].location.start.offset == old[relexFrom].location.start.offset)
+            relexFrom--;
+        SourceLocation resumeAt = resumeAtToken ? old[relexFrom].location.start : SourceLocation();
+
+        // The statement holding that token is parsed again, and so is the one before it,
+        // whose end was decided by looking at the token that may have changed
+        int relexOffset = old[relexFrom].location.start.offset;
+        size_t edited = static_cast<size_t>(
+            std::upper_bound(priorStatements.begin(), priorStatements.end(), relexOffset,
+                             [](int offset, BaseStmtSyntax *statement) { return offset < statement->location.start.offset; }) -
+            priorStatements.begin());
+        edited = edited > 0 ? edited - 1 : 0;
+        size_t reparseFrom = edited > 0 ? edited - 1 : 0;
+        size_t reparseToken = tokenAt(old, startOf(reparseFrom));
+        if (reparseToken >= old.size() || old[reparseToken].location.start.offset != startOf(reparseFrom) ||
+            reparseToken > relexFrom)
+        {
+            return parseWhole(source);
+        }
+
+        // Lex until a later statement's first token comes out where the edit moved it, as it
+        // was. From there on the text is unchanged and lexes the same
+        Lexer lexer(source);
+        lexer.resume(resumeAt);
+        std::vector<Token> relexed;
+        size_t candidate = edited + 1;
+        while (candidate < priorStatements.size() && startOf(candidate) < editEnd)
+            candidate++;
+        size_t synced = priorStatements.size();
+        size_t syncedToken = old.size();
+
+        while (true)
+        {
+            Token token = lexer.lex_next();
+            bool atEnd = token.kind == TokenKind::EndOfFile;
+            while (candidate < priorStatements.size() && startOf(candidate) + delta < token.location.start.offset)
+                candidate++;
+
+            if (!atEnd && candidate < priorStatements.size() && startOf(candidate) + delta == token.location.start.offset)
+            {
+                size_t index = tokenAt(old, startOf(candidate));
+                const auto &expected = old[index];
+                if (expected.location.start.offset == startOf(candidate) && token.kind == expected.kind &&
+                    token.location.width == expected.location.width &&
+                    token.location.start.column == expected.location.start.column)
+                {
+                    synced = candidate;
+                    syncedToken = index;
+                    relexed.push_back(std::move(token));
+                    break;
+                }
+            }
+
+            relexed.push_back(std::move(token));
+            if (atEnd)
+                break;
+        }
+
+        if (lexer.has_errors())
+        {
+            return parseWhole(source);
+        }
+        if (resumeAtToken)
+        {
+            relexed.front().leading_trivia = old[relexFrom].leading_trivia;
+        }
+
+        // Splice the new tokens in, moving the unchanged ones after them
+        int lineDelta = 0;
+        size_t replacedEnd = old.size();
+        if (synced < priorStatements.size())
+        {
+            lineDelta = relexed.back().location.start.line - old[syncedToken].location.start.line;
+            replacedEnd = syncedToken + 1;
+        }
+        tokens.splice(relexFrom, replacedEnd, std::move(relexed), delta, lineDelta);
+
+        // Parse from the first edited statement until the tokens of an unchanged one come
+        // up next. A statement the edit left unterminated runs on into the ones after it
+        const auto &current = tokens.get_tokens();
+        std::vector<BaseStmtSyntax *> statements(priorStatements.begin(), priorStatements.begin() + reparseFrom);
+        tokens.restore({reparseToken});
+        size_t next = synced;
+        size_t nextToken = next < priorStatements.size() ? tokenAt(current, startOf(next) + delta) : current.size();
+        while (!tokens.at_end())
+        {
+            while (next < priorStatements.size() && tokens.position() > nextToken)
+            {
+                next++;
+                nextToken = next < priorStatements.size() ? tokenAt(current, startOf(next) + delta) : current.size();
+            }
+            if (next < priorStatements.size() && tokens.position() == nextToken)
+                break;
+
+            if (auto statement = parseTopLevelStatement())
+                statements.push_back(statement);
+        }
+
+        reusedCount = reparseFrom;
+        if (!tokens.at_end() && next < priorStatements.size())
+        {
+            LocationShifter shifter(delta, lineDelta);
+            for (size_t i = next; i < priorStatements.size(); i++)
+            {
+                if (delta != 0 || lineDelta != 0)
+                    priorStatements[i]->accept(&shifter);
+                statements.push_back(priorStatements[i]);
+            }
+            reusedCount += priorStatements.size() - next;
+        }
+
+        reusedFrom = std::move(prior);
+        generation = reusedFrom->generation + 1;
+
+        auto unit = arena.make<CompilationUnitSyntax>();
+        unit->topLevelStatements = arena.makeList(statements);
+        tokens.restore({current.size() - 1});
+        unit->location = SourceRange(current.front().location.start, tokens.previous().location.end());
+        return unit;
+    }
+
     #pragma endregion
     
     #pragma region Error Handling
 
     void Parser::error(const std::string &msg)
     {
-        static int lastPos = 0;
-        if (lastPos == tokens.position())
+        if (lastErrorPosition == tokens.position())
         {
             synchronize();
             return;
         }
-        lastPos = tokens.position();
+        lastErrorPosition = tokens.position();
 
-        errors.push_back({msg, tokens.current().location, ParseError::ERROR});
+        errors.push_back({msg, tokens.location(), ParseError::ERROR});
     }
 
     void Parser::warning(const std::string &msg)
     {
-        errors.push_back({msg, tokens.current().location, ParseError::WARNING});
+        errors.push_back({msg, tokens.location(), ParseError::WARNING});
     }
 
     MissingExprSyntax *Parser::errorExpr(const std::string &msg)
@@ -178,7 +408,7 @@ namespace Fern
         return tokens.check(kind);
     }
 
-    bool Parser::checkAny(std::initializer_list<TokenKind> kinds)
+    bool Parser::checkAny(TokenKindSet kinds)
     {
         return tokens.check_any(kinds);
     }
@@ -198,18 +428,14 @@ namespace Fern
         return true;
     }
 
-    Token Parser::previous()
+    const Token &Parser::previous()
     {
         return tokens.previous();
     }
 
     TokenKind Parser::peekNext()
     {
-        auto checkpoint = tokens.checkpoint();
-        tokens.advance();
-        TokenKind next = tokens.current().kind;
-        tokens.restore(checkpoint);
-        return next;
+        return tokens.peek_kind();
     }
 
     #pragma endregion
@@ -257,7 +483,7 @@ namespace Fern
 
     BaseDeclSyntax *Parser::parseDeclaration()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         ModifierKindFlags modifiers = parseModifiers();
 
         if (check(TokenKind::Namespace))
@@ -406,13 +632,13 @@ namespace Fern
         decl->members = arena.makeList(members);
         expect(TokenKind::RightBrace, "Expected '}' to close type declaration");
 
-        decl->location = SourceRange(startToken.location.start, previous().location.end());
+        decl->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return decl;
     }
 
     EnumCaseDeclSyntax *Parser::parseEnumCase()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto decl = arena.make<EnumCaseDeclSyntax>();
         decl->name = parseIdentifier();
 
@@ -425,7 +651,7 @@ namespace Fern
             decl->associatedData = arena.emptyList<ParameterDeclSyntax *>();
         }
 
-        decl->location = SourceRange(startToken.location.start, previous().location.end());
+        decl->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return decl;
     }
 
@@ -532,7 +758,7 @@ namespace Fern
             decl->body = nullptr;
         }
 
-        decl->location = SourceRange(startToken.location.start, previous().location.end());
+        decl->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return decl;
     }
 
@@ -551,12 +777,12 @@ namespace Fern
         if (!decl->body)
         {
             auto block = arena.make<BlockSyntax>();
-            block->location = previous().location;
+            block->location = tokens.previous_location();
             block->statements = arena.emptyList<BaseStmtSyntax *>();
             decl->body = block;
         }
 
-        decl->location = SourceRange(startToken.location.start, previous().location.end());
+        decl->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return decl;
     }
 
@@ -567,7 +793,7 @@ namespace Fern
         if (!check(TokenKind::Identifier))
         {
             // Check if the user used a keyword instead of an identifier
-            auto currentToken = tokens.current();
+            const Token &currentToken = tokens.current();
             if (currentToken.is_keyword())
             {
                 error("Cannot use keyword '" + std::string(currentToken.text) + "' as an identifier");
@@ -594,13 +820,13 @@ namespace Fern
         {
             auto initCheckpoint = tokens.checkpoint();
             tokens.advance();
-            parseExpression();
+            parseInitializer();
             if (check(TokenKind::LeftBrace))
             {
                 isProperty = true;
                 tokens.restore(initCheckpoint);
                 consume(TokenKind::Assign);
-                initializer = parseExpression();
+                initializer = parseInitializer();
             }
             else
             {
@@ -625,7 +851,7 @@ namespace Fern
 
             varDecl->variable = ti;
             varDecl->initializer = initializer;
-            varDecl->location = SourceRange(startToken.location.start, previous().location.end());
+            varDecl->location = SourceRange(startToken.location.start, tokens.previous_location().end());
 
             prop->variable = varDecl;
 
@@ -643,7 +869,7 @@ namespace Fern
                 parsePropertyAccessorSyntaxs(prop);
             }
 
-            prop->location = SourceRange(startToken.location.start, previous().location.end());
+            prop->location = SourceRange(startToken.location.start, tokens.previous_location().end());
             return prop;
         }
 
@@ -657,12 +883,12 @@ namespace Fern
         // Only type inference allowed for var declarations
         ti->type = nullptr; // Type inference
 
-        ti->location = SourceRange(startToken.location.start, previous().location.end());
+        ti->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         decl->variable = ti;
 
         if (consume(TokenKind::Assign))
         {
-            decl->initializer = parseExpression();
+            decl->initializer = parseInitializer();
             if (!decl->initializer)
             {
                 decl->initializer = errorExpr("Expected initializer");
@@ -674,7 +900,7 @@ namespace Fern
         }
 
         HANDLE_SEMI
-        decl->location = SourceRange(startToken.location.start, previous().location.end());
+        decl->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return decl;
     }
 
@@ -715,7 +941,7 @@ namespace Fern
 
         do
         {
-            auto fieldStartToken = tokens.current();
+            const Token &fieldStartToken = tokens.current();
             auto name = parseIdentifier();
             BaseExprSyntax *initializer = nullptr;
 
@@ -741,7 +967,7 @@ namespace Fern
 
                 varDecl->variable = ti;
                 varDecl->initializer = initializer;
-                varDecl->location = SourceRange(fieldStartToken.location.start, previous().location.end());
+                varDecl->location = SourceRange(fieldStartToken.location.start, tokens.previous_location().end());
 
                 prop->variable = varDecl;
 
@@ -758,7 +984,7 @@ namespace Fern
                 {
                     parsePropertyAccessorSyntaxs(prop);
                 }
-                prop->location = SourceRange(fieldStartToken.location.start, previous().location.end());
+                prop->location = SourceRange(fieldStartToken.location.start, tokens.previous_location().end());
                 declarations.push_back(prop);
                 hasProperties = true;
             }
@@ -775,7 +1001,7 @@ namespace Fern
 
                 field->variable = ti;
                 field->initializer = initializer;
-                field->location = SourceRange(fieldStartToken.location.start, previous().location.end());
+                field->location = SourceRange(fieldStartToken.location.start, tokens.previous_location().end());
                 declarations.push_back(field);
             }
         } while (consume(TokenKind::Comma));
@@ -789,7 +1015,7 @@ namespace Fern
         // Set location for all declarations to span from the type to the end
         for (auto decl : declarations)
         {
-            decl->location = SourceRange(startToken.location.start, previous().location.end());
+            decl->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         }
 
         return declarations;
@@ -800,7 +1026,7 @@ namespace Fern
         consume(TokenKind::LeftBrace);
         while (!check(TokenKind::RightBrace) && !tokens.at_end())
         {
-            auto accessorStartToken = tokens.current();
+            const Token &accessorStartToken = tokens.current();
             ModifierKindFlags accessorMods = parseModifiers();
 
             if (consume(TokenKind::Get))
@@ -832,7 +1058,7 @@ namespace Fern
                 {
                     getter->body = std::monostate{};
                 }
-                getter->location = SourceRange(accessorStartToken.location.start, previous().location.end());
+                getter->location = SourceRange(accessorStartToken.location.start, tokens.previous_location().end());
                 prop->getter = getter;
             }
             else if (consume(TokenKind::Set))
@@ -864,7 +1090,7 @@ namespace Fern
                 {
                     setter->body = std::monostate{};
                 }
-                setter->location = SourceRange(accessorStartToken.location.start, previous().location.end());
+                setter->location = SourceRange(accessorStartToken.location.start, tokens.previous_location().end());
                 prop->setter = setter;
             }
             else
@@ -931,7 +1157,7 @@ namespace Fern
             decl->isFileScoped = true;
             decl->body = std::nullopt;
         }
-        decl->location = SourceRange(startToken.location.start, previous().location.end());
+        decl->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return decl;
     }
 
@@ -941,7 +1167,7 @@ namespace Fern
 
     BaseStmtSyntax *Parser::parseStatement()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         if (check(TokenKind::If))
             return parseIfStatement();
         if (check(TokenKind::While))
@@ -980,7 +1206,7 @@ namespace Fern
 
     BlockSyntax *Parser::parseBlock()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto block = arena.make<BlockSyntax>();
         consume(TokenKind::LeftBrace);
 
@@ -1018,13 +1244,13 @@ namespace Fern
         block->statements = arena.makeList(statements);
 
         expect(TokenKind::RightBrace, "Expected '}' to close block");
-        block->location = SourceRange(startToken.location.start, previous().location.end());
+        block->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return block;
     }
 
     BaseStmtSyntax *Parser::parseIfStatement()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         consume(TokenKind::If);
 
         // Check if parentheses are present
@@ -1056,14 +1282,14 @@ namespace Fern
         ifExpr->condition = condition;
         ifExpr->thenBranch = thenStmt;
         ifExpr->elseBranch = elseStmt;
-        ifExpr->location = SourceRange(startToken.location.start, previous().location.end());
+        ifExpr->location = SourceRange(startToken.location.start, tokens.previous_location().end());
 
         return ifExpr;
     }
 
     WhileStmtSyntax *Parser::parseWhileStatement()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto stmt = arena.make<WhileStmtSyntax>();
         consume(TokenKind::While);
 
@@ -1085,7 +1311,7 @@ namespace Fern
         if (!stmt->body)
             stmt->body = errorStmt("Expected loop body");
 
-        stmt->location = SourceRange(startToken.location.start, previous().location.end());
+        stmt->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return stmt;
     }
 
@@ -1096,7 +1322,7 @@ namespace Fern
 
     ForStmtSyntax *Parser::parseTraditionalForStatement()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto stmt = arena.make<ForStmtSyntax>();
         consume(TokenKind::For);
 
@@ -1168,13 +1394,13 @@ namespace Fern
         if (!stmt->body)
             stmt->body = errorStmt("Expected loop body");
 
-        stmt->location = SourceRange(startToken.location.start, previous().location.end());
+        stmt->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return stmt;
     }
 
     ReturnStmtSyntax *Parser::parseReturnStatement()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto stmt = arena.make<ReturnStmtSyntax>();
         consume(TokenKind::Return);
 
@@ -1192,13 +1418,13 @@ namespace Fern
         {
             warning("Return statement outside function or property");
         }
-        stmt->location = SourceRange(startToken.location.start, previous().location.end());
+        stmt->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return stmt;
     }
 
     BreakStmtSyntax *Parser::parseBreakStatement()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto stmt = arena.make<BreakStmtSyntax>();
         consume(TokenKind::Break);
         HANDLE_SEMI
@@ -1206,13 +1432,13 @@ namespace Fern
         {
             warning("Break statement outside loop");
         }
-        stmt->location = SourceRange(startToken.location.start, previous().location.end());
+        stmt->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return stmt;
     }
 
     ContinueStmtSyntax *Parser::parseContinueStatement()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto stmt = arena.make<ContinueStmtSyntax>();
         consume(TokenKind::Continue);
         HANDLE_SEMI
@@ -1220,7 +1446,7 @@ namespace Fern
         {
             warning("Continue statement outside loop");
         }
-        stmt->location = SourceRange(startToken.location.start, previous().location.end());
+        stmt->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return stmt;
     }
 
@@ -1233,13 +1459,13 @@ namespace Fern
             stmt->expression = errorExpr("Expected expression");
         }
         HANDLE_SEMI
-        stmt->location = SourceRange(stmt->expression->location.start, previous().location.end());
+        stmt->location = SourceRange(stmt->expression->location.start, tokens.previous_location().end());
         return stmt;
     }
 
     UsingDirectiveSyntax *Parser::parseUsingDirective()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto directive = arena.make<UsingDirectiveSyntax>();
         consume(TokenKind::Using);
 
@@ -1265,7 +1491,7 @@ namespace Fern
         }
 
         HANDLE_SEMI
-        directive->location = SourceRange(startToken.location.start, previous().location.end());
+        directive->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return directive;
     }
 
@@ -1287,7 +1513,7 @@ namespace Fern
     {
         while (!tokens.at_end())
         {
-            Token op = tokens.current();
+            const Token &op = tokens.current();
             int precedence = op.get_binary_precedence();
 
             if (op.kind == TokenKind::Question)
@@ -1376,7 +1602,7 @@ namespace Fern
         }
         else if (check(TokenKind::This))
         {
-            auto startToken = tokens.current();
+            const Token &startToken = tokens.current();
             auto thisExpr = arena.make<ThisExprSyntax>();
             tokens.advance();
             thisExpr->location = startToken.location;
@@ -1436,7 +1662,7 @@ namespace Fern
                 call->arguments = arena.makeList(args);
 
                 expect(TokenKind::RightParen, "Expected ')' after arguments");
-                call->location = SourceRange(expr->location.start, previous().location.end());
+                call->location = SourceRange(expr->location.start, tokens.previous_location().end());
                 expr = call;
             }
             else if (check(TokenKind::Dot))
@@ -1460,7 +1686,7 @@ namespace Fern
                     indexer->index = errorExpr("Expected index expression");
 
                 expect(TokenKind::RightBracket, "Expected ']' after index");
-                indexer->location = SourceRange(expr->location.start, previous().location.end());
+                indexer->location = SourceRange(expr->location.start, tokens.previous_location().end());
                 expr = indexer;
             }
             else if (checkAny({TokenKind::Increment, TokenKind::Decrement}))
@@ -1470,7 +1696,7 @@ namespace Fern
                 unary->op = tokens.current().to_unary_operator_kind();
                 unary->isPostfix = true;
                 tokens.advance();
-                unary->location = SourceRange(expr->location.start, previous().location.end());
+                unary->location = SourceRange(expr->location.start, tokens.previous_location().end());
                 expr = unary;
             }
             else
@@ -1483,9 +1709,9 @@ namespace Fern
 
     BaseExprSyntax *Parser::parseUnaryExpression()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto unary = arena.make<UnaryExprSyntax>();
-        Token op = tokens.current();
+        const Token &op = tokens.current();
         tokens.advance();
         unary->op = op.to_unary_operator_kind();
         unary->isPostfix = false;
@@ -1501,7 +1727,7 @@ namespace Fern
     LiteralExprSyntax *Parser::parseLiteral()
     {
         auto lit = arena.make<LiteralExprSyntax>();
-        Token tok = tokens.current();
+        const Token &tok = tokens.current();
         lit->location = tok.location;
         lit->value = tok.text;
         lit->kind = tok.to_literal_kind();
@@ -1526,7 +1752,7 @@ namespace Fern
                     auto generic = arena.make<GenericNameSyntax>();
                     generic->identifier = nameExpr;
                     generic->typeArguments = genericArgs;
-                    generic->location = SourceRange(nameExpr->location.start, previous().location.end());
+                    generic->location = SourceRange(nameExpr->location.start, tokens.previous_location().end());
                     nameExpr = generic;
                 }
             }
@@ -1552,6 +1778,13 @@ namespace Fern
         }
 
     List<BaseExprSyntax *> Parser::parseGenericArgs()
+    {
+        if (!check(TokenKind::Less))
+            return {};
+        return memoized(MemoRule::GenericArgs, [this]() { return parseGenericArgsUnmemoized(); });
+    }
+
+    List<BaseExprSyntax *> Parser::parseGenericArgsUnmemoized()
     {
         auto cp = tokens.checkpoint();
         if (!check(TokenKind::Less))
@@ -1588,7 +1821,11 @@ namespace Fern
         {
             return nullptr; // Don't error, just return null
         }
+        return memoized(MemoRule::TypeExpression, [this]() { return parseTypeExpressionUnmemoized(); });
+    }
 
+    BaseExprSyntax *Parser::parseTypeExpressionUnmemoized()
+    {
         auto nameExpr = parseNameExpression();
         BaseExprSyntax *baseType = nameExpr;
 
@@ -1639,7 +1876,7 @@ namespace Fern
                 return nullptr;
             }
 
-            arrayType->location = SourceRange(baseType->location.start, previous().location.end());
+            arrayType->location = SourceRange(baseType->location.start, tokens.previous_location().end());
             baseType = arrayType;
         }
 
@@ -1653,6 +1890,12 @@ namespace Fern
         return baseType;
     }
 
+    BaseExprSyntax *Parser::parseInitializer()
+    {
+        // Parsed once to see whether a property's accessors follow, then again for real
+        return memoized(MemoRule::Initializer, [this]() { return parseExpression(); });
+    }
+
     BaseExprSyntax *Parser::parseParenthesizedOrLambda()
     {
         auto checkpoint = tokens.checkpoint();
@@ -1747,7 +1990,7 @@ namespace Fern
 
     BaseExprSyntax *Parser::parseCastExpression()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         consume(TokenKind::LeftParen);
 
         // Parse the target type
@@ -1777,7 +2020,7 @@ namespace Fern
 
     BaseExprSyntax *Parser::parseArrayLiteral()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto array = arena.make<ArrayLiteralExprSyntax>();
         consume(TokenKind::LeftBracket);
 
@@ -1794,13 +2037,13 @@ namespace Fern
         array->elements = arena.makeList(elements);
 
         expect(TokenKind::RightBracket, "Expected ']' after array elements");
-        array->location = SourceRange(startToken.location.start, previous().location.end());
+        array->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return array;
     }
 
     BaseExprSyntax *Parser::parseNewExpression()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto newExpr = arena.make<NewExprSyntax>();
         consume(TokenKind::New);
 
@@ -1836,13 +2079,13 @@ namespace Fern
         {
             newExpr->arguments = arena.emptyList<BaseExprSyntax *>();
         }
-        newExpr->location = SourceRange(startToken.location.start, previous().location.end());
+        newExpr->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return newExpr;
     }
 
     BaseExprSyntax *Parser::parseLambdaExpression()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto lambda = arena.make<LambdaExprSyntax>();
 
         if (check(TokenKind::LeftParen))
@@ -1852,7 +2095,7 @@ namespace Fern
             while (!check(TokenKind::RightParen) && !tokens.at_end())
             {
                 auto param = arena.make<ParameterDeclSyntax>();
-                auto paramStart = tokens.current();
+                const Token &paramStart = tokens.current();
                 param->param = parseTypedIdentifier();
                 if (!param->param)
                 {
@@ -1862,7 +2105,7 @@ namespace Fern
                     param->param = ti;
                 }
                 param->defaultValue = nullptr;
-                param->location = SourceRange(paramStart.location.start, previous().location.end());
+                param->location = SourceRange(paramStart.location.start, tokens.previous_location().end());
                 params.push_back(param);
                 if (!consume(TokenKind::Comma))
                     break;
@@ -1874,7 +2117,7 @@ namespace Fern
         {
             std::vector<ParameterDeclSyntax *> params;
             auto param = arena.make<ParameterDeclSyntax>();
-            auto paramStart = tokens.current();
+            const Token &paramStart = tokens.current();
             auto ti = arena.make<TypedIdentifier>();
             ti->type = nullptr;
             ti->name = parseIdentifier();
@@ -1902,13 +2145,13 @@ namespace Fern
             exprStmt->location = expr->location;
             lambda->body = exprStmt;
         }
-        lambda->location = SourceRange(startToken.location.start, previous().location.end());
+        lambda->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return lambda;
     }
 
     BaseExprSyntax *Parser::parseTypeOfExpression()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto typeOf = arena.make<TypeOfExprSyntax>();
         consume(TokenKind::Typeof);
         expect(TokenKind::LeftParen, "Expected '(' after 'typeof'");
@@ -1918,13 +2161,13 @@ namespace Fern
             typeOf->type = errorExpr("Expected type");
 
         expect(TokenKind::RightParen, "Expected ')' after type");
-        typeOf->location = SourceRange(startToken.location.start, previous().location.end());
+        typeOf->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return typeOf;
     }
 
     BaseExprSyntax *Parser::parseSizeOfExpression()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto sizeOf = arena.make<SizeOfExprSyntax>();
         consume(TokenKind::Sizeof);
         expect(TokenKind::LeftParen, "Expected '(' after 'sizeof'");
@@ -1934,7 +2177,7 @@ namespace Fern
             sizeOf->type = errorExpr("Expected type");
 
         expect(TokenKind::RightParen, "Expected ')' after type");
-        sizeOf->location = SourceRange(startToken.location.start, previous().location.end());
+        sizeOf->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return sizeOf;
     }
 
@@ -1949,7 +2192,7 @@ namespace Fern
             return nullptr;
         }
 
-        auto tok = tokens.current();
+        const Token &tok = tokens.current();
         auto id = arena.makeIdentifier(tok);
         id->location = tok.location;
         tokens.advance();
@@ -1959,7 +2202,7 @@ namespace Fern
 
     TypedIdentifier *Parser::parseTypedIdentifier()
     {
-        auto startToken = tokens.current();
+        const Token &startToken = tokens.current();
         auto ti = arena.make<TypedIdentifier>();
         if (consume(TokenKind::Var))
         {
@@ -1976,7 +2219,7 @@ namespace Fern
             }
             ti->name = parseIdentifier();
         }
-        ti->location = SourceRange(startToken.location.start, previous().location.end());
+        ti->location = SourceRange(startToken.location.start, tokens.previous_location().end());
         return ti;
     }
 
@@ -1987,7 +2230,7 @@ namespace Fern
         std::vector<ParameterDeclSyntax *> params;
         while (!check(TokenKind::RightParen) && !tokens.at_end())
         {
-            auto startToken = tokens.current();
+            const Token &startToken = tokens.current();
             auto param = arena.make<ParameterDeclSyntax>();
             param->param = parseTypedIdentifier();
             if (!param->param)
@@ -2006,7 +2249,7 @@ namespace Fern
             {
                 param->defaultValue = nullptr;
             }
-            param->location = SourceRange(startToken.location.start, previous().location.end());
+            param->location = SourceRange(startToken.location.start, tokens.previous_location().end());
             params.push_back(param);
             if (!consume(TokenKind::Comma))
                 break;
@@ -2024,10 +2267,10 @@ namespace Fern
 
         while (!check(TokenKind::Greater) && !tokens.at_end())
         {
-            auto startToken = tokens.current();
+            const Token &startToken = tokens.current();
             auto typeParam = arena.make<TypeParameterDeclSyntax>();
             typeParam->name = parseIdentifier();
-            typeParam->location = SourceRange(startToken.location.start, previous().location.end());
+            typeParam->location = SourceRange(startToken.location.start, tokens.previous_location().end());
             typeParams.push_back(typeParam);
 
             if (!consume(TokenKind::Comma))
@@ -2087,8 +2330,8 @@ namespace Fern
         // No semicolon found - check if next token is on same line
         if (!tokens.at_end())
         {
-            Token prev = tokens.previous();
-            Token curr = tokens.current();
+            const Token &prev = tokens.previous();
+            const Token &curr = tokens.current();
 
             // If the next token is on the same line as the end of the previous statement,
             // we require a semicolon
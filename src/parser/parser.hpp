@@ -5,13 +5,22 @@
 #include "token_stream.hpp"
 #include "common/token.hpp"
 #include <vector>
+#include <memory>
 #include <optional>
 #include <string>
 #include <initializer_list>
+#include <unordered_map>
 #include <functional> // For std::invoke_result_t
 
 namespace Fern {
 
+// A change to a source text: the `removed` bytes at `offset` became `inserted` new ones
+struct TextEdit {
+    int offset;
+    int removed;
+    int inserted;
+};
+
 class Parser {
 public:
     Parser(TokenStream& tokens);
@@ -20,6 +29,29 @@ public:
     // Main entry point
     CompilationUnitSyntax* parse();
 
+    // Parse `source`, the text `edit` made of the one `prior` parsed into `priorUnit`, reusing
+    // the top-level declarations the edit didn't reach. This parser must be over the same
+    // TokenStream as `prior`; it is updated to the new text, relexing only from the edit to
+    // the next declaration whose tokens line up again. Reused declarations are moved to their
+    // new place and stay in `prior`'s arena, so this parser keeps `prior` alive. Falls back
+    // to lexing and parsing everything when `prior` had errors or reuse can't be made safe.
+    // `priorUnit` is consumed: the declarations it shares with the new tree are moved in
+    // place, so its locations are wrong afterwards, as are those of anything bound from it.
+    // Copying them instead would cost as much as parsing them again
+    CompilationUnitSyntax* reparse(std::unique_ptr<Parser> prior, CompilationUnitSyntax* priorUnit,
+                                   const TextEdit& edit, std::string_view source);
+
+    // Top-level declarations the last reparse() took from the previous tree
+    size_t getReusedCount() const { return reusedCount; }
+
+    // Packrat memoization of the rules parsed speculatively (on unless turned off)
+    void setMemoization(bool enabled) { memoize = enabled; }
+    struct MemoStats {
+        size_t hits;   // rule runs answered from the memo
+        size_t misses; // rule runs that parsed
+    };
+    MemoStats getMemoStats() const { return {memoHits, memoMisses}; }
+
     // Error tracking
     struct ParseError {
         std::string message;
@@ -35,6 +67,58 @@ private:
     Arena arena;
     TokenStream& tokens;
     std::vector<ParseError> errors;
+    size_t lastErrorPosition = SIZE_MAX; // a second error at the same token means recovery is stuck
+
+    // Incremental reparsing
+    std::unique_ptr<Parser> reusedFrom; // owns the arena the reused declarations are in
+    size_t generation = 0;              // reparses since the text was last parsed whole
+    size_t reusedCount = 0;
+    CompilationUnitSyntax* parseWhole(std::string_view source);
+
+    // Packrat memo for the rules that are tried speculatively and then parsed again from the
+    // same token: what the rule built there (nodes stay in the arena) and where it stopped.
+    // Without it, a chain like `a < b < c ...` tries generic arguments from every `<` to the
+    // end, and nested initializers are parsed twice at every level
+    enum class MemoRule : uint8_t { TypeExpression, GenericArgs, Initializer, Count };
+    struct MemoEntry {
+        size_t end;                      // token position after the rule
+        BaseExprSyntax* node;            // TypeExpression and Initializer
+        List<BaseExprSyntax*> arguments; // GenericArgs
+    };
+    std::unordered_map<size_t, MemoEntry> memo; // keyed by token position and rule
+    bool memoize = true;
+    size_t memoHits = 0;
+    size_t memoMisses = 0;
+
+    template <typename F>
+    auto memoized(MemoRule rule, F &&parseRule)
+    {
+        using Result = std::invoke_result_t<F>;
+        constexpr bool isList = std::is_same_v<Result, List<BaseExprSyntax*>>;
+        if (!memoize)
+            return parseRule();
+
+        size_t key = tokens.position() * size_t(MemoRule::Count) + size_t(rule);
+        if (auto it = memo.find(key); it != memo.end())
+        {
+            memoHits++;
+            tokens.restore({it->second.end});
+            if constexpr (isList)
+                return it->second.arguments;
+            else
+                return it->second.node;
+        }
+
+        memoMisses++;
+        Result result = parseRule();
+        MemoEntry entry{tokens.position(), nullptr, {}};
+        if constexpr (isList)
+            entry.arguments = result;
+        else
+            entry.node = result;
+        memo.emplace(key, entry);
+        return result;
+    }
 
     // Context tracking
     enum class Context {
@@ -82,10 +166,10 @@ private:
 
     // ================== Utility Helpers ==================
     bool check(TokenKind kind);
-    bool checkAny(std::initializer_list<TokenKind> kinds);
+    bool checkAny(TokenKindSet kinds);
     bool consume(TokenKind kind);
     bool expect(TokenKind kind, const std::string& msg);
-    Token previous();
+    const Token &previous();
     TokenKind peekNext();
     bool isExpressionTerminator();
     bool isPatternTerminator();
@@ -131,7 +215,10 @@ private:
     LiteralExprSyntax* parseLiteral();
     BaseNameExprSyntax* parseNameExpression();
     List<BaseExprSyntax *> parseGenericArgs();
+    List<BaseExprSyntax *> parseGenericArgsUnmemoized();
     BaseExprSyntax* parseTypeExpression();
+    BaseExprSyntax* parseTypeExpressionUnmemoized();
+    BaseExprSyntax* parseInitializer(); // the expression after a declaration's '='
     BaseExprSyntax* parseParenthesizedOrLambda();
     BaseExprSyntax* parseCastExpression();
     BaseExprSyntax* parseArrayLiteral();
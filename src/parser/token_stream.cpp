@@ -1,45 +1,54 @@
 #include "parser/token_stream.hpp"
 #include <algorithm>
+#include <iterator>
 #include <stdexcept>
 #include <sstream>
 #include <iomanip>
 
 namespace Fern
 {
+    TokenStream::TokenStream(std::vector<Token> tokens) : tokens_(std::move(tokens)), position_(0)
+    {
+        index_from(0);
+    }
+
     const Token &TokenStream::current() const
     {
         ensure_valid_position();
         return tokens_[position_];
     }
 
-    const Token &TokenStream::peek(int offset) const
+    size_t TokenStream::clamp(int offset) const
     {
         if (offset < 0)
         {
             // Handle negative offsets (looking backward)
             size_t back_offset = static_cast<size_t>(-offset);
-            if (back_offset > position_)
-            {
-                return tokens_[0];
-            }
-            return tokens_[position_ - back_offset];
+            return back_offset > position_ ? 0 : position_ - back_offset;
         }
 
         size_t target_pos = position_ + static_cast<size_t>(offset);
-        if (target_pos >= tokens_.size())
-        {
-            return tokens_.back(); // Return EOF token
-        }
-        return tokens_[target_pos];
+        return target_pos >= tokens_.size() ? tokens_.size() - 1 : target_pos; // EOF token
+    }
+
+    const Token &TokenStream::peek(int offset) const
+    {
+        return tokens_[clamp(offset)];
+    }
+
+    TokenKind TokenStream::peek_kind(int offset) const
+    {
+        return static_cast<TokenKind>(kinds_[clamp(offset)]);
     }
 
     const Token &TokenStream::previous() const
     {
-        if (position_ == 0)
-        {
-            return tokens_[0];
-        }
-        return tokens_[position_ - 1];
+        return tokens_[position_ == 0 ? 0 : position_ - 1];
+    }
+
+    SourceRange TokenStream::previous_location() const
+    {
+        return locations_[position_ == 0 ? 0 : position_ - 1];
     }
 
     void TokenStream::advance()
@@ -52,33 +61,29 @@ namespace Fern
 
     bool TokenStream::at_end() const
     {
-        return position_ >= tokens_.size() ||
-               (position_ < tokens_.size() && tokens_[position_].kind == TokenKind::EndOfFile);
+        return position_ >= kinds_.size() || kinds_[position_] == static_cast<uint8_t>(TokenKind::EndOfFile);
     }
 
     bool TokenStream::check(TokenKind kind) const
     {
         if (at_end())
             return false;
-        return current().kind == kind;
+        return kinds_[position_] == static_cast<uint8_t>(kind);
     }
 
-    bool TokenStream::check_any(std::initializer_list<TokenKind> kinds) const
+    bool TokenStream::check_any(TokenKindSet kinds) const
     {
         if (at_end())
             return false;
-        TokenKind current_kind = current().kind;
-        return std::any_of(kinds.begin(), kinds.end(),
-                           [current_kind](TokenKind k)
-                           { return k == current_kind; });
+        return kinds.contains(static_cast<TokenKind>(kinds_[position_]));
     }
 
     bool TokenStream::check_sequence(std::initializer_list<TokenKind> sequence) const
     {
-        size_t offset = 0;
+        int offset = 0;
         for (TokenKind kind : sequence)
         {
-            if (peek(offset).kind != kind)
+            if (peek_kind(offset) != kind)
             {
                 return false;
             }
@@ -97,7 +102,7 @@ namespace Fern
         return false;
     }
 
-    bool TokenStream::consume_any(std::initializer_list<TokenKind> kinds)
+    bool TokenStream::consume_any(TokenKindSet kinds)
     {
         if (check_any(kinds))
         {
@@ -107,20 +112,14 @@ namespace Fern
         return false;
     }
 
-    TokenKind TokenStream::consume_any_get(std::initializer_list<TokenKind> kinds)
+    TokenKind TokenStream::consume_any_get(TokenKindSet kinds)
     {
-        if (at_end())
+        if (!check_any(kinds))
             return TokenKind::EndOfFile;
 
-        TokenKind current_kind = current().kind;
-        if (std::any_of(kinds.begin(), kinds.end(),
-                        [current_kind](TokenKind k)
-                        { return k == current_kind; }))
-        {
-            advance();
-            return current_kind;
-        }
-        return TokenKind::EndOfFile;
+        TokenKind kind = current_kind();
+        advance();
+        return kind;
     }
 
     void TokenStream::skip_to(TokenKind kind)
@@ -131,7 +130,7 @@ namespace Fern
         }
     }
 
-    void TokenStream::skip_to_any(std::initializer_list<TokenKind> kinds)
+    void TokenStream::skip_to_any(TokenKindSet kinds)
     {
         while (!at_end() && !check_any(kinds))
         {
@@ -164,13 +163,54 @@ namespace Fern
             
             // Insert the second '>' right after the current position
             tokens_.insert(tokens_.begin() + position_ + 1, rightToken);
+            index_from(position_);
+        }
+    }
+
+    void TokenStream::splice(size_t first, size_t last, std::vector<Token> replacement, int offset_delta, int line_delta)
+    {
+        first = std::min(first, tokens_.size());
+        last = std::clamp(last, first, tokens_.size());
+
+        // In place: the tokens after the edit are most of a large file, and only their
+        // positions change
+        for (size_t i = last; i < tokens_.size(); i++)
+        {
+            auto &start = tokens_[i].location.start;
+            start.offset += offset_delta;
+            start.line += line_delta;
         }
+
+        size_t common = std::min(last - first, replacement.size());
+        std::move(replacement.begin(), replacement.begin() + common, tokens_.begin() + first);
+        if (replacement.size() > common)
+        {
+            tokens_.insert(tokens_.begin() + last, std::make_move_iterator(replacement.begin() + common),
+                           std::make_move_iterator(replacement.end()));
+        }
+        else
+        {
+            tokens_.erase(tokens_.begin() + first + common, tokens_.begin() + last);
+        }
+        index_from(first);
+        position_ = 0;
     }
 
     SourceRange TokenStream::location() const
     {
         ensure_valid_position();
-        return tokens_[position_].location;
+        return locations_[position_];
+    }
+
+    void TokenStream::index_from(size_t first)
+    {
+        kinds_.resize(tokens_.size());
+        locations_.resize(tokens_.size());
+        for (size_t i = first; i < tokens_.size(); i++)
+        {
+            kinds_[i] = static_cast<uint8_t>(tokens_[i].kind);
+            locations_[i] = tokens_[i].location;
+        }
     }
 
     void TokenStream::ensure_valid_position() const
@@ -1,15 +1,24 @@
 #pragma once
 
 #include "common/token.hpp"
+#include <cstdint>
 #include <vector>
-#include <initializer_list>
 
 namespace Fern
 {
+    /**
+     * @brief The lexed tokens of a file and the parser's position in them
+     *
+     * Besides the tokens themselves, the stream keeps their kinds packed one byte each and
+     * their locations in a parallel array. Kind checks and locations, which the parser asks
+     * for several times per token, read those; a whole Token, with its text and trivia, is
+     * only touched when asked for. References to tokens stay valid until splice() or
+     * splitRightShift() changes the stream.
+     */
     class TokenStream
     {
     public:
-        TokenStream(std::vector<Token> tokens) : tokens_(std::move(tokens)), position_(0) {}
+        TokenStream(std::vector<Token> tokens);
 
         // Core navigation
         const Token &current() const;
@@ -18,14 +27,19 @@ namespace Fern
         void advance();
         bool at_end() const;
 
+        // Kinds and locations without touching the Token; the same clamping as peek()
+        TokenKind current_kind() const { return peek_kind(0); }
+        TokenKind peek_kind(int offset = 1) const;
+        SourceRange previous_location() const;
+
         // Conditional consumption
         bool check(TokenKind kind) const;
-        bool check_any(std::initializer_list<TokenKind> kinds) const;
+        bool check_any(TokenKindSet kinds) const;
         bool check_sequence(std::initializer_list<TokenKind> sequence) const;
 
         bool consume(TokenKind kind);
-        bool consume_any(std::initializer_list<TokenKind> kinds);
-        TokenKind consume_any_get(std::initializer_list<TokenKind> kinds);
+        bool consume_any(TokenKindSet kinds);
+        TokenKind consume_any_get(TokenKindSet kinds);
 
         // Speculative parsing support
         struct Checkpoint
@@ -38,12 +52,18 @@ namespace Fern
 
         // Skip to recovery points
         void skip_to(TokenKind kind);
-        void skip_to_any(std::initializer_list<TokenKind> kinds);
+        void skip_to_any(TokenKindSet kinds);
         void skip_past(TokenKind kind);
 
         // Generic parsing support
         void splitRightShift(); // Split '>>' into '>' + '>'
 
+        // Incremental reparsing support
+        const std::vector<Token> &get_tokens() const { return tokens_; }
+        // Replace tokens [first, last) with `replacement`, moving the ones after them by
+        // `offset_delta` bytes and `line_delta` lines, as the edit that was relexed did
+        void splice(size_t first, size_t last, std::vector<Token> replacement, int offset_delta, int line_delta);
+
         // Utility
         SourceRange location() const;
         size_t position() const { return position_; }
@@ -51,9 +71,13 @@ namespace Fern
         std::string to_string() const;
 
     private:
-        std::vector<Token> tokens_;
+        std::vector<Token> tokens_;          // whole tokens: the cold side, for text and trivia
+        std::vector<uint8_t> kinds_;         // tokens_[i].kind
+        std::vector<SourceRange> locations_; // tokens_[i].location
         size_t position_;
 
+        size_t clamp(int offset) const;
+        void index_from(size_t first); // refill kinds_ and locations_ from tokens_[first] on
         void ensure_valid_position() const;
     };
 }
\ No newline at end of file
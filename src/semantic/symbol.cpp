@@ -1,4 +1,5 @@
 #include "symbol.hpp"
+#include <algorithm>
 
 namespace Fern
 {
@@ -19,7 +20,20 @@ namespace Fern
         return ptr;
     }
     
-    std::vector<Symbol*> ContainerSymbol::get_member(const std::string& name) {
+    std::unique_ptr<Symbol> ContainerSymbol::remove_member(Symbol* member) {
+        auto range = members.equal_range(member->name);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.get() == member) {
+                auto symbol = std::move(it->second);
+                members.erase(it);
+                member_order.erase(std::find(member_order.begin(), member_order.end(), member));
+                return symbol;
+            }
+        }
+        return nullptr;
+    }
+
+    std::vector<Symbol*> ContainerSymbol::get_member(std::string_view name) {
         std::vector<Symbol*> results;
         auto range = members.equal_range(name);
         for (auto it = range.first; it != range.second; ++it) {
@@ -28,7 +42,12 @@ namespace Fern
         return results;
     }
     
-    std::vector<FunctionSymbol*> ContainerSymbol::get_functions(const std::string& name) {
+    Symbol* ContainerSymbol::find_member(std::string_view name) {
+        auto it = members.find(name);
+        return it != members.end() ? it->second.get() : nullptr;
+    }
+    
+    std::vector<FunctionSymbol*> ContainerSymbol::get_functions(std::string_view name) {
         std::vector<FunctionSymbol*> results;
         auto range = members.equal_range(name);
         for (auto it = range.first; it != range.second; ++it) {
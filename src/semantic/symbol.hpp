@@ -4,6 +4,7 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 #include "common/source_location.hpp"
@@ -115,20 +116,27 @@ namespace Fern
     
     struct ContainerSymbol : Symbol {
         // Children organized by name (multimap for overloads)
-        // Using std::multimap instead of unordered_multimap to preserve insertion order
-        std::multimap<std::string, std::unique_ptr<Symbol>> members;
+        // Using std::multimap instead of unordered_multimap to preserve insertion order;
+        // std::less<> so lookups by string_view don't build a std::string
+        std::multimap<std::string, std::unique_ptr<Symbol>, std::less<>> members;
 
         // Ordered list for deterministic iteration
         std::vector<Symbol*> member_order;
         
         // Add a member
         Symbol* add_member(std::unique_ptr<Symbol> symbol);
+
+        // Take a member back out; null if it isn't one
+        std::unique_ptr<Symbol> remove_member(Symbol* member);
         
         // Lookup member by name (non-recursive)
-        std::vector<Symbol*> get_member(const std::string& name);
+        std::vector<Symbol*> get_member(std::string_view name);
+
+        // First member by that name, without collecting the rest
+        Symbol* find_member(std::string_view name);
         
         // Get all function overloads
-        std::vector<FunctionSymbol*> get_functions(const std::string& name);
+        std::vector<FunctionSymbol*> get_functions(std::string_view name);
     };
 
     #pragma region Namespace Symbol
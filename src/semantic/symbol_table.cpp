@@ -1,4 +1,5 @@
 #include "symbol_table.hpp"
+#include <algorithm>
 #include <sstream>
 #include <functional>
 #include <iostream>
@@ -21,7 +22,8 @@ void SymbolTable::push_scope(Symbol* scope) {
 }
 
 void SymbolTable::pop_scope() {
-    if (current_scope && current_scope->parent) {
+    // An outer namespace is only for lookups, never a scope to define into
+    if (current_scope && current_scope->parent && current_scope != global_namespace.get()) {
         current_scope = current_scope->parent;
     }
 }
@@ -86,14 +88,13 @@ LocalSymbol* SymbolTable::define_local(const std::string& name, TypePtr type) {
     );
 }
 
-Symbol* SymbolTable::resolve(const std::string& name) {
+Symbol* SymbolTable::resolve(std::string_view name) {
     // Walk up scopes looking for name
     Symbol* scope = current_scope;
     while (scope) {
         if (auto container = scope->as<ContainerSymbol>()) {
-            auto members = container->get_member(name);
-            if (!members.empty()) {
-                return members[0];
+            if (auto member = container->find_member(name)) {
+                return member;
             }
         }
         scope = scope->parent;
@@ -102,58 +103,53 @@ Symbol* SymbolTable::resolve(const std::string& name) {
     return nullptr;
 }
 
-Symbol* SymbolTable::resolve(const std::vector<std::string>& parts) {
+Symbol* SymbolTable::resolve(std::span<const std::string_view> parts) {
     // convert to name, then call resolve
     if (parts.empty()) return nullptr;
-    std::string name = parts[0];
+    if (parts.size() == 1) return resolve(parts[0]);
+    std::string name(parts[0]);
     for (size_t i = 1; i < parts.size(); ++i) {
-        name += "." + parts[i];
+        name += '.';
+        name += parts[i];
     }
     return resolve(name);
 }
 
-Symbol* SymbolTable::resolve_local(const std::string& name) {
+Symbol* SymbolTable::resolve_local(std::string_view name) {
     if (auto container = current_scope->as<ContainerSymbol>()) {
-        auto members = container->get_member(name);
-        if (!members.empty()) {
-            return members[0]; // TODO: Handle ambiguity
-        }
+        return container->find_member(name); // TODO: Handle ambiguity
     }
     return nullptr;
 }
 
-Symbol* SymbolTable::resolve_local(const std::vector<std::string>& parts) {
+Symbol* SymbolTable::resolve_local(std::span<const std::string_view> parts) {
     if (parts.empty()) return nullptr;
     // just look up the last part in the current scope
     return resolve_local(parts.back());
 }
 
-FunctionSymbol* SymbolTable::resolve_function(const std::string& name, const std::vector<TypePtr>& arg_types) {
-    std::vector<FunctionSymbol*> candidates;
-    
-    // Collect all functions with this name
+FunctionSymbol* SymbolTable::resolve_function(std::string_view name, const std::vector<TypePtr>& arg_types) {
+    // Simple overload resolution (exact match only for now), innermost scope first
     Symbol* scope = current_scope;
     while (scope) {
         if (auto container = scope->as<ContainerSymbol>()) {
-            auto funcs = container->get_functions(name);
-            candidates.insert(candidates.end(), funcs.begin(), funcs.end());
-        }
-        scope = scope->parent;
-    }
-    
-    // Simple overload resolution (exact match only for now)
-    for (auto func : candidates) {
-        if (func->parameters.size() != arg_types.size()) continue;
-        
-        bool matches = true;
-        for (size_t i = 0; i < arg_types.size(); i++) {
-            if (func->parameters[i]->type != arg_types[i]) {
-                matches = false;
-                break;
+            auto range = container->members.equal_range(name);
+            for (auto it = range.first; it != range.second; ++it) {
+                auto func = it->second->as<FunctionSymbol>();
+                if (!func || func->parameters.size() != arg_types.size()) continue;
+
+                bool matches = true;
+                for (size_t i = 0; i < arg_types.size(); i++) {
+                    if (func->parameters[i]->type != arg_types[i]) {
+                        matches = false;
+                        break;
+                    }
+                }
+
+                if (matches) return func;
             }
         }
-        
-        if (matches) return func;
+        scope = scope->parent;
     }
     
     return nullptr;
@@ -164,6 +160,10 @@ NamespaceSymbol* SymbolTable::get_global_namespace() {
     return global_namespace.get();
 }
 
+void SymbolTable::set_outer_namespace(NamespaceSymbol* outer) {
+    global_namespace->parent = outer;
+}
+
 void SymbolTable::map_ast_to_symbol(BaseSyntax* ast_node, Symbol* symbol) {
     if (ast_node && symbol) {
         ast_to_symbol_map[ast_node] = symbol;
@@ -179,9 +179,37 @@ Symbol* SymbolTable::get_symbol_for_ast(BaseSyntax* ast_node) {
     return nullptr;
 }
 
-std::vector<std::string> SymbolTable::merge(SymbolTable& other) {
+void SymbolTable::unmap_ast(BaseSyntax* ast_node) {
+    ast_to_symbol_map.erase(ast_node);
+}
+
+std::vector<Symbol*> SymbolTable::collect_declarations(NamespaceSymbol* ns) {
+    std::vector<Symbol*> declarations;
+    std::function<void(NamespaceSymbol*)> collect = [&](NamespaceSymbol* current) {
+        for (auto member : current->member_order) {
+            if (auto nested = member->as<NamespaceSymbol>()) {
+                collect(nested);
+            } else {
+                declarations.push_back(member);
+            }
+        }
+    };
+    if (ns) collect(ns);
+    return declarations;
+}
+
+std::vector<std::string> SymbolTable::merge(SymbolTable& other, MergedSymbols* merged) {
     std::vector<std::string> conflicts;
 
+    // Listed before anything moves, while the other table still holds it all
+    if (merged) {
+        merged->declarations = collect_declarations(other.global_namespace.get());
+        merged->syntax.clear();
+        for (auto& [ast_node, symbol] : other.ast_to_symbol_map) {
+            merged->syntax.push_back(ast_node);
+        }
+    }
+
     // Merge AST to symbol mappings
     for (auto& [ast_node, symbol] : other.ast_to_symbol_map) {
         ast_to_symbol_map[ast_node] = symbol;
@@ -294,6 +322,8 @@ void SymbolTable::merge_namespace(NamespaceSymbol* target, NamespaceSymbol* sour
                 conflicts.push_back("Symbol conflict: '" + name +
                                   "' already exists in namespace '" +
                                   target->get_qualified_name() + "'");
+                symbol_ptr->parent = target;
+                rejected.push_back(std::move(symbol_ptr));
             }
         } else {
             // No conflict - transfer symbol to target
@@ -307,6 +337,29 @@ void SymbolTable::merge_namespace(NamespaceSymbol* target, NamespaceSymbol* sour
     }
 }
 
+std::vector<std::unique_ptr<Symbol>> SymbolTable::unmerge(const MergedSymbols& merged) {
+    std::vector<std::unique_ptr<Symbol>> removed;
+    for (auto symbol : merged.declarations) {
+        auto container = symbol->parent ? symbol->parent->as<ContainerSymbol>() : nullptr;
+        auto owned = container ? container->remove_member(symbol) : nullptr;
+        if (!owned) {
+            // Never added: the merge rejected it
+            auto it = std::find_if(rejected.begin(), rejected.end(),
+                                   [symbol](const auto& r) { return r.get() == symbol; });
+            if (it != rejected.end()) {
+                owned = std::move(*it);
+                rejected.erase(it);
+            }
+        }
+        if (owned) removed.push_back(std::move(owned));
+    }
+
+    for (auto ast_node : merged.syntax) {
+        ast_to_symbol_map.erase(ast_node);
+    }
+    return removed;
+}
+
 void SymbolTable::update_parent_pointers(Symbol* symbol, Symbol* new_parent) {
     symbol->parent = new_parent;
     
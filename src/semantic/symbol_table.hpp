@@ -2,6 +2,8 @@
 
 #include <string>
 #include <memory>
+#include <span>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include "symbol.hpp"
@@ -34,15 +36,20 @@ public:
     LocalSymbol* define_local(const std::string& name, TypePtr type);
     
     // Symbol resolution
-    Symbol* resolve(const std::string& name);
-    Symbol* resolve(const std::vector<std::string>& parts);
-    Symbol* resolve_local(const std::string& name);
-    Symbol* resolve_local(const std::vector<std::string>& parts);
-    FunctionSymbol* resolve_function(const std::string& name, const std::vector<TypePtr>& arg_types);
+    Symbol* resolve(std::string_view name);
+    Symbol* resolve(std::span<const std::string_view> parts);
+    Symbol* resolve_local(std::string_view name);
+    Symbol* resolve_local(std::span<const std::string_view> parts);
+    FunctionSymbol* resolve_function(std::string_view name, const std::vector<TypePtr>& arg_types);
     
     // Access to global namespace
     NamespaceSymbol* get_global_namespace();
 
+    // Resolve names this table doesn't define in another table's global namespace, e.g. a
+    // library compiled once and shared by many small programs. Nothing is copied or moved,
+    // so the outer table must outlive this one
+    void set_outer_namespace(NamespaceSymbol* outer);
+
     // Access to type system (needed by symbol_table_builder)
     TypeSystem& get_type_system() { return types; }
     const TypeSystem& get_type_system() const { return types; }
@@ -51,8 +58,26 @@ public:
     void map_ast_to_symbol(BaseSyntax* ast_node, Symbol* symbol);
     Symbol* get_symbol_for_ast(BaseSyntax* ast_node);
 
+    // AST nodes mapped so far, e.g. to carry a rebuilt table's mappings over to this one
+    const std::unordered_map<BaseSyntax*, Symbol*>& get_ast_symbols() const { return ast_to_symbol_map; }
+    void unmap_ast(BaseSyntax* ast_node);
+
+    // What one merge() brought in, so unmerge() can take it out again
+    struct MergedSymbols {
+        std::vector<Symbol*> declarations; // the other table's non-namespace members of namespaces
+        std::vector<BaseSyntax*> syntax;   // its AST mappings
+    };
+
     // Merge another symbol table into this one
-    std::vector<std::string> merge(SymbolTable& other);
+    std::vector<std::string> merge(SymbolTable& other, MergedSymbols* merged = nullptr);
+
+    // Take out what a merge() brought in, e.g. to replace one file's declarations with a newer
+    // version of them. Namespaces stay, even if that leaves them empty. The symbols are handed
+    // back rather than destroyed, since bound trees may still point at them
+    std::vector<std::unique_ptr<Symbol>> unmerge(const MergedSymbols& merged);
+
+    // The non-namespace members of `ns` and of the namespaces in it, in declaration order
+    static std::vector<Symbol*> collect_declarations(NamespaceSymbol* ns);
 
     // Debugging
     std::string to_string() const;
@@ -65,6 +90,10 @@ private:
     // Mapping from AST nodes to their corresponding symbols
     std::unordered_map<BaseSyntax*, Symbol*> ast_to_symbol_map;
 
+    // Symbols a merge turned away as conflicts. The AST mappings merged with them still point
+    // at them, so they're kept rather than destroyed
+    std::vector<std::unique_ptr<Symbol>> rejected;
+
     // Recursively merge source namespace into target namespace
     void merge_namespace(NamespaceSymbol* target, NamespaceSymbol* source,
                         std::vector<std::string>& conflicts);
@@ -22,7 +22,7 @@ namespace Fern
     {
         if (unit)
         {
-            unit->accept(this);
+            dispatch(unit);
         }
     }
 
@@ -41,7 +41,7 @@ namespace Fern
         for (auto stmt : node->topLevelStatements)
         {
             if (stmt)
-                stmt->accept(this);
+                dispatch(stmt);
         }
 
         symbolTable.pop_scope();
@@ -71,7 +71,7 @@ namespace Fern
             for (auto stmt : *node->body)
             {
                 if (stmt)
-                    stmt->accept(this);
+                    dispatch(stmt);
             }
         }
 
@@ -112,6 +112,7 @@ namespace Fern
 
         // Set access level
         type_symbol->access = get_access_level(node->modifiers);
+        type_symbol->location = node->location;
 
         // Enter type scope
         symbolTable.push_scope(type_symbol);
@@ -120,7 +121,7 @@ namespace Fern
         for (auto member : node->members)
         {
             if (member)
-                member->accept(this);
+                dispatch(member);
         }
 
         symbolTable.pop_scope();
@@ -170,6 +171,7 @@ namespace Fern
         }
 
         func_symbol->access = get_access_level(node->modifiers);
+        func_symbol->location = node->location;
 
         // Enter function scope
         symbolTable.push_scope(func_symbol);
@@ -181,7 +183,7 @@ namespace Fern
         {
             if (param_decl)
             {
-                param_decl->accept(this);
+                dispatch(param_decl);
 
                 // Extract the created parameter symbol
                 if (param_decl->param && param_decl->param->name)
@@ -206,7 +208,7 @@ namespace Fern
             for (auto stmt : node->body->statements)
             {
                 if (stmt)
-                    stmt->accept(this);
+                    dispatch(stmt);
             }
         }
 
@@ -253,7 +255,7 @@ namespace Fern
         {
             if (param_decl)
             {
-                param_decl->accept(this);
+                dispatch(param_decl);
 
                 // Extract the created parameter symbol
                 if (param_decl->param && param_decl->param->name)
@@ -284,7 +286,7 @@ namespace Fern
             for (auto stmt : node->body->statements)
             {
                 if (stmt)
-                    stmt->accept(this);
+                    dispatch(stmt);
             }
         }
 
@@ -307,13 +309,14 @@ namespace Fern
         }
         else
         {
+            param_symbol->location = node->location;
         }
 
         // Visit children for annotation
         if (node->param)
-            node->param->accept(this);
+            dispatch(node->param);
         if (node->defaultValue)
-            node->defaultValue->accept(this);
+            dispatch(node->defaultValue);
     }
 
     void SymbolTableBuilder::visit(VariableDeclSyntax *node)
@@ -334,6 +337,10 @@ namespace Fern
             {
                 push_error("Failed to define field '" + name + "'");
             }
+            else
+            {
+                field_symbol->location = node->location;
+            }
         }
         else
         {
@@ -343,13 +350,17 @@ namespace Fern
             {
                 push_error("Failed to define local variable '" + name + "'");
             }
+            else
+            {
+                local_symbol->location = node->location;
+            }
         }
 
         // Visit children
         if (node->variable)
-            node->variable->accept(this);
+            dispatch(node->variable);
         if (node->initializer)
-            node->initializer->accept(this);
+            dispatch(node->initializer);
     }
 
     void SymbolTableBuilder::visit(PropertyDeclSyntax *node)
@@ -370,6 +381,8 @@ namespace Fern
             return;
         }
 
+        prop_symbol->location = node->location;
+
         // Store whether this property has getter/setter and create function symbols
         prop_symbol->has_getter = (node->getter != nullptr);
         prop_symbol->has_setter = (node->setter != nullptr);
@@ -422,7 +435,7 @@ namespace Fern
         for (auto stmt : node->statements)
         {
             if (stmt)
-                stmt->accept(this);
+                dispatch(stmt);
         }
 
         symbolTable.pop_scope();
@@ -432,22 +445,22 @@ namespace Fern
     {
         // Visit condition in current scope
         if (node->condition)
-            node->condition->accept(this);
+            dispatch(node->condition);
 
         // Visit branches - they are BlockSyntax nodes that create their own scopes
         if (node->thenBranch)
-            node->thenBranch->accept(this);
+            dispatch(node->thenBranch);
         if (node->elseBranch)
-            node->elseBranch->accept(this);
+            dispatch(node->elseBranch);
     }
 
     void SymbolTableBuilder::visit(WhileStmtSyntax *node)
     {
         // Visit condition and body - body is BlockSyntax that creates its own scope
         if (node->condition)
-            node->condition->accept(this);
+            dispatch(node->condition);
         if (node->body)
-            node->body->accept(this);
+            dispatch(node->body);
     }
 
     void SymbolTableBuilder::visit(ForStmtSyntax *node)
@@ -458,16 +471,16 @@ namespace Fern
         symbolTable.push_scope(for_block);
 
         if (node->initializer)
-            node->initializer->accept(this);
+            dispatch(node->initializer);
         if (node->condition)
-            node->condition->accept(this);
+            dispatch(node->condition);
         for (auto update : node->updates)
         {
             if (update)
-                update->accept(this);
+                dispatch(update);
         }
         if (node->body)
-            node->body->accept(this);
+            dispatch(node->body);
 
         symbolTable.pop_scope();
     }
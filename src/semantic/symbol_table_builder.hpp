@@ -8,7 +8,7 @@
 namespace Fern
 {
 
-class SymbolTableBuilder : public DefaultVisitor
+class SymbolTableBuilder final : public SyntaxSwitchVisitor<SymbolTableBuilder>
 {
 private:
     SymbolTable& symbolTable;
@@ -35,7 +35,8 @@ public:
     bool has_errors() const { return !errors.empty(); }
 
     // === Visitor Implementations ===
-    
+
+    using DefaultVisitor::visit;
     void visit(BaseSyntax* node) override;
     void visit(CompilationUnitSyntax* node) override;
     void visit(NamespaceDeclSyntax* node) override;
@@ -1,5 +1,6 @@
 #include "type.hpp"
 #include "symbol.hpp"
+#include <algorithm>
 
 namespace Fern
 {
@@ -9,6 +10,7 @@ namespace Fern
     
     bool Type::is_value_type() const {
         if (is<PrimitiveType>()) return true;
+        if (is<VectorType>()) return true;
         if (is<PointerType>()) return true;  // Pointers themselves are values
         if (is<NamedType>()) {
             // Check if the type symbol is a value type (struct)
@@ -52,6 +54,9 @@ namespace Fern
                 }
                 return t.element->get_name() + "[]";
             }
+            else if constexpr (std::is_same_v<T, VectorType>) {
+                return t.element->get_name() + "x" + std::to_string(t.lanes);
+            }
             else if constexpr (std::is_same_v<T, FunctionType>) {
                 std::string result = "fn(";
                 for (size_t i = 0; i < t.paramTypes.size(); i++) {
@@ -87,15 +92,75 @@ namespace Fern
         }, kind);
     }
 
+    // Layout follows the LLVM structs HLIRCodeGen emits: natural alignment, fields in
+    // declaration order, 64-bit pointers, dynamic arrays as { i32 length, ptr data }
+    static int round_up(int value, int alignment) {
+        return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+    }
+
     int Type::get_size() const
     {
-        // TODO: Implement proper size calculation based on type
-        return 4;
+        if (auto prim = as<PrimitiveType>()) {
+            switch (prim->kind) {
+                case PrimitiveKind::Void: return 0;
+                case PrimitiveKind::Bool:
+                case PrimitiveKind::Char:
+                case PrimitiveKind::I8:
+                case PrimitiveKind::U8: return 1;
+                case PrimitiveKind::I16:
+                case PrimitiveKind::U16: return 2;
+                case PrimitiveKind::I32:
+                case PrimitiveKind::U32:
+                case PrimitiveKind::F32: return 4;
+                case PrimitiveKind::I64:
+                case PrimitiveKind::U64:
+                case PrimitiveKind::F64: return 8;
+            }
+        }
+        if (is<PointerType>() || is<FunctionType>()) return 8;
+        if (auto array = as<ArrayType>()) {
+            if (array->size >= 0) return array->element->get_size() * array->size;
+            return 16;
+        }
+        if (auto vector = as<VectorType>()) {
+            return vector->element->get_size() * static_cast<int>(vector->lanes);
+        }
+        if (auto named = as<NamedType>()) {
+            if (!named->symbol) return 0;
+            int offset = 0;
+            for (auto member : named->symbol->member_order) {
+                if (auto field = member->as<VariableSymbol>()) {
+                    if (!field->type) continue;
+                    offset = round_up(offset, field->type->get_alignment()) + field->type->get_size();
+                }
+            }
+            return round_up(offset, get_alignment());
+        }
+        return 0; // generics and unresolved types have no layout yet
     }
 
     int Type::get_alignment() const {
-        // TODO: Implement proper alignment calculation based on type
-        return 4;
+        if (is<PrimitiveType>()) {
+            return std::max(1, get_size());
+        }
+        if (is<PointerType>() || is<FunctionType>()) return 8;
+        if (auto array = as<ArrayType>()) {
+            return array->size >= 0 ? array->element->get_alignment() : 8;
+        }
+        if (is<VectorType>()) {
+            return get_size(); // LLVM aligns vectors to their full width
+        }
+        if (auto named = as<NamedType>()) {
+            int alignment = 1;
+            if (!named->symbol) return alignment;
+            for (auto member : named->symbol->member_order) {
+                if (auto field = member->as<VariableSymbol>()) {
+                    if (field->type) alignment = std::max(alignment, field->type->get_alignment());
+                }
+            }
+            return alignment;
+        }
+        return 1;
     }
 
 } // namespace Fern
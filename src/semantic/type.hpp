@@ -35,6 +35,12 @@ namespace Fern
         int32_t size = -1;  // -1 = dynamic array
     };
     
+    // Fixed-width SIMD vector of a numeric primitive, e.g. f32x4 or i32x8
+    struct VectorType {
+        TypePtr element;
+        uint32_t lanes;
+    };
+    
     struct FunctionType {
         TypePtr returnType;
         std::vector<TypePtr> paramTypes;
@@ -65,6 +71,7 @@ namespace Fern
             PrimitiveType,
             PointerType,
             ArrayType,
+            VectorType,
             FunctionType,
             NamedType,
             GenericType,
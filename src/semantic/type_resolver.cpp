@@ -8,6 +8,7 @@ namespace Fern
     bool TypeResolver::resolve(BoundCompilationUnit *unit)
     {
         errors.clear();
+        diagnostics.clear();
         substitution.clear();
         pendingConstraints.clear();
 
@@ -16,11 +17,12 @@ namespace Fern
         {
             // Clear errors at start of each pass (we'll re-encounter them if they persist)
             errors.clear();
+            diagnostics.clear();
 
             size_t constraintsBefore = pendingConstraints.size();
 
             // Visit the entire tree
-            unit->accept(this);
+            dispatch(unit);
 
             // Check if we made progress
             bool madeProgress = (pendingConstraints.size() < constraintsBefore);
@@ -107,7 +109,7 @@ namespace Fern
 
     // === Symbol Resolution ===
 
-    Symbol *TypeResolver::resolve_qualified_name(const std::vector<std::string> &parts)
+    Symbol *TypeResolver::resolve_qualified_name(std::span<const std::string_view> parts)
     {
         if (parts.empty())
             return nullptr;
@@ -129,11 +131,9 @@ namespace Fern
             if (!container)
                 return nullptr;
 
-            auto members = container->get_member(parts[i]);
-            if (members.empty())
+            current = container->find_member(parts[i]); // TODO: Handle ambiguity
+            if (!current)
                 return nullptr;
-
-            current = members[0]; // TODO: Handle ambiguity
         }
 
         return current;
@@ -274,6 +274,12 @@ namespace Fern
                 {
                     return primitive;
                 }
+
+                TypePtr vector = typeSystem.get_vector(boundType->parts[0]);
+                if (vector)
+                {
+                    return vector;
+                }
             }
         }
 
@@ -474,6 +480,7 @@ namespace Fern
             ss << "Error: " << message;
         }
         errors.push_back(ss.str());
+        diagnostics.push_back({node ? node->location : SourceRange(), node != nullptr, message});
     }
 
     void TypeResolver::report_final_errors()
@@ -481,7 +488,186 @@ namespace Fern
         for (auto constraint : pendingConstraints)
         {
             errors.push_back("Could not infer type: " + constraint->get_name());
+            diagnostics.push_back({SourceRange(), false, errors.back()});
+        }
+    }
+
+    // === Vector Built-ins ===
+
+    bool TypeResolver::get_constant_lane(BoundExpression *expr, int64_t &lane)
+    {
+        auto literal = expr ? expr->as<BoundLiteralExpression>() : nullptr;
+        if (!literal || !std::holds_alternative<int64_t>(literal->constantValue))
+            return false;
+
+        lane = std::get<int64_t>(literal->constantValue);
+        return true;
+    }
+
+    TypePtr TypeResolver::resolve_vector_binary(BoundBinaryExpression *node, TypePtr leftType, TypePtr rightType)
+    {
+        // Operators apply lane by lane; a scalar operand is broadcast to every lane
+        TypePtr vectorType = leftType->is<VectorType>() ? leftType : rightType;
+        TypePtr otherType = leftType->is<VectorType>() ? rightType : leftType;
+        TypePtr elementType = vectorType->as<VectorType>()->element;
+
+        if (otherType->is<UnresolvedType>())
+        {
+            unify(otherType, elementType, node, "vector operand");
+        }
+        else if (otherType != vectorType && otherType != elementType)
+        {
+            report_error(node, "Incompatible types for binary operator: '" +
+                                   leftType->get_name() + "' and '" + rightType->get_name() + "'");
+            return typeSystem.get_unresolved();
+        }
+
+        switch (node->operatorKind)
+        {
+        case BinaryOperatorKind::Add:
+        case BinaryOperatorKind::Subtract:
+        case BinaryOperatorKind::Multiply:
+        case BinaryOperatorKind::Divide:
+        case BinaryOperatorKind::Modulo:
+            return vectorType;
+
+        case BinaryOperatorKind::BitwiseAnd:
+        case BinaryOperatorKind::BitwiseOr:
+        case BinaryOperatorKind::BitwiseXor:
+        case BinaryOperatorKind::LeftShift:
+        case BinaryOperatorKind::RightShift:
+            if (elementType == typeSystem.get_f32() || elementType == typeSystem.get_f64())
+            {
+                report_error(node, "Bitwise operators require an integer vector, got '" +
+                                       vectorType->get_name() + "'");
+                return typeSystem.get_unresolved();
+            }
+            return vectorType;
+
+        default:
+            report_error(node, "Operator is not supported on vector type '" + vectorType->get_name() + "'");
+            return typeSystem.get_unresolved();
+        }
+    }
+
+    bool TypeResolver::resolve_vector_constructor(BoundCallExpression *node)
+    {
+        auto nameExpr = node->callee ? node->callee->as<BoundNameExpression>() : nullptr;
+        if (!nameExpr || nameExpr->parts.size() != 1 || resolve_qualified_name(nameExpr->parts))
+            return false;
+
+        TypePtr vectorType = typeSystem.get_vector(nameExpr->parts[0]);
+        if (!vectorType)
+            return false;
+
+        auto vector = vectorType->as<VectorType>();
+        for (auto arg : node->arguments)
+        {
+            if (arg)
+                dispatch(arg);
+        }
+
+        // Either one value per lane, or a single value broadcast to all of them
+        if (node->arguments.size() != 1 && node->arguments.size() != vector->lanes)
+        {
+            report_error(node, "'" + vectorType->get_name() + "' takes 1 or " + std::to_string(vector->lanes) +
+                                   " values, got " + std::to_string(node->arguments.size()));
+        }
+        else
+        {
+            for (size_t i = 0; i < node->arguments.size(); ++i)
+            {
+                TypePtr argType = apply_substitution(node->arguments[i]->type);
+                if (argType->is<UnresolvedType>())
+                    unify(argType, vector->element, node, "vector lane");
+                else
+                    check_implicit_conversion(argType, vector->element, node, "lane " + std::to_string(i));
+            }
+        }
+
+        node->intrinsic = VectorIntrinsic::Construct;
+        annotate_expression(node, vectorType);
+        return true;
+    }
+
+    void TypeResolver::resolve_vector_method(BoundCallExpression *node, BoundMemberAccessExpression *memberExpr,
+                                             TypePtr vectorType)
+    {
+        auto vector = vectorType->as<VectorType>();
+        std::string name(memberExpr->memberName);
+
+        // Horizontal reductions fold every lane into one element
+        VectorIntrinsic reduction = VectorIntrinsic::None;
+        if (name == "sum")
+            reduction = VectorIntrinsic::Sum;
+        else if (name == "product")
+            reduction = VectorIntrinsic::Product;
+        else if (name == "min")
+            reduction = VectorIntrinsic::Min;
+        else if (name == "max")
+            reduction = VectorIntrinsic::Max;
+
+        if (reduction != VectorIntrinsic::None)
+        {
+            if (!node->arguments.empty())
+            {
+                report_error(node, "'" + name + "' takes no arguments");
+            }
+            node->intrinsic = reduction;
+            annotate_expression(node, vector->element);
+            return;
+        }
+
+        if (name != "shuffle")
+        {
+            report_error(node, "Unknown vector operation '" + name + "' on '" + vectorType->get_name() + "'");
+            annotate_expression(node, typeSystem.get_unresolved());
+            return;
+        }
+
+        // shuffle(indices...) picks lanes of this vector; shuffle(other, indices...) picks
+        // from both, with lanes of `other` numbered after ours
+        size_t firstIndex = 0;
+        uint32_t sourceLanes = vector->lanes;
+        if (!node->arguments.empty() && node->arguments[0])
+        {
+            TypePtr firstType = apply_substitution(node->arguments[0]->type);
+            if (firstType && firstType->is<VectorType>())
+            {
+                if (firstType != vectorType)
+                {
+                    report_error(node, "shuffle: cannot combine '" + vectorType->get_name() + "' with '" +
+                                           firstType->get_name() + "'");
+                }
+                firstIndex = 1;
+                sourceLanes *= 2;
+            }
+        }
+
+        uint32_t resultLanes = static_cast<uint32_t>(node->arguments.size() - firstIndex);
+        TypePtr resultType = typeSystem.get_vector(vector->element, resultLanes);
+        if (!resultType)
+        {
+            report_error(node, "shuffle: " + std::to_string(resultLanes) + " lanes is not a valid vector width");
+            annotate_expression(node, typeSystem.get_unresolved());
+            return;
         }
+
+        for (size_t i = firstIndex; i < node->arguments.size(); ++i)
+        {
+            int64_t lane = 0;
+            if (!get_constant_lane(node->arguments[i], lane))
+            {
+                report_error(node, "shuffle: lane indices must be integer constants");
+            }
+            else if (lane < 0 || lane >= sourceLanes)
+            {
+                report_error(node, "shuffle: lane " + std::to_string(lane) + " is out of range");
+            }
+        }
+
+        node->intrinsic = VectorIntrinsic::Shuffle;
+        annotate_expression(node, resultType);
     }
 
     // === Expression Visitors ===
@@ -531,7 +717,7 @@ namespace Fern
             if (!node->symbol)
             {
                 report_error(node, "Undefined symbol: " +
-                                       (node->parts.empty() ? "<empty>" : node->parts.back()));
+                                       std::string(node->parts.empty() ? "<empty>" : node->parts.back()));
                 annotate_expression(node, typeSystem.get_unresolved());
                 return;
             }
@@ -569,9 +755,9 @@ namespace Fern
     {
         // Visit operands
         if (node->left)
-            node->left->accept(this);
+            dispatch(node->left);
         if (node->right)
-            node->right->accept(this);
+            dispatch(node->right);
 
         TypePtr leftType = node->left ? apply_substitution(node->left->type) : nullptr;
         TypePtr rightType = node->right ? apply_substitution(node->right->type) : nullptr;
@@ -582,6 +768,12 @@ namespace Fern
             return;
         }
 
+        if (leftType->is<VectorType>() || rightType->is<VectorType>())
+        {
+            annotate_expression(node, resolve_vector_binary(node, leftType, rightType));
+            return;
+        }
+
         // Handle comparison operators
         switch (node->operatorKind)
         {
@@ -651,7 +843,7 @@ namespace Fern
     void TypeResolver::visit(BoundUnaryExpression *node)
     {
         if (node->operand)
-            node->operand->accept(this);
+            dispatch(node->operand);
 
         TypePtr operandType = node->operand ? apply_substitution(node->operand->type) : nullptr;
         if (!operandType)
@@ -709,9 +901,9 @@ namespace Fern
     void TypeResolver::visit(BoundAssignmentExpression *node)
     {
         if (node->target)
-            node->target->accept(this);
+            dispatch(node->target);
         if (node->value)
-            node->value->accept(this);
+            dispatch(node->value);
 
         TypePtr targetType = node->target ? apply_substitution(node->target->type) : nullptr;
         TypePtr valueType = node->value ? apply_substitution(node->value->type) : nullptr;
@@ -728,10 +920,16 @@ namespace Fern
             report_error(node, "Cannot assign to rvalue");
         }
 
+        // Compound operators on a vector broadcast a scalar of its element type (v *= 2.0)
+        auto targetVector = targetType->as<VectorType>();
+        bool broadcast = targetVector && valueType == targetVector->element &&
+                         node->operatorKind != AssignmentOperatorKind::Assign;
+
         // Check type compatibility
         if (!targetType->is<UnresolvedType>() && !valueType->is<UnresolvedType>())
         {
-            check_implicit_conversion(valueType, targetType, node, "assignment");
+            if (!broadcast)
+                check_implicit_conversion(valueType, targetType, node, "assignment");
         }
         else
         {
@@ -743,13 +941,37 @@ namespace Fern
 
     void TypeResolver::visit(BoundCallExpression *node)
     {
-        // Visit callee and arguments
-        if (node->callee)
-            node->callee->accept(this);
+        // Vector constructors are named after their type, not a function
+        if (resolve_vector_constructor(node))
+            return;
+
+        // Visit callee and arguments. Method calls on vectors are built-ins, so the
+        // object is resolved first to tell them apart from ordinary member access.
+        auto calleeMember = node->callee ? node->callee->as<BoundMemberAccessExpression>() : nullptr;
+        if (calleeMember)
+        {
+            if (calleeMember->object)
+                dispatch(calleeMember->object);
+            resolve_member_access(calleeMember);
+        }
+        else if (node->callee)
+        {
+            dispatch(node->callee);
+        }
         for (auto arg : node->arguments)
         {
             if (arg)
-                arg->accept(this);
+                dispatch(arg);
+        }
+
+        if (calleeMember && calleeMember->object)
+        {
+            TypePtr objectType = apply_substitution(calleeMember->object->type);
+            if (objectType && objectType->is<VectorType>())
+            {
+                resolve_vector_method(node, calleeMember, objectType);
+                return;
+            }
         }
 
         // Collect argument types
@@ -882,7 +1104,7 @@ namespace Fern
                 }
                 else
                 {
-                    report_error(node, "Member '" + memberExpr->memberName + "' is not callable");
+                    report_error(node, "Member '" + std::string(memberExpr->memberName) + "' is not callable");
                     annotate_expression(node, typeSystem.get_unresolved());
                 }
             }
@@ -902,8 +1124,21 @@ namespace Fern
     void TypeResolver::visit(BoundMemberAccessExpression *node)
     {
         if (node->object)
-            node->object->accept(this);
+            dispatch(node->object);
 
+        TypePtr objectType = node->object ? apply_substitution(node->object->type) : nullptr;
+        if (objectType && objectType->is<VectorType>())
+        {
+            report_error(node, "Vector operation '" + std::string(node->memberName) + "' must be called");
+            annotate_expression(node, typeSystem.get_unresolved());
+            return;
+        }
+
+        resolve_member_access(node);
+    }
+
+    void TypeResolver::resolve_member_access(BoundMemberAccessExpression *node)
+    {
         TypePtr objectType = node->object ? apply_substitution(node->object->type) : nullptr;
         if (!objectType)
         {
@@ -911,6 +1146,12 @@ namespace Fern
             return;
         }
 
+        // Vector members are only callable built-ins; the call resolves them
+        if (objectType->is<VectorType>())
+        {
+            return;
+        }
+
         // Get the type's symbol
         TypeSymbol *typeSymbol = nullptr;
         if (objectType->is<NamedType>())
@@ -930,7 +1171,7 @@ namespace Fern
         auto members = typeSymbol->get_member(node->memberName);
         if (members.empty())
         {
-            report_error(node, "Member '" + node->memberName + "' not found in type '" +
+            report_error(node, "Member '" + std::string(node->memberName) + "' not found in type '" +
                                    typeSymbol->name + "'");
             annotate_expression(node, typeSystem.get_unresolved());
             return;
@@ -969,9 +1210,9 @@ namespace Fern
     void TypeResolver::visit(BoundIndexExpression *node)
     {
         if (node->object)
-            node->object->accept(this);
+            dispatch(node->object);
         if (node->index)
-            node->index->accept(this);
+            dispatch(node->index);
 
         TypePtr objectType = node->object ? apply_substitution(node->object->type) : nullptr;
         TypePtr indexType = node->index ? apply_substitution(node->index->type) : nullptr;
@@ -996,6 +1237,20 @@ namespace Fern
             unify(indexType, typeSystem.get_i32(), node, "pointer index");
             annotate_expression(node, ptrType->pointee);
         }
+        // Lane access on a vector
+        else if (objectType->is<VectorType>())
+        {
+            auto vectorType = objectType->as<VectorType>();
+            unify(indexType, typeSystem.get_i32(), node, "vector lane");
+
+            int64_t lane = 0;
+            if (get_constant_lane(node->index, lane) && (lane < 0 || lane >= vectorType->lanes))
+            {
+                report_error(node, "Lane " + std::to_string(lane) + " is out of range for '" +
+                                       objectType->get_name() + "'");
+            }
+            annotate_expression(node, vectorType->element);
+        }
         else
         {
             report_error(node, "Cannot index type '" + objectType->get_name() + "'");
@@ -1006,11 +1261,11 @@ namespace Fern
     void TypeResolver::visit(BoundNewExpression *node)
     {
         if (node->typeExpression)
-            node->typeExpression->accept(this);
+            dispatch(node->typeExpression);
         for (auto arg : node->arguments)
         {
             if (arg)
-                arg->accept(this);
+                dispatch(arg);
         }
 
         TypePtr type = resolve_type_expression(node->typeExpression);
@@ -1081,13 +1336,13 @@ namespace Fern
     void TypeResolver::visit(BoundArrayCreationExpression *node)
     {
         if (node->elementTypeExpression)
-            node->elementTypeExpression->accept(this);
+            dispatch(node->elementTypeExpression);
         if (node->size)
-            node->size->accept(this);
+            dispatch(node->size);
         for (auto init : node->initializers)
         {
             if (init)
-                init->accept(this);
+                dispatch(init);
         }
 
         TypePtr elementType = resolve_type_expression(node->elementTypeExpression);
@@ -1143,9 +1398,9 @@ namespace Fern
     void TypeResolver::visit(BoundCastExpression *node)
     {
         if (node->expression)
-            node->expression->accept(this);
+            dispatch(node->expression);
         if (node->targetTypeExpression)
-            node->targetTypeExpression->accept(this);
+            dispatch(node->targetTypeExpression);
 
         TypePtr sourceType = node->expression ? apply_substitution(node->expression->type) : nullptr;
         TypePtr targetType = resolve_type_expression(node->targetTypeExpression);
@@ -1165,11 +1420,11 @@ namespace Fern
     void TypeResolver::visit(BoundConditionalExpression *node)
     {
         if (node->condition)
-            node->condition->accept(this);
+            dispatch(node->condition);
         if (node->thenExpression)
-            node->thenExpression->accept(this);
+            dispatch(node->thenExpression);
         if (node->elseExpression)
-            node->elseExpression->accept(this);
+            dispatch(node->elseExpression);
 
         TypePtr condType = node->condition ? apply_substitution(node->condition->type) : nullptr;
         TypePtr thenType = node->thenExpression ? apply_substitution(node->thenExpression->type) : nullptr;
@@ -1207,7 +1462,7 @@ namespace Fern
     void TypeResolver::visit(BoundTypeOfExpression *node)
     {
         if (node->typeExpression)
-            node->typeExpression->accept(this);
+            dispatch(node->typeExpression);
 
         // typeof returns Type type (runtime type information)
         // TODO: Implement proper Type type
@@ -1217,7 +1472,7 @@ namespace Fern
     void TypeResolver::visit(BoundSizeOfExpression *node)
     {
         if (node->typeExpression)
-            node->typeExpression->accept(this);
+            dispatch(node->typeExpression);
 
         // sizeof returns size_t (u64)
         annotate_expression(node, typeSystem.get_primitive("u64"));
@@ -1226,7 +1481,7 @@ namespace Fern
     void TypeResolver::visit(BoundParenthesizedExpression *node)
     {
         if (node->expression)
-            node->expression->accept(this);
+            dispatch(node->expression);
 
         TypePtr innerType = node->expression ? node->expression->type : nullptr;
         annotate_expression(node, innerType);
@@ -1241,7 +1496,7 @@ namespace Fern
     void TypeResolver::visit(BoundConversionExpression *node)
     {
         if (node->expression)
-            node->expression->accept(this);
+            dispatch(node->expression);
 
         // Type should already be set by whoever created this node
         if (!node->type)
@@ -1272,7 +1527,7 @@ namespace Fern
         for (auto stmt : node->statements)
         {
             if (stmt)
-                stmt->accept(this);
+                dispatch(stmt);
         }
 
         // Restore previous scope
@@ -1285,13 +1540,13 @@ namespace Fern
     void TypeResolver::visit(BoundExpressionStatement *node)
     {
         if (node->expression)
-            node->expression->accept(this);
+            dispatch(node->expression);
     }
 
     void TypeResolver::visit(BoundIfStatement *node)
     {
         if (node->condition)
-            node->condition->accept(this);
+            dispatch(node->condition);
 
         TypePtr condType = node->condition ? apply_substitution(node->condition->type) : nullptr;
         if (condType)
@@ -1300,15 +1555,15 @@ namespace Fern
         }
 
         if (node->thenStatement)
-            node->thenStatement->accept(this);
+            dispatch(node->thenStatement);
         if (node->elseStatement)
-            node->elseStatement->accept(this);
+            dispatch(node->elseStatement);
     }
 
     void TypeResolver::visit(BoundWhileStatement *node)
     {
         if (node->condition)
-            node->condition->accept(this);
+            dispatch(node->condition);
 
         TypePtr condType = node->condition ? apply_substitution(node->condition->type) : nullptr;
         if (condType)
@@ -1317,17 +1572,17 @@ namespace Fern
         }
 
         if (node->body)
-            node->body->accept(this);
+            dispatch(node->body);
     }
 
     void TypeResolver::visit(BoundForStatement *node)
     {
         if (node->initializer)
-            node->initializer->accept(this);
+            dispatch(node->initializer);
 
         if (node->condition)
         {
-            node->condition->accept(this);
+            dispatch(node->condition);
             TypePtr condType = apply_substitution(node->condition->type);
             if (condType)
             {
@@ -1338,11 +1593,11 @@ namespace Fern
         for (auto inc : node->incrementors)
         {
             if (inc)
-                inc->accept(this);
+                dispatch(inc);
         }
 
         if (node->body)
-            node->body->accept(this);
+            dispatch(node->body);
     }
 
     void TypeResolver::visit(BoundBreakStatement *node)
@@ -1358,7 +1613,7 @@ namespace Fern
     void TypeResolver::visit(BoundReturnStatement *node)
     {
         if (node->value)
-            node->value->accept(this);
+            dispatch(node->value);
 
         if (!currentFunction)
         {
@@ -1414,7 +1669,7 @@ namespace Fern
         // Resolve type if specified
         if (node->typeExpression)
         {
-            node->typeExpression->accept(this);
+            dispatch(node->typeExpression);
 
             if (node->symbol)
             {
@@ -1428,7 +1683,7 @@ namespace Fern
         // Process initializer
         if (node->initializer)
         {
-            node->initializer->accept(this);
+            dispatch(node->initializer);
 
             if (node->symbol && node->symbol->as<VariableSymbol>())
             {
@@ -1465,7 +1720,7 @@ namespace Fern
             // Resolve return type
             if (node->returnTypeExpression)
             {
-                node->returnTypeExpression->accept(this);
+                dispatch(node->returnTypeExpression);
                 currentFunction->return_type = resolve_type_expression(node->returnTypeExpression);
             }
 
@@ -1473,13 +1728,13 @@ namespace Fern
             for (auto param : node->parameters)
             {
                 if (param)
-                    param->accept(this);
+                    dispatch(param);
             }
 
             // Visit body
             if (node->body)
             {
-                node->body->accept(this);
+                dispatch(node->body);
 
                 // Infer return type if needed
                 if (currentFunction->return_type->is<UnresolvedType>())
@@ -1500,7 +1755,7 @@ namespace Fern
     {
         if (node->typeExpression)
         {
-            node->typeExpression->accept(this);
+            dispatch(node->typeExpression);
 
             if (node->symbol)
             {
@@ -1516,7 +1771,7 @@ namespace Fern
         {
             if (node->getter->expression)
             {
-                node->getter->expression->accept(this);
+                dispatch(node->getter->expression);
                 
                 // Infer property type from getter expression if no explicit type
                 if (node->symbol && (!node->typeExpression || node->symbol->as<PropertySymbol>()->type->is<UnresolvedType>()))
@@ -1539,15 +1794,15 @@ namespace Fern
                 }
             }
             if (node->getter->body)
-                node->getter->body->accept(this);
+                dispatch(node->getter->body);
         }
         
         if (node->setter)
         {
             if (node->setter->expression)
-                node->setter->expression->accept(this);
+                dispatch(node->setter->expression);
             if (node->setter->body)
-                node->setter->body->accept(this);
+                dispatch(node->setter->body);
         }
     }
 
@@ -1583,7 +1838,7 @@ namespace Fern
             // Resolve base type
             if (node->baseTypeExpression)
             {
-                node->baseTypeExpression->accept(this);
+                dispatch(node->baseTypeExpression);
                 // TODO: Set base class
             }
 
@@ -1591,7 +1846,7 @@ namespace Fern
             for (auto member : node->members)
             {
                 if (member)
-                    member->accept(this);
+                    dispatch(member);
             }
 
             // Restore scope
@@ -1616,7 +1871,7 @@ namespace Fern
             for (auto member : node->members)
             {
                 if (member)
-                    member->accept(this);
+                    dispatch(member);
             }
 
             // Restore scope
@@ -1630,7 +1885,7 @@ namespace Fern
         for (auto stmt : node->statements)
         {
             if (stmt)
-                stmt->accept(this);
+                dispatch(stmt);
         }
     }
 
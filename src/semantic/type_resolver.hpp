@@ -12,12 +12,23 @@
 namespace Fern
 {
 
-    class TypeResolver : public BoundVisitor
+    // A resolution error with where it was reported, for tools that point into the source
+    struct ResolveDiagnostic
     {
+        SourceRange location;
+        bool has_location;
+        std::string message;
+    };
+
+    class TypeResolver final : public BoundSwitchVisitor<TypeResolver, BoundVisitor>
+    {
+        friend class BoundSwitchVisitor<TypeResolver, BoundVisitor>;
+
     private:
         SymbolTable& symbolTable;
         TypeSystem& typeSystem;
         std::vector<std::string> errors;
+        std::vector<ResolveDiagnostic> diagnostics; // the same errors, located
         
         // Type inference via unification
         std::unordered_map<TypePtr, TypePtr> substitution;
@@ -36,6 +47,7 @@ namespace Fern
         
         bool resolve(BoundCompilationUnit* unit);
         const std::vector<std::string>& get_errors() const { return errors; }
+        const std::vector<ResolveDiagnostic>& get_diagnostics() const { return diagnostics; }
         
     private:
         // === Core Type Resolution ===
@@ -44,7 +56,7 @@ namespace Fern
         void annotate_expression(BoundExpression* expr, TypePtr type, Symbol* symbol = nullptr);
         
         // === Symbol Resolution ===
-        Symbol* resolve_qualified_name(const std::vector<std::string>& parts);
+        Symbol* resolve_qualified_name(std::span<const std::string_view> parts);
         FunctionSymbol* resolve_overload(const std::vector<FunctionSymbol*>& overloads, 
                                         const std::vector<TypePtr>& argTypes);
         
@@ -58,6 +70,14 @@ namespace Fern
         bool check_implicit_conversion(TypePtr from, TypePtr to, BoundNode* node, const std::string& context);
         bool check_explicit_conversion(TypePtr from, TypePtr to, BoundNode* node, const std::string& context);
         
+        // === Vector Built-ins ===
+        static bool get_constant_lane(BoundExpression* expr, int64_t& lane);
+        TypePtr resolve_vector_binary(BoundBinaryExpression* node, TypePtr leftType, TypePtr rightType);
+        bool resolve_vector_constructor(BoundCallExpression* node);
+        void resolve_vector_method(BoundCallExpression* node, BoundMemberAccessExpression* memberExpr,
+                                   TypePtr vectorType);
+        void resolve_member_access(BoundMemberAccessExpression* node);
+        
         // === Error Reporting ===
         void report_error(BoundNode* node, const std::string& message);
         void report_final_errors();
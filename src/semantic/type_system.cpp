@@ -12,7 +12,7 @@ template<typename T>
 TypePtr TypeSystem::find_or_create(const T& type_kind) {
     // Linear search for now (could optimize with better hashing)
     for (const auto& type : all_types) {
-        if (type->is<T>() && compare_types(type->as<T>(), type_kind)) {
+        if (type->is<T>() && compare_types(*type->as<T>(), type_kind)) {
             return type;
         }
     }
@@ -36,6 +36,14 @@ bool TypeSystem::compare_types(const ArrayType& a, const ArrayType& b) const {
     return a.element == b.element && a.size == b.size;
 }
 
+bool TypeSystem::compare_types(const VectorType& a, const VectorType& b) const {
+    return a.element == b.element && a.lanes == b.lanes;
+}
+
+bool TypeSystem::compare_types(const FunctionType& a, const FunctionType& b) const {
+    return a.returnType == b.returnType && a.paramTypes == b.paramTypes;
+}
+
 bool TypeSystem::compare_types(const NamedType& a, const NamedType& b) const {
     return a.symbol == b.symbol;
 }
@@ -92,8 +100,8 @@ TypePtr TypeSystem::get_f64() {
     return primitives[PrimitiveKind::F64]; 
 }
 
-TypePtr TypeSystem::get_primitive(const std::string& name) {
-    static std::unordered_map<std::string, PrimitiveKind> name_map = {
+TypePtr TypeSystem::get_primitive(std::string_view name) {
+    static std::unordered_map<std::string_view, PrimitiveKind> name_map = {
         {"void", PrimitiveKind::Void},
         {"bool", PrimitiveKind::Bool},
         {"char", PrimitiveKind::Char},
@@ -124,6 +132,49 @@ TypePtr TypeSystem::get_array(TypePtr element, int32_t size) {
     return find_or_create(ArrayType{element, size});
 }
 
+bool TypeSystem::is_valid_vector(TypePtr element, uint32_t lanes) {
+    if (!element || (lanes != 2 && lanes != 4 && lanes != 8 && lanes != 16)) {
+        return false;
+    }
+    auto prim = element->as<PrimitiveType>();
+    if (!prim) {
+        return false;
+    }
+    switch (prim->kind) {
+        case PrimitiveKind::Void:
+        case PrimitiveKind::Bool:
+        case PrimitiveKind::Char:
+            return false;
+        default:
+            return true;
+    }
+}
+
+TypePtr TypeSystem::get_vector(TypePtr element, uint32_t lanes) {
+    if (!is_valid_vector(element, lanes)) {
+        return nullptr;
+    }
+    return find_or_create(VectorType{element, lanes});
+}
+
+TypePtr TypeSystem::get_vector(std::string_view name) {
+    // <element>x<lanes>, e.g. f32x4, i32x8, f64x2
+    auto split = name.rfind('x');
+    if (split == std::string::npos || split == 0 || split + 1 >= name.size()) {
+        return nullptr;
+    }
+
+    uint32_t lanes = 0;
+    for (size_t i = split + 1; i < name.size(); i++) {
+        if (name[i] < '0' || name[i] > '9' || lanes > 16) {
+            return nullptr;
+        }
+        lanes = lanes * 10 + (name[i] - '0');
+    }
+
+    return get_vector(get_primitive(name.substr(0, split)), lanes);
+}
+
 TypePtr TypeSystem::get_function(TypePtr return_type, std::vector<TypePtr> params) {
     return find_or_create(FunctionType{return_type, std::move(params)});
 }
@@ -148,7 +199,11 @@ TypePtr TypeSystem::get_type_parameter(const std::string& name, uint32_t index)
 }
 
 TypePtr TypeSystem::get_unresolved() {
-    return find_or_create(UnresolvedType{next_unresolved_id++});
+    // Each id is fresh, so these are never found again; keeping them out of all_types
+    // stops every later lookup (and a long-lived Session) from paying for them
+    auto type = std::make_shared<Type>();
+    type->kind = UnresolvedType{next_unresolved_id++};
+    return type;
 }
 
 bool TypeSystem::are_equal(TypePtr a, TypePtr b) const {
@@ -4,6 +4,7 @@
 #include <variant>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include "type.hpp"
 #include "symbol.hpp"
@@ -32,6 +33,8 @@ namespace Fern
         bool compare_types(const PrimitiveType& a, const PrimitiveType& b) const;
         bool compare_types(const PointerType& a, const PointerType& b) const;
         bool compare_types(const ArrayType& a, const ArrayType& b) const;
+        bool compare_types(const VectorType& a, const VectorType& b) const;
+        bool compare_types(const FunctionType& a, const FunctionType& b) const;
         bool compare_types(const NamedType& a, const NamedType& b) const;
         bool compare_types(const UnresolvedType& a, const UnresolvedType& b) const;
         
@@ -51,9 +54,12 @@ namespace Fern
         TypePtr get_f32();
         TypePtr get_f64();
         
-        TypePtr get_primitive(const std::string& name);
+        TypePtr get_primitive(std::string_view name);
         TypePtr get_pointer(TypePtr pointee);
         TypePtr get_array(TypePtr element, int32_t size = -1);
+        TypePtr get_vector(TypePtr element, uint32_t lanes);
+        TypePtr get_vector(std::string_view name);  // "f32x4", nullptr if not a vector type
+        static bool is_valid_vector(TypePtr element, uint32_t lanes);
         TypePtr get_function(TypePtr return_type, std::vector<TypePtr> params);
         TypePtr get_named(TypeSymbol* symbol);
         TypePtr get_generic(TypeSymbol* generic, std::vector<TypePtr> args);
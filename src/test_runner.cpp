@@ -1,27 +1,414 @@
 #include "test_runner.hpp"
 #include "compiler.hpp"
+#include "codegen/profile.hpp"
 #include "common/logger.hpp"
+#include "parser/lexer.hpp"
+#include "parser/parser.hpp"
+#include "parser/token_stream.hpp"
+#include "format/formatter.hpp"
+#include <llvm/IR/DebugInfoMetadata.h>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <memory>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <optional>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 namespace fs = std::filesystem;
 
 namespace Fern {
 
-static std::string read_file(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open file: " + filename);
+TestRunner::TestRunner() {
+}
+
+// "-- Expected: trap" marks a test whose Main has to stop on a failed bounds check
+static bool expects_trap(std::string_view source) {
+    auto pos = source.find("-- Expected:");
+    if (pos == std::string_view::npos) {
+        return false;
     }
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    auto value = source.substr(pos + 12, source.find('\n', pos) - pos - 12);
+    return value.find("trap") != std::string_view::npos;
 }
 
-TestRunner::TestRunner() {
+// "-- Expected: 42.0" is what Main has to return; nullopt without one, or when the header
+// works the value out rather than giving it
+static std::optional<float> expected_value(std::string_view source) {
+    auto pos = source.find("-- Expected:");
+    if (pos == std::string_view::npos) {
+        return std::nullopt;
+    }
+    std::string value(source.substr(pos + 12, source.find('\n', pos) - pos - 12));
+    char* end = nullptr;
+    float number = std::strtof(value.c_str(), &end);
+    if (end == value.c_str() || value.find_first_not_of(" \t\r", end - value.c_str()) != std::string::npos) {
+        return std::nullopt;
+    }
+    return number;
+}
+
+static bool same_value(float expected, float value) {
+    return std::fabs(expected - value) <= std::fabs(expected) * 1e-6f;
+}
+
+static std::string value_text(float value) {
+    std::ostringstream text;
+    text << value;
+    return text.str();
+}
+
+// "-- Check: reparse ..." names extra checks: front-end ones run on the source before it's
+// compiled, the rest build it again another way and call Main
+static bool has_check(std::string_view source, std::string_view check) {
+    auto pos = source.find("-- Check:");
+    if (pos == std::string_view::npos) {
+        return false;
+    }
+    auto value = source.substr(pos + 9, source.find('\n', pos) - pos - 9);
+    return value.find(check) != std::string_view::npos;
+}
+
+// Every node location in a tree, in the order a visitor reaches them
+class LocationCollector : public DefaultVisitor {
+public:
+    using DefaultVisitor::visit;
+    std::vector<SourceRange> locations;
+
+    void visit(BaseSyntax* node) override {
+        locations.push_back(node->location);
+    }
+
+    void visit(SimpleNameSyntax* node) override {
+        locations.push_back(node->identifier.location);
+        DefaultVisitor::visit(node);
+    }
+};
+
+static bool same_range(const SourceRange& a, const SourceRange& b) {
+    return a.start == b.start && a.width == b.width;
+}
+
+// Where two parses of the same text first disagree, or empty when they don't
+static std::string compare_parses(const TokenStream& tokens, CompilationUnitSyntax* unit,
+                                  const TokenStream& expected_tokens, CompilationUnitSyntax* expected) {
+    const auto& got = tokens.get_tokens();
+    const auto& want = expected_tokens.get_tokens();
+    if (got.size() != want.size()) {
+        return std::to_string(got.size()) + " tokens, a full parse has " + std::to_string(want.size());
+    }
+    for (size_t i = 0; i < got.size(); i++) {
+        if (got[i].kind != want[i].kind || !same_range(got[i].location, want[i].location)) {
+            return "token " + std::to_string(i) + " is at " + got[i].location.start.to_string() +
+                   ", a full parse has it at " + want[i].location.start.to_string();
+        }
+    }
+
+    LocationCollector got_nodes, want_nodes;
+    unit->accept(&got_nodes);
+    expected->accept(&want_nodes);
+    if (got_nodes.locations.size() != want_nodes.locations.size()) {
+        return std::to_string(got_nodes.locations.size()) + " nodes, a full parse has " +
+               std::to_string(want_nodes.locations.size());
+    }
+    for (size_t i = 0; i < got_nodes.locations.size(); i++) {
+        if (!same_range(got_nodes.locations[i], want_nodes.locations[i])) {
+            return "node " + std::to_string(i) + " is at " + got_nodes.locations[i].start.to_string() +
+                   ", a full parse has it at " + want_nodes.locations[i].start.to_string();
+        }
+    }
+    return "";
+}
+
+// Adds a comment line ahead of the second declaration and reparses, twice, so the
+// declarations after it are reused and moved twice. After each edit every token and node
+// has to be where parsing the edited text from scratch puts it
+static std::string check_reparse(std::string source) {
+    TokenStream tokens(Lexer(source).tokenize_all());
+    auto parser = std::make_unique<Parser>(tokens);
+    auto unit = parser->parse();
+    if (parser->hasErrors() || unit->topLevelStatements.size() < 3) {
+        return "needs three declarations that parse";
+    }
+
+    const std::string comment = "-- edited\n";
+    for (int pass = 1; pass <= 2; pass++) {
+        int offset = unit->topLevelStatements[1]->location.start.offset;
+        source.insert(static_cast<size_t>(offset), comment);
+        auto next = std::make_unique<Parser>(tokens);
+        unit = next->reparse(std::move(parser), unit, TextEdit{offset, 0, static_cast<int>(comment.size())}, source);
+        parser = std::move(next);
+
+        std::string edit = "edit " + std::to_string(pass) + ": ";
+        if (parser->hasErrors()) {
+            return edit + parser->getErrors().front().message;
+        }
+        if (parser->getReusedCount() == 0) {
+            return edit + "no declaration was reused";
+        }
+
+        TokenStream fresh_tokens(Lexer(source).tokenize_all());
+        Parser fresh(fresh_tokens);
+        auto fresh_unit = fresh.parse();
+        std::string difference = compare_parses(tokens, unit, fresh_tokens, fresh_unit);
+        if (!difference.empty()) {
+            return edit + difference;
+        }
+    }
+    return "";
+}
+
+// Parses the source with the parser's memo and without it. The trees have to match node for
+// node, and the memo has to have answered some of the rules tried again from the same token
+static std::string check_memo(std::string source) {
+    TokenStream tokens(Lexer(source).tokenize_all());
+    Parser parser(tokens);
+    auto unit = parser.parse();
+
+    TokenStream unmemoized_tokens(Lexer(source).tokenize_all());
+    Parser unmemoized(unmemoized_tokens);
+    unmemoized.setMemoization(false);
+    auto unmemoized_unit = unmemoized.parse();
+
+    if (parser.hasErrors() || unmemoized.hasErrors()) {
+        return "doesn't parse";
+    }
+    std::string difference = compare_parses(tokens, unit, unmemoized_tokens, unmemoized_unit);
+    if (!difference.empty()) {
+        return "memoized, " + difference;
+    }
+    if (parser.getMemoStats().hits == 0) {
+        return "the memo answered nothing";
+    }
+    return "";
+}
+
+using SourceCheck = std::string (*)(std::string source);
+
+static const std::pair<const char*, SourceCheck> source_checks[] = {
+    {"reparse", check_reparse},
+    {"memo", check_memo},
+};
+
+// Compiles the test again with `configure` applied and calls Main, which has to return what
+// the plain build did. Returns what went wrong, or empty; `module` keeps the build
+static std::string run_configured(const SourceFile& file, float plain,
+                                  const std::function<void(Compiler&)>& configure,
+                                  std::unique_ptr<CompiledModule>& module) {
+    Compiler compiler;
+    compiler.set_print_ast(false);
+    compiler.set_print_symbols(false);
+    compiler.set_print_hlir(false);
+    configure(compiler);
+
+    module = compiler.compile(file);
+    if (!module || !module->is_valid()) {
+        std::string errors = "doesn't compile";
+        if (module) {
+            for (const auto& error : module->get_errors()) {
+                errors += "; " + error;
+            }
+        }
+        return errors;
+    }
+
+    auto value = module->execute_jit<float>("Main");
+    if (!value) {
+        return "Main didn't run";
+    }
+    if (!same_value(plain, *value)) {
+        return "returned " + value_text(*value) + ", the plain build " + value_text(plain);
+    }
+    return "";
+}
+
+// Code generation split across four threads at -O2, so calls cross LLVM modules
+static std::string check_partitioned(const SourceFile& file, float plain) {
+    std::unique_ptr<CompiledModule> module;
+    std::string error = run_configured(file, plain, [](Compiler& compiler) {
+        compiler.set_codegen_threads(4);
+        compiler.set_opt_level(2);
+    }, module);
+    if (error.empty() && module->get_parts().size() < 2) {
+        error = "code generation wasn't partitioned";
+    }
+    return error;
+}
+
+// Each function compiled on its first call, through a stub
+static std::string check_lazy(const SourceFile& file, float plain) {
+    std::unique_ptr<CompiledModule> module;
+    return run_configured(file, plain, [](Compiler& compiler) {
+        compiler.set_jit_mode(JITMode::Lazy);
+    }, module);
+}
+
+// Built for perf: each Fern function gets debug info with lines from its body, and once it
+// has run, perf's symbol map for this process names it
+static std::string check_perf(const SourceFile& file, float plain) {
+    std::unique_ptr<CompiledModule> module;
+    std::string error = run_configured(file, plain, [](Compiler& compiler) {
+        compiler.set_profiling(true);
+    }, module);
+    if (!error.empty()) {
+        return error;
+    }
+
+    std::vector<std::string> functions;
+    for (const auto& part : module->get_parts()) {
+        for (const llvm::Function& function : *part.module) {
+            const llvm::DISubprogram* subprogram = function.getSubprogram();
+            if (function.isDeclaration() || !subprogram) {
+                continue;
+            }
+            bool body_lines = false;
+            for (const auto& block : function) {
+                for (const auto& inst : block) {
+                    body_lines |= inst.getDebugLoc() && inst.getDebugLoc().getLine() > subprogram->getLine();
+                }
+            }
+            if (!body_lines) {
+                return function.getName().str() + " has no lines past its declaration";
+            }
+            functions.push_back(function.getName().str());
+        }
+    }
+    if (functions.empty()) {
+        return "no function has debug info";
+    }
+
+#ifdef __linux__
+    std::ifstream map_file("/tmp/perf-" + std::to_string(getpid()) + ".map");
+    std::stringstream map;
+    map << map_file.rdbuf();
+    for (const auto& name : functions) {
+        if (map.str().find(" " + name + "\n") == std::string::npos) {
+            return "the perf map doesn't name " + name;
+        }
+    }
+#endif
+    return "";
+}
+
+// Built instrumented at -O2 and run to write a profile, then built again at -O2 using it. The
+// profile has to load, and the second build has to give Main the entry count it recorded
+static std::string check_pgo(const SourceFile& file, float plain) {
+    std::string profile = (fs::temp_directory_path() /
+                           ("fern-test-" + fs::path(file.filename).stem().string() + ".profile")).string();
+    std::error_code ec;
+    fs::remove(profile, ec); // instrumented runs append
+
+    std::unique_ptr<CompiledModule> module;
+    std::string error = run_configured(file, plain, [&](Compiler& compiler) {
+        compiler.set_opt_level(2);
+        compiler.set_profile_generate(profile);
+    }, module);
+    if (!error.empty()) {
+        fs::remove(profile, ec);
+        return "instrumented: " + error;
+    }
+
+    ProfileData data;
+    if (!data.load(profile, error) || data.empty()) {
+        fs::remove(profile, ec);
+        return error.empty() ? "the instrumented run wrote no counts" : error;
+    }
+
+    error = run_configured(file, plain, [&](Compiler& compiler) {
+        compiler.set_opt_level(2);
+        compiler.set_profile_use(profile);
+    }, module);
+    fs::remove(profile, ec);
+    if (!error.empty()) {
+        return "with the profile: " + error;
+    }
+
+    for (const auto& part : module->get_parts()) {
+        llvm::Function* main = part.module->getFunction("Main");
+        if (main && !main->isDeclaration()) {
+            auto count = main->getEntryCount();
+            return count && count->getCount() > 0 ? "" : "Main has no entry count from the profile";
+        }
+    }
+    return "no part defines Main";
+}
+
+static std::string without_whitespace(std::string_view text) {
+    std::string rest;
+    for (char c : text) {
+        if (!std::isspace(static_cast<unsigned char>(c))) {
+            rest += c;
+        }
+    }
+    return rest;
+}
+
+// Laid out again by `fern fmt`'s formatter: only whitespace may change, formatting the result
+// again has to leave it as it is, and the formatted program has to return what the original did
+static std::string check_format(const SourceFile& file, float plain) {
+    Formatter formatter;
+    std::string once, twice, error;
+    if (!formatter.format(file.source(), once, &error)) {
+        return "doesn't format: " + error;
+    }
+    if (without_whitespace(once) != without_whitespace(file.source())) {
+        return "formatting changed more than whitespace";
+    }
+    formatter.format(once, twice);
+    if (twice != once) {
+        return "formatting the formatted text changed it again";
+    }
+
+    std::unique_ptr<CompiledModule> module;
+    return run_configured(SourceFile(file.filename, once), plain, [](Compiler&) {}, module);
+}
+
+using BuildCheck = std::string (*)(const SourceFile& file, float plain);
+
+static const std::pair<const char*, BuildCheck> build_checks[] = {
+    {"partitioned", check_partitioned},
+    {"lazy", check_lazy},
+    {"perf", check_perf},
+    {"pgo", check_pgo},
+    {"format", check_format},
+};
+
+// Runs Main in a child process, since a trap takes the whole process down
+static void run_expecting_trap(CompiledModule& module, TestResult& result) {
+#ifdef _WIN32
+    (void)module;
+    result.crashed = true;
+    result.error_message = "trap tests need fork()";
+#else
+    std::cout.flush();
+    pid_t child = fork();
+    if (child < 0) {
+        result.crashed = true;
+        result.error_message = "fork failed";
+        return;
+    }
+    if (child == 0) {
+        module.execute_jit<float>("Main");
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    result.trapped = WIFSIGNALED(status);
+    result.passed = result.trapped;
+    if (!result.passed) {
+        result.error_message = "Main returned without trapping";
+    }
+#endif
 }
 
 TestResult TestRunner::run_single_test(const std::string& test_file) {
@@ -36,8 +423,19 @@ TestResult TestRunner::run_single_test(const std::string& test_file) {
         compiler.set_print_hlir(false);
 
         // Read and compile the test file
-        std::string source = read_file(test_file);
-        std::vector<SourceFile> source_files = {{test_file, source}};
+        std::vector<SourceFile> source_files = {SourceFile::open(test_file)};
+        bool trap = expects_trap(source_files[0].source());
+
+        for (const auto& [name, check] : source_checks) {
+            if (has_check(source_files[0].source(), name)) {
+                std::string error = check(std::string(source_files[0].source()));
+                if (!error.empty()) {
+                    result.error_message = std::string(name) + ": " + error;
+                    return result;
+                }
+            }
+        }
+        compiler.set_bounds_checks(trap);
 
         auto compile_result = compiler.compile(source_files);
 
@@ -55,6 +453,11 @@ TestResult TestRunner::run_single_test(const std::string& test_file) {
             return result;
         }
 
+        if (trap) {
+            run_expecting_trap(*compile_result, result);
+            return result;
+        }
+
         // Try to execute the test
         auto jit_result = compile_result->execute_jit<float>("Main");
 
@@ -63,6 +466,23 @@ TestResult TestRunner::run_single_test(const std::string& test_file) {
             // Consider test passed if it returns a non-negative value
             // (negative values often indicate errors in convention)
             result.passed = (result.return_value >= 0.0f);
+
+            auto expected = expected_value(source_files[0].source());
+            if (expected && !same_value(*expected, result.return_value)) {
+                result.passed = false;
+                result.error_message = "returned " + value_text(result.return_value) + ", expected " +
+                                       value_text(*expected);
+            }
+
+            for (const auto& [name, check] : build_checks) {
+                if (result.passed && has_check(source_files[0].source(), name)) {
+                    std::string error = check(source_files[0], result.return_value);
+                    if (!error.empty()) {
+                        result.passed = false;
+                        result.error_message = std::string(name) + ": " + error;
+                    }
+                }
+            }
         } else {
             result.crashed = true;
             result.error_message = "JIT execution failed or Main not found";
@@ -83,10 +503,10 @@ std::vector<TestResult> TestRunner::run_all_tests(const std::string& test_dir) {
     std::vector<TestResult> results;
     std::vector<std::string> test_files;
 
-    // Collect all .fern files in the test directory
+    // Collect all .fn files in the test directory
     try {
         for (const auto& entry : fs::directory_iterator(test_dir)) {
-            if (entry.is_regular_file() && entry.path().extension() == ".fern") {
+            if (entry.is_regular_file() && entry.path().extension() == ".fn") {
                 test_files.push_back(entry.path().string());
             }
         }
@@ -111,12 +531,16 @@ std::vector<TestResult> TestRunner::run_all_tests(const std::string& test_dir) {
         results.push_back(result);
 
         // Print immediate result
-        if (result.passed) {
+        if (result.passed && result.trapped) {
+            std::cout << "PASS (trapped)" << std::endl;
+        } else if (result.passed) {
             std::cout << "PASS (returned " << result.return_value << ")" << std::endl;
         } else if (result.crashed) {
             std::cout << "CRASH: " << result.error_message << std::endl;
         } else if (result.compile_failed) {
             std::cout << "COMPILE FAILED: " << result.error_message << std::endl;
+        } else if (!result.error_message.empty()) {
+            std::cout << "FAIL: " << result.error_message << std::endl;
         } else {
             std::cout << "FAIL (returned " << result.return_value << ")" << std::endl;
         }
@@ -147,6 +571,9 @@ void TestRunner::print_summary(const std::vector<TestResult>& results) {
             if (!result.error_message.empty()) {
                 std::cout << "  " << result.error_message << std::endl;
             }
+        } else if (!result.error_message.empty()) {
+            failed++;
+            std::cout << "FAIL: " << result.test_name << " - " << result.error_message << std::endl;
         } else {
             failed++;
             std::cout << "FAIL: " << result.test_name << " (returned " << result.return_value << ")" << std::endl;
@@ -10,12 +10,13 @@ struct TestResult {
     bool passed;
     bool crashed;
     bool compile_failed;
+    bool trapped;       // Main stopped on a failed bounds check
     float return_value;
     std::string error_message;
 
     TestResult(const std::string& name)
         : test_name(name), passed(false), crashed(false),
-          compile_failed(false), return_value(0.0f) {}
+          compile_failed(false), trapped(false), return_value(0.0f) {}
 };
 
 class TestRunner {
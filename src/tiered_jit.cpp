@@ -0,0 +1,293 @@
+#include "tiered_jit.hpp"
+#include "compiled_module.hpp"
+#include "common/logger.hpp"
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace Fern
+{
+    static double ms_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    TierManager::TierManager(llvm::orc::LLJIT &jit, uint64_t threshold)
+        : jit(jit), state{threshold, this}, created(std::chrono::steady_clock::now())
+    {
+        auto stubs_builder = llvm::orc::createLocalIndirectStubsManagerBuilder(jit.getTargetTriple());
+        if (!stubs_builder)
+        {
+            LOG_ERROR("Tiered JIT: no indirect stubs for " + jit.getTargetTriple().str(), LogCategory::JIT);
+            return;
+        }
+        stubs = stubs_builder();
+
+        // The two symbols tier-0 code expects from its host
+        llvm::orc::SymbolMap host_symbols;
+        host_symbols[jit.mangleAndIntern("__fern_tier_state")] = {
+            llvm::orc::ExecutorAddr::fromPtr(&state), llvm::JITSymbolFlags::Exported};
+        host_symbols[jit.mangleAndIntern("__fern_tier_up")] = {
+            llvm::orc::ExecutorAddr::fromPtr(&tier_up_hook),
+            llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable};
+        if (auto err = jit.getMainJITDylib().define(llvm::orc::absoluteSymbols(std::move(host_symbols))))
+        {
+            LOG_ERROR("Tiered JIT: " + llvm::toString(std::move(err)), LogCategory::JIT);
+        }
+
+        worker = std::thread([this]() { run_worker(); });
+    }
+
+    TierManager::~TierManager()
+    {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stopping = true;
+        }
+        queue_changed.notify_all();
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+
+    llvm::Error TierManager::add_module(std::unique_ptr<llvm::Module> module,
+                                        std::unique_ptr<llvm::LLVMContext> context)
+    {
+        if (!stubs)
+        {
+            return llvm::make_error<llvm::StringError>("tiered JIT has no stubs manager",
+                                                       llvm::inconvertibleErrorCode());
+        }
+
+        std::vector<std::string> names;
+        for (llvm::Function &func : *module)
+        {
+            if (!func.isDeclaration())
+            {
+                names.push_back(func.getName().str());
+            }
+        }
+
+        // F becomes F.tier0, and every call to it goes through stub F instead
+        llvm::orc::SymbolMap stub_symbols;
+        for (const auto &name : names)
+        {
+            llvm::Function *body = module->getFunction(name);
+            body->setName(name + ".tier0");
+            auto *callee = llvm::Function::Create(body->getFunctionType(), llvm::GlobalValue::ExternalLinkage,
+                                                  name, module.get());
+            body->replaceAllUsesWith(callee);
+
+            auto flags = llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable;
+            if (auto err = stubs->createStub(name, llvm::orc::ExecutorAddr(), flags))
+            {
+                return err;
+            }
+            stub_symbols[jit.mangleAndIntern(name)] = stubs->findStub(name, false);
+
+            auto record = std::make_unique<FunctionRecord>();
+            record->name = name;
+            pending.push_back(record.get());
+            functions.push_back(std::move(record));
+        }
+
+        if (auto err = jit.getMainJITDylib().define(llvm::orc::absoluteSymbols(std::move(stub_symbols))))
+        {
+            return err;
+        }
+        return jit.addIRModule(llvm::orc::ThreadSafeModule(std::move(module), std::move(context)));
+    }
+
+    void TierManager::set_source(const llvm::Module &module)
+    {
+        source_bitcode.clear();
+        llvm::raw_string_ostream stream(source_bitcode);
+        llvm::WriteBitcodeToFile(module, stream);
+        stream.flush();
+    }
+
+    llvm::Error TierManager::link_pending()
+    {
+        for (FunctionRecord *record : pending)
+        {
+            auto body = jit.lookup(record->name + ".tier0");
+            if (!body)
+            {
+                return body.takeError();
+            }
+            if (auto err = stubs->updatePointer(record->name, *body))
+            {
+                return err;
+            }
+
+            // Modules built without profile counters run tier 0 for good
+            auto counter = jit.lookup("__fern_count." + record->name);
+            if (!counter)
+            {
+                llvm::consumeError(counter.takeError());
+                continue;
+            }
+            record->counter = counter->toPtr<uint64_t *>();
+            by_counter[record->counter] = record;
+        }
+        pending.clear();
+        return llvm::Error::success();
+    }
+
+    void TierManager::tier_up_hook(State *state, uint64_t *counter)
+    {
+        // Called on every entry past the threshold until the stub moves, so stay cheap
+        auto &by_counter = state->owner->by_counter;
+        auto it = by_counter.find(counter);
+        if (it != by_counter.end())
+        {
+            state->owner->request(it->second);
+        }
+    }
+
+    void TierManager::request(FunctionRecord *record)
+    {
+        if (record->requested.exchange(true))
+        {
+            return;
+        }
+
+        record->requested_count = std::atomic_ref<uint64_t>(*record->counter).load(std::memory_order_relaxed);
+        record->requested_ms = ms_since(created);
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            queue.push_back(record);
+            in_flight++;
+        }
+        queue_changed.notify_all();
+    }
+
+    void TierManager::run_worker()
+    {
+        while (true)
+        {
+            FunctionRecord *record = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_changed.wait(lock, [&]() { return stopping || !queue.empty(); });
+                if (stopping)
+                {
+                    return;
+                }
+                record = queue.front();
+                queue.pop_front();
+            }
+
+            compile_tier3(record);
+
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                in_flight--;
+            }
+            queue_changed.notify_all();
+        }
+    }
+
+    void TierManager::compile_tier3(FunctionRecord *record)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        auto context = std::make_unique<llvm::LLVMContext>();
+        auto parsed = llvm::parseBitcodeFile(
+            llvm::MemoryBufferRef(llvm::StringRef(source_bitcode), "tier3." + record->name), *context);
+        if (!parsed)
+        {
+            LOG_ERROR("Tier-up of " + record->name + " failed: " + llvm::toString(parsed.takeError()),
+                      LogCategory::JIT);
+            return;
+        }
+        std::unique_ptr<llvm::Module> module = std::move(*parsed);
+
+        llvm::Function *target = module->getFunction(record->name);
+        if (!target || target->isDeclaration())
+        {
+            LOG_ERROR("Tier-up of " + record->name + " failed: no source for it", LogCategory::JIT);
+            return;
+        }
+
+        // Other bodies stay visible to the inliner but are never emitted; calls the
+        // optimizer leaves alone still go through their stubs, and exported globals
+        // resolve to the tier-0 definitions
+        for (llvm::Function &func : *module)
+        {
+            if (&func != target && !func.isDeclaration())
+            {
+                func.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+            }
+        }
+        for (llvm::GlobalVariable &global : module->globals())
+        {
+            if (!global.isDeclaration() && !global.hasLocalLinkage())
+            {
+                global.setInitializer(nullptr);
+                global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+            }
+        }
+        target->setName(record->name + ".tier3");
+
+        if (!optimize_module(*module, 3))
+        {
+            LOG_ERROR("Tier-up of " + record->name + " failed: optimization", LogCategory::JIT);
+            return;
+        }
+
+        if (auto err = jit.addIRModule(llvm::orc::ThreadSafeModule(std::move(module), std::move(context))))
+        {
+            LOG_ERROR("Tier-up of " + record->name + " failed: " + llvm::toString(std::move(err)), LogCategory::JIT);
+            return;
+        }
+        auto body = jit.lookup(record->name + ".tier3");
+        if (!body)
+        {
+            LOG_ERROR("Tier-up of " + record->name + " failed: " + llvm::toString(body.takeError()), LogCategory::JIT);
+            return;
+        }
+        if (auto err = stubs->updatePointer(record->name, *body))
+        {
+            LOG_ERROR("Tier-up of " + record->name + " failed: " + llvm::toString(std::move(err)), LogCategory::JIT);
+            return;
+        }
+        record->tier = 3;
+
+        std::lock_guard<std::mutex> lock(events_mutex);
+        events.push_back({record->name, record->requested_count, record->requested_ms, ms_since(start)});
+    }
+
+    void TierManager::wait_idle()
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_changed.wait(lock, [&]() { return in_flight == 0 || stopping; });
+    }
+
+    std::vector<TierUpEvent> TierManager::get_events() const
+    {
+        std::lock_guard<std::mutex> lock(events_mutex);
+        return events;
+    }
+
+    std::vector<FunctionCounter> TierManager::get_counters() const
+    {
+        std::vector<FunctionCounter> counters;
+        for (const auto &record : functions)
+        {
+            FunctionCounter counter;
+            counter.function = record->name;
+            if (record->counter)
+            {
+                counter.count = std::atomic_ref<uint64_t>(*record->counter).load(std::memory_order_relaxed);
+            }
+            counter.tier = record->tier;
+            counters.push_back(counter);
+        }
+        return counters;
+    }
+
+} // namespace Fern
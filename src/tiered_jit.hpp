@@ -0,0 +1,125 @@
+#pragma once
+#include <llvm/ExecutionEngine/Orc/IndirectionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Error.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Fern
+{
+    // One hot function that was recompiled at -O3
+    struct TierUpEvent
+    {
+        std::string function;
+        uint64_t count = 0;      // counter value when the tier-up was requested
+        double requested_ms = 0; // since the JIT was created
+        double compile_ms = 0;   // -O3 pipeline plus machine code, on the background thread
+    };
+
+    struct FunctionCounter
+    {
+        std::string function;
+        uint64_t count = 0; // entries plus loop header executions while in tier 0
+        int tier = 0;       // 0 until the optimized code is installed, then 3
+    };
+
+    /**
+     * @brief Two-tier execution on top of an LLJIT
+     *
+     * Tier 0 is the module as HLIRCodeGen emits it with profile counters on, compiled
+     * without the LLVM pipeline. Every function F is renamed F.tier0 and callers reach
+     * it through an indirect stub named F. When F's counter reaches the threshold its
+     * prologue calls back into the JIT, which:
+     * 1. Queues F for the background thread (once)
+     * 2. Copies the uninstrumented source module into a fresh context, keeps F as
+     *    F.tier3 and every other body as available_externally so it can be inlined
+     * 3. Runs -O3, JIT-compiles F.tier3 and re-points stub F at it
+     *
+     * Calls that already entered F.tier0 finish there; every later call runs tier 3.
+     */
+    class TierManager
+    {
+    public:
+        // What generated code sees through __fern_tier_state; the threshold must come first
+        struct State
+        {
+            uint64_t threshold;
+            TierManager *owner;
+        };
+
+    private:
+        struct FunctionRecord
+        {
+            std::string name;
+            uint64_t *counter = nullptr;
+            std::atomic<bool> requested{false};
+            std::atomic<int> tier{0};
+            uint64_t requested_count = 0; // written by the hook before the record is queued
+            double requested_ms = 0;
+        };
+
+        llvm::orc::LLJIT &jit;
+        std::unique_ptr<llvm::orc::IndirectStubsManager> stubs;
+        State state;
+
+        std::vector<std::unique_ptr<FunctionRecord>> functions;
+        std::unordered_map<uint64_t *, FunctionRecord *> by_counter; // filled before any code runs
+        std::vector<FunctionRecord *> pending;                      // added but not linked yet
+        std::string source_bitcode;                                 // uninstrumented IR for tier 3
+
+        // Background compiler
+        std::thread worker;
+        std::mutex queue_mutex;
+        std::condition_variable queue_changed;
+        std::deque<FunctionRecord *> queue;
+        size_t in_flight = 0;
+        bool stopping = false;
+
+        mutable std::mutex events_mutex;
+        std::vector<TierUpEvent> events;
+        std::chrono::steady_clock::time_point created;
+
+        static void tier_up_hook(State *state, uint64_t *counter);
+        void request(FunctionRecord *record);
+        void run_worker();
+        void compile_tier3(FunctionRecord *record);
+
+    public:
+        static constexpr uint64_t DEFAULT_THRESHOLD = 1000;
+
+        TierManager(llvm::orc::LLJIT &jit, uint64_t threshold = DEFAULT_THRESHOLD);
+        ~TierManager();
+
+        TierManager(const TierManager &) = delete;
+        TierManager &operator=(const TierManager &) = delete;
+
+        void set_threshold(uint64_t threshold) { state.threshold = threshold; }
+        uint64_t get_threshold() const { return state.threshold; }
+
+        // Rename the module's functions to their tier-0 names, stub the originals and add it
+        llvm::Error add_module(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context);
+
+        // Uninstrumented IR for every function added so far, recompiled function by function
+        void set_source(const llvm::Module &module);
+
+        // Compile the tier-0 code added since the last call and point its stubs at it
+        llvm::Error link_pending();
+
+        // Block until every requested tier-up is installed
+        void wait_idle();
+
+        std::vector<TierUpEvent> get_events() const;
+        std::vector<FunctionCounter> get_counters() const;
+    };
+
+} // namespace Fern